@@ -79,6 +79,11 @@ if(MSVC)
   # Adds support for multiple processes builds
   set_property(DIRECTORY APPEND PROPERTY COMPILE_OPTIONS "/MP")
 
+  # Enables AVX2 instructions set
+  if(ozz_build_simd_avx AND NOT ozz_build_simd_ref)
+    set_property(DIRECTORY APPEND PROPERTY COMPILE_OPTIONS "/arch:AVX2")
+  endif()
+
   #---------------
   # For all builds
   foreach(flag ${cxx_all_flags})
@@ -116,6 +121,11 @@ else()
   # Automatically selects native architecture optimizations (sse...)
   #set_property(DIRECTORY APPEND PROPERTY COMPILE_OPTIONS "-march=native")
 
+  # Enables AVX2 and FMA instructions set
+  if(ozz_build_simd_avx AND NOT ozz_build_simd_ref)
+    set_property(DIRECTORY APPEND PROPERTY COMPILE_OPTIONS "-mavx2" "-mfma")
+  endif()
+
   #----------------------
   # Enables debug glibcxx if NDebug isn't defined, not supported by APPLE
   if(NOT APPLE)
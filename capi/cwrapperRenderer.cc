@@ -256,15 +256,36 @@ void rendererDrawSkinnedMesh(struct RendererData* rendererData, ozz::math::Float
     // multiplied by inverse model-space bind-pose.
     skinning_job.joint_matrices = skinning_matrices;
 
-    // Setup joint's indices.
-    skinning_job.joint_indices = make_range(part.joint_indices);
-    skinning_job.joint_indices_stride = sizeof(uint16_t) * part_influences_count;
+    // Setup joint's indices, according to the format they are stored in.
+    if (!part.joint_indices8.empty())
+    {
+      skinning_job.joint_indices8 = make_range(part.joint_indices8);
+      skinning_job.joint_indices_stride = sizeof(uint8_t) * part_influences_count;
+    }
+    else
+    {
+      skinning_job.joint_indices = make_range(part.joint_indices);
+      skinning_job.joint_indices_stride = sizeof(uint16_t) * part_influences_count;
+    }
 
-    // Setup joint's weights.
+    // Setup joint's weights, according to the format they are stored in.
     if (part_influences_count > 1)
     {
-      skinning_job.joint_weights = make_range(part.joint_weights);
-      skinning_job.joint_weights_stride = sizeof(float) * (part_influences_count - 1);
+      if (!part.joint_weights8.empty())
+      {
+        skinning_job.joint_weights8 = make_range(part.joint_weights8);
+        skinning_job.joint_weights_stride = sizeof(uint8_t) * (part_influences_count - 1);
+      }
+      else if (!part.joint_weights16.empty())
+      {
+        skinning_job.joint_weights16 = make_range(part.joint_weights16);
+        skinning_job.joint_weights_stride = sizeof(uint16_t) * (part_influences_count - 1);
+      }
+      else
+      {
+        skinning_job.joint_weights = make_range(part.joint_weights);
+        skinning_job.joint_weights_stride = sizeof(float) * (part_influences_count - 1);
+      }
     }
 
     // Setup input positions, coming from the loaded mesh.
@@ -28,12 +28,10 @@
 #ifndef OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_BUILDER_H_
 #define OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_BUILDER_H_
 
+#include "ozz/animation/runtime/animation.h"
+
 namespace ozz {
 namespace animation {
-
-// Forward declares the runtime animation type.
-class Animation;
-
 namespace offline {
 
 // Forward declares the offline animation type.
@@ -44,12 +42,32 @@ struct RawAnimation;
 // No optimization at all is performed on the raw animation.
 class AnimationBuilder {
  public:
+  // Initializes the builder with default parameters (standard rotation
+  // format and float times).
+  AnimationBuilder();
+
   // Creates an Animation based on _raw_animation and *this builder parameters.
   // Returns a valid Animation on success
   // The returned animation will then need to be deleted using the default 
   // allocator Delete() function.
   // See RawAnimation::Validate() for more details about failure reasons.
   Animation* operator()(const RawAnimation& _raw_animation) const;
+
+  // Format of built animation rotation keys.
+  // Animation::kRotationPacked format requires 8 bytes per key instead of 12,
+  // at the cost of a lower precision: quaternion components are quantized
+  // with an error lower than 7e-4, and key times with an error lower than
+  // duration / 131070 (see PackedRotationKey). Keys of a track that would
+  // share the same quantized time are removed.
+  Animation::RotationFormat rotation_format;
+
+  // Format of built animation key times.
+  // Animation::kTimeQuantized format stores translation, scale and standard
+  // rotation key times on 16 bits instead of 32, as a ratio of the animation
+  // duration. Keys then require 10 bytes instead of 12, and time quantization
+  // error is lower than duration / 131070. Keys of a track that would share
+  // the same quantized time are removed.
+  Animation::TimeFormat time_format;
 };
 }  // offline
 }  // animation
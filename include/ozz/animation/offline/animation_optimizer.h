@@ -29,6 +29,10 @@
 #define OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_OPTIMIZER_H_
 
 namespace ozz {
+
+// Forward declare task scheduler type.
+class TaskScheduler;
+
 namespace animation {
 
 // Forward declare runtime skeleton type.
@@ -46,6 +50,36 @@ class AnimationOptimizer {
   // Initializes the optimizer with default tolerances (favoring quality).
   AnimationOptimizer();
 
+  // Declares key frames reduction algorithms. Both only remove keys that can
+  // be interpolated from the remaining ones within tolerances.
+  enum Reduction {
+    // Extends a segment of keys one key at a time, validating all its
+    // intermediate keys at every step. Cost is quadratic with the length of
+    // segments, hence the number of keys of smooth tracks.
+    kReductionGreedy,
+
+    // Extends a segment of keys by doubling its length while its intermediate
+    // keys are valid, then binary searches the longest valid segment. Cost
+    // is O(n log n) for a track of n keys, but the longest valid segment can
+    // be missed as validity isn't monotonic, leaving a few more keys.
+    kReductionBisect,
+  };
+
+  // Declares how the error of removing keys is evaluated.
+  enum Error {
+    // Compares values to each track tolerance, and approximates the error
+    // along the joint hierarchy from the maximum length and scale of child
+    // joints (see hierarchical_tolerance). This is conservative.
+    kErrorHierarchical,
+
+    // Compares values to each track tolerance, and measures the actual
+    // model-space position error of the joint and all its descendants, at
+    // every key frame time of the animation. The error must remain below
+    // hierarchical_tolerance. This removes more keys, but requires to store
+    // model-space matrices of all joints at every key frame time.
+    kErrorModelSpace,
+  };
+
   // Optimizes _input using *this parameters. _skeleton is required to evaluate
   // optimization error along joint hierarchy (see hierarchical_tolerance).
   // Returns true on success and fills _output_animation with the optimized
@@ -72,6 +106,18 @@ class AnimationOptimizer {
   // (distance) that an optimization on a joint is allowed to generate on its
   // whole child hierarchy.
   float hierarchical_tolerance;
+
+  // Key frames reduction algorithm. Default is kReductionGreedy.
+  Reduction reduction;
+
+  // Error evaluation mode. Default is kErrorHierarchical.
+  Error error;
+
+  // Optional scheduler used to optimize animation tracks concurrently, as
+  // independent tasks. If NULL, tracks are optimized sequentially from the
+  // calling thread. The output is the same in both cases. kErrorModelSpace
+  // mode optimizes tracks sequentially, as joints depend on their parents.
+  TaskScheduler* scheduler;
 };
 }  // offline
 }  // animation
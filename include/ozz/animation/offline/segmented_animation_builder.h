@@ -0,0 +1,79 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_SEGMENTED_ANIMATION_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_SEGMENTED_ANIMATION_BUILDER_H_
+
+#include "ozz/animation/runtime/animation.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime segmented animation type.
+class SegmentedAnimation;
+
+namespace offline {
+
+// Forward declares the offline animation type.
+struct RawAnimation;
+
+// Defines the class responsible of building runtime segmented animation
+// instances from offline raw animations.
+// The raw animation is split in segments of segment_duration seconds. Every
+// segment is built as an independent runtime Animation with the
+// AnimationBuilder. First and last keys of every segment are computed by
+// interpolating the raw animation at segment bounds, so that sampling a
+// segment gives the same result as sampling the whole animation. Because
+// rotations are normalized-lerped, the intermediate rotation key inserted at a
+// segment bound can induce a tiny error though.
+// No optimization is performed on the data at all.
+class SegmentedAnimationBuilder {
+ public:
+  // Initializes the builder with default segment duration.
+  SegmentedAnimationBuilder();
+
+  // Creates a SegmentedAnimation based on _raw_animation and *this builder
+  // parameters.
+  // Returns a valid SegmentedAnimation on success, with all its segments
+  // resident. The returned animation must be deleted using the default
+  // allocator Delete() function.
+  // Returns NULL on failure. See RawAnimation::Validate() for more details
+  // about failure reasons. Segment duration must also be greater than 0.
+  SegmentedAnimation* operator()(const RawAnimation& _raw_animation) const;
+
+  // Duration of a segment in seconds.
+  float segment_duration;
+
+  // Formats of segments rotation keys and key times, see AnimationBuilder.
+  // Quantized times are relative to every segment duration.
+  Animation::RotationFormat rotation_format;
+  Animation::TimeFormat time_format;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_SEGMENTED_ANIMATION_BUILDER_H_
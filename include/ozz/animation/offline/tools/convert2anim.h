@@ -49,6 +49,20 @@ class AnimationConverter {
 
  private:
 
+  // Imports _file and outputs all its animations to _animation file(s).
+  // Returns the number of successfully exported animations in _exported.
+  bool Convert(const char* _file,
+               const char* _animation,
+               const ozz::animation::Skeleton& _skeleton,
+               int* _exported);
+
+  // Converts all input files listed in _manifest, concurrently if possible.
+  // Outputs a summary report once all files are converted.
+  bool ConvertBatch(const char* _manifest,
+                    const ozz::animation::Skeleton& _skeleton);
+
+  // Imports all animations from _filename. Calls are serialized, so
+  // implementations don't need to be thread safe, even in batch mode.
   virtual bool Import(const char* _filename,
                       const ozz::animation::Skeleton& _skeleton,
                       float _sampling_rate,
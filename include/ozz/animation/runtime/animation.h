@@ -41,7 +41,38 @@ namespace offline { class AnimationBuilder; }
 // Forward declaration of key frame's type.
 struct TranslationKey;
 struct RotationKey;
+struct PackedRotationKey;
 struct ScaleKey;
+struct QuantizedTranslationKey;
+struct QuantizedRotationKey;
+struct QuantizedScaleKey;
+struct ConstantTranslation;
+struct ConstantRotation;
+struct ConstantScale;
+
+// Declares the seek table of a key frames buffer.
+// A seek table stores snapshots of the left and right keys of every track, as
+// they are when a SamplingCache cursor reaches a given position in the sorted
+// key frames buffer. Seek points are spaced by SeekTable::interval keys, the
+// first one being located right after the first two keys of every track.
+// This allows the cache to jump to any time in O(log n), rather than walking
+// all the keys from the beginning of the buffer.
+// Seek tables are computed when the animation is built or loaded. They are
+// only serialized by in-place archives.
+struct SeekTable {
+  // Seek point's times. A seek point is valid for any time greater or equal to
+  // its time. Times are sorted in ascending order, and are expressed in the
+  // same unit as the keys they index, which is quantized time for quantized
+  // and packed keys (see Animation::TimeFormat).
+  ozz::Range<float> times;
+
+  // Left and right key indices of every track, for every seek point.
+  ozz::Range<int> keys;
+
+  // Number of keys between two consecutive seek points, that is
+  // Animation::kSeekInterval keys per track.
+  int interval;
+};
 
 // Defines a runtime skeletal animation clip.
 // The runtime animation data structure stores animation keyframes, for all the
@@ -53,9 +84,30 @@ struct ScaleKey;
 // joints order of the runtime skeleton structure. In order to optimize cache
 // coherency when sampling the animation, Keyframes in this array are sorted by
 // time, then by track number.
+// Constant tracks, whose value never changes, aren't stored as key frames. They
+// are stored once in separate compact buffers, so that memory and sampling
+// cost only scale with the number of animated tracks. Key frames track number
+// is then an index in the buffer of animated tracks of the same type (see
+// translation_tracks()), rather than a joint index.
 class Animation {
  public:
 
+  // Declares rotation key formats. The format is chosen per animation, when
+  // it's built (see offline::AnimationBuilder::rotation_format).
+  enum RotationFormat {
+    kRotationStandard,  // RotationKey, 12 bytes per key.
+    kRotationPacked,  // PackedRotationKey, 8 bytes per key, lower precision.
+  };
+
+  // Declares key time formats. The format is chosen per animation, when it's
+  // built (see offline::AnimationBuilder::time_format). It applies to
+  // translation, scale and standard rotation keys, packed rotation keys
+  // always use quantized times.
+  enum TimeFormat {
+    kTimeFloat,  // Float times, 12 bytes per key.
+    kTimeQuantized,  // 16 bits quantized times, 10 bytes per key.
+  };
+
   // Builds a default animation.
   Animation();
 
@@ -83,21 +135,109 @@ class Animation {
     return name_ ? name_ : "";
   }
 
+  // Gets the format of key times, which tells which of float time or quantized
+  // time buffers store animation translation, rotation and scale keys. The
+  // other ones are empty.
+  TimeFormat time_format() const {
+    return time_format_;
+  }
+
   // Gets the buffer of translations keys.
   ozz::Range<const TranslationKey> translations() const {
     return translations_;
   }
 
+  // Gets the buffer of quantized time translations keys.
+  ozz::Range<const QuantizedTranslationKey> quantized_translations() const {
+    return quantized_translations_;
+  }
+
+  // Gets the format of rotation keys, which tells which of rotations() or
+  // packed_rotations() buffer stores animation rotation keys. The other one is
+  // empty.
+  RotationFormat rotation_format() const {
+    return rotation_format_;
+  }
+
   // Gets the buffer of rotation keys.
   ozz::Range<const RotationKey> rotations() const {
     return rotations_;
   }
 
+  // Gets the buffer of quantized time rotation keys.
+  ozz::Range<const QuantizedRotationKey> quantized_rotations() const {
+    return quantized_rotations_;
+  }
+
+  // Gets the buffer of packed rotation keys.
+  ozz::Range<const PackedRotationKey> packed_rotations() const {
+    return packed_rotations_;
+  }
+
   // Gets the buffer of scale keys.
   ozz::Range<const ScaleKey> scales() const {
     return scales_;
   }
 
+  // Gets the buffer of quantized time scale keys.
+  ozz::Range<const QuantizedScaleKey> quantized_scales() const {
+    return quantized_scales_;
+  }
+
+  // Gets the joint index of every animated translation, rotation and scale
+  // track, sorted in ascending order. Key frames track member indexes these
+  // buffers. Joints that aren't listed have a constant value instead.
+  ozz::Range<const uint16_t> translation_tracks() const {
+    return translation_tracks_;
+  }
+  ozz::Range<const uint16_t> rotation_tracks() const {
+    return rotation_tracks_;
+  }
+  ozz::Range<const uint16_t> scale_tracks() const {
+    return scale_tracks_;
+  }
+
+  // Returns the number of SoA elements matching the number of animated
+  // translation, rotation and scale tracks. Key frame buffers store keys for
+  // this number of SoA tracks.
+  int num_soa_translation_tracks() const {
+    return static_cast<int>(translation_tracks_.Count() + 3) / 4;
+  }
+  int num_soa_rotation_tracks() const {
+    return static_cast<int>(rotation_tracks_.Count() + 3) / 4;
+  }
+  int num_soa_scale_tracks() const {
+    return static_cast<int>(scale_tracks_.Count() + 3) / 4;
+  }
+
+  // Gets the buffers of constant translation, rotation and scale tracks,
+  // sorted by joint index. Their values are applied as is when sampling,
+  // without any interpolation. Soa padding joints are constant identity
+  // tracks, unless all the tracks of a type are animated.
+  ozz::Range<const ConstantTranslation> constant_translations() const {
+    return constant_translations_;
+  }
+  ozz::Range<const ConstantRotation> constant_rotations() const {
+    return constant_rotations_;
+  }
+  ozz::Range<const ConstantScale> constant_scales() const {
+    return constant_scales_;
+  }
+
+  // Gets the seek tables of translation, rotation and scale keys.
+  const SeekTable& translations_seek_table() const {
+    return translations_seek_table_;
+  }
+  const SeekTable& rotations_seek_table() const {
+    return rotations_seek_table_;
+  }
+  const SeekTable& scales_seek_table() const {
+    return scales_seek_table_;
+  }
+
+  // Number of keys per animated track between two consecutive seek points.
+  enum { kSeekInterval = 8 };
+
   // Get the estimated animation's size in bytes.
   size_t size() const;
 
@@ -106,6 +246,18 @@ class Animation {
   void Save(ozz::io::OArchive& _archive) const;
   void Load(ozz::io::IArchive& _archive, uint32_t _version);
 
+  // In-place serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators,
+  // using io::MakeInPlace(animation) wrapper. In-place archives store native
+  // endian and aligned data (seek tables included), which are used directly
+  // from the stream memory if the stream supports it (see io::Stream::Map), or
+  // copied otherwise. In the first case, the stream must outlive the
+  // animation.
+  // Loading fails, leaving the animation empty, if the archive isn't native
+  // endian or if it was saved with a different memory layout.
+  void SaveInPlace(ozz::io::OArchive& _archive) const;
+  void LoadInPlace(ozz::io::IArchive& _archive, uint32_t _version);
+
  protected:
  private:
 
@@ -116,11 +268,43 @@ class Animation {
   // AnimationBuilder class is allowed to instantiate an Animation.
   friend class offline::AnimationBuilder;
 
-  // Internal destruction function.
-  void Allocate(size_t _name_len, size_t _translation_count,
-                size_t _rotation_count, size_t _scale_count);
+  // Defines the number of elements of every buffer, used to allocate an
+  // animation. Key counts are the number of keys of rotation_format_ and
+  // time_format_ formats, which must be set. The number of animated tracks of
+  // each type is deduced from the number of constant ones.
+  struct Counts {
+    size_t name_len;
+    size_t translations;
+    size_t rotations;
+    size_t scales;
+    size_t constant_translations;
+    size_t constant_rotations;
+    size_t constant_scales;
+  };
+
+  // Internal allocation/destruction functions.
+  void Allocate(const Counts& _counts);
   void Deallocate();
 
+  // Computes the size of the single buffer that stores all keys, constants,
+  // tracks, seek tables and name. num_tracks_ must be set.
+  size_t ComputeBufferSize(const Counts& _counts) const;
+
+  // Distributes _buffer memory to keys, constants, tracks, seek tables and
+  // name.
+  void FixUp(char* _buffer, const Counts& _counts);
+
+  // Gets the counts of *this animation buffers.
+  Counts GetCounts() const;
+
+  // Fills animated tracks buffers with the joints that don't have a constant
+  // value. Constants must be filled and sorted by joint index.
+  void BuildTracks();
+
+  // Computes seek tables from translation, rotation and scale keys. Keys must
+  // be filled and sorted.
+  void BuildSeekTables();
+
   // Duration of the animation clip.
   float duration_;
 
@@ -131,16 +315,51 @@ class Animation {
   // Animation name.
   char* name_;
 
+  // Format of rotation keys, selects packed_rotations_ buffer.
+  RotationFormat rotation_format_;
+
+  // Format of key times, selects quantized_* buffers.
+  TimeFormat time_format_;
+
   // Stores all translation/rotation/scale keys begin and end of buffers.
+  // packed_rotations_ buffer is distributed first, so its begin is always the
+  // beginning of the allocated buffer.
+  ozz::Range<PackedRotationKey> packed_rotations_;
   ozz::Range<TranslationKey> translations_;
   ozz::Range<RotationKey> rotations_;
   ozz::Range<ScaleKey> scales_;
+  ozz::Range<QuantizedTranslationKey> quantized_translations_;
+  ozz::Range<QuantizedRotationKey> quantized_rotations_;
+  ozz::Range<QuantizedScaleKey> quantized_scales_;
+
+  // Stores constant translation/rotation/scale tracks.
+  ozz::Range<ConstantTranslation> constant_translations_;
+  ozz::Range<ConstantRotation> constant_rotations_;
+  ozz::Range<ConstantScale> constant_scales_;
+
+  // Stores joint indices of animated translation/rotation/scale tracks.
+  ozz::Range<uint16_t> translation_tracks_;
+  ozz::Range<uint16_t> rotation_tracks_;
+  ozz::Range<uint16_t> scale_tracks_;
+
+  // Seek tables of translation/rotation/scale keys.
+  SeekTable translations_seek_table_;
+  SeekTable rotations_seek_table_;
+  SeekTable scales_seek_table_;
+
+  // True if animation's buffer is used in place from a stream memory, in which
+  // case it isn't owned by the animation.
+  bool in_place_;
 };
 }  // animation
 
 namespace io {
-OZZ_IO_TYPE_VERSION(4, animation::Animation)
+OZZ_IO_TYPE_VERSION(7, animation::Animation)
 OZZ_IO_TYPE_TAG("ozz-animation", animation::Animation)
+
+// In-place version must be bumped whenever Animation memory layout changes.
+OZZ_IO_TYPE_VERSION(4, io::InPlace<animation::Animation>)
+OZZ_IO_TYPE_TAG("ozz-animation_in_place", io::InPlace<animation::Animation>)
 }  // io
 }  // ozz
 #endif  // OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_H_
@@ -37,6 +37,10 @@ namespace math { struct SoaTransform; }
 
 namespace animation {
 
+// Forward declares the animation and the cache used by the SamplingBlendingJob.
+class Animation;
+class SamplingCache;
+
 // Blends multiple input layer/postures to a single output. The number of
 // transforms/joints blended by the job is defined by the number of transforms
 // of the bind pose (note that this is a SoA format). This means that all
@@ -99,6 +103,8 @@ struct BlendingJob {
     // Negative weight values are considered as 0, but positive ones aren't
     // clamped because they could exceed 1.f if all layers contains valid joint
     // weights.
+    // Soa joints whose 4 weights are 0 (or less) are skipped by the job, so
+    // masking out large parts of a skeleton makes partial blending cheaper.
     Range<const math::SimdFloat4> joint_weights;
   };
 
@@ -129,6 +135,93 @@ struct BlendingJob {
   // transforms defined by the bind pose buffer size will be processed.
   Range<ozz::math::SoaTransform> output;
 };
+
+// Samples and blends multiple animation layers to a single output. The result
+// is the same as sampling every layer with a SamplingJob, then blending them
+// with a BlendingJob, but without any intermediate posture buffer: soa joints
+// are processed by small blocks, every layer being sampled to a block buffer
+// that is blended to the output while it's still in cache.
+// Layers that don't contribute to the output (weight <= 0 for blend layers,
+// weight == 0 for additive layers) are skipped entirely, they are neither
+// sampled nor blended.
+// Partial blending, additive blending and threshold follow BlendingJob rules.
+// The number of transforms/joints processed by the job is defined by the
+// number of transforms of the bind pose. Every layer animation must have at
+// least this number of soa tracks.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct SamplingBlendingJob {
+  // Default constructor, initializes default values.
+  SamplingBlendingJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if layer range is not valid (can be empty though).
+  // -if additive layer range is not valid (can be empty though).
+  // -if any layer animation or cache is NULL.
+  // -if any layer animation has less soa tracks than the bind pose buffer.
+  // -if any layer cache is too small for its animation.
+  // -if output range is not valid.
+  // -if output or any layer joint weights buffer is smaller than the bind pose
+  // buffer.
+  // -if the threshold value is less than or equal to 0.f.
+  bool Validate() const;
+
+  // Runs job's sampling and blending task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Defines a layer of animation to sample and its blending parameters.
+  struct Layer {
+    // Default constructor, initializes default values.
+    Layer();
+
+    // Blending weight of this layer, see BlendingJob::Layer::weight.
+    float weight;
+
+    // The animation to sample.
+    const Animation* animation;
+
+    // A cache object that must be big enough to sample the animation. Every
+    // layer must use its own cache.
+    SamplingCache* cache;
+
+    // Time used to sample the animation, clamped in range [0,duration] before
+    // job execution.
+    float time;
+
+    // Optional range [begin,end[ of blending weight for each joint in this
+    // layer, see BlendingJob::Layer::joint_weights. Joints whose weights are
+    // all 0 for a whole block of joints aren't sampled.
+    Range<const math::SimdFloat4> joint_weights;
+  };
+
+  // The job blends the bind pose to the output when the accumulated weight of
+  // all layers is less than this threshold value.
+  // Must be greater than 0.f.
+  float threshold;
+
+  // Job input layers, can be empty or NULL.
+  // The range of layers that must be sampled and blended.
+  Range<const Layer> layers;
+
+  // Job input additive layers, can be empty or NULL.
+  // The range of layers that must be sampled and added to the output.
+  Range<const Layer> additive_layers;
+
+  // The skeleton bind pose. The size of this buffer defines the number of
+  // transforms to sample and blend.
+  Range<const ozz::math::SoaTransform> bind_pose;
+
+  // Job output.
+  // The range of output transforms to be filled with blended layer
+  // transforms during job execution.
+  // Must be at least as big as the bind pose buffer, but only the number of
+  // transforms defined by the bind pose buffer size will be processed.
+  Range<ozz::math::SoaTransform> output;
+};
 }  // animation
 }  // ozz
 #endif  // OZZ_OZZ_ANIMATION_RUNTIME_BLENDING_JOB_H_
@@ -29,6 +29,7 @@
 #define OZZ_OZZ_ANIMATION_RUNTIME_LOCAL_TO_MODEL_JOB_H_
 
 #include "ozz/base/platform.h"
+#include "ozz/animation/runtime/skeleton.h"
 
 namespace ozz {
 
@@ -38,9 +39,6 @@ namespace math { struct Float4x4; }
 
 namespace animation {
 
-// Forward declares the Skeleton object used to describe joint hierarchy.
-class Skeleton;
-
 // Computes model-space joint matrices from local-space SoaTransform.
 // This job uses the skeleton to define joints parent-child hierarchy. The job
 // iterates through all joints to compute their transform relatively to the
@@ -50,14 +48,32 @@ class Skeleton;
 // ordered like skeleton's joints. Output are matrices, because the combination
 // of affine transformations can contain shearing or complex transformation
 // that cannot be represented as Transform object.
+// The job can be restricted to a range of joints [from, to[, so that the
+// joint hierarchy can be split across multiple jobs (and threads). Joints of a
+// range are processed in order, and model-space matrices of their parents that
+// are outside of the range are read from the output, meaning they must have
+// been computed beforehand. See PartitionJoints() from skeleton_utils.h, which
+// partitions a skeleton in ranges that can be processed concurrently.
+// The job can also be restricted to the subtrees of a root joint and/or of
+// dirty joints, in which case only those joints and their descendants are
+// updated. This allows to refresh model-space matrices after modifying a few
+// local-space transforms (IK, attachments...), at a fraction of a full update
+// cost. Matrices of the other joints are read from the output when required.
 struct LocalToModelJob {
   // Default constructor, initializes default values.
   LocalToModelJob() :
-    skeleton(NULL) {
+    skeleton(NULL),
+    from(0),
+    to(Skeleton::kMaxJoints),
+    root(Skeleton::kNoParentIndex) {
   }
 
   // Validates job parameters. Returns true for a valid job, or false otherwise:
   // -if any input pointer, including ranges, is NULL.
+  // -if from is negative or greater than to.
+  // -if root isn't a valid joint index, nor Skeleton::kNoParentIndex.
+  // -if dirty isn't empty and its size is smaller than the number of words
+  // required to store a bit per skeleton joint.
   // -if the size of the input is smaller than the skeleton's number of joints.
   // Note that this input has a SoA format.
   // -if the size of of the output is smaller than the skeleton's number of
@@ -74,6 +90,20 @@ struct LocalToModelJob {
   // model space conversion.
   const Skeleton* skeleton;
 
+  // Range of joints [from, to[ to process. to is clamped to the number of
+  // joints of the skeleton, so default values process the whole hierarchy.
+  int from;
+  int to;
+
+  // Restricts the update to root joint and its descendants. Default
+  // Skeleton::kNoParentIndex value doesn't restrict the update.
+  int root;
+
+  // Bitset of dirty joints, where joint i is stored as bit (i & 31) of word
+  // i / 32. If not empty, the update is restricted to dirty joints and their
+  // descendants (as well as root subtree if root is also specified).
+  Range<const uint32_t> dirty;
+
   // Job input.
   // The input range that store local transforms.
   Range<const ozz::math::SoaTransform> input;
@@ -48,8 +48,9 @@ class SamplingCache;
 // SamplingJob uses a cache (aka SamplingCache) to store intermediate values
 // (decompressed animation keyframes...) while sampling. This cache also stores
 // pre-computed values that allows drastic optimization while playing/sampling
-// the animation forward. Backward sampling works, but isn't optimized through
-// the cache.
+// the animation forward. Backward and random-access sampling (rewind,
+// scrubbing...) use animation's seek tables to jump to the requested time,
+// rather than invalidating the cache.
 // The job does not owned the buffers (in/output) and will thus not delete them
 // during job's destruction.
 struct SamplingJob {
@@ -59,6 +60,7 @@ struct SamplingJob {
   // Validates job parameters. Returns true for a valid job, or false otherwise:
   // -if any input pointer is NULL
   // -if output range is invalid.
+  // -if soa_joints_mask range is too small, or begin is NULL and end isn't.
   bool Validate() const;
 
   // Runs job's sampling task.
@@ -77,6 +79,14 @@ struct SamplingJob {
   // A cache object that must be big enough to sample *this animation.
   SamplingCache* cache;
 
+  // Optional mask of the soa joints to sample, one bit per soa joint: soa
+  // joint i is sampled if bit (i & 7) of byte i / 8 is set. It must be big
+  // enough to store a bit per animation soa track. Key frames of masked out
+  // joints are neither decompressed nor interpolated, and their output
+  // SoaTransform are left unchanged. All joints are sampled if begin is NULL.
+  // The mask can change from a run to the next, the cache remains valid.
+  Range<const uint8_t> soa_joints_mask;
+
   // Job output.
   // The output range to be filled with sampled joints during job execution.
   // If there are less joints in the animation compared to the output range,
@@ -86,6 +96,58 @@ struct SamplingJob {
   Range<ozz::math::SoaTransform> output;
 };
 
+// Samples a single animation for a batch of instances (characters) that play
+// this animation at different times, outputting each instance's posture in
+// local-space.
+// All instances share a single SamplingCache, so key frames lookup and
+// decompression are done once for the whole batch: when instances are sorted
+// by ascending time, moving from an instance to the next one only updates the
+// cache entries whose key frames changed in-between, and instances whose key
+// frame windows coincide only pay for the interpolation. Unsorted instances are
+// still sampled correctly, but the cache then needs to seek backward.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct BatchSamplingJob {
+  // Default constructor, initializes default values.
+  BatchSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input pointer is NULL
+  // -if instances range is invalid.
+  // -if any instance output range is invalid.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Defines an instance to sample.
+  struct Instance {
+    // Default constructor, initializes default values.
+    Instance();
+
+    // Time used to sample animation for this instance, clamped in range
+    // [0,duration] before job execution.
+    float time;
+
+    // The output range to be filled with sampled joints during job execution.
+    // Follows the same rules as SamplingJob::output.
+    Range<ozz::math::SoaTransform> output;
+  };
+
+  // The animation to sample, shared by all instances.
+  const Animation* animation;
+
+  // A cache object that must be big enough to sample *this animation. It is
+  // shared by all the instances of the batch.
+  SamplingCache* cache;
+
+  // Instances to sample, processed in order.
+  Range<const Instance> instances;
+};
+
 namespace internal {
   // Soa hot data to interpolate.
   struct InterpSoaTranslation;
@@ -108,7 +170,7 @@ class SamplingCache {
   // Invalidate the cache.
   // The SamplingJob automatically invalidates a cache when required
   // during sampling. This automatic mechanism is based on the animation
-  // address and sampling time. The weak point is that it can result in a
+  // address. The weak point is that it can result in a
   // crash if ever the address of an animation is used again with another
   // animation (could be the result of successive call to delete / new).
   // Therefore it is recommended to manually invalidate a cache when it is
@@ -126,19 +188,36 @@ class SamplingCache {
   void operator=(SamplingCache const&);
 
   friend struct SamplingJob;
-
-  // Steps the cache in order to use it for a potentially new animation and
-  // time. If the _animation is different from the animation currently cached,
-  // or if the _time shows that the animation is played backward, then the
-  // cache is invalidated and reseted for the new _animation and _time.
-  void Step(const Animation& _animation, float _time);
+  friend struct BatchSamplingJob;
+  friend struct SamplingBlendingJob;
+
+  // Steps the cache in order to use it for a potentially new animation. If the
+  // _animation is different from the animation currently cached, then the
+  // cache is invalidated and reseted for the new _animation.
+  void Step(const Animation& _animation);
+
+  // Fetches key frames from _animation at _time, and updates outdated soa
+  // hot data accordingly. If the cache state is ahead of _time (backward
+  // sampling), or far behind it, then the cache seeks to _time using
+  // _animation seek tables. Step() must have been called before.
+  // Only soa tracks of the soa joints enabled by _soa_joints_mask are
+  // decompressed, others remain outdated. All are if _soa_joints_mask is NULL.
+  void Update(const Animation& _animation, float _time,
+              const uint8_t* _soa_joints_mask);
+
+  // Interpolates soa hot data at _time, and outputs soa joints
+  // [_soa_begin,_soa_end[ of _animation to _output, which stores soa joints
+  // from _soa_begin. Soa joints that _soa_joints_mask disables, if not NULL,
+  // are left unchanged. Update() must have been called for _time before, with
+  // the same mask.
+  void Interpolate(const Animation& _animation, float _time,
+                   int _soa_begin, int _soa_end,
+                   const uint8_t* _soa_joints_mask,
+                   math::SoaTransform* _output) const;
 
   // The animation this cache refers to. NULL means that the cache is invalid.
   const Animation* animation_;
 
-  // The current time in the animation.
-  float time_;
-
   // The number of soa tracks that can store this cache.
   int max_soa_tracks_;
 
@@ -161,6 +240,12 @@ class SamplingCache {
   unsigned char* outdated_translations_;
   unsigned char* outdated_rotations_;
   unsigned char* outdated_scales_;
+
+  // Soa entries enabled by the last Update() soa joints mask. One bit per soa
+  // entry, only used if a mask was provided.
+  unsigned char* translations_mask_;
+  unsigned char* rotations_mask_;
+  unsigned char* scales_mask_;
 };
 }  // animation
 }  // ozz
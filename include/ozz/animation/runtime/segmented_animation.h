@@ -0,0 +1,180 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SEGMENTED_ANIMATION_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SEGMENTED_ANIMATION_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/io/archive_traits.h"
+
+namespace ozz {
+namespace io { class IArchive; class OArchive; class Stream; }
+namespace animation {
+
+// Forward declares the SegmentedAnimationBuilder, used to instantiate a
+// SegmentedAnimation.
+namespace offline { class SegmentedAnimationBuilder; }
+
+// Forward declares the animation type of a segment.
+class Animation;
+
+// Defines a runtime skeletal animation clip whose keyframes are split in fixed
+// duration segments, so that only the segments around the current playback
+// time need to be resident in memory. This is aimed to be used for long
+// animations (cinematics...).
+// Every segment is a complete runtime Animation, covering the time range
+// [index * segment_duration, (index + 1) * segment_duration] of the clip. This
+// range is remapped to [0, segment duration] in the segment, which includes its
+// own first and last keys. Segments are thus independent from each other and
+// can be sampled by a SamplingJob. See Resolve() function.
+// When a SegmentedAnimation is loaded from an archive, only its header is
+// read. Segments are then loaded (and unloaded) on demand by Update() function,
+// from the stream the animation was loaded from. This stream must thus remain
+// opened as long as segments are streamed.
+class SegmentedAnimation {
+ public:
+
+  // Builds a default segmented animation, with no segment.
+  SegmentedAnimation();
+
+  // Declares the public non-virtual destructor.
+  ~SegmentedAnimation();
+
+  // Gets the animation clip duration.
+  float duration() const {
+    return duration_;
+  }
+
+  // Gets the number of animated tracks.
+  int num_tracks() const {
+    return num_tracks_;
+  }
+
+  // Returns the number of SoA elements matching the number of tracks of *this
+  // animation. This value is useful to allocate SoA runtime data structures.
+  int num_soa_tracks() const {
+    return (num_tracks_ + 3) / 4;
+  }
+
+  // Gets animation name.
+  const char* name() const {
+    return name_ ? name_ : "";
+  }
+
+  // Gets the duration of a segment. The last segment can be longer or shorter
+  // as it ends at animation duration.
+  float segment_duration() const {
+    return segment_duration_;
+  }
+
+  // Gets the number of segments.
+  int num_segments() const {
+    return static_cast<int>(segments_.Count());
+  }
+
+  // Gets the index of the segment used to sample the animation at time _time.
+  // _time is clamped in range [0,duration].
+  int segment_index(float _time) const;
+
+  // Gets segment at index _index if it's resident, NULL otherwise.
+  const Animation* segment(int _index) const;
+
+  // Gets the segment used to sample the animation at time _time, which can be
+  // used as a SamplingJob input, along with _segment_time output that is the
+  // time to use to sample this segment.
+  // Returns NULL if this segment isn't resident, see Update().
+  const Animation* Resolve(float _time, float* _segment_time) const;
+
+  // Streams in the segment used to sample the animation at time _time, and the
+  // _look_ahead following segments. All other segments are streamed out.
+  // Nothing is streamed out if the animation wasn't loaded from a stream, as
+  // segments couldn't be streamed in again.
+  // If _streamed_out isn't NULL, it's set to true if any segment was streamed
+  // out, false otherwise. A segment streamed in later can reuse the address of
+  // a streamed out one, which SamplingCache can't detect. SamplingCache used
+  // to sample segments must thus be invalidated (SamplingCache::Invalidate())
+  // when segments are streamed out.
+  // Returns false if a segment couldn't be loaded.
+  bool Update(float _time, int _look_ahead = 1, bool* _streamed_out = NULL);
+
+  // Get the estimated animation's size in bytes, including resident segments.
+  size_t size() const;
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  // Saving requires all segments to be resident. Loading only reads animation
+  // header, segments are loaded on demand from _archive stream.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+
+  // Disables copy and assignation.
+  SegmentedAnimation(SegmentedAnimation const&);
+  void operator=(SegmentedAnimation const&);
+
+  // SegmentedAnimationBuilder class is allowed to instantiate a
+  // SegmentedAnimation.
+  friend class offline::SegmentedAnimationBuilder;
+
+  // Internal allocation/deallocation functions.
+  void Allocate(size_t _name_len, size_t _num_segments);
+  void Deallocate();
+
+  // Loads segment _index from the stream, if it's not already resident.
+  bool LoadSegment(int _index);
+
+  // Duration of the animation clip.
+  float duration_;
+
+  // Duration of a segment.
+  float segment_duration_;
+
+  // The number of joint tracks.
+  int num_tracks_;
+
+  // Animation name.
+  char* name_;
+
+  // Resident segments, NULL for segments that aren't resident.
+  ozz::Range<Animation*> segments_;
+
+  // Segments position in the stream, followed by the end of the last segment,
+  // so that segment i data are in range [offsets_[i], offsets_[i + 1][.
+  ozz::Range<int> offsets_;
+
+  // The stream the animation was loaded from, used to stream in segments.
+  ozz::io::Stream* stream_;
+};
+}  // animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::SegmentedAnimation)
+OZZ_IO_TYPE_TAG("ozz-segmented_animation", animation::SegmentedAnimation)
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SEGMENTED_ANIMATION_H_
@@ -120,6 +120,17 @@ class Skeleton {
   void Save(ozz::io::OArchive& _archive) const;
   void Load(ozz::io::IArchive& _archive, uint32_t _version);
 
+  // In-place serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators,
+  // using io::MakeInPlace(skeleton) wrapper. In-place archives store native
+  // endian and aligned data, which are used directly from the stream memory if
+  // the stream supports it (see io::Stream::Map), or copied otherwise. In the
+  // first case, the stream must outlive the skeleton.
+  // Loading fails, leaving the skeleton empty, if the archive isn't native
+  // endian or if it was saved with a different memory layout.
+  void SaveInPlace(ozz::io::OArchive& _archive) const;
+  void LoadInPlace(ozz::io::IArchive& _archive, uint32_t _version);
+
  private:
 
   // Disables copy and assignation.
@@ -145,12 +156,20 @@ class Skeleton {
 
   // Stores the name of every joint in an array of c-strings.
   Range<char*> joint_names_;
+
+  // True if skeleton's data are used in place from a stream memory, in which
+  // case only joint_names_ array is owned by the skeleton.
+  bool in_place_;
 };
 }  // animation
 
 namespace io {
 OZZ_IO_TYPE_VERSION(1, animation::Skeleton)
 OZZ_IO_TYPE_TAG("ozz-skeleton", animation::Skeleton)
+
+// In-place version must be bumped whenever Skeleton memory layout changes.
+OZZ_IO_TYPE_VERSION(1, io::InPlace<animation::Skeleton>)
+OZZ_IO_TYPE_TAG("ozz-skeleton_in_place", io::InPlace<animation::Skeleton>)
 }  // io
 }  // ozz
 #endif  // OZZ_OZZ_ANIMATION_RUNTIME_SKELETON_H_
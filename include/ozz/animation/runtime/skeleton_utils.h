@@ -82,6 +82,49 @@ inline _Fct IterateJointsDF(const Skeleton& _skeleton, int _from, _Fct _fct) {
   }
   return _fct;
 }
+
+// Defines the structure filled by PartitionJoints with joint ranges that can be
+// processed concurrently. ranges and stages buffers are provided by the user,
+// and aren't owned by the partition.
+struct JointsPartition {
+  // Default constructor, initializes an empty partition.
+  JointsPartition() :
+    num_ranges(0),
+    num_stages(0) {
+  }
+
+  // A range of joints [from, to[.
+  struct JointRange {
+    uint16_t from;
+    uint16_t to;
+  };
+
+  // Joint ranges, sorted by stage. Buffer must be big enough to store a range
+  // per skeleton joint.
+  Range<JointRange> ranges;
+  int num_ranges;
+
+  // Index of the first range of each stage, stages[num_stages] being
+  // num_ranges. Ranges of stage i are [stages[i], stages[i + 1][. Buffer must
+  // be big enough to store the number of skeleton joints + 1 indices.
+  Range<uint16_t> stages;
+  int num_stages;
+};
+
+// Partitions _skeleton joints in stages of contiguous joint ranges. Ranges of a
+// stage are independent of each other: every joint parent is either in a
+// previous stage, or in the same range. Stages must be processed in order,
+// while ranges of a stage can be processed concurrently, for example with
+// LocalToModelJob from and to members.
+// _grain is the maximum number of joints of a range. A smaller grain exposes
+// more parallelism, at the cost of more stages and ranges.
+// Partition only depends on the joint hierarchy, so it can be computed once per
+// skeleton.
+// Returns false if _partition buffers are too small for _skeleton, in which
+// case the partition is left empty.
+bool PartitionJoints(const Skeleton& _skeleton,
+                     int _grain,
+                     JointsPartition* _partition);
 }  // animation
 }  // ozz
 #endif  // OZZ_OZZ_ANIMATION_RUNTIME_SKELETON_UTILS_H_
@@ -0,0 +1,97 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SKINNING_MATRICES_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SKINNING_MATRICES_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration math structures.
+namespace math { struct SoaFloat4x4; }
+namespace math { struct Float4x4; }
+
+namespace animation {
+
+// Computes skinning matrices, aka the multiplication of model-space joint
+// matrices (output of the LocalToModelJob) by inverse bind-pose matrices.
+// Inverse bind-poses are provided as an array of soa matrices, built once with
+// PackInverseBindPoses (usually when the mesh is loaded). Model matrices are
+// transposed to soa by batches of 4, so that the multiplication is done with
+// soa math, and the result is transposed back to output matrices.
+// The job can output skinning matrices for a subset of the skeleton joints,
+// using an optional remapping table: output matrix i is then computed from
+// model matrix joint_remaps[i] and inverse bind-pose i. This allows to only
+// compute the joints actually referenced by a mesh (or mesh part).
+// The number of skinning matrices computed is the size of the output range.
+struct SkinningMatricesJob {
+  // Default constructor, initializes default values.
+  SkinningMatricesJob() {
+  }
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input or output range is NULL.
+  // -if inverse_bind_poses size is smaller than the number of soa elements
+  // required to store the output size.
+  // -if joint_remaps isn't empty and its size is smaller than the output size,
+  // or if any of its indices is out of the models range.
+  // -if joint_remaps is empty and models size is smaller than the output size.
+  bool Validate() const;
+
+  // Runs job's skinning matrices task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // Model-space joint matrices, as output by the LocalToModelJob.
+  Range<const math::Float4x4> models;
+
+  // Inverse bind-pose matrices, packed as soa matrices with
+  // PackInverseBindPoses.
+  Range<const math::SoaFloat4x4> inverse_bind_poses;
+
+  // Optional remapping table, from output (and inverse bind-pose) index to
+  // models index.
+  Range<const uint16_t> joint_remaps;
+
+  // Job output.
+  // The output range to be filled with skinning matrices.
+  Range<math::Float4x4> output;
+};
+
+// Packs _inverse_bind_poses matrices to soa matrices, as expected by the
+// SkinningMatricesJob. _output size must be at least
+// (_inverse_bind_poses.Count() + 3) / 4. Padding matrices of the last soa
+// element are set to identity.
+// Returns false if _output is too small.
+bool PackInverseBindPoses(Range<const math::Float4x4> _inverse_bind_poses,
+                          Range<math::SoaFloat4x4> _output);
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SKINNING_MATRICES_JOB_H_
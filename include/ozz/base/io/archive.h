@@ -45,6 +45,12 @@
 // helper function ozz::io::MakeArray() that is then streamed in or out using
 // << and >> archive operators: archive << ozz::io::MakeArray(my_array, count);
 //
+// Objects that support it can also be saved/loaded "in place" with the helper
+// function ozz::io::MakeInPlace(). In-place data are written with the native
+// memory layout and alignment, so that they can be used directly from the
+// stream memory when loading (see Stream::Map()), without any copy. This is
+// typically used with ozz::io::MappedFile to load memory mapped data.
+//
 // Versioning can be done using OZZ_IO_TYPE_VERSION macros. Type version
 // is saved in the OArchive, and is given back to Load functions to allow to
 // manually handle version modifications. Versioning can be disabled using
@@ -392,6 +398,53 @@ OZZ_INLINE const internal::Array<const _Ty> MakeArray(
   return array;
 }
 
+// Wrapper for in-place serialization.
+// Must be used through ozz::io::MakeInPlace.
+// The wrapped type _Ty must implement "void SaveInPlace(OArchive&) const" and
+// "void LoadInPlace(IArchive&, uint32_t _version)" intrusive functions, and
+// declare the version (and optionally the tag) of InPlace<_Ty> type, which
+// must be bumped whenever _Ty in-place memory layout changes.
+template <typename _Ty>
+struct InPlace {
+  OZZ_INLINE void Save(OArchive& _archive) const {
+    object->SaveInPlace(_archive);
+  }
+  OZZ_INLINE void Load(IArchive& _archive, uint32_t _version) const {
+    object->LoadInPlace(_archive, _version);
+  }
+  _Ty* object;
+};
+
+namespace internal {
+// InPlace of a const _Ty shares InPlace of _Ty version and tag.
+template <typename _Ty> struct Version<const InPlace<const _Ty> > {
+  enum { kValue = Version<const InPlace<_Ty> >::kValue };
+};
+template <typename _Ty> struct Tag<const InPlace<const _Ty> >
+    : public Tag<const InPlace<_Ty> > {
+};
+}  // internal
+
+// Utility function that instantiates InPlace wrapper.
+template <typename _Ty>
+OZZ_INLINE const InPlace<_Ty> MakeInPlace(_Ty& _object) {
+  const InPlace<_Ty> in_place = {&_object};
+  return in_place;
+}
+template <typename _Ty>
+OZZ_INLINE const InPlace<const _Ty> MakeInPlace(const _Ty& _object) {
+  const InPlace<const _Ty> in_place = {&_object};
+  return in_place;
+}
+
+// Writes 0 padding bytes to _archive stream, until stream position is aligned
+// on _alignment bytes, which must be a power of 2.
+void PadInPlace(OArchive& _archive, size_t _alignment);
+
+// Skips _archive stream bytes until stream position is aligned on _alignment
+// bytes, which must be a power of 2. Returns false if the stream is too short.
+bool PadInPlace(IArchive& _archive, size_t _alignment);
+
 namespace internal {
 // Specialisation of the Tagger helper for tagged types.
 template<typename _Ty>
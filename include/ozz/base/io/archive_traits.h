@@ -40,6 +40,10 @@ namespace io {
 class OArchive;
 class IArchive;
 
+// Forward declaration of in-place serialization wrapper, so that in-place
+// versions and tags can be declared without including archive.h.
+template <typename _Ty> struct InPlace;
+
 // Default loading and saving external declaration.
 // Those template implementations aim to be specialized at compilation time by
 // non-member Load and save functions. For example the specialization of the
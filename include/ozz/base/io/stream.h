@@ -30,6 +30,8 @@
 
 // Provides Stream interface used to read/write a memory buffer or a file with
 // Crt fread/fwrite/fseek/ftell like functions.
+// Some streams (MemoryStream, MappedFile) also provide direct access to their
+// content, see Stream::Map().
 
 #include "ozz/base/platform.h"
 
@@ -74,6 +76,17 @@ class Stream {
   // Returns the current size of the stream.
   virtual size_t Size() const = 0;
 
+  // Gets direct access to the _size bytes following the position indicator of
+  // the stream, without copying them. The position indicator of the stream is
+  // advanced by _size bytes. The returned memory is read-only, and remains
+  // valid as long as the stream is neither modified nor destroyed.
+  // Returns NULL if the stream doesn't support direct access (which is the
+  // default implementation), or if less than _size bytes remain, in which case
+  // the position indicator isn't modified.
+  virtual const void* Map(size_t /*_size*/) {
+    return NULL;
+  }
+
  protected:
 
   // Required virtual destructor.
@@ -127,8 +140,64 @@ class File : public Stream {
   void* file_;
 };
 
+// Implements a read-only Stream of type File, whose content is memory mapped.
+// The file is mapped once at construction time, so that its content can be
+// accessed in place with MappedFile::Map(). Pages are only loaded by the system
+// when they are first accessed.
+// Mapped memory is aligned on a page boundary, so it's aligned for any type.
+class MappedFile : public Stream {
+ public:
+  // Maps the whole file at path _filename for reading.
+  // Use opened() function to test opening result. Note that an empty file
+  // cannot be mapped.
+  explicit MappedFile(const char* _filename);
+
+  // Unmaps the file if it is opened.
+  virtual ~MappedFile();
+
+  // Unmaps the file if it is opened.
+  void Close();
+
+  // See Stream::opened for details.
+  virtual bool opened() const;
+
+  // See Stream::Read for details.
+  virtual size_t Read(void* _buffer, size_t _size);
+
+  // MappedFile is read-only, so this function always returns 0.
+  virtual size_t Write(const void* _buffer, size_t _size);
+
+  // See Stream::Seek for details. MappedFile cannot be sought beyond its end.
+  virtual int Seek(int _offset, Origin _origin);
+
+  // See Stream::Tell for details.
+  virtual int Tell() const;
+
+  // See Stream::Tell for details.
+  virtual size_t Size() const;
+
+  // See Stream::Map for details.
+  virtual const void* Map(size_t _size);
+
+ private:
+  // Disallow copy and assignment.
+  MappedFile(const MappedFile&);
+  void operator=(const MappedFile&);
+
+  // Begin of the mapped memory, NULL if the file isn't opened.
+  const char* data_;
+
+  // Size of the mapped memory, which is the size of the file.
+  int size_;
+
+  // The cursor position in the mapped memory.
+  int tell_;
+};
+
 // Implements an in-memory Stream. Allows to use a memory buffer as a Stream.
 // The opening mode is equivalent to fopen w+b (binary read/write).
+// The memory buffer is aligned on a 16 bytes boundary, so it can be mapped
+// (MemoryStream::Map()) to any type that does not require a bigger alignment.
 class MemoryStream : public Stream {
  public:
   // Construct an empty memory stream opened in w+b mode.
@@ -155,6 +224,9 @@ class MemoryStream : public Stream {
   // See Stream::Tell for details.
   virtual size_t Size() const;
 
+  // See Stream::Map for details.
+  virtual const void* Map(size_t _size);
+
  private:
 
   // Resizes buffers size to _size bytes. If _size is less than the actual
@@ -165,6 +237,9 @@ class MemoryStream : public Stream {
   // Size of the buffer increment.
   static const size_t kBufferSizeIncrement;
 
+  // Alignment of the buffer.
+  static const size_t kBufferAlignment;
+
   // Maximum stream size.
   static const size_t kMaxSize;
 
@@ -35,6 +35,12 @@
 #if !defined(OZZ_BUILD_SIMD_REF)
 
 // Try to match a SSE2+ version.
+#if defined(__AVX2__) || defined(OZZ_SIMD_AVX2)
+#include <immintrin.h>
+#define OZZ_SIMD_AVX2
+#define OZZ_SIMD_AVX  // AVX is available if AVX2 is.
+#endif
+
 #if defined(__AVX__) || defined(OZZ_SIMD_AVX)
 #include <immintrin.h> 
 #define OZZ_SIMD_AVX
@@ -140,4 +146,43 @@ typedef const SimdInt4& _SimdInt4;
 }  // ozz
 
 #endif  // OZZ_SIMD_x
+
+// Declares the 8 wide simd float vector, which is native when AVX is available,
+// or emulated with two SimdFloat4 otherwise.
+#if defined(OZZ_SIMD_AVX)
+
+namespace ozz {
+namespace math {
+
+// Vector of eight floating point values.
+typedef __m256 SimdFloat8;
+
+// Argument type for SimdFloat8.
+typedef const __m256 _SimdFloat8;
+}  // math
+}  // ozz
+
+#else  // OZZ_SIMD_AVX
+
+// Declares emulated simd float vector outside of ozz::math, in order to match
+// native implementation details (operators are declared in global namespace).
+
+// Vector of eight floating point values, made of two SimdFloat4.
+struct SimdFloat8Def {
+  ozz::math::SimdFloat4 lo;
+  ozz::math::SimdFloat4 hi;
+};
+
+namespace ozz {
+namespace math {
+
+// Vector of eight floating point values.
+typedef SimdFloat8Def SimdFloat8;
+
+// Argument type for SimdFloat8.
+typedef const SimdFloat8& _SimdFloat8;
+}  // math
+}  // ozz
+
+#endif  // OZZ_SIMD_AVX
 #endif  // OZZ_OZZ_BASE_MATHS_INTERNAL_SIMD_MATH_CONFIG_H_
@@ -0,0 +1,290 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MATHS_SIMD_MATH_WIDE_H_
+#define OZZ_OZZ_BASE_MATHS_SIMD_MATH_WIDE_H_
+
+// Declares SimdFloat8 functions. SimdFloat8 is a vector of eight floating point
+// values, implemented with a native AVX register when available, or emulated
+// with two SimdFloat4 otherwise. It aims at processing two 4 wide soa elements
+// at once, hence loading and storing functions work with pairs of SimdFloat4.
+
+#include "ozz/base/platform.h"
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+namespace math {
+namespace simd_float8 {
+// Returns a SimdFloat8 vector with all components set to 0.
+OZZ_INLINE SimdFloat8 zero();
+
+// Returns a SimdFloat8 vector with all components set to 1.
+OZZ_INLINE SimdFloat8 one();
+
+// Loads _x to the all the components of the returned vector.
+OZZ_INLINE SimdFloat8 Load1(float _x);
+
+// Loads _lo to the 4 lower components of the returned vector, and _hi to the 4
+// higher ones.
+OZZ_INLINE SimdFloat8 Load(_SimdFloat4 _lo, _SimdFloat4 _hi);
+}  // simd_float8
+
+// Returns the 4 lower components of _v.
+OZZ_INLINE SimdFloat4 GetLow(_SimdFloat8 _v);
+
+// Returns the 4 higher components of _v.
+OZZ_INLINE SimdFloat4 GetHigh(_SimdFloat8 _v);
+
+// Returns the per element multiplication of _a and _b, added to _addend.
+OZZ_INLINE SimdFloat8 MAdd(_SimdFloat8 _a, _SimdFloat8 _b, _SimdFloat8 _addend);
+
+// Returns the per element estimated reciprocal of _v.
+OZZ_INLINE SimdFloat8 RcpEst(_SimdFloat8 _v);
+
+// Returns the per element estimated reciprocal square root of _v, improved with
+// one Newton-Raphson step.
+OZZ_INLINE SimdFloat8 RSqrtEstNR(_SimdFloat8 _v);
+
+// Returns the per element maximum of _v and 0.
+OZZ_INLINE SimdFloat8 Max0(_SimdFloat8 _v);
+
+// Returns the sign bit of each component of _v, all other bits being 0.
+OZZ_INLINE SimdFloat8 Sign(_SimdFloat8 _v);
+
+// Returns per element binary xor operation of _a and _b.
+OZZ_INLINE SimdFloat8 Xor(_SimdFloat8 _a, _SimdFloat8 _b);
+}  // math
+}  // ozz
+
+#if !defined(__GNUC__) || !defined(OZZ_SIMD_AVX)
+// Returns per element addition of _a and _b.
+OZZ_INLINE ozz::math::SimdFloat8 operator+(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b);
+
+// Returns per element subtraction of _a and _b.
+OZZ_INLINE ozz::math::SimdFloat8 operator-(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b);
+
+// Returns per element negation of _v.
+OZZ_INLINE ozz::math::SimdFloat8 operator-(ozz::math::_SimdFloat8 _v);
+
+// Returns per element multiplication of _a and _b.
+OZZ_INLINE ozz::math::SimdFloat8 operator*(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b);
+
+// Returns per element division of _a and _b.
+OZZ_INLINE ozz::math::SimdFloat8 operator/(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b);
+#endif  // !defined(__GNUC__) || !defined(OZZ_SIMD_AVX)
+
+#if defined(OZZ_SIMD_AVX)
+
+namespace ozz {
+namespace math {
+namespace simd_float8 {
+OZZ_INLINE SimdFloat8 zero() {
+  return _mm256_setzero_ps();
+}
+
+OZZ_INLINE SimdFloat8 one() {
+  return _mm256_set1_ps(1.f);
+}
+
+OZZ_INLINE SimdFloat8 Load1(float _x) {
+  return _mm256_set1_ps(_x);
+}
+
+OZZ_INLINE SimdFloat8 Load(_SimdFloat4 _lo, _SimdFloat4 _hi) {
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_lo), _hi, 1);
+}
+}  // simd_float8
+
+OZZ_INLINE SimdFloat4 GetLow(_SimdFloat8 _v) {
+  return _mm256_castps256_ps128(_v);
+}
+
+OZZ_INLINE SimdFloat4 GetHigh(_SimdFloat8 _v) {
+  return _mm256_extractf128_ps(_v, 1);
+}
+
+OZZ_INLINE SimdFloat8 MAdd(
+  _SimdFloat8 _a, _SimdFloat8 _b, _SimdFloat8 _addend) {
+  return _mm256_add_ps(_mm256_mul_ps(_a, _b), _addend);
+}
+
+OZZ_INLINE SimdFloat8 RcpEst(_SimdFloat8 _v) {
+  return _mm256_rcp_ps(_v);
+}
+
+OZZ_INLINE SimdFloat8 RSqrtEstNR(_SimdFloat8 _v) {
+  const __m256 nr = _mm256_rsqrt_ps(_v);
+  // Do one more Newton-Raphson step to improve precision.
+  const __m256 muls = _mm256_mul_ps(_mm256_mul_ps(_v, nr), nr);
+  return _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(.5f), nr),
+                       _mm256_sub_ps(_mm256_set1_ps(3.f), muls));
+}
+
+OZZ_INLINE SimdFloat8 Max0(_SimdFloat8 _v) {
+  return _mm256_max_ps(_mm256_setzero_ps(), _v);
+}
+
+OZZ_INLINE SimdFloat8 Sign(_SimdFloat8 _v) {
+  return _mm256_and_ps(_v, _mm256_set1_ps(-0.f));
+}
+
+OZZ_INLINE SimdFloat8 Xor(_SimdFloat8 _a, _SimdFloat8 _b) {
+  return _mm256_xor_ps(_a, _b);
+}
+}  // math
+}  // ozz
+
+#if !defined(__GNUC__)
+OZZ_INLINE ozz::math::SimdFloat8 operator+(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  return _mm256_add_ps(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator-(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  return _mm256_sub_ps(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator-(ozz::math::_SimdFloat8 _v) {
+  return _mm256_sub_ps(_mm256_setzero_ps(), _v);
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator*(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  return _mm256_mul_ps(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator/(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  return _mm256_div_ps(_a, _b);
+}
+#endif  // !defined(__GNUC__)
+
+#else  // OZZ_SIMD_AVX
+
+// Emulates SimdFloat8 functions with SimdFloat4 ones, applied to both the low
+// and the high halves.
+namespace ozz {
+namespace math {
+namespace simd_float8 {
+OZZ_INLINE SimdFloat8 zero() {
+  const SimdFloat8 r = {simd_float4::zero(), simd_float4::zero()};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 one() {
+  const SimdFloat8 r = {simd_float4::one(), simd_float4::one()};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 Load1(float _x) {
+  const SimdFloat8 r = {simd_float4::Load1(_x), simd_float4::Load1(_x)};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 Load(_SimdFloat4 _lo, _SimdFloat4 _hi) {
+  const SimdFloat8 r = {_lo, _hi};
+  return r;
+}
+}  // simd_float8
+
+OZZ_INLINE SimdFloat4 GetLow(_SimdFloat8 _v) {
+  return _v.lo;
+}
+
+OZZ_INLINE SimdFloat4 GetHigh(_SimdFloat8 _v) {
+  return _v.hi;
+}
+
+OZZ_INLINE SimdFloat8 MAdd(
+  _SimdFloat8 _a, _SimdFloat8 _b, _SimdFloat8 _addend) {
+  const SimdFloat8 r = {MAdd(_a.lo, _b.lo, _addend.lo),
+                        MAdd(_a.hi, _b.hi, _addend.hi)};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 RcpEst(_SimdFloat8 _v) {
+  const SimdFloat8 r = {RcpEst(_v.lo), RcpEst(_v.hi)};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 RSqrtEstNR(_SimdFloat8 _v) {
+  const SimdFloat8 r = {RSqrtEstNR(_v.lo), RSqrtEstNR(_v.hi)};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 Max0(_SimdFloat8 _v) {
+  const SimdFloat8 r = {Max0(_v.lo), Max0(_v.hi)};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 Sign(_SimdFloat8 _v) {
+  const SimdFloat8 r = {And(_v.lo, Sign(_v.lo)), And(_v.hi, Sign(_v.hi))};
+  return r;
+}
+
+OZZ_INLINE SimdFloat8 Xor(_SimdFloat8 _a, _SimdFloat8 _b) {
+  const SimdFloat8 r = {Xor(_a.lo, _b.lo), Xor(_a.hi, _b.hi)};
+  return r;
+}
+}  // math
+}  // ozz
+
+OZZ_INLINE ozz::math::SimdFloat8 operator+(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  const ozz::math::SimdFloat8 r = {_a.lo + _b.lo, _a.hi + _b.hi};
+  return r;
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator-(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  const ozz::math::SimdFloat8 r = {_a.lo - _b.lo, _a.hi - _b.hi};
+  return r;
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator-(ozz::math::_SimdFloat8 _v) {
+  const ozz::math::SimdFloat8 r = {-_v.lo, -_v.hi};
+  return r;
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator*(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  const ozz::math::SimdFloat8 r = {_a.lo * _b.lo, _a.hi * _b.hi};
+  return r;
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator/(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  const ozz::math::SimdFloat8 r = {_a.lo / _b.lo, _a.hi / _b.hi};
+  return r;
+}
+#endif  // OZZ_SIMD_AVX
+#endif  // OZZ_OZZ_BASE_MATHS_SIMD_MATH_WIDE_H_
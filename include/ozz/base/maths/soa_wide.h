@@ -0,0 +1,282 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MATHS_SOA_WIDE_H_
+#define OZZ_OZZ_BASE_MATHS_SOA_WIDE_H_
+
+// Declares 8 wide soa types, based on SimdFloat8. Each of them is loaded from
+// and split back to two 4 wide soa objects (SoaFloat3, SoaQuaternion...), so
+// they can be used to process two consecutive soa elements at once without
+// changing data layout. They only implement the subset of operations required
+// by runtime jobs.
+
+#include "ozz/base/platform.h"
+#include "ozz/base/maths/simd_math_wide.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/soa_quaternion.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace math {
+
+struct WideSoaFloat3 {
+  SimdFloat8 x, y, z;
+
+  // Loads _lo to the 4 lower lanes, and _hi to the 4 higher ones.
+  static OZZ_INLINE WideSoaFloat3 Load(const SoaFloat3& _lo,
+                                       const SoaFloat3& _hi) {
+    const WideSoaFloat3 r = {simd_float8::Load(_lo.x, _hi.x),
+                             simd_float8::Load(_lo.y, _hi.y),
+                             simd_float8::Load(_lo.z, _hi.z)};
+    return r;
+  }
+};
+
+struct WideSoaFloat4 {
+  SimdFloat8 x, y, z, w;
+
+  // Loads _lo to the 4 lower lanes, and _hi to the 4 higher ones.
+  static OZZ_INLINE WideSoaFloat4 Load(const SoaFloat4& _lo,
+                                       const SoaFloat4& _hi) {
+    const WideSoaFloat4 r = {simd_float8::Load(_lo.x, _hi.x),
+                             simd_float8::Load(_lo.y, _hi.y),
+                             simd_float8::Load(_lo.z, _hi.z),
+                             simd_float8::Load(_lo.w, _hi.w)};
+    return r;
+  }
+};
+
+struct WideSoaQuaternion {
+  SimdFloat8 x, y, z, w;
+
+  // Loads _lo to the 4 lower lanes, and _hi to the 4 higher ones.
+  static OZZ_INLINE WideSoaQuaternion Load(const SoaQuaternion& _lo,
+                                           const SoaQuaternion& _hi) {
+    const WideSoaQuaternion r = {simd_float8::Load(_lo.x, _hi.x),
+                                 simd_float8::Load(_lo.y, _hi.y),
+                                 simd_float8::Load(_lo.z, _hi.z),
+                                 simd_float8::Load(_lo.w, _hi.w)};
+    return r;
+  }
+};
+
+struct WideSoaTransform {
+  WideSoaFloat3 translation;
+  WideSoaQuaternion rotation;
+  WideSoaFloat3 scale;
+
+  // Loads _lo to the 4 lower lanes, and _hi to the 4 higher ones.
+  static OZZ_INLINE WideSoaTransform Load(const SoaTransform& _lo,
+                                          const SoaTransform& _hi) {
+    const WideSoaTransform r = {
+      WideSoaFloat3::Load(_lo.translation, _hi.translation),
+      WideSoaQuaternion::Load(_lo.rotation, _hi.rotation),
+      WideSoaFloat3::Load(_lo.scale, _hi.scale)};
+    return r;
+  }
+};
+
+struct WideSoaFloat4x4 {
+  // Soa matrix columns, see SoaFloat4x4.
+  WideSoaFloat4 cols[4];
+
+  // Returns the affine transformation matrix built from split translation,
+  // rotation (quaternion) and scale. See SoaFloat4x4::FromAffine.
+  static OZZ_INLINE WideSoaFloat4x4 FromAffine(
+    const WideSoaFloat3& _translation,
+    const WideSoaQuaternion& _quaternion,
+    const WideSoaFloat3& _scale) {
+    const SimdFloat8 zero = simd_float8::zero();
+    const SimdFloat8 one = simd_float8::one();
+    const SimdFloat8 two = one + one;
+
+    const SimdFloat8 xx = _quaternion.x * _quaternion.x;
+    const SimdFloat8 xy = _quaternion.x * _quaternion.y;
+    const SimdFloat8 xz = _quaternion.x * _quaternion.z;
+    const SimdFloat8 xw = _quaternion.x * _quaternion.w;
+    const SimdFloat8 yy = _quaternion.y * _quaternion.y;
+    const SimdFloat8 yz = _quaternion.y * _quaternion.z;
+    const SimdFloat8 yw = _quaternion.y * _quaternion.w;
+    const SimdFloat8 zz = _quaternion.z * _quaternion.z;
+    const SimdFloat8 zw = _quaternion.z * _quaternion.w;
+
+    const WideSoaFloat4x4 ret = {{{_scale.x * (one - two * (yy + zz)),
+                                   _scale.x * two * (xy + zw),
+                                   _scale.x * two * (xz - yw),
+                                   zero},
+                                  {_scale.y * two * (xy - zw),
+                                   _scale.y * (one - two * (xx + zz)),
+                                   _scale.y * two * (yz + xw),
+                                   zero},
+                                  {_scale.z * two * (xz + yw),
+                                   _scale.z * two * (yz - xw),
+                                   _scale.z * (one - two * (xx + yy)),
+                                   zero},
+                                  {_translation.x,
+                                   _translation.y,
+                                   _translation.z,
+                                   one}}};
+    return ret;
+  }
+};
+
+// Returns the 4 lower lanes of _v.
+OZZ_INLINE SoaFloat3 GetLow(const WideSoaFloat3& _v) {
+  const SoaFloat3 r = {GetLow(_v.x), GetLow(_v.y), GetLow(_v.z)};
+  return r;
+}
+
+// Returns the 4 higher lanes of _v.
+OZZ_INLINE SoaFloat3 GetHigh(const WideSoaFloat3& _v) {
+  const SoaFloat3 r = {GetHigh(_v.x), GetHigh(_v.y), GetHigh(_v.z)};
+  return r;
+}
+
+// Returns the 4 lower lanes of _v.
+OZZ_INLINE SoaFloat4 GetLow(const WideSoaFloat4& _v) {
+  const SoaFloat4 r = {
+    GetLow(_v.x), GetLow(_v.y), GetLow(_v.z), GetLow(_v.w)};
+  return r;
+}
+
+// Returns the 4 higher lanes of _v.
+OZZ_INLINE SoaFloat4 GetHigh(const WideSoaFloat4& _v) {
+  const SoaFloat4 r = {
+    GetHigh(_v.x), GetHigh(_v.y), GetHigh(_v.z), GetHigh(_v.w)};
+  return r;
+}
+
+// Returns the 4 lower lanes of _q.
+OZZ_INLINE SoaQuaternion GetLow(const WideSoaQuaternion& _q) {
+  const SoaQuaternion r = {
+    GetLow(_q.x), GetLow(_q.y), GetLow(_q.z), GetLow(_q.w)};
+  return r;
+}
+
+// Returns the 4 higher lanes of _q.
+OZZ_INLINE SoaQuaternion GetHigh(const WideSoaQuaternion& _q) {
+  const SoaQuaternion r = {
+    GetHigh(_q.x), GetHigh(_q.y), GetHigh(_q.z), GetHigh(_q.w)};
+  return r;
+}
+
+// Returns the 4 lower lanes of _t.
+OZZ_INLINE SoaTransform GetLow(const WideSoaTransform& _t) {
+  const SoaTransform r = {
+    GetLow(_t.translation), GetLow(_t.rotation), GetLow(_t.scale)};
+  return r;
+}
+
+// Returns the 4 higher lanes of _t.
+OZZ_INLINE SoaTransform GetHigh(const WideSoaTransform& _t) {
+  const SoaTransform r = {
+    GetHigh(_t.translation), GetHigh(_t.rotation), GetHigh(_t.scale)};
+  return r;
+}
+
+// Returns the 4 lower lanes of _m.
+OZZ_INLINE SoaFloat4x4 GetLow(const WideSoaFloat4x4& _m) {
+  const SoaFloat4x4 r = {{GetLow(_m.cols[0]), GetLow(_m.cols[1]),
+                          GetLow(_m.cols[2]), GetLow(_m.cols[3])}};
+  return r;
+}
+
+// Returns the 4 higher lanes of _m.
+OZZ_INLINE SoaFloat4x4 GetHigh(const WideSoaFloat4x4& _m) {
+  const SoaFloat4x4 r = {{GetHigh(_m.cols[0]), GetHigh(_m.cols[1]),
+                          GetHigh(_m.cols[2]), GetHigh(_m.cols[3])}};
+  return r;
+}
+
+// Returns the linear interpolation of _a and _b with coefficient _f.
+OZZ_INLINE WideSoaFloat3 Lerp(const WideSoaFloat3& _a,
+                              const WideSoaFloat3& _b,
+                              _SimdFloat8 _f) {
+  const WideSoaFloat3 r = {(_b.x - _a.x) * _f + _a.x,
+                           (_b.y - _a.y) * _f + _a.y,
+                           (_b.z - _a.z) * _f + _a.z};
+  return r;
+}
+
+// Returns the estimated normalized quaternion _q.
+OZZ_INLINE WideSoaQuaternion NormalizeEst(const WideSoaQuaternion& _q) {
+  const SimdFloat8 len2 =
+    _q.x * _q.x + _q.y * _q.y + _q.z * _q.z + _q.w * _q.w;
+  // Uses RSqrtEstNR (with one more Newton-Raphson step) as quaternions loose
+  // much precision due to normalization.
+  const SimdFloat8 inv_len = RSqrtEstNR(len2);
+  const WideSoaQuaternion r = {
+    _q.x * inv_len, _q.y * inv_len, _q.z * inv_len, _q.w * inv_len};
+  return r;
+}
+
+// Returns the estimated normalized linear interpolation of _a and _b with
+// coefficient _f.
+OZZ_INLINE WideSoaQuaternion NLerpEst(const WideSoaQuaternion& _a,
+                                      const WideSoaQuaternion& _b,
+                                      _SimdFloat8 _f) {
+  const WideSoaQuaternion lerp = {(_b.x - _a.x) * _f + _a.x,
+                                  (_b.y - _a.y) * _f + _a.y,
+                                  (_b.z - _a.z) * _f + _a.z,
+                                  (_b.w - _a.w) * _f + _a.w};
+  return NormalizeEst(lerp);
+}
+}  // math
+}  // ozz
+
+// Returns per element addition of _a and _b.
+OZZ_INLINE ozz::math::WideSoaFloat3 operator+(
+  const ozz::math::WideSoaFloat3& _a, const ozz::math::WideSoaFloat3& _b) {
+  const ozz::math::WideSoaFloat3 r = {_a.x + _b.x, _a.y + _b.y, _a.z + _b.z};
+  return r;
+}
+
+// Returns per element multiplication of _v and scalar value _f.
+OZZ_INLINE ozz::math::WideSoaFloat3 operator*(
+  const ozz::math::WideSoaFloat3& _v, ozz::math::_SimdFloat8 _f) {
+  const ozz::math::WideSoaFloat3 r = {_v.x * _f, _v.y * _f, _v.z * _f};
+  return r;
+}
+
+// Returns the addition of _a and _b.
+OZZ_INLINE ozz::math::WideSoaQuaternion operator+(
+  const ozz::math::WideSoaQuaternion& _a,
+  const ozz::math::WideSoaQuaternion& _b) {
+  const ozz::math::WideSoaQuaternion r = {
+    _a.x + _b.x, _a.y + _b.y, _a.z + _b.z, _a.w + _b.w};
+  return r;
+}
+
+// Returns the multiplication of _q and scalar value _f.
+OZZ_INLINE ozz::math::WideSoaQuaternion operator*(
+  const ozz::math::WideSoaQuaternion& _q, ozz::math::_SimdFloat8 _f) {
+  const ozz::math::WideSoaQuaternion r = {
+    _q.x * _f, _q.y * _f, _q.z * _f, _q.w * _f};
+  return r;
+}
+#endif  // OZZ_OZZ_BASE_MATHS_SOA_WIDE_H_
@@ -43,10 +43,12 @@ class Allocator;
 static const size_t kDefaultAlignment = 16;
 
 // Defines the default allocator accessor.
+// The default heap allocator is thread safe.
 Allocator* default_allocator();
 
 // Set the default allocator, used for all dynamic allocation inside ozz.
 // Returns current memory allocator, such that in can be restored if needed.
+// _allocator must be thread safe if ozz is used from concurrent threads.
 Allocator* SetDefaulAllocator(Allocator* _allocator);
 
 // Defines an abstract allocator class.
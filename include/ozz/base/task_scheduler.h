@@ -0,0 +1,51 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_TASK_SCHEDULER_H_
+#define OZZ_OZZ_BASE_TASK_SCHEDULER_H_
+
+namespace ozz {
+
+// Defines the interface of a task scheduler, used by ozz jobs and utilities to
+// run their tasks concurrently (see geometry::ParallelSkinningJob or
+// animation::offline::AnimationOptimizer). Application implements it on top of
+// its own threading system (thread pool, job system, OpenMP...).
+class TaskScheduler {
+ public:
+  // Task function type, _index being the index of the task to run, in range
+  // [0, _count[ (see Run).
+  typedef void (*TaskFct)(void* _user_data, int _index);
+
+  virtual ~TaskScheduler() {}
+
+  // Runs _count tasks, calling _fct for every task index, and returns once all
+  // of them are completed. Tasks are independent, so they can be run in any
+  // order, from any thread.
+  virtual void Run(TaskFct _fct, void* _user_data, int _count) = 0;
+};
+}  // ozz
+#endif  // OZZ_OZZ_BASE_TASK_SCHEDULER_H_
@@ -0,0 +1,167 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_DUAL_QUATERNION_SKINNING_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_DUAL_QUATERNION_SKINNING_JOB_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+namespace geometry {
+
+// Defines a unit dual quaternion, which represents a rigid transformation
+// (rotation and translation) with 8 floats, instead of the 16 of a matrix.
+// real is the rotation quaternion (x, y, z, w), and dual is half the
+// translation quaternion multiplied by real: .5 * t * real.
+struct DualQuaternion {
+  math::SimdFloat4 real;
+  math::SimdFloat4 dual;
+};
+
+// Builds a palette of skinning dual quaternions from model-space joint
+// matrices, as output by animation::LocalToModelJob, and inverse bind-pose
+// matrices. Each dual quaternion is the rigid part of the matrix
+// models[i] * inverse_bind_poses[i]. Scale is discarded, as dual quaternions
+// don't support it. A matrix whose rotation cannot be extracted (more than one
+// axis scaled to 0) outputs an identity rotation.
+struct DualQuaternionPaletteJob {
+  // Default constructor, initializes default values.
+  DualQuaternionPaletteJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if any range is invalid.
+  // - if inverse_bind_poses or output are smaller than models.
+  bool Validate() const;
+
+  // Runs palette building task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Model-space joint matrices, as output by animation::LocalToModelJob.
+  Range<const math::Float4x4> models;
+
+  // Inverse bind-pose model-space matrices, one per model matrix.
+  Range<const math::Float4x4> inverse_bind_poses;
+
+  // Output dual quaternions palette, one per model matrix.
+  Range<DualQuaternion> output;
+};
+
+// Provides dual quaternion skinning of vertices.
+// This job implements the same interface as SkinningJob, but joint
+// transformations are provided as a palette of unit dual quaternions (see
+// DualQuaternionPaletteJob) rather than matrices. Joint dual quaternions are
+// blended according to vertex weights, and the normalized result is applied to
+// positions, normals and tangents. Compared to matrix palette skinning, this
+// halves the amount of palette data read per influence, and preserves volume
+// when joints twist (no "candy-wrapper" artifact). Only rigid transformations
+// are supported though, non-uniform or uniform scale can't be represented by
+// dual quaternions. Vectors (normals and tangents) are only rotated, so no
+// inverse transpose palette is needed.
+// Like SkinningJob, every variant (1 to 4 influences, or any number of
+// influences, with normals and tangents...) is implemented with a specialized
+// loop. See SkinningJob for input and output buffers description.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct DualQuaternionSkinningJob {
+  // Default constructor, initializes default values.
+  DualQuaternionSkinningJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if any range is invalid. See each range description.
+  // - if normals are provided but positions aren't.
+  // - if tangents are provided but normals aren't.
+  // - if no output is provided while an input is. For example, if input normals
+  // are provided, then output normals must also.
+  bool Validate() const;
+
+  // Runs job's skinning task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Number of vertices to transform. All input and output arrays must store at
+  // least this number of vertices.
+  int vertex_count;
+
+  // Maximum number of joints influencing each vertex. Must be greater than 0.
+  // Joint indices and weights are sampled the same way as SkinningJob's.
+  int influences_count;
+
+  // Array of unit dual quaternions for each joint. Joint are indexed through
+  // indices array.
+  Range<const DualQuaternion> joint_dual_quaternions;
+
+  // Array of joints indices, influences_count indices per vertex, and stride
+  // (number of bytes between each vertex).
+  Range<const uint16_t> joint_indices;
+  size_t joint_indices_stride;
+
+  // Array of joints weights, influences_count - 1 weights per vertex, and
+  // stride (number of bytes between each vertex). The weight for the last
+  // joint is restored at runtime, as the sum of the weights for each vertex is
+  // 1.
+  Range<const float> joint_weights;
+  size_t joint_weights_stride;
+
+  // Input vertex positions array (3 float values per vertex) and stride.
+  Range<const float> in_positions;
+  size_t in_positions_stride;
+
+  // Optional input vertex normals array (3 float values per vertex) and stride.
+  Range<const float> in_normals;
+  size_t in_normals_stride;
+
+  // Optional input vertex tangents array (3 float values per vertex) and
+  // stride. Tangents can only be provided with normals.
+  Range<const float> in_tangents;
+  size_t in_tangents_stride;
+
+  // Output vertex positions array (3 float values per vertex) and stride.
+  Range<float> out_positions;
+  size_t out_positions_stride;
+
+  // Output vertex normals array (3 float values per vertex) and stride,
+  // required if input normals are provided. As dual quaternions are rigid
+  // transformations, normals length is preserved.
+  Range<float> out_normals;
+  size_t out_normals_stride;
+
+  // Output vertex tangents array (3 float values per vertex) and stride,
+  // required if input tangents are provided.
+  Range<float> out_tangents;
+  size_t out_tangents_stride;
+};
+}  // geometry
+}  // ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_DUAL_QUATERNION_SKINNING_JOB_H_
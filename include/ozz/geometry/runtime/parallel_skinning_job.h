@@ -0,0 +1,84 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_PARALLEL_SKINNING_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_PARALLEL_SKINNING_JOB_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/task_scheduler.h"
+#include "ozz/geometry/runtime/skinning_job.h"
+
+namespace ozz {
+namespace geometry {
+
+// Skins a SkinningJob concurrently, splitting its vertices in ranges that are
+// run as independent tasks by a TaskScheduler. Every range is skinned by a
+// SkinningJob, so that results are exactly the same as the ones of the
+// SkinningJob::Run().
+// Ranges are made of a multiple of grain vertices, rounded up so that every
+// range output starts on a cache line boundary (if output buffers are aligned
+// on a cache line), preventing false sharing between concurrent tasks.
+// The job does not owned the buffers (in/output), nor the scheduler, and will
+// thus not delete them during job's destruction.
+struct ParallelSkinningJob {
+  // Default constructor, initializes default values.
+  ParallelSkinningJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if skinning job isn't valid. See SkinningJob::Validate().
+  // - if grain is less or equal to 0.
+  bool Validate() const;
+
+  // Runs job's skinning tasks, and returns once they are all completed.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Returns the number of vertices of each range, which is grain rounded up
+  // to a multiple of the cache line size. The last range can be smaller.
+  // Returns 0 if *this job is not valid.
+  int range_size() const;
+
+  // The skinning job to split, see SkinningJob for parameters description.
+  SkinningJob job;
+
+  // Minimum number of vertices of each task. Default value is 1024, big
+  // enough to amortize scheduling cost.
+  int grain;
+
+  // Scheduler used to run tasks. If NULL, tasks are run sequentially from
+  // the calling thread.
+  TaskScheduler* scheduler;
+
+  // Size in bytes of a cache line, used to align ranges.
+  static const int kCacheLineSize = 64;
+};
+}  // geometry
+}  // ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_PARALLEL_SKINNING_JOB_H_
@@ -77,6 +77,11 @@ struct SkinningJob {
   // Validates job parameters.
   // Returns true for a valid job, false otherwise:
   // - if any range is invalid. See each range description.
+  // - if joint indices aren't provided in one, and only one, of the supported
+  // formats (joint_indices or joint_indices8).
+  // - if influences_count is greater than 1 and joint weights aren't provided
+  // in one, and only one, of the supported formats (joint_weights,
+  // joint_weights16 or joint_weights8).
   // - if normals are provided but positions aren't.
   // - if tangents are provided but normals aren't.
   // - if no output is provided while an input is. For example, if input normals
@@ -122,6 +127,14 @@ struct SkinningJob {
   // Each vertex has influences_max number of indices, meaning that the size of
   // this array must be at least influences_max * vertex_count.
   Range<const uint16_t> joint_indices;
+
+  // Optional compact alternative to joint_indices, usable when there are at
+  // most 256 joints in the matrices palette. Only one of joint_indices and
+  // joint_indices8 shall be provided.
+  Range<const uint8_t> joint_indices8;
+
+  // Stride (number of bytes between each vertex) of the provided indices
+  // array, whatever its format.
   size_t joint_indices_stride;
 
   // Array of joints weights. This array is used to associate a weight to every
@@ -132,6 +145,16 @@ struct SkinningJob {
   // Each vertex has (influences_max - 1) number of weights, meaning that the
   // size of this array must be at least (influences_max - 1)* vertex_count.
   Range<const float> joint_weights;
+
+  // Optional compact alternatives to joint_weights, where weights are stored
+  // as unsigned normalized integers: [0, 65535] or [0, 255] maps to [0, 1].
+  // They are decoded to floats when skinning. Only one of joint_weights,
+  // joint_weights16 and joint_weights8 shall be provided.
+  Range<const uint16_t> joint_weights16;
+  Range<const uint8_t> joint_weights8;
+
+  // Stride (number of bytes between each vertex) of the provided weights
+  // array, whatever its format.
   size_t joint_weights_stride;
 
   // Input vertex positions array (3 float values per vertex) and stride (number
@@ -0,0 +1,144 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_SOA_SKINNING_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_SOA_SKINNING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math { struct Float4x4; struct SoaFloat3; }
+namespace geometry {
+
+// Provides matrix palette skinning of vertices packed in soa form.
+// This job implements the same algorithm as SkinningJob, but rather than
+// transforming one vertex per loop, it transforms packets of 4 vertices whose
+// positions, normals and tangents are stored as soa (math::SoaFloat3). Joint
+// matrices are gathered and transposed once per packet, and the weighted
+// matrix is built for 4 vertices at once. When the library is built with AVX
+// support, packets are processed by pairs (8 vertices per loop).
+// Soa buffers are usually built once, when the mesh is loaded, using
+// PackSoaVertices and PackSoaInfluences helpers. Skinned vertices can be
+// converted back to strided buffers using UnpackSoaVertices.
+// A mesh of vertex_count vertices is made of (vertex_count + 3) / 4 packets.
+// Padding vertices of the last packet are transformed like any other vertex,
+// which means that their joint indices must be valid.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct SoaSkinningJob {
+  // Default constructor, initializes default values.
+  SoaSkinningJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if any range is invalid or too small. See each range description.
+  // - if normals are provided but positions aren't.
+  // - if tangents are provided but normals aren't.
+  // - if joint_weights isn't aligned to 16 bytes.
+  // - if no output is provided while an input is. For example, if input normals
+  // are provided, then output normals must also.
+  bool Validate() const;
+
+  // Runs job's skinning task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Number of vertices to transform. All input and output arrays must store at
+  // least (vertex_count + 3) / 4 packets.
+  int vertex_count;
+
+  // Maximum number of joints influencing each vertex. Must be greater than 0.
+  int influences_count;
+
+  // Array of matrices for each joint. Joint are indexed through indices array.
+  Range<const math::Float4x4> joint_matrices;
+
+  // Optional array of inverse transposed matrices for each joint, used to
+  // transform normals and tangents. See SkinningJob for more details.
+  Range<const math::Float4x4> joint_inverse_transpose_matrices;
+
+  // Array of joints indices, influences_count * 4 indices per packet. For each
+  // packet, indices are stored influence by influence, 4 vertices each.
+  Range<const uint16_t> joint_indices;
+
+  // Array of joints weights, (influences_count - 1) * 4 weights per packet.
+  // For each packet, weights are stored influence by influence, 4 vertices
+  // each. Like SkinningJob, the weight of the last influence is restored at
+  // runtime. The array must be aligned to 16 bytes, so that weights of an
+  // influence can be loaded at once.
+  Range<const float> joint_weights;
+
+  // Input vertex positions, normals and tangents packets. Normals and tangents
+  // are optional.
+  Range<const math::SoaFloat3> in_positions;
+  Range<const math::SoaFloat3> in_normals;
+  Range<const math::SoaFloat3> in_tangents;
+
+  // Output vertex positions, normals and tangents packets. Like SkinningJob,
+  // output normals and tangents are not normalized.
+  Range<math::SoaFloat3> out_positions;
+  Range<math::SoaFloat3> out_normals;
+  Range<math::SoaFloat3> out_tangents;
+};
+
+// Packs _count vertices (3 floats each) from _in array, whose stride is
+// _in_stride bytes, to _out soa packets. The last packet is padded by repeating
+// the last vertex.
+// Returns false if _in or _out are too small.
+bool PackSoaVertices(Range<const float> _in,
+                     size_t _in_stride,
+                     int _count,
+                     Range<math::SoaFloat3> _out);
+
+// Unpacks _count vertices from _in soa packets to _out array, whose stride is
+// _out_stride bytes. This is the reverse operation of PackSoaVertices.
+// Returns false if _in or _out are too small.
+bool UnpackSoaVertices(Range<const math::SoaFloat3> _in,
+                       int _count,
+                       Range<float> _out,
+                       size_t _out_stride);
+
+// Packs joint indices and weights of _count vertices, with _influences_count
+// joints per vertex, to the SoaSkinningJob layout. Inputs follow SkinningJob
+// layout, with _indices_stride and _weights_stride bytes from a vertex to the
+// next. Weights are only needed if _influences_count is greater than 1.
+// _out_weights should be aligned to 16 bytes, as required by SoaSkinningJob.
+// The last packet is padded by repeating the last vertex.
+// Returns false if any range is too small.
+bool PackSoaInfluences(int _count,
+                       int _influences_count,
+                       Range<const uint16_t> _indices,
+                       size_t _indices_stride,
+                       Range<const float> _weights,
+                       size_t _weights_stride,
+                       Range<uint16_t> _out_indices,
+                       Range<float> _out_weights);
+}  // geometry
+}  // ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_SOA_SKINNING_JOB_H_
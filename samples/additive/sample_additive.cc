@@ -31,6 +31,7 @@
 #include "ozz/animation/runtime/blending_job.h"
 #include "ozz/animation/runtime/sampling_job.h"
 #include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skinning_matrices_job.h"
 
 #include "ozz/base/log.h"
 
@@ -39,6 +40,7 @@
 #include "ozz/base/maths/vec_float.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/soa_float4x4.h"
 
 #include "ozz/base/memory/allocator.h"
 
@@ -165,13 +167,13 @@ class AdditiveBlendSampleApplication : public ozz::sample::Application {
   // Samples animation, transforms to model space and renders.
   virtual bool OnDisplay(ozz::sample::Renderer* _renderer) {
 
-    // Update skinning matrices latest blending stage output.
-    assert(models_.Count() == skinning_matrices_.Count() &&
-           models_.Count() == mesh_.inverse_bind_poses.size());
-
     // Builds skinning matrices, based on the output of the animation stage.
-    for (size_t i = 0; i < models_.Count(); ++i) {
-      skinning_matrices_[i] = models_[i] * mesh_.inverse_bind_poses[i];
+    ozz::animation::SkinningMatricesJob skinning_matrices_job;
+    skinning_matrices_job.models = models_;
+    skinning_matrices_job.inverse_bind_poses = inverse_bind_poses_;
+    skinning_matrices_job.output = skinning_matrices_;
+    if (!skinning_matrices_job.Run()) {
+      return false;
     }
 
     // Renders skin.
@@ -203,6 +205,13 @@ class AdditiveBlendSampleApplication : public ozz::sample::Application {
       return false;
     }
 
+    // Packs mesh inverse bind poses to the soa format expected by the
+    // skinning matrices job.
+    inverse_bind_poses_ =
+      allocator->AllocateRange<ozz::math::SoaFloat4x4>(num_soa_joints);
+    ozz::animation::PackInverseBindPoses(
+      ozz::make_range(mesh_.inverse_bind_poses), inverse_bind_poses_);
+
     // Reading animations.
     const char* filenames[] = {
       OPTIONS_animation, OPTIONS_additive_animation};
@@ -290,6 +299,7 @@ class AdditiveBlendSampleApplication : public ozz::sample::Application {
     allocator->Deallocate(blended_locals_);
     allocator->Deallocate(models_);
     allocator->Deallocate(skinning_matrices_);
+    allocator->Deallocate(inverse_bind_poses_);
   }
 
   virtual bool OnGui(ozz::sample::ImGui* _im_gui) {
@@ -457,6 +467,9 @@ class AdditiveBlendSampleApplication : public ozz::sample::Application {
   // inverse bind pose with the model space matrix.
   ozz::Range<ozz::math::Float4x4> skinning_matrices_;
 
+  // Mesh inverse bind pose matrices, packed as soa matrices.
+  ozz::Range<ozz::math::SoaFloat4x4> inverse_bind_poses_;
+
   // The mesh used by the sample.
   ozz::sample::Mesh mesh_;
 
@@ -92,52 +92,35 @@ class BlendSampleApplication : public ozz::sample::Application {
       UpdateRuntimeParameters();
     }
 
-    // Updates and samples all animations to their respective local space
-    // transform buffers.
+    // Updates animations time.
     for (int i = 0; i < kNumLayers; ++i) {
       Sampler& sampler = samplers_[i];
-
-      // Updates animations time.
       sampler.controller.Update(sampler.animation, _dt);
-
-      // Early out if this sampler weight makes it irrelevant during blending.
-      if (samplers_[i].weight <= 0.f) {
-        continue;
-      }
-
-      // Setup sampling job.
-      ozz::animation::SamplingJob sampling_job;
-      sampling_job.animation = &sampler.animation;
-      sampling_job.cache = sampler.cache;
-      sampling_job.time = sampler.controller.time();
-      sampling_job.output = sampler.locals;
-
-      // Samples animation.
-      if (!sampling_job.Run()) {
-        return false;
-      }
     }
 
-    // Blends animations.
-    // Blends the local spaces transforms computed by sampling all animations
-    // (1st stage just above), and outputs the result to the local space
-    // transform buffer blended_locals_
+    // Samples and blends animations.
+    // Samples all animations and blends them in a single pass, outputting the
+    // result to the local space transform buffer blended_locals_. Layers
+    // whose weight makes them irrelevant during blending aren't sampled.
 
-    // Prepares blending layers.
-    ozz::animation::BlendingJob::Layer layers[kNumLayers];
+    // Prepares sampling and blending layers.
+    ozz::animation::SamplingBlendingJob::Layer layers[kNumLayers];
     for (int i = 0; i < kNumLayers; ++i) {
-      layers[i].transform = samplers_[i].locals;
-      layers[i].weight = samplers_[i].weight;
+      Sampler& sampler = samplers_[i];
+      layers[i].animation = &sampler.animation;
+      layers[i].cache = sampler.cache;
+      layers[i].time = sampler.controller.time();
+      layers[i].weight = sampler.weight;
     }
 
-    // Setups blending job.
-    ozz::animation::BlendingJob blend_job;
+    // Setups sampling and blending job.
+    ozz::animation::SamplingBlendingJob blend_job;
     blend_job.threshold = threshold_;
     blend_job.layers = layers;
     blend_job.bind_pose = skeleton_.bind_pose();
     blend_job.output = blended_locals_;
 
-    // Blends.
+    // Samples and blends.
     if (!blend_job.Run()) {
       return false;
     }
@@ -228,10 +211,6 @@ class BlendSampleApplication : public ozz::sample::Application {
           return false;
       }
 
-      // Allocates sampler runtime buffers.
-      sampler.locals =
-        allocator->AllocateRange<ozz::math::SoaTransform>(num_soa_joints);
-
       // Allocates a cache that matches animation requirements.
       sampler.cache = allocator->New<ozz::animation::SamplingCache>(num_joints);
     }
@@ -250,7 +229,6 @@ class BlendSampleApplication : public ozz::sample::Application {
     ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
     for (int i = 0; i < kNumLayers; ++i) {
       Sampler& sampler = samplers_[i];
-      allocator->Deallocate(sampler.locals);
       allocator->Delete(sampler.cache);
     }
     allocator->Deallocate(blended_locals_);
@@ -349,9 +327,6 @@ class BlendSampleApplication : public ozz::sample::Application {
 
     // Sampling cache.
     ozz::animation::SamplingCache* cache;
-
-    // Buffer of local transforms as sampled from animation_.
-    ozz::Range<ozz::math::SoaTransform> locals;
   } samplers_[kNumLayers];  // kNumLayers animations to blend.
 
   // Blending job bind pose threshold.
@@ -59,6 +59,9 @@ void Save(OArchive& _archive,
     _archive << part.colors;
     _archive << part.joint_indices;
     _archive << part.joint_weights;
+    _archive << part.joint_indices8;
+    _archive << part.joint_weights16;
+    _archive << part.joint_weights8;
   }
 }
 
@@ -67,7 +70,6 @@ void Load(IArchive& _archive,
           sample::Mesh::Part* _parts,
           size_t _count,
           uint32_t _version) {
-  (void)_version;
   for (size_t i = 0; i < _count; ++i) {
     sample::Mesh::Part& part = _parts[i];
     _archive >> part.positions;
@@ -77,6 +79,12 @@ void Load(IArchive& _archive,
     _archive >> part.colors;
     _archive >> part.joint_indices;
     _archive >> part.joint_weights;
+    // Compact indices and weights formats were introduced in version 2.
+    if (_version > 1) {
+      _archive >> part.joint_indices8;
+      _archive >> part.joint_weights16;
+      _archive >> part.joint_weights8;
+    }
   }
 }
 
@@ -97,7 +97,9 @@ struct Mesh {
       if (_vertex_count == 0) {
         return 0;
       }
-      return static_cast<int>(joint_indices.size()) / _vertex_count;
+      const size_t indices_count =
+        joint_indices.empty() ? joint_indices8.size() : joint_indices.size();
+      return static_cast<int>(indices_count) / _vertex_count;
     }
 
     typedef ozz::Vector<float>::Std Positions;
@@ -120,11 +122,25 @@ struct Mesh {
     Colors colors;
     enum {kColorsCpnts = 4};  // r, g, b, a components
 
+    // Joint indices are stored in one of the following formats. The compact
+    // 8 bits format is only possible with meshes skinned by at most 256
+    // joints.
     typedef ozz::Vector<uint16_t>::Std JointIndices;
     JointIndices joint_indices;  // Stride equals influences_count
 
+    typedef ozz::Vector<uint8_t>::Std JointIndices8;
+    JointIndices8 joint_indices8;  // Stride equals influences_count
+
+    // Joint weights are stored in one of the following formats. 16 and 8 bits
+    // formats are unsigned normalized integers.
     typedef ozz::Vector<float>::Std JointWeights;
     JointWeights joint_weights;  // Stride equals influences_count - 1
+
+    typedef ozz::Vector<uint16_t>::Std JointWeights16;
+    JointWeights16 joint_weights16;  // Stride equals influences_count - 1
+
+    typedef ozz::Vector<uint8_t>::Std JointWeights8;
+    JointWeights8 joint_weights8;  // Stride equals influences_count - 1
   };
   typedef ozz::Vector<Part>::Std Parts;
   Parts parts;
@@ -142,7 +158,7 @@ struct Mesh {
 namespace io {
 
 OZZ_IO_TYPE_TAG("ozz-sample-Mesh-Part", sample::Mesh::Part)
-OZZ_IO_TYPE_VERSION(1, sample::Mesh::Part)
+OZZ_IO_TYPE_VERSION(2, sample::Mesh::Part)
 
 OZZ_IO_TYPE_TAG("ozz-sample-Mesh", sample::Mesh)
 OZZ_IO_TYPE_VERSION(1, sample::Mesh)
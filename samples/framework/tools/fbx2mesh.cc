@@ -54,6 +54,22 @@ OZZ_OPTIONS_DECLARE_STRING(skeleton, "Specifies the skeleton that the skin is bo
 OZZ_OPTIONS_DECLARE_STRING(mesh, "Specifies ozz mesh ouput file.", "", true)
 OZZ_OPTIONS_DECLARE_BOOL(split, "Split the skinned mesh into parts (number of joint influences per vertex).", true, false)
 OZZ_OPTIONS_DECLARE_INT(max_influences, "Maximum number of joint influences per vertex (0 means no limitation).", 0, false)
+OZZ_OPTIONS_DECLARE_BOOL(compact_indices, "Stores joint indices on 8 bits when the skeleton has at most 256 joints.", true, false)
+
+static bool ValidateWeightsBits(const ozz::options::Option& _option,
+                                int /*_argc*/) {
+  const ozz::options::IntOption& option =
+    static_cast<const ozz::options::IntOption&>(_option);
+  bool valid = option.value() == 0 ||
+               option.value() == 8 ||
+               option.value() == 16;
+  if (!valid) {
+    ozz::log::Err() << "Invalid weights bits option (must be 0, 8 or 16)." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_INT_FN(weights_bits, "Stores joint weights as 8 or 16 bits unsigned normalized integers (0 means 32 bits floats).", 0, false, &ValidateWeightsBits)
 
 namespace {
 
@@ -798,6 +814,53 @@ bool StripWeights(ozz::sample::Mesh* _mesh) {
   return true;
 }
 
+// Quantizes a [0, 1] weight to an unsigned normalized integer of type _Ty.
+template <typename _Ty>
+_Ty QuantizeWeight(float _weight) {
+  const float max = static_cast<float>(std::numeric_limits<_Ty>::max());
+  const float clamped = ozz::math::Clamp(0.f, _weight, 1.f);
+  return static_cast<_Ty>(clamped * max + .5f);
+}
+
+// Converts joint indices and weights to compact formats, depending on
+// _compact_indices and _weights_bits (0 keeps float weights). Indices are
+// converted to 8 bits only if the mesh is skinned by at most 256 joints.
+bool CompressInfluences(ozz::sample::Mesh* _mesh,
+                        int _num_joints,
+                        bool _compact_indices,
+                        int _weights_bits) {
+  const bool indices8 =
+    _compact_indices &&
+    _num_joints <= std::numeric_limits<uint8_t>::max() + 1;
+  for (size_t i = 0; i < _mesh->parts.size(); ++i) {
+    ozz::sample::Mesh::Part& part = _mesh->parts[i];
+    if (indices8) {
+      part.joint_indices8.resize(part.joint_indices.size());
+      for (size_t j = 0; j < part.joint_indices.size(); ++j) {
+        assert(part.joint_indices[j] < _num_joints);
+        part.joint_indices8[j] = static_cast<uint8_t>(part.joint_indices[j]);
+      }
+      part.joint_indices.clear();
+    }
+    if (_weights_bits == 16) {
+      part.joint_weights16.resize(part.joint_weights.size());
+      for (size_t j = 0; j < part.joint_weights.size(); ++j) {
+        part.joint_weights16[j] =
+          QuantizeWeight<uint16_t>(part.joint_weights[j]);
+      }
+      part.joint_weights.clear();
+    } else if (_weights_bits == 8) {
+      part.joint_weights8.resize(part.joint_weights.size());
+      for (size_t j = 0; j < part.joint_weights.size(); ++j) {
+        part.joint_weights8[j] = QuantizeWeight<uint8_t>(part.joint_weights[j]);
+      }
+      part.joint_weights.clear();
+    }
+  }
+
+  return true;
+}
+
 int main(int _argc, const char** _argv) {
   // Parses arguments.
   ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
@@ -913,6 +976,14 @@ int main(int _argc, const char** _argv) {
       return EXIT_FAILURE;
     }
 
+    ozz::log::LogV() << "Compressing skinning indices and weights." <<
+      std::endl;
+    if (!CompressInfluences(&output_mesh, skeleton.num_joints(),
+                            OPTIONS_compact_indices, OPTIONS_weights_bits)) {
+      ozz::log::Err() << "Failed to compress skinning data." << std::endl;
+      return EXIT_FAILURE;
+    }
+
     assert(OPTIONS_max_influences <= 0 ||
            output_mesh.max_influences_count() <= OPTIONS_max_influences);
   }
@@ -129,43 +129,34 @@ void CopyRaw(const _SrcTrack& _src, uint16_t _track, float _duration,
   assert(_dest->front().key.time == 0.f && _dest->back().key.time == _duration);
 }
 
-void CopyToAnimation(ozz::Vector<SortingTranslationKey>::Std* _src,
-                     ozz::Range<TranslationKey>* _dest) {
-  const size_t src_count = _src->size();
-  if (!src_count) {
-    return;
-  }
-
-  // Sort animation keys to favor cache coherency.
-  std::sort(&_src->front(), (&_src->back()) + 1, &SortingKeyLess<SortingTranslationKey>);
+// Stores a sorting key time to a key frame time. Float times are copied,
+// while quantized times must have been quantized with QuantizeTimes already.
+void StoreTime(float _time, float* _dest) {
+  *_dest = _time;
+}
 
-  // Fills output.
-  const SortingTranslationKey* src = &_src->front();
-  for (size_t i = 0; i < src_count; ++i) {
-    TranslationKey& key = _dest->begin[i];
-    key.time = src[i].key.time;
-    key.track = src[i].track;
-    key.value[0] = ozz::math::FloatToHalf(src[i].key.value.x);
-    key.value[1] = ozz::math::FloatToHalf(src[i].key.value.y);
-    key.value[2] = ozz::math::FloatToHalf(src[i].key.value.z);
-  }
+void StoreTime(float _time, uint16_t* _dest) {
+  *_dest = static_cast<uint16_t>(_time);
 }
 
-void CopyToAnimation(ozz::Vector<SortingScaleKey>::Std* _src,
-                     ozz::Range<ScaleKey>* _dest) {
+// Copies translation or scale keys, _DestKey being one of TranslationKey,
+// ScaleKey or their quantized time variants.
+template<typename _SortingKey, typename _DestKey>
+void CopyToAnimation(typename ozz::Vector<_SortingKey>::Std* _src,
+                     ozz::Range<_DestKey>* _dest) {
   const size_t src_count = _src->size();
   if (!src_count) {
     return;
   }
 
   // Sort animation keys to favor cache coherency.
-  std::sort(&_src->front(), (&_src->back()) + 1, &SortingKeyLess<SortingScaleKey>);
+  std::sort(&_src->front(), (&_src->back()) + 1, &SortingKeyLess<_SortingKey>);
 
   // Fills output.
-  const SortingScaleKey* src = &_src->front();
+  const _SortingKey* src = &_src->front();
   for (size_t i = 0; i < src_count; ++i) {
-    ScaleKey& key = _dest->begin[i];
-    key.time = src[i].key.time;
+    _DestKey& key = _dest->begin[i];
+    StoreTime(src[i].key.time, &key.time);
     key.track = src[i].track;
     key.value[0] = ozz::math::FloatToHalf(src[i].key.value.x);
     key.value[1] = ozz::math::FloatToHalf(src[i].key.value.y);
@@ -179,14 +170,15 @@ bool LessAbs(float _left, float _right) {
   return std::abs(_left) < std::abs(_right);
 }
 
-// Compresses quaternion to ozz::animation::RotationKey format.
+// Compresses quaternion to ozz::animation::RotationKey format, or
+// QuantizedRotationKey which only differs by its time.
 // The 3 smallest components of the quaternion are quantized to 16 bits
 // integers, while the largest is recomputed thanks to quaternion normalization
 // property (x^2+y^2+z^2+w^2 = 1). Because the 3 components are the 3 smallest,
 // their value cannot be greater than sqrt(2)/2. Thus quantization quality is
 // improved by pre-multiplying each componenent by sqrt(2).
-void CompressQuat(const ozz::math::Quaternion& _src,
-                  ozz::animation::RotationKey* _dest) {
+template<typename _DestKey>
+void CompressQuat(const ozz::math::Quaternion& _src, _DestKey* _dest) {
   // Finds the largest quaternion component.
   const float quat[4] = {_src.x, _src.y, _src.z, _src.w};
   const size_t largest = std::max_element(quat, quat + 4, LessAbs) - quat;
@@ -207,13 +199,42 @@ void CompressQuat(const ozz::math::Quaternion& _src,
   _dest->value[1] = math::Clamp(-32767, b, 32767) & 0xffff;
   _dest->value[2] = math::Clamp(-32767, c, 32767) & 0xffff;
 }
+
+// Compresses quaternion to ozz::animation::PackedRotationKey format.
+// Like CompressQuat, the largest component is dropped, but the 3 smallest
+// components are quantized to 11, 11 and 10 bits unsigned integers and packed
+// in a single 32 bits value.
+void CompressPackedQuat(const ozz::math::Quaternion& _src,
+                        ozz::animation::PackedRotationKey* _dest) {
+  // Finds the largest quaternion component.
+  const float quat[4] = {_src.x, _src.y, _src.z, _src.w};
+  const size_t largest = std::max_element(quat, quat + 4, LessAbs) - quat;
+  assert(largest <= 3);
+  _dest->largest = largest & 0x3;
+
+  // Stores the sign of the largest component.
+  _dest->sign = quat[largest] < 0.f;
+
+  // Remaps the 3 smallest components from [-1/sqrt(2):1/sqrt(2)] to [0:1],
+  // and quantizes them.
+  const int kMapping[4][3] = {{1, 2, 3}, {0, 2, 3}, {0, 1, 3}, {0, 1, 2}};
+  const int* map = kMapping[largest];
+  const float a = (quat[map[0]] * math::kSqrt2 + 1.f) * .5f;
+  const float b = (quat[map[1]] * math::kSqrt2 + 1.f) * .5f;
+  const float c = (quat[map[2]] * math::kSqrt2 + 1.f) * .5f;
+  const int qa = static_cast<int>(floor(a * 2047.f + .5f));
+  const int qb = static_cast<int>(floor(b * 2047.f + .5f));
+  const int qc = static_cast<int>(floor(c * 1023.f + .5f));
+  _dest->value = static_cast<uint32_t>(math::Clamp(0, qa, 2047)) |
+                 (static_cast<uint32_t>(math::Clamp(0, qb, 2047)) << 11) |
+                 (static_cast<uint32_t>(math::Clamp(0, qc, 1023)) << 22);
+}
 }
 
-// Specialize for rotations in order to normalize quaternions.
+// Normalizes rotation keys quaternions, then sorts keys.
 // Consecutive opposite quaternions are also fixed up in order to avoid checking
 // for the smallest path during the NLerp runtime algorithm.
-void CopyToAnimation(ozz::Vector<SortingRotationKey>::Std* _src,
-                     ozz::Range<RotationKey>* _dest) {
+void NormalizeAndSort(ozz::Vector<SortingRotationKey>::Std* _src) {
   const size_t src_count = _src->size();
   if (!src_count) {
     return;
@@ -251,20 +272,160 @@ void CopyToAnimation(ozz::Vector<SortingRotationKey>::Std* _src,
   std::sort(array_begin(*_src),
             array_end(*_src),
             &SortingKeyLess<SortingRotationKey>);
+}
+
+// Specialize for rotations in order to normalize quaternions. _DestKey is
+// RotationKey or QuantizedRotationKey.
+template<typename _DestKey>
+void CopyToAnimation(ozz::Vector<SortingRotationKey>::Std* _src,
+                     ozz::Range<_DestKey>* _dest) {
+  NormalizeAndSort(_src);
 
   // Fills rotation keys output.
+  const size_t src_count = _src->size();
+  const SortingRotationKey* src = array_begin(*_src);
   for (size_t i = 0; i < src_count; ++i) {
     const SortingRotationKey& skey = src[i];
-    RotationKey& dkey = _dest->begin[i];
-    dkey.time = skey.key.time;
+    _DestKey& dkey = _dest->begin[i];
+    StoreTime(skey.key.time, &dkey.time);
     dkey.track = skey.track;
 
     // Compress quaternion to destination container.
     CompressQuat(skey.key.value, &dkey);
   }
 }
+
+// Specialize for packed rotations. Key times must have been quantized with
+// QuantizeTimes.
+void CopyToAnimation(ozz::Vector<SortingRotationKey>::Std* _src,
+                     ozz::Range<PackedRotationKey>* _dest) {
+  NormalizeAndSort(_src);
+
+  // Fills packed rotation keys output.
+  const size_t src_count = _src->size();
+  const SortingRotationKey* src = array_begin(*_src);
+  for (size_t i = 0; i < src_count; ++i) {
+    const SortingRotationKey& skey = src[i];
+    PackedRotationKey& dkey = _dest->begin[i];
+    StoreTime(skey.key.time, &dkey.time);
+    dkey.track = skey.track;
+
+    // Compress quaternion to destination container.
+    CompressPackedQuat(skey.key.value, &dkey);
+  }
+}
+
+// Compresses the value of a constant translation or scale track.
+template<typename _Constant>
+void CompressConstant(const math::Float3& _value, _Constant* _dest) {
+  _dest->value[0] = ozz::math::FloatToHalf(_value.x);
+  _dest->value[1] = ozz::math::FloatToHalf(_value.y);
+  _dest->value[2] = ozz::math::FloatToHalf(_value.z);
+}
+
+// Compresses the value of a constant rotation track, normalized the same way
+// as rotation keys.
+void CompressConstant(const math::Quaternion& _value,
+                      ConstantRotation* _dest) {
+  math::Quaternion normalized =
+    NormalizeSafe(_value, math::Quaternion::identity());
+  if (normalized.w < 0.f) {
+    normalized = -normalized;  // Q an -Q are the same rotation.
+  }
+  CompressQuat(normalized, _dest);
+}
+
+// Tests if a raw track is constant, ie: it has no key or all its keys share
+// the same value.
+template<typename _SrcTrack>
+bool IsConstant(const _SrcTrack& _src) {
+  for (size_t k = 1; k < _src.size(); ++k) {
+    if (!(_src[k].value == _src[0].value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Splits _input tracks of a type, selected by _member, into constant and
+// animated tracks. Constant values are pushed to _constants, while keys of
+// animated tracks are copied to _keys, using their rank as track index. Soa
+// padding joints are animated identity tracks if all the other tracks are
+// animated, or constant ones otherwise. Identity keys are also added to match
+// soa requirements for animated tracks.
+template<typename _SrcTrack, typename _SortingKey, typename _Constant>
+void SplitTracks(const RawAnimation& _input,
+                 const _SrcTrack RawAnimation::JointTrack::*_member,
+                 typename ozz::Vector<_SortingKey>::Std* _keys,
+                 typename ozz::Vector<_Constant>::Std* _constants) {
+  typedef typename _SrcTrack::value_type SrcKey;
+  const int num_tracks = _input.num_tracks();
+  bool has_constant = false;
+  for (int i = 0; i < num_tracks && !has_constant; ++i) {
+    has_constant = IsConstant(_input.tracks[i].*_member);
+  }
+
+  const _SrcTrack empty;
+  uint16_t animated = 0;
+  for (int i = 0; i < math::Align(num_tracks, 4); ++i) {
+    const bool padding = i >= num_tracks;
+    const _SrcTrack& src = padding ? empty : _input.tracks[i].*_member;
+    if ((!padding || has_constant) && IsConstant(src)) {
+      _Constant constant;
+      constant.track = static_cast<uint16_t>(i);
+      CompressConstant(src.empty() ? SrcKey::identity() : src.front().value,
+                       &constant);
+      _constants->push_back(constant);
+    } else {
+      CopyRaw(src, animated++, _input.duration, _keys);
+    }
+  }
+
+  // Add enough identity keys to match soa requirements.
+  for (const int end = math::Align(animated, 4); animated < end; ++animated) {
+    PushBackIdentityKey<SrcKey>(animated, 0.f, _keys);
+    PushBackIdentityKey<SrcKey>(animated, _input.duration, _keys);
+  }
+}
+
+// Quantizes key times as a ratio of _duration, in range [0:kQuantizedTimeMax].
+// Key and previous key times are replaced by their quantized value. Keys of a
+// track whose quantized time equals their predecessor's one are removed, as
+// interpolating between them would divide by zero. The last key of a track
+// (at t = duration) is always kept, replacing its predecessor if needed.
+// Keys are expected to be sorted per-track.
+template<typename _SortingKey>
+void QuantizeTimes(float _duration,
+                   typename ozz::Vector<_SortingKey>::Std* _keys) {
+  const float to_quantized = kQuantizedTimeMax / _duration;
+  const size_t src_count = _keys->size();
+  size_t count = 0;
+  for (size_t i = 0; i < src_count; ++i) {
+    _SortingKey key = (*_keys)[i];
+    const float quantized = floor(key.key.time * to_quantized + .5f);
+    const bool first = count == 0 || (*_keys)[count - 1].track != key.track;
+    if (!first && quantized <= (*_keys)[count - 1].key.time) {
+      const bool last =
+        i + 1 == src_count || (*_keys)[i + 1].track != key.track;
+      if (!last) {
+        continue;  // Removes this key.
+      }
+      --count;  // Removes the predecessor, which can't be the first key.
+    }
+    const bool follows = count > 0 && (*_keys)[count - 1].track == key.track;
+    key.key.time = quantized;
+    key.prev_key_time = follows ? (*_keys)[count - 1].key.time : -1.f;
+    (*_keys)[count++] = key;
+  }
+  _keys->resize(count);
+}
 }  // namespace
 
+AnimationBuilder::AnimationBuilder()
+    : rotation_format(Animation::kRotationStandard),
+      time_format(Animation::kTimeFloat) {
+}
+
 // Ensures _input's validity and allocates _animation.
 // An animation needs to have at least two key frames per joint, the first at
 // t = 0 and the last at t = duration. If at least one of those keys are not
@@ -291,7 +452,6 @@ Animation* AnimationBuilder::operator()(const RawAnimation& _input) const {
   // already been validated.
   const uint16_t num_tracks = static_cast<uint16_t>(_input.num_tracks());
   animation->num_tracks_ = num_tracks;
-  const uint16_t num_soa_tracks = math::Align(num_tracks, 4);
 
   // Declares and preallocates tracks to sort.
   size_t translations = 0, rotations = 0, scales = 0;
@@ -308,40 +468,88 @@ Animation* AnimationBuilder::operator()(const RawAnimation& _input) const {
   ozz::Vector<SortingScaleKey>::Std sorting_scales;
   sorting_scales.reserve(scales);
 
-  // Filters RawAnimation keys and copies them to the output sorting structure.
-  uint16_t i = 0;
-  for (; i < num_tracks; ++i) {
-    const RawAnimation::JointTrack& raw_track = _input.tracks[i];
-    CopyRaw(raw_track.translations, i, duration, &sorting_translations);
-    CopyRaw(raw_track.rotations, i, duration, &sorting_rotations);
-    CopyRaw(raw_track.scales, i, duration, &sorting_scales);
+  // Filters RawAnimation keys and copies them to the output sorting structure,
+  // apart from constant tracks.
+  ozz::Vector<ConstantTranslation>::Std constant_translations;
+  ozz::Vector<ConstantRotation>::Std constant_rotations;
+  ozz::Vector<ConstantScale>::Std constant_scales;
+  SplitTracks<RawAnimation::JointTrack::Translations, SortingTranslationKey,
+              ConstantTranslation>(
+    _input, &RawAnimation::JointTrack::translations, &sorting_translations,
+    &constant_translations);
+  SplitTracks<RawAnimation::JointTrack::Rotations, SortingRotationKey,
+              ConstantRotation>(
+    _input, &RawAnimation::JointTrack::rotations, &sorting_rotations,
+    &constant_rotations);
+  SplitTracks<RawAnimation::JointTrack::Scales, SortingScaleKey,
+              ConstantScale>(
+    _input, &RawAnimation::JointTrack::scales, &sorting_scales,
+    &constant_scales);
+
+  // Quantized time and packed rotation keys are quantized, which can remove
+  // keys.
+  const bool packed = rotation_format == Animation::kRotationPacked;
+  const bool quantized = time_format == Animation::kTimeQuantized;
+  if (quantized) {
+    QuantizeTimes<SortingTranslationKey>(duration, &sorting_translations);
+    QuantizeTimes<SortingScaleKey>(duration, &sorting_scales);
   }
-
-  // Add enough identity keys to match soa requirements.
-  for (; i < num_soa_tracks; ++i) {
-    typedef RawAnimation::TranslationKey SrcTKey;
-    PushBackIdentityKey<SrcTKey>(i, 0.f, &sorting_translations);
-    PushBackIdentityKey<SrcTKey>(i, duration, &sorting_translations);
-
-    typedef RawAnimation::RotationKey SrcRKey;
-    PushBackIdentityKey<SrcRKey>(i, 0.f, &sorting_rotations);
-    PushBackIdentityKey<SrcRKey>(i, duration, &sorting_rotations);
-
-    typedef RawAnimation::ScaleKey SrcSKey;
-    PushBackIdentityKey<SrcSKey>(i, 0.f, &sorting_scales);
-    PushBackIdentityKey<SrcSKey>(i, duration, &sorting_scales);
+  if (packed || quantized) {
+    QuantizeTimes<SortingRotationKey>(duration, &sorting_rotations);
   }
 
   // Allocate animation members.
-  animation->Allocate(_input.name.length() + 1,
-                      sorting_translations.size(),
-                      sorting_rotations.size(),
-                      sorting_scales.size());
+  animation->rotation_format_ = rotation_format;
+  animation->time_format_ = time_format;
+  Animation::Counts counts;
+  counts.name_len = _input.name.length() + 1;
+  counts.translations = sorting_translations.size();
+  counts.rotations = sorting_rotations.size();
+  counts.scales = sorting_scales.size();
+  counts.constant_translations = constant_translations.size();
+  counts.constant_rotations = constant_rotations.size();
+  counts.constant_scales = constant_scales.size();
+  animation->Allocate(counts);
+
+  // Copy constants, which are already sorted by joint index.
+  if (!constant_translations.empty()) {
+    std::memcpy(animation->constant_translations_.begin,
+                array_begin(constant_translations),
+                animation->constant_translations_.Size());
+  }
+  if (!constant_rotations.empty()) {
+    std::memcpy(animation->constant_rotations_.begin,
+                array_begin(constant_rotations),
+                animation->constant_rotations_.Size());
+  }
+  if (!constant_scales.empty()) {
+    std::memcpy(animation->constant_scales_.begin,
+                array_begin(constant_scales),
+                animation->constant_scales_.Size());
+  }
+  animation->BuildTracks();
 
   // Copy sorted keys to final animation.
-  CopyToAnimation(&sorting_translations, &animation->translations_);
-  CopyToAnimation(&sorting_rotations, &animation->rotations_);
-  CopyToAnimation(&sorting_scales, &animation->scales_);
+  if (quantized) {
+    CopyToAnimation<SortingTranslationKey>(
+      &sorting_translations, &animation->quantized_translations_);
+    CopyToAnimation<SortingScaleKey>(
+      &sorting_scales, &animation->quantized_scales_);
+  } else {
+    CopyToAnimation<SortingTranslationKey>(
+      &sorting_translations, &animation->translations_);
+    CopyToAnimation<SortingScaleKey>(&sorting_scales, &animation->scales_);
+  }
+  if (packed) {
+    CopyToAnimation(&sorting_rotations, &animation->packed_rotations_);
+  } else if (quantized) {
+    CopyToAnimation(&sorting_rotations, &animation->quantized_rotations_);
+  } else {
+    CopyToAnimation(&sorting_rotations, &animation->rotations_);
+  }
+
+  // Computes seek tables from sorted keys.
+  animation->BuildSeekTables();
 
   // Copy animation's name.
   strcpy(animation->name_, _input.name.c_str());
@@ -27,15 +27,22 @@
 
 #include "ozz/animation/offline/animation_optimizer.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cassert>
 
+#include "ozz/base/task_scheduler.h"
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/transform.h"
 
 #include "ozz/animation/offline/raw_animation.h"
 #include "ozz/animation/offline/raw_animation_utils.h"
 
+#include "ozz/animation/runtime/local_to_model_job.h"
 #include "ozz/animation/runtime/skeleton.h"
 #include "ozz/animation/runtime/skeleton_utils.h"
 
@@ -48,7 +55,10 @@ AnimationOptimizer::AnimationOptimizer()
   : translation_tolerance(1e-3f),  // 1 mm.
     rotation_tolerance(.1f * math::kPi / 180.f),  // 0.1 degree.
     scale_tolerance(1e-3f),  // 0.1%.
-    hierarchical_tolerance(1e-3f) {  // 1 mm.
+    hierarchical_tolerance(1e-3f),  // 1 mm.
+    reduction(kReductionGreedy),
+    error(kErrorHierarchical),
+    scheduler(NULL) {
 }
 
 namespace {
@@ -165,14 +175,56 @@ void BuildHierarchicalSpecs(const RawAnimation& _animation,
   }
 }
 
+// Validates keys against the comparator of their track type, ie: tests if a
+// candidate value can replace the value of a key.
+template<typename _RawTrack, typename _Comparator>
+struct CompareValidator {
+  typedef typename _RawTrack::value_type::Value Value;
+
+  // Tests if _value can replace the value of _src key _key.
+  bool operator()(size_t _key, const Value& _value) const {
+    return comparator(_value,
+                      (*src)[_key].value,
+                      tolerance,
+                      hierarchical_tolerance,
+                      hierarchy_length);
+  }
+
+  // Tests if _src values can be interpolated by _lerp from key _left to key
+  // _right, in between keys. Only keys are compared, which operator() does.
+  template<typename _Lerp>
+  bool Segment(size_t _left, size_t _right, const _Lerp& _lerp) const {
+    (void)_left;
+    (void)_right;
+    (void)_lerp;
+    return true;
+  }
+
+  const _RawTrack* src;
+  _Comparator comparator;
+  float tolerance;
+  float hierarchical_tolerance;
+  float hierarchy_length;
+};
+
+// Interpolation function that always returns the left value, which is how a
+// track is sampled after its last key.
+struct LerpLeft {
+  template<typename _Value>
+  _Value operator()(const _Value& _a, const _Value& _b, float _alpha) const {
+    (void)_b;
+    (void)_alpha;
+    return _a;
+  }
+};
+
 // Copy _src keys to _dest but except the ones that can be interpolated.
-template<typename _RawTrack, typename _Comparator, typename _Lerp>
+// _validator tests if the interpolated value of a key can replace it, and if
+// the segment of removed keys can be interpolated in between keys.
+template<typename _RawTrack, typename _Lerp, typename _Validator>
 void Filter(const _RawTrack& _src,
-            const _Comparator& _comparator,
             const _Lerp& _lerp,
-            float _tolerance,
-            float _hierarchical_tolerance,
-            float _hierarchy_length,
+            const _Validator& _validator,
             _RawTrack* _dest) {
   _dest->reserve(_src.size());
 
@@ -185,14 +237,9 @@ void Filter(const _RawTrack& _src,
       last_src_pushed = i;
     } else if (i == _src.size() - 1) {
       // Don't push the last value if it's the same as last_src_pushed.
-      typename _RawTrack::const_reference left = _src[last_src_pushed];
-      typename _RawTrack::const_reference right = _src[i];
-      if (!_comparator(left.value,
-                       right.value,
-                       _tolerance,
-                       _hierarchical_tolerance,
-                       _hierarchy_length)) {
-        _dest->push_back(right);
+      if (!_validator(i, _src[last_src_pushed].value) ||
+          !_validator.Segment(last_src_pushed, i, LerpLeft())) {
+        _dest->push_back(_src[i]);
         last_src_pushed = i;
       }
     } else {
@@ -200,21 +247,92 @@ void Filter(const _RawTrack& _src,
       // interpolated from keys last_src_pushed and i + 1.
       typename _RawTrack::const_reference left = _src[last_src_pushed];
       typename _RawTrack::const_reference right = _src[i + 1];
-      for (size_t j = last_src_pushed + 1; j <= i; ++j) {
+      bool valid = true;
+      for (size_t j = last_src_pushed + 1; valid && j <= i; ++j) {
         typename _RawTrack::const_reference test = _src[j];
         const float alpha = (test.time - left.time) / (right.time - left.time);
         assert(alpha >= 0.f && alpha <= 1.f);
-        if (!_comparator(_lerp(left.value, right.value, alpha),
-                         test.value,
-                         _tolerance,
-                         _hierarchical_tolerance,
-                         _hierarchy_length)) {
-          _dest->push_back(_src[i]);
-          last_src_pushed = i;
-          break;
-        }
+        valid = _validator(j, _lerp(left.value, right.value, alpha));
+      }
+      if (!valid || !_validator.Segment(last_src_pushed, i + 1, _lerp)) {
+        _dest->push_back(_src[i]);
+        last_src_pushed = i;
+      }
+    }
+  }
+  assert(_dest->size() <= _src.size());
+}
+
+// Tests if all keys in range ]_left,_right[ of _src can be interpolated from
+// keys _left and _right, as well as the segment in between keys. Returns as
+// soon as a key can't.
+template<typename _RawTrack, typename _Lerp, typename _Validator>
+bool Interpolable(const _RawTrack& _src,
+                  size_t _left,
+                  size_t _right,
+                  const _Lerp& _lerp,
+                  const _Validator& _validator) {
+  typename _RawTrack::const_reference left = _src[_left];
+  typename _RawTrack::const_reference right = _src[_right];
+  for (size_t j = _left + 1; j < _right; ++j) {
+    typename _RawTrack::const_reference test = _src[j];
+    const float alpha = (test.time - left.time) / (right.time - left.time);
+    assert(alpha >= 0.f && alpha <= 1.f);
+    if (!_validator(j, _lerp(left.value, right.value, alpha))) {
+      return false;
+    }
+  }
+  return _validator.Segment(_left, _right, _lerp);
+}
+
+// Copy _src keys to _dest but except the ones that can be interpolated, like
+// Filter does. From the last pushed key, segments are extended by doubling
+// their length while they're interpolable, then the longest interpolable one
+// is binary searched, so that a track of n keys costs O(n log n).
+template<typename _RawTrack, typename _Lerp, typename _Validator>
+void FilterBisect(const _RawTrack& _src,
+                  const _Lerp& _lerp,
+                  const _Validator& _validator,
+                  _RawTrack* _dest) {
+  _dest->reserve(_src.size());
+  if (_src.empty()) {
+    return;
+  }
+
+  // First key is always pushed.
+  _dest->push_back(_src[0]);
+
+  const size_t last = _src.size() - 1;
+  size_t left = 0;  // Index (in src) of the last pushed key.
+  while (left < last) {
+    // Finds valid and invalid segment ends, valid < invalid, by doubling
+    // segment length. left + 1 is always valid, as there's no key in between.
+    size_t valid = left + 1;
+    size_t invalid = last + 1;
+    for (size_t length = 2; left + length <= last; length *= 2) {
+      if (!Interpolable(_src, left, left + length, _lerp, _validator)) {
+        invalid = left + length;
+        break;
+      }
+      valid = left + length;
+    }
+
+    // Binary searches the longest valid segment in ]valid,invalid[.
+    while (invalid - valid > 1) {
+      const size_t middle = valid + (invalid - valid) / 2;
+      if (Interpolable(_src, left, middle, _lerp, _validator)) {
+        valid = middle;
+      } else {
+        invalid = middle;
       }
     }
+
+    // Don't push the last value if it's the same as the last pushed one.
+    if (valid != last || !_validator(last, _src[left].value) ||
+        !_validator.Segment(left, last, LerpLeft())) {
+      _dest->push_back(_src[valid]);
+    }
+    left = valid;
   }
   assert(_dest->size() <= _src.size());
 }
@@ -266,6 +384,478 @@ bool CompareScale(const math::Float3& _a,
   const math::Float3 l(_hierarchy_length);
   return Compare(_a * l, _b * l, _hierarchical_tolerance);
 }
+
+// Filters _src to _dest with _reduction algorithm, validating keys with
+// _validator.
+template<typename _RawTrack, typename _Lerp, typename _Validator>
+void Reduce(AnimationOptimizer::Reduction _reduction,
+            const _RawTrack& _src,
+            const _Lerp& _lerp,
+            const _Validator& _validator,
+            _RawTrack* _dest) {
+  if (_reduction == AnimationOptimizer::kReductionBisect) {
+    FilterBisect(_src, _lerp, _validator, _dest);
+  } else {
+    Filter(_src, _lerp, _validator, _dest);
+  }
+}
+
+// Filters _src to _dest with _reduction algorithm, comparing keys with
+// _comparator.
+template<typename _RawTrack, typename _Comparator, typename _Lerp>
+void Reduce(AnimationOptimizer::Reduction _reduction,
+            const _RawTrack& _src,
+            _Comparator _comparator,
+            const _Lerp& _lerp,
+            float _tolerance,
+            float _hierarchical_tolerance,
+            float _hierarchy_length,
+            _RawTrack* _dest) {
+  const CompareValidator<_RawTrack, _Comparator> validator = {
+    &_src, _comparator, _tolerance, _hierarchical_tolerance,
+    _hierarchy_length};
+  Reduce(_reduction, _src, _lerp, validator, _dest);
+}
+
+// Compares a time to a key time, to search sorted keys.
+struct KeyTimeLess {
+  template<typename _Key>
+  bool operator()(float _time, const _Key& _key) const {
+    return _time < _key.time;
+  }
+};
+
+// Samples _track at _time, interpolating keys with _lerp. Returns identity
+// value if _track has no key.
+template<typename _RawTrack, typename _Lerp>
+typename _RawTrack::value_type::Value SampleTrack(const _RawTrack& _track,
+                                                  float _time,
+                                                  const _Lerp& _lerp) {
+  if (_track.empty()) {
+    return _RawTrack::value_type::identity();
+  }
+  typename _RawTrack::const_iterator right =
+    std::upper_bound(_track.begin(), _track.end(), _time, KeyTimeLess());
+  if (right == _track.begin()) {
+    return right->value;
+  } else if (right == _track.end()) {
+    return _track.back().value;
+  }
+  typename _RawTrack::const_iterator left = right - 1;
+  const float alpha = (_time - left->time) / (right->time - left->time);
+  return _lerp(left->value, right->value, alpha);
+}
+
+// Packs _count local transforms to soa transforms, completing the last soa
+// element with identity.
+void PackSoa(const math::Transform* _transforms, int _count,
+             math::SoaTransform* _soa) {
+  for (int i = 0; i < _count; i += 4) {
+    const math::Transform identity = math::Transform::identity();
+    const math::Transform& t0 = _transforms[i];
+    const math::Transform& t1 = i + 1 < _count ? _transforms[i + 1] : identity;
+    const math::Transform& t2 = i + 2 < _count ? _transforms[i + 2] : identity;
+    const math::Transform& t3 = i + 3 < _count ? _transforms[i + 3] : identity;
+    const math::SoaTransform soa = {
+      {math::simd_float4::Load(t0.translation.x, t1.translation.x,
+                               t2.translation.x, t3.translation.x),
+       math::simd_float4::Load(t0.translation.y, t1.translation.y,
+                               t2.translation.y, t3.translation.y),
+       math::simd_float4::Load(t0.translation.z, t1.translation.z,
+                               t2.translation.z, t3.translation.z)},
+      {math::simd_float4::Load(t0.rotation.x, t1.rotation.x,
+                               t2.rotation.x, t3.rotation.x),
+       math::simd_float4::Load(t0.rotation.y, t1.rotation.y,
+                               t2.rotation.y, t3.rotation.y),
+       math::simd_float4::Load(t0.rotation.z, t1.rotation.z,
+                               t2.rotation.z, t3.rotation.z),
+       math::simd_float4::Load(t0.rotation.w, t1.rotation.w,
+                               t2.rotation.w, t3.rotation.w)},
+      {math::simd_float4::Load(t0.scale.x, t1.scale.x,
+                               t2.scale.x, t3.scale.x),
+       math::simd_float4::Load(t0.scale.y, t1.scale.y,
+                               t2.scale.y, t3.scale.y),
+       math::simd_float4::Load(t0.scale.z, t1.scale.z,
+                               t2.scale.z, t3.scale.z)}};
+    _soa[i / 4] = soa;
+  }
+}
+
+// Builds the affine matrix of _transform.
+math::Float4x4 ToMatrix(const math::Transform& _transform) {
+  return math::Float4x4::FromAffine(
+    math::simd_float4::Load3PtrU(&_transform.translation.x),
+    math::simd_float4::LoadPtrU(&_transform.rotation.x),
+    math::simd_float4::Load3PtrU(&_transform.scale.x));
+}
+
+// Measures model-space error of joint positions, at every key frame time of
+// an animation. Joints are optimized in skeleton order, so that parents are
+// optimized before their children. Error is measured on the joint being
+// optimized and all its descendants, with optimized ancestors and original
+// descendants. Every joint final position is thus measured once all the
+// tracks it depends on are optimized.
+struct ModelSpaceContext {
+  // Samples _input at every key frame time, and computes reference
+  // model-space matrices with the LocalToModelJob.
+  ModelSpaceContext(const RawAnimation& _input, const Skeleton& _skeleton,
+                    float _tolerance);
+
+  // Prepares positions of _joint and its descendants, relatively to _joint
+  // reference model-space matrix, so that they can be transformed by
+  // candidate _joint matrices.
+  void BeginJoint(int _joint);
+
+  // Updates current joint _member local transforms from its optimized
+  // _track, so that next tracks of this joint are validated against it.
+  template<typename _RawTrack, typename _Lerp>
+  void UpdateLocals(const _RawTrack& _track, const _Lerp& _lerp,
+                    typename _RawTrack::value_type::Value
+                      math::Transform::*_member) {
+    for (int f = 0; f < num_frames; ++f) {
+      locals[f * num_joints + joint].*_member =
+        SampleTrack(_track, times[f], _lerp);
+    }
+  }
+
+  // Computes current joint optimized model-space matrices, once all its
+  // tracks are optimized.
+  void EndJoint();
+
+  // Tests if model-space positions of current joint and its descendants
+  // remain within tolerance at _frame, if current joint local transform is
+  // replaced by _local.
+  bool Validate(int _frame, const math::Transform& _local) const;
+
+  // Finds frame indices of _track key times.
+  template<typename _RawTrack>
+  void FindFrames(const _RawTrack& _track,
+                  ozz::Vector<int>::Std* _frames) const {
+    _frames->resize(_track.size());
+    for (size_t i = 0; i < _track.size(); ++i) {
+      const ozz::Vector<float>::Std::const_iterator it =
+        std::lower_bound(times.begin(), times.end(), _track[i].time);
+      assert(it != times.end() && *it == _track[i].time);
+      (*_frames)[i] = static_cast<int>(it - times.begin());
+    }
+  }
+
+  const Skeleton* skeleton;
+  int num_joints;
+  int num_frames;
+  math::SimdFloat4 tolerance_sq;
+
+  // Sorted times of all animation key frames.
+  ozz::Vector<float>::Std times;
+
+  // Per frame local transforms, updated as joints are optimized.
+  ozz::Vector<math::Transform>::Std locals;
+
+  // Per frame reference and optimized model-space matrices.
+  ozz::Vector<math::Float4x4>::Std models;
+  ozz::Vector<math::Float4x4>::Std optimized_models;
+
+  // Current joint, and per frame soa positions of current joint and its
+  // descendants: relative to current joint and reference model-space.
+  int joint;
+  int num_groups;
+  ozz::Vector<int>::Std descendants;
+  ozz::Vector<char>::Std is_descendant;
+  ozz::Vector<math::SoaFloat3>::Std relatives;
+  ozz::Vector<math::SoaFloat3>::Std positions;
+};
+
+ModelSpaceContext::ModelSpaceContext(const RawAnimation& _input,
+                                     const Skeleton& _skeleton,
+                                     float _tolerance)
+  : skeleton(&_skeleton),
+    num_joints(_skeleton.num_joints()),
+    num_frames(0),
+    tolerance_sq(math::simd_float4::Load1(_tolerance * _tolerance)),
+    joint(-1),
+    num_groups(0) {
+  // Collects all key frame times.
+  for (int i = 0; i < num_joints; ++i) {
+    const RawAnimation::JointTrack& track = _input.tracks[i];
+    for (size_t j = 0; j < track.translations.size(); ++j) {
+      times.push_back(track.translations[j].time);
+    }
+    for (size_t j = 0; j < track.rotations.size(); ++j) {
+      times.push_back(track.rotations[j].time);
+    }
+    for (size_t j = 0; j < track.scales.size(); ++j) {
+      times.push_back(track.scales[j].time);
+    }
+  }
+  std::sort(times.begin(), times.end());
+  times.erase(std::unique(times.begin(), times.end()), times.end());
+  num_frames = static_cast<int>(times.size());
+
+  // Samples local transforms, and computes their model-space matrices.
+  locals.resize(num_frames * num_joints);
+  models.resize(num_frames * num_joints);
+  optimized_models.resize(num_frames * num_joints);
+  ozz::Vector<math::SoaTransform>::Std soa_locals(_skeleton.num_soa_joints());
+  for (int f = 0; f < num_frames; ++f) {
+    math::Transform* frame_locals = &locals[f * num_joints];
+    for (int i = 0; i < num_joints; ++i) {
+      const RawAnimation::JointTrack& track = _input.tracks[i];
+      frame_locals[i].translation =
+        SampleTrack(track.translations, times[f], LerpTranslation);
+      frame_locals[i].rotation =
+        SampleTrack(track.rotations, times[f], LerpRotation);
+      frame_locals[i].scale = SampleTrack(track.scales, times[f], LerpScale);
+    }
+    PackSoa(frame_locals, num_joints, &soa_locals[0]);
+
+    LocalToModelJob job;
+    job.skeleton = &_skeleton;
+    job.input = ozz::Range<const math::SoaTransform>(
+      &soa_locals[0], soa_locals.size());
+    job.output = ozz::Range<math::Float4x4>(
+      &models[f * num_joints], num_joints);
+    const bool success = job.Run();
+    assert(success);
+    (void)success;
+  }
+}
+
+void ModelSpaceContext::BeginJoint(int _joint) {
+  joint = _joint;
+
+  // Collects _joint and its descendants. Skeleton joints are breadth-first
+  // ordered, so descendants aren't contiguous, but they always follow their
+  // parent.
+  const Skeleton::JointProperties* properties =
+    skeleton->joint_properties().begin;
+  is_descendant.assign(num_joints, 0);
+  is_descendant[_joint] = 1;
+  descendants.clear();
+  descendants.push_back(_joint);
+  for (int i = _joint + 1; i < num_joints; ++i) {
+    const int parent = properties[i].parent;
+    if (parent != Skeleton::kNoParentIndex && is_descendant[parent]) {
+      is_descendant[i] = 1;
+      descendants.push_back(i);
+    }
+  }
+  const int count = static_cast<int>(descendants.size());
+  num_groups = (count + 3) / 4;
+
+  // Packs their positions by groups of 4, relative to _joint and in
+  // model-space. Last group is completed with the last joint.
+  relatives.resize(num_frames * num_groups);
+  positions.resize(num_frames * num_groups);
+  for (int f = 0; f < num_frames; ++f) {
+    const math::Float4x4* frame_models = &models[f * num_joints];
+    const math::Float4x4 inverse = math::Invert(frame_models[_joint]);
+    for (int g = 0; g < num_groups; ++g) {
+      math::SimdFloat4 relative[4];
+      math::SimdFloat4 position[4];
+      for (int l = 0; l < 4; ++l) {
+        const int descendant = descendants[math::Min(g * 4 + l, count - 1)];
+        position[l] = frame_models[descendant].cols[3];
+        relative[l] = math::TransformPoint(inverse, position[l]);
+      }
+      math::SimdFloat4 soa[3];
+      math::Transpose4x3(relative, soa);
+      const math::SoaFloat3 soa_relative = {soa[0], soa[1], soa[2]};
+      relatives[f * num_groups + g] = soa_relative;
+      math::Transpose4x3(position, soa);
+      const math::SoaFloat3 soa_position = {soa[0], soa[1], soa[2]};
+      positions[f * num_groups + g] = soa_position;
+    }
+  }
+}
+
+void ModelSpaceContext::EndJoint() {
+  const int parent = skeleton->joint_properties()[joint].parent;
+  for (int f = 0; f < num_frames; ++f) {
+    const math::Transform& local = locals[f * num_joints + joint];
+    math::Float4x4& model = optimized_models[f * num_joints + joint];
+    if (parent == Skeleton::kNoParentIndex) {
+      model = ToMatrix(local);
+    } else {
+      model = optimized_models[f * num_joints + parent] * ToMatrix(local);
+    }
+  }
+}
+
+bool ModelSpaceContext::Validate(int _frame,
+                                 const math::Transform& _local) const {
+  // Computes candidate model-space matrix, from optimized parent.
+  const int parent = skeleton->joint_properties()[joint].parent;
+  math::Float4x4 model = ToMatrix(_local);
+  if (parent != Skeleton::kNoParentIndex) {
+    model = optimized_models[_frame * num_joints + parent] * model;
+  }
+
+  // Splats matrix components, to transform 4 positions at once.
+  const math::SimdFloat4 m00 = math::SplatX(model.cols[0]);
+  const math::SimdFloat4 m01 = math::SplatY(model.cols[0]);
+  const math::SimdFloat4 m02 = math::SplatZ(model.cols[0]);
+  const math::SimdFloat4 m10 = math::SplatX(model.cols[1]);
+  const math::SimdFloat4 m11 = math::SplatY(model.cols[1]);
+  const math::SimdFloat4 m12 = math::SplatZ(model.cols[1]);
+  const math::SimdFloat4 m20 = math::SplatX(model.cols[2]);
+  const math::SimdFloat4 m21 = math::SplatY(model.cols[2]);
+  const math::SimdFloat4 m22 = math::SplatZ(model.cols[2]);
+  const math::SimdFloat4 m30 = math::SplatX(model.cols[3]);
+  const math::SimdFloat4 m31 = math::SplatY(model.cols[3]);
+  const math::SimdFloat4 m32 = math::SplatZ(model.cols[3]);
+
+  const math::SoaFloat3* relative = &relatives[_frame * num_groups];
+  const math::SoaFloat3* position = &positions[_frame * num_groups];
+  for (int g = 0; g < num_groups; ++g) {
+    const math::SoaFloat3& r = relative[g];
+    const math::SimdFloat4 dx =
+      m00 * r.x + m10 * r.y + m20 * r.z + m30 - position[g].x;
+    const math::SimdFloat4 dy =
+      m01 * r.x + m11 * r.y + m21 * r.z + m31 - position[g].y;
+    const math::SimdFloat4 dz =
+      m02 * r.x + m12 * r.y + m22 * r.z + m32 - position[g].z;
+    const math::SimdFloat4 error_sq = dx * dx + dy * dy + dz * dz;
+    if (!math::AreAllFalse(math::CmpGt(error_sq, tolerance_sq))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Validates keys against the comparator of their track type, and against the
+// model-space error of joints positions measured by a ModelSpaceContext.
+template<typename _RawTrack, typename _Comparator>
+struct ModelSpaceValidator {
+  typedef typename _RawTrack::value_type::Value Value;
+
+  // Tests if _value can replace the value of _src key _key.
+  bool operator()(size_t _key, const Value& _value) const {
+    // Local tolerance is tested first, as it's cheaper.
+    if (!compare(_key, _value)) {
+      return false;
+    }
+    const int frame = (*frames)[_key];
+    math::Transform local = context->locals[frame * context->num_joints +
+                                            context->joint];
+    local.*member = _value;
+    return context->Validate(frame, local);
+  }
+
+  // Tests if _src values interpolated by _lerp from key _left to key _right
+  // remain within model-space tolerance at every frame in between, including
+  // key frame times of other tracks.
+  template<typename _Lerp>
+  bool Segment(size_t _left, size_t _right, const _Lerp& _lerp) const {
+    typename _RawTrack::const_reference left = (*compare.src)[_left];
+    typename _RawTrack::const_reference right = (*compare.src)[_right];
+    for (int f = (*frames)[_left] + 1; f < (*frames)[_right]; ++f) {
+      const float alpha =
+        (context->times[f] - left.time) / (right.time - left.time);
+      math::Transform local = context->locals[f * context->num_joints +
+                                              context->joint];
+      local.*member = _lerp(left.value, right.value, alpha);
+      if (!context->Validate(f, local)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  CompareValidator<_RawTrack, _Comparator> compare;
+  const ModelSpaceContext* context;
+  const ozz::Vector<int>::Std* frames;
+  Value math::Transform::*member;
+};
+
+// Filters _src to _dest with _reduction algorithm, comparing keys with
+// _comparator and measuring model-space error with _context.
+template<typename _RawTrack, typename _Comparator, typename _Lerp>
+void ReduceModelSpace(AnimationOptimizer::Reduction _reduction,
+                      ModelSpaceContext* _context,
+                      const _RawTrack& _src,
+                      _Comparator _comparator,
+                      const _Lerp& _lerp,
+                      float _tolerance,
+                      float _hierarchical_tolerance,
+                      typename _RawTrack::value_type::Value
+                        math::Transform::*_member,
+                      _RawTrack* _dest) {
+  ozz::Vector<int>::Std frames;
+  _context->FindFrames(_src, &frames);
+
+  // Hierarchical comparison is disabled with a null hierarchy length, as it's
+  // replaced by the model-space error.
+  const ModelSpaceValidator<_RawTrack, _Comparator> validator = {
+    {&_src, _comparator, _tolerance, _hierarchical_tolerance, 0.f},
+    _context, &frames, _member};
+  Reduce(_reduction, _src, _lerp, validator, _dest);
+
+  _context->UpdateLocals(*_dest, _lerp, _member);
+}
+
+// Optimizes all _input tracks to _output, measuring model-space error.
+void OptimizeModelSpace(const AnimationOptimizer& _optimizer,
+                        const RawAnimation& _input,
+                        const Skeleton& _skeleton,
+                        RawAnimation* _output) {
+  ModelSpaceContext context(_input, _skeleton,
+                            _optimizer.hierarchical_tolerance);
+  for (int i = 0; i < _input.num_tracks(); ++i) {
+    const RawAnimation::JointTrack& input = _input.tracks[i];
+    RawAnimation::JointTrack& output = _output->tracks[i];
+    context.BeginJoint(i);
+    ReduceModelSpace(_optimizer.reduction, &context, input.translations,
+                     CompareTranslation, LerpTranslation,
+                     _optimizer.translation_tolerance,
+                     _optimizer.hierarchical_tolerance,
+                     &math::Transform::translation, &output.translations);
+    ReduceModelSpace(_optimizer.reduction, &context, input.rotations,
+                     CompareRotation, LerpRotation,
+                     _optimizer.rotation_tolerance,
+                     _optimizer.hierarchical_tolerance,
+                     &math::Transform::rotation, &output.rotations);
+    ReduceModelSpace(_optimizer.reduction, &context, input.scales,
+                     CompareScale, LerpScale,
+                     _optimizer.scale_tolerance,
+                     _optimizer.hierarchical_tolerance,
+                     &math::Transform::scale, &output.scales);
+    context.EndJoint();
+  }
+}
+
+// Tasks context, shared by all tasks.
+struct TaskContext {
+  const AnimationOptimizer* optimizer;
+  const RawAnimation* input;
+  const JointSpecs* hierarchical_joint_specs;
+  RawAnimation* output;
+};
+
+// Task function, filters track _index translations, rotations and scales.
+// Tracks are independent, so tasks only write to their own output track.
+void OptimizeTrack(void* _user_data, int _index) {
+  const TaskContext& context = *reinterpret_cast<TaskContext*>(_user_data);
+  const AnimationOptimizer& optimizer = *context.optimizer;
+  const RawAnimation::JointTrack& input = context.input->tracks[_index];
+  const JointSpec& spec = (*context.hierarchical_joint_specs)[_index];
+  RawAnimation::JointTrack& output = context.output->tracks[_index];
+
+  Reduce(optimizer.reduction, input.translations,
+         CompareTranslation, LerpTranslation,
+         optimizer.translation_tolerance,
+         optimizer.hierarchical_tolerance, spec.scale,
+         &output.translations);
+  Reduce(optimizer.reduction, input.rotations,
+         CompareRotation, LerpRotation,
+         optimizer.rotation_tolerance,
+         optimizer.hierarchical_tolerance, spec.length,
+         &output.rotations);
+  Reduce(optimizer.reduction, input.scales,
+         CompareScale, LerpScale,
+         optimizer.scale_tolerance,
+         optimizer.hierarchical_tolerance, spec.length,
+         &output.scales);
+}
 }  // namespace
 
 bool AnimationOptimizer::operator()(const RawAnimation& _input,
@@ -287,31 +877,42 @@ bool AnimationOptimizer::operator()(const RawAnimation& _input,
     return false;
   }
 
-  // First computes bone lengths, that will be used when filtering.
-  JointSpecs hierarchical_joint_specs;
-  BuildHierarchicalSpecs(_input, _skeleton, &hierarchical_joint_specs);
-  
   // Rebuilds output animation.
   _output->name = _input.name;
   _output->duration = _input.duration;
   _output->tracks.resize(_input.tracks.size());
-  
+
+  // Model-space error is measured joint after joint, from parents to
+  // children, so tracks are optimized sequentially.
+  if (error == kErrorModelSpace) {
+    OptimizeModelSpace(*this, _input, _skeleton, _output);
+    return _output->Validate();
+  }
+
+  // First computes bone lengths, that will be used when filtering.
+  JointSpecs hierarchical_joint_specs;
+  BuildHierarchicalSpecs(_input, _skeleton, &hierarchical_joint_specs);
+
+  // Reserves output keys up front, so that tasks don't allocate memory
+  // concurrently, which custom allocators aren't required to support. Output
+  // tracks never have more keys than input ones.
   for (size_t i = 0; i < _input.tracks.size(); ++i) {
-    Filter(_input.tracks[i].translations,
-           CompareTranslation, LerpTranslation,
-           translation_tolerance,
-           hierarchical_tolerance, hierarchical_joint_specs[i].scale,
-           &_output->tracks[i].translations);
-    Filter(_input.tracks[i].rotations,
-           CompareRotation, LerpRotation,
-           rotation_tolerance,
-           hierarchical_tolerance, hierarchical_joint_specs[i].length,
-           &_output->tracks[i].rotations);
-    Filter(_input.tracks[i].scales,
-           CompareScale, LerpScale,
-           scale_tolerance,
-           hierarchical_tolerance, hierarchical_joint_specs[i].length,
-           &_output->tracks[i].scales);
+    const RawAnimation::JointTrack& input = _input.tracks[i];
+    RawAnimation::JointTrack& output = _output->tracks[i];
+    output.translations.reserve(input.translations.size());
+    output.rotations.reserve(input.rotations.size());
+    output.scales.reserve(input.scales.size());
+  }
+
+  // Dispatches tracks.
+  TaskContext context = {this, &_input, &hierarchical_joint_specs, _output};
+  const int num_tracks = _input.num_tracks();
+  if (scheduler && num_tracks > 1) {
+    scheduler->Run(&OptimizeTrack, &context, num_tracks);
+  } else {
+    for (int i = 0; i < num_tracks; ++i) {
+      OptimizeTrack(&context, i);
+    }
   }
 
   // Output animation is always valid though.
@@ -0,0 +1,170 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/segmented_animation_builder.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/math_ex.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/segmented_animation.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace {
+
+// Samples track _track at time _time, using _lerp interpolation function that
+// matches runtime sampling.
+template<typename _Track>
+typename _Track::value_type::Value SampleTrack(
+    const _Track& _track, float _time,
+    typename _Track::value_type::Value (*_lerp)(
+      const typename _Track::value_type::Value&,
+      const typename _Track::value_type::Value&,
+      float)) {
+  assert(!_track.empty());
+  if (_time <= _track.front().time) {
+    return _track.front().value;
+  }
+  for (size_t i = 1; i < _track.size(); ++i) {
+    if (_time <= _track[i].time) {
+      const float alpha = (_time - _track[i - 1].time) /
+                          (_track[i].time - _track[i - 1].time);
+      return _lerp(_track[i - 1].value, _track[i].value, alpha);
+    }
+  }
+  return _track.back().value;
+}
+
+// Extracts keys of _src track in range [_begin,_end], and remaps them to range
+// [0,_end-_begin]. First and last keys are sampled at segment bounds.
+template<typename _Track>
+void ExtractSegment(
+    const _Track& _src, float _begin, float _end,
+    typename _Track::value_type::Value (*_lerp)(
+      const typename _Track::value_type::Value&,
+      const typename _Track::value_type::Value&,
+      float),
+    _Track* _dest) {
+  typedef typename _Track::value_type Key;
+  if (_src.empty()) {  // Identity keys will be added by the AnimationBuilder.
+    return;
+  }
+
+  const Key first = {0.f, SampleTrack(_src, _begin, _lerp)};
+  _dest->push_back(first);
+
+  const float duration = _end - _begin;
+  for (size_t i = 0; i < _src.size(); ++i) {
+    const float time = _src[i].time - _begin;
+    // Keys are kept strictly ordered, even with floating point rounding.
+    if (time > _dest->back().time && time < duration) {
+      const Key key = {time, _src[i].value};
+      _dest->push_back(key);
+    }
+  }
+
+  const Key last = {duration, SampleTrack(_src, _end, _lerp)};
+  _dest->push_back(last);
+}
+}  // namespace
+
+SegmentedAnimationBuilder::SegmentedAnimationBuilder()
+    : segment_duration(1.f),
+      rotation_format(Animation::kRotationStandard),
+      time_format(Animation::kTimeFloat) {
+}
+
+SegmentedAnimation* SegmentedAnimationBuilder::operator()(
+    const RawAnimation& _input) const {
+  // Tests _raw_animation validity.
+  if (!_input.Validate() || !(segment_duration > 0.f)) {
+    return NULL;
+  }
+
+  // Computes the number of segments. The last segment absorbs the remaining
+  // time if it's too small.
+  const float duration = _input.duration;
+  const int num_segments = math::Max(
+    1, static_cast<int>(std::ceil(duration / segment_duration - 1e-3f)));
+
+  SegmentedAnimation* animation =
+    memory::default_allocator()->New<SegmentedAnimation>();
+  animation->duration_ = duration;
+  animation->segment_duration_ = segment_duration;
+  animation->num_tracks_ = _input.num_tracks();
+  animation->Allocate(_input.name.length(), num_segments);
+  if (animation->name_) {
+    std::strcpy(animation->name_, _input.name.c_str());
+  }
+
+  // Builds every segment as a standalone animation.
+  AnimationBuilder builder;
+  builder.rotation_format = rotation_format;
+  builder.time_format = time_format;
+  RawAnimation raw_segment;
+  raw_segment.tracks.resize(_input.tracks.size());
+  for (int i = 0; i < num_segments; ++i) {
+    const float begin = i * segment_duration;
+    const float end = i == num_segments - 1 ? duration : begin + segment_duration;
+    raw_segment.duration = end - begin;
+
+    for (size_t j = 0; j < _input.tracks.size(); ++j) {
+      const RawAnimation::JointTrack& src = _input.tracks[j];
+      RawAnimation::JointTrack& dest = raw_segment.tracks[j];
+      dest.translations.clear();
+      dest.rotations.clear();
+      dest.scales.clear();
+      ExtractSegment(src.translations, begin, end, &LerpTranslation,
+                     &dest.translations);
+      ExtractSegment(src.rotations, begin, end, &LerpRotation,
+                     &dest.rotations);
+      ExtractSegment(src.scales, begin, end, &LerpScale, &dest.scales);
+    }
+
+    Animation* segment = builder(raw_segment);
+    if (!segment) {  // Shall not happen as input was validated.
+      memory::default_allocator()->Delete(animation);
+      return NULL;
+    }
+    animation->segments_.begin[i] = segment;
+  }
+
+  return animation;  // Success.
+}
+}  // offline
+}  // animation
+}  // ozz
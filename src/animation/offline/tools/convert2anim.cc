@@ -27,9 +27,15 @@
 
 #include "ozz/animation/offline/tools/convert2anim.h"
 
+#include <algorithm>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif  // _OPENMP
+
 #include "ozz/animation/offline/animation_builder.h"
 #include "ozz/animation/offline/animation_optimizer.h"
 #include "ozz/animation/offline/additive_animation_builder.h"
@@ -48,7 +54,13 @@
 #include "ozz/options/options.h"
 
 // Declares command line options.
-OZZ_OPTIONS_DECLARE_STRING(file, "Specifies input file", "", true)
+OZZ_OPTIONS_DECLARE_STRING(file,
+  "Specifies input file. Ignored if a manifest is specified.", "", false)
+OZZ_OPTIONS_DECLARE_STRING(manifest,
+  "Specifies a manifest file, listing input files to convert as a batch, one "
+  "per line. An input file can be followed by a '>' character and an output "
+  "file, which overrides animation option for this input. Empty lines and "
+  "lines starting with '#' are ignored.", "", false)
 OZZ_OPTIONS_DECLARE_STRING(skeleton,
   "Specifies ozz skeleton (raw or runtime) input file", "", true)
 
@@ -96,6 +108,26 @@ OZZ_OPTIONS_DECLARE_FLOAT(
   "Optimizer hierarchical tolerance in meters",
   ozz::animation::offline::AnimationOptimizer().hierarchical_tolerance, false)
 
+static bool ValidateReduction(const ozz::options::Option& _option,
+                              int /*_argc*/) {
+  const ozz::options::StringOption& option =
+    static_cast<const ozz::options::StringOption&>(_option);
+  bool valid = std::strcmp(option.value(), "greedy") == 0 ||
+               std::strcmp(option.value(), "bisect") == 0;
+  if (!valid) {
+    ozz::log::Err() << "Invalid reduction option." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_STRING_FN(
+  reduction,
+  "Selects optimizer keyframes reduction algorithm. Can be \"greedy\" or "\
+  "\"bisect\" (faster on long tracks).",
+  "greedy",
+  false,
+  &ValidateReduction)
+
 OZZ_OPTIONS_DECLARE_BOOL(additive, "Creates a delta animation that can be used for additive blending.", false, false)
 
 static bool ValidateEndianness(const ozz::options::Option& _option,
@@ -163,6 +195,34 @@ OZZ_OPTIONS_DECLARE_BOOL(
   false,
   false)
 
+static bool ValidateJobs(const ozz::options::Option& _option,
+                         int /*_argc*/) {
+  const ozz::options::IntOption& option =
+    static_cast<const ozz::options::IntOption&>(_option);
+  bool valid = option.value() >= 0;
+  if (!valid) {
+    ozz::log::Err() << "Invalid jobs option (must be >= 0)." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_STRING(
+  cache,
+  "Specifies an existing directory used to cache imported and built "
+  "animations. Import and build stages are skipped when input file, skeleton "
+  "and options match a cached conversion.",
+  "",
+  false)
+
+OZZ_OPTIONS_DECLARE_INT_FN(
+  jobs,
+  "Specifies the number of manifest input files converted concurrently. Set a "
+  "value = 0 to use all available cores. Concurrent conversions require a "
+  "thread safe default allocator, which the heap allocator is.",
+  0,
+  false,
+  &ValidateJobs)
+
 namespace ozz {
 namespace animation {
 namespace offline {
@@ -247,8 +307,8 @@ ozz::animation::Skeleton* ImportSkeleton() {
   return skeleton;
 }
 
-bool OutputSingleAnimation() {
-  return strchr(OPTIONS_animation.value(), '*') == NULL;
+bool OutputSingleAnimation(const char* _animation) {
+  return strchr(_animation, '*') == NULL;
 }
 
 ozz::String::Std BuildFilename(const char* _filename, const char* _animation) {
@@ -260,8 +320,9 @@ ozz::String::Std BuildFilename(const char* _filename, const char* _animation) {
   return output;
 }
 
-bool Export(const ozz::animation::offline::RawAnimation _raw_animation,
-            const ozz::animation::Skeleton& _skeleton) {
+bool Export(const ozz::animation::offline::RawAnimation& _raw_animation,
+            const ozz::animation::Skeleton& _skeleton,
+            const char* _animation) {
   // Raw animation to build and output.
   ozz::animation::offline::RawAnimation raw_animation;
 
@@ -288,6 +349,10 @@ bool Export(const ozz::animation::offline::RawAnimation _raw_animation,
     optimizer.translation_tolerance = OPTIONS_translation;
     optimizer.scale_tolerance = OPTIONS_scale;
     optimizer.hierarchical_tolerance = OPTIONS_hierarchical;
+    optimizer.reduction =
+      std::strcmp(OPTIONS_reduction, "bisect") == 0 ?
+        ozz::animation::offline::AnimationOptimizer::kReductionBisect :
+        ozz::animation::offline::AnimationOptimizer::kReductionGreedy;
     ozz::animation::offline::RawAnimation raw_optimized_animation;
     if (!optimizer(raw_animation, _skeleton, &raw_optimized_animation)) {
       ozz::log::Err() << "Failed to optimize animation." << std::endl;
@@ -320,7 +385,7 @@ bool Export(const ozz::animation::offline::RawAnimation _raw_animation,
     // file on the disk.
 
     // Builds output filename.
-    ozz::String::Std filename = BuildFilename(OPTIONS_animation,
+    ozz::String::Std filename = BuildFilename(_animation,
                                               _raw_animation.name.c_str());
 
     ozz::log::Log() << "Opens output file: " << filename << std::endl;
@@ -363,8 +428,411 @@ bool Export(const ozz::animation::offline::RawAnimation _raw_animation,
 
   return true;
 }
+
+// Removes leading and trailing white spaces from _string.
+ozz::String::Std Trim(const ozz::String::Std& _string) {
+  const char* kSpaces = " \t\r\n";
+  const size_t begin = _string.find_first_not_of(kSpaces);
+  if (begin == std::string::npos) {
+    return ozz::String::Std();
+  }
+  const size_t end = _string.find_last_not_of(kSpaces);
+  return _string.substr(begin, end - begin + 1);
+}
+
+// Input file and output file(s) of a batch conversion.
+struct BatchEntry {
+  ozz::String::Std file;
+  ozz::String::Std animation;
+};
+
+bool ReadManifest(const char* _manifest,
+                  ozz::Vector<BatchEntry>::Std* _entries) {
+  ozz::io::File file(_manifest, "rb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open manifest file: " << _manifest <<
+      std::endl;
+    return false;
+  }
+  ozz::String::Std content(file.Size(), 0);
+  if (!content.empty() &&
+      file.Read(&content[0], content.size()) != content.size()) {
+    ozz::log::Err() << "Failed to read manifest file: " << _manifest <<
+      std::endl;
+    return false;
+  }
+
+  // Parses manifest content, line by line.
+  size_t begin = 0;
+  while (begin < content.size()) {
+    size_t end = content.find('\n', begin);
+    if (end == std::string::npos) {
+      end = content.size();
+    }
+    const ozz::String::Std line = Trim(content.substr(begin, end - begin));
+    begin = end + 1;
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    BatchEntry entry;
+    const size_t separator = line.find('>');
+    if (separator == std::string::npos) {
+      entry.file = line;
+      entry.animation = OPTIONS_animation.value();
+    } else {
+      entry.file = Trim(line.substr(0, separator));
+      entry.animation = Trim(line.substr(separator + 1));
+      if (std::count(entry.animation.begin(), entry.animation.end(), '*') > 1) {
+        ozz::log::Err() << "Invalid manifest output file \"" <<
+          entry.animation << "\". There should be 0 or 1 \'*\' character." <<
+          std::endl;
+        return false;
+      }
+    }
+    if (entry.file.empty() || entry.animation.empty()) {
+      ozz::log::Err() << "Invalid manifest line \"" << line << "\"." <<
+        std::endl;
+      return false;
+    }
+    _entries->push_back(entry);
+  }
+  return true;
+}
+
+// Incremental 64 bits FNV-1a hash, used to compute cache keys.
+class Hasher {
+ public:
+  Hasher()
+    : hash_((static_cast<uint64_t>(0xcbf29ce4u) << 32) | 0x84222325u) {
+  }
+
+  void Update(const void* _data, size_t _size) {
+    const uint8_t* data = static_cast<const uint8_t*>(_data);
+    for (size_t i = 0; i < _size; ++i) {
+      hash_ ^= data[i];
+      // Multiplies by FNV prime 2^40 + 0x1b3.
+      hash_ = (hash_ << 40) + hash_ * 0x1b3u;
+    }
+  }
+
+  template <typename _Ty>
+  void UpdateValue(const _Ty& _value) {
+    Update(&_value, sizeof(_Ty));
+  }
+
+  // Includes terminating null character, to separate consecutive strings.
+  void UpdateString(const char* _string) {
+    Update(_string, std::strlen(_string) + 1);
+  }
+
+  // Hashes _filename content. Returns false if file can't be read.
+  bool UpdateFile(const char* _filename) {
+    ozz::io::File file(_filename, "rb");
+    if (!file.opened()) {
+      return false;
+    }
+    char buffer[4096];
+    for (size_t read; (read = file.Read(buffer, sizeof(buffer))) != 0;) {
+      Update(buffer, read);
+    }
+    return true;
+  }
+
+  uint64_t hash() const {
+    return hash_;
+  }
+
+ private:
+  uint64_t hash_;
+};
+
+ozz::String::Std ToHex(uint64_t _key) {
+  char hex[17];
+  std::sprintf(hex, "%08x%08x", static_cast<unsigned int>(_key >> 32),
+               static_cast<unsigned int>(_key & 0xffffffffu));
+  return hex;
+}
+
+ozz::String::Std CachePath(uint64_t _key, const char* _extension) {
+  ozz::String::Std path(OPTIONS_cache);
+  path += '/';
+  path += ToHex(_key);
+  path += _extension;
+  return path;
+}
+
+// Computes the key of _file import, from input and skeleton files content,
+// and import options.
+bool ComputeImportKey(const char* _file, uint64_t* _key) {
+  Hasher hasher;
+  hasher.UpdateValue(static_cast<int>(
+    ozz::io::internal::Version<const RawAnimation>::kValue));
+  if (!hasher.UpdateFile(_file) ||
+      !hasher.UpdateFile(OPTIONS_skeleton)) {
+    return false;
+  }
+  hasher.UpdateValue(OPTIONS_sampling_rate.value());
+  *_key = hasher.hash();
+  return true;
+}
+
+// Computes the key of the _index animation output, from its import key and all
+// options that affect the output file.
+uint64_t ComputeExportKey(uint64_t _import_key, size_t _index) {
+  Hasher hasher;
+  hasher.UpdateValue(_import_key);
+  hasher.UpdateValue(static_cast<uint32_t>(_index));
+  hasher.UpdateValue(static_cast<int>(
+    ozz::io::internal::Version<const ozz::animation::Animation>::kValue));
+  hasher.UpdateValue(OPTIONS_additive.value());
+  hasher.UpdateValue(OPTIONS_optimize.value());
+  hasher.UpdateValue(OPTIONS_rotation.value());
+  hasher.UpdateValue(OPTIONS_translation.value());
+  hasher.UpdateValue(OPTIONS_scale.value());
+  hasher.UpdateValue(OPTIONS_hierarchical.value());
+  hasher.UpdateString(OPTIONS_reduction);
+  hasher.UpdateString(OPTIONS_endian);
+  hasher.UpdateValue(OPTIONS_raw.value());
+  return hasher.hash();
+}
+
+bool CopyFileContent(const char* _from, const char* _to) {
+  ozz::io::File from(_from, "rb");
+  if (!from.opened()) {
+    return false;
+  }
+  ozz::io::File to(_to, "wb");
+  if (!to.opened()) {
+    return false;
+  }
+  char buffer[4096];
+  for (size_t read; (read = from.Read(buffer, sizeof(buffer))) != 0;) {
+    if (to.Write(buffer, read) != read) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Cache files are written to a temporary file, renamed once complete. This
+// ensures interrupted or concurrent conversions never leave a partial cache
+// file. _owner makes the temporary file unique to a conversion.
+ozz::String::Std TemporaryPath(const ozz::String::Std& _path,
+                               const char* _owner) {
+  Hasher hasher;
+  hasher.UpdateString(_owner);
+  return _path + '.' + ToHex(hasher.hash()) + ".tmp";
+}
+
+void CommitCacheFile(const ozz::String::Std& _temporary,
+                     const ozz::String::Std& _path) {
+  if (std::rename(_temporary.c_str(), _path.c_str()) != 0) {
+    std::remove(_temporary.c_str());
+  }
+}
+
+bool LoadImportCache(const ozz::String::Std& _path,
+                     ozz::Vector<RawAnimation>::Std* _animations) {
+  ozz::io::File file(_path.c_str(), "rb");
+  // Endianness byte and animations count are always written.
+  if (!file.opened() || file.Size() < 1 + sizeof(uint32_t)) {
+    return false;
+  }
+  ozz::io::IArchive archive(&file);
+  uint32_t count;
+  archive >> count;
+  _animations->resize(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    if (!archive.TestTag<RawAnimation>()) {
+      _animations->clear();
+      return false;
+    }
+    archive >> _animations->at(i);
+  }
+  return static_cast<size_t>(file.Tell()) == file.Size();
+}
+
+void SaveImportCache(const ozz::String::Std& _path, const char* _owner,
+                     const ozz::Vector<RawAnimation>::Std& _animations) {
+  const ozz::String::Std temporary = TemporaryPath(_path, _owner);
+  {
+    ozz::io::File file(temporary.c_str(), "wb");
+    if (!file.opened()) {
+      ozz::log::Log() << "Failed to open cache file: " << temporary <<
+        std::endl;
+      return;
+    }
+    ozz::io::OArchive archive(&file);
+    archive << static_cast<uint32_t>(_animations.size());
+    for (size_t i = 0; i < _animations.size(); ++i) {
+      archive << _animations[i];
+    }
+  }
+  CommitCacheFile(temporary, _path);
+}
+
+void SaveExportCache(const ozz::String::Std& _path, const char* _output) {
+  const ozz::String::Std temporary = TemporaryPath(_path, _output);
+  if (CopyFileContent(_output, temporary.c_str())) {
+    CommitCacheFile(temporary, _path);
+  } else {
+    std::remove(temporary.c_str());
+    ozz::log::Log() << "Failed to write cache file: " << temporary <<
+      std::endl;
+  }
+}
 }  // namespace
 
+bool AnimationConverter::Convert(const char* _file,
+                                 const char* _animation,
+                                 const ozz::animation::Skeleton& _skeleton,
+                                 int* _exported) {
+  *_exported = 0;
+
+  // Ensures file to import actually exist.
+  if (!ozz::io::File::Exist(_file)) {
+    ozz::log::Err() << "File \"" << _file << "\" doesn't exist." <<
+      std::endl;
+    return false;
+  }
+
+  // Looks for a cached import of the same file, skeleton and options.
+  const bool cache = *OPTIONS_cache.value() != 0;
+  uint64_t import_key = 0;
+  ozz::String::Std import_path;
+  Animations animations;
+  bool imported = false;
+  if (cache && ComputeImportKey(_file, &import_key)) {
+    import_path = CachePath(import_key, ".raw");
+    imported = LoadImportCache(import_path, &animations);
+    if (imported) {
+      ozz::log::Log() << "Reuses cached import of file \"" << _file <<
+        "\" (" << import_path << ")." << std::endl;
+    }
+  }
+
+  if (!imported) {
+    // Imports animation from the document.
+    ozz::log::Log() << "Importing file \"" << _file << "\"" << std::endl;
+
+    // Importers (ie: fbx sdk) aren't required to be thread safe, so imports
+    // are serialized.
+#ifdef _OPENMP
+#pragma omp critical(ozz_animation_converter_import)
+#endif  // _OPENMP
+    imported = Import(_file, _skeleton, OPTIONS_sampling_rate, &animations);
+    if (!imported) {
+      ozz::log::Err() << "Failed to import file \"" << _file << "\"" <<
+        std::endl;
+      return false;
+    }
+    if (!import_path.empty()) {
+      SaveImportCache(import_path, _animation, animations);
+    }
+  }
+
+  if (OutputSingleAnimation(_animation) && animations.size() > 1) {
+    ozz::log::Log() << animations.size() <<
+      " animations found. Only the first one (" << animations[0].name <<
+      ") will be exported." << std::endl;
+
+    // Remove all unhandled animations.
+    animations.resize(1);
+  }
+
+  // Iterate all imported animation, build and output them.
+  bool success = true;
+  for (size_t i = 0; i < animations.size(); ++i) {
+    // Reuses cached output if optimization and build options didn't change.
+    const ozz::String::Std filename =
+      BuildFilename(_animation, animations[i].name.c_str());
+    ozz::String::Std export_path;
+    if (!import_path.empty()) {
+      export_path = CachePath(ComputeExportKey(import_key, i), ".ozz");
+      if (ozz::io::File::Exist(export_path.c_str()) &&
+          CopyFileContent(export_path.c_str(), filename.c_str())) {
+        ozz::log::Log() << "Reuses cached animation " << export_path <<
+          " for output file: " << filename << std::endl;
+        ++*_exported;
+        continue;
+      }
+    }
+
+    if (Export(animations[i], _skeleton, _animation)) {
+      ++*_exported;
+      if (!export_path.empty()) {
+        SaveExportCache(export_path, filename.c_str());
+      }
+    } else {
+      success = false;
+    }
+  }
+  return success;
+}
+
+bool AnimationConverter::ConvertBatch(
+  const char* _manifest, const ozz::animation::Skeleton& _skeleton) {
+  ozz::Vector<BatchEntry>::Std entries;
+  if (!ReadManifest(_manifest, &entries)) {
+    return false;
+  }
+
+  // Outputs of inputs relying on animation option would overwrite each other.
+  if (OutputSingleAnimation(OPTIONS_animation)) {
+    int defaults = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+      defaults += entries[i].animation == OPTIONS_animation.value();
+    }
+    if (defaults > 1) {
+      ozz::log::Err() << "Animation option must contain a \'*\' character "
+        "when used as output by more than one manifest input." << std::endl;
+      return false;
+    }
+  }
+
+  // Every job converts a single input file at a time, so memory usage is
+  // bounded by the number of jobs, whatever the manifest size. The skeleton is
+  // shared by all jobs. Jobs allocate concurrently, relying on the default
+  // allocator being thread safe.
+  const int count = static_cast<int>(entries.size());
+  ozz::Vector<int>::Std exported(entries.size(), 0);
+  ozz::Vector<int>::Std succeeded(entries.size(), 0);
+#ifdef _OPENMP
+  const int jobs = OPTIONS_jobs > 0 ? OPTIONS_jobs : omp_get_max_threads();
+  ozz::log::Log() << "Converts " << count << " manifest input files, using " <<
+    jobs << " jobs." << std::endl;
+#pragma omp parallel for schedule(dynamic) num_threads(jobs)
+#else  // _OPENMP
+  ozz::log::Log() << "Converts " << count << " manifest input files." <<
+    std::endl;
+#endif  // _OPENMP
+  for (int i = 0; i < count; ++i) {
+    succeeded[i] = Convert(entries[i].file.c_str(),
+                           entries[i].animation.c_str(),
+                           _skeleton,
+                           &exported[i]);
+  }
+
+  // Outputs summary report.
+  int failures = 0, animations = 0;
+  for (int i = 0; i < count; ++i) {
+    failures += !succeeded[i];
+    animations += exported[i];
+  }
+  ozz::log::Log() << "Batch conversion summary:" << std::endl;
+  ozz::log::Log() << " - Input files: " << count << " (" <<
+    count - failures << " succeeded, " << failures << " failed)." << std::endl;
+  ozz::log::Log() << " - Exported animations: " << animations << "." <<
+    std::endl;
+  for (int i = 0; i < count; ++i) {
+    if (!succeeded[i]) {
+      ozz::log::Err() << " - Failed to convert \"" << entries[i].file <<
+        "\"." << std::endl;
+    }
+  }
+  return failures == 0;
+}
+
 int AnimationConverter::operator()(int _argc, const char** _argv) {
   // Parses arguments.
   ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
@@ -389,8 +857,10 @@ int AnimationConverter::operator()(int _argc, const char** _argv) {
   ozz::log::SetLevel(log_level);
 
   // Ensures file to import actually exist.
-  if (!ozz::io::File::Exist(OPTIONS_file)) {
-    ozz::log::Err() << "File \"" << OPTIONS_file << "\" doesn't exist." <<
+  const bool batch = *OPTIONS_manifest.value() != 0;
+  const char* input = batch ? OPTIONS_manifest.value() : OPTIONS_file.value();
+  if (!ozz::io::File::Exist(input)) {
+    ozz::log::Err() << "File \"" << input << "\" doesn't exist." <<
       std::endl;
     return EXIT_FAILURE;
   }
@@ -401,31 +871,12 @@ int AnimationConverter::operator()(int _argc, const char** _argv) {
     return EXIT_FAILURE;
   }
 
-  // Imports animation from the document.
-  ozz::log::Log() << "Importing file \"" << OPTIONS_file << "\"" <<
-    std::endl;
-
-  bool success = false;
-  Animations animations;
-  if (Import(OPTIONS_file, *skeleton, OPTIONS_sampling_rate, &animations)) {
-    success = true;
-
-    if (OutputSingleAnimation() && animations.size() > 1) {
-      ozz::log::Log() << animations.size() <<
-        " animations found. Only the first one (" << animations[0].name <<
-        ") will be exported." << std::endl;
-
-      // Remove all unhandled animations.
-      animations.resize(1);
-    }
-
-    // Iterate all imported animation, build and output them.
-    for (size_t i = 0; i < animations.size(); ++i) {
-      success &= Export(animations[i], *skeleton);
-    }
+  bool success;
+  if (batch) {
+    success = ConvertBatch(OPTIONS_manifest, *skeleton);
   } else {
-    ozz::log::Err() << "Failed to import file \"" << OPTIONS_file << "\"" <<
-      std::endl;
+    int exported;
+    success = Convert(OPTIONS_file, OPTIONS_animation, *skeleton, &exported);
   }
 
   ozz::memory::default_allocator()->Delete(skeleton);
@@ -42,71 +42,677 @@
 namespace ozz {
 namespace animation {
 
+namespace {
+// Computes the number of seek points required for a buffer of _count keys.
+// Seek points are located every _interval keys, after the first 2 keys of
+// every track.
+size_t CountSeekPoints(size_t _count, int _num_tracks, int _interval) {
+  const size_t first = static_cast<size_t>(_num_tracks) * 2;
+  if (_interval == 0 || _count <= first) {
+    return 0;
+  }
+  return (_count - first) / _interval;
+}
+
+// Gets the number of tracks stored in a key frames buffer, which is the number
+// of animated tracks, ie: joints minus constant tracks, rounded up to soa size.
+int CountKeyTracks(int _num_soa_tracks, size_t _constant_count) {
+  const int animated = _num_soa_tracks * 4 - static_cast<int>(_constant_count);
+  return (animated + 3) & ~3;
+}
+
+// Computes the size of the seek table of a buffer of _count keys storing
+// _num_tracks tracks.
+size_t ComputeSeekTableSize(size_t _count, int _num_tracks) {
+  const int interval = _num_tracks * Animation::kSeekInterval;
+  const size_t num_points = CountSeekPoints(_count, _num_tracks, interval);
+  return num_points * (sizeof(int) * _num_tracks * 2 + sizeof(float));
+}
+
+// Allocates seek table _table from _buffer, for a buffer of _count keys
+// storing _num_tracks tracks.
+char* AllocateSeekTable(char* _buffer, size_t _count, int _num_tracks,
+                        SeekTable* _table) {
+  _table->interval = _num_tracks * Animation::kSeekInterval;
+  const size_t num_points =
+    CountSeekPoints(_count, _num_tracks, _table->interval);
+  _table->keys.begin = reinterpret_cast<int*>(_buffer);
+  assert(math::IsAligned(_table->keys.begin, OZZ_ALIGN_OF(int)));
+  _buffer += num_points * _num_tracks * 2 * sizeof(int);
+  _table->keys.end = reinterpret_cast<int*>(_buffer);
+
+  _table->times.begin = reinterpret_cast<float*>(_buffer);
+  assert(math::IsAligned(_table->times.begin, OZZ_ALIGN_OF(float)));
+  _buffer += num_points * sizeof(float);
+  _table->times.end = reinterpret_cast<float*>(_buffer);
+  return _buffer;
+}
+
+// Fills seek table _table by walking _keys the same way the SamplingJob does,
+// and taking a snapshot of every track left and right keys every
+// _table->interval keys.
+template<typename _Key>
+void FillSeekTable(ozz::Range<const _Key> _keys, int _num_tracks,
+                   SeekTable* _table) {
+  const int interval = _table->interval;
+  const int num_points = static_cast<int>(_table->times.Count());
+  const int* prev = NULL;
+  int cursor = _num_tracks * 2;
+  for (int i = 0; i < num_points; ++i) {
+    int* state = _table->keys.begin + i * _num_tracks * 2;
+    if (prev) {
+      std::memcpy(state, prev, sizeof(int) * _num_tracks * 2);
+    } else {
+      // The first 2 key frames of every track are sorted first.
+      for (int j = 0; j < _num_tracks; ++j) {
+        state[j * 2 + 0] = j;
+        state[j * 2 + 1] = _num_tracks + j;
+      }
+    }
+    for (const int end = cursor + interval; cursor < end; ++cursor) {
+      const int base = _keys.begin[cursor].track * 2;
+      state[base] = state[base + 1];
+      state[base + 1] = cursor;
+    }
+    // The seek point is valid as soon as the previous key of the last
+    // processed key is reached.
+    const int last = _keys.begin[cursor - 1].track * 2;
+    _table->times.begin[i] = _keys.begin[state[last]].time;
+    prev = state;
+  }
+}
+
+// Keys are serialized by chunks of kKeyChunkSize keys, so that they can be
+// converted from/to their archive layout with a single stream access per
+// chunk.
+const size_t kKeyChunkSize = 256;
+
+// Translation and scale keys archive layout (time, track and 3 values, all
+// written with their native size) matches their memory layout, so they can be
+// read/written with a single stream access.
+OZZ_STATIC_ASSERT(sizeof(TranslationKey) == 12 && sizeof(ScaleKey) == 12);
+OZZ_STATIC_ASSERT(sizeof(QuantizedTranslationKey) == 10 &&
+                  sizeof(QuantizedScaleKey) == 10);
+
+// Swaps the endianness of _count translation or scale keys stored in _keys, in
+// a single pass over memory. Every key is processed as three 32 bits words: the
+// time, whose 4 bytes are reversed, then the track and the 3 values, whose
+// bytes are swapped by pairs (two 16 bits values per word).
+void SwapBulkKeys(char* _keys, size_t _count) {
+  for (size_t i = 0; i < _count; ++i) {
+    char* key = _keys + i * 12;
+    uint32_t time, track_value0, value12;
+    std::memcpy(&time, key + 0, 4);
+    std::memcpy(&track_value0, key + 4, 4);
+    std::memcpy(&value12, key + 8, 4);
+    time = (time >> 24) | ((time >> 8) & 0x0000ff00) |
+           ((time << 8) & 0x00ff0000) | (time << 24);
+    track_value0 = ((track_value0 >> 8) & 0x00ff00ff) |
+                   ((track_value0 << 8) & 0xff00ff00);
+    value12 = ((value12 >> 8) & 0x00ff00ff) | ((value12 << 8) & 0xff00ff00);
+    std::memcpy(key + 0, &time, 4);
+    std::memcpy(key + 4, &track_value0, 4);
+    std::memcpy(key + 8, &value12, 4);
+  }
+}
+
+// Swaps the endianness of _count 16 bits values stored in _values. Values are
+// processed by pairs, as 32 bits words, the same way SwapBulkKeys does.
+void Swap16(char* _values, size_t _count) {
+  const size_t pairs = _count / 2;
+  for (size_t i = 0; i < pairs; ++i) {
+    char* pair = _values + i * 4;
+    uint32_t word;
+    std::memcpy(&word, pair, 4);
+    word = ((word >> 8) & 0x00ff00ff) | ((word << 8) & 0xff00ff00);
+    std::memcpy(pair, &word, 4);
+  }
+  if (_count & 1) {
+    char* last = _values + pairs * 4;
+    const char temp = last[0];
+    last[0] = last[1];
+    last[1] = temp;
+  }
+}
+
+// Swaps the endianness of _count quantized time translation or scale keys
+// stored in _keys. All their members are 16 bits values, so bytes are swapped
+// by pairs.
+void SwapQuantizedBulkKeys(char* _keys, size_t _count) {
+  Swap16(_keys, _count * 5);
+}
+
+// Constant translations and scales archive layout matches their memory layout
+// as well, with 4 16 bits values each.
+OZZ_STATIC_ASSERT(sizeof(ConstantTranslation) == 8 &&
+                  sizeof(ConstantScale) == 8);
+
+void SwapConstants(char* _constants, size_t _count) {
+  Swap16(_constants, _count * 4);
+}
+
+template<typename _Key>
+void SaveBulkKeys(io::OArchive& _archive, ozz::Range<const _Key> _keys,
+                  void (*_swap)(char*, size_t)) {
+  if (!_archive.endian_swap()) {
+    _archive.SaveBinary(_keys.begin, _keys.Size());
+    return;
+  }
+  // Keys are swapped in a temporary buffer, as they are const.
+  char buffer[kKeyChunkSize * sizeof(_Key)];
+  for (const _Key* key = _keys.begin; key < _keys.end;) {
+    const size_t count =
+      math::Min(kKeyChunkSize, static_cast<size_t>(_keys.end - key));
+    std::memcpy(buffer, key, count * sizeof(_Key));
+    _swap(buffer, count);
+    _archive.SaveBinary(buffer, count * sizeof(_Key));
+    key += count;
+  }
+}
+
+template<typename _Key>
+void LoadBulkKeys(io::IArchive& _archive, ozz::Range<_Key> _keys,
+                  void (*_swap)(char*, size_t)) {
+  _archive.LoadBinary(_keys.begin, _keys.Size());
+  if (_archive.endian_swap()) {  // Can swap in-place.
+    _swap(reinterpret_cast<char*>(_keys.begin), _keys.Count());
+  }
+}
+
+// Rotation keys archive layout differs from their memory layout, because of
+// track/largest/sign bit fields: time (4 bytes, or 2 bytes for quantized
+// times), track (2 bytes), largest (1 byte), sign (1 byte) and 3 values
+// (3 * 2 bytes). They are converted by chunks of keys.
+const size_t kRotationKeyArchiveSize = 14;
+const size_t kQuantizedRotationKeyArchiveSize = 12;
+OZZ_STATIC_ASSERT(sizeof(bool) == 1);
+
+// Swaps the endianness of _count rotation keys stored with their archive
+// layout in _keys, in a single pass over memory. Largest and sign bytes don't
+// need swapping.
+void SwapRotationKeys(char* _keys, size_t _count) {
+  for (size_t i = 0; i < _count; ++i) {
+    char* key = _keys + i * kRotationKeyArchiveSize;
+    uint32_t time, value01;
+    uint16_t track, value2;
+    std::memcpy(&time, key + 0, 4);
+    std::memcpy(&track, key + 4, 2);
+    std::memcpy(&value01, key + 8, 4);
+    std::memcpy(&value2, key + 12, 2);
+    time = (time >> 24) | ((time >> 8) & 0x0000ff00) |
+           ((time << 8) & 0x00ff0000) | (time << 24);
+    track = static_cast<uint16_t>((track >> 8) | (track << 8));
+    value01 = ((value01 >> 8) & 0x00ff00ff) | ((value01 << 8) & 0xff00ff00);
+    value2 = static_cast<uint16_t>((value2 >> 8) | (value2 << 8));
+    std::memcpy(key + 0, &time, 4);
+    std::memcpy(key + 4, &track, 2);
+    std::memcpy(key + 8, &value01, 4);
+    std::memcpy(key + 12, &value2, 2);
+  }
+}
+
+// Quantized time rotation keys variant of SwapRotationKeys.
+void SwapQuantizedRotationKeys(char* _keys, size_t _count) {
+  for (size_t i = 0; i < _count; ++i) {
+    char* key = _keys + i * kQuantizedRotationKeyArchiveSize;
+    uint32_t time_track, value01;
+    uint16_t value2;
+    std::memcpy(&time_track, key + 0, 4);
+    std::memcpy(&value01, key + 6, 4);
+    std::memcpy(&value2, key + 10, 2);
+    time_track = ((time_track >> 8) & 0x00ff00ff) |
+                 ((time_track << 8) & 0xff00ff00);
+    value01 = ((value01 >> 8) & 0x00ff00ff) | ((value01 << 8) & 0xff00ff00);
+    value2 = static_cast<uint16_t>((value2 >> 8) | (value2 << 8));
+    std::memcpy(key + 0, &time_track, 4);
+    std::memcpy(key + 6, &value01, 4);
+    std::memcpy(key + 10, &value2, 2);
+  }
+}
+
+// Saves rotation keys of type _Key, which is RotationKey or
+// QuantizedRotationKey. Archive layout only differs by time size.
+template<typename _Key>
+void SaveRotationKeys(io::OArchive& _archive, ozz::Range<const _Key> _keys,
+                      void (*_swap)(char*, size_t)) {
+  const size_t time_size = sizeof(_keys.begin->time);
+  const size_t key_size = time_size + 10;
+  char buffer[kKeyChunkSize * kRotationKeyArchiveSize];
+  for (const _Key* key = _keys.begin; key < _keys.end;) {
+    const size_t count =
+      math::Min(kKeyChunkSize, static_cast<size_t>(_keys.end - key));
+    char* cursor = buffer;
+    for (const _Key* end = key + count; key < end; ++key, cursor += key_size) {
+      const uint16_t track = key->track;
+      std::memcpy(cursor + 0, &key->time, time_size);
+      std::memcpy(cursor + time_size, &track, 2);
+      cursor[time_size + 2] = static_cast<char>(key->largest);
+      cursor[time_size + 3] = static_cast<char>(key->sign);
+      std::memcpy(cursor + time_size + 4, key->value, 6);
+    }
+    if (_archive.endian_swap()) {
+      _swap(buffer, count);
+    }
+    _archive.SaveBinary(buffer, count * key_size);
+  }
+}
+
+template<typename _Key>
+void LoadRotationKeys(io::IArchive& _archive, ozz::Range<_Key> _keys,
+                      void (*_swap)(char*, size_t)) {
+  const size_t time_size = sizeof(_keys.begin->time);
+  const size_t key_size = time_size + 10;
+  char buffer[kKeyChunkSize * kRotationKeyArchiveSize];
+  for (_Key* key = _keys.begin; key < _keys.end;) {
+    const size_t count =
+      math::Min(kKeyChunkSize, static_cast<size_t>(_keys.end - key));
+    _archive.LoadBinary(buffer, count * key_size);
+    if (_archive.endian_swap()) {
+      _swap(buffer, count);
+    }
+    const char* cursor = buffer;
+    for (_Key* end = key + count; key < end; ++key, cursor += key_size) {
+      uint16_t track;
+      std::memcpy(&key->time, cursor + 0, time_size);
+      std::memcpy(&track, cursor + time_size, 2);
+      key->track = track;
+      key->largest = cursor[time_size + 2] & 3;
+      key->sign = cursor[time_size + 3] & 1;
+      std::memcpy(key->value, cursor + time_size + 4, 6);
+    }
+  }
+}
+
+// Packed rotation keys archive layout: time (2 bytes), track (2 bytes),
+// largest (1 byte), sign (1 byte) and packed value (4 bytes).
+const size_t kPackedRotationKeyArchiveSize = 10;
+
+// Swaps the endianness of _count packed rotation keys stored with their archive
+// layout in _keys.
+void SwapPackedRotationKeys(char* _keys, size_t _count) {
+  for (size_t i = 0; i < _count; ++i) {
+    char* key = _keys + i * kPackedRotationKeyArchiveSize;
+    uint32_t time_track, value;
+    std::memcpy(&time_track, key + 0, 4);
+    std::memcpy(&value, key + 6, 4);
+    time_track = ((time_track >> 8) & 0x00ff00ff) |
+                 ((time_track << 8) & 0xff00ff00);
+    value = (value >> 24) | ((value >> 8) & 0x0000ff00) |
+            ((value << 8) & 0x00ff0000) | (value << 24);
+    std::memcpy(key + 0, &time_track, 4);
+    std::memcpy(key + 6, &value, 4);
+  }
+}
+
+void SavePackedRotationKeys(io::OArchive& _archive,
+                            ozz::Range<const PackedRotationKey> _keys) {
+  char buffer[kKeyChunkSize * kPackedRotationKeyArchiveSize];
+  for (const PackedRotationKey* key = _keys.begin; key < _keys.end;) {
+    const size_t count =
+      math::Min(kKeyChunkSize, static_cast<size_t>(_keys.end - key));
+    char* cursor = buffer;
+    for (const PackedRotationKey* end = key + count; key < end;
+         ++key, cursor += kPackedRotationKeyArchiveSize) {
+      const uint16_t track = key->track;
+      std::memcpy(cursor + 0, &key->time, 2);
+      std::memcpy(cursor + 2, &track, 2);
+      cursor[4] = static_cast<char>(key->largest);
+      cursor[5] = static_cast<char>(key->sign);
+      std::memcpy(cursor + 6, &key->value, 4);
+    }
+    if (_archive.endian_swap()) {
+      SwapPackedRotationKeys(buffer, count);
+    }
+    _archive.SaveBinary(buffer, count * kPackedRotationKeyArchiveSize);
+  }
+}
+
+void LoadPackedRotationKeys(io::IArchive& _archive,
+                            ozz::Range<PackedRotationKey> _keys) {
+  char buffer[kKeyChunkSize * kPackedRotationKeyArchiveSize];
+  for (PackedRotationKey* key = _keys.begin; key < _keys.end;) {
+    const size_t count =
+      math::Min(kKeyChunkSize, static_cast<size_t>(_keys.end - key));
+    _archive.LoadBinary(buffer, count * kPackedRotationKeyArchiveSize);
+    if (_archive.endian_swap()) {
+      SwapPackedRotationKeys(buffer, count);
+    }
+    const char* cursor = buffer;
+    for (PackedRotationKey* end = key + count; key < end;
+         ++key, cursor += kPackedRotationKeyArchiveSize) {
+      uint16_t track;
+      std::memcpy(&key->time, cursor + 0, 2);
+      std::memcpy(&track, cursor + 2, 2);
+      key->track = track;
+      key->largest = cursor[4] & 3;
+      key->sign = cursor[5] & 1;
+      std::memcpy(&key->value, cursor + 6, 4);
+    }
+  }
+}
+
+// Constant rotations archive layout: track (2 bytes), largest (1 byte), sign
+// (1 byte) and 3 values (3 * 2 bytes).
+const size_t kConstantRotationArchiveSize = 10;
+
+// Swaps the endianness of _count constant rotations stored with their archive
+// layout in _constants.
+void SwapConstantRotations(char* _constants, size_t _count) {
+  for (size_t i = 0; i < _count; ++i) {
+    char* constant = _constants + i * kConstantRotationArchiveSize;
+    Swap16(constant + 0, 1);
+    Swap16(constant + 4, 3);
+  }
+}
+
+void SaveConstantRotations(io::OArchive& _archive,
+                           ozz::Range<const ConstantRotation> _constants) {
+  char buffer[kKeyChunkSize * kConstantRotationArchiveSize];
+  for (const ConstantRotation* constant = _constants.begin;
+       constant < _constants.end;) {
+    const size_t count = math::Min(
+      kKeyChunkSize, static_cast<size_t>(_constants.end - constant));
+    char* cursor = buffer;
+    for (const ConstantRotation* end = constant + count; constant < end;
+         ++constant, cursor += kConstantRotationArchiveSize) {
+      const uint16_t track = constant->track;
+      std::memcpy(cursor + 0, &track, 2);
+      cursor[2] = static_cast<char>(constant->largest);
+      cursor[3] = static_cast<char>(constant->sign);
+      std::memcpy(cursor + 4, constant->value, 6);
+    }
+    if (_archive.endian_swap()) {
+      SwapConstantRotations(buffer, count);
+    }
+    _archive.SaveBinary(buffer, count * kConstantRotationArchiveSize);
+  }
+}
+
+void LoadConstantRotations(io::IArchive& _archive,
+                           ozz::Range<ConstantRotation> _constants) {
+  char buffer[kKeyChunkSize * kConstantRotationArchiveSize];
+  for (ConstantRotation* constant = _constants.begin;
+       constant < _constants.end;) {
+    const size_t count = math::Min(
+      kKeyChunkSize, static_cast<size_t>(_constants.end - constant));
+    _archive.LoadBinary(buffer, count * kConstantRotationArchiveSize);
+    if (_archive.endian_swap()) {
+      SwapConstantRotations(buffer, count);
+    }
+    const char* cursor = buffer;
+    for (ConstantRotation* end = constant + count; constant < end;
+         ++constant, cursor += kConstantRotationArchiveSize) {
+      uint16_t track;
+      std::memcpy(&track, cursor + 0, 2);
+      constant->track = track;
+      constant->largest = cursor[2] & 3;
+      constant->sign = cursor[3] & 1;
+      std::memcpy(constant->value, cursor + 4, 6);
+    }
+  }
+}
+
+// Fills _tracks with the index of the _num_tracks joints that aren't listed in
+// _constants, which is sorted by joint index.
+template<typename _Constant>
+void FillTracks(ozz::Range<const _Constant> _constants, int _num_tracks,
+                ozz::Range<uint16_t> _tracks) {
+  const _Constant* constant = _constants.begin;
+  uint16_t* track = _tracks.begin;
+  for (int i = 0; i < _num_tracks; ++i) {
+    if (constant < _constants.end && constant->track == i) {
+      ++constant;
+    } else if (track < _tracks.end) {
+      *track++ = static_cast<uint16_t>(i);
+    }
+  }
+  assert(constant == _constants.end && track == _tracks.end &&
+         "Constants must be sorted by joint index.");
+}
+
+// Allocates _count keys of type _Key from _buffer to _keys.
+template<typename _Key>
+char* AllocateKeys(char* _buffer, size_t _count, ozz::Range<_Key>* _keys) {
+  _keys->begin = reinterpret_cast<_Key*>(_buffer);
+  assert(math::IsAligned(_keys->begin, OZZ_ALIGN_OF(_Key)));
+  _buffer += _count * sizeof(_Key);
+  _keys->end = reinterpret_cast<_Key*>(_buffer);
+  return _buffer;
+}
+}  // namespace
+
 Animation::Animation()
     : duration_(0.f),
       num_tracks_(0),
-      name_(NULL) {
+      name_(NULL),
+      rotation_format_(kRotationStandard),
+      time_format_(kTimeFloat),
+      in_place_(false) {
 }
 
 Animation::~Animation() {
   Deallocate();
 }
 
-void Animation::Allocate(size_t name_len, size_t _translation_count,
-                         size_t _rotation_count, size_t _scale_count) {
+size_t Animation::ComputeBufferSize(const Counts& _counts) const {
+  // Seek tables and animated tracks sizes depend on the number of tracks,
+  // which must be set.
+  const int num_tracks = num_soa_tracks() * 4;
+  const size_t seek_tables_size =
+    ComputeSeekTableSize(
+      _counts.translations,
+      CountKeyTracks(num_soa_tracks(), _counts.constant_translations)) +
+    ComputeSeekTableSize(
+      _counts.rotations,
+      CountKeyTracks(num_soa_tracks(), _counts.constant_rotations)) +
+    ComputeSeekTableSize(
+      _counts.scales,
+      CountKeyTracks(num_soa_tracks(), _counts.constant_scales));
+  const size_t num_animated =
+    num_tracks * 3 - _counts.constant_translations -
+    _counts.constant_rotations - _counts.constant_scales;
+
+  // Key sizes depend on rotation and time formats, which must be set.
+  const bool quantized = time_format_ == kTimeQuantized;
+  const size_t translation_size = quantized ?
+    sizeof(QuantizedTranslationKey) : sizeof(TranslationKey);
+  const size_t rotation_size = rotation_format_ == kRotationPacked ?
+    sizeof(PackedRotationKey) :
+    (quantized ? sizeof(QuantizedRotationKey) : sizeof(RotationKey));
+  const size_t scale_size = quantized ?
+    sizeof(QuantizedScaleKey) : sizeof(ScaleKey);
+
+  return (_counts.name_len > 0 ? _counts.name_len + 1 : 0) +
+         _counts.translations * translation_size +
+         _counts.rotations * rotation_size +
+         _counts.scales * scale_size +
+         _counts.constant_translations * sizeof(ConstantTranslation) +
+         _counts.constant_rotations * sizeof(ConstantRotation) +
+         _counts.constant_scales * sizeof(ConstantScale) +
+         num_animated * sizeof(uint16_t) +
+         seek_tables_size;
+}
+
+void Animation::Allocate(const Counts& _counts) {
+  // Compute overall size and allocate a single buffer for all the data.
+  const size_t buffer_size = ComputeBufferSize(_counts);
+  char* buffer = memory::default_allocator()->Allocate<char>(buffer_size);
+
+  FixUp(buffer, _counts);
+}
+
+void Animation::FixUp(char* _buffer, const Counts& _counts) {
   // Distributes buffer memory while ensuring proper alignment (serves larger
   // alignment values first).
   OZZ_STATIC_ASSERT(
+    OZZ_ALIGN_OF(PackedRotationKey) >= OZZ_ALIGN_OF(ConstantTranslation) &&
+    OZZ_ALIGN_OF(ConstantTranslation) >= OZZ_ALIGN_OF(ConstantRotation) &&
+    OZZ_ALIGN_OF(ConstantRotation) >= OZZ_ALIGN_OF(ConstantScale) &&
+    OZZ_ALIGN_OF(ConstantScale) >= OZZ_ALIGN_OF(TranslationKey) &&
     OZZ_ALIGN_OF(TranslationKey) >= OZZ_ALIGN_OF(RotationKey) &&
     OZZ_ALIGN_OF(RotationKey) >= OZZ_ALIGN_OF(ScaleKey) &&
-    OZZ_ALIGN_OF(ScaleKey) >= OZZ_ALIGN_OF(char));
+    OZZ_ALIGN_OF(ScaleKey) >= OZZ_ALIGN_OF(int) &&
+    OZZ_ALIGN_OF(int) >= OZZ_ALIGN_OF(float) &&
+    OZZ_ALIGN_OF(float) >= OZZ_ALIGN_OF(QuantizedTranslationKey) &&
+    OZZ_ALIGN_OF(QuantizedTranslationKey) >=
+      OZZ_ALIGN_OF(QuantizedRotationKey) &&
+    OZZ_ALIGN_OF(QuantizedRotationKey) >= OZZ_ALIGN_OF(QuantizedScaleKey) &&
+    OZZ_ALIGN_OF(QuantizedScaleKey) >= OZZ_ALIGN_OF(uint16_t) &&
+    OZZ_ALIGN_OF(uint16_t) >= OZZ_ALIGN_OF(char));
 
   assert(name_ == NULL && translations_.Size() == 0 && rotations_.Size() == 0 &&
-         scales_.Size() == 0);
-
-  // Compute overall size and allocate a single buffer for all the data.
-  const size_t buffer_size =
-    (name_len > 0 ? name_len + 1 : 0) +
-    _translation_count * sizeof(TranslationKey) +
-    _rotation_count * sizeof(RotationKey) +
-    _scale_count * sizeof(ScaleKey);
-  char* buffer = memory::default_allocator()->Allocate<char>(buffer_size);
-
-  // Fix up pointers
-  translations_.begin = reinterpret_cast<TranslationKey*>(buffer);
-  assert(math::IsAligned(translations_.begin, OZZ_ALIGN_OF(TranslationKey)));
-  buffer += _translation_count * sizeof(TranslationKey);
-  translations_.end = reinterpret_cast<TranslationKey*>(buffer);
-
-  rotations_.begin = reinterpret_cast<RotationKey*>(buffer);
-  assert(math::IsAligned(rotations_.begin, OZZ_ALIGN_OF(RotationKey)));
-  buffer += _rotation_count * sizeof(RotationKey);
-  rotations_.end = reinterpret_cast<RotationKey*>(buffer);
-
-  scales_.begin = reinterpret_cast<ScaleKey*>(buffer);
-  assert(math::IsAligned(scales_.begin, OZZ_ALIGN_OF(ScaleKey)));
-  buffer += _scale_count * sizeof(ScaleKey);
-  scales_.end = reinterpret_cast<ScaleKey*>(buffer);
+         packed_rotations_.Size() == 0 && scales_.Size() == 0 &&
+         quantized_translations_.Size() == 0 &&
+         quantized_rotations_.Size() == 0 && quantized_scales_.Size() == 0 &&
+         constant_translations_.Size() == 0 &&
+         constant_rotations_.Size() == 0 && constant_scales_.Size() == 0);
+
+  const int num_tracks = num_soa_tracks() * 4;
+  const bool packed = rotation_format_ == kRotationPacked;
+  const bool quantized = time_format_ == kTimeQuantized;
+
+  // Fix up pointers. Only buffers matching rotation and time formats are
+  // given keys, others are empty.
+  _buffer = AllocateKeys(
+    _buffer, packed ? _counts.rotations : 0, &packed_rotations_);
+  _buffer = AllocateKeys(
+    _buffer, _counts.constant_translations, &constant_translations_);
+  _buffer = AllocateKeys(
+    _buffer, _counts.constant_rotations, &constant_rotations_);
+  _buffer = AllocateKeys(_buffer, _counts.constant_scales, &constant_scales_);
+  _buffer = AllocateKeys(
+    _buffer, quantized ? 0 : _counts.translations, &translations_);
+  _buffer = AllocateKeys(
+    _buffer, packed || quantized ? 0 : _counts.rotations, &rotations_);
+  _buffer = AllocateKeys(_buffer, quantized ? 0 : _counts.scales, &scales_);
+
+  _buffer = AllocateSeekTable(
+    _buffer, _counts.translations,
+    CountKeyTracks(num_soa_tracks(), _counts.constant_translations),
+    &translations_seek_table_);
+  _buffer = AllocateSeekTable(
+    _buffer, _counts.rotations,
+    CountKeyTracks(num_soa_tracks(), _counts.constant_rotations),
+    &rotations_seek_table_);
+  _buffer = AllocateSeekTable(
+    _buffer, _counts.scales,
+    CountKeyTracks(num_soa_tracks(), _counts.constant_scales),
+    &scales_seek_table_);
+
+  _buffer = AllocateKeys(
+    _buffer, quantized ? _counts.translations : 0, &quantized_translations_);
+  _buffer = AllocateKeys(
+    _buffer, quantized && !packed ? _counts.rotations : 0,
+    &quantized_rotations_);
+  _buffer = AllocateKeys(
+    _buffer, quantized ? _counts.scales : 0, &quantized_scales_);
+
+  _buffer = AllocateKeys(
+    _buffer, num_tracks - _counts.constant_translations, &translation_tracks_);
+  _buffer = AllocateKeys(
+    _buffer, num_tracks - _counts.constant_rotations, &rotation_tracks_);
+  _buffer = AllocateKeys(
+    _buffer, num_tracks - _counts.constant_scales, &scale_tracks_);
 
   // Let name be NULL if animation has no name. Allows to avoid allocating this
   // buffer in the constructor of empty animations.
-  name_ = reinterpret_cast<char*>(name_len > 0 ? buffer : NULL);
+  name_ = reinterpret_cast<char*>(_counts.name_len > 0 ? _buffer : NULL);
   assert(math::IsAligned(name_, OZZ_ALIGN_OF(char)));
 }
 
 void Animation::Deallocate() {
 
-  memory::default_allocator()->Deallocate(translations_.begin);
+  // In-place animations do not own their buffer.
+  if (!in_place_) {
+    memory::default_allocator()->Deallocate(packed_rotations_.begin);
+  }
+  in_place_ = false;
 
   name_ = NULL;
+  rotation_format_ = kRotationStandard;
+  time_format_ = kTimeFloat;
+  packed_rotations_ = ozz::Range<PackedRotationKey>();
   translations_ = ozz::Range<TranslationKey>();
   rotations_ = ozz::Range<RotationKey>();
   scales_ = ozz::Range<ScaleKey>();
+  quantized_translations_ = ozz::Range<QuantizedTranslationKey>();
+  quantized_rotations_ = ozz::Range<QuantizedRotationKey>();
+  quantized_scales_ = ozz::Range<QuantizedScaleKey>();
+  constant_translations_ = ozz::Range<ConstantTranslation>();
+  constant_rotations_ = ozz::Range<ConstantRotation>();
+  constant_scales_ = ozz::Range<ConstantScale>();
+  translation_tracks_ = ozz::Range<uint16_t>();
+  rotation_tracks_ = ozz::Range<uint16_t>();
+  scale_tracks_ = ozz::Range<uint16_t>();
+  translations_seek_table_ = SeekTable();
+  rotations_seek_table_ = SeekTable();
+  scales_seek_table_ = SeekTable();
+}
+
+Animation::Counts Animation::GetCounts() const {
+  Counts counts;
+  counts.name_len = name_ ? std::strlen(name_) : 0;
+  counts.translations =
+    translations_.Count() + quantized_translations_.Count();
+  counts.rotations =
+    rotations_.Count() + quantized_rotations_.Count() +
+    packed_rotations_.Count();
+  counts.scales = scales_.Count() + quantized_scales_.Count();
+  counts.constant_translations = constant_translations_.Count();
+  counts.constant_rotations = constant_rotations_.Count();
+  counts.constant_scales = constant_scales_.Count();
+  return counts;
+}
+
+void Animation::BuildTracks() {
+  const int num_tracks = num_soa_tracks() * 4;
+  FillTracks<ConstantTranslation>(
+    constant_translations_, num_tracks, translation_tracks_);
+  FillTracks<ConstantRotation>(
+    constant_rotations_, num_tracks, rotation_tracks_);
+  FillTracks<ConstantScale>(constant_scales_, num_tracks, scale_tracks_);
+}
+
+void Animation::BuildSeekTables() {
+  const int num_translations = num_soa_translation_tracks() * 4;
+  const int num_rotations = num_soa_rotation_tracks() * 4;
+  const int num_scales = num_soa_scale_tracks() * 4;
+  if (time_format_ == kTimeQuantized) {
+    FillSeekTable<QuantizedTranslationKey>(
+      quantized_translations_, num_translations, &translations_seek_table_);
+    FillSeekTable<QuantizedScaleKey>(
+      quantized_scales_, num_scales, &scales_seek_table_);
+  } else {
+    FillSeekTable<TranslationKey>(
+      translations_, num_translations, &translations_seek_table_);
+    FillSeekTable<ScaleKey>(scales_, num_scales, &scales_seek_table_);
+  }
+  if (rotation_format_ == kRotationPacked) {
+    FillSeekTable<PackedRotationKey>(
+      packed_rotations_, num_rotations, &rotations_seek_table_);
+  } else if (time_format_ == kTimeQuantized) {
+    FillSeekTable<QuantizedRotationKey>(
+      quantized_rotations_, num_rotations, &rotations_seek_table_);
+  } else {
+    FillSeekTable<RotationKey>(
+      rotations_, num_rotations, &rotations_seek_table_);
+  }
 }
 
 size_t Animation::size() const {
   const size_t size =
-    sizeof(*this) + translations_.Size() + rotations_.Size() + scales_.Size();
+    sizeof(*this) + translations_.Size() + rotations_.Size() +
+    packed_rotations_.Size() + scales_.Size() +
+    quantized_translations_.Size() + quantized_rotations_.Size() +
+    quantized_scales_.Size() +
+    constant_translations_.Size() + constant_rotations_.Size() +
+    constant_scales_.Size() +
+    translation_tracks_.Size() + rotation_tracks_.Size() +
+    scale_tracks_.Size() +
+    translations_seek_table_.keys.Size() +
+    translations_seek_table_.times.Size() +
+    rotations_seek_table_.keys.Size() + rotations_seek_table_.times.Size() +
+    scales_seek_table_.keys.Size() + scales_seek_table_.times.Size();
   return size;
 }
 
@@ -114,43 +720,46 @@ void Animation::Save(ozz::io::OArchive& _archive) const {
   _archive << duration_;
   _archive << static_cast<int32_t>(num_tracks_);
 
-  const size_t name_len = name_ ? std::strlen(name_) : 0;
-  _archive << static_cast<int32_t>(name_len);
-
-  const ptrdiff_t translation_count = translations_.Count();
-  _archive << static_cast<int32_t>(translation_count);
-  const ptrdiff_t rotation_count = rotations_.Count();
-  _archive << static_cast<int32_t>(rotation_count);
-  const ptrdiff_t scale_count = scales_.Count();
-  _archive << static_cast<int32_t>(scale_count);
-
-  _archive << ozz::io::MakeArray(name_, name_len);
-
-  for (ptrdiff_t i = 0; i < translation_count; ++i) {
-    const TranslationKey& key = translations_.begin[i];
-    _archive << key.time;
-    _archive << key.track;
-    _archive << ozz::io::MakeArray(key.value);
+  const Counts counts = GetCounts();
+  _archive << static_cast<int32_t>(counts.name_len);
+
+  _archive << static_cast<int32_t>(counts.translations);
+  _archive << static_cast<int32_t>(counts.rotations);
+  _archive << static_cast<int32_t>(counts.scales);
+  _archive << static_cast<uint8_t>(rotation_format_);
+  _archive << static_cast<uint8_t>(time_format_);
+  _archive << static_cast<int32_t>(counts.constant_translations);
+  _archive << static_cast<int32_t>(counts.constant_rotations);
+  _archive << static_cast<int32_t>(counts.constant_scales);
+
+  _archive << ozz::io::MakeArray(name_, counts.name_len);
+
+  if (time_format_ == kTimeQuantized) {
+    SaveBulkKeys<QuantizedTranslationKey>(
+      _archive, quantized_translations_, SwapQuantizedBulkKeys);
+  } else {
+    SaveBulkKeys<TranslationKey>(_archive, translations_, SwapBulkKeys);
   }
-
-  for (ptrdiff_t i = 0; i < rotation_count; ++i) {
-    const RotationKey& key = rotations_.begin[i];
-    _archive << key.time;
-    uint16_t track = key.track;
-    _archive << track;
-    uint8_t largest = key.largest;
-    _archive << largest;
-    bool sign = key.sign;
-    _archive << sign;
-    _archive << ozz::io::MakeArray(key.value);
+  if (rotation_format_ == kRotationPacked) {
+    SavePackedRotationKeys(_archive, packed_rotations_);
+  } else if (time_format_ == kTimeQuantized) {
+    SaveRotationKeys<QuantizedRotationKey>(
+      _archive, quantized_rotations_, SwapQuantizedRotationKeys);
+  } else {
+    SaveRotationKeys<RotationKey>(_archive, rotations_, SwapRotationKeys);
   }
-
-  for (ptrdiff_t i = 0; i < scale_count; ++i) {
-    const ScaleKey& key = scales_.begin[i];
-    _archive << key.time;
-    _archive << key.track;
-    _archive << ozz::io::MakeArray(key.value);
+  if (time_format_ == kTimeQuantized) {
+    SaveBulkKeys<QuantizedScaleKey>(
+      _archive, quantized_scales_, SwapQuantizedBulkKeys);
+  } else {
+    SaveBulkKeys<ScaleKey>(_archive, scales_, SwapBulkKeys);
   }
+
+  // Animated tracks aren't serialized, they are deduced from constants.
+  SaveBulkKeys<ConstantTranslation>(
+    _archive, constant_translations_, SwapConstants);
+  SaveConstantRotations(_archive, constant_rotations_);
+  SaveBulkKeys<ConstantScale>(_archive, constant_scales_, SwapConstants);
 }
 
 void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
@@ -160,8 +769,10 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   duration_ = 0.f;
   num_tracks_ = 0;
 
-  // No retro-compatibility with anterior versions.
-  if (_version != 4) {
+  // No retro-compatibility with versions anterior to 4. Version 4 doesn't
+  // store rotation format (standard), versions 4 and 5 don't store time
+  // format (float), and versions 4 to 6 don't have constant tracks.
+  if (_version < 4 || _version > 7) {
     return;
   }
 
@@ -179,41 +790,218 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   _archive >> rotation_count;
   int32_t scale_count;
   _archive >> scale_count;
+  uint8_t rotation_format = kRotationStandard;
+  if (_version >= 5) {
+    _archive >> rotation_format;
+  }
+  rotation_format_ = rotation_format == kRotationPacked ?
+    kRotationPacked : kRotationStandard;
+  uint8_t time_format = kTimeFloat;
+  if (_version >= 6) {
+    _archive >> time_format;
+  }
+  time_format_ = time_format == kTimeQuantized ? kTimeQuantized : kTimeFloat;
+  int32_t constant_counts[3] = {0, 0, 0};
+  if (_version >= 7) {
+    _archive >> ozz::io::MakeArray(constant_counts);
+  }
+  for (int i = 0; i < 3; ++i) {
+    if (constant_counts[i] < 0 || constant_counts[i] > num_soa_tracks() * 4) {
+      num_tracks_ = 0;
+      return;
+    }
+  }
 
-  Allocate(name_len, translation_count, rotation_count, scale_count);
+  Counts counts;
+  counts.name_len = name_len;
+  counts.translations = translation_count;
+  counts.rotations = rotation_count;
+  counts.scales = scale_count;
+  counts.constant_translations = constant_counts[0];
+  counts.constant_rotations = constant_counts[1];
+  counts.constant_scales = constant_counts[2];
+  Allocate(counts);
 
   if (name_) {  // NULL name_ is supported.
     _archive >> ozz::io::MakeArray(name_, name_len);
     name_[name_len] = 0;
   }
 
-  for (int i = 0; i < translation_count; ++i) {
-    TranslationKey& key = translations_.begin[i];
-    _archive >> key.time;
-    _archive >> key.track;
-    _archive >> ozz::io::MakeArray(key.value);
-  }
-
-  for (int i = 0; i < rotation_count; ++i) {
-    RotationKey& key = rotations_.begin[i];
-    _archive >> key.time;
-    uint16_t track;
-    _archive >> track;
-    key.track = track;
-    uint8_t largest;
-    _archive >> largest;
-    key.largest = largest & 3;
-    bool sign;
-    _archive >> sign;
-    key.sign = sign & 1;
-    _archive >> ozz::io::MakeArray(key.value);
-  }
-
-  for (int i = 0; i < scale_count; ++i) {
-    ScaleKey& key = scales_.begin[i];
-    _archive >> key.time;
-    _archive >> key.track;
-    _archive >> ozz::io::MakeArray(key.value);
+  if (time_format_ == kTimeQuantized) {
+    LoadBulkKeys<QuantizedTranslationKey>(
+      _archive, quantized_translations_, SwapQuantizedBulkKeys);
+  } else {
+    LoadBulkKeys<TranslationKey>(_archive, translations_, SwapBulkKeys);
+  }
+  if (rotation_format_ == kRotationPacked) {
+    LoadPackedRotationKeys(_archive, packed_rotations_);
+  } else if (time_format_ == kTimeQuantized) {
+    LoadRotationKeys<QuantizedRotationKey>(
+      _archive, quantized_rotations_, SwapQuantizedRotationKeys);
+  } else {
+    LoadRotationKeys<RotationKey>(_archive, rotations_, SwapRotationKeys);
+  }
+  if (time_format_ == kTimeQuantized) {
+    LoadBulkKeys<QuantizedScaleKey>(
+      _archive, quantized_scales_, SwapQuantizedBulkKeys);
+  } else {
+    LoadBulkKeys<ScaleKey>(_archive, scales_, SwapBulkKeys);
+  }
+
+  LoadBulkKeys<ConstantTranslation>(
+    _archive, constant_translations_, SwapConstants);
+  LoadConstantRotations(_archive, constant_rotations_);
+  LoadBulkKeys<ConstantScale>(_archive, constant_scales_, SwapConstants);
+
+  // Animated tracks and seek tables aren't serialized, they are rebuilt from
+  // loaded constants and keys.
+  BuildTracks();
+  BuildSeekTables();
+}
+
+void Animation::SaveInPlace(ozz::io::OArchive& _archive) const {
+  assert(!_archive.endian_swap() &&
+         "In-place archives must have native endianness.");
+
+  // Stores memory layout properties, so they can be validated when loading.
+  _archive << static_cast<uint32_t>(sizeof(TranslationKey));
+  _archive << static_cast<uint32_t>(sizeof(RotationKey));
+  _archive << static_cast<uint32_t>(sizeof(PackedRotationKey));
+  _archive << static_cast<uint32_t>(sizeof(ScaleKey));
+  _archive << static_cast<uint32_t>(sizeof(QuantizedTranslationKey));
+  _archive << static_cast<uint32_t>(sizeof(QuantizedRotationKey));
+  _archive << static_cast<uint32_t>(sizeof(QuantizedScaleKey));
+  _archive << static_cast<uint32_t>(sizeof(ConstantTranslation));
+  _archive << static_cast<uint32_t>(sizeof(ConstantRotation));
+  _archive << static_cast<uint32_t>(sizeof(ConstantScale));
+  _archive << static_cast<int32_t>(kSeekInterval);
+  _archive << static_cast<uint8_t>(rotation_format_);
+  _archive << static_cast<uint8_t>(time_format_);
+
+  _archive << duration_;
+  _archive << static_cast<int32_t>(num_tracks_);
+
+  const Counts counts = GetCounts();
+  const int32_t counts_array[] = {
+    static_cast<int32_t>(counts.name_len),
+    static_cast<int32_t>(counts.translations),
+    static_cast<int32_t>(counts.rotations),
+    static_cast<int32_t>(counts.scales),
+    static_cast<int32_t>(counts.constant_translations),
+    static_cast<int32_t>(counts.constant_rotations),
+    static_cast<int32_t>(counts.constant_scales)};
+  _archive << ozz::io::MakeArray(counts_array);
+
+  // Stores buffers as-is, in the order they are distributed by FixUp, seek
+  // tables and animated tracks included.
+  io::PadInPlace(_archive, OZZ_ALIGN_OF(PackedRotationKey));
+  _archive.SaveBinary(packed_rotations_.begin, packed_rotations_.Size());
+  _archive.SaveBinary(constant_translations_.begin,
+                      constant_translations_.Size());
+  _archive.SaveBinary(constant_rotations_.begin, constant_rotations_.Size());
+  _archive.SaveBinary(constant_scales_.begin, constant_scales_.Size());
+  _archive.SaveBinary(translations_.begin, translations_.Size());
+  _archive.SaveBinary(rotations_.begin, rotations_.Size());
+  _archive.SaveBinary(scales_.begin, scales_.Size());
+  const SeekTable* tables[] = {
+    &translations_seek_table_, &rotations_seek_table_, &scales_seek_table_};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(tables); ++i) {
+    _archive.SaveBinary(tables[i]->keys.begin, tables[i]->keys.Size());
+    _archive.SaveBinary(tables[i]->times.begin, tables[i]->times.Size());
+  }
+  _archive.SaveBinary(quantized_translations_.begin,
+                      quantized_translations_.Size());
+  _archive.SaveBinary(quantized_rotations_.begin,
+                      quantized_rotations_.Size());
+  _archive.SaveBinary(quantized_scales_.begin, quantized_scales_.Size());
+  _archive.SaveBinary(translation_tracks_.begin, translation_tracks_.Size());
+  _archive.SaveBinary(rotation_tracks_.begin, rotation_tracks_.Size());
+  _archive.SaveBinary(scale_tracks_.begin, scale_tracks_.Size());
+  if (counts.name_len > 0) {  // Includes null terminating character.
+    _archive.SaveBinary(name_, counts.name_len + 1);
+  }
+}
+
+void Animation::LoadInPlace(ozz::io::IArchive& _archive, uint32_t _version) {
+
+  // Destroy animation in case it was already used before.
+  Deallocate();
+  duration_ = 0.f;
+  num_tracks_ = 0;
+
+  // In-place data cannot be endian swapped.
+  if (_version != 4 || _archive.endian_swap()) {
+    return;
+  }
+
+  uint32_t sizes[10];
+  _archive >> ozz::io::MakeArray(sizes);
+  int32_t interval;
+  _archive >> interval;
+  uint8_t rotation_format;
+  _archive >> rotation_format;
+  uint8_t time_format;
+  _archive >> time_format;
+
+  float duration;
+  _archive >> duration;
+  int32_t num_tracks;
+  _archive >> num_tracks;
+
+  int32_t counts_array[7];
+  _archive >> ozz::io::MakeArray(counts_array);
+  Counts counts;
+  counts.name_len = counts_array[0];
+  counts.translations = counts_array[1];
+  counts.rotations = counts_array[2];
+  counts.scales = counts_array[3];
+  counts.constant_translations = counts_array[4];
+  counts.constant_rotations = counts_array[5];
+  counts.constant_scales = counts_array[6];
+
+  // Rejects data whose memory layout doesn't match.
+  const uint32_t expected_sizes[10] = {
+    sizeof(TranslationKey), sizeof(RotationKey), sizeof(PackedRotationKey),
+    sizeof(ScaleKey), sizeof(QuantizedTranslationKey),
+    sizeof(QuantizedRotationKey), sizeof(QuantizedScaleKey),
+    sizeof(ConstantTranslation), sizeof(ConstantRotation),
+    sizeof(ConstantScale)};
+  num_tracks_ = num_tracks;
+  const size_t max_constants = static_cast<size_t>(num_soa_tracks()) * 4;
+  if (std::memcmp(sizes, expected_sizes, sizeof(sizes)) != 0 ||
+      interval != kSeekInterval ||
+      rotation_format > kRotationPacked ||
+      time_format > kTimeQuantized ||
+      counts.constant_translations > max_constants ||
+      counts.constant_rotations > max_constants ||
+      counts.constant_scales > max_constants ||
+      !io::PadInPlace(_archive, OZZ_ALIGN_OF(PackedRotationKey))) {
+    num_tracks_ = 0;
+    return;
+  }
+  duration_ = duration;
+  rotation_format_ = static_cast<RotationFormat>(rotation_format);
+  time_format_ = static_cast<TimeFormat>(time_format);
+
+  const size_t buffer_size = ComputeBufferSize(counts);
+
+  // Uses stream memory directly if it's available and properly aligned.
+  io::Stream* stream = _archive.stream();
+  char* buffer =
+    static_cast<char*>(const_cast<void*>(stream->Map(buffer_size)));
+  if (buffer && !math::IsAligned(buffer, OZZ_ALIGN_OF(PackedRotationKey))) {
+    stream->Seek(-static_cast<int>(buffer_size), io::Stream::kCurrent);
+    buffer = NULL;
+  }
+
+  if (buffer) {
+    in_place_ = true;
+    FixUp(buffer, counts);
+  } else {
+    // Falls back to copying data. The buffer is contiguous as data are
+    // distributed in the same order they were saved.
+    Allocate(counts);
+    _archive.LoadBinary(packed_rotations_.begin, buffer_size);
   }
 }
 }  // animation
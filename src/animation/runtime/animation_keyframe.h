@@ -74,6 +74,27 @@ struct RotationKey {
   int16_t value[3];  // The quantized value of the 3 smallest components.
 };
 
+// Defines the packed rotation key frame type, an alternative to RotationKey
+// that requires 8 bytes per key instead of 12. It's selected per animation,
+// see Animation::RotationFormat.
+// Time is quantized on 16 bits, as a ratio of the animation duration (see
+// kQuantizedTimeMax). The 3 smallest components of the quaternion are quantized
+// to 11, 11 and 10 bits, packed in a single 32 bits value: bits [0:10] store
+// the first component, bits [11:21] the second and bits [22:31] the third.
+// Each component c, in range [-1/sqrt(2):1/sqrt(2)], is stored as the unsigned
+// integer round((c * sqrt(2) + 1) / 2 * (2^n - 1)), n being the number of bits.
+// Quantization error is then bounded to sqrt(2) / (2 * (2^n - 1)) per
+// component, that is 3.5e-4 for 11 bits components and 6.9e-4 for 10 bits
+// ones. Time quantization error is bounded to
+// duration / (2 * kQuantizedTimeMax).
+struct PackedRotationKey {
+  uint16_t time;  // Quantized time, as a ratio of the animation duration.
+  uint16_t track:13;  // The track this key frame belongs to.
+  uint16_t largest:2;  // The largest component of the quaternion.
+  uint16_t sign:1;  // The sign of the largest component. 1 for negative.
+  uint32_t value;  // The quantized value of the 3 smallest components.
+};
+
 // Defines the scale key frame type.
 // Scale values are stored as half precision floats with 16 bits per
 // component.
@@ -82,6 +103,57 @@ struct ScaleKey {
   uint16_t track;
   uint16_t value[3];
 };
+
+// Defines quantized time variants of translation, rotation and scale key frame
+// types, which require 10 bytes per key instead of 12. They are selected per
+// animation, see Animation::TimeFormat.
+// Time is quantized on 16 bits, as a ratio of the animation duration (see
+// kQuantizedTimeMax), with an error bounded to
+// duration / (2 * kQuantizedTimeMax). Values are stored the same way as
+// their float time counterparts.
+struct QuantizedTranslationKey {
+  uint16_t time;  // Quantized time, as a ratio of the animation duration.
+  uint16_t track;
+  uint16_t value[3];
+};
+
+struct QuantizedRotationKey {
+  uint16_t time;  // Quantized time, as a ratio of the animation duration.
+  uint16_t track:13;  // The track this key frame belongs to.
+  uint16_t largest:2;  // The largest component of the quaternion.
+  uint16_t sign:1;  // The sign of the largest component. 1 for negative.
+  int16_t value[3];  // The quantized value of the 3 smallest components.
+};
+
+struct QuantizedScaleKey {
+  uint16_t time;  // Quantized time, as a ratio of the animation duration.
+  uint16_t track;
+  uint16_t value[3];
+};
+
+// Defines constant track types. A track whose value never changes is stored
+// once as a constant, rather than as key frames (see
+// Animation::constant_translations()). Constant values are compressed the same
+// way as key frame values, track member being the joint index.
+struct ConstantTranslation {
+  uint16_t track;
+  uint16_t value[3];
+};
+
+struct ConstantRotation {
+  uint16_t track:13;  // The joint this constant belongs to.
+  uint16_t largest:2;  // The largest component of the quaternion.
+  uint16_t sign:1;  // The sign of the largest component. 1 for negative.
+  int16_t value[3];  // The quantized value of the 3 smallest components.
+};
+
+struct ConstantScale {
+  uint16_t track;
+  uint16_t value[3];
+};
+
+// Maximum value of a quantized time, matching animation duration.
+const float kQuantizedTimeMax = 65535.f;
 }  // animation
 }  // ozz
 #endif  // OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
@@ -30,10 +30,12 @@
 #include <cstddef>
 #include <cassert>
 
-#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
 
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/soa_wide.h"
 
 namespace ozz {
 namespace animation {
@@ -47,6 +49,21 @@ BlendingJob::BlendingJob()
 }
 
 namespace {
+// Validates joint weights range [_begin,_end[. Ranges are passed as pointers,
+// as simd types attributes would be ignored as Range template arguments.
+bool ValidateJointWeights(const math::SimdFloat4* _begin,
+                          const math::SimdFloat4* _end,
+                          ptrdiff_t _min_range) {
+  bool valid = true;
+  if (_begin != NULL) {
+    valid &= _end >= _begin;
+    valid &= _end - _begin >= _min_range;
+  } else {
+    valid &= _end == NULL;
+  }
+  return valid;
+}
+
 bool ValidateLayer(const BlendingJob::Layer& _layer, ptrdiff_t _min_range) {
   bool valid = true;
 
@@ -56,12 +73,8 @@ bool ValidateLayer(const BlendingJob::Layer& _layer, ptrdiff_t _min_range) {
   valid &= _layer.transform.end - _layer.transform.begin >= _min_range;
 
   // Joint weights are optional.
-  if (_layer.joint_weights.begin != NULL) {
-    valid &= _layer.joint_weights.end >= _layer.joint_weights.begin;
-    valid &= _layer.joint_weights.end - _layer.joint_weights.begin >= _min_range;
-  } else {
-    valid &= _layer.joint_weights.end == NULL;
-  }
+  valid &= ValidateJointWeights(
+    _layer.joint_weights.begin, _layer.joint_weights.end, _min_range);
   return valid;
 }
 }  // namespace
@@ -122,29 +135,50 @@ bool BlendingJob::Validate() const {
 
 namespace {
 
-// Macro that defines the process of blending the 1st pass.
+// Negates _q quaternions that are opposed to _ref ones, to be sure to choose
+// the shortest path between the two.
+OZZ_INLINE math::SoaQuaternion ShortestPath(const math::SoaQuaternion& _ref,
+                                            const math::SoaQuaternion& _q) {
+  const math::SimdFloat4 dot =
+    _ref.x * _q.x + _ref.y * _q.y + _ref.z * _q.z + _ref.w * _q.w;
+  const math::SimdInt4 sign = math::Sign(dot);
+  const math::SoaQuaternion r = {math::Xor(_q.x, sign),
+                                 math::Xor(_q.y, sign),
+                                 math::Xor(_q.z, sign),
+                                 math::Xor(_q.w, sign)};
+  return r;
+}
+
+// 8 wide version of ShortestPath.
+OZZ_INLINE math::WideSoaQuaternion ShortestPath(
+  const math::WideSoaQuaternion& _ref, const math::WideSoaQuaternion& _q) {
+  const math::SimdFloat8 dot =
+    _ref.x * _q.x + _ref.y * _q.y + _ref.z * _q.z + _ref.w * _q.w;
+  const math::SimdFloat8 sign = math::Sign(dot);
+  const math::WideSoaQuaternion r = {math::Xor(_q.x, sign),
+                                     math::Xor(_q.y, sign),
+                                     math::Xor(_q.z, sign),
+                                     math::Xor(_q.w, sign)};
+  return r;
+}
+
+// Macro that defines the process of blending the 1st pass. It applies to both
+// 4 and 8 wide soa transforms.
 #define OZZ_BLEND_1ST_PASS(_in, _simd_weight, _out) { \
   _out->translation = _in.translation * _simd_weight; \
   _out->rotation = _in.rotation * _simd_weight; \
   _out->scale = _in.scale * _simd_weight; \
 }
 
-// Macro that defines the process of blending any pass but the first.
+// Macro that defines the process of blending any pass but the first. It
+// applies to both 4 and 8 wide soa transforms.
 #define OZZ_BLEND_N_PASS(_in, _simd_weight, _out) { \
   /* Blends translation. */ \
   _out->translation = _out->translation + _in.translation * _simd_weight; \
   /* Blends rotations, negates opposed quaternions to be sure to choose*/ \
   /* the shortest path between the two.*/ \
-  const math::SimdFloat4 dot = _out->rotation.x * _in.rotation.x + \
-                               _out->rotation.y * _in.rotation.y + \
-                               _out->rotation.z * _in.rotation.z + \
-                               _out->rotation.w * _in.rotation.w; \
-  const math::SimdInt4 sign = math::Sign(dot); \
-  const math::SoaQuaternion rotation = {math::Xor(_in.rotation.x, sign), \
-                                        math::Xor(_in.rotation.y, sign), \
-                                        math::Xor(_in.rotation.z, sign), \
-                                        math::Xor(_in.rotation.w, sign)}; \
-  _out->rotation = _out->rotation + rotation * _simd_weight; \
+  _out->rotation = _out->rotation + \
+    ShortestPath(_out->rotation, _in.rotation) * _simd_weight; \
   /* Blends scales.*/ \
   _out->scale = _out->scale + _in.scale * _simd_weight; \
 }
@@ -194,35 +228,49 @@ namespace {
   _out.scale = _out.scale * rcp_scale; \
 }
 
-// Defines parameters that are passed through blending stages.
+// Defines the maximum number of soa joints processed at once. The job runs all
+// blending stages on a block of joints before moving to the next one. This
+// bounds the size of the per-joint accumulated weights array allocated on the
+// stack, whatever the number of joints, and keeps the output block in cache
+// from a stage to the next. It's a multiple of 2 so that 8 wide simd pairing
+// isn't broken by block boundaries.
+const size_t kBlockSoaJoints = 32;
+
+// Defines parameters that are passed through blending stages, for a block of
+// soa joints.
 struct ProcessArgs {
-  ProcessArgs(const BlendingJob& _job)
-    : job(_job),
-      num_soa_joints(_job.bind_pose.end - _job.bind_pose.begin),
+  ProcessArgs(float _threshold,
+              math::SoaTransform* _output,
+              const math::SoaTransform* _bind_pose,
+              size_t _num_soa_joints)
+    : threshold(_threshold),
+      num_soa_joints(_num_soa_joints),
+      output(_output),
+      bind_pose(_bind_pose),
       num_passes(0),
       num_partial_passes(0),
       accumulated_weight(0.f) {
-    // The range of all buffers has already been validated.
-    assert(job.output.end >= job.output.begin + num_soa_joints);
     assert(OZZ_ARRAY_SIZE(accumulated_weights) >= num_soa_joints);
   }
 
-  // Allocates enough space to store a accumulated weights per-joint.
-  // It will be initialized by the first pass processed, if any.
-  // This is quite big for a stack allocation (16 byte * maximum number of
-  // joints). This is one of the reasons why the number of joints is limited
-  // by the API.
+  // Allocates enough space to store accumulated weights per-joint of the
+  // block. It will be initialized by the first pass processed, if any.
   // Note that this array is used with SoA data.
   // This is the first argument in order to avoid wasting too much space with
   // alignment padding.
-  math::SimdFloat4 accumulated_weights[Skeleton::kMaxSoAJoints];
+  math::SimdFloat4 accumulated_weights[kBlockSoaJoints];
 
-  // The job to process.
-  const BlendingJob& job;
+  // The bind pose is blended when the accumulated weight is less than this
+  // threshold value.
+  float threshold;
 
-  // The number of transforms to process as defined by the size of the bind pose.
+  // The number of soa joints of the block.
   size_t num_soa_joints;
 
+  // Output and bind pose transforms, offset to the beginning of the block.
+  math::SoaTransform* output;
+  const math::SoaTransform* bind_pose;
+
   // Number of processed blended passes (excluding passes with a weight <= 0.f),
   // including partial passes.
   int num_passes;
@@ -239,76 +287,173 @@ struct ProcessArgs {
    void operator = (const ProcessArgs&);
 };
 
-// Blends all layers of the job to its output.
-void BlendLayers(ProcessArgs* _args) {
-  assert(_args);
+// Returns true if any lane of _joint_weights is positive, meaning that the soa
+// joint contributes to partial blending.
+OZZ_INLINE bool IsActive(const math::SimdFloat4& _joint_weights) {
+  return !math::AreAllFalse(
+    math::CmpGt(_joint_weights, math::simd_float4::zero()));
+}
 
-  // Iterates through all layers and blend them to the output.
-  for (const BlendingJob::Layer* layer = _args->job.layers.begin;
-       layer < _args->job.layers.end;
-       ++layer) {
+// Returns true if any joint of the _count soa joints weights _joint_weights
+// contributes to partial blending.
+OZZ_INLINE bool IsAnyActive(const math::SimdFloat4* _joint_weights,
+                            size_t _count) {
+  for (size_t i = 0; i < _count; ++i) {
+    if (IsActive(_joint_weights[i])) {
+      return true;
+    }
+  }
+  return false;
+}
 
-    // Asserts buffer sizes, which must never fail as it has been validated.
-    assert(layer->transform.end >=
-           layer->transform.begin + _args->num_soa_joints);
-    assert(!layer->joint_weights.begin ||
-           (layer->joint_weights.end >=
-            layer->joint_weights.begin + _args->num_soa_joints));
+// Initializes _count soa joints of a first pass, as blending a transform with
+// a weight of 0 would.
+OZZ_INLINE void ClearFirstPass(math::SoaTransform* _output,
+                               math::SimdFloat4* _accumulated_weights,
+                               size_t _count) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SoaTransform cleared = {
+    {zero, zero, zero}, {zero, zero, zero, zero}, {zero, zero, zero}};
+  for (size_t i = 0; i < _count; ++i) {
+    _output[i] = cleared;
+    _accumulated_weights[i] = zero;
+  }
+}
 
-    // Skip irrelevant layers.
-    if (layer->weight <= 0.f) {
+// Blends _src transforms to the block output, with _weight and optional
+// _joint_weights. Soa joints are processed by pairs with 8 wide simd, the last
+// one (if any) with 4 wide simd. _FirstPass selects the blending process of
+// the first pass, _Partial enables per-joint weights. With partial blending,
+// soa joints whose weights are all 0 are skipped, _src isn't even read.
+template <bool _FirstPass, bool _Partial>
+void BlendLayer(const math::SoaTransform* _src,
+                const math::SimdFloat4* _joint_weights,
+                float _weight,
+                ProcessArgs* _args) {
+  const math::SimdFloat4 layer_weight = math::simd_float4::Load1(_weight);
+  const math::SimdFloat8 wide_layer_weight = math::simd_float8::Load1(_weight);
+  const math::SoaTransform* src = _src;
+  const math::SimdFloat4* joint_weights = _joint_weights;
+  math::SimdFloat4* accumulated_weights = _args->accumulated_weights;
+  math::SoaTransform* output = _args->output;
+  const size_t num_soa_joints = _args->num_soa_joints;
+
+  size_t i = 0;
+  for (; i + 1 < num_soa_joints; i += 2) {
+    if (_Partial &&
+        !IsActive(joint_weights[i]) && !IsActive(joint_weights[i + 1])) {
+      if (_FirstPass) {
+        ClearFirstPass(output + i, accumulated_weights + i, 2);
+      }
       continue;
     }
+    const math::WideSoaTransform wide_src =
+      math::WideSoaTransform::Load(src[i], src[i + 1]);
+    const math::SimdFloat8 weight =
+      _Partial ? wide_layer_weight * math::Max0(math::simd_float8::Load(
+                                       joint_weights[i], joint_weights[i + 1]))
+               : wide_layer_weight;
+    math::SimdFloat8 accumulated_weight;
+    math::WideSoaTransform dest;
+    if (_FirstPass) {
+      accumulated_weight = weight;
+      OZZ_BLEND_1ST_PASS(wide_src, weight, (&dest));
+    } else {
+      accumulated_weight =
+        math::simd_float8::Load(accumulated_weights[i],
+                                accumulated_weights[i + 1]) + weight;
+      dest = math::WideSoaTransform::Load(output[i], output[i + 1]);
+      OZZ_BLEND_N_PASS(wide_src, weight, (&dest));
+    }
+    accumulated_weights[i] = math::GetLow(accumulated_weight);
+    accumulated_weights[i + 1] = math::GetHigh(accumulated_weight);
+    output[i] = math::GetLow(dest);
+    output[i + 1] = math::GetHigh(dest);
+  }
+  for (; i < num_soa_joints; ++i) {
+    if (_Partial && !IsActive(joint_weights[i])) {
+      if (_FirstPass) {
+        ClearFirstPass(output + i, accumulated_weights + i, 1);
+      }
+      continue;
+    }
+    const math::SimdFloat4 weight =
+      _Partial ? layer_weight * math::Max0(joint_weights[i]) : layer_weight;
+    math::SoaTransform* dest = output + i;
+    if (_FirstPass) {
+      accumulated_weights[i] = weight;
+      OZZ_BLEND_1ST_PASS(src[i], weight, dest);
+    } else {
+      accumulated_weights[i] = accumulated_weights[i] + weight;
+      OZZ_BLEND_N_PASS(src[i], weight, dest);
+    }
+  }
+}
 
-    // Accumulates global weights.
-    _args->accumulated_weight += layer->weight;
-    const math::SimdFloat4 layer_weight = math::simd_float4::Load1(layer->weight);
+// Returns _joint_weights offset to the block starting at soa joint _offset, or
+// NULL if per-joint weights are disabled (_joint_weights is NULL).
+OZZ_INLINE const math::SimdFloat4* BlockJointWeights(
+  const math::SimdFloat4* _joint_weights, size_t _offset) {
+  return _joint_weights ? _joint_weights + _offset : NULL;
+}
 
-    if (layer->joint_weights.begin) {
-      // This layer has per-joint weights.
-      ++_args->num_partial_passes;
+// Blends a layer pass to the block output. _src and _joint_weights (NULL if
+// the layer has no per-joint weights) point to the beginning of the block.
+// Layers with a weight <= 0 are skipped.
+void BlendPass(const math::SoaTransform* _src,
+               const math::SimdFloat4* _joint_weights,
+               float _weight,
+               ProcessArgs* _args) {
+  // Skip irrelevant layers.
+  if (_weight <= 0.f) {
+    return;
+  }
 
-      if (_args->num_passes == 0) {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          const math::SimdFloat4 weight =
-            layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          _args->accumulated_weights[i] = weight;
-          OZZ_BLEND_1ST_PASS(src, weight, dest);
-        }
-      } else {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          const math::SimdFloat4 weight =
-            layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          _args->accumulated_weights[i] =
-            _args->accumulated_weights[i] + weight;
-          OZZ_BLEND_N_PASS(src, weight, dest);
-        }
-      }
+  // Accumulates global weights.
+  _args->accumulated_weight += _weight;
+
+  if (_joint_weights) {
+    // This layer has per-joint weights.
+    ++_args->num_partial_passes;
+
+    if (_args->num_passes == 0) {
+      BlendLayer<true, true>(_src, _joint_weights, _weight, _args);
     } else {
-      // This is a full layer.
-      if (_args->num_passes == 0) {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          _args->accumulated_weights[i] = layer_weight;
-          OZZ_BLEND_1ST_PASS(src, layer_weight, dest);
-        }
-      } else {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          _args->accumulated_weights[i] =
-            _args->accumulated_weights[i] + layer_weight;
-          OZZ_BLEND_N_PASS(src, layer_weight, dest);
-        }
-      }
+      BlendLayer<false, true>(_src, _joint_weights, _weight, _args);
     }
-    // One more pass blended.
-    ++_args->num_passes;
+  } else {
+    // This is a full layer.
+    if (_args->num_passes == 0) {
+      BlendLayer<true, false>(_src, NULL, _weight, _args);
+    } else {
+      BlendLayer<false, false>(_src, NULL, _weight, _args);
+    }
+  }
+  // One more pass blended.
+  ++_args->num_passes;
+}
+
+// Blends all layers of the job to the output block starting at soa joint
+// _offset.
+void BlendLayers(const BlendingJob& _job, size_t _offset, ProcessArgs* _args) {
+  assert(_args);
+
+  // Iterates through all layers and blend them to the output.
+  for (const BlendingJob::Layer* layer = _job.layers.begin;
+       layer < _job.layers.end;
+       ++layer) {
+
+    // Asserts buffer sizes, which must never fail as it has been validated.
+    assert(layer->transform.end >=
+           layer->transform.begin + _offset + _args->num_soa_joints);
+    assert(!layer->joint_weights.begin ||
+           (layer->joint_weights.end >= layer->joint_weights.begin +
+                                        _offset + _args->num_soa_joints));
+
+    BlendPass(layer->transform.begin + _offset,
+              BlockJointWeights(layer->joint_weights.begin, _offset),
+              layer->weight,
+              _args);
   }
 }
 
@@ -317,33 +462,28 @@ void BlendLayers(ProcessArgs* _args) {
 void BlendBindPose(ProcessArgs* _args) {
   assert(_args);
 
-  // Asserts buffer sizes, which must never fail as it has been validated.
-  assert(_args->job.bind_pose.end >=
-         _args->job.bind_pose.begin + _args->num_soa_joints);
-
   if (_args->num_partial_passes == 0) {
     // No partial blending pass detected, threshold can be tested globally.
-    const float bp_weight =
-      _args->job.threshold - _args->accumulated_weight;
+    const float bp_weight = _args->threshold - _args->accumulated_weight;
 
     if (bp_weight > 0.f) {  // The bind-pose is needed if it has a weight.
       if (_args->num_passes == 0) {
         // Strictly copying bind-pose.
         _args->accumulated_weight = 1.f;
         for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          _args->job.output.begin[i] = _args->job.bind_pose.begin[i];
+          _args->output[i] = _args->bind_pose[i];
         }
       } else {
         // Updates global accumulated weight, but not per-joint weight any more
         // because normalization stage will be global also.
-        _args->accumulated_weight = _args->job.threshold;
+        _args->accumulated_weight = _args->threshold;
 
         const math::SimdFloat4 simd_bp_weight =
           math::simd_float4::Load1(bp_weight);
 
         for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = _args->job.bind_pose.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
+          const math::SoaTransform& src = _args->bind_pose[i];
+          math::SoaTransform* dest = _args->output + i;
           OZZ_BLEND_N_PASS(src, simd_bp_weight, dest);
         }
       }
@@ -352,14 +492,14 @@ void BlendBindPose(ProcessArgs* _args) {
     // Blending passes contain partial blending, threshold must be tested for
     // each joint.
     const math::SimdFloat4 threshold = 
-      math::simd_float4::Load1(_args->job.threshold);
+      math::simd_float4::Load1(_args->threshold);
 
     // There's been at least 1 pass as num_partial_passes != 0.
     assert(_args->num_passes != 0);
 
     for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-      const math::SoaTransform& src = _args->job.bind_pose.begin[i];
-      math::SoaTransform* dest = _args->job.output.begin + i;
+      const math::SoaTransform& src = _args->bind_pose[i];
+      math::SoaTransform* dest = _args->output + i;
       const math::SimdFloat4 bp_weight =
         math::Max0(threshold - _args->accumulated_weights[i]);
       _args->accumulated_weights[i] =
@@ -382,7 +522,7 @@ void Normalize(ProcessArgs* _args) {
     const math::SimdFloat4 ratio =
       math::simd_float4::Load1(1.f / _args->accumulated_weight);
     for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-      math::SoaTransform& dest = _args->job.output.begin[i];
+      math::SoaTransform& dest = _args->output[i];
       dest.rotation = NormalizeEst(dest.rotation);
       dest.translation = dest.translation * ratio;
       dest.scale = dest.scale * ratio;
@@ -392,7 +532,7 @@ void Normalize(ProcessArgs* _args) {
     const math::SimdFloat4 one = math::simd_float4::one();
     for (size_t i = 0; i < _args->num_soa_joints; ++i) {
       const math::SimdFloat4 ratio = one / _args->accumulated_weights[i];
-      math::SoaTransform& dest = _args->job.output.begin[i];
+      math::SoaTransform& dest = _args->output[i];
       dest.rotation = NormalizeEst(dest.rotation);
       dest.translation = dest.translation * ratio;
       dest.scale = dest.scale * ratio;
@@ -400,104 +540,317 @@ void Normalize(ProcessArgs* _args) {
   }
 }
 
-// Process additive blending pass.
-void AddLayers(ProcessArgs* _args) {
+// Adds (or subtracts if _weight is negative) an additive layer pass to the
+// block output. _src and _joint_weights (NULL if the layer has no per-joint
+// weights) point to the beginning of the block. Layers with a weight of 0 are
+// skipped.
+void AddPass(const math::SoaTransform* _src,
+             const math::SimdFloat4* _joint_weights,
+             float _weight,
+             ProcessArgs* _args) {
+  // Prepares constants.
+  const math::SimdFloat4 one = math::simd_float4::one();
+
+  if (_weight > 0.f) {
+    // Weight is positive, need to perform additive blending.
+    const math::SimdFloat4 layer_weight = math::simd_float4::Load1(_weight);
+
+    if (_joint_weights) {
+      // This layer has per-joint weights. Soa joints whose weights are all 0
+      // are skipped.
+      for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+        if (!IsActive(_joint_weights[i])) {
+          continue;
+        }
+        const math::SoaTransform& src = _src[i];
+        math::SoaTransform& dest = _args->output[i];
+        const math::SimdFloat4 weight =
+          layer_weight * math::Max0(_joint_weights[i]);
+        const math::SimdFloat4 one_minus_weight = one - weight;
+        const math::SoaFloat3 one_minus_weight_f3 = {
+          one_minus_weight, one_minus_weight, one_minus_weight};
+        OZZ_ADD_PASS(src, weight, dest);
+      }
+    } else {
+      // This is a full layer.
+      const math::SimdFloat4 one_minus_weight = one - layer_weight;
+      const math::SoaFloat3 one_minus_weight_f3 = {
+        one_minus_weight, one_minus_weight, one_minus_weight};
+
+      for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+        const math::SoaTransform& src = _src[i];
+        math::SoaTransform& dest = _args->output[i];
+        OZZ_ADD_PASS(src, layer_weight, dest);
+      }
+    }
+  } else if (_weight < 0.f) {
+    // Weight is negative, need to perform subtractive blending.
+    const math::SimdFloat4 layer_weight = math::simd_float4::Load1(-_weight);
+
+    if (_joint_weights) {
+      // This layer has per-joint weights. Soa joints whose weights are all 0
+      // are skipped.
+      for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+        if (!IsActive(_joint_weights[i])) {
+          continue;
+        }
+        const math::SoaTransform& src = _src[i];
+        math::SoaTransform& dest = _args->output[i];
+        const math::SimdFloat4 weight =
+          layer_weight * math::Max0(_joint_weights[i]);
+        const math::SimdFloat4 one_minus_weight = one - weight;
+        OZZ_SUB_PASS(src, weight, dest);
+      }
+    } else {
+      // This is a full layer.
+      const math::SimdFloat4 one_minus_weight = one - layer_weight;
+      for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+        const math::SoaTransform& src = _src[i];
+        math::SoaTransform& dest = _args->output[i];
+        OZZ_SUB_PASS(src, layer_weight, dest);
+      }
+    }
+  } else {
+    // Skip layer as its weight is 0.
+  }
+}
+
+// Process additive blending pass of all additive layers of the job, to the
+// output block starting at soa joint _offset.
+void AddLayers(const BlendingJob& _job, size_t _offset, ProcessArgs* _args) {
   assert(_args);
 
   // Iterates through all layers and blend them to the output.
-  for (const BlendingJob::Layer* layer = _args->job.additive_layers.begin;
-       layer < _args->job.additive_layers.end;
+  for (const BlendingJob::Layer* layer = _job.additive_layers.begin;
+       layer < _job.additive_layers.end;
        ++layer) {
 
     // Asserts buffer sizes, which must never fail as it has been validated.
     assert(layer->transform.end >=
-           layer->transform.begin + _args->num_soa_joints);
+           layer->transform.begin + _offset + _args->num_soa_joints);
     assert(!layer->joint_weights.begin ||
-           (layer->joint_weights.end >=
-            layer->joint_weights.begin + _args->num_soa_joints));
+           (layer->joint_weights.end >= layer->joint_weights.begin +
+                                        _offset + _args->num_soa_joints));
 
-    // Prepares constants. 
-    const math::SimdFloat4 one = math::simd_float4::one();
+    AddPass(layer->transform.begin + _offset,
+            BlockJointWeights(layer->joint_weights.begin, _offset),
+            layer->weight,
+            _args);
+  }
+}
+}  // namespace
 
-    if (layer->weight > 0.f) {
-      // Weight is positive, need to perform additive blending.
-      const math::SimdFloat4 layer_weight =
-        math::simd_float4::Load1(layer->weight);
+bool BlendingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
 
-      if (layer->joint_weights.begin) {
-        // This layer has per-joint weights.
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          const math::SimdFloat4 weight =
-            layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          const math::SimdFloat4 one_minus_weight = one - weight;
-          const math::SoaFloat3 one_minus_weight_f3 = {
-            one_minus_weight, one_minus_weight, one_minus_weight};
-          OZZ_ADD_PASS(src, weight, dest);
-        }
-      } else {
-        // This is a full layer.
-        const math::SimdFloat4 one_minus_weight = one - layer_weight;
-        const math::SoaFloat3 one_minus_weight_f3 = {
-          one_minus_weight, one_minus_weight, one_minus_weight};
+  // Processes soa joints by blocks, running all blending stages on a block
+  // before moving to the next one.
+  const size_t num_soa_joints = bind_pose.end - bind_pose.begin;
+  for (size_t offset = 0; offset < num_soa_joints; offset += kBlockSoaJoints) {
+    const size_t block_soa_joints =
+      math::Min(num_soa_joints - offset, kBlockSoaJoints);
 
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          OZZ_ADD_PASS(src, layer_weight, dest);
-        }
-      }
-    } else if (layer->weight < 0.f) {
-      // Weight is negative, need to perform subtractive blending.
-      const math::SimdFloat4 layer_weight =
-        math::simd_float4::Load1(-layer->weight);
+    // Initializes blended parameters that are exchanged across blend stages.
+    ProcessArgs process_args(threshold,
+                             output.begin + offset,
+                             bind_pose.begin + offset,
+                             block_soa_joints);
 
-      if (layer->joint_weights.begin) {
-        // This layer has per-joint weights.
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          const math::SimdFloat4 weight =
-            layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          const math::SimdFloat4 one_minus_weight = one - weight;
-          OZZ_SUB_PASS(src, weight, dest);
-        }
-      } else {
-        // This is a full layer.
-        const math::SimdFloat4 one_minus_weight = one - layer_weight;
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          OZZ_SUB_PASS(src, layer_weight, dest);
-        }
-      }
-    } else {
-      // Skip layer as its weight is 0.
-    }
+    // Blends all layers to the job output buffers.
+    BlendLayers(*this, offset, &process_args);
+
+    // Applies bind pose.
+    BlendBindPose(&process_args);
+
+    // Normalizes output.
+    Normalize(&process_args);
+
+    // Process additive blending.
+    AddLayers(*this, offset, &process_args);
   }
+
+  return true;
 }
-}  // namespace
 
-bool BlendingJob::Run() const {
-  if (!Validate()) {
+SamplingBlendingJob::Layer::Layer()
+    : weight(0.f),
+      animation(NULL),
+      cache(NULL),
+      time(0.f) {
+}
+
+SamplingBlendingJob::SamplingBlendingJob()
+    : threshold(.1f) {
+}
+
+namespace {
+bool ValidateLayer(const SamplingBlendingJob::Layer& _layer,
+                   ptrdiff_t _min_range) {
+  // Test for NULL pointers.
+  if (!_layer.animation || !_layer.cache) {
     return false;
   }
 
-  // Initializes blended parameters that are exchanged across blend stages.
-  ProcessArgs process_args(*this);
+  bool valid = true;
+
+  // Tests that the animation outputs all the joints to blend, and that the
+  // cache is big enough to sample it.
+  const ptrdiff_t num_soa_tracks = _layer.animation->num_soa_tracks();
+  valid &= num_soa_tracks >= _min_range;
+  valid &= _layer.cache->max_soa_tracks() >= num_soa_tracks;
+
+  // Joint weights are optional.
+  valid &= ValidateJointWeights(
+    _layer.joint_weights.begin, _layer.joint_weights.end, _min_range);
+  return valid;
+}
+
+// Clamps _layer time in range [0,duration] of its animation.
+OZZ_INLINE float ClampTime(const SamplingBlendingJob::Layer& _layer) {
+  return math::Clamp(0.f, _layer.time, _layer.animation->duration());
+}
+
+// Defines the number of soa joints processed at once by the
+// SamplingBlendingJob. Every layer is sampled to a buffer of this size, that
+// is blended to the output straight away, while it's still in cache.
+const size_t kSamplingBlockSoaJoints = 8;
+OZZ_STATIC_ASSERT(kSamplingBlockSoaJoints <= kBlockSoaJoints &&
+                  (kSamplingBlockSoaJoints & 1) == 0);
+}  // namespace
+
+bool SamplingBlendingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
 
-  // Blends all layers to the job output buffers.
-  BlendLayers(&process_args);
+  // Test for valid threshold).
+  valid &= threshold > 0.f;
 
-  // Applies bind pose.
-  BlendBindPose(&process_args);
+  // Test for NULL begin pointers.
+  valid &= bind_pose.begin != NULL;
+  valid &= output.begin != NULL;
 
-  // Normalizes output.
-  Normalize(&process_args);
+  // Test ranges are valid (implicitly test for NULL end pointers).
+  valid &= bind_pose.end >= bind_pose.begin;
+  valid &= output.end >= output.begin;
 
-  // Process additive blending.
-  AddLayers(&process_args);
+  // The bind pose size defines the ranges of transforms to blend, so all
+  // other buffers should be bigger.
+  const ptrdiff_t min_range = bind_pose.end - bind_pose.begin;
+  valid &= output.end - output.begin >= min_range;
+
+  // Blend layers are optional.
+  if (layers.begin != NULL) {
+    valid &= layers.end >= layers.begin;
+  } else {
+    valid &= layers.end == NULL;
+  }
+
+  // Validates layers.
+  for (const Layer* layer = layers.begin;
+       layers.begin && layer < layers.end;
+       ++layer) {
+    valid &= ValidateLayer(*layer, min_range);
+  }
+
+  // Additive layers are optional.
+  if (additive_layers.begin != NULL) {
+    valid &= additive_layers.end >= additive_layers.begin;
+  } else {
+    valid &= additive_layers.end == NULL;
+  }
+
+  // Validates additive layers.
+  for (const Layer* layer = additive_layers.begin;
+       additive_layers.begin && layer < additive_layers.end;
+       ++layer) {
+    valid &= ValidateLayer(*layer, min_range);
+  }
+
+  return valid;
+}
+
+bool SamplingBlendingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Fetches and decompresses key frames of the layers that contribute to the
+  // output. Other layers aren't sampled at all, their cache is left unchanged.
+  for (const Layer* layer = layers.begin; layer < layers.end; ++layer) {
+    if (layer->weight > 0.f) {
+      layer->cache->Step(*layer->animation);
+      layer->cache->Update(*layer->animation, ClampTime(*layer), NULL);
+    }
+  }
+  for (const Layer* layer = additive_layers.begin;
+       layer < additive_layers.end;
+       ++layer) {
+    if (layer->weight != 0.f) {
+      layer->cache->Step(*layer->animation);
+      layer->cache->Update(*layer->animation, ClampTime(*layer), NULL);
+    }
+  }
+
+  // Processes soa joints by blocks. Every contributing layer is interpolated
+  // to the block samples buffer, which is blended to the output straight away.
+  math::SoaTransform samples[kSamplingBlockSoaJoints];
+  const size_t num_soa_joints = bind_pose.end - bind_pose.begin;
+  for (size_t offset = 0;
+       offset < num_soa_joints;
+       offset += kSamplingBlockSoaJoints) {
+    const size_t block_soa_joints =
+      math::Min(num_soa_joints - offset, kSamplingBlockSoaJoints);
+    const int soa_begin = static_cast<int>(offset);
+    const int soa_end = static_cast<int>(offset + block_soa_joints);
+
+    // Initializes blended parameters that are exchanged across blend stages.
+    ProcessArgs process_args(threshold,
+                             output.begin + offset,
+                             bind_pose.begin + offset,
+                             block_soa_joints);
+
+    // Samples and blends all layers to the job output buffers.
+    for (const Layer* layer = layers.begin; layer < layers.end; ++layer) {
+      if (layer->weight <= 0.f) {
+        continue;
+      }
+      // Partial layers aren't sampled if none of the block joints
+      // contributes. The pass is still processed, samples won't be read.
+      const math::SimdFloat4* joint_weights =
+        BlockJointWeights(layer->joint_weights.begin, offset);
+      if (!joint_weights || IsAnyActive(joint_weights, block_soa_joints)) {
+        layer->cache->Interpolate(*layer->animation, ClampTime(*layer),
+                                  soa_begin, soa_end, NULL, samples);
+      }
+      BlendPass(samples, joint_weights, layer->weight, &process_args);
+    }
+
+    // Applies bind pose.
+    BlendBindPose(&process_args);
+
+    // Normalizes output.
+    Normalize(&process_args);
+
+    // Samples and process additive blending.
+    for (const Layer* layer = additive_layers.begin;
+         layer < additive_layers.end;
+         ++layer) {
+      // Partial layers are skipped if none of the block joints contributes.
+      const math::SimdFloat4* joint_weights =
+        BlockJointWeights(layer->joint_weights.begin, offset);
+      if (layer->weight == 0.f ||
+          (joint_weights && !IsAnyActive(joint_weights, block_soa_joints))) {
+        continue;
+      }
+      layer->cache->Interpolate(*layer->animation, ClampTime(*layer),
+                                soa_begin, soa_end, NULL, samples);
+      AddPass(samples, joint_weights, layer->weight, &process_args);
+    }
+  }
 
   return true;
 }
@@ -31,6 +31,7 @@
 
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/soa_wide.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/math_ex.h"
 
@@ -39,6 +40,24 @@
 namespace ozz {
 namespace animation {
 
+namespace {
+// Tests if _joint must be updated, ie: if _joint or one of its ancestors is
+// _root or is flagged in _dirty bitset. Ancestors are walked up to the first
+// one that precedes _first, as the update can't start before it.
+bool IsUpdated(const Skeleton::JointProperties* _properties, int _root,
+               const uint32_t* _dirty, int _first, int _joint) {
+  for (int joint = _joint;
+       joint != Skeleton::kNoParentIndex && joint >= _first;
+       joint = _properties[joint].parent) {
+    if (joint == _root ||
+        (_dirty != NULL && (_dirty[joint / 32] & (1u << (joint & 31))) != 0)) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
 bool LocalToModelJob::Validate() const {
   // Don't need any early out, as jobs are valid in most of the performance
   // critical cases.
@@ -52,7 +71,18 @@ bool LocalToModelJob::Validate() const {
   valid &= input.begin != NULL;
   valid &= output.begin != NULL;
 
+  // Test joints range.
+  valid &= from >= 0;
+  valid &= from <= to;
+
   const int num_joints = skeleton->num_joints();
+
+  // Test subtree restrictions.
+  valid &= (root >= 0 && root < num_joints) ||
+           root == Skeleton::kNoParentIndex;
+  valid &= dirty.begin == NULL ||
+           dirty.end - dirty.begin >= (num_joints + 31) / 32;
+
   const int num_soa_joints = (num_joints + 3) / 4;
 
   // Test input and output ranges, implicitly tests for NULL end pointers.
@@ -71,16 +101,21 @@ bool LocalToModelJob::Run() const {
     return false;
   }
 
-  // Early out if no joint.
-  const int num_joints = skeleton->num_joints();
-  if (num_joints == 0) {
-    return true;
-  }
-
   // Fetch joint's properties.
   Range<const Skeleton::JointProperties> properties =
     skeleton->joint_properties();
 
+  // Early out if no joint to process. A leaf root subtree is limited to the
+  // root itself.
+  int end = math::Min(to, skeleton->num_joints());
+  if (dirty.begin == NULL && root != Skeleton::kNoParentIndex &&
+      properties.begin[root].is_leaf) {
+    end = math::Min(end, root + 1);
+  }
+  if (from >= end) {
+    return true;
+  }
+
   // Output.
   Float4x4* const model_matrices = output.begin;
 
@@ -88,22 +123,74 @@ bool LocalToModelJob::Run() const {
   // matrices without requiring a branch.
   const Float4x4 identity = Float4x4::identity();
 
+  // When the job is restricted to subtrees, a joint is updated if it's the
+  // root, if it's dirty or if one of its ancestors is. Joints preceding the
+  // first one that can be updated are skipped. Flags are computed for the
+  // joints of the current soa element only, so no storage depends on the
+  // number of joints.
+  const bool partial = root != Skeleton::kNoParentIndex || dirty.begin != NULL;
+  const int first = dirty.begin != NULL ? 0 : root;
+  const int begin = partial ? math::Max(from, first) : from;
+
+  // Local soa matrices of the next soa element, built along with the current
+  // ones using 8 wide simd.
+  SoaFloat4x4 next_soa_matrices;
+  int next_soa = -1;
+  const int end_soa = (end + 3) / 4;
+
   // Converts to matrices and applies hierarchical transformation.
-  for (int joint = 0; joint < num_joints;) {
-    // Builds soa matrices from soa transforms.
-    const SoaTransform& transform = input.begin[joint / 4];
-    const SoaFloat4x4 local_soa_matrices =
-      SoaFloat4x4::FromAffine(transform.translation,
-                              transform.rotation,
-                              transform.scale);
+  for (int joint = begin; joint < end;) {
+    // Skips soa elements that have no joint to update.
+    const int proceed_up_to = math::Min((joint + 4) & ~3, end);
+    bool updated[4] = {true, true, true, true};
+    if (partial) {
+      bool any = false;
+      for (int i = joint; i < proceed_up_to; ++i) {
+        updated[i & 3] =
+          IsUpdated(properties.begin, root, dirty.begin, first, i);
+        any |= updated[i & 3];
+      }
+      if (!any) {
+        joint = proceed_up_to;
+        continue;
+      }
+    }
+
+    // Builds soa matrices from soa transforms, two soa elements at once
+    // whenever the next one is in the range.
+    const int soa = joint / 4;
+    SoaFloat4x4 local_soa_matrices;
+    if (soa == next_soa) {
+      local_soa_matrices = next_soa_matrices;
+    } else if (soa + 1 < end_soa) {
+      const math::WideSoaTransform transforms =
+        math::WideSoaTransform::Load(input.begin[soa], input.begin[soa + 1]);
+      const math::WideSoaFloat4x4 wide_soa_matrices =
+        math::WideSoaFloat4x4::FromAffine(transforms.translation,
+                                          transforms.rotation,
+                                          transforms.scale);
+      local_soa_matrices = math::GetLow(wide_soa_matrices);
+      next_soa_matrices = math::GetHigh(wide_soa_matrices);
+      next_soa = soa + 1;
+    } else {
+      const SoaTransform& transform = input.begin[soa];
+      local_soa_matrices = SoaFloat4x4::FromAffine(transform.translation,
+                                                   transform.rotation,
+                                                   transform.scale);
+    }
     // Converts to aos matrices.
     math::SimdFloat4 local_aos_matrices[16];
     math::Transpose16x16(&local_soa_matrices.cols[0].x, local_aos_matrices);
 
-    // Applies hierarchical transformation.
-    const int proceed_up_to = joint + math::Min(4, num_joints - joint);
-    const math::SimdFloat4* local_aos_matrix = local_aos_matrices;
+    // Applies hierarchical transformation, up to the end of the soa element or
+    // of the range. Only the first soa element of the range can start with an
+    // offset.
+    const math::SimdFloat4* local_aos_matrix =
+      local_aos_matrices + (joint & 3) * 4;
     for (; joint < proceed_up_to; ++joint, local_aos_matrix += 4) {
+      if (!updated[joint & 3]) {
+        continue;
+      }
       const int parent = properties.begin[joint].parent;
       const Float4x4* parent_matrix =
         math::Select(parent == Skeleton::kNoParentIndex,
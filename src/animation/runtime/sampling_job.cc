@@ -27,11 +27,14 @@
 
 #include "ozz/animation/runtime/sampling_job.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/math_constant.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/soa_wide.h"
 #include "ozz/base/memory/allocator.h"
 #include "ozz/animation/runtime/animation.h"
 
@@ -76,6 +79,14 @@ bool SamplingJob::Validate() const {
   // Tests cache size.
   valid &= cache->max_soa_tracks() >= num_soa_tracks;
 
+  // Tests optional soa joints mask size, one bit per soa joint.
+  if (soa_joints_mask.begin) {
+    valid &= soa_joints_mask.end - soa_joints_mask.begin >=
+             (num_soa_tracks + 7) / 8;
+  } else {
+    valid &= soa_joints_mask.end == NULL;
+  }
+
   return valid;
 }
 
@@ -145,15 +156,99 @@ void UpdateKeys(float _time, int _num_soa_tracks,
     *_cursor = static_cast<int>(cursor - _keys.begin);
 }
 
+// Moves the cache to the seek point matching _time, if the cache isn't valid
+// for _time anymore (sampling backward) or if a seek point is ahead of the
+// current cursor (jumping forward). Only the tracks whose keys differ from the
+// restored ones are flagged as outdated. UpdateKeys is then responsible for
+// walking keys forward from the restored cursor.
+template<typename _Key>
+void SeekKeys(float _time, int _num_soa_tracks,
+              ozz::Range<const _Key> _keys,
+              const SeekTable& _table, int _interval,
+              int* _cursor,
+              int* _cache, unsigned char* _outdated) {
+  if (!*_cursor) {
+    return;  // The cache is invalid, it will be initialized by UpdateKeys.
+  }
+  const int num_tracks = _num_soa_tracks * 4;
+  const int first = num_tracks * 2;
+  const ptrdiff_t num_points = _table.times.Count();
+
+  // Cache is valid for _time if the previous key of the last processed key is
+  // before _time. In this case, there's no need to seek unless a seek point is
+  // reachable ahead of the cursor.
+  const int last = _keys.begin[*_cursor - 1].track * 2;
+  if (_keys.begin[_cache[last]].time <= _time) {
+    const int next = (*_cursor - first) / _interval;
+    if (next >= num_points || _table.times.begin[next] > _time) {
+      return;
+    }
+  }
+
+  // Finds the last seek point valid for _time.
+  const float* times = _table.times.begin;
+  const float* point = std::upper_bound(times, times + num_points, _time) - 1;
+  const int index = static_cast<int>(point - _table.times.begin);
+
+  // Restores cache entries, from the seek point or from the first keys if none
+  // is valid, and flag changed entries as outdated.
+  if (index >= 0) {
+    const int* state = _table.keys.begin + index * num_tracks * 2;
+    for (int i = 0; i < num_tracks; ++i) {
+      const int base = i * 2;
+      if (_cache[base] != state[base] || _cache[base + 1] != state[base + 1]) {
+        _cache[base] = state[base];
+        _cache[base + 1] = state[base + 1];
+        _outdated[i / 32] |= (1 << ((i & 0x1f) / 4));
+      }
+    }
+    *_cursor = first + (index + 1) * _interval;
+  } else {
+    for (int i = 0; i < num_tracks; ++i) {
+      const int base = i * 2;
+      if (_cache[base] != i || _cache[base + 1] != num_tracks + i) {
+        _cache[base] = i;
+        _cache[base + 1] = num_tracks + i;
+        _outdated[i / 32] |= (1 << ((i & 0x1f) / 4));
+      }
+    }
+    *_cursor = first;
+  }
+}
+
+// Loads the times of 4 keys to a SIMD vector, in seconds. Float times are
+// loaded as is.
+OZZ_INLINE math::SimdFloat4 LoadTimes(float _t0, float _t1, float _t2,
+                                      float _t3, float /*_time_scale*/) {
+  return math::simd_float4::Load(_t0, _t1, _t2, _t3);
+}
+
+// Quantized times are converted to float, then scaled to seconds.
+OZZ_INLINE math::SimdFloat4 LoadTimes(uint16_t _t0, uint16_t _t1,
+                                      uint16_t _t2, uint16_t _t3,
+                                      float _time_scale) {
+  return math::simd_float4::Load1(_time_scale) * math::simd_float4::FromInt(
+    math::simd_int4::Load(_t0, _t1, _t2, _t3));
+}
+
+// Decompresses translation keys of type _Key, which is TranslationKey or
+// QuantizedTranslationKey. _time_scale converts quantized times to seconds.
+template<typename _Key>
 void UpdateSoaTranslations(int _num_soa_tracks,
-                           ozz::Range<const TranslationKey> _keys,
+                           ozz::Range<const _Key> _keys,
+                           float _time_scale,
                            const int* _interp,
                            unsigned char* _outdated,
+                           const unsigned char* _mask,
                            internal::InterpSoaTranslation* soa_translations_) {
   const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
   for (int j = 0; j < num_outdated_flags; ++j) {
+    // Only processes entries enabled by _mask, if any. Others stay outdated.
     unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+    if (_mask) {
+      outdated &= _mask[j];
+    }
+    _outdated[j] &= ~outdated;  // Reset outdated entries that are processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
@@ -161,12 +256,12 @@ void UpdateSoaTranslations(int _num_soa_tracks,
       const int base = i * 4 * 2;  // * soa size * 2 keys
 
       // Decompress left side keyframes and store them in soa structures.
-      const TranslationKey& k00 = _keys.begin[_interp[base + 0]];
-      const TranslationKey& k10 = _keys.begin[_interp[base + 2]];
-      const TranslationKey& k20 = _keys.begin[_interp[base + 4]];
-      const TranslationKey& k30 = _keys.begin[_interp[base + 6]];
-      soa_translations_[i].time[0] = math::simd_float4::Load(
-        k00.time, k10.time, k20.time, k30.time);
+      const _Key& k00 = _keys.begin[_interp[base + 0]];
+      const _Key& k10 = _keys.begin[_interp[base + 2]];
+      const _Key& k20 = _keys.begin[_interp[base + 4]];
+      const _Key& k30 = _keys.begin[_interp[base + 6]];
+      soa_translations_[i].time[0] = LoadTimes(
+        k00.time, k10.time, k20.time, k30.time, _time_scale);
       soa_translations_[i].value[0].x = math::HalfToFloat(math::simd_int4::Load(
         k00.value[0], k10.value[0], k20.value[0], k30.value[0]));
       soa_translations_[i].value[0].y = math::HalfToFloat(math::simd_int4::Load(
@@ -175,12 +270,12 @@ void UpdateSoaTranslations(int _num_soa_tracks,
         k00.value[2], k10.value[2], k20.value[2], k30.value[2]));
 
       // Decompress right side keyframes and store them in soa structures.
-      const TranslationKey& k01 = _keys.begin[_interp[base + 1]];
-      const TranslationKey& k11 = _keys.begin[_interp[base + 3]];
-      const TranslationKey& k21 = _keys.begin[_interp[base + 5]];
-      const TranslationKey& k31 = _keys.begin[_interp[base + 7]];
-      soa_translations_[i].time[1] = math::simd_float4::Load(
-        k01.time, k11.time, k21.time, k31.time);
+      const _Key& k01 = _keys.begin[_interp[base + 1]];
+      const _Key& k11 = _keys.begin[_interp[base + 3]];
+      const _Key& k21 = _keys.begin[_interp[base + 5]];
+      const _Key& k31 = _keys.begin[_interp[base + 7]];
+      soa_translations_[i].time[1] = LoadTimes(
+        k01.time, k11.time, k21.time, k31.time, _time_scale);
       soa_translations_[i].value[1].x = math::HalfToFloat(math::simd_int4::Load(
         k01.value[0], k11.value[0], k21.value[0], k31.value[0]));
       soa_translations_[i].value[1].y = math::HalfToFloat(math::simd_int4::Load(
@@ -242,10 +337,15 @@ void UpdateSoaTranslations(int _num_soa_tracks,
   _quat.x = cpnt[0]; _quat.y = cpnt[1]; _quat.z = cpnt[2]; _quat.w = cpnt[3];\
 }
 
+// Decompresses rotation keys of type _Key, which is RotationKey or
+// QuantizedRotationKey. _time_scale converts quantized times to seconds.
+template<typename _Key>
 void UpdateSoaRotations(int _num_soa_tracks,
-                        ozz::Range<const RotationKey> _keys,
+                        ozz::Range<const _Key> _keys,
+                        float _time_scale,
                         const int* _interp,
                         unsigned char* _outdated,
+                        const unsigned char* _mask,
                         internal::InterpSoaRotation* _soa_rotations) {
 
   // Prepares constants.
@@ -266,8 +366,12 @@ void UpdateSoaRotations(int _num_soa_tracks,
 
   const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
   for (int j = 0; j < num_outdated_flags; ++j) {
+    // Only processes entries enabled by _mask, if any. Others stay outdated.
     unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+    if (_mask) {
+      outdated &= _mask[j];
+    }
+    _outdated[j] &= ~outdated;  // Reset outdated entries that are processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
@@ -277,26 +381,26 @@ void UpdateSoaRotations(int _num_soa_tracks,
 
       // Decompress left side keyframes and store them in soa structures.
       {
-        const RotationKey& k0 = _keys.begin[_interp[base + 0]];
-        const RotationKey& k1 = _keys.begin[_interp[base + 2]];
-        const RotationKey& k2 = _keys.begin[_interp[base + 4]];
-        const RotationKey& k3 = _keys.begin[_interp[base + 6]];
+        const _Key& k0 = _keys.begin[_interp[base + 0]];
+        const _Key& k1 = _keys.begin[_interp[base + 2]];
+        const _Key& k2 = _keys.begin[_interp[base + 4]];
+        const _Key& k3 = _keys.begin[_interp[base + 6]];
 
         _soa_rotations[i].time[0] =
-          math::simd_float4::Load(k0.time, k1.time, k2.time, k3.time);
+          LoadTimes(k0.time, k1.time, k2.time, k3.time, _time_scale);
         math::SoaQuaternion& quat = _soa_rotations[i].value[0];
         DECOMPRESS_SOA_QUAT(k0, k1, k2, k3, quat);
       }
 
       // Decompress right side keyframes and store them in soa structures.
       {
-        const RotationKey& k0 = _keys.begin[_interp[base + 1]];
-        const RotationKey& k1 = _keys.begin[_interp[base + 3]];
-        const RotationKey& k2 = _keys.begin[_interp[base + 5]];
-        const RotationKey& k3 = _keys.begin[_interp[base + 7]];
+        const _Key& k0 = _keys.begin[_interp[base + 1]];
+        const _Key& k1 = _keys.begin[_interp[base + 3]];
+        const _Key& k2 = _keys.begin[_interp[base + 5]];
+        const _Key& k3 = _keys.begin[_interp[base + 7]];
 
         _soa_rotations[i].time[1] =
-          math::simd_float4::Load(k0.time, k1.time, k2.time, k3.time);
+          LoadTimes(k0.time, k1.time, k2.time, k3.time, _time_scale);
         math::SoaQuaternion& quat = _soa_rotations[i].value[1];
         DECOMPRESS_SOA_QUAT(k0, k1, k2, k3, quat);
       }
@@ -304,17 +408,319 @@ void UpdateSoaRotations(int _num_soa_tracks,
   }
 }
 
+// Sets lane _lane of _dest soa value to lane _src_lane of _src, which stores
+// a soa value components.
+OZZ_INLINE void SetLane(math::SoaFloat3* _dest, int _lane,
+                        const float (*_src)[4], int _src_lane) {
+  _dest->x = math::SetI(_dest->x, _lane, _src[0][_src_lane]);
+  _dest->y = math::SetI(_dest->y, _lane, _src[1][_src_lane]);
+  _dest->z = math::SetI(_dest->z, _lane, _src[2][_src_lane]);
+}
+
+OZZ_INLINE void SetLane(math::SoaQuaternion* _dest, int _lane,
+                        const float (*_src)[4], int _src_lane) {
+  _dest->x = math::SetI(_dest->x, _lane, _src[0][_src_lane]);
+  _dest->y = math::SetI(_dest->y, _lane, _src[1][_src_lane]);
+  _dest->z = math::SetI(_dest->z, _lane, _src[2][_src_lane]);
+  _dest->w = math::SetI(_dest->w, _lane, _src[3][_src_lane]);
+}
+
+// Stores soa value _value components to _dest.
+OZZ_INLINE void StoreLanes(const math::SoaFloat3& _value, float (*_dest)[4]) {
+  math::StorePtr(_value.x, _dest[0]);
+  math::StorePtr(_value.y, _dest[1]);
+  math::StorePtr(_value.z, _dest[2]);
+}
+
+OZZ_INLINE void StoreLanes(const math::SoaQuaternion& _value,
+                           float (*_dest)[4]) {
+  math::StorePtr(_value.x, _dest[0]);
+  math::StorePtr(_value.y, _dest[1]);
+  math::StorePtr(_value.z, _dest[2]);
+  math::StorePtr(_value.w, _dest[3]);
+}
+
+// Defines the joints to output when sampling: the range [begin,end[, where
+// begin is a multiple of 4 and output buffer stores joints from begin. If mask
+// isn't NULL, only the soa joints whose bit is set are output.
+struct JointFilter {
+  // Tests if _joint shall be output.
+  bool Contains(int _joint) const {
+    if (_joint < begin || _joint >= end) {
+      return false;
+    }
+    return !mask || (mask[_joint / 32] & (1 << ((_joint / 4) & 7))) != 0;
+  }
+
+  // Tests if any of the _count first _joints shall be output.
+  bool ContainsAny(const uint16_t* _joints, int _count) const {
+    for (int i = 0; i < _count; ++i) {
+      if (Contains(_joints[i])) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  int begin;
+  int end;
+  const unsigned char* mask;
+};
+
+// Scatters the _count first lanes of _value to _output joints _joints, _member
+// selecting the transform component. Joints outside of _filter are skipped.
+template<typename _Soa>
+void ScatterSoa(const _Soa& _value, const uint16_t* _joints, int _count,
+                _Soa math::SoaTransform::*_member,
+                const JointFilter& _filter,
+                math::SoaTransform* _output) {
+  OZZ_ALIGN(16) float values[4][4];
+  StoreLanes(_value, values);
+  for (int i = 0; i < _count; ++i) {
+    const int joint = _joints[i];
+    if (!_filter.Contains(joint)) {
+      continue;
+    }
+    const int index = (joint - _filter.begin) / 4;
+    SetLane(&(_output[index].*_member), joint & 3, values, i);
+  }
+}
+
+// Compares a constant track to a joint index, to search sorted constants.
+struct ConstantLess {
+  template<typename _Constant>
+  bool operator()(const _Constant& _constant, int _joint) const {
+    return _constant.track < _joint;
+  }
+};
+
+// Finds the constants of _constants, sorted by joint index, that belong to
+// _filter range.
+template<typename _Constant>
+ozz::Range<const _Constant> FindConstants(
+  ozz::Range<const _Constant> _constants, const JointFilter& _filter) {
+  const _Constant* begin = std::lower_bound(
+    _constants.begin, _constants.end, _filter.begin, ConstantLess());
+  const _Constant* end =
+    std::lower_bound(begin, _constants.end, _filter.end, ConstantLess());
+  return ozz::Range<const _Constant>(begin, end);
+}
+
+// Finds the range [*_first,*_last[ of animated soa tracks that contains all
+// the joints of _filter range. _tracks are sorted in ascending order.
+void FindSoaTracks(ozz::Range<const uint16_t> _tracks,
+                   const JointFilter& _filter,
+                   int* _first, int* _last) {
+  const uint16_t* begin =
+    std::lower_bound(_tracks.begin, _tracks.end, _filter.begin);
+  const uint16_t* end = std::lower_bound(begin, _tracks.end, _filter.end);
+  *_first = static_cast<int>(begin - _tracks.begin) / 4;
+  *_last = static_cast<int>(end - _tracks.begin + 3) / 4;
+}
+
+// Decompresses constant translations or scales, 4 at a time, and stores them
+// to their joints in _output. Constants that _filter masks out are skipped.
+template<typename _Constant>
+void StoreConstants(ozz::Range<const _Constant> _constants,
+                    math::SoaFloat3 math::SoaTransform::*_member,
+                    const JointFilter& _filter,
+                    math::SoaTransform* _output) {
+  const int count = static_cast<int>(_constants.Count());
+  for (int i = 0; i < count; i += 4) {
+    // The last soa value is completed with the last constant.
+    const _Constant& c0 = _constants.begin[i];
+    const _Constant& c1 = _constants.begin[math::Min(i + 1, count - 1)];
+    const _Constant& c2 = _constants.begin[math::Min(i + 2, count - 1)];
+    const _Constant& c3 = _constants.begin[math::Min(i + 3, count - 1)];
+    const uint16_t joints[4] = {c0.track, c1.track, c2.track, c3.track};
+    if (_filter.mask && !_filter.ContainsAny(joints, math::Min(count - i, 4))) {
+      continue;
+    }
+    const math::SoaFloat3 value = {
+      math::HalfToFloat(math::simd_int4::Load(
+        c0.value[0], c1.value[0], c2.value[0], c3.value[0])),
+      math::HalfToFloat(math::simd_int4::Load(
+        c0.value[1], c1.value[1], c2.value[1], c3.value[1])),
+      math::HalfToFloat(math::simd_int4::Load(
+        c0.value[2], c1.value[2], c2.value[2], c3.value[2]))};
+    ScatterSoa(value, joints, math::Min(count - i, 4), _member, _filter,
+               _output);
+  }
+}
+
+// Decompresses constant rotations, 4 at a time, and stores them to their
+// joints in _output. Constants that _filter masks out are skipped.
+void StoreConstantRotations(ozz::Range<const ConstantRotation> _constants,
+                            const JointFilter& _filter,
+                            math::SoaTransform* _output) {
+  // Prepares constants, as required by DECOMPRESS_SOA_QUAT.
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 eps = math::simd_float4::Load1(1e-16f);
+  const math::SimdFloat4 kInt2Float =
+    math::simd_float4::Load1(1.f / (32767.f * math::kSqrt2));
+  const math::SimdInt4 mf000 = math::simd_int4::mask_f000();
+  const math::SimdInt4 m0f00 = math::simd_int4::mask_0f00();
+  const math::SimdInt4 m00f0 = math::simd_int4::mask_00f0();
+  const math::SimdInt4 m000f = math::simd_int4::mask_000f();
+  const int kCpntMapping[4][4] = {
+    {0, 0, 1, 2}, {0, 0, 1, 2}, {0, 1, 0, 2}, {0, 1, 2, 0}
+  };
+
+  const int count = static_cast<int>(_constants.Count());
+  for (int i = 0; i < count; i += 4) {
+    // The last soa value is completed with the last constant.
+    const ConstantRotation& c0 = _constants.begin[i];
+    const ConstantRotation& c1 =
+      _constants.begin[math::Min(i + 1, count - 1)];
+    const ConstantRotation& c2 =
+      _constants.begin[math::Min(i + 2, count - 1)];
+    const ConstantRotation& c3 =
+      _constants.begin[math::Min(i + 3, count - 1)];
+    const uint16_t joints[4] = {c0.track, c1.track, c2.track, c3.track};
+    if (_filter.mask && !_filter.ContainsAny(joints, math::Min(count - i, 4))) {
+      continue;
+    }
+    math::SoaQuaternion value;
+    DECOMPRESS_SOA_QUAT(c0, c1, c2, c3, value);
+    ScatterSoa(value, joints, math::Min(count - i, 4),
+               &math::SoaTransform::rotation, _filter, _output);
+  }
+}
+
 #undef DECOMPRESS_SOA_QUAT
 
+// Decompresses 4 packed rotation keys to a SoA quaternion. Unlike standard
+// keys, the whole decompression happens in SIMD registers: the 3 smallest
+// components are extracted from the packed values with shifts and masks, and
+// the largest component is re-injected with selects instead of a mapping
+// table.
+OZZ_INLINE void DecompressSoaPackedQuat(const PackedRotationKey& _k0,
+                                        const PackedRotationKey& _k1,
+                                        const PackedRotationKey& _k2,
+                                        const PackedRotationKey& _k3,
+                                        math::SoaQuaternion* _quat) {
+  // Extracts the 3 quantized components, stored on 11, 11 and 10 bits.
+  const math::SimdInt4 value = math::simd_int4::Load(
+    static_cast<int>(_k0.value), static_cast<int>(_k1.value),
+    static_cast<int>(_k2.value), static_cast<int>(_k3.value));
+  const math::SimdInt4 mask11 =
+    math::simd_int4::Load(0x7ff, 0x7ff, 0x7ff, 0x7ff);
+  const math::SimdInt4 qa = math::And(value, mask11);
+  const math::SimdInt4 qb = math::And(math::ShiftRu(value, 11), mask11);
+  const math::SimdInt4 qc = math::ShiftRu(value, 22);
+
+  // Dequantizes components from [0:2^n-1] to [-1/sqrt(2):1/sqrt(2)].
+  const math::SimdFloat4 offset = math::simd_float4::Load1(-math::kSqrt2_2);
+  const math::SimdFloat4 scale11 =
+    math::simd_float4::Load1(math::kSqrt2 / 2047.f);
+  const math::SimdFloat4 scale10 =
+    math::simd_float4::Load1(math::kSqrt2 / 1023.f);
+  const math::SimdFloat4 a =
+    math::MAdd(math::simd_float4::FromInt(qa), scale11, offset);
+  const math::SimdFloat4 b =
+    math::MAdd(math::simd_float4::FromInt(qb), scale11, offset);
+  const math::SimdFloat4 c =
+    math::MAdd(math::simd_float4::FromInt(qc), scale10, offset);
+
+  // Get back length of the largest component. Favors performance over
+  // accuracy by using x * RSqrtEst(x) instead of Sqrt(x).
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 eps = math::simd_float4::Load1(1e-16f);
+  const math::SimdFloat4 dot = a * a + b * b + c * c;
+  const math::SimdFloat4 ww0 = math::Max(eps, one - dot);
+  const math::SimdFloat4 w0 = ww0 * math::RSqrtEst(ww0);
+  // Re-applies largest component's sign.
+  const math::SimdInt4 sign = math::ShiftL(
+    math::simd_int4::Load(_k0.sign, _k1.sign, _k2.sign, _k3.sign), 31);
+  const math::SimdFloat4 restored = math::Or(w0, sign);
+
+  // Re-injects the largest component, smallest components being stored in
+  // quaternion order.
+  const math::SimdInt4 largest = math::simd_int4::Load(
+    _k0.largest, _k1.largest, _k2.largest, _k3.largest);
+  const math::SimdInt4 l0 =
+    math::CmpEq(largest, math::simd_int4::Load(0, 0, 0, 0));
+  const math::SimdInt4 l1 =
+    math::CmpEq(largest, math::simd_int4::Load(1, 1, 1, 1));
+  const math::SimdInt4 l2 =
+    math::CmpEq(largest, math::simd_int4::Load(2, 2, 2, 2));
+  const math::SimdInt4 l3 =
+    math::CmpEq(largest, math::simd_int4::Load(3, 3, 3, 3));
+  _quat->x = math::Select(l0, restored, a);
+  _quat->y = math::Select(l0, a, math::Select(l1, restored, b));
+  _quat->z = math::Select(l3, c, math::Select(l2, restored, b));
+  _quat->w = math::Select(l3, restored, c);
+}
+
+// Decompresses packed rotation keys. _time_scale converts quantized times to
+// seconds.
+void UpdateSoaPackedRotations(int _num_soa_tracks,
+                              ozz::Range<const PackedRotationKey> _keys,
+                              float _time_scale,
+                              const int* _interp,
+                              unsigned char* _outdated,
+                              const unsigned char* _mask,
+                              internal::InterpSoaRotation* _soa_rotations) {
+  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
+  for (int j = 0; j < num_outdated_flags; ++j) {
+    // Only processes entries enabled by _mask, if any. Others stay outdated.
+    unsigned char outdated = _outdated[j];
+    if (_mask) {
+      outdated &= _mask[j];
+    }
+    _outdated[j] &= ~outdated;  // Reset outdated entries that are processed.
+    for (int i = j * 8; outdated; ++i, outdated >>= 1) {
+      if (!(outdated & 1)) {
+        continue;
+      }
+
+      const int base = i * 4 * 2;  // * soa size * 2 keys per track
+
+      // Decompress left side keyframes and store them in soa structures.
+      {
+        const PackedRotationKey& k0 = _keys.begin[_interp[base + 0]];
+        const PackedRotationKey& k1 = _keys.begin[_interp[base + 2]];
+        const PackedRotationKey& k2 = _keys.begin[_interp[base + 4]];
+        const PackedRotationKey& k3 = _keys.begin[_interp[base + 6]];
+
+        _soa_rotations[i].time[0] =
+          LoadTimes(k0.time, k1.time, k2.time, k3.time, _time_scale);
+        DecompressSoaPackedQuat(k0, k1, k2, k3, &_soa_rotations[i].value[0]);
+      }
+
+      // Decompress right side keyframes and store them in soa structures.
+      {
+        const PackedRotationKey& k0 = _keys.begin[_interp[base + 1]];
+        const PackedRotationKey& k1 = _keys.begin[_interp[base + 3]];
+        const PackedRotationKey& k2 = _keys.begin[_interp[base + 5]];
+        const PackedRotationKey& k3 = _keys.begin[_interp[base + 7]];
+
+        _soa_rotations[i].time[1] =
+          LoadTimes(k0.time, k1.time, k2.time, k3.time, _time_scale);
+        DecompressSoaPackedQuat(k0, k1, k2, k3, &_soa_rotations[i].value[1]);
+      }
+    }
+  }
+}
+
+// Decompresses scale keys of type _Key, which is ScaleKey or QuantizedScaleKey.
+// _time_scale converts quantized times to seconds.
+template<typename _Key>
 void UpdateSoaScales(int _num_soa_tracks,
-                     ozz::Range<const ScaleKey> _keys,
+                     ozz::Range<const _Key> _keys,
+                     float _time_scale,
                      const int* _interp,
                      unsigned char* _outdated,
+                     const unsigned char* _mask,
                      internal::InterpSoaScale* soa_scales_) {
   const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
   for (int j = 0; j < num_outdated_flags; ++j) {
+    // Only processes entries enabled by _mask, if any. Others stay outdated.
     unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+    if (_mask) {
+      outdated &= _mask[j];
+    }
+    _outdated[j] &= ~outdated;  // Reset outdated entries that are processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
@@ -322,12 +728,12 @@ void UpdateSoaScales(int _num_soa_tracks,
       const int base = i * 4 * 2;  // * soa size * 2 keys
 
       // Decompress left side keyframes and store them in soa structures.
-      const ScaleKey& k00 = _keys.begin[_interp[base + 0]];
-      const ScaleKey& k10 = _keys.begin[_interp[base + 2]];
-      const ScaleKey& k20 = _keys.begin[_interp[base + 4]];
-      const ScaleKey& k30 = _keys.begin[_interp[base + 6]];
-      soa_scales_[i].time[0] = math::simd_float4::Load(
-        k00.time, k10.time, k20.time, k30.time);
+      const _Key& k00 = _keys.begin[_interp[base + 0]];
+      const _Key& k10 = _keys.begin[_interp[base + 2]];
+      const _Key& k20 = _keys.begin[_interp[base + 4]];
+      const _Key& k30 = _keys.begin[_interp[base + 6]];
+      soa_scales_[i].time[0] = LoadTimes(
+        k00.time, k10.time, k20.time, k30.time, _time_scale);
       soa_scales_[i].value[0].x = math::HalfToFloat(math::simd_int4::Load(
         k00.value[0],k10.value[0], k20.value[0], k30.value[0]));
       soa_scales_[i].value[0].y = math::HalfToFloat(math::simd_int4::Load(
@@ -336,12 +742,12 @@ void UpdateSoaScales(int _num_soa_tracks,
         k00.value[2], k10.value[2], k20.value[2], k30.value[2]));
 
       // Decompress right side keyframes and store them in soa structures.
-      const ScaleKey& k01 = _keys.begin[_interp[base + 1]];
-      const ScaleKey& k11 = _keys.begin[_interp[base + 3]];
-      const ScaleKey& k21 = _keys.begin[_interp[base + 5]];
-      const ScaleKey& k31 = _keys.begin[_interp[base + 7]];
-      soa_scales_[i].time[1] = math::simd_float4::Load(
-        k01.time, k11.time, k21.time, k31.time);
+      const _Key& k01 = _keys.begin[_interp[base + 1]];
+      const _Key& k11 = _keys.begin[_interp[base + 3]];
+      const _Key& k21 = _keys.begin[_interp[base + 5]];
+      const _Key& k31 = _keys.begin[_interp[base + 7]];
+      soa_scales_[i].time[1] = LoadTimes(
+        k01.time, k11.time, k21.time, k31.time, _time_scale);
       soa_scales_[i].value[1].x = math::HalfToFloat(math::simd_int4::Load(
         k01.value[0], k11.value[0], k21.value[0], k31.value[0]));
       soa_scales_[i].value[1].y = math::HalfToFloat(math::simd_int4::Load(
@@ -352,35 +758,205 @@ void UpdateSoaScales(int _num_soa_tracks,
   }
 }
 
-void Interpolates(float _anim_time,
-                  int _num_soa_tracks,
+// Computes _tracks_mask, one bit per animated soa track of _tracks, set if any
+// of the soa track joints is enabled by _soa_joints_mask.
+void ComputeTracksMask(ozz::Range<const uint16_t> _tracks,
+                       const unsigned char* _soa_joints_mask,
+                       unsigned char* _tracks_mask) {
+  const int num_tracks = static_cast<int>(_tracks.Count());
+  memset(_tracks_mask, 0, ((num_tracks + 3) / 4 + 7) / 8);
+  for (int i = 0; i < num_tracks; ++i) {
+    const int soa_joint = _tracks.begin[i] / 4;
+    if (_soa_joints_mask[soa_joint / 8] & (1 << (soa_joint & 7))) {
+      const int soa_track = i / 4;
+      _tracks_mask[soa_track / 8] |= 1 << (soa_track & 7);
+    }
+  }
+}
+
+// Seeks and fetches _keys to the cache at _time, expressed in keys time unit,
+// then updates outdated soa hot values with _update_soa function. Only soa
+// entries enabled by _mask are updated, unless _mask is NULL.
+template<typename _Key, typename _Interp>
+void UpdateCache(float _time, int _num_soa_tracks,
+                 ozz::Range<const _Key> _keys,
+                 const SeekTable& _table, float _time_scale,
+                 int* _cursor, int* _cache, unsigned char* _outdated,
+                 const unsigned char* _mask,
+                 _Interp* _soa,
+                 void (*_update_soa)(int, ozz::Range<const _Key>, float,
+                                     const int*, unsigned char*,
+                                     const unsigned char*, _Interp*)) {
+  if (_num_soa_tracks == 0) {
+    return;  // All tracks are constant.
+  }
+  SeekKeys(_time, _num_soa_tracks, _keys, _table, _table.interval,
+           _cursor, _cache, _outdated);
+  UpdateKeys(_time, _num_soa_tracks, _keys, _cursor, _cache, _outdated);
+  _update_soa(_num_soa_tracks, _keys, _time_scale, _cache, _outdated, _mask,
+              _soa);
+}
+
+// Stores _value, the soa value of animated tracks [_index * 4, _index * 4 + 4[,
+// to their joints of _filter in _output, _member selecting the transform
+// component. The whole soa value is stored at once if these tracks are the 4
+// joints of an output soa element, which is always the case if there's no
+// constant track.
+template<typename _Soa>
+OZZ_INLINE void StoreAnimated(const _Soa& _value, int _index,
+                              ozz::Range<const uint16_t> _tracks,
+                              _Soa math::SoaTransform::*_member,
+                              const JointFilter& _filter,
+                              math::SoaTransform* _output) {
+  const int first = _index * 4;
+  const int count = static_cast<int>(_tracks.Count()) - first;
+  const uint16_t* joints = _tracks.begin + first;
+  if (count >= 4 && (joints[0] & 3) == 0 && joints[3] == joints[0] + 3 &&
+      _filter.Contains(joints[0])) {
+    _output[(joints[0] - _filter.begin) / 4].*_member = _value;
+  } else {
+    ScatterSoa(_value, joints, math::Min(count, 4), _member, _filter, _output);
+  }
+}
+
+// Tests if animated soa track _index has any joint that _filter outputs. Soa
+// tracks that are masked out aren't interpolated, nor decompressed.
+OZZ_INLINE bool IsSoaTrackEnabled(int _index,
+                                  ozz::Range<const uint16_t> _tracks,
+                                  const JointFilter& _filter) {
+  if (!_filter.mask) {
+    return true;  // FindSoaTracks already restricted tracks to the range.
+  }
+  const int first = _index * 4;
+  const int count = static_cast<int>(_tracks.Count()) - first;
+  return _filter.ContainsAny(_tracks.begin + first, math::Min(count, 4));
+}
+
+// Computes the interpolation ratio of two consecutive soa tracks _lo and _hi
+// at once.
+template <typename _Interp>
+OZZ_INLINE math::SimdFloat8 WideInterpRatio(const _Interp& _lo,
+                                            const _Interp& _hi,
+                                            math::_SimdFloat8 _time) {
+  const math::SimdFloat8 time0 =
+    math::simd_float8::Load(_lo.time[0], _hi.time[0]);
+  const math::SimdFloat8 time1 =
+    math::simd_float8::Load(_lo.time[1], _hi.time[1]);
+  return (_time - time0) * math::RcpEst(time1 - time0);
+}
+
+// Interpolates soa hot data at _anim_time, and stores the joints of _filter to
+// _output. Only animated soa tracks that contain joints of _filter are
+// interpolated.
+void Interpolates(const Animation& _animation,
+                  float _anim_time,
                   const internal::InterpSoaTranslation* _translations,
                   const internal::InterpSoaRotation* _rotations,
                   const internal::InterpSoaScale* _scales,
+                  const JointFilter& _filter,
                   math::SoaTransform* _output) {
-    const math::SimdFloat4 anim_time = math::simd_float4::Load1(_anim_time);
-    for (int i = 0; i < _num_soa_tracks; ++i) {
-      // Prepares interpolation coefficients.
-      const math::SimdFloat4 interp_t_time =
-        (anim_time - _translations[i].time[0]) *
-        math::RcpEst(_translations[i].time[1] - _translations[i].time[0]);
-      const math::SimdFloat4 interp_r_time =
-        (anim_time - _rotations[i].time[0]) *
-        math::RcpEst(_rotations[i].time[1] - _rotations[i].time[0]);
-      const math::SimdFloat4 interp_s_time =
-        (anim_time - _scales[i].time[0]) *
-        math::RcpEst(_scales[i].time[1] - _scales[i].time[0]);
-
-      // Processes interpolations.
-      // The lerp of the rotation uses the shortest path, because opposed
-      // quaternions were negated during animation build stage (AnimationBuilder).
-      _output[i].translation = Lerp(
-        _translations[i].value[0], _translations[i].value[1], interp_t_time);
-      _output[i].rotation = NLerpEst(
-        _rotations[i].value[0], _rotations[i].value[1], interp_r_time);
-      _output[i].scale = Lerp(
-        _scales[i].value[0], _scales[i].value[1], interp_s_time);
+  const math::SimdFloat4 anim_time = math::simd_float4::Load1(_anim_time);
+  const math::SimdFloat8 wide_time = math::simd_float8::Load1(_anim_time);
+
+  // Processes interpolations of animated tracks. Soa tracks are interpolated
+  // by pairs with 8 wide simd, the last one (if any) with 4 wide simd.
+  int i, last;
+  FindSoaTracks(_animation.translation_tracks(), _filter, &i, &last);
+  for (; i < last - 1; i += 2) {
+    if (!IsSoaTrackEnabled(i, _animation.translation_tracks(), _filter) &&
+        !IsSoaTrackEnabled(i + 1, _animation.translation_tracks(), _filter)) {
+      continue;
+    }
+    const internal::InterpSoaTranslation* interp = _translations + i;
+    const math::WideSoaFloat3 value = Lerp(
+      math::WideSoaFloat3::Load(interp[0].value[0], interp[1].value[0]),
+      math::WideSoaFloat3::Load(interp[0].value[1], interp[1].value[1]),
+      WideInterpRatio(interp[0], interp[1], wide_time));
+    StoreAnimated(GetLow(value), i, _animation.translation_tracks(),
+                  &math::SoaTransform::translation, _filter, _output);
+    StoreAnimated(GetHigh(value), i + 1, _animation.translation_tracks(),
+                  &math::SoaTransform::translation, _filter, _output);
+  }
+  for (; i < last; ++i) {
+    if (!IsSoaTrackEnabled(i, _animation.translation_tracks(), _filter)) {
+      continue;
     }
+    const math::SimdFloat4 interp_time =
+      (anim_time - _translations[i].time[0]) *
+      math::RcpEst(_translations[i].time[1] - _translations[i].time[0]);
+    StoreAnimated(
+      Lerp(_translations[i].value[0], _translations[i].value[1], interp_time),
+      i, _animation.translation_tracks(), &math::SoaTransform::translation,
+      _filter, _output);
+  }
+
+  // The lerp of the rotation uses the shortest path, because opposed
+  // quaternions were negated during animation build stage (AnimationBuilder).
+  FindSoaTracks(_animation.rotation_tracks(), _filter, &i, &last);
+  for (; i < last - 1; i += 2) {
+    if (!IsSoaTrackEnabled(i, _animation.rotation_tracks(), _filter) &&
+        !IsSoaTrackEnabled(i + 1, _animation.rotation_tracks(), _filter)) {
+      continue;
+    }
+    const internal::InterpSoaRotation* interp = _rotations + i;
+    const math::WideSoaQuaternion value = NLerpEst(
+      math::WideSoaQuaternion::Load(interp[0].value[0], interp[1].value[0]),
+      math::WideSoaQuaternion::Load(interp[0].value[1], interp[1].value[1]),
+      WideInterpRatio(interp[0], interp[1], wide_time));
+    StoreAnimated(GetLow(value), i, _animation.rotation_tracks(),
+                  &math::SoaTransform::rotation, _filter, _output);
+    StoreAnimated(GetHigh(value), i + 1, _animation.rotation_tracks(),
+                  &math::SoaTransform::rotation, _filter, _output);
+  }
+  for (; i < last; ++i) {
+    if (!IsSoaTrackEnabled(i, _animation.rotation_tracks(), _filter)) {
+      continue;
+    }
+    const math::SimdFloat4 interp_time =
+      (anim_time - _rotations[i].time[0]) *
+      math::RcpEst(_rotations[i].time[1] - _rotations[i].time[0]);
+    StoreAnimated(
+      NLerpEst(_rotations[i].value[0], _rotations[i].value[1], interp_time),
+      i, _animation.rotation_tracks(), &math::SoaTransform::rotation,
+      _filter, _output);
+  }
+
+  FindSoaTracks(_animation.scale_tracks(), _filter, &i, &last);
+  for (; i < last - 1; i += 2) {
+    if (!IsSoaTrackEnabled(i, _animation.scale_tracks(), _filter) &&
+        !IsSoaTrackEnabled(i + 1, _animation.scale_tracks(), _filter)) {
+      continue;
+    }
+    const internal::InterpSoaScale* interp = _scales + i;
+    const math::WideSoaFloat3 value = Lerp(
+      math::WideSoaFloat3::Load(interp[0].value[0], interp[1].value[0]),
+      math::WideSoaFloat3::Load(interp[0].value[1], interp[1].value[1]),
+      WideInterpRatio(interp[0], interp[1], wide_time));
+    StoreAnimated(GetLow(value), i, _animation.scale_tracks(),
+                  &math::SoaTransform::scale, _filter, _output);
+    StoreAnimated(GetHigh(value), i + 1, _animation.scale_tracks(),
+                  &math::SoaTransform::scale, _filter, _output);
+  }
+  for (; i < last; ++i) {
+    if (!IsSoaTrackEnabled(i, _animation.scale_tracks(), _filter)) {
+      continue;
+    }
+    const math::SimdFloat4 interp_time =
+      (anim_time - _scales[i].time[0]) *
+      math::RcpEst(_scales[i].time[1] - _scales[i].time[0]);
+    StoreAnimated(
+      Lerp(_scales[i].value[0], _scales[i].value[1], interp_time),
+      i, _animation.scale_tracks(), &math::SoaTransform::scale,
+      _filter, _output);
+  }
+
+  // Constant tracks values are stored without interpolation.
+  StoreConstants(FindConstants(_animation.constant_translations(), _filter),
+                 &math::SoaTransform::translation, _filter, _output);
+  StoreConstantRotations(
+    FindConstants(_animation.constant_rotations(), _filter), _filter, _output);
+  StoreConstants(FindConstants(_animation.constant_scales(), _filter),
+                 &math::SoaTransform::scale, _filter, _output);
 }
 }  // namespace
 
@@ -403,59 +979,93 @@ bool SamplingJob::Run() const {
   // Clamps time in range [0,duration].
   const float anim_time = math::Clamp(0.f, time, animation->duration());
 
-  // Step the cache to this potentially new animation and time.
+  // Step the cache to this potentially new animation, then seeks and fetches
+  // key frames at anim_time, and updates outdated soa hot values.
   assert(cache->max_soa_tracks() >= num_soa_tracks);
-  cache->Step(*animation, anim_time);
-
-  // Fetch key frames from the animation to the cache a t = anim_time.
-  // Then updates outdated soa hot values.
-  UpdateKeys(anim_time, num_soa_tracks,
-             animation->translations(),
-             &cache->translation_cursor_,
-             cache->translation_keys_,
-             cache->outdated_translations_);
-  UpdateSoaTranslations(num_soa_tracks,
-                        animation->translations(),
-                        cache->translation_keys_,
-                        cache->outdated_translations_,
-                        cache->soa_translations_);
-
-  UpdateKeys(anim_time, num_soa_tracks,
-             animation->rotations(),
-             &cache->rotation_cursor_,
-             cache->rotation_keys_,
-             cache->outdated_rotations_);
-  UpdateSoaRotations(num_soa_tracks,
-                     animation->rotations(),
-                     cache->rotation_keys_,
-                     cache->outdated_rotations_,
-                     cache->soa_rotations_);
-
-  UpdateKeys(anim_time, num_soa_tracks,
-             animation->scales(),
-             &cache->scale_cursor_,
-             cache->scale_keys_,
-             cache->outdated_scales_);
-  UpdateSoaScales(num_soa_tracks,
-                  animation->scales(),
-                  cache->scale_keys_,
-                  cache->outdated_scales_,
-                  cache->soa_scales_);
+  cache->Step(*animation);
+  cache->Update(*animation, anim_time, soa_joints_mask.begin);
 
   // Interpolates soa hot data.
-  Interpolates(anim_time,
-               num_soa_tracks,
-               cache->soa_translations_,
-               cache->soa_rotations_,
-               cache->soa_scales_,
-               output.begin);
+  cache->Interpolate(*animation, anim_time, 0, num_soa_tracks,
+                     soa_joints_mask.begin, output.begin);
+
+  return true;
+}
+
+BatchSamplingJob::Instance::Instance()
+    : time(0.f) {
+}
+
+BatchSamplingJob::BatchSamplingJob()
+    : animation(NULL),
+      cache(NULL) {
+}
+
+bool BatchSamplingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL pointers.
+  if (!animation || !cache) {
+    return false;
+  }
+
+  // Tests instances range, implicitly tests instances.end != NULL.
+  valid &= instances.begin != NULL;
+  valid &= instances.begin <= instances.end;
+
+  // Tests cache size.
+  const ptrdiff_t num_soa_tracks = animation->num_soa_tracks();
+  valid &= cache->max_soa_tracks() >= num_soa_tracks;
+
+  // Tests each instance output range.
+  if (valid) {
+    for (const Instance* instance = instances.begin;
+         instance < instances.end;
+         ++instance) {
+      valid &= instance->output.begin != NULL;
+      valid &= instance->output.end - instance->output.begin >= num_soa_tracks;
+    }
+  }
+
+  return valid;
+}
+
+bool BatchSamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+  if (num_soa_tracks == 0) {  // Early out if animation contains no joint.
+    return true;
+  }
+
+  assert(cache->max_soa_tracks() >= num_soa_tracks);
+  for (const Instance* instance = instances.begin;
+       instance < instances.end;
+       ++instance) {
+    // Clamps time in range [0,duration].
+    const float anim_time =
+      math::Clamp(0.f, instance->time, animation->duration());
+
+    // Steps the shared cache to this instance time. Only entries whose key
+    // frames differ from the previous instance are decompressed again.
+    cache->Step(*animation);
+    cache->Update(*animation, anim_time, NULL);
+
+    // Interpolates soa hot data.
+    cache->Interpolate(*animation, anim_time, 0, num_soa_tracks, NULL,
+                       instance->output.begin);
+  }
 
   return true;
 }
 
 SamplingCache::SamplingCache(int _max_tracks)
     : animation_(NULL),
-    time_(0.f),
     max_soa_tracks_((_max_tracks + 3) / 4),
     soa_translations_(NULL),
     soa_rotations_(NULL),
@@ -468,7 +1078,10 @@ SamplingCache::SamplingCache(int _max_tracks)
     scale_cursor_(0),
     outdated_translations_(NULL),
     outdated_rotations_(NULL),
-    outdated_scales_(NULL) {
+    outdated_scales_(NULL),
+    translations_mask_(NULL),
+    rotations_mask_(NULL),
+    scales_mask_(NULL) {
   using internal::InterpSoaTranslation;
   using internal::InterpSoaRotation;
   using internal::InterpSoaScale;
@@ -486,7 +1099,7 @@ SamplingCache::SamplingCache(int _max_tracks)
     sizeof(InterpSoaRotation) * max_soa_tracks_ +
     sizeof(InterpSoaScale) *max_soa_tracks_ +
     sizeof(int) * max_tracks * 2 * 3 +  // 2 keys * (trans + rot + scale).
-    sizeof(unsigned char) * 3 * num_outdated;
+    sizeof(unsigned char) * 3 * num_outdated * 2;  // Outdated flags + masks.
 
   // Allocates all at once.
   memory::Allocator* allocator = memory::default_allocator();
@@ -517,6 +1130,13 @@ SamplingCache::SamplingCache(int _max_tracks)
   outdated_scales_ = reinterpret_cast<unsigned char*>(alloc_cursor);
   alloc_cursor += sizeof(unsigned char) * num_outdated;
 
+  translations_mask_ = reinterpret_cast<unsigned char*>(alloc_cursor);
+  alloc_cursor += sizeof(unsigned char) * num_outdated;
+  rotations_mask_ = reinterpret_cast<unsigned char*>(alloc_cursor);
+  alloc_cursor += sizeof(unsigned char) * num_outdated;
+  scales_mask_ = reinterpret_cast<unsigned char*>(alloc_cursor);
+  alloc_cursor += sizeof(unsigned char) * num_outdated;
+
   assert(alloc_cursor == alloc_begin + size);
 }
 
@@ -525,20 +1145,120 @@ SamplingCache::~SamplingCache() {
   memory::default_allocator()->Deallocate(soa_translations_);
 }
 
-void SamplingCache::Step(const Animation& _animation, float _time) {
-  // The cache is invalidated if animation has changed or if it is being rewind.
-  if (animation_ != &_animation || _time < time_) {
+void SamplingCache::Step(const Animation& _animation) {
+  // The cache is invalidated if animation has changed. Rewinding is handled
+  // by seeking keys during Update().
+  if (animation_ != &_animation) {
     animation_ = &_animation;
     translation_cursor_ = 0;
     rotation_cursor_ = 0;
     scale_cursor_ = 0;
   }
-  time_ = _time;
+}
+
+void SamplingCache::Update(const Animation& _animation, float _time,
+                           const uint8_t* _soa_joints_mask) {
+  assert(max_soa_tracks_ >= _animation.num_soa_tracks());
+  const int num_soa_translations = _animation.num_soa_translation_tracks();
+  const int num_soa_rotations = _animation.num_soa_rotation_tracks();
+  const int num_soa_scales = _animation.num_soa_scale_tracks();
+
+  // Converts the soa joints mask to animated soa tracks masks. Key frames are
+  // still walked for all tracks, but only enabled ones are decompressed.
+  const unsigned char* translations_mask = NULL;
+  const unsigned char* rotations_mask = NULL;
+  const unsigned char* scales_mask = NULL;
+  if (_soa_joints_mask) {
+    ComputeTracksMask(_animation.translation_tracks(), _soa_joints_mask,
+                      translations_mask_);
+    ComputeTracksMask(_animation.rotation_tracks(), _soa_joints_mask,
+                      rotations_mask_);
+    ComputeTracksMask(_animation.scale_tracks(), _soa_joints_mask,
+                      scales_mask_);
+    translations_mask = translations_mask_;
+    rotations_mask = rotations_mask_;
+    scales_mask = scales_mask_;
+  }
+
+  // Quantized time keys and their seek tables are walked in quantized time
+  // unit, which is converted back to seconds by _time_scale.
+  const float duration = _animation.duration();
+  const float quantized_time =
+    duration > 0.f ? _time * (kQuantizedTimeMax / duration) : 0.f;
+  const float time_scale = duration / kQuantizedTimeMax;
+  const bool quantized = _animation.time_format() == Animation::kTimeQuantized;
+
+  // Seeks and fetches key frames from the animation to the cache at t = _time.
+  // Then updates outdated soa hot values.
+  if (quantized) {
+    UpdateCache(quantized_time, num_soa_translations,
+                _animation.quantized_translations(),
+                _animation.translations_seek_table(), time_scale,
+                &translation_cursor_, translation_keys_,
+                outdated_translations_, translations_mask, soa_translations_,
+                &UpdateSoaTranslations<QuantizedTranslationKey>);
+  } else {
+    UpdateCache(_time, num_soa_translations,
+                _animation.translations(),
+                _animation.translations_seek_table(), time_scale,
+                &translation_cursor_, translation_keys_,
+                outdated_translations_, translations_mask, soa_translations_,
+                &UpdateSoaTranslations<TranslationKey>);
+  }
+
+  if (_animation.rotation_format() == Animation::kRotationPacked) {
+    UpdateCache(quantized_time, num_soa_rotations,
+                _animation.packed_rotations(),
+                _animation.rotations_seek_table(), time_scale,
+                &rotation_cursor_, rotation_keys_,
+                outdated_rotations_, rotations_mask, soa_rotations_,
+                &UpdateSoaPackedRotations);
+  } else if (quantized) {
+    UpdateCache(quantized_time, num_soa_rotations,
+                _animation.quantized_rotations(),
+                _animation.rotations_seek_table(), time_scale,
+                &rotation_cursor_, rotation_keys_,
+                outdated_rotations_, rotations_mask, soa_rotations_,
+                &UpdateSoaRotations<QuantizedRotationKey>);
+  } else {
+    UpdateCache(_time, num_soa_rotations,
+                _animation.rotations(),
+                _animation.rotations_seek_table(), time_scale,
+                &rotation_cursor_, rotation_keys_,
+                outdated_rotations_, rotations_mask, soa_rotations_,
+                &UpdateSoaRotations<RotationKey>);
+  }
+
+  if (quantized) {
+    UpdateCache(quantized_time, num_soa_scales,
+                _animation.quantized_scales(),
+                _animation.scales_seek_table(), time_scale,
+                &scale_cursor_, scale_keys_,
+                outdated_scales_, scales_mask, soa_scales_,
+                &UpdateSoaScales<QuantizedScaleKey>);
+  } else {
+    UpdateCache(_time, num_soa_scales,
+                _animation.scales(),
+                _animation.scales_seek_table(), time_scale,
+                &scale_cursor_, scale_keys_,
+                outdated_scales_, scales_mask, soa_scales_,
+                &UpdateSoaScales<ScaleKey>);
+  }
+}
+
+void SamplingCache::Interpolate(const Animation& _animation, float _time,
+                                int _soa_begin, int _soa_end,
+                                const uint8_t* _soa_joints_mask,
+                                math::SoaTransform* _output) const {
+  assert(_soa_begin >= 0 && _soa_begin <= _soa_end &&
+         _soa_end <= _animation.num_soa_tracks());
+  const JointFilter filter = {_soa_begin * 4, _soa_end * 4, _soa_joints_mask};
+  Interpolates(_animation, _time, soa_translations_, soa_rotations_,
+               soa_scales_, filter, _output);
 }
 
 void SamplingCache::Invalidate() {
   animation_ = NULL;
-  time_ = 0.f;
   translation_cursor_ = 0;
   rotation_cursor_ = 0;
   scale_cursor_ = 0;
@@ -0,0 +1,310 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/segmented_animation.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+
+#include <cstring>
+#include <cassert>
+
+namespace ozz {
+namespace animation {
+
+SegmentedAnimation::SegmentedAnimation()
+    : duration_(0.f),
+      segment_duration_(0.f),
+      num_tracks_(0),
+      name_(NULL),
+      stream_(NULL) {
+}
+
+SegmentedAnimation::~SegmentedAnimation() {
+  Deallocate();
+}
+
+void SegmentedAnimation::Allocate(size_t _name_len, size_t _num_segments) {
+  // Distributes buffer memory while ensuring proper alignment (serves larger
+  // alignment values first).
+  OZZ_STATIC_ASSERT(
+    OZZ_ALIGN_OF(Animation*) >= OZZ_ALIGN_OF(int) &&
+    OZZ_ALIGN_OF(int) >= OZZ_ALIGN_OF(char));
+
+  assert(name_ == NULL && segments_.Size() == 0 && offsets_.Size() == 0);
+
+  // Compute overall size and allocate a single buffer for all the data.
+  const size_t buffer_size =
+    (_name_len > 0 ? _name_len + 1 : 0) +
+    _num_segments * sizeof(Animation*) +
+    (_num_segments + 1) * sizeof(int);
+  char* buffer = memory::default_allocator()->Allocate<char>(buffer_size);
+
+  // Fix up pointers
+  segments_.begin = reinterpret_cast<Animation**>(buffer);
+  assert(math::IsAligned(segments_.begin, OZZ_ALIGN_OF(Animation*)));
+  buffer += _num_segments * sizeof(Animation*);
+  segments_.end = reinterpret_cast<Animation**>(buffer);
+
+  offsets_.begin = reinterpret_cast<int*>(buffer);
+  assert(math::IsAligned(offsets_.begin, OZZ_ALIGN_OF(int)));
+  buffer += (_num_segments + 1) * sizeof(int);
+  offsets_.end = reinterpret_cast<int*>(buffer);
+
+  // Let name be NULL if animation has no name.
+  name_ = reinterpret_cast<char*>(_name_len > 0 ? buffer : NULL);
+
+  // No segment is resident yet.
+  for (size_t i = 0; i < _num_segments; ++i) {
+    segments_.begin[i] = NULL;
+  }
+  for (size_t i = 0; i <= _num_segments; ++i) {
+    offsets_.begin[i] = 0;
+  }
+}
+
+void SegmentedAnimation::Deallocate() {
+  memory::Allocator* allocator = memory::default_allocator();
+  for (Animation** segment = segments_.begin;
+       segment < segments_.end;
+       ++segment) {
+    allocator->Delete(*segment);
+  }
+  allocator->Deallocate(segments_.begin);
+
+  name_ = NULL;
+  segments_ = ozz::Range<Animation*>();
+  offsets_ = ozz::Range<int>();
+  stream_ = NULL;
+}
+
+int SegmentedAnimation::segment_index(float _time) const {
+  const int num_segments = this->num_segments();
+  if (num_segments == 0) {
+    return 0;
+  }
+  const float time = math::Clamp(0.f, _time, duration_);
+  const int index = static_cast<int>(time / segment_duration_);
+  return math::Min(index, num_segments - 1);
+}
+
+const Animation* SegmentedAnimation::segment(int _index) const {
+  if (_index < 0 || _index >= num_segments()) {
+    return NULL;
+  }
+  return segments_.begin[_index];
+}
+
+const Animation* SegmentedAnimation::Resolve(float _time,
+                                             float* _segment_time) const {
+  assert(_segment_time);
+  const int index = segment_index(_time);
+  const float time = math::Clamp(0.f, _time, duration_);
+  *_segment_time = math::Max(0.f, time - index * segment_duration_);
+  return segment(index);
+}
+
+bool SegmentedAnimation::LoadSegment(int _index) {
+  if (segments_.begin[_index]) {
+    return true;  // Already resident.
+  }
+  // A truncated stream doesn't contain the whole segment data.
+  const int begin = offsets_.begin[_index];
+  const int end = offsets_.begin[_index + 1];
+  if (!stream_ || static_cast<int>(stream_->Size()) < end ||
+      stream_->Seek(begin, io::Stream::kSet)) {
+    return false;
+  }
+
+  // Every segment is stored as a standalone archive.
+  io::IArchive archive(stream_);
+  if (!archive.TestTag<Animation>()) {
+    return false;
+  }
+  Animation* segment = memory::default_allocator()->New<Animation>();
+  archive >> *segment;
+
+  // Rejects segments that couldn't be loaded (unsupported version, corrupted
+  // data...), or that don't match the animation. Slot remains empty.
+  if (stream_->Tell() != end ||
+      segment->num_tracks() != num_tracks_ ||
+      segment->duration() <= 0.f) {
+    memory::default_allocator()->Delete(segment);
+    return false;
+  }
+  segments_.begin[_index] = segment;
+  return true;
+}
+
+bool SegmentedAnimation::Update(float _time, int _look_ahead,
+                                bool* _streamed_out) {
+  if (_streamed_out) {
+    *_streamed_out = false;
+  }
+  const int num_segments = this->num_segments();
+  if (num_segments == 0) {
+    return true;
+  }
+  const int first = segment_index(_time);
+  const int last = math::Min(first + math::Max(_look_ahead, 0),
+                             num_segments - 1);
+
+  // Streams out segments that aren't required anymore, only if they can be
+  // streamed in again.
+  if (stream_) {
+    memory::Allocator* allocator = memory::default_allocator();
+    for (int i = 0; i < num_segments; ++i) {
+      if ((i < first || i > last) && segments_.begin[i]) {
+        allocator->Delete(segments_.begin[i]);
+        segments_.begin[i] = NULL;
+        if (_streamed_out) {
+          *_streamed_out = true;
+        }
+      }
+    }
+  }
+
+  // Streams in required segments.
+  bool success = true;
+  for (int i = first; i <= last; ++i) {
+    success &= LoadSegment(i);
+  }
+  return success;
+}
+
+size_t SegmentedAnimation::size() const {
+  size_t size = sizeof(*this) + segments_.Size() + offsets_.Size();
+  for (Animation** segment = segments_.begin;
+       segment < segments_.end;
+       ++segment) {
+    if (*segment) {
+      size += (*segment)->size();
+    }
+  }
+  return size;
+}
+
+void SegmentedAnimation::Save(ozz::io::OArchive& _archive) const {
+  _archive << duration_;
+  _archive << segment_duration_;
+  _archive << static_cast<int32_t>(num_tracks_);
+
+  const size_t name_len = name_ ? std::strlen(name_) : 0;
+  _archive << static_cast<int32_t>(name_len);
+  _archive << ozz::io::MakeArray(name_, name_len);
+
+  // Every segment is written as a standalone archive (with the same
+  // endianness), so it can be loaded independently. Segments are first written
+  // to a memory stream in order to know their size.
+  const Endianness native = GetNativeEndianness();
+  const Endianness endianness = _archive.endian_swap() ?
+    (native == kLittleEndian ? kBigEndian : kLittleEndian) : native;
+  const int32_t num_segments = static_cast<int32_t>(segments_.Count());
+  _archive << num_segments;
+
+  ozz::io::MemoryStream segments_stream;
+  for (int i = 0; i < num_segments; ++i) {
+    assert(segments_.begin[i] && "Saving requires all segments to be resident");
+    const int begin = segments_stream.Tell();
+    ozz::io::OArchive archive(&segments_stream, endianness);
+    archive << *segments_.begin[i];
+    _archive << static_cast<int32_t>(segments_stream.Tell() - begin);
+  }
+
+  // Copies segments data.
+  const size_t size = segments_stream.Size();
+  if (size) {
+    char* buffer = memory::default_allocator()->Allocate<char>(size);
+    segments_stream.Seek(0, ozz::io::Stream::kSet);
+    OZZ_IF_DEBUG(size_t read =) segments_stream.Read(buffer, size);
+    assert(read == size);
+    OZZ_IF_DEBUG(size_t written =) _archive.SaveBinary(buffer, size);
+    assert(written == size);
+    memory::default_allocator()->Deallocate(buffer);
+  }
+}
+
+void SegmentedAnimation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+
+  // Destroy animation in case it was already used before.
+  Deallocate();
+  duration_ = 0.f;
+  segment_duration_ = 0.f;
+  num_tracks_ = 0;
+
+  if (_version != 1) {
+    return;
+  }
+
+  _archive >> duration_;
+  _archive >> segment_duration_;
+
+  int32_t num_tracks;
+  _archive >> num_tracks;
+  num_tracks_ = num_tracks;
+
+  int32_t name_len;
+  _archive >> name_len;
+  char* name = NULL;
+  if (name_len > 0) {  // Name is read before allocation, as sizes are unknown.
+    name = memory::default_allocator()->Allocate<char>(name_len);
+    _archive >> ozz::io::MakeArray(name, name_len);
+  }
+
+  int32_t num_segments;
+  _archive >> num_segments;
+
+  Allocate(name_len, num_segments);
+  if (name_) {  // NULL name_ is supported.
+    std::memcpy(name_, name, name_len);
+    name_[name_len] = 0;
+  }
+  memory::default_allocator()->Deallocate(name);
+
+  // Computes segments position in the stream. Segments data follow the
+  // segments size table.
+  int32_t* sizes = memory::default_allocator()->Allocate<int32_t>(
+    math::Max(num_segments, 1));
+  _archive >> ozz::io::MakeArray(sizes, num_segments);
+  stream_ = _archive.stream();
+  int offset = stream_->Tell();
+  for (int i = 0; i < num_segments; ++i) {
+    offsets_.begin[i] = offset;
+    offset += sizes[i];
+  }
+  offsets_.begin[num_segments] = offset;
+  memory::default_allocator()->Deallocate(sizes);
+
+  // Skips segments data, which are loaded on demand.
+  stream_->Seek(offset, ozz::io::Stream::kSet);
+}
+}  // animation
+}  // ozz
@@ -28,6 +28,7 @@
 #include "ozz/animation/runtime/skeleton.h"
 
 #include <cstring>
+#include <cassert>
 
 #include "ozz/base/io/archive.h"
 #include "ozz/base/maths/math_ex.h"
@@ -74,7 +75,16 @@ void Load(IArchive& _archive,
 
 namespace animation {
 
-Skeleton::Skeleton() {}
+namespace {
+// In-place data alignment. OZZ_ALIGN_OF(math::SoaTransform) is conservatively
+// computed from its size, where SoaTransform only requires the alignment of its
+// SimdFloat4 members, which matches their size.
+const size_t kInPlaceAlignment = sizeof(math::SimdFloat4);
+}  // namespace
+
+Skeleton::Skeleton()
+    : in_place_(false) {
+}
 
 Skeleton::~Skeleton() {
   Deallocate();
@@ -130,7 +140,13 @@ char* Skeleton::Allocate(size_t _chars_size, size_t _num_joints) {
 }
 
 void Skeleton::Deallocate() {
-  memory::default_allocator()->Deallocate(bind_pose_.begin);
+  if (in_place_) {
+    // Only joint names array is owned by in-place skeletons.
+    memory::default_allocator()->Deallocate(joint_names_.begin);
+    in_place_ = false;
+  } else {
+    memory::default_allocator()->Deallocate(bind_pose_.begin);
+  }
   bind_pose_.Clear();
   joint_names_.Clear();
   joint_properties_.Clear();
@@ -201,5 +217,117 @@ void Skeleton::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   _archive >> ozz::io::MakeArray(joint_properties_);
   _archive >> ozz::io::MakeArray(bind_pose_);
 }
+
+void Skeleton::SaveInPlace(ozz::io::OArchive& _archive) const {
+  assert(!_archive.endian_swap() &&
+         "In-place archives must have native endianness.");
+
+  // Stores memory layout properties, so they can be validated when loading.
+  _archive << static_cast<uint32_t>(sizeof(math::SoaTransform));
+  _archive << static_cast<uint32_t>(sizeof(Skeleton::JointProperties));
+
+  const int32_t num_joints = this->num_joints();
+
+  // Early out if skeleton's empty.
+  _archive << num_joints;
+  if (!num_joints) {
+    return;
+  }
+
+  size_t chars_count = 0;
+  for (int i = 0; i < num_joints; ++i) {
+    chars_count += (std::strlen(joint_names_[i]) + 1) * sizeof(char);
+  }
+  _archive << static_cast<int32_t>(chars_count);
+
+  // Stores data as-is, from the biggest to the smallest alignment.
+  io::PadInPlace(_archive, kInPlaceAlignment);
+  _archive.SaveBinary(bind_pose_.begin, bind_pose_.Size());
+  _archive.SaveBinary(joint_properties_.begin, joint_properties_.Size());
+  _archive.SaveBinary(joint_names_[0], chars_count);
+}
+
+void Skeleton::LoadInPlace(ozz::io::IArchive& _archive, uint32_t _version) {
+
+  // Deallocate skeleton in case it was already used before.
+  Deallocate();
+
+  // In-place data cannot be endian swapped.
+  if (_version != 1 || _archive.endian_swap()) {
+    return;
+  }
+
+  uint32_t transform_size;
+  _archive >> transform_size;
+  uint32_t properties_size;
+  _archive >> properties_size;
+  if (transform_size != sizeof(math::SoaTransform) ||
+      properties_size != sizeof(Skeleton::JointProperties)) {
+    return;
+  }
+
+  int32_t num_joints;
+  _archive >> num_joints;
+
+  // Early out if skeleton's empty.
+  if (!num_joints) {
+    return;
+  }
+
+  int32_t chars_count;
+  _archive >> chars_count;
+
+  if (!io::PadInPlace(_archive, kInPlaceAlignment)) {
+    return;
+  }
+
+  const size_t bind_poses_size =
+    (num_joints + 3) / 4 * sizeof(math::SoaTransform);
+  const size_t joint_properties_size =
+    num_joints * sizeof(Skeleton::JointProperties);
+  const size_t data_size =
+    bind_poses_size + joint_properties_size + chars_count;
+
+  // Uses stream memory directly if it's available and properly aligned.
+  io::Stream* stream = _archive.stream();
+  char* data = static_cast<char*>(const_cast<void*>(stream->Map(data_size)));
+  if (data &&
+      !math::IsAligned(data, kInPlaceAlignment)) {
+    stream->Seek(-static_cast<int>(data_size), io::Stream::kCurrent);
+    data = NULL;
+  }
+
+  char* cursor;
+  if (data) {
+    in_place_ = true;
+    joint_names_ =
+      memory::default_allocator()->AllocateRange<char*>(num_joints);
+
+    bind_pose_.begin = reinterpret_cast<math::SoaTransform*>(data);
+    data += bind_poses_size;
+    bind_pose_.end = reinterpret_cast<math::SoaTransform*>(data);
+
+    joint_properties_.begin =
+      reinterpret_cast<Skeleton::JointProperties*>(data);
+    data += joint_properties_size;
+    joint_properties_.end = reinterpret_cast<Skeleton::JointProperties*>(data);
+
+    cursor = data;
+  } else {
+    // Falls back to copying data.
+    cursor = Allocate(chars_count, num_joints);
+    _archive.LoadBinary(bind_pose_.begin, bind_poses_size);
+    _archive.LoadBinary(joint_properties_.begin, joint_properties_size);
+    _archive.LoadBinary(cursor, chars_count);
+  }
+
+  // Fixes up array of pointers. Stops at num_joints - 1, so that it doesn't
+  // read memory past the end of the buffer.
+  for (int i = 0; i < num_joints - 1; ++i) {
+    joint_names_[i] = cursor;
+    cursor += std::strlen(joint_names_[i]) + 1;
+  }
+  joint_names_[num_joints - 1] = cursor;
+}
 }  // animation
 }  // ozz
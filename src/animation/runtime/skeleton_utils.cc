@@ -28,6 +28,7 @@
 #include "ozz/animation/runtime/skeleton_utils.h"
 
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
 
 #include <assert.h>
 
@@ -148,5 +149,109 @@ void IterateJointsDF(const Skeleton& _skeleton,
   }
 }
 #undef _HAS_SIBLING
+
+// Joints are sorted such that a parent always precedes its children. An
+// interval of joints can thus be cut at every joint that isn't preceded by the
+// parent of any of the following joints of the interval. Resulting chunks only
+// depend on themselves and on joints outside of the interval, which are already
+// processed. Chunks are merged together in ranges of at most _grain joints,
+// while bigger chunks are split: their first _grain joints are processed by the
+// current stage, the remaining ones are deferred to the next stage.
+bool PartitionJoints(const Skeleton& _skeleton,
+                     int _grain,
+                     JointsPartition* _partition) {
+  assert(_partition);
+  assert(_grain > 0 && "Grain must be greater than 0.");
+  const int num_joints = _skeleton.num_joints();
+  Range<const Skeleton::JointProperties> properties =
+    _skeleton.joint_properties();
+
+  // Initialize partition.
+  _partition->num_ranges = 0;
+  _partition->num_stages = 0;
+
+  // Tests buffers sizes.
+  if (_partition->ranges.Count() < static_cast<size_t>(num_joints) ||
+      _partition->stages.Count() < static_cast<size_t>(num_joints) + 1) {
+    return false;
+  }
+  _partition->stages[0] = 0;
+
+  if (num_joints == 0 || _grain <= 0) {
+    return true;
+  }
+
+  // Queue of the intervals that remain to be processed, and flags of the
+  // joints that start a new chunk. Intervals are disjoint and not empty, so
+  // there's no more than num_joints of them.
+  typedef JointsPartition::JointRange JointRange;
+  memory::Allocator* allocator = memory::default_allocator();
+  JointRange* queue = allocator->Allocate<JointRange>(num_joints);
+  bool* cuts = allocator->Allocate<bool>(num_joints);
+  int queue_begin = 0;
+  int queue_size = 0;
+  const JointRange all = {0, static_cast<uint16_t>(num_joints)};
+  queue[queue_size++] = all;
+
+  while (queue_size != 0) {
+    // Intervals currently in the queue are all processed by this stage.
+    for (int stage_size = queue_size; stage_size != 0; --stage_size) {
+      const JointRange interval = queue[queue_begin];
+      queue_begin = (queue_begin + 1) % num_joints;
+      --queue_size;
+
+      // Finds chunks, traversing the interval backward to know the lowest
+      // parent of all the following joints.
+      int lowest = interval.to;
+      for (int joint = interval.to - 1; joint > interval.from; --joint) {
+        const int parent = properties.begin[joint].parent;
+        if (parent >= interval.from && parent < lowest) {
+          lowest = parent;
+        }
+        cuts[joint] = lowest >= joint;
+      }
+
+      // Fills ranges with chunks.
+      int range_begin = interval.from;
+      for (int chunk = interval.from; chunk < interval.to;) {
+        int chunk_end = chunk + 1;
+        for (; chunk_end < interval.to && !cuts[chunk_end]; ++chunk_end) {
+        }
+
+        if (chunk_end - range_begin > _grain) {
+          // Chunk doesn't fit in the current range, which is closed.
+          if (chunk > range_begin) {
+            const JointRange range = {static_cast<uint16_t>(range_begin),
+                                      static_cast<uint16_t>(chunk)};
+            _partition->ranges[_partition->num_ranges++] = range;
+            range_begin = chunk;
+          }
+          // Chunk is split if it's bigger than the grain.
+          if (chunk_end - chunk > _grain) {
+            const JointRange head = {static_cast<uint16_t>(chunk),
+                                     static_cast<uint16_t>(chunk + _grain)};
+            _partition->ranges[_partition->num_ranges++] = head;
+            const JointRange tail = {static_cast<uint16_t>(chunk + _grain),
+                                     static_cast<uint16_t>(chunk_end)};
+            queue[(queue_begin + queue_size++) % num_joints] = tail;
+            range_begin = chunk_end;
+          }
+        }
+        chunk = chunk_end;
+      }
+      if (range_begin < interval.to) {
+        const JointRange range = {static_cast<uint16_t>(range_begin),
+                                  interval.to};
+        _partition->ranges[_partition->num_ranges++] = range;
+      }
+    }
+    _partition->stages[++_partition->num_stages] =
+      static_cast<uint16_t>(_partition->num_ranges);
+  }
+
+  allocator->Deallocate(queue);
+  allocator->Deallocate(cuts);
+  return true;
+}
 }  // animation
 }  // ozz
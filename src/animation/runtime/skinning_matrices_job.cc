@@ -0,0 +1,141 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/skinning_matrices_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace animation {
+
+bool SkinningMatricesJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL begin pointers.
+  valid &= models.begin != NULL;
+  valid &= inverse_bind_poses.begin != NULL;
+  valid &= output.begin != NULL;
+
+  // Test ranges, implicitly tests for NULL end pointers.
+  const ptrdiff_t num_matrices = output.end - output.begin;
+  valid &= num_matrices >= 0;
+  valid &= inverse_bind_poses.end - inverse_bind_poses.begin >=
+           (num_matrices + 3) / 4;
+
+  // Test remapping table.
+  const ptrdiff_t num_models = models.end - models.begin;
+  if (joint_remaps.begin != NULL) {
+    valid &= joint_remaps.end - joint_remaps.begin >= num_matrices;
+    for (const uint16_t* remap = joint_remaps.begin;
+         valid && remap < joint_remaps.begin + num_matrices;
+         ++remap) {
+      valid &= *remap < num_models;
+    }
+  } else {
+    valid &= num_models >= num_matrices;
+  }
+
+  return valid;
+}
+
+bool SkinningMatricesJob::Run() const {
+  using math::SoaFloat4x4;
+  using math::Float4x4;
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_matrices = static_cast<int>(output.end - output.begin);
+  for (int i = 0, soa = 0; i < num_matrices; i += 4, ++soa) {
+    const int count = math::Min(num_matrices - i, 4);
+
+    // Gathers and transposes up to 4 model matrices to a soa matrix. Missing
+    // ones are replaced by the last model matrix.
+    const Float4x4* aos_models[4];
+    for (int j = 0; j < 4; ++j) {
+      const int index = i + math::Min(j, count - 1);
+      aos_models[j] = &models.begin[
+        joint_remaps.begin != NULL ? joint_remaps.begin[index] : index];
+    }
+    SoaFloat4x4 soa_models;
+    for (int k = 0; k < 4; ++k) {
+      const math::SimdFloat4 aos_cols[4] = {aos_models[0]->cols[k],
+                                            aos_models[1]->cols[k],
+                                            aos_models[2]->cols[k],
+                                            aos_models[3]->cols[k]};
+      math::Transpose4x4(aos_cols, &soa_models.cols[k].x);
+    }
+
+    // Multiplies by inverse bind-poses and transposes back to aos.
+    const SoaFloat4x4 soa_skinning = soa_models * inverse_bind_poses.begin[soa];
+    for (int k = 0; k < 4; ++k) {
+      math::SimdFloat4 aos_cols[4];
+      math::Transpose4x4(&soa_skinning.cols[k].x, aos_cols);
+      for (int j = 0; j < count; ++j) {
+        output.begin[i + j].cols[k] = aos_cols[j];
+      }
+    }
+  }
+  return true;
+}
+
+bool PackInverseBindPoses(Range<const math::Float4x4> _inverse_bind_poses,
+                          Range<math::SoaFloat4x4> _output) {
+  const int num_matrices = static_cast<int>(_inverse_bind_poses.Count());
+  const int num_soa_matrices = (num_matrices + 3) / 4;
+  if (_output.Count() < static_cast<size_t>(num_soa_matrices)) {
+    return false;
+  }
+
+  const math::Float4x4 identity = math::Float4x4::identity();
+  for (int soa = 0; soa < num_soa_matrices; ++soa) {
+    const math::Float4x4* matrices[4];
+    for (int j = 0; j < 4; ++j) {
+      const int index = soa * 4 + j;
+      matrices[j] = index < num_matrices ?
+        &_inverse_bind_poses.begin[index] : &identity;
+    }
+    for (int k = 0; k < 4; ++k) {
+      const math::SimdFloat4 aos_cols[4] = {matrices[0]->cols[k],
+                                            matrices[1]->cols[k],
+                                            matrices[2]->cols[k],
+                                            matrices[3]->cols[k]};
+      math::Transpose4x4(aos_cols, &_output.begin[soa].cols[k].x);
+    }
+  }
+  return true;
+}
+}  // animation
+}  // ozz
@@ -56,5 +56,36 @@ IArchive::IArchive(Stream* _stream)
   *this >> endianness;
   endian_swap_ = endianness != GetNativeEndianness();
 }
+
+// In-place padding implementation.
+
+void PadInPlace(OArchive& _archive, size_t _alignment) {
+  assert((_alignment & (_alignment - 1)) == 0 &&
+         "Alignment must be a power of 2.");
+  const int tell = _archive.stream()->Tell();
+  assert(tell >= 0);
+  const size_t padding =
+    (_alignment - (static_cast<size_t>(tell) & (_alignment - 1))) &
+    (_alignment - 1);
+  for (size_t i = 0; i < padding; ++i) {
+    const uint8_t zero = 0;
+    _archive << zero;
+  }
+}
+
+bool PadInPlace(IArchive& _archive, size_t _alignment) {
+  assert((_alignment & (_alignment - 1)) == 0 &&
+         "Alignment must be a power of 2.");
+  const int tell = _archive.stream()->Tell();
+  if (tell < 0) {
+    return false;
+  }
+  const size_t padding =
+    (_alignment - (static_cast<size_t>(tell) & (_alignment - 1))) &
+    (_alignment - 1);
+  return padding == 0 ||
+         _archive.stream()->Seek(static_cast<int>(padding),
+                                 Stream::kCurrent) == 0;
+}
 }  // io
 }  // ozz
@@ -31,7 +31,9 @@ namespace ozz {
 namespace math {
 
 const char* SimdImplementationName() {
-#if defined(OZZ_SIMD_AVX)
+#if defined(OZZ_SIMD_AVX2)
+  return "AVX2";
+#elif defined(OZZ_SIMD_AVX)
   return "AVX";
 #elif defined(OZZ_SIMD_SSE4_2)
   return "SSE4.2";
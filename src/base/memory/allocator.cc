@@ -31,6 +31,10 @@
 #include <cassert>
 #include <memory.h>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif  // _MSC_VER
+
 #include "ozz/base/maths/math_ex.h"
 
 namespace ozz {
@@ -41,10 +45,32 @@ struct Header {
   void* unaligned;
   size_t size;
 };
+
+// Atomically adds _value to _count, so that allocations can be traced from
+// concurrent threads.
+#if defined(_MSC_VER)
+typedef long AtomicCount;
+inline void AtomicAdd(volatile AtomicCount* _count, long _value) {
+  _InterlockedExchangeAdd(_count, _value);
+}
+#elif defined(__GNUC__) || defined(__clang__)
+typedef int AtomicCount;
+inline void AtomicAdd(volatile AtomicCount* _count, int _value) {
+  __sync_fetch_and_add(_count, _value);
 }
+#else
+// No atomic support, allocations must not be traced concurrently.
+typedef int AtomicCount;
+inline void AtomicAdd(volatile AtomicCount* _count, int _value) {
+  *_count += _value;
+}
+#endif
+}  // namespace
 
 // Implements the basic heap allocator->
 // Will trace allocation count and assert in case of a memory leak.
+// Allocation count is updated atomically, so the heap allocator is thread
+// safe.
 class HeapAllocator : public Allocator {
  public:
   HeapAllocator() :
@@ -70,7 +96,7 @@ class HeapAllocator : public Allocator {
     header->unaligned = unaligned;
     header->size = _size;
     // Allocation's succeeded.
-    ++allocation_count_;
+    AtomicAdd(&allocation_count_, 1);
     return aligned;
   }
 
@@ -84,7 +110,7 @@ class HeapAllocator : public Allocator {
       free(old_header->unaligned);
 
       // Deallocation completed.
-      --allocation_count_;
+      AtomicAdd(&allocation_count_, -1);
     }
     return new_block;
   }
@@ -95,14 +121,14 @@ class HeapAllocator : public Allocator {
         reinterpret_cast<char*>(_block) - sizeof(Header));
       free(header->unaligned);
       // Deallocation completed.
-      --allocation_count_;
+      AtomicAdd(&allocation_count_, -1);
     }
   }
 
  private:
   // Internal allocation count used to track memory leaks.
   // Should equals 0 at destruction time.
-  int allocation_count_;
+  volatile AtomicCount allocation_count_;
 };
 
 namespace {
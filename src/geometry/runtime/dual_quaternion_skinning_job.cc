@@ -0,0 +1,361 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/dual_quaternion_skinning_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+namespace geometry {
+
+DualQuaternionPaletteJob::DualQuaternionPaletteJob() {
+}
+
+bool DualQuaternionPaletteJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL pointers.
+  valid &= models.begin != NULL && models.end >= models.begin;
+  valid &= inverse_bind_poses.begin != NULL &&
+           inverse_bind_poses.end >= inverse_bind_poses.begin;
+  valid &= output.begin != NULL && output.end >= output.begin;
+
+  // Test ranges size.
+  valid &= inverse_bind_poses.Count() >= models.Count();
+  valid &= output.Count() >= models.Count();
+
+  return valid;
+}
+
+bool DualQuaternionPaletteJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const size_t count = models.Count();
+  for (size_t i = 0; i < count; ++i) {
+    const math::Float4x4 matrix = models[i] * inverse_bind_poses[i];
+
+    // Extracts rigid part of the transformation.
+    math::SimdFloat4 translation, rotation, scale;
+    if (!math::ToAffine(matrix, &translation, &rotation, &scale)) {
+      translation = matrix.cols[3];
+      rotation = math::simd_float4::w_axis();
+    }
+
+    // dual = .5 * t * real, where t is the pure quaternion (x, y, z, 0) made
+    // of the translation.
+    const math::SimdInt4 mask_fff0 = math::simd_int4::mask_fff0();
+    const math::SimdFloat4 half = math::simd_float4::Load1(.5f);
+    const math::SimdFloat4 t = math::And(translation, mask_fff0);
+    const math::SimdFloat4 dual_xyz =
+      math::Cross3(t, rotation) + t * math::SplatW(rotation);
+    const math::SimdFloat4 dual_w = math::SplatX(-math::Dot3(t, rotation));
+    DualQuaternion& dq = output.begin[i];
+    dq.real = rotation;
+    dq.dual = math::Select(mask_fff0, dual_xyz, dual_w) * half;
+  }
+
+  return true;
+}
+
+DualQuaternionSkinningJob::DualQuaternionSkinningJob()
+ : vertex_count(0),
+   influences_count(0),
+   joint_indices_stride(0),
+   joint_weights_stride(0),
+   in_positions_stride(0),
+   in_normals_stride(0),
+   in_tangents_stride(0),
+   out_positions_stride(0),
+   out_normals_stride(0),
+   out_tangents_stride(0) {
+}
+
+bool DualQuaternionSkinningJob::Validate() const {
+
+  // Start validation of all parameters.
+  bool valid = true;
+
+  // Checks influences bounds.
+  valid &= influences_count > 0;
+
+  // Checks joints dual quaternions, required.
+  valid &= joint_dual_quaternions.begin != NULL;
+  valid &= joint_dual_quaternions.end >= joint_dual_quaternions.begin;
+
+  // Prepares local variables used to compute buffer size.
+  const int vertex_count_minus_1 = vertex_count > 0 ? vertex_count - 1 : 0;
+  const int vertex_count_at_least_1 = vertex_count > 0;
+
+  // Checks indices, required.
+  valid &= joint_indices.Size() >=
+    joint_indices_stride * vertex_count_minus_1 +
+    sizeof(uint16_t) * influences_count * vertex_count_at_least_1;
+
+  // Checks weights, required if influences_count > 1.
+  if (influences_count != 1) {
+    valid &= joint_weights.Size() >=
+      joint_weights_stride * vertex_count_minus_1 +
+      sizeof(float) * (influences_count - 1) * vertex_count_at_least_1;
+  }
+
+  // Checks positions, mandatory.
+  valid &= in_positions.Size() >=
+      in_positions_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+  valid &= out_positions.begin != NULL;
+  valid &= out_positions.Size() >=
+      out_positions_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+
+  // Checks normals, optional.
+  if (in_normals.begin) {
+    valid &= in_normals.Size() >=
+      in_normals_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+    valid &= out_normals.begin != NULL;
+    valid &= out_normals.Size() >=
+      out_normals_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+
+    // Checks tangents, optional but requires normals.
+    if (in_tangents.begin) {
+      valid &= in_tangents.Size() >=
+        in_tangents_stride * vertex_count_minus_1 +
+        sizeof(float) * 3 * vertex_count_at_least_1;
+      valid &= out_tangents.begin != NULL;
+      valid &= out_tangents.Size() >=
+        out_tangents_stride * vertex_count_minus_1 +
+        sizeof(float) * 3 * vertex_count_at_least_1;
+    }
+  } else {
+    // Tangents are not supported if normals are not there.
+    valid &= in_tangents.begin == NULL;
+    valid &= in_tangents.end == NULL;
+  }
+
+  return valid;
+}
+
+namespace {
+
+// Blends the dual quaternions of the joints influencing a vertex, and
+// normalizes the result. _Influences is the number of influences when known
+// at compile time, or 0 to use job's influences_count. Dual quaternions are
+// blended in the hemisphere of the first one, as q and -q represent the same
+// rotation.
+template <int _Influences>
+OZZ_INLINE void BlendDualQuaternions(const DualQuaternionSkinningJob& _job,
+                                     const uint16_t* _indices,
+                                     const float* _weights,
+                                     math::SimdFloat4* _real,
+                                     math::SimdFloat4* _dual) {
+  const DualQuaternion& dq0 = _job.joint_dual_quaternions[_indices[0]];
+  if (_Influences == 1) {
+    // Palette dual quaternions are already normalized.
+    *_real = dq0.real;
+    *_dual = dq0.dual;
+    return;
+  }
+  const int last = (_Influences ? _Influences : _job.influences_count) - 1;
+
+  const math::SimdFloat4 w0 = math::simd_float4::Load1PtrU(_weights);
+  math::SimdFloat4 wsum = w0;
+  math::SimdFloat4 real = dq0.real * w0;
+  math::SimdFloat4 dual = dq0.dual * w0;
+  for (int i = 1; i <= last; ++i) {
+    const DualQuaternion& dq = _job.joint_dual_quaternions[_indices[i]];
+    math::SimdFloat4 w;
+    if (i != last) {
+      w = math::simd_float4::Load1PtrU(_weights + i);
+      wsum = wsum + w;
+    } else {
+      w = math::simd_float4::one() - wsum;
+    }
+    const math::SimdInt4 sign =
+      math::Sign(math::SplatX(math::Dot4(dq0.real, dq.real)));
+    const math::SimdFloat4 signed_w = math::Xor(w, sign);
+    real = real + dq.real * signed_w;
+    dual = dual + dq.dual * signed_w;
+  }
+
+  const math::SimdFloat4 inv_len =
+    math::SplatX(math::RSqrtEstNR(math::Length4Sqr(real)));
+  *_real = real * inv_len;
+  *_dual = dual * inv_len;
+}
+
+// Rotates vector _v by unit quaternion _q.
+OZZ_INLINE math::SimdFloat4 Rotate(math::_SimdFloat4 _q,
+                                   math::_SimdFloat4 _v) {
+  const math::SimdFloat4 a = math::Cross3(_q, _v) + math::SplatW(_q) * _v;
+  const math::SimdFloat4 b = math::Cross3(_q, a);
+  return _v + b + b;
+}
+
+// Transforms point _p by unit dual quaternion (_real, _dual).
+OZZ_INLINE math::SimdFloat4 Transform(math::_SimdFloat4 _real,
+                                      math::_SimdFloat4 _dual,
+                                      math::_SimdFloat4 _p) {
+  const math::SimdFloat4 t = math::Cross3(_real, _dual) +
+                             math::SplatW(_real) * _dual -
+                             math::SplatW(_dual) * _real;
+  return Rotate(_real, _p) + t + t;
+}
+
+// Loads 3 floats. The 4th component is also read if it's _Safe to, that is
+// for all vertices but the last one.
+template <bool _Safe>
+OZZ_INLINE math::SimdFloat4 Load3(const float* _f) {
+  return _Safe ?
+    math::simd_float4::LoadPtrU(_f) : math::simd_float4::Load3PtrU(_f);
+}
+
+// Defines job's buffers iterators.
+struct Iterators {
+  explicit Iterators(const DualQuaternionSkinningJob& _job)
+    : indices(_job.joint_indices.begin),
+      weights(_job.joint_weights.begin),
+      in_positions(_job.in_positions.begin),
+      in_normals(_job.in_normals.begin),
+      in_tangents(_job.in_tangents.begin),
+      out_positions(_job.out_positions.begin),
+      out_normals(_job.out_normals.begin),
+      out_tangents(_job.out_tangents.begin) {
+  }
+  const uint16_t* indices;
+  const float* weights;
+  const float* in_positions;
+  const float* in_normals;
+  const float* in_tangents;
+  float* out_positions;
+  float* out_normals;
+  float* out_tangents;
+};
+
+// Skins the vertex pointed by _it. Positions are always transformed, normals
+// and tangents are transformed according to _Normals and _Tangents.
+template <int _Influences, bool _Normals, bool _Tangents, bool _Safe>
+OZZ_INLINE void SkinVertex(const DualQuaternionSkinningJob& _job,
+                           const Iterators& _it) {
+  math::SimdFloat4 real, dual;
+  BlendDualQuaternions<_Influences>(
+    _job, _it.indices, _it.weights, &real, &dual);
+
+  const math::SimdFloat4 in_p = Load3<_Safe>(_it.in_positions);
+  math::Store3PtrU(Transform(real, dual, in_p), _it.out_positions);
+  if (_Normals) {
+    const math::SimdFloat4 in_n = Load3<_Safe>(_it.in_normals);
+    math::Store3PtrU(Rotate(real, in_n), _it.out_normals);
+  }
+  if (_Tangents) {
+    const math::SimdFloat4 in_t = Load3<_Safe>(_it.in_tangents);
+    math::Store3PtrU(Rotate(real, in_t), _it.out_tangents);
+  }
+}
+
+// Skins all job's vertices.
+template <int _Influences, bool _Normals, bool _Tangents>
+void SkinVertices(const DualQuaternionSkinningJob& _job) {
+  assert(_job.vertex_count > 0);
+  Iterators it(_job);
+  for (int i = 0; i < _job.vertex_count - 1; ++i) {
+    SkinVertex<_Influences, _Normals, _Tangents, true>(_job, it);
+
+    it.indices = PointerStride(it.indices, _job.joint_indices_stride);
+    it.weights = PointerStride(it.weights, _job.joint_weights_stride);
+    it.in_positions = PointerStride(it.in_positions, _job.in_positions_stride);
+    it.out_positions =
+      PointerStride(it.out_positions, _job.out_positions_stride);
+    if (_Normals) {
+      it.in_normals = PointerStride(it.in_normals, _job.in_normals_stride);
+      it.out_normals = PointerStride(it.out_normals, _job.out_normals_stride);
+    }
+    if (_Tangents) {
+      it.in_tangents = PointerStride(it.in_tangents, _job.in_tangents_stride);
+      it.out_tangents =
+        PointerStride(it.out_tangents, _job.out_tangents_stride);
+    }
+  }
+  // Last vertex doesn't read beyond buffers end.
+  SkinVertex<_Influences, _Normals, _Tangents, false>(_job, it);
+}
+
+// Defines a matrix of skinning function pointers. This matrix will then be
+// indexed according to skinning jobs parameters.
+typedef void (*SkinningFct)(const DualQuaternionSkinningJob&);
+const SkinningFct kSkinningFct[5][3] = {
+  {&SkinVertices<1, false, false>,
+   &SkinVertices<1, true, false>,
+   &SkinVertices<1, true, true>},
+  {&SkinVertices<2, false, false>,
+   &SkinVertices<2, true, false>,
+   &SkinVertices<2, true, true>},
+  {&SkinVertices<3, false, false>,
+   &SkinVertices<3, true, false>,
+   &SkinVertices<3, true, true>},
+  {&SkinVertices<4, false, false>,
+   &SkinVertices<4, true, false>,
+   &SkinVertices<4, true, true>},
+  {&SkinVertices<0, false, false>,
+   &SkinVertices<0, true, false>,
+   &SkinVertices<0, true, true>}
+};
+}  // namespace
+
+bool DualQuaternionSkinningJob::Run() const {
+  // Exit with an error if job is invalid.
+  if (!Validate()) {
+    return false;
+  }
+
+  // Early out if no vertex. This isn't an error.
+  if (vertex_count == 0) {
+    return true;
+  }
+
+  // Find skinning function index.
+  const size_t inf =
+    static_cast<size_t>(influences_count) > OZZ_ARRAY_SIZE(kSkinningFct) ?
+      OZZ_ARRAY_SIZE(kSkinningFct) - 1 : influences_count - 1;
+  assert(inf < OZZ_ARRAY_SIZE(kSkinningFct));
+  const size_t fct = (in_normals.begin != NULL) + (in_tangents.begin != NULL);
+  assert(fct < OZZ_ARRAY_SIZE(kSkinningFct[0]));
+
+  // Calls skinning function. Cannot fail because job is valid.
+  kSkinningFct[inf][fct](*this);
+
+  return true;
+}
+}  // geometry
+}  // ozz
@@ -0,0 +1,149 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/parallel_skinning_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace geometry {
+
+ParallelSkinningJob::ParallelSkinningJob()
+ : grain(1024),
+   scheduler(NULL) {
+}
+
+bool ParallelSkinningJob::Validate() const {
+  bool valid = job.Validate();
+  valid &= grain > 0;
+  return valid;
+}
+
+namespace {
+
+// Computes the number of vertices of a buffer of stride _stride that match a
+// whole number of cache lines.
+int CacheLineVertices(size_t _stride) {
+  int vertices = 1;
+  while ((_stride * vertices) % ParallelSkinningJob::kCacheLineSize != 0 &&
+         vertices < ParallelSkinningJob::kCacheLineSize) {
+    vertices *= 2;
+  }
+  return vertices;
+}
+
+// Offsets _range begin by _count elements of _stride bytes.
+template <typename _Ty>
+void Offset(Range<_Ty>* _range, size_t _stride, int _count) {
+  if (_range->begin) {
+    _range->begin = reinterpret_cast<_Ty*>(
+      reinterpret_cast<uintptr_t>(_range->begin) + _stride * _count);
+  }
+}
+
+// Tasks context, shared by all tasks.
+struct TaskContext {
+  const SkinningJob* job;
+  int range_size;
+};
+
+// Task function, skins the vertex range _index.
+void SkinRange(void* _user_data, int _index) {
+  const TaskContext& context = *reinterpret_cast<TaskContext*>(_user_data);
+  const SkinningJob& job = *context.job;
+  const int range_size = context.range_size;
+  const int begin = _index * range_size;
+  assert(begin < job.vertex_count);
+
+  // Offsets all job buffers to the beginning of the range.
+  SkinningJob range_job = job;
+  range_job.vertex_count = math::Min(range_size, job.vertex_count - begin);
+  Offset(&range_job.joint_indices, job.joint_indices_stride, begin);
+  Offset(&range_job.joint_indices8, job.joint_indices_stride, begin);
+  if (job.influences_count > 1) {
+    Offset(&range_job.joint_weights, job.joint_weights_stride, begin);
+    Offset(&range_job.joint_weights16, job.joint_weights_stride, begin);
+    Offset(&range_job.joint_weights8, job.joint_weights_stride, begin);
+  }
+  Offset(&range_job.in_positions, job.in_positions_stride, begin);
+  Offset(&range_job.in_normals, job.in_normals_stride, begin);
+  Offset(&range_job.in_tangents, job.in_tangents_stride, begin);
+  Offset(&range_job.out_positions, job.out_positions_stride, begin);
+  Offset(&range_job.out_normals, job.out_normals_stride, begin);
+  Offset(&range_job.out_tangents, job.out_tangents_stride, begin);
+
+  // Cannot fail as a sub range of a valid job is valid.
+  const bool success = range_job.Run();
+  assert(success);
+  (void)success;
+}
+}  // namespace
+
+int ParallelSkinningJob::range_size() const {
+  if (!Validate()) {
+    return 0;
+  }
+
+  // Rounds grain up to a multiple of the vertices of a cache line. Strides are
+  // checked for all outputs, as they can be interleaved or not.
+  int alignment = CacheLineVertices(job.out_positions_stride);
+  if (job.out_normals.begin) {
+    alignment = math::Max(alignment,
+                          CacheLineVertices(job.out_normals_stride));
+  }
+  if (job.out_tangents.begin) {
+    alignment = math::Max(alignment,
+                          CacheLineVertices(job.out_tangents_stride));
+  }
+  return (grain + alignment - 1) / alignment * alignment;
+}
+
+bool ParallelSkinningJob::Run() const {
+  // Exit with an error if job is invalid.
+  if (!Validate()) {
+    return false;
+  }
+
+  TaskContext context = {&job, range_size()};
+  const int ranges =
+    (job.vertex_count + context.range_size - 1) / context.range_size;
+
+  // Dispatches ranges.
+  if (scheduler && ranges > 1) {
+    scheduler->Run(&SkinRange, &context, ranges);
+  } else {
+    for (int i = 0; i < ranges; ++i) {
+      SkinRange(&context, i);
+    }
+  }
+
+  return true;
+}
+}  // geometry
+}  // ozz
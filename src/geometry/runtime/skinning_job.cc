@@ -70,18 +70,37 @@ bool SkinningJob::Validate() const {
   const int vertex_count_minus_1 = vertex_count > 0 ? vertex_count - 1 : 0;
   const int vertex_count_at_least_1 = vertex_count > 0;
 
-  // Checks indices, required.
-  valid &= joint_indices.begin != NULL;
-  valid &= joint_indices.Size() >=
-    joint_indices_stride * vertex_count_minus_1 +
-    sizeof(uint16_t) * influences_count * vertex_count_at_least_1;
+  // Checks indices, required in one (and only one) of the supported formats.
+  valid &= (joint_indices.begin != NULL) + (joint_indices8.begin != NULL) == 1;
+  if (joint_indices.begin) {
+    valid &= joint_indices.Size() >=
+      joint_indices_stride * vertex_count_minus_1 +
+      sizeof(uint16_t) * influences_count * vertex_count_at_least_1;
+  } else {
+    valid &= joint_indices8.Size() >=
+      joint_indices_stride * vertex_count_minus_1 +
+      sizeof(uint8_t) * influences_count * vertex_count_at_least_1;
+  }
 
-  // Checks weights, required if influences_count > 1. 
+  // Checks weights, required if influences_count > 1, in one (and only one) of
+  // the supported formats.
   if (influences_count != 1) {
-    valid &= joint_weights.begin != NULL;
-    valid &= joint_weights.Size() >=
-      joint_weights_stride * vertex_count_minus_1 +
-      sizeof(float) * (influences_count - 1) * vertex_count_at_least_1;
+    valid &= (joint_weights.begin != NULL) +
+             (joint_weights16.begin != NULL) +
+             (joint_weights8.begin != NULL) == 1;
+    if (joint_weights.begin) {
+      valid &= joint_weights.Size() >=
+        joint_weights_stride * vertex_count_minus_1 +
+        sizeof(float) * (influences_count - 1) * vertex_count_at_least_1;
+    } else if (joint_weights16.begin) {
+      valid &= joint_weights16.Size() >=
+        joint_weights_stride * vertex_count_minus_1 +
+        sizeof(uint16_t) * (influences_count - 1) * vertex_count_at_least_1;
+    } else {
+      valid &= joint_weights8.Size() >=
+        joint_weights_stride * vertex_count_minus_1 +
+        sizeof(uint8_t) * (influences_count - 1) * vertex_count_at_least_1;
+    }
   }
 
   // Checks positions, mandatory.
@@ -123,6 +142,68 @@ bool SkinningJob::Validate() const {
   return valid;
 }
 
+// Defines joint indices formats. Each provides the index type, and a function
+// that returns the beginning of job's indices array.
+struct Indices16 {
+  typedef uint16_t Type;
+  static OZZ_INLINE const Type* Begin(const SkinningJob& _job) {
+    return _job.joint_indices.begin;
+  }
+};
+
+struct Indices8 {
+  typedef uint8_t Type;
+  static OZZ_INLINE const Type* Begin(const SkinningJob& _job) {
+    return _job.joint_indices8.begin;
+  }
+};
+
+// Defines joint weights formats. Each provides the weight type, a function
+// that returns the beginning of job's weights array, and functions that
+// decode weights:
+// - Load1 decodes the weight pointed by _w, and replicates it to all the
+// components of the returned vector.
+// - Load decodes the 4 weights pointed by _w.
+struct WeightsFloat {
+  typedef float Type;
+  static OZZ_INLINE const Type* Begin(const SkinningJob& _job) {
+    return _job.joint_weights.begin;
+  }
+  static OZZ_INLINE math::SimdFloat4 Load1(const Type* _w) {
+    return math::simd_float4::Load1PtrU(_w);
+  }
+  static OZZ_INLINE math::SimdFloat4 Load(const Type* _w) {
+    return math::simd_float4::LoadPtrU(_w);
+  }
+};
+
+// Unsigned normalized integer weights, [0, 2^n - 1] mapping to [0, 1].
+template <typename _Ty>
+struct WeightsUNorm {
+  typedef _Ty Type;
+  static OZZ_INLINE math::SimdFloat4 Load1(const Type* _w) {
+    return math::simd_float4::Load1(
+      static_cast<float>(_w[0]) * (1.f / static_cast<_Ty>(-1)));
+  }
+  static OZZ_INLINE math::SimdFloat4 Load(const Type* _w) {
+    const math::SimdInt4 w = math::simd_int4::Load(_w[0], _w[1], _w[2], _w[3]);
+    return math::simd_float4::FromInt(w) *
+           math::simd_float4::Load1(1.f / static_cast<_Ty>(-1));
+  }
+};
+
+struct WeightsUNorm16 : public WeightsUNorm<uint16_t> {
+  static OZZ_INLINE const Type* Begin(const SkinningJob& _job) {
+    return _job.joint_weights16.begin;
+  }
+};
+
+struct WeightsUNorm8 : public WeightsUNorm<uint8_t> {
+  static OZZ_INLINE const Type* Begin(const SkinningJob& _job) {
+    return _job.joint_weights8.begin;
+  }
+};
+
 // For performance optimization reasons, every skinning variants (positions,
 // positions + normals, 1 to n influences...) are implemented as separate
 // specialized functions.
@@ -130,8 +211,11 @@ bool SkinningJob::Validate() const {
 // define a skeleton code (SKINNING_FN) for the skinning loop, which internally
 // calls MACRO that are shared or specialized according to skinning variants.
 
+// Skinning functions are templates of _Indices and _Weights formats.
+
 // Defines the skeleton code for the per vertex skinning loop.
 #define SKINNING_FN(_type, _it, _inf) \
+  template <typename _Indices, typename _Weights> \
   void SKINNING_FN_NAME(_type, _it, _inf)(const SkinningJob& _job) { \
     ASSERT_##_type() \
     ASSERT_##_it() \
@@ -178,7 +262,7 @@ bool SkinningJob::Validate() const {
 
 // Implements loop initializations for positions, ...
 #define INIT_P() \
-  const uint16_t* joint_indices = _job.joint_indices.begin; \
+  const typename _Indices::Type* joint_indices = _Indices::Begin(_job); \
   const float* in_positions = _job.in_positions.begin; \
   float* out_positions = _job.out_positions.begin;
 
@@ -199,7 +283,7 @@ bool SkinningJob::Validate() const {
 
 #define INIT_W2() \
   const math::SimdFloat4 one = math::simd_float4::one(); \
-  const float* joint_weights = _job.joint_weights.begin;
+  const typename _Weights::Type* joint_weights = _Weights::Begin(_job);
 
 #define INIT_W3() \
   INIT_W2()
@@ -217,7 +301,8 @@ bool SkinningJob::Validate() const {
 #define NEXT_W1()
 
 #define NEXT_W2() \
-  joint_weights = NEXT(const float*, joint_weights, _job.joint_weights_stride); \
+  joint_weights = NEXT(const typename _Weights::Type*, \
+                       joint_weights, _job.joint_weights_stride);
 
 #define NEXT_W3() \
   NEXT_W2()
@@ -229,7 +314,8 @@ bool SkinningJob::Validate() const {
   NEXT_W2()
 
 #define NEXT_P() \
-  joint_indices = NEXT(const uint16_t*, joint_indices, _job.joint_indices_stride); \
+  joint_indices = NEXT(const typename _Indices::Type*, \
+                       joint_indices, _job.joint_indices_stride); \
   in_positions = NEXT(const float*, in_positions, _job.in_positions_stride); \
   out_positions = NEXT(float*, out_positions, _job.out_positions_stride);
 
@@ -250,7 +336,7 @@ bool SkinningJob::Validate() const {
 // _OUTER functions restrict access to data that are sure to be readable from
 // the buffer.
 #define PREPARE_1_INNER(_it) \
-  const uint16_t i0 = joint_indices[0]; \
+  const int i0 = joint_indices[0]; \
   const math::Float4x4& transform = _job.joint_matrices[i0]; \
   PREPARE_##_it##_1()
 
@@ -268,9 +354,9 @@ bool SkinningJob::Validate() const {
   const math::Float4x4& it_transform = _job.joint_inverse_transpose_matrices[i0];
 
 #define PREPARE_2_INNER(_it) \
-  const math::SimdFloat4 w0 = math::simd_float4::Load1PtrU(joint_weights + 0); \
-  const uint16_t i0 = joint_indices[0]; \
-  const uint16_t i1 = joint_indices[1]; \
+  const math::SimdFloat4 w0 = _Weights::Load1(joint_weights + 0); \
+  const int i0 = joint_indices[0]; \
+  const int i1 = joint_indices[1]; \
   const math::Float4x4& m0 = _job.joint_matrices[i0]; \
   const math::Float4x4& m1 = _job.joint_matrices[i1]; \
   const math::SimdFloat4 w1 = one - w0; \
@@ -291,9 +377,9 @@ bool SkinningJob::Validate() const {
   PREPARE_2_INNER(_it)
 
 #define PREPARE_3_CONCAT(_it) \
-  const uint16_t i0 = joint_indices[0]; \
-  const uint16_t i1 = joint_indices[1]; \
-  const uint16_t i2 = joint_indices[2]; \
+  const int i0 = joint_indices[0]; \
+  const int i1 = joint_indices[1]; \
+  const int i2 = joint_indices[2]; \
   const math::Float4x4& m0 = _job.joint_matrices[i0]; \
   const math::Float4x4& m1 = _job.joint_matrices[i1]; \
   const math::Float4x4& m2 = _job.joint_matrices[i2]; \
@@ -315,21 +401,21 @@ bool SkinningJob::Validate() const {
                                       math::ColumnMultiply(mit2, w2); \
 
 #define PREPARE_3_INNER(_it) \
-  const math::SimdFloat4 w = math::simd_float4::LoadPtrU(joint_weights); \
+  const math::SimdFloat4 w = _Weights::Load(joint_weights); \
   const math::SimdFloat4 w0 = math::SplatX(w); \
   const math::SimdFloat4 w1 = math::SplatY(w); \
   PREPARE_3_CONCAT(_it)
 
 #define PREPARE_3_OUTER(_it) \
-  const math::SimdFloat4 w0 = math::simd_float4::Load1PtrU(joint_weights + 0); \
-  const math::SimdFloat4 w1 = math::simd_float4::Load1PtrU(joint_weights + 1); \
+  const math::SimdFloat4 w0 = _Weights::Load1(joint_weights + 0); \
+  const math::SimdFloat4 w1 = _Weights::Load1(joint_weights + 1); \
   PREPARE_3_CONCAT(_it)
 
 #define PREPARE_4_CONCAT(_it) \
-  const uint16_t i0 = joint_indices[0]; \
-  const uint16_t i1 = joint_indices[1]; \
-  const uint16_t i2 = joint_indices[2]; \
-  const uint16_t i3 = joint_indices[3]; \
+  const int i0 = joint_indices[0]; \
+  const int i1 = joint_indices[1]; \
+  const int i2 = joint_indices[2]; \
+  const int i3 = joint_indices[3]; \
   const math::Float4x4& m0 = _job.joint_matrices[i0]; \
   const math::Float4x4& m1 = _job.joint_matrices[i1]; \
   const math::Float4x4& m2 = _job.joint_matrices[i2]; \
@@ -355,25 +441,25 @@ bool SkinningJob::Validate() const {
                                       math::ColumnMultiply(mit3, w3); \
 
 #define PREPARE_4_INNER(_it) \
-  const math::SimdFloat4 w = math::simd_float4::LoadPtrU(joint_weights); \
+  const math::SimdFloat4 w = _Weights::Load(joint_weights); \
   const math::SimdFloat4 w0 = math::SplatX(w); \
   const math::SimdFloat4 w1 = math::SplatY(w); \
   const math::SimdFloat4 w2 = math::SplatZ(w); \
   PREPARE_4_CONCAT(_it)
 
 #define PREPARE_4_OUTER(_it) \
-  const math::SimdFloat4 w0 = math::simd_float4::Load1PtrU(joint_weights + 0); \
-  const math::SimdFloat4 w1 = math::simd_float4::Load1PtrU(joint_weights + 1); \
-  const math::SimdFloat4 w2 = math::simd_float4::Load1PtrU(joint_weights + 2); \
+  const math::SimdFloat4 w0 = _Weights::Load1(joint_weights + 0); \
+  const math::SimdFloat4 w1 = _Weights::Load1(joint_weights + 1); \
+  const math::SimdFloat4 w2 = _Weights::Load1(joint_weights + 2); \
   PREPARE_4_CONCAT(_it)
 
 #define PREPARE_NOIT_N() \
-  math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(joint_weights + 0); \
+  math::SimdFloat4 wsum = _Weights::Load1(joint_weights + 0); \
   math::Float4x4 transform = \
     math::ColumnMultiply(_job.joint_matrices[joint_indices[0]], wsum); \
   const int last = _job.influences_count - 1; \
   for (int j = 1; j < last; ++j) { \
-    const math::SimdFloat4 w = math::simd_float4::Load1PtrU(joint_weights + j); \
+    const math::SimdFloat4 w = _Weights::Load1(joint_weights + j); \
     wsum = wsum + w; \
     transform = transform + \
       math::ColumnMultiply(_job.joint_matrices[joint_indices[j]], w); \
@@ -383,16 +469,16 @@ bool SkinningJob::Validate() const {
   PREPARE_NOIT()
 
 #define PREPARE_IT_N() \
-  math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(joint_weights + 0); \
-  const uint16_t i0 = joint_indices[0]; \
+  math::SimdFloat4 wsum = _Weights::Load1(joint_weights + 0); \
+  const int i0 = joint_indices[0]; \
   math::Float4x4 transform = \
     math::ColumnMultiply(_job.joint_matrices[i0], wsum); \
   math::Float4x4 it_transform = \
     math::ColumnMultiply(_job.joint_inverse_transpose_matrices[i0], wsum); \
   const int last = _job.influences_count - 1; \
   for (int j = 1; j < last; ++j) { \
-    const uint16_t ij = joint_indices[j]; \
-    const math::SimdFloat4 w = math::simd_float4::Load1PtrU(joint_weights + j); \
+    const int ij = joint_indices[j]; \
+    const math::SimdFloat4 w = _Weights::Load1(joint_weights + j); \
     wsum = wsum + w; \
     transform = transform + \
       math::ColumnMultiply(_job.joint_matrices[ij], w); \
@@ -475,26 +561,71 @@ SKINNING_FN(PNT, NOIT, N)
 SKINNING_FN(PN, IT, N)
 SKINNING_FN(PNT, IT, N)
 
-// Defines a matrix of skinning function pointers. This matrix will then be
-// indexed according to skinning jobs parameters.
+// Defines a matrix of skinning function pointers, for every indices and weights
+// formats. This matrix will then be indexed according to skinning jobs
+// parameters.
 typedef void (*SkiningFct)(const SkinningJob&);
-static const SkiningFct kSkinningFct[2][5][3] = {
+template <typename _Indices, typename _Weights>
+struct SkinningFcts {
+  static const SkiningFct kFct[2][5][3];
+};
+
+#define SKINNING_FN_PTR(_type, _it, _inf) \
+  &SKINNING_FN_NAME(_type, _it, _inf)<_Indices, _Weights>
+
+template <typename _Indices, typename _Weights>
+const SkiningFct SkinningFcts<_Indices, _Weights>::kFct[2][5][3] = {
   {
-    {&SKINNING_FN_NAME(P, NOIT, 1), &SKINNING_FN_NAME(PN, NOIT, 1), &SKINNING_FN_NAME(PNT, NOIT, 1)},
-    {&SKINNING_FN_NAME(P, NOIT, 2), &SKINNING_FN_NAME(PN, NOIT, 2), &SKINNING_FN_NAME(PNT, NOIT, 2)},
-    {&SKINNING_FN_NAME(P, NOIT, 3), &SKINNING_FN_NAME(PN, NOIT, 3), &SKINNING_FN_NAME(PNT, NOIT, 3)},
-    {&SKINNING_FN_NAME(P, NOIT, 4), &SKINNING_FN_NAME(PN, NOIT, 4), &SKINNING_FN_NAME(PNT, NOIT, 4)},
-    {&SKINNING_FN_NAME(P, NOIT, N), &SKINNING_FN_NAME(PN, NOIT, N), &SKINNING_FN_NAME(PNT, NOIT, N)},
+    {SKINNING_FN_PTR(P, NOIT, 1),
+     SKINNING_FN_PTR(PN, NOIT, 1),
+     SKINNING_FN_PTR(PNT, NOIT, 1)},
+    {SKINNING_FN_PTR(P, NOIT, 2),
+     SKINNING_FN_PTR(PN, NOIT, 2),
+     SKINNING_FN_PTR(PNT, NOIT, 2)},
+    {SKINNING_FN_PTR(P, NOIT, 3),
+     SKINNING_FN_PTR(PN, NOIT, 3),
+     SKINNING_FN_PTR(PNT, NOIT, 3)},
+    {SKINNING_FN_PTR(P, NOIT, 4),
+     SKINNING_FN_PTR(PN, NOIT, 4),
+     SKINNING_FN_PTR(PNT, NOIT, 4)},
+    {SKINNING_FN_PTR(P, NOIT, N),
+     SKINNING_FN_PTR(PN, NOIT, N),
+     SKINNING_FN_PTR(PNT, NOIT, N)},
   },
   {
-    {&SKINNING_FN_NAME(P, NOIT, 1), &SKINNING_FN_NAME(PN, IT, 1), &SKINNING_FN_NAME(PNT, IT, 1)},
-    {&SKINNING_FN_NAME(P, NOIT, 2), &SKINNING_FN_NAME(PN, IT, 2), &SKINNING_FN_NAME(PNT, IT, 2)},
-    {&SKINNING_FN_NAME(P, NOIT, 3), &SKINNING_FN_NAME(PN, IT, 3), &SKINNING_FN_NAME(PNT, IT, 3)},
-    {&SKINNING_FN_NAME(P, NOIT, 4), &SKINNING_FN_NAME(PN, IT, 4), &SKINNING_FN_NAME(PNT, IT, 4)},
-    {&SKINNING_FN_NAME(P, NOIT, N), &SKINNING_FN_NAME(PN, IT, N), &SKINNING_FN_NAME(PNT, IT, N)},
+    {SKINNING_FN_PTR(P, NOIT, 1),
+     SKINNING_FN_PTR(PN, IT, 1),
+     SKINNING_FN_PTR(PNT, IT, 1)},
+    {SKINNING_FN_PTR(P, NOIT, 2),
+     SKINNING_FN_PTR(PN, IT, 2),
+     SKINNING_FN_PTR(PNT, IT, 2)},
+    {SKINNING_FN_PTR(P, NOIT, 3),
+     SKINNING_FN_PTR(PN, IT, 3),
+     SKINNING_FN_PTR(PNT, IT, 3)},
+    {SKINNING_FN_PTR(P, NOIT, 4),
+     SKINNING_FN_PTR(PN, IT, 4),
+     SKINNING_FN_PTR(PNT, IT, 4)},
+    {SKINNING_FN_PTR(P, NOIT, N),
+     SKINNING_FN_PTR(PN, IT, N),
+     SKINNING_FN_PTR(PNT, IT, N)},
   }
 };
 
+#undef SKINNING_FN_PTR
+
+// Selects the skinning function matrix that matches job's indices and weights
+// formats.
+template <typename _Indices>
+static const SkiningFct (*SelectFcts(const SkinningJob& _job))[5][3] {
+  if (_job.joint_weights16.begin != NULL) {
+    return SkinningFcts<_Indices, WeightsUNorm16>::kFct;
+  } else if (_job.joint_weights8.begin != NULL) {
+    return SkinningFcts<_Indices, WeightsUNorm8>::kFct;
+  }
+  // Default to float weights, also used when there's a single influence.
+  return SkinningFcts<_Indices, WeightsFloat>::kFct;
+}
+
 // Implements job Run function.
 bool SkinningJob::Run() const {
   // Exit with an error if job is invalid.
@@ -508,18 +639,22 @@ bool SkinningJob::Run() const {
     return true;
   }
 
+  // Find skinning function matrix, according to indices and weights formats.
+  const SkiningFct (*fcts)[5][3] = joint_indices8.begin != NULL ?
+    SelectFcts<Indices8>(*this) : SelectFcts<Indices16>(*this);
+
   // Find skinning function index.
   const size_t it = joint_inverse_transpose_matrices.begin != NULL;
-  assert(it < OZZ_ARRAY_SIZE(kSkinningFct));
+  assert(it < 2);
   const size_t inf =
-    static_cast<size_t>(influences_count) > OZZ_ARRAY_SIZE(kSkinningFct[0]) ?
-      OZZ_ARRAY_SIZE(kSkinningFct[0]) -1 : influences_count - 1;
-  assert(inf < OZZ_ARRAY_SIZE(kSkinningFct[0]));
+    static_cast<size_t>(influences_count) > OZZ_ARRAY_SIZE(fcts[0]) ?
+      OZZ_ARRAY_SIZE(fcts[0]) -1 : influences_count - 1;
+  assert(inf < OZZ_ARRAY_SIZE(fcts[0]));
   const size_t fct = (in_normals.begin != NULL) + (in_tangents.begin != NULL);
-  assert(fct < OZZ_ARRAY_SIZE(kSkinningFct[0][0]));
+  assert(fct < OZZ_ARRAY_SIZE(fcts[0][0]));
 
   // Calls skinning function. Cannot fail because job is valid.
-  kSkinningFct[it][inf][fct](*this);
+  fcts[it][inf][fct](*this);
 
   return true;
 }
@@ -0,0 +1,492 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/soa_skinning_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_wide.h"
+
+namespace ozz {
+namespace geometry {
+
+SoaSkinningJob::SoaSkinningJob()
+ : vertex_count(0),
+   influences_count(0) {
+}
+
+bool SoaSkinningJob::Validate() const {
+
+  // Start validation of all parameters.
+  bool valid = true;
+
+  // Checks vertex and influences bounds.
+  valid &= vertex_count >= 0;
+  valid &= influences_count > 0;
+
+  // Checks joints matrices, required.
+  valid &= joint_matrices.begin != NULL;
+  valid &= joint_matrices.end >= joint_matrices.begin;
+
+  // Checks optional inverse transpose matrices.
+  valid &= joint_inverse_transpose_matrices.end >=
+           joint_inverse_transpose_matrices.begin;
+
+  const size_t packets = static_cast<size_t>((vertex_count + 3) / 4);
+
+  // Checks indices, required.
+  valid &= joint_indices.begin != NULL;
+  valid &= joint_indices.Count() >= packets * influences_count * 4;
+
+  // Checks weights, required if influences_count > 1.
+  if (influences_count > 1) {
+    valid &= joint_weights.begin != NULL;
+    valid &= math::IsAligned(joint_weights.begin, 16);
+    valid &= joint_weights.Count() >= packets * (influences_count - 1) * 4;
+  }
+
+  // Checks positions, mandatory.
+  valid &= in_positions.begin != NULL;
+  valid &= in_positions.Count() >= packets;
+  valid &= out_positions.begin != NULL;
+  valid &= out_positions.Count() >= packets;
+
+  // Checks normals, optional.
+  if (in_normals.begin) {
+    valid &= in_normals.Count() >= packets;
+    valid &= out_normals.begin != NULL;
+    valid &= out_normals.Count() >= packets;
+
+    // Checks tangents, optional but requires normals.
+    if (in_tangents.begin) {
+      valid &= in_tangents.Count() >= packets;
+      valid &= out_tangents.begin != NULL;
+      valid &= out_tangents.Count() >= packets;
+    }
+  } else {
+    // Tangents are not supported if normals are not there.
+    valid &= in_tangents.begin == NULL;
+    valid &= in_tangents.end == NULL;
+  }
+
+  return valid;
+}
+
+namespace {
+
+// Soa affine matrix, made of the x, y and z components of the 4 columns, with
+// _Lanes::Simd components. It's templated on lanes traits rather than on simd
+// types, as simd types attributes would be ignored as template arguments.
+template <typename _Lanes>
+struct SoaAffine {
+  typename _Lanes::Simd cols[4][3];
+};
+
+// Defines the 4 lanes packet traits, which processes a single packet per loop.
+struct Lanes4 {
+  typedef math::SimdFloat4 Simd;
+  typedef math::SoaFloat3 Float3;
+  enum { kPackets = 1 };
+
+  static OZZ_INLINE Simd one() {
+    return math::simd_float4::one();
+  }
+
+  // Gathers the 4 joint matrices of a packet referenced by _indices, and
+  // transposes them to a soa affine matrix. _next is the number of indices
+  // from a packet to the next, unused here.
+  static OZZ_INLINE void Gather(const math::Float4x4* _matrices,
+                                const uint16_t* _indices,
+                                int _next,
+                                SoaAffine<Lanes4>* _out) {
+    (void)_next;
+    const math::Float4x4& m0 = _matrices[_indices[0]];
+    const math::Float4x4& m1 = _matrices[_indices[1]];
+    const math::Float4x4& m2 = _matrices[_indices[2]];
+    const math::Float4x4& m3 = _matrices[_indices[3]];
+    for (int i = 0; i < 4; ++i) {
+      const math::SimdFloat4 cols[4] = {
+        m0.cols[i], m1.cols[i], m2.cols[i], m3.cols[i]};
+      math::Transpose4x3(cols, _out->cols[i]);
+    }
+  }
+
+  // Loads the 4 weights of an influence. _next is the number of weights from
+  // a packet to the next, unused here.
+  static OZZ_INLINE Simd LoadWeight(const float* _weights, int _next) {
+    (void)_next;
+    return math::simd_float4::LoadPtr(_weights);
+  }
+
+  static OZZ_INLINE Float3 Load(const math::SoaFloat3* _in) {
+    return *_in;
+  }
+
+  static OZZ_INLINE void Store(const Float3& _v, math::SoaFloat3* _out) {
+    *_out = _v;
+  }
+};
+
+// Defines the 8 lanes packet traits, which processes two packets per loop.
+struct Lanes8 {
+  typedef math::SimdFloat8 Simd;
+  typedef math::WideSoaFloat3 Float3;
+  enum { kPackets = 2 };
+
+  static OZZ_INLINE Simd one() {
+    return math::simd_float8::one();
+  }
+
+  static OZZ_INLINE void Gather(const math::Float4x4* _matrices,
+                                const uint16_t* _indices,
+                                int _next,
+                                SoaAffine<Lanes8>* _out) {
+    SoaAffine<Lanes4> lo;
+    SoaAffine<Lanes4> hi;
+    Lanes4::Gather(_matrices, _indices, 0, &lo);
+    Lanes4::Gather(_matrices, _indices + _next, 0, &hi);
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        _out->cols[i][j] = math::simd_float8::Load(lo.cols[i][j],
+                                                   hi.cols[i][j]);
+      }
+    }
+  }
+
+  static OZZ_INLINE Simd LoadWeight(const float* _weights, int _next) {
+    return math::simd_float8::Load(math::simd_float4::LoadPtr(_weights),
+                                   math::simd_float4::LoadPtr(_weights + _next));
+  }
+
+  static OZZ_INLINE Float3 Load(const math::SoaFloat3* _in) {
+    return math::WideSoaFloat3::Load(_in[0], _in[1]);
+  }
+
+  static OZZ_INLINE void Store(const Float3& _v, math::SoaFloat3* _out) {
+    _out[0] = math::GetLow(_v);
+    _out[1] = math::GetHigh(_v);
+  }
+};
+
+// Computes the weighted soa matrix of a packet, from the _job.influences_count
+// joint matrices of _matrices palette.
+template <typename _Lanes, int _Influences>
+OZZ_INLINE void WeightPacket(const SoaSkinningJob& _job,
+                             const math::Float4x4* _matrices,
+                             const uint16_t* _indices,
+                             const float* _weights,
+                             SoaAffine<_Lanes>* _out) {
+  typedef typename _Lanes::Simd Simd;
+  const int influences = _Influences ? _Influences : _job.influences_count;
+  const int last = influences - 1;
+  const int next_indices = influences * 4;
+  const int next_weights = last * 4;
+
+  // A single influence has an implicit weight of 1.
+  if (influences == 1) {
+    _Lanes::Gather(_matrices, _indices, next_indices, _out);
+    return;
+  }
+
+  // Accumulates weighted matrices. The weight of the last influence is
+  // restored from the sum of the others.
+  Simd wsum = _Lanes::LoadWeight(_weights, next_weights);
+  SoaAffine<_Lanes> m;
+  _Lanes::Gather(_matrices, _indices, next_indices, &m);
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      _out->cols[i][j] = m.cols[i][j] * wsum;
+    }
+  }
+  for (int k = 1; k < influences; ++k) {
+    Simd w;
+    if (k < last) {
+      w = _Lanes::LoadWeight(_weights + k * 4, next_weights);
+      wsum = wsum + w;
+    } else {
+      w = _Lanes::one() - wsum;
+    }
+    _Lanes::Gather(_matrices, _indices + k * 4, next_indices, &m);
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        _out->cols[i][j] = math::MAdd(m.cols[i][j], w, _out->cols[i][j]);
+      }
+    }
+  }
+}
+
+// Transforms soa point _p by soa matrix _m.
+template <typename _Lanes>
+OZZ_INLINE typename _Lanes::Float3 TransformPoint(
+  const SoaAffine<_Lanes>& _m, const typename _Lanes::Float3& _p) {
+  const typename _Lanes::Float3 r = {
+    math::MAdd(_m.cols[0][0], _p.x,
+               math::MAdd(_m.cols[1][0], _p.y,
+                          math::MAdd(_m.cols[2][0], _p.z, _m.cols[3][0]))),
+    math::MAdd(_m.cols[0][1], _p.x,
+               math::MAdd(_m.cols[1][1], _p.y,
+                          math::MAdd(_m.cols[2][1], _p.z, _m.cols[3][1]))),
+    math::MAdd(_m.cols[0][2], _p.x,
+               math::MAdd(_m.cols[1][2], _p.y,
+                          math::MAdd(_m.cols[2][2], _p.z, _m.cols[3][2])))};
+  return r;
+}
+
+// Transforms soa vector _v by soa matrix _m.
+template <typename _Lanes>
+OZZ_INLINE typename _Lanes::Float3 TransformVector(
+  const SoaAffine<_Lanes>& _m, const typename _Lanes::Float3& _v) {
+  const typename _Lanes::Float3 r = {
+    math::MAdd(_m.cols[0][0], _v.x,
+               math::MAdd(_m.cols[1][0], _v.y, _m.cols[2][0] * _v.z)),
+    math::MAdd(_m.cols[0][1], _v.x,
+               math::MAdd(_m.cols[1][1], _v.y, _m.cols[2][1] * _v.z)),
+    math::MAdd(_m.cols[0][2], _v.x,
+               math::MAdd(_m.cols[1][2], _v.y, _m.cols[2][2] * _v.z))};
+  return r;
+}
+
+// Skins packets [_begin, _end[, _Lanes::kPackets at a time. _end - _begin
+// must be a multiple of _Lanes::kPackets.
+// _Influences is the number of influences, or 0 if it should be read from the
+// job.
+template <typename _Lanes, int _Influences>
+void SkinPackets(const SoaSkinningJob& _job, int _begin, int _end) {
+  typedef typename _Lanes::Float3 Float3;
+  assert((_end - _begin) % _Lanes::kPackets == 0);
+
+  const int influences = _Influences ? _Influences : _job.influences_count;
+  const bool normals = _job.in_normals.begin != NULL;
+  const bool tangents = _job.in_tangents.begin != NULL;
+  const bool it = normals && _job.joint_inverse_transpose_matrices.begin;
+
+  for (int i = _begin; i < _end; i += _Lanes::kPackets) {
+    const uint16_t* indices = _job.joint_indices.begin + i * influences * 4;
+    const float* weights = _job.joint_weights.begin + i * (influences - 1) * 4;
+
+    SoaAffine<_Lanes> transform;
+    WeightPacket<_Lanes, _Influences>(
+      _job, _job.joint_matrices.begin, indices, weights, &transform);
+
+    const Float3 in_p = _Lanes::Load(_job.in_positions.begin + i);
+    _Lanes::Store(TransformPoint(transform, in_p),
+                  _job.out_positions.begin + i);
+    if (!normals) {
+      continue;
+    }
+
+    // Vectors are transformed by inverse transpose matrices if provided.
+    SoaAffine<_Lanes> it_transform;
+    if (it) {
+      WeightPacket<_Lanes, _Influences>(
+        _job, _job.joint_inverse_transpose_matrices.begin, indices, weights,
+        &it_transform);
+    }
+    const SoaAffine<_Lanes>& vector_transform =
+      it ? it_transform : transform;
+
+    const Float3 in_n = _Lanes::Load(_job.in_normals.begin + i);
+    _Lanes::Store(TransformVector(vector_transform, in_n),
+                  _job.out_normals.begin + i);
+    if (tangents) {
+      const Float3 in_t = _Lanes::Load(_job.in_tangents.begin + i);
+      _Lanes::Store(TransformVector(vector_transform, in_t),
+                    _job.out_tangents.begin + i);
+    }
+  }
+}
+
+// Skins all job's packets, by pairs using 8 lanes, then the remaining one
+// using 4 lanes.
+template <int _Influences>
+void SkinAll(const SoaSkinningJob& _job) {
+  const int packets = (_job.vertex_count + 3) / 4;
+  const int pairs = packets & ~1;
+  SkinPackets<Lanes8, _Influences>(_job, 0, pairs);
+  SkinPackets<Lanes4, _Influences>(_job, pairs, packets);
+}
+
+// Defines skinning functions for 1 to 4 influences, and any number of
+// influences.
+typedef void (*SoaSkinningFct)(const SoaSkinningJob&);
+const SoaSkinningFct kSoaSkinningFct[] = {
+  &SkinAll<1>, &SkinAll<2>, &SkinAll<3>, &SkinAll<4>, &SkinAll<0>};
+}  // namespace
+
+bool SoaSkinningJob::Run() const {
+  // Exit with an error if job is invalid.
+  if (!Validate()) {
+    return false;
+  }
+
+  // Finds skinning function index.
+  const size_t inf =
+    static_cast<size_t>(influences_count) > OZZ_ARRAY_SIZE(kSoaSkinningFct) ?
+      OZZ_ARRAY_SIZE(kSoaSkinningFct) - 1 : influences_count - 1;
+  assert(inf < OZZ_ARRAY_SIZE(kSoaSkinningFct));
+
+  // Calls skinning function. Cannot fail because job is valid.
+  kSoaSkinningFct[inf](*this);
+
+  return true;
+}
+
+bool PackSoaVertices(Range<const float> _in,
+                     size_t _in_stride,
+                     int _count,
+                     Range<math::SoaFloat3> _out) {
+  if (_count < 0) {
+    return false;
+  }
+  const size_t packets = static_cast<size_t>((_count + 3) / 4);
+  if (_out.Count() < packets) {
+    return false;
+  }
+  if (_count == 0) {
+    return true;
+  }
+  if (!_in.begin ||
+      _in.Size() < _in_stride * (_count - 1) + sizeof(float) * 3) {
+    return false;
+  }
+
+  for (size_t i = 0; i < packets; ++i) {
+    float soa[3][4];
+    for (int j = 0; j < 4; ++j) {
+      // Pads with the last vertex.
+      const int vertex = math::Min(static_cast<int>(i * 4 + j), _count - 1);
+      const float* in = reinterpret_cast<const float*>(
+        reinterpret_cast<uintptr_t>(_in.begin) + vertex * _in_stride);
+      soa[0][j] = in[0];
+      soa[1][j] = in[1];
+      soa[2][j] = in[2];
+    }
+    const math::SoaFloat3 packet = {math::simd_float4::LoadPtrU(soa[0]),
+                                    math::simd_float4::LoadPtrU(soa[1]),
+                                    math::simd_float4::LoadPtrU(soa[2])};
+    _out[i] = packet;
+  }
+  return true;
+}
+
+bool UnpackSoaVertices(Range<const math::SoaFloat3> _in,
+                       int _count,
+                       Range<float> _out,
+                       size_t _out_stride) {
+  if (_count < 0) {
+    return false;
+  }
+  const size_t packets = static_cast<size_t>((_count + 3) / 4);
+  if (_in.Count() < packets) {
+    return false;
+  }
+  if (_count == 0) {
+    return true;
+  }
+  if (!_out.begin ||
+      _out.Size() < _out_stride * (_count - 1) + sizeof(float) * 3) {
+    return false;
+  }
+
+  for (size_t i = 0; i < packets; ++i) {
+    float soa[3][4];
+    math::StorePtrU(_in[i].x, soa[0]);
+    math::StorePtrU(_in[i].y, soa[1]);
+    math::StorePtrU(_in[i].z, soa[2]);
+    const int count = math::Min(4, static_cast<int>(_count - i * 4));
+    for (int j = 0; j < count; ++j) {
+      float* out = reinterpret_cast<float*>(
+        reinterpret_cast<uintptr_t>(_out.begin) + (i * 4 + j) * _out_stride);
+      out[0] = soa[0][j];
+      out[1] = soa[1][j];
+      out[2] = soa[2][j];
+    }
+  }
+  return true;
+}
+
+bool PackSoaInfluences(int _count,
+                       int _influences_count,
+                       Range<const uint16_t> _indices,
+                       size_t _indices_stride,
+                       Range<const float> _weights,
+                       size_t _weights_stride,
+                       Range<uint16_t> _out_indices,
+                       Range<float> _out_weights) {
+  if (_count < 0 || _influences_count <= 0) {
+    return false;
+  }
+  const size_t packets = static_cast<size_t>((_count + 3) / 4);
+  const int last = _influences_count - 1;
+  if (_out_indices.Count() < packets * _influences_count * 4 ||
+      _out_weights.Count() < packets * last * 4) {
+    return false;
+  }
+  if (_count == 0) {
+    return true;
+  }
+  if (!_indices.begin ||
+      _indices.Size() < _indices_stride * (_count - 1) +
+                        sizeof(uint16_t) * _influences_count) {
+    return false;
+  }
+  if (last > 0 &&
+      (!_weights.begin ||
+       _weights.Size() < _weights_stride * (_count - 1) +
+                         sizeof(float) * last)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < packets; ++i) {
+    uint16_t* out_indices = _out_indices.begin + i * _influences_count * 4;
+    float* out_weights = _out_weights.begin + i * last * 4;
+    for (int j = 0; j < 4; ++j) {
+      // Pads with the last vertex.
+      const int vertex = math::Min(static_cast<int>(i * 4 + j), _count - 1);
+      const uint16_t* indices = reinterpret_cast<const uint16_t*>(
+        reinterpret_cast<uintptr_t>(_indices.begin) +
+          vertex * _indices_stride);
+      for (int k = 0; k < _influences_count; ++k) {
+        out_indices[k * 4 + j] = indices[k];
+      }
+    }
+    for (int j = 0; j < 4; ++j) {
+      const int vertex = math::Min(static_cast<int>(i * 4 + j), _count - 1);
+      const float* weights = reinterpret_cast<const float*>(
+        reinterpret_cast<uintptr_t>(_weights.begin) + vertex * _weights_stride);
+      for (int k = 0; k < last; ++k) {
+        out_weights[k * 4 + j] = weights[k];
+      }
+    }
+  }
+  return true;
+}
+}  // geometry
+}  // ozz
@@ -120,6 +120,27 @@ struct RotationKey {
   int16_t value[3];  // The quantized value of the 3 smallest components.
 };
 
+// Defines the packed rotation key frame type, an alternative to RotationKey
+// that requires 8 bytes per key instead of 12. It's selected per animation,
+// see Animation::RotationFormat.
+// Time is quantized on 16 bits, as a ratio of the animation duration (see
+// kQuantizedTimeMax). The 3 smallest components of the quaternion are quantized
+// to 11, 11 and 10 bits, packed in a single 32 bits value: bits [0:10] store
+// the first component, bits [11:21] the second and bits [22:31] the third.
+// Each component c, in range [-1/sqrt(2):1/sqrt(2)], is stored as the unsigned
+// integer round((c * sqrt(2) + 1) / 2 * (2^n - 1)), n being the number of bits.
+// Quantization error is then bounded to sqrt(2) / (2 * (2^n - 1)) per
+// component, that is 3.5e-4 for 11 bits components and 6.9e-4 for 10 bits
+// ones. Time quantization error is bounded to
+// duration / (2 * kQuantizedTimeMax).
+struct PackedRotationKey {
+  uint16_t time;  // Quantized time, as a ratio of the animation duration.
+  uint16_t track:13;  // The track this key frame belongs to.
+  uint16_t largest:2;  // The largest component of the quaternion.
+  uint16_t sign:1;  // The sign of the largest component. 1 for negative.
+  uint32_t value;  // The quantized value of the 3 smallest components.
+};
+
 // Defines the scale key frame type.
 // Scale values are stored as half precision floats with 16 bits per
 // component.
@@ -128,6 +149,57 @@ struct ScaleKey {
   uint16_t track;
   uint16_t value[3];
 };
+
+// Defines quantized time variants of translation, rotation and scale key frame
+// types, which require 10 bytes per key instead of 12. They are selected per
+// animation, see Animation::TimeFormat.
+// Time is quantized on 16 bits, as a ratio of the animation duration (see
+// kQuantizedTimeMax), with an error bounded to
+// duration / (2 * kQuantizedTimeMax). Values are stored the same way as
+// their float time counterparts.
+struct QuantizedTranslationKey {
+  uint16_t time;  // Quantized time, as a ratio of the animation duration.
+  uint16_t track;
+  uint16_t value[3];
+};
+
+struct QuantizedRotationKey {
+  uint16_t time;  // Quantized time, as a ratio of the animation duration.
+  uint16_t track:13;  // The track this key frame belongs to.
+  uint16_t largest:2;  // The largest component of the quaternion.
+  uint16_t sign:1;  // The sign of the largest component. 1 for negative.
+  int16_t value[3];  // The quantized value of the 3 smallest components.
+};
+
+struct QuantizedScaleKey {
+  uint16_t time;  // Quantized time, as a ratio of the animation duration.
+  uint16_t track;
+  uint16_t value[3];
+};
+
+// Defines constant track types. A track whose value never changes is stored
+// once as a constant, rather than as key frames (see
+// Animation::constant_translations()). Constant values are compressed the same
+// way as key frame values, track member being the joint index.
+struct ConstantTranslation {
+  uint16_t track;
+  uint16_t value[3];
+};
+
+struct ConstantRotation {
+  uint16_t track:13;  // The joint this constant belongs to.
+  uint16_t largest:2;  // The largest component of the quaternion.
+  uint16_t sign:1;  // The sign of the largest component. 1 for negative.
+  int16_t value[3];  // The quantized value of the 3 smallest components.
+};
+
+struct ConstantScale {
+  uint16_t track;
+  uint16_t value[3];
+};
+
+// Maximum value of a quantized time, matching animation duration.
+const float kQuantizedTimeMax = 65535.f;
 }  // animation
 }  // ozz
 #endif  // OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
@@ -136,71 +208,677 @@ struct ScaleKey {
 namespace ozz {
 namespace animation {
 
+namespace {
+// Computes the number of seek points required for a buffer of _count keys.
+// Seek points are located every _interval keys, after the first 2 keys of
+// every track.
+size_t CountSeekPoints(size_t _count, int _num_tracks, int _interval) {
+  const size_t first = static_cast<size_t>(_num_tracks) * 2;
+  if (_interval == 0 || _count <= first) {
+    return 0;
+  }
+  return (_count - first) / _interval;
+}
+
+// Gets the number of tracks stored in a key frames buffer, which is the number
+// of animated tracks, ie: joints minus constant tracks, rounded up to soa size.
+int CountKeyTracks(int _num_soa_tracks, size_t _constant_count) {
+  const int animated = _num_soa_tracks * 4 - static_cast<int>(_constant_count);
+  return (animated + 3) & ~3;
+}
+
+// Computes the size of the seek table of a buffer of _count keys storing
+// _num_tracks tracks.
+size_t ComputeSeekTableSize(size_t _count, int _num_tracks) {
+  const int interval = _num_tracks * Animation::kSeekInterval;
+  const size_t num_points = CountSeekPoints(_count, _num_tracks, interval);
+  return num_points * (sizeof(int) * _num_tracks * 2 + sizeof(float));
+}
+
+// Allocates seek table _table from _buffer, for a buffer of _count keys
+// storing _num_tracks tracks.
+char* AllocateSeekTable(char* _buffer, size_t _count, int _num_tracks,
+                        SeekTable* _table) {
+  _table->interval = _num_tracks * Animation::kSeekInterval;
+  const size_t num_points =
+    CountSeekPoints(_count, _num_tracks, _table->interval);
+  _table->keys.begin = reinterpret_cast<int*>(_buffer);
+  assert(math::IsAligned(_table->keys.begin, OZZ_ALIGN_OF(int)));
+  _buffer += num_points * _num_tracks * 2 * sizeof(int);
+  _table->keys.end = reinterpret_cast<int*>(_buffer);
+
+  _table->times.begin = reinterpret_cast<float*>(_buffer);
+  assert(math::IsAligned(_table->times.begin, OZZ_ALIGN_OF(float)));
+  _buffer += num_points * sizeof(float);
+  _table->times.end = reinterpret_cast<float*>(_buffer);
+  return _buffer;
+}
+
+// Fills seek table _table by walking _keys the same way the SamplingJob does,
+// and taking a snapshot of every track left and right keys every
+// _table->interval keys.
+template<typename _Key>
+void FillSeekTable(ozz::Range<const _Key> _keys, int _num_tracks,
+                   SeekTable* _table) {
+  const int interval = _table->interval;
+  const int num_points = static_cast<int>(_table->times.Count());
+  const int* prev = NULL;
+  int cursor = _num_tracks * 2;
+  for (int i = 0; i < num_points; ++i) {
+    int* state = _table->keys.begin + i * _num_tracks * 2;
+    if (prev) {
+      std::memcpy(state, prev, sizeof(int) * _num_tracks * 2);
+    } else {
+      // The first 2 key frames of every track are sorted first.
+      for (int j = 0; j < _num_tracks; ++j) {
+        state[j * 2 + 0] = j;
+        state[j * 2 + 1] = _num_tracks + j;
+      }
+    }
+    for (const int end = cursor + interval; cursor < end; ++cursor) {
+      const int base = _keys.begin[cursor].track * 2;
+      state[base] = state[base + 1];
+      state[base + 1] = cursor;
+    }
+    // The seek point is valid as soon as the previous key of the last
+    // processed key is reached.
+    const int last = _keys.begin[cursor - 1].track * 2;
+    _table->times.begin[i] = _keys.begin[state[last]].time;
+    prev = state;
+  }
+}
+
+// Keys are serialized by chunks of kKeyChunkSize keys, so that they can be
+// converted from/to their archive layout with a single stream access per
+// chunk.
+const size_t kKeyChunkSize = 256;
+
+// Translation and scale keys archive layout (time, track and 3 values, all
+// written with their native size) matches their memory layout, so they can be
+// read/written with a single stream access.
+OZZ_STATIC_ASSERT(sizeof(TranslationKey) == 12 && sizeof(ScaleKey) == 12);
+OZZ_STATIC_ASSERT(sizeof(QuantizedTranslationKey) == 10 &&
+                  sizeof(QuantizedScaleKey) == 10);
+
+// Swaps the endianness of _count translation or scale keys stored in _keys, in
+// a single pass over memory. Every key is processed as three 32 bits words: the
+// time, whose 4 bytes are reversed, then the track and the 3 values, whose
+// bytes are swapped by pairs (two 16 bits values per word).
+void SwapBulkKeys(char* _keys, size_t _count) {
+  for (size_t i = 0; i < _count; ++i) {
+    char* key = _keys + i * 12;
+    uint32_t time, track_value0, value12;
+    std::memcpy(&time, key + 0, 4);
+    std::memcpy(&track_value0, key + 4, 4);
+    std::memcpy(&value12, key + 8, 4);
+    time = (time >> 24) | ((time >> 8) & 0x0000ff00) |
+           ((time << 8) & 0x00ff0000) | (time << 24);
+    track_value0 = ((track_value0 >> 8) & 0x00ff00ff) |
+                   ((track_value0 << 8) & 0xff00ff00);
+    value12 = ((value12 >> 8) & 0x00ff00ff) | ((value12 << 8) & 0xff00ff00);
+    std::memcpy(key + 0, &time, 4);
+    std::memcpy(key + 4, &track_value0, 4);
+    std::memcpy(key + 8, &value12, 4);
+  }
+}
+
+// Swaps the endianness of _count 16 bits values stored in _values. Values are
+// processed by pairs, as 32 bits words, the same way SwapBulkKeys does.
+void Swap16(char* _values, size_t _count) {
+  const size_t pairs = _count / 2;
+  for (size_t i = 0; i < pairs; ++i) {
+    char* pair = _values + i * 4;
+    uint32_t word;
+    std::memcpy(&word, pair, 4);
+    word = ((word >> 8) & 0x00ff00ff) | ((word << 8) & 0xff00ff00);
+    std::memcpy(pair, &word, 4);
+  }
+  if (_count & 1) {
+    char* last = _values + pairs * 4;
+    const char temp = last[0];
+    last[0] = last[1];
+    last[1] = temp;
+  }
+}
+
+// Swaps the endianness of _count quantized time translation or scale keys
+// stored in _keys. All their members are 16 bits values, so bytes are swapped
+// by pairs.
+void SwapQuantizedBulkKeys(char* _keys, size_t _count) {
+  Swap16(_keys, _count * 5);
+}
+
+// Constant translations and scales archive layout matches their memory layout
+// as well, with 4 16 bits values each.
+OZZ_STATIC_ASSERT(sizeof(ConstantTranslation) == 8 &&
+                  sizeof(ConstantScale) == 8);
+
+void SwapConstants(char* _constants, size_t _count) {
+  Swap16(_constants, _count * 4);
+}
+
+template<typename _Key>
+void SaveBulkKeys(io::OArchive& _archive, ozz::Range<const _Key> _keys,
+                  void (*_swap)(char*, size_t)) {
+  if (!_archive.endian_swap()) {
+    _archive.SaveBinary(_keys.begin, _keys.Size());
+    return;
+  }
+  // Keys are swapped in a temporary buffer, as they are const.
+  char buffer[kKeyChunkSize * sizeof(_Key)];
+  for (const _Key* key = _keys.begin; key < _keys.end;) {
+    const size_t count =
+      math::Min(kKeyChunkSize, static_cast<size_t>(_keys.end - key));
+    std::memcpy(buffer, key, count * sizeof(_Key));
+    _swap(buffer, count);
+    _archive.SaveBinary(buffer, count * sizeof(_Key));
+    key += count;
+  }
+}
+
+template<typename _Key>
+void LoadBulkKeys(io::IArchive& _archive, ozz::Range<_Key> _keys,
+                  void (*_swap)(char*, size_t)) {
+  _archive.LoadBinary(_keys.begin, _keys.Size());
+  if (_archive.endian_swap()) {  // Can swap in-place.
+    _swap(reinterpret_cast<char*>(_keys.begin), _keys.Count());
+  }
+}
+
+// Rotation keys archive layout differs from their memory layout, because of
+// track/largest/sign bit fields: time (4 bytes, or 2 bytes for quantized
+// times), track (2 bytes), largest (1 byte), sign (1 byte) and 3 values
+// (3 * 2 bytes). They are converted by chunks of keys.
+const size_t kRotationKeyArchiveSize = 14;
+const size_t kQuantizedRotationKeyArchiveSize = 12;
+OZZ_STATIC_ASSERT(sizeof(bool) == 1);
+
+// Swaps the endianness of _count rotation keys stored with their archive
+// layout in _keys, in a single pass over memory. Largest and sign bytes don't
+// need swapping.
+void SwapRotationKeys(char* _keys, size_t _count) {
+  for (size_t i = 0; i < _count; ++i) {
+    char* key = _keys + i * kRotationKeyArchiveSize;
+    uint32_t time, value01;
+    uint16_t track, value2;
+    std::memcpy(&time, key + 0, 4);
+    std::memcpy(&track, key + 4, 2);
+    std::memcpy(&value01, key + 8, 4);
+    std::memcpy(&value2, key + 12, 2);
+    time = (time >> 24) | ((time >> 8) & 0x0000ff00) |
+           ((time << 8) & 0x00ff0000) | (time << 24);
+    track = static_cast<uint16_t>((track >> 8) | (track << 8));
+    value01 = ((value01 >> 8) & 0x00ff00ff) | ((value01 << 8) & 0xff00ff00);
+    value2 = static_cast<uint16_t>((value2 >> 8) | (value2 << 8));
+    std::memcpy(key + 0, &time, 4);
+    std::memcpy(key + 4, &track, 2);
+    std::memcpy(key + 8, &value01, 4);
+    std::memcpy(key + 12, &value2, 2);
+  }
+}
+
+// Quantized time rotation keys variant of SwapRotationKeys.
+void SwapQuantizedRotationKeys(char* _keys, size_t _count) {
+  for (size_t i = 0; i < _count; ++i) {
+    char* key = _keys + i * kQuantizedRotationKeyArchiveSize;
+    uint32_t time_track, value01;
+    uint16_t value2;
+    std::memcpy(&time_track, key + 0, 4);
+    std::memcpy(&value01, key + 6, 4);
+    std::memcpy(&value2, key + 10, 2);
+    time_track = ((time_track >> 8) & 0x00ff00ff) |
+                 ((time_track << 8) & 0xff00ff00);
+    value01 = ((value01 >> 8) & 0x00ff00ff) | ((value01 << 8) & 0xff00ff00);
+    value2 = static_cast<uint16_t>((value2 >> 8) | (value2 << 8));
+    std::memcpy(key + 0, &time_track, 4);
+    std::memcpy(key + 6, &value01, 4);
+    std::memcpy(key + 10, &value2, 2);
+  }
+}
+
+// Saves rotation keys of type _Key, which is RotationKey or
+// QuantizedRotationKey. Archive layout only differs by time size.
+template<typename _Key>
+void SaveRotationKeys(io::OArchive& _archive, ozz::Range<const _Key> _keys,
+                      void (*_swap)(char*, size_t)) {
+  const size_t time_size = sizeof(_keys.begin->time);
+  const size_t key_size = time_size + 10;
+  char buffer[kKeyChunkSize * kRotationKeyArchiveSize];
+  for (const _Key* key = _keys.begin; key < _keys.end;) {
+    const size_t count =
+      math::Min(kKeyChunkSize, static_cast<size_t>(_keys.end - key));
+    char* cursor = buffer;
+    for (const _Key* end = key + count; key < end; ++key, cursor += key_size) {
+      const uint16_t track = key->track;
+      std::memcpy(cursor + 0, &key->time, time_size);
+      std::memcpy(cursor + time_size, &track, 2);
+      cursor[time_size + 2] = static_cast<char>(key->largest);
+      cursor[time_size + 3] = static_cast<char>(key->sign);
+      std::memcpy(cursor + time_size + 4, key->value, 6);
+    }
+    if (_archive.endian_swap()) {
+      _swap(buffer, count);
+    }
+    _archive.SaveBinary(buffer, count * key_size);
+  }
+}
+
+template<typename _Key>
+void LoadRotationKeys(io::IArchive& _archive, ozz::Range<_Key> _keys,
+                      void (*_swap)(char*, size_t)) {
+  const size_t time_size = sizeof(_keys.begin->time);
+  const size_t key_size = time_size + 10;
+  char buffer[kKeyChunkSize * kRotationKeyArchiveSize];
+  for (_Key* key = _keys.begin; key < _keys.end;) {
+    const size_t count =
+      math::Min(kKeyChunkSize, static_cast<size_t>(_keys.end - key));
+    _archive.LoadBinary(buffer, count * key_size);
+    if (_archive.endian_swap()) {
+      _swap(buffer, count);
+    }
+    const char* cursor = buffer;
+    for (_Key* end = key + count; key < end; ++key, cursor += key_size) {
+      uint16_t track;
+      std::memcpy(&key->time, cursor + 0, time_size);
+      std::memcpy(&track, cursor + time_size, 2);
+      key->track = track;
+      key->largest = cursor[time_size + 2] & 3;
+      key->sign = cursor[time_size + 3] & 1;
+      std::memcpy(key->value, cursor + time_size + 4, 6);
+    }
+  }
+}
+
+// Packed rotation keys archive layout: time (2 bytes), track (2 bytes),
+// largest (1 byte), sign (1 byte) and packed value (4 bytes).
+const size_t kPackedRotationKeyArchiveSize = 10;
+
+// Swaps the endianness of _count packed rotation keys stored with their archive
+// layout in _keys.
+void SwapPackedRotationKeys(char* _keys, size_t _count) {
+  for (size_t i = 0; i < _count; ++i) {
+    char* key = _keys + i * kPackedRotationKeyArchiveSize;
+    uint32_t time_track, value;
+    std::memcpy(&time_track, key + 0, 4);
+    std::memcpy(&value, key + 6, 4);
+    time_track = ((time_track >> 8) & 0x00ff00ff) |
+                 ((time_track << 8) & 0xff00ff00);
+    value = (value >> 24) | ((value >> 8) & 0x0000ff00) |
+            ((value << 8) & 0x00ff0000) | (value << 24);
+    std::memcpy(key + 0, &time_track, 4);
+    std::memcpy(key + 6, &value, 4);
+  }
+}
+
+void SavePackedRotationKeys(io::OArchive& _archive,
+                            ozz::Range<const PackedRotationKey> _keys) {
+  char buffer[kKeyChunkSize * kPackedRotationKeyArchiveSize];
+  for (const PackedRotationKey* key = _keys.begin; key < _keys.end;) {
+    const size_t count =
+      math::Min(kKeyChunkSize, static_cast<size_t>(_keys.end - key));
+    char* cursor = buffer;
+    for (const PackedRotationKey* end = key + count; key < end;
+         ++key, cursor += kPackedRotationKeyArchiveSize) {
+      const uint16_t track = key->track;
+      std::memcpy(cursor + 0, &key->time, 2);
+      std::memcpy(cursor + 2, &track, 2);
+      cursor[4] = static_cast<char>(key->largest);
+      cursor[5] = static_cast<char>(key->sign);
+      std::memcpy(cursor + 6, &key->value, 4);
+    }
+    if (_archive.endian_swap()) {
+      SwapPackedRotationKeys(buffer, count);
+    }
+    _archive.SaveBinary(buffer, count * kPackedRotationKeyArchiveSize);
+  }
+}
+
+void LoadPackedRotationKeys(io::IArchive& _archive,
+                            ozz::Range<PackedRotationKey> _keys) {
+  char buffer[kKeyChunkSize * kPackedRotationKeyArchiveSize];
+  for (PackedRotationKey* key = _keys.begin; key < _keys.end;) {
+    const size_t count =
+      math::Min(kKeyChunkSize, static_cast<size_t>(_keys.end - key));
+    _archive.LoadBinary(buffer, count * kPackedRotationKeyArchiveSize);
+    if (_archive.endian_swap()) {
+      SwapPackedRotationKeys(buffer, count);
+    }
+    const char* cursor = buffer;
+    for (PackedRotationKey* end = key + count; key < end;
+         ++key, cursor += kPackedRotationKeyArchiveSize) {
+      uint16_t track;
+      std::memcpy(&key->time, cursor + 0, 2);
+      std::memcpy(&track, cursor + 2, 2);
+      key->track = track;
+      key->largest = cursor[4] & 3;
+      key->sign = cursor[5] & 1;
+      std::memcpy(&key->value, cursor + 6, 4);
+    }
+  }
+}
+
+// Constant rotations archive layout: track (2 bytes), largest (1 byte), sign
+// (1 byte) and 3 values (3 * 2 bytes).
+const size_t kConstantRotationArchiveSize = 10;
+
+// Swaps the endianness of _count constant rotations stored with their archive
+// layout in _constants.
+void SwapConstantRotations(char* _constants, size_t _count) {
+  for (size_t i = 0; i < _count; ++i) {
+    char* constant = _constants + i * kConstantRotationArchiveSize;
+    Swap16(constant + 0, 1);
+    Swap16(constant + 4, 3);
+  }
+}
+
+void SaveConstantRotations(io::OArchive& _archive,
+                           ozz::Range<const ConstantRotation> _constants) {
+  char buffer[kKeyChunkSize * kConstantRotationArchiveSize];
+  for (const ConstantRotation* constant = _constants.begin;
+       constant < _constants.end;) {
+    const size_t count = math::Min(
+      kKeyChunkSize, static_cast<size_t>(_constants.end - constant));
+    char* cursor = buffer;
+    for (const ConstantRotation* end = constant + count; constant < end;
+         ++constant, cursor += kConstantRotationArchiveSize) {
+      const uint16_t track = constant->track;
+      std::memcpy(cursor + 0, &track, 2);
+      cursor[2] = static_cast<char>(constant->largest);
+      cursor[3] = static_cast<char>(constant->sign);
+      std::memcpy(cursor + 4, constant->value, 6);
+    }
+    if (_archive.endian_swap()) {
+      SwapConstantRotations(buffer, count);
+    }
+    _archive.SaveBinary(buffer, count * kConstantRotationArchiveSize);
+  }
+}
+
+void LoadConstantRotations(io::IArchive& _archive,
+                           ozz::Range<ConstantRotation> _constants) {
+  char buffer[kKeyChunkSize * kConstantRotationArchiveSize];
+  for (ConstantRotation* constant = _constants.begin;
+       constant < _constants.end;) {
+    const size_t count = math::Min(
+      kKeyChunkSize, static_cast<size_t>(_constants.end - constant));
+    _archive.LoadBinary(buffer, count * kConstantRotationArchiveSize);
+    if (_archive.endian_swap()) {
+      SwapConstantRotations(buffer, count);
+    }
+    const char* cursor = buffer;
+    for (ConstantRotation* end = constant + count; constant < end;
+         ++constant, cursor += kConstantRotationArchiveSize) {
+      uint16_t track;
+      std::memcpy(&track, cursor + 0, 2);
+      constant->track = track;
+      constant->largest = cursor[2] & 3;
+      constant->sign = cursor[3] & 1;
+      std::memcpy(constant->value, cursor + 4, 6);
+    }
+  }
+}
+
+// Fills _tracks with the index of the _num_tracks joints that aren't listed in
+// _constants, which is sorted by joint index.
+template<typename _Constant>
+void FillTracks(ozz::Range<const _Constant> _constants, int _num_tracks,
+                ozz::Range<uint16_t> _tracks) {
+  const _Constant* constant = _constants.begin;
+  uint16_t* track = _tracks.begin;
+  for (int i = 0; i < _num_tracks; ++i) {
+    if (constant < _constants.end && constant->track == i) {
+      ++constant;
+    } else if (track < _tracks.end) {
+      *track++ = static_cast<uint16_t>(i);
+    }
+  }
+  assert(constant == _constants.end && track == _tracks.end &&
+         "Constants must be sorted by joint index.");
+}
+
+// Allocates _count keys of type _Key from _buffer to _keys.
+template<typename _Key>
+char* AllocateKeys(char* _buffer, size_t _count, ozz::Range<_Key>* _keys) {
+  _keys->begin = reinterpret_cast<_Key*>(_buffer);
+  assert(math::IsAligned(_keys->begin, OZZ_ALIGN_OF(_Key)));
+  _buffer += _count * sizeof(_Key);
+  _keys->end = reinterpret_cast<_Key*>(_buffer);
+  return _buffer;
+}
+}  // namespace
+
 Animation::Animation()
     : duration_(0.f),
       num_tracks_(0),
-      name_(NULL) {
+      name_(NULL),
+      rotation_format_(kRotationStandard),
+      time_format_(kTimeFloat),
+      in_place_(false) {
 }
 
 Animation::~Animation() {
   Deallocate();
 }
 
-void Animation::Allocate(size_t name_len, size_t _translation_count,
-                         size_t _rotation_count, size_t _scale_count) {
+size_t Animation::ComputeBufferSize(const Counts& _counts) const {
+  // Seek tables and animated tracks sizes depend on the number of tracks,
+  // which must be set.
+  const int num_tracks = num_soa_tracks() * 4;
+  const size_t seek_tables_size =
+    ComputeSeekTableSize(
+      _counts.translations,
+      CountKeyTracks(num_soa_tracks(), _counts.constant_translations)) +
+    ComputeSeekTableSize(
+      _counts.rotations,
+      CountKeyTracks(num_soa_tracks(), _counts.constant_rotations)) +
+    ComputeSeekTableSize(
+      _counts.scales,
+      CountKeyTracks(num_soa_tracks(), _counts.constant_scales));
+  const size_t num_animated =
+    num_tracks * 3 - _counts.constant_translations -
+    _counts.constant_rotations - _counts.constant_scales;
+
+  // Key sizes depend on rotation and time formats, which must be set.
+  const bool quantized = time_format_ == kTimeQuantized;
+  const size_t translation_size = quantized ?
+    sizeof(QuantizedTranslationKey) : sizeof(TranslationKey);
+  const size_t rotation_size = rotation_format_ == kRotationPacked ?
+    sizeof(PackedRotationKey) :
+    (quantized ? sizeof(QuantizedRotationKey) : sizeof(RotationKey));
+  const size_t scale_size = quantized ?
+    sizeof(QuantizedScaleKey) : sizeof(ScaleKey);
+
+  return (_counts.name_len > 0 ? _counts.name_len + 1 : 0) +
+         _counts.translations * translation_size +
+         _counts.rotations * rotation_size +
+         _counts.scales * scale_size +
+         _counts.constant_translations * sizeof(ConstantTranslation) +
+         _counts.constant_rotations * sizeof(ConstantRotation) +
+         _counts.constant_scales * sizeof(ConstantScale) +
+         num_animated * sizeof(uint16_t) +
+         seek_tables_size;
+}
+
+void Animation::Allocate(const Counts& _counts) {
+  // Compute overall size and allocate a single buffer for all the data.
+  const size_t buffer_size = ComputeBufferSize(_counts);
+  char* buffer = memory::default_allocator()->Allocate<char>(buffer_size);
+
+  FixUp(buffer, _counts);
+}
+
+void Animation::FixUp(char* _buffer, const Counts& _counts) {
   // Distributes buffer memory while ensuring proper alignment (serves larger
   // alignment values first).
   OZZ_STATIC_ASSERT(
+    OZZ_ALIGN_OF(PackedRotationKey) >= OZZ_ALIGN_OF(ConstantTranslation) &&
+    OZZ_ALIGN_OF(ConstantTranslation) >= OZZ_ALIGN_OF(ConstantRotation) &&
+    OZZ_ALIGN_OF(ConstantRotation) >= OZZ_ALIGN_OF(ConstantScale) &&
+    OZZ_ALIGN_OF(ConstantScale) >= OZZ_ALIGN_OF(TranslationKey) &&
     OZZ_ALIGN_OF(TranslationKey) >= OZZ_ALIGN_OF(RotationKey) &&
     OZZ_ALIGN_OF(RotationKey) >= OZZ_ALIGN_OF(ScaleKey) &&
-    OZZ_ALIGN_OF(ScaleKey) >= OZZ_ALIGN_OF(char));
+    OZZ_ALIGN_OF(ScaleKey) >= OZZ_ALIGN_OF(int) &&
+    OZZ_ALIGN_OF(int) >= OZZ_ALIGN_OF(float) &&
+    OZZ_ALIGN_OF(float) >= OZZ_ALIGN_OF(QuantizedTranslationKey) &&
+    OZZ_ALIGN_OF(QuantizedTranslationKey) >=
+      OZZ_ALIGN_OF(QuantizedRotationKey) &&
+    OZZ_ALIGN_OF(QuantizedRotationKey) >= OZZ_ALIGN_OF(QuantizedScaleKey) &&
+    OZZ_ALIGN_OF(QuantizedScaleKey) >= OZZ_ALIGN_OF(uint16_t) &&
+    OZZ_ALIGN_OF(uint16_t) >= OZZ_ALIGN_OF(char));
 
   assert(name_ == NULL && translations_.Size() == 0 && rotations_.Size() == 0 &&
-         scales_.Size() == 0);
-
-  // Compute overall size and allocate a single buffer for all the data.
-  const size_t buffer_size =
-    (name_len > 0 ? name_len + 1 : 0) +
-    _translation_count * sizeof(TranslationKey) +
-    _rotation_count * sizeof(RotationKey) +
-    _scale_count * sizeof(ScaleKey);
-  char* buffer = memory::default_allocator()->Allocate<char>(buffer_size);
-
-  // Fix up pointers
-  translations_.begin = reinterpret_cast<TranslationKey*>(buffer);
-  assert(math::IsAligned(translations_.begin, OZZ_ALIGN_OF(TranslationKey)));
-  buffer += _translation_count * sizeof(TranslationKey);
-  translations_.end = reinterpret_cast<TranslationKey*>(buffer);
-
-  rotations_.begin = reinterpret_cast<RotationKey*>(buffer);
-  assert(math::IsAligned(rotations_.begin, OZZ_ALIGN_OF(RotationKey)));
-  buffer += _rotation_count * sizeof(RotationKey);
-  rotations_.end = reinterpret_cast<RotationKey*>(buffer);
-
-  scales_.begin = reinterpret_cast<ScaleKey*>(buffer);
-  assert(math::IsAligned(scales_.begin, OZZ_ALIGN_OF(ScaleKey)));
-  buffer += _scale_count * sizeof(ScaleKey);
-  scales_.end = reinterpret_cast<ScaleKey*>(buffer);
+         packed_rotations_.Size() == 0 && scales_.Size() == 0 &&
+         quantized_translations_.Size() == 0 &&
+         quantized_rotations_.Size() == 0 && quantized_scales_.Size() == 0 &&
+         constant_translations_.Size() == 0 &&
+         constant_rotations_.Size() == 0 && constant_scales_.Size() == 0);
+
+  const int num_tracks = num_soa_tracks() * 4;
+  const bool packed = rotation_format_ == kRotationPacked;
+  const bool quantized = time_format_ == kTimeQuantized;
+
+  // Fix up pointers. Only buffers matching rotation and time formats are
+  // given keys, others are empty.
+  _buffer = AllocateKeys(
+    _buffer, packed ? _counts.rotations : 0, &packed_rotations_);
+  _buffer = AllocateKeys(
+    _buffer, _counts.constant_translations, &constant_translations_);
+  _buffer = AllocateKeys(
+    _buffer, _counts.constant_rotations, &constant_rotations_);
+  _buffer = AllocateKeys(_buffer, _counts.constant_scales, &constant_scales_);
+  _buffer = AllocateKeys(
+    _buffer, quantized ? 0 : _counts.translations, &translations_);
+  _buffer = AllocateKeys(
+    _buffer, packed || quantized ? 0 : _counts.rotations, &rotations_);
+  _buffer = AllocateKeys(_buffer, quantized ? 0 : _counts.scales, &scales_);
+
+  _buffer = AllocateSeekTable(
+    _buffer, _counts.translations,
+    CountKeyTracks(num_soa_tracks(), _counts.constant_translations),
+    &translations_seek_table_);
+  _buffer = AllocateSeekTable(
+    _buffer, _counts.rotations,
+    CountKeyTracks(num_soa_tracks(), _counts.constant_rotations),
+    &rotations_seek_table_);
+  _buffer = AllocateSeekTable(
+    _buffer, _counts.scales,
+    CountKeyTracks(num_soa_tracks(), _counts.constant_scales),
+    &scales_seek_table_);
+
+  _buffer = AllocateKeys(
+    _buffer, quantized ? _counts.translations : 0, &quantized_translations_);
+  _buffer = AllocateKeys(
+    _buffer, quantized && !packed ? _counts.rotations : 0,
+    &quantized_rotations_);
+  _buffer = AllocateKeys(
+    _buffer, quantized ? _counts.scales : 0, &quantized_scales_);
+
+  _buffer = AllocateKeys(
+    _buffer, num_tracks - _counts.constant_translations, &translation_tracks_);
+  _buffer = AllocateKeys(
+    _buffer, num_tracks - _counts.constant_rotations, &rotation_tracks_);
+  _buffer = AllocateKeys(
+    _buffer, num_tracks - _counts.constant_scales, &scale_tracks_);
 
   // Let name be NULL if animation has no name. Allows to avoid allocating this
   // buffer in the constructor of empty animations.
-  name_ = reinterpret_cast<char*>(name_len > 0 ? buffer : NULL);
+  name_ = reinterpret_cast<char*>(_counts.name_len > 0 ? _buffer : NULL);
   assert(math::IsAligned(name_, OZZ_ALIGN_OF(char)));
 }
 
 void Animation::Deallocate() {
 
-  memory::default_allocator()->Deallocate(translations_.begin);
+  // In-place animations do not own their buffer.
+  if (!in_place_) {
+    memory::default_allocator()->Deallocate(packed_rotations_.begin);
+  }
+  in_place_ = false;
 
   name_ = NULL;
+  rotation_format_ = kRotationStandard;
+  time_format_ = kTimeFloat;
+  packed_rotations_ = ozz::Range<PackedRotationKey>();
   translations_ = ozz::Range<TranslationKey>();
   rotations_ = ozz::Range<RotationKey>();
   scales_ = ozz::Range<ScaleKey>();
+  quantized_translations_ = ozz::Range<QuantizedTranslationKey>();
+  quantized_rotations_ = ozz::Range<QuantizedRotationKey>();
+  quantized_scales_ = ozz::Range<QuantizedScaleKey>();
+  constant_translations_ = ozz::Range<ConstantTranslation>();
+  constant_rotations_ = ozz::Range<ConstantRotation>();
+  constant_scales_ = ozz::Range<ConstantScale>();
+  translation_tracks_ = ozz::Range<uint16_t>();
+  rotation_tracks_ = ozz::Range<uint16_t>();
+  scale_tracks_ = ozz::Range<uint16_t>();
+  translations_seek_table_ = SeekTable();
+  rotations_seek_table_ = SeekTable();
+  scales_seek_table_ = SeekTable();
+}
+
+Animation::Counts Animation::GetCounts() const {
+  Counts counts;
+  counts.name_len = name_ ? std::strlen(name_) : 0;
+  counts.translations =
+    translations_.Count() + quantized_translations_.Count();
+  counts.rotations =
+    rotations_.Count() + quantized_rotations_.Count() +
+    packed_rotations_.Count();
+  counts.scales = scales_.Count() + quantized_scales_.Count();
+  counts.constant_translations = constant_translations_.Count();
+  counts.constant_rotations = constant_rotations_.Count();
+  counts.constant_scales = constant_scales_.Count();
+  return counts;
+}
+
+void Animation::BuildTracks() {
+  const int num_tracks = num_soa_tracks() * 4;
+  FillTracks<ConstantTranslation>(
+    constant_translations_, num_tracks, translation_tracks_);
+  FillTracks<ConstantRotation>(
+    constant_rotations_, num_tracks, rotation_tracks_);
+  FillTracks<ConstantScale>(constant_scales_, num_tracks, scale_tracks_);
+}
+
+void Animation::BuildSeekTables() {
+  const int num_translations = num_soa_translation_tracks() * 4;
+  const int num_rotations = num_soa_rotation_tracks() * 4;
+  const int num_scales = num_soa_scale_tracks() * 4;
+  if (time_format_ == kTimeQuantized) {
+    FillSeekTable<QuantizedTranslationKey>(
+      quantized_translations_, num_translations, &translations_seek_table_);
+    FillSeekTable<QuantizedScaleKey>(
+      quantized_scales_, num_scales, &scales_seek_table_);
+  } else {
+    FillSeekTable<TranslationKey>(
+      translations_, num_translations, &translations_seek_table_);
+    FillSeekTable<ScaleKey>(scales_, num_scales, &scales_seek_table_);
+  }
+  if (rotation_format_ == kRotationPacked) {
+    FillSeekTable<PackedRotationKey>(
+      packed_rotations_, num_rotations, &rotations_seek_table_);
+  } else if (time_format_ == kTimeQuantized) {
+    FillSeekTable<QuantizedRotationKey>(
+      quantized_rotations_, num_rotations, &rotations_seek_table_);
+  } else {
+    FillSeekTable<RotationKey>(
+      rotations_, num_rotations, &rotations_seek_table_);
+  }
 }
 
 size_t Animation::size() const {
   const size_t size =
-    sizeof(*this) + translations_.Size() + rotations_.Size() + scales_.Size();
+    sizeof(*this) + translations_.Size() + rotations_.Size() +
+    packed_rotations_.Size() + scales_.Size() +
+    quantized_translations_.Size() + quantized_rotations_.Size() +
+    quantized_scales_.Size() +
+    constant_translations_.Size() + constant_rotations_.Size() +
+    constant_scales_.Size() +
+    translation_tracks_.Size() + rotation_tracks_.Size() +
+    scale_tracks_.Size() +
+    translations_seek_table_.keys.Size() +
+    translations_seek_table_.times.Size() +
+    rotations_seek_table_.keys.Size() + rotations_seek_table_.times.Size() +
+    scales_seek_table_.keys.Size() + scales_seek_table_.times.Size();
   return size;
 }
 
@@ -208,43 +886,46 @@ void Animation::Save(ozz::io::OArchive& _archive) const {
   _archive << duration_;
   _archive << static_cast<int32_t>(num_tracks_);
 
-  const size_t name_len = name_ ? std::strlen(name_) : 0;
-  _archive << static_cast<int32_t>(name_len);
+  const Counts counts = GetCounts();
+  _archive << static_cast<int32_t>(counts.name_len);
 
-  const ptrdiff_t translation_count = translations_.Count();
-  _archive << static_cast<int32_t>(translation_count);
-  const ptrdiff_t rotation_count = rotations_.Count();
-  _archive << static_cast<int32_t>(rotation_count);
-  const ptrdiff_t scale_count = scales_.Count();
-  _archive << static_cast<int32_t>(scale_count);
+  _archive << static_cast<int32_t>(counts.translations);
+  _archive << static_cast<int32_t>(counts.rotations);
+  _archive << static_cast<int32_t>(counts.scales);
+  _archive << static_cast<uint8_t>(rotation_format_);
+  _archive << static_cast<uint8_t>(time_format_);
+  _archive << static_cast<int32_t>(counts.constant_translations);
+  _archive << static_cast<int32_t>(counts.constant_rotations);
+  _archive << static_cast<int32_t>(counts.constant_scales);
 
-  _archive << ozz::io::MakeArray(name_, name_len);
+  _archive << ozz::io::MakeArray(name_, counts.name_len);
 
-  for (ptrdiff_t i = 0; i < translation_count; ++i) {
-    const TranslationKey& key = translations_.begin[i];
-    _archive << key.time;
-    _archive << key.track;
-    _archive << ozz::io::MakeArray(key.value);
+  if (time_format_ == kTimeQuantized) {
+    SaveBulkKeys<QuantizedTranslationKey>(
+      _archive, quantized_translations_, SwapQuantizedBulkKeys);
+  } else {
+    SaveBulkKeys<TranslationKey>(_archive, translations_, SwapBulkKeys);
   }
-
-  for (ptrdiff_t i = 0; i < rotation_count; ++i) {
-    const RotationKey& key = rotations_.begin[i];
-    _archive << key.time;
-    uint16_t track = key.track;
-    _archive << track;
-    uint8_t largest = key.largest;
-    _archive << largest;
-    bool sign = key.sign;
-    _archive << sign;
-    _archive << ozz::io::MakeArray(key.value);
+  if (rotation_format_ == kRotationPacked) {
+    SavePackedRotationKeys(_archive, packed_rotations_);
+  } else if (time_format_ == kTimeQuantized) {
+    SaveRotationKeys<QuantizedRotationKey>(
+      _archive, quantized_rotations_, SwapQuantizedRotationKeys);
+  } else {
+    SaveRotationKeys<RotationKey>(_archive, rotations_, SwapRotationKeys);
   }
-
-  for (ptrdiff_t i = 0; i < scale_count; ++i) {
-    const ScaleKey& key = scales_.begin[i];
-    _archive << key.time;
-    _archive << key.track;
-    _archive << ozz::io::MakeArray(key.value);
+  if (time_format_ == kTimeQuantized) {
+    SaveBulkKeys<QuantizedScaleKey>(
+      _archive, quantized_scales_, SwapQuantizedBulkKeys);
+  } else {
+    SaveBulkKeys<ScaleKey>(_archive, scales_, SwapBulkKeys);
   }
+
+  // Animated tracks aren't serialized, they are deduced from constants.
+  SaveBulkKeys<ConstantTranslation>(
+    _archive, constant_translations_, SwapConstants);
+  SaveConstantRotations(_archive, constant_rotations_);
+  SaveBulkKeys<ConstantScale>(_archive, constant_scales_, SwapConstants);
 }
 
 void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
@@ -254,8 +935,10 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   duration_ = 0.f;
   num_tracks_ = 0;
 
-  // No retro-compatibility with anterior versions.
-  if (_version != 4) {
+  // No retro-compatibility with versions anterior to 4. Version 4 doesn't
+  // store rotation format (standard), versions 4 and 5 don't store time
+  // format (float), and versions 4 to 6 don't have constant tracks.
+  if (_version < 4 || _version > 7) {
     return;
   }
 
@@ -273,41 +956,218 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   _archive >> rotation_count;
   int32_t scale_count;
   _archive >> scale_count;
+  uint8_t rotation_format = kRotationStandard;
+  if (_version >= 5) {
+    _archive >> rotation_format;
+  }
+  rotation_format_ = rotation_format == kRotationPacked ?
+    kRotationPacked : kRotationStandard;
+  uint8_t time_format = kTimeFloat;
+  if (_version >= 6) {
+    _archive >> time_format;
+  }
+  time_format_ = time_format == kTimeQuantized ? kTimeQuantized : kTimeFloat;
+  int32_t constant_counts[3] = {0, 0, 0};
+  if (_version >= 7) {
+    _archive >> ozz::io::MakeArray(constant_counts);
+  }
+  for (int i = 0; i < 3; ++i) {
+    if (constant_counts[i] < 0 || constant_counts[i] > num_soa_tracks() * 4) {
+      num_tracks_ = 0;
+      return;
+    }
+  }
 
-  Allocate(name_len, translation_count, rotation_count, scale_count);
+  Counts counts;
+  counts.name_len = name_len;
+  counts.translations = translation_count;
+  counts.rotations = rotation_count;
+  counts.scales = scale_count;
+  counts.constant_translations = constant_counts[0];
+  counts.constant_rotations = constant_counts[1];
+  counts.constant_scales = constant_counts[2];
+  Allocate(counts);
 
   if (name_) {  // NULL name_ is supported.
     _archive >> ozz::io::MakeArray(name_, name_len);
     name_[name_len] = 0;
   }
 
-  for (int i = 0; i < translation_count; ++i) {
-    TranslationKey& key = translations_.begin[i];
-    _archive >> key.time;
-    _archive >> key.track;
-    _archive >> ozz::io::MakeArray(key.value);
+  if (time_format_ == kTimeQuantized) {
+    LoadBulkKeys<QuantizedTranslationKey>(
+      _archive, quantized_translations_, SwapQuantizedBulkKeys);
+  } else {
+    LoadBulkKeys<TranslationKey>(_archive, translations_, SwapBulkKeys);
+  }
+  if (rotation_format_ == kRotationPacked) {
+    LoadPackedRotationKeys(_archive, packed_rotations_);
+  } else if (time_format_ == kTimeQuantized) {
+    LoadRotationKeys<QuantizedRotationKey>(
+      _archive, quantized_rotations_, SwapQuantizedRotationKeys);
+  } else {
+    LoadRotationKeys<RotationKey>(_archive, rotations_, SwapRotationKeys);
+  }
+  if (time_format_ == kTimeQuantized) {
+    LoadBulkKeys<QuantizedScaleKey>(
+      _archive, quantized_scales_, SwapQuantizedBulkKeys);
+  } else {
+    LoadBulkKeys<ScaleKey>(_archive, scales_, SwapBulkKeys);
+  }
+
+  LoadBulkKeys<ConstantTranslation>(
+    _archive, constant_translations_, SwapConstants);
+  LoadConstantRotations(_archive, constant_rotations_);
+  LoadBulkKeys<ConstantScale>(_archive, constant_scales_, SwapConstants);
+
+  // Animated tracks and seek tables aren't serialized, they are rebuilt from
+  // loaded constants and keys.
+  BuildTracks();
+  BuildSeekTables();
+}
+
+void Animation::SaveInPlace(ozz::io::OArchive& _archive) const {
+  assert(!_archive.endian_swap() &&
+         "In-place archives must have native endianness.");
+
+  // Stores memory layout properties, so they can be validated when loading.
+  _archive << static_cast<uint32_t>(sizeof(TranslationKey));
+  _archive << static_cast<uint32_t>(sizeof(RotationKey));
+  _archive << static_cast<uint32_t>(sizeof(PackedRotationKey));
+  _archive << static_cast<uint32_t>(sizeof(ScaleKey));
+  _archive << static_cast<uint32_t>(sizeof(QuantizedTranslationKey));
+  _archive << static_cast<uint32_t>(sizeof(QuantizedRotationKey));
+  _archive << static_cast<uint32_t>(sizeof(QuantizedScaleKey));
+  _archive << static_cast<uint32_t>(sizeof(ConstantTranslation));
+  _archive << static_cast<uint32_t>(sizeof(ConstantRotation));
+  _archive << static_cast<uint32_t>(sizeof(ConstantScale));
+  _archive << static_cast<int32_t>(kSeekInterval);
+  _archive << static_cast<uint8_t>(rotation_format_);
+  _archive << static_cast<uint8_t>(time_format_);
+
+  _archive << duration_;
+  _archive << static_cast<int32_t>(num_tracks_);
+
+  const Counts counts = GetCounts();
+  const int32_t counts_array[] = {
+    static_cast<int32_t>(counts.name_len),
+    static_cast<int32_t>(counts.translations),
+    static_cast<int32_t>(counts.rotations),
+    static_cast<int32_t>(counts.scales),
+    static_cast<int32_t>(counts.constant_translations),
+    static_cast<int32_t>(counts.constant_rotations),
+    static_cast<int32_t>(counts.constant_scales)};
+  _archive << ozz::io::MakeArray(counts_array);
+
+  // Stores buffers as-is, in the order they are distributed by FixUp, seek
+  // tables and animated tracks included.
+  io::PadInPlace(_archive, OZZ_ALIGN_OF(PackedRotationKey));
+  _archive.SaveBinary(packed_rotations_.begin, packed_rotations_.Size());
+  _archive.SaveBinary(constant_translations_.begin,
+                      constant_translations_.Size());
+  _archive.SaveBinary(constant_rotations_.begin, constant_rotations_.Size());
+  _archive.SaveBinary(constant_scales_.begin, constant_scales_.Size());
+  _archive.SaveBinary(translations_.begin, translations_.Size());
+  _archive.SaveBinary(rotations_.begin, rotations_.Size());
+  _archive.SaveBinary(scales_.begin, scales_.Size());
+  const SeekTable* tables[] = {
+    &translations_seek_table_, &rotations_seek_table_, &scales_seek_table_};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(tables); ++i) {
+    _archive.SaveBinary(tables[i]->keys.begin, tables[i]->keys.Size());
+    _archive.SaveBinary(tables[i]->times.begin, tables[i]->times.Size());
+  }
+  _archive.SaveBinary(quantized_translations_.begin,
+                      quantized_translations_.Size());
+  _archive.SaveBinary(quantized_rotations_.begin,
+                      quantized_rotations_.Size());
+  _archive.SaveBinary(quantized_scales_.begin, quantized_scales_.Size());
+  _archive.SaveBinary(translation_tracks_.begin, translation_tracks_.Size());
+  _archive.SaveBinary(rotation_tracks_.begin, rotation_tracks_.Size());
+  _archive.SaveBinary(scale_tracks_.begin, scale_tracks_.Size());
+  if (counts.name_len > 0) {  // Includes null terminating character.
+    _archive.SaveBinary(name_, counts.name_len + 1);
+  }
+}
+
+void Animation::LoadInPlace(ozz::io::IArchive& _archive, uint32_t _version) {
+
+  // Destroy animation in case it was already used before.
+  Deallocate();
+  duration_ = 0.f;
+  num_tracks_ = 0;
+
+  // In-place data cannot be endian swapped.
+  if (_version != 4 || _archive.endian_swap()) {
+    return;
   }
 
-  for (int i = 0; i < rotation_count; ++i) {
-    RotationKey& key = rotations_.begin[i];
-    _archive >> key.time;
-    uint16_t track;
-    _archive >> track;
-    key.track = track;
-    uint8_t largest;
-    _archive >> largest;
-    key.largest = largest & 3;
-    bool sign;
-    _archive >> sign;
-    key.sign = sign & 1;
-    _archive >> ozz::io::MakeArray(key.value);
+  uint32_t sizes[10];
+  _archive >> ozz::io::MakeArray(sizes);
+  int32_t interval;
+  _archive >> interval;
+  uint8_t rotation_format;
+  _archive >> rotation_format;
+  uint8_t time_format;
+  _archive >> time_format;
+
+  float duration;
+  _archive >> duration;
+  int32_t num_tracks;
+  _archive >> num_tracks;
+
+  int32_t counts_array[7];
+  _archive >> ozz::io::MakeArray(counts_array);
+  Counts counts;
+  counts.name_len = counts_array[0];
+  counts.translations = counts_array[1];
+  counts.rotations = counts_array[2];
+  counts.scales = counts_array[3];
+  counts.constant_translations = counts_array[4];
+  counts.constant_rotations = counts_array[5];
+  counts.constant_scales = counts_array[6];
+
+  // Rejects data whose memory layout doesn't match.
+  const uint32_t expected_sizes[10] = {
+    sizeof(TranslationKey), sizeof(RotationKey), sizeof(PackedRotationKey),
+    sizeof(ScaleKey), sizeof(QuantizedTranslationKey),
+    sizeof(QuantizedRotationKey), sizeof(QuantizedScaleKey),
+    sizeof(ConstantTranslation), sizeof(ConstantRotation),
+    sizeof(ConstantScale)};
+  num_tracks_ = num_tracks;
+  const size_t max_constants = static_cast<size_t>(num_soa_tracks()) * 4;
+  if (std::memcmp(sizes, expected_sizes, sizeof(sizes)) != 0 ||
+      interval != kSeekInterval ||
+      rotation_format > kRotationPacked ||
+      time_format > kTimeQuantized ||
+      counts.constant_translations > max_constants ||
+      counts.constant_rotations > max_constants ||
+      counts.constant_scales > max_constants ||
+      !io::PadInPlace(_archive, OZZ_ALIGN_OF(PackedRotationKey))) {
+    num_tracks_ = 0;
+    return;
+  }
+  duration_ = duration;
+  rotation_format_ = static_cast<RotationFormat>(rotation_format);
+  time_format_ = static_cast<TimeFormat>(time_format);
+
+  const size_t buffer_size = ComputeBufferSize(counts);
+
+  // Uses stream memory directly if it's available and properly aligned.
+  io::Stream* stream = _archive.stream();
+  char* buffer =
+    static_cast<char*>(const_cast<void*>(stream->Map(buffer_size)));
+  if (buffer && !math::IsAligned(buffer, OZZ_ALIGN_OF(PackedRotationKey))) {
+    stream->Seek(-static_cast<int>(buffer_size), io::Stream::kCurrent);
+    buffer = NULL;
   }
 
-  for (int i = 0; i < scale_count; ++i) {
-    ScaleKey& key = scales_.begin[i];
-    _archive >> key.time;
-    _archive >> key.track;
-    _archive >> ozz::io::MakeArray(key.value);
+  if (buffer) {
+    in_place_ = true;
+    FixUp(buffer, counts);
+  } else {
+    // Falls back to copying data. The buffer is contiguous as data are
+    // distributed in the same order they were saved.
+    Allocate(counts);
+    _archive.LoadBinary(packed_rotations_.begin, buffer_size);
   }
 }
 }  // animation
@@ -347,10 +1207,12 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
 #include <cstddef>
 #include <cassert>
 
-#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
 
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/soa_wide.h"
 
 namespace ozz {
 namespace animation {
@@ -364,6 +1226,21 @@ BlendingJob::BlendingJob()
 }
 
 namespace {
+// Validates joint weights range [_begin,_end[. Ranges are passed as pointers,
+// as simd types attributes would be ignored as Range template arguments.
+bool ValidateJointWeights(const math::SimdFloat4* _begin,
+                          const math::SimdFloat4* _end,
+                          ptrdiff_t _min_range) {
+  bool valid = true;
+  if (_begin != NULL) {
+    valid &= _end >= _begin;
+    valid &= _end - _begin >= _min_range;
+  } else {
+    valid &= _end == NULL;
+  }
+  return valid;
+}
+
 bool ValidateLayer(const BlendingJob::Layer& _layer, ptrdiff_t _min_range) {
   bool valid = true;
 
@@ -373,12 +1250,8 @@ bool ValidateLayer(const BlendingJob::Layer& _layer, ptrdiff_t _min_range) {
   valid &= _layer.transform.end - _layer.transform.begin >= _min_range;
 
   // Joint weights are optional.
-  if (_layer.joint_weights.begin != NULL) {
-    valid &= _layer.joint_weights.end >= _layer.joint_weights.begin;
-    valid &= _layer.joint_weights.end - _layer.joint_weights.begin >= _min_range;
-  } else {
-    valid &= _layer.joint_weights.end == NULL;
-  }
+  valid &= ValidateJointWeights(
+    _layer.joint_weights.begin, _layer.joint_weights.end, _min_range);
   return valid;
 }
 }  // namespace
@@ -439,29 +1312,50 @@ bool BlendingJob::Validate() const {
 
 namespace {
 
-// Macro that defines the process of blending the 1st pass.
+// Negates _q quaternions that are opposed to _ref ones, to be sure to choose
+// the shortest path between the two.
+OZZ_INLINE math::SoaQuaternion ShortestPath(const math::SoaQuaternion& _ref,
+                                            const math::SoaQuaternion& _q) {
+  const math::SimdFloat4 dot =
+    _ref.x * _q.x + _ref.y * _q.y + _ref.z * _q.z + _ref.w * _q.w;
+  const math::SimdInt4 sign = math::Sign(dot);
+  const math::SoaQuaternion r = {math::Xor(_q.x, sign),
+                                 math::Xor(_q.y, sign),
+                                 math::Xor(_q.z, sign),
+                                 math::Xor(_q.w, sign)};
+  return r;
+}
+
+// 8 wide version of ShortestPath.
+OZZ_INLINE math::WideSoaQuaternion ShortestPath(
+  const math::WideSoaQuaternion& _ref, const math::WideSoaQuaternion& _q) {
+  const math::SimdFloat8 dot =
+    _ref.x * _q.x + _ref.y * _q.y + _ref.z * _q.z + _ref.w * _q.w;
+  const math::SimdFloat8 sign = math::Sign(dot);
+  const math::WideSoaQuaternion r = {math::Xor(_q.x, sign),
+                                     math::Xor(_q.y, sign),
+                                     math::Xor(_q.z, sign),
+                                     math::Xor(_q.w, sign)};
+  return r;
+}
+
+// Macro that defines the process of blending the 1st pass. It applies to both
+// 4 and 8 wide soa transforms.
 #define OZZ_BLEND_1ST_PASS(_in, _simd_weight, _out) { \
   _out->translation = _in.translation * _simd_weight; \
   _out->rotation = _in.rotation * _simd_weight; \
   _out->scale = _in.scale * _simd_weight; \
 }
 
-// Macro that defines the process of blending any pass but the first.
+// Macro that defines the process of blending any pass but the first. It
+// applies to both 4 and 8 wide soa transforms.
 #define OZZ_BLEND_N_PASS(_in, _simd_weight, _out) { \
   /* Blends translation. */ \
   _out->translation = _out->translation + _in.translation * _simd_weight; \
   /* Blends rotations, negates opposed quaternions to be sure to choose*/ \
   /* the shortest path between the two.*/ \
-  const math::SimdFloat4 dot = _out->rotation.x * _in.rotation.x + \
-                               _out->rotation.y * _in.rotation.y + \
-                               _out->rotation.z * _in.rotation.z + \
-                               _out->rotation.w * _in.rotation.w; \
-  const math::SimdInt4 sign = math::Sign(dot); \
-  const math::SoaQuaternion rotation = {math::Xor(_in.rotation.x, sign), \
-                                        math::Xor(_in.rotation.y, sign), \
-                                        math::Xor(_in.rotation.z, sign), \
-                                        math::Xor(_in.rotation.w, sign)}; \
-  _out->rotation = _out->rotation + rotation * _simd_weight; \
+  _out->rotation = _out->rotation + \
+    ShortestPath(_out->rotation, _in.rotation) * _simd_weight; \
   /* Blends scales.*/ \
   _out->scale = _out->scale + _in.scale * _simd_weight; \
 }
@@ -511,35 +1405,49 @@ namespace {
   _out.scale = _out.scale * rcp_scale; \
 }
 
-// Defines parameters that are passed through blending stages.
+// Defines the maximum number of soa joints processed at once. The job runs all
+// blending stages on a block of joints before moving to the next one. This
+// bounds the size of the per-joint accumulated weights array allocated on the
+// stack, whatever the number of joints, and keeps the output block in cache
+// from a stage to the next. It's a multiple of 2 so that 8 wide simd pairing
+// isn't broken by block boundaries.
+const size_t kBlockSoaJoints = 32;
+
+// Defines parameters that are passed through blending stages, for a block of
+// soa joints.
 struct ProcessArgs {
-  ProcessArgs(const BlendingJob& _job)
-    : job(_job),
-      num_soa_joints(_job.bind_pose.end - _job.bind_pose.begin),
+  ProcessArgs(float _threshold,
+              math::SoaTransform* _output,
+              const math::SoaTransform* _bind_pose,
+              size_t _num_soa_joints)
+    : threshold(_threshold),
+      num_soa_joints(_num_soa_joints),
+      output(_output),
+      bind_pose(_bind_pose),
       num_passes(0),
       num_partial_passes(0),
       accumulated_weight(0.f) {
-    // The range of all buffers has already been validated.
-    assert(job.output.end >= job.output.begin + num_soa_joints);
     assert(OZZ_ARRAY_SIZE(accumulated_weights) >= num_soa_joints);
   }
 
-  // Allocates enough space to store a accumulated weights per-joint.
-  // It will be initialized by the first pass processed, if any.
-  // This is quite big for a stack allocation (16 byte * maximum number of
-  // joints). This is one of the reasons why the number of joints is limited
-  // by the API.
+  // Allocates enough space to store accumulated weights per-joint of the
+  // block. It will be initialized by the first pass processed, if any.
   // Note that this array is used with SoA data.
   // This is the first argument in order to avoid wasting too much space with
   // alignment padding.
-  math::SimdFloat4 accumulated_weights[Skeleton::kMaxSoAJoints];
+  math::SimdFloat4 accumulated_weights[kBlockSoaJoints];
 
-  // The job to process.
-  const BlendingJob& job;
+  // The bind pose is blended when the accumulated weight is less than this
+  // threshold value.
+  float threshold;
 
-  // The number of transforms to process as defined by the size of the bind pose.
+  // The number of soa joints of the block.
   size_t num_soa_joints;
 
+  // Output and bind pose transforms, offset to the beginning of the block.
+  math::SoaTransform* output;
+  const math::SoaTransform* bind_pose;
+
   // Number of processed blended passes (excluding passes with a weight <= 0.f),
   // including partial passes.
   int num_passes;
@@ -556,76 +1464,173 @@ struct ProcessArgs {
    void operator = (const ProcessArgs&);
 };
 
-// Blends all layers of the job to its output.
-void BlendLayers(ProcessArgs* _args) {
-  assert(_args);
+// Returns true if any lane of _joint_weights is positive, meaning that the soa
+// joint contributes to partial blending.
+OZZ_INLINE bool IsActive(const math::SimdFloat4& _joint_weights) {
+  return !math::AreAllFalse(
+    math::CmpGt(_joint_weights, math::simd_float4::zero()));
+}
 
-  // Iterates through all layers and blend them to the output.
-  for (const BlendingJob::Layer* layer = _args->job.layers.begin;
-       layer < _args->job.layers.end;
-       ++layer) {
+// Returns true if any joint of the _count soa joints weights _joint_weights
+// contributes to partial blending.
+OZZ_INLINE bool IsAnyActive(const math::SimdFloat4* _joint_weights,
+                            size_t _count) {
+  for (size_t i = 0; i < _count; ++i) {
+    if (IsActive(_joint_weights[i])) {
+      return true;
+    }
+  }
+  return false;
+}
 
-    // Asserts buffer sizes, which must never fail as it has been validated.
-    assert(layer->transform.end >=
-           layer->transform.begin + _args->num_soa_joints);
-    assert(!layer->joint_weights.begin ||
-           (layer->joint_weights.end >=
-            layer->joint_weights.begin + _args->num_soa_joints));
+// Initializes _count soa joints of a first pass, as blending a transform with
+// a weight of 0 would.
+OZZ_INLINE void ClearFirstPass(math::SoaTransform* _output,
+                               math::SimdFloat4* _accumulated_weights,
+                               size_t _count) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SoaTransform cleared = {
+    {zero, zero, zero}, {zero, zero, zero, zero}, {zero, zero, zero}};
+  for (size_t i = 0; i < _count; ++i) {
+    _output[i] = cleared;
+    _accumulated_weights[i] = zero;
+  }
+}
 
-    // Skip irrelevant layers.
-    if (layer->weight <= 0.f) {
+// Blends _src transforms to the block output, with _weight and optional
+// _joint_weights. Soa joints are processed by pairs with 8 wide simd, the last
+// one (if any) with 4 wide simd. _FirstPass selects the blending process of
+// the first pass, _Partial enables per-joint weights. With partial blending,
+// soa joints whose weights are all 0 are skipped, _src isn't even read.
+template <bool _FirstPass, bool _Partial>
+void BlendLayer(const math::SoaTransform* _src,
+                const math::SimdFloat4* _joint_weights,
+                float _weight,
+                ProcessArgs* _args) {
+  const math::SimdFloat4 layer_weight = math::simd_float4::Load1(_weight);
+  const math::SimdFloat8 wide_layer_weight = math::simd_float8::Load1(_weight);
+  const math::SoaTransform* src = _src;
+  const math::SimdFloat4* joint_weights = _joint_weights;
+  math::SimdFloat4* accumulated_weights = _args->accumulated_weights;
+  math::SoaTransform* output = _args->output;
+  const size_t num_soa_joints = _args->num_soa_joints;
+
+  size_t i = 0;
+  for (; i + 1 < num_soa_joints; i += 2) {
+    if (_Partial &&
+        !IsActive(joint_weights[i]) && !IsActive(joint_weights[i + 1])) {
+      if (_FirstPass) {
+        ClearFirstPass(output + i, accumulated_weights + i, 2);
+      }
       continue;
     }
+    const math::WideSoaTransform wide_src =
+      math::WideSoaTransform::Load(src[i], src[i + 1]);
+    const math::SimdFloat8 weight =
+      _Partial ? wide_layer_weight * math::Max0(math::simd_float8::Load(
+                                       joint_weights[i], joint_weights[i + 1]))
+               : wide_layer_weight;
+    math::SimdFloat8 accumulated_weight;
+    math::WideSoaTransform dest;
+    if (_FirstPass) {
+      accumulated_weight = weight;
+      OZZ_BLEND_1ST_PASS(wide_src, weight, (&dest));
+    } else {
+      accumulated_weight =
+        math::simd_float8::Load(accumulated_weights[i],
+                                accumulated_weights[i + 1]) + weight;
+      dest = math::WideSoaTransform::Load(output[i], output[i + 1]);
+      OZZ_BLEND_N_PASS(wide_src, weight, (&dest));
+    }
+    accumulated_weights[i] = math::GetLow(accumulated_weight);
+    accumulated_weights[i + 1] = math::GetHigh(accumulated_weight);
+    output[i] = math::GetLow(dest);
+    output[i + 1] = math::GetHigh(dest);
+  }
+  for (; i < num_soa_joints; ++i) {
+    if (_Partial && !IsActive(joint_weights[i])) {
+      if (_FirstPass) {
+        ClearFirstPass(output + i, accumulated_weights + i, 1);
+      }
+      continue;
+    }
+    const math::SimdFloat4 weight =
+      _Partial ? layer_weight * math::Max0(joint_weights[i]) : layer_weight;
+    math::SoaTransform* dest = output + i;
+    if (_FirstPass) {
+      accumulated_weights[i] = weight;
+      OZZ_BLEND_1ST_PASS(src[i], weight, dest);
+    } else {
+      accumulated_weights[i] = accumulated_weights[i] + weight;
+      OZZ_BLEND_N_PASS(src[i], weight, dest);
+    }
+  }
+}
 
-    // Accumulates global weights.
-    _args->accumulated_weight += layer->weight;
-    const math::SimdFloat4 layer_weight = math::simd_float4::Load1(layer->weight);
+// Returns _joint_weights offset to the block starting at soa joint _offset, or
+// NULL if per-joint weights are disabled (_joint_weights is NULL).
+OZZ_INLINE const math::SimdFloat4* BlockJointWeights(
+  const math::SimdFloat4* _joint_weights, size_t _offset) {
+  return _joint_weights ? _joint_weights + _offset : NULL;
+}
 
-    if (layer->joint_weights.begin) {
-      // This layer has per-joint weights.
-      ++_args->num_partial_passes;
+// Blends a layer pass to the block output. _src and _joint_weights (NULL if
+// the layer has no per-joint weights) point to the beginning of the block.
+// Layers with a weight <= 0 are skipped.
+void BlendPass(const math::SoaTransform* _src,
+               const math::SimdFloat4* _joint_weights,
+               float _weight,
+               ProcessArgs* _args) {
+  // Skip irrelevant layers.
+  if (_weight <= 0.f) {
+    return;
+  }
 
-      if (_args->num_passes == 0) {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          const math::SimdFloat4 weight =
-            layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          _args->accumulated_weights[i] = weight;
-          OZZ_BLEND_1ST_PASS(src, weight, dest);
-        }
-      } else {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          const math::SimdFloat4 weight =
-            layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          _args->accumulated_weights[i] =
-            _args->accumulated_weights[i] + weight;
-          OZZ_BLEND_N_PASS(src, weight, dest);
-        }
-      }
+  // Accumulates global weights.
+  _args->accumulated_weight += _weight;
+
+  if (_joint_weights) {
+    // This layer has per-joint weights.
+    ++_args->num_partial_passes;
+
+    if (_args->num_passes == 0) {
+      BlendLayer<true, true>(_src, _joint_weights, _weight, _args);
     } else {
-      // This is a full layer.
-      if (_args->num_passes == 0) {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          _args->accumulated_weights[i] = layer_weight;
-          OZZ_BLEND_1ST_PASS(src, layer_weight, dest);
-        }
-      } else {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          _args->accumulated_weights[i] =
-            _args->accumulated_weights[i] + layer_weight;
-          OZZ_BLEND_N_PASS(src, layer_weight, dest);
-        }
-      }
+      BlendLayer<false, true>(_src, _joint_weights, _weight, _args);
+    }
+  } else {
+    // This is a full layer.
+    if (_args->num_passes == 0) {
+      BlendLayer<true, false>(_src, NULL, _weight, _args);
+    } else {
+      BlendLayer<false, false>(_src, NULL, _weight, _args);
     }
-    // One more pass blended.
-    ++_args->num_passes;
+  }
+  // One more pass blended.
+  ++_args->num_passes;
+}
+
+// Blends all layers of the job to the output block starting at soa joint
+// _offset.
+void BlendLayers(const BlendingJob& _job, size_t _offset, ProcessArgs* _args) {
+  assert(_args);
+
+  // Iterates through all layers and blend them to the output.
+  for (const BlendingJob::Layer* layer = _job.layers.begin;
+       layer < _job.layers.end;
+       ++layer) {
+
+    // Asserts buffer sizes, which must never fail as it has been validated.
+    assert(layer->transform.end >=
+           layer->transform.begin + _offset + _args->num_soa_joints);
+    assert(!layer->joint_weights.begin ||
+           (layer->joint_weights.end >= layer->joint_weights.begin +
+                                        _offset + _args->num_soa_joints));
+
+    BlendPass(layer->transform.begin + _offset,
+              BlockJointWeights(layer->joint_weights.begin, _offset),
+              layer->weight,
+              _args);
   }
 }
 
@@ -634,33 +1639,28 @@ void BlendLayers(ProcessArgs* _args) {
 void BlendBindPose(ProcessArgs* _args) {
   assert(_args);
 
-  // Asserts buffer sizes, which must never fail as it has been validated.
-  assert(_args->job.bind_pose.end >=
-         _args->job.bind_pose.begin + _args->num_soa_joints);
-
   if (_args->num_partial_passes == 0) {
     // No partial blending pass detected, threshold can be tested globally.
-    const float bp_weight =
-      _args->job.threshold - _args->accumulated_weight;
+    const float bp_weight = _args->threshold - _args->accumulated_weight;
 
     if (bp_weight > 0.f) {  // The bind-pose is needed if it has a weight.
       if (_args->num_passes == 0) {
         // Strictly copying bind-pose.
         _args->accumulated_weight = 1.f;
         for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          _args->job.output.begin[i] = _args->job.bind_pose.begin[i];
+          _args->output[i] = _args->bind_pose[i];
         }
       } else {
         // Updates global accumulated weight, but not per-joint weight any more
         // because normalization stage will be global also.
-        _args->accumulated_weight = _args->job.threshold;
+        _args->accumulated_weight = _args->threshold;
 
         const math::SimdFloat4 simd_bp_weight =
           math::simd_float4::Load1(bp_weight);
 
         for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = _args->job.bind_pose.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
+          const math::SoaTransform& src = _args->bind_pose[i];
+          math::SoaTransform* dest = _args->output + i;
           OZZ_BLEND_N_PASS(src, simd_bp_weight, dest);
         }
       }
@@ -669,14 +1669,14 @@ void BlendBindPose(ProcessArgs* _args) {
     // Blending passes contain partial blending, threshold must be tested for
     // each joint.
     const math::SimdFloat4 threshold = 
-      math::simd_float4::Load1(_args->job.threshold);
+      math::simd_float4::Load1(_args->threshold);
 
     // There's been at least 1 pass as num_partial_passes != 0.
     assert(_args->num_passes != 0);
 
     for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-      const math::SoaTransform& src = _args->job.bind_pose.begin[i];
-      math::SoaTransform* dest = _args->job.output.begin + i;
+      const math::SoaTransform& src = _args->bind_pose[i];
+      math::SoaTransform* dest = _args->output + i;
       const math::SimdFloat4 bp_weight =
         math::Max0(threshold - _args->accumulated_weights[i]);
       _args->accumulated_weights[i] =
@@ -699,7 +1699,7 @@ void Normalize(ProcessArgs* _args) {
     const math::SimdFloat4 ratio =
       math::simd_float4::Load1(1.f / _args->accumulated_weight);
     for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-      math::SoaTransform& dest = _args->job.output.begin[i];
+      math::SoaTransform& dest = _args->output[i];
       dest.rotation = NormalizeEst(dest.rotation);
       dest.translation = dest.translation * ratio;
       dest.scale = dest.scale * ratio;
@@ -709,7 +1709,7 @@ void Normalize(ProcessArgs* _args) {
     const math::SimdFloat4 one = math::simd_float4::one();
     for (size_t i = 0; i < _args->num_soa_joints; ++i) {
       const math::SimdFloat4 ratio = one / _args->accumulated_weights[i];
-      math::SoaTransform& dest = _args->job.output.begin[i];
+      math::SoaTransform& dest = _args->output[i];
       dest.rotation = NormalizeEst(dest.rotation);
       dest.translation = dest.translation * ratio;
       dest.scale = dest.scale * ratio;
@@ -717,81 +1717,102 @@ void Normalize(ProcessArgs* _args) {
   }
 }
 
-// Process additive blending pass.
-void AddLayers(ProcessArgs* _args) {
-  assert(_args);
-
-  // Iterates through all layers and blend them to the output.
-  for (const BlendingJob::Layer* layer = _args->job.additive_layers.begin;
-       layer < _args->job.additive_layers.end;
-       ++layer) {
-
-    // Asserts buffer sizes, which must never fail as it has been validated.
-    assert(layer->transform.end >=
-           layer->transform.begin + _args->num_soa_joints);
-    assert(!layer->joint_weights.begin ||
-           (layer->joint_weights.end >=
-            layer->joint_weights.begin + _args->num_soa_joints));
-
-    // Prepares constants. 
-    const math::SimdFloat4 one = math::simd_float4::one();
+// Adds (or subtracts if _weight is negative) an additive layer pass to the
+// block output. _src and _joint_weights (NULL if the layer has no per-joint
+// weights) point to the beginning of the block. Layers with a weight of 0 are
+// skipped.
+void AddPass(const math::SoaTransform* _src,
+             const math::SimdFloat4* _joint_weights,
+             float _weight,
+             ProcessArgs* _args) {
+  // Prepares constants.
+  const math::SimdFloat4 one = math::simd_float4::one();
 
-    if (layer->weight > 0.f) {
-      // Weight is positive, need to perform additive blending.
-      const math::SimdFloat4 layer_weight =
-        math::simd_float4::Load1(layer->weight);
+  if (_weight > 0.f) {
+    // Weight is positive, need to perform additive blending.
+    const math::SimdFloat4 layer_weight = math::simd_float4::Load1(_weight);
 
-      if (layer->joint_weights.begin) {
-        // This layer has per-joint weights.
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          const math::SimdFloat4 weight =
-            layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          const math::SimdFloat4 one_minus_weight = one - weight;
-          const math::SoaFloat3 one_minus_weight_f3 = {
-            one_minus_weight, one_minus_weight, one_minus_weight};
-          OZZ_ADD_PASS(src, weight, dest);
+    if (_joint_weights) {
+      // This layer has per-joint weights. Soa joints whose weights are all 0
+      // are skipped.
+      for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+        if (!IsActive(_joint_weights[i])) {
+          continue;
         }
-      } else {
-        // This is a full layer.
-        const math::SimdFloat4 one_minus_weight = one - layer_weight;
+        const math::SoaTransform& src = _src[i];
+        math::SoaTransform& dest = _args->output[i];
+        const math::SimdFloat4 weight =
+          layer_weight * math::Max0(_joint_weights[i]);
+        const math::SimdFloat4 one_minus_weight = one - weight;
         const math::SoaFloat3 one_minus_weight_f3 = {
           one_minus_weight, one_minus_weight, one_minus_weight};
-
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          OZZ_ADD_PASS(src, layer_weight, dest);
-        }
+        OZZ_ADD_PASS(src, weight, dest);
       }
-    } else if (layer->weight < 0.f) {
-      // Weight is negative, need to perform subtractive blending.
-      const math::SimdFloat4 layer_weight =
-        math::simd_float4::Load1(-layer->weight);
-
-      if (layer->joint_weights.begin) {
-        // This layer has per-joint weights.
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          const math::SimdFloat4 weight =
-            layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          const math::SimdFloat4 one_minus_weight = one - weight;
-          OZZ_SUB_PASS(src, weight, dest);
-        }
-      } else {
-        // This is a full layer.
-        const math::SimdFloat4 one_minus_weight = one - layer_weight;
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform& dest = _args->job.output.begin[i];
-          OZZ_SUB_PASS(src, layer_weight, dest);
+    } else {
+      // This is a full layer.
+      const math::SimdFloat4 one_minus_weight = one - layer_weight;
+      const math::SoaFloat3 one_minus_weight_f3 = {
+        one_minus_weight, one_minus_weight, one_minus_weight};
+
+      for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+        const math::SoaTransform& src = _src[i];
+        math::SoaTransform& dest = _args->output[i];
+        OZZ_ADD_PASS(src, layer_weight, dest);
+      }
+    }
+  } else if (_weight < 0.f) {
+    // Weight is negative, need to perform subtractive blending.
+    const math::SimdFloat4 layer_weight = math::simd_float4::Load1(-_weight);
+
+    if (_joint_weights) {
+      // This layer has per-joint weights. Soa joints whose weights are all 0
+      // are skipped.
+      for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+        if (!IsActive(_joint_weights[i])) {
+          continue;
         }
+        const math::SoaTransform& src = _src[i];
+        math::SoaTransform& dest = _args->output[i];
+        const math::SimdFloat4 weight =
+          layer_weight * math::Max0(_joint_weights[i]);
+        const math::SimdFloat4 one_minus_weight = one - weight;
+        OZZ_SUB_PASS(src, weight, dest);
       }
     } else {
-      // Skip layer as its weight is 0.
+      // This is a full layer.
+      const math::SimdFloat4 one_minus_weight = one - layer_weight;
+      for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+        const math::SoaTransform& src = _src[i];
+        math::SoaTransform& dest = _args->output[i];
+        OZZ_SUB_PASS(src, layer_weight, dest);
+      }
     }
+  } else {
+    // Skip layer as its weight is 0.
+  }
+}
+
+// Process additive blending pass of all additive layers of the job, to the
+// output block starting at soa joint _offset.
+void AddLayers(const BlendingJob& _job, size_t _offset, ProcessArgs* _args) {
+  assert(_args);
+
+  // Iterates through all layers and blend them to the output.
+  for (const BlendingJob::Layer* layer = _job.additive_layers.begin;
+       layer < _job.additive_layers.end;
+       ++layer) {
+
+    // Asserts buffer sizes, which must never fail as it has been validated.
+    assert(layer->transform.end >=
+           layer->transform.begin + _offset + _args->num_soa_joints);
+    assert(!layer->joint_weights.begin ||
+           (layer->joint_weights.end >= layer->joint_weights.begin +
+                                        _offset + _args->num_soa_joints));
+
+    AddPass(layer->transform.begin + _offset,
+            BlockJointWeights(layer->joint_weights.begin, _offset),
+            layer->weight,
+            _args);
   }
 }
 }  // namespace
@@ -801,20 +1822,212 @@ bool BlendingJob::Run() const {
     return false;
   }
 
-  // Initializes blended parameters that are exchanged across blend stages.
-  ProcessArgs process_args(*this);
+  // Processes soa joints by blocks, running all blending stages on a block
+  // before moving to the next one.
+  const size_t num_soa_joints = bind_pose.end - bind_pose.begin;
+  for (size_t offset = 0; offset < num_soa_joints; offset += kBlockSoaJoints) {
+    const size_t block_soa_joints =
+      math::Min(num_soa_joints - offset, kBlockSoaJoints);
+
+    // Initializes blended parameters that are exchanged across blend stages.
+    ProcessArgs process_args(threshold,
+                             output.begin + offset,
+                             bind_pose.begin + offset,
+                             block_soa_joints);
+
+    // Blends all layers to the job output buffers.
+    BlendLayers(*this, offset, &process_args);
+
+    // Applies bind pose.
+    BlendBindPose(&process_args);
+
+    // Normalizes output.
+    Normalize(&process_args);
+
+    // Process additive blending.
+    AddLayers(*this, offset, &process_args);
+  }
+
+  return true;
+}
+
+SamplingBlendingJob::Layer::Layer()
+    : weight(0.f),
+      animation(NULL),
+      cache(NULL),
+      time(0.f) {
+}
+
+SamplingBlendingJob::SamplingBlendingJob()
+    : threshold(.1f) {
+}
+
+namespace {
+bool ValidateLayer(const SamplingBlendingJob::Layer& _layer,
+                   ptrdiff_t _min_range) {
+  // Test for NULL pointers.
+  if (!_layer.animation || !_layer.cache) {
+    return false;
+  }
+
+  bool valid = true;
+
+  // Tests that the animation outputs all the joints to blend, and that the
+  // cache is big enough to sample it.
+  const ptrdiff_t num_soa_tracks = _layer.animation->num_soa_tracks();
+  valid &= num_soa_tracks >= _min_range;
+  valid &= _layer.cache->max_soa_tracks() >= num_soa_tracks;
+
+  // Joint weights are optional.
+  valid &= ValidateJointWeights(
+    _layer.joint_weights.begin, _layer.joint_weights.end, _min_range);
+  return valid;
+}
+
+// Clamps _layer time in range [0,duration] of its animation.
+OZZ_INLINE float ClampTime(const SamplingBlendingJob::Layer& _layer) {
+  return math::Clamp(0.f, _layer.time, _layer.animation->duration());
+}
+
+// Defines the number of soa joints processed at once by the
+// SamplingBlendingJob. Every layer is sampled to a buffer of this size, that
+// is blended to the output straight away, while it's still in cache.
+const size_t kSamplingBlockSoaJoints = 8;
+OZZ_STATIC_ASSERT(kSamplingBlockSoaJoints <= kBlockSoaJoints &&
+                  (kSamplingBlockSoaJoints & 1) == 0);
+}  // namespace
+
+bool SamplingBlendingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for valid threshold).
+  valid &= threshold > 0.f;
+
+  // Test for NULL begin pointers.
+  valid &= bind_pose.begin != NULL;
+  valid &= output.begin != NULL;
+
+  // Test ranges are valid (implicitly test for NULL end pointers).
+  valid &= bind_pose.end >= bind_pose.begin;
+  valid &= output.end >= output.begin;
+
+  // The bind pose size defines the ranges of transforms to blend, so all
+  // other buffers should be bigger.
+  const ptrdiff_t min_range = bind_pose.end - bind_pose.begin;
+  valid &= output.end - output.begin >= min_range;
+
+  // Blend layers are optional.
+  if (layers.begin != NULL) {
+    valid &= layers.end >= layers.begin;
+  } else {
+    valid &= layers.end == NULL;
+  }
+
+  // Validates layers.
+  for (const Layer* layer = layers.begin;
+       layers.begin && layer < layers.end;
+       ++layer) {
+    valid &= ValidateLayer(*layer, min_range);
+  }
+
+  // Additive layers are optional.
+  if (additive_layers.begin != NULL) {
+    valid &= additive_layers.end >= additive_layers.begin;
+  } else {
+    valid &= additive_layers.end == NULL;
+  }
+
+  // Validates additive layers.
+  for (const Layer* layer = additive_layers.begin;
+       additive_layers.begin && layer < additive_layers.end;
+       ++layer) {
+    valid &= ValidateLayer(*layer, min_range);
+  }
+
+  return valid;
+}
 
-  // Blends all layers to the job output buffers.
-  BlendLayers(&process_args);
+bool SamplingBlendingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
 
-  // Applies bind pose.
-  BlendBindPose(&process_args);
+  // Fetches and decompresses key frames of the layers that contribute to the
+  // output. Other layers aren't sampled at all, their cache is left unchanged.
+  for (const Layer* layer = layers.begin; layer < layers.end; ++layer) {
+    if (layer->weight > 0.f) {
+      layer->cache->Step(*layer->animation);
+      layer->cache->Update(*layer->animation, ClampTime(*layer), NULL);
+    }
+  }
+  for (const Layer* layer = additive_layers.begin;
+       layer < additive_layers.end;
+       ++layer) {
+    if (layer->weight != 0.f) {
+      layer->cache->Step(*layer->animation);
+      layer->cache->Update(*layer->animation, ClampTime(*layer), NULL);
+    }
+  }
 
-  // Normalizes output.
-  Normalize(&process_args);
+  // Processes soa joints by blocks. Every contributing layer is interpolated
+  // to the block samples buffer, which is blended to the output straight away.
+  math::SoaTransform samples[kSamplingBlockSoaJoints];
+  const size_t num_soa_joints = bind_pose.end - bind_pose.begin;
+  for (size_t offset = 0;
+       offset < num_soa_joints;
+       offset += kSamplingBlockSoaJoints) {
+    const size_t block_soa_joints =
+      math::Min(num_soa_joints - offset, kSamplingBlockSoaJoints);
+    const int soa_begin = static_cast<int>(offset);
+    const int soa_end = static_cast<int>(offset + block_soa_joints);
+
+    // Initializes blended parameters that are exchanged across blend stages.
+    ProcessArgs process_args(threshold,
+                             output.begin + offset,
+                             bind_pose.begin + offset,
+                             block_soa_joints);
+
+    // Samples and blends all layers to the job output buffers.
+    for (const Layer* layer = layers.begin; layer < layers.end; ++layer) {
+      if (layer->weight <= 0.f) {
+        continue;
+      }
+      // Partial layers aren't sampled if none of the block joints
+      // contributes. The pass is still processed, samples won't be read.
+      const math::SimdFloat4* joint_weights =
+        BlockJointWeights(layer->joint_weights.begin, offset);
+      if (!joint_weights || IsAnyActive(joint_weights, block_soa_joints)) {
+        layer->cache->Interpolate(*layer->animation, ClampTime(*layer),
+                                  soa_begin, soa_end, NULL, samples);
+      }
+      BlendPass(samples, joint_weights, layer->weight, &process_args);
+    }
 
-  // Process additive blending.
-  AddLayers(&process_args);
+    // Applies bind pose.
+    BlendBindPose(&process_args);
+
+    // Normalizes output.
+    Normalize(&process_args);
+
+    // Samples and process additive blending.
+    for (const Layer* layer = additive_layers.begin;
+         layer < additive_layers.end;
+         ++layer) {
+      // Partial layers are skipped if none of the block joints contributes.
+      const math::SimdFloat4* joint_weights =
+        BlockJointWeights(layer->joint_weights.begin, offset);
+      if (layer->weight == 0.f ||
+          (joint_weights && !IsAnyActive(joint_weights, block_soa_joints))) {
+        continue;
+      }
+      layer->cache->Interpolate(*layer->animation, ClampTime(*layer),
+                                soa_begin, soa_end, NULL, samples);
+      AddPass(samples, joint_weights, layer->weight, &process_args);
+    }
+  }
 
   return true;
 }
@@ -856,6 +2069,7 @@ bool BlendingJob::Run() const {
 
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/soa_wide.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/math_ex.h"
 
@@ -864,6 +2078,24 @@ bool BlendingJob::Run() const {
 namespace ozz {
 namespace animation {
 
+namespace {
+// Tests if _joint must be updated, ie: if _joint or one of its ancestors is
+// _root or is flagged in _dirty bitset. Ancestors are walked up to the first
+// one that precedes _first, as the update can't start before it.
+bool IsUpdated(const Skeleton::JointProperties* _properties, int _root,
+               const uint32_t* _dirty, int _first, int _joint) {
+  for (int joint = _joint;
+       joint != Skeleton::kNoParentIndex && joint >= _first;
+       joint = _properties[joint].parent) {
+    if (joint == _root ||
+        (_dirty != NULL && (_dirty[joint / 32] & (1u << (joint & 31))) != 0)) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
 bool LocalToModelJob::Validate() const {
   // Don't need any early out, as jobs are valid in most of the performance
   // critical cases.
@@ -877,7 +2109,18 @@ bool LocalToModelJob::Validate() const {
   valid &= input.begin != NULL;
   valid &= output.begin != NULL;
 
+  // Test joints range.
+  valid &= from >= 0;
+  valid &= from <= to;
+
   const int num_joints = skeleton->num_joints();
+
+  // Test subtree restrictions.
+  valid &= (root >= 0 && root < num_joints) ||
+           root == Skeleton::kNoParentIndex;
+  valid &= dirty.begin == NULL ||
+           dirty.end - dirty.begin >= (num_joints + 31) / 32;
+
   const int num_soa_joints = (num_joints + 3) / 4;
 
   // Test input and output ranges, implicitly tests for NULL end pointers.
@@ -896,16 +2139,21 @@ bool LocalToModelJob::Run() const {
     return false;
   }
 
-  // Early out if no joint.
-  const int num_joints = skeleton->num_joints();
-  if (num_joints == 0) {
-    return true;
-  }
-
   // Fetch joint's properties.
   Range<const Skeleton::JointProperties> properties =
     skeleton->joint_properties();
 
+  // Early out if no joint to process. A leaf root subtree is limited to the
+  // root itself.
+  int end = math::Min(to, skeleton->num_joints());
+  if (dirty.begin == NULL && root != Skeleton::kNoParentIndex &&
+      properties.begin[root].is_leaf) {
+    end = math::Min(end, root + 1);
+  }
+  if (from >= end) {
+    return true;
+  }
+
   // Output.
   Float4x4* const model_matrices = output.begin;
 
@@ -913,22 +2161,74 @@ bool LocalToModelJob::Run() const {
   // matrices without requiring a branch.
   const Float4x4 identity = Float4x4::identity();
 
+  // When the job is restricted to subtrees, a joint is updated if it's the
+  // root, if it's dirty or if one of its ancestors is. Joints preceding the
+  // first one that can be updated are skipped. Flags are computed for the
+  // joints of the current soa element only, so no storage depends on the
+  // number of joints.
+  const bool partial = root != Skeleton::kNoParentIndex || dirty.begin != NULL;
+  const int first = dirty.begin != NULL ? 0 : root;
+  const int begin = partial ? math::Max(from, first) : from;
+
+  // Local soa matrices of the next soa element, built along with the current
+  // ones using 8 wide simd.
+  SoaFloat4x4 next_soa_matrices;
+  int next_soa = -1;
+  const int end_soa = (end + 3) / 4;
+
   // Converts to matrices and applies hierarchical transformation.
-  for (int joint = 0; joint < num_joints;) {
-    // Builds soa matrices from soa transforms.
-    const SoaTransform& transform = input.begin[joint / 4];
-    const SoaFloat4x4 local_soa_matrices =
-      SoaFloat4x4::FromAffine(transform.translation,
-                              transform.rotation,
-                              transform.scale);
+  for (int joint = begin; joint < end;) {
+    // Skips soa elements that have no joint to update.
+    const int proceed_up_to = math::Min((joint + 4) & ~3, end);
+    bool updated[4] = {true, true, true, true};
+    if (partial) {
+      bool any = false;
+      for (int i = joint; i < proceed_up_to; ++i) {
+        updated[i & 3] =
+          IsUpdated(properties.begin, root, dirty.begin, first, i);
+        any |= updated[i & 3];
+      }
+      if (!any) {
+        joint = proceed_up_to;
+        continue;
+      }
+    }
+
+    // Builds soa matrices from soa transforms, two soa elements at once
+    // whenever the next one is in the range.
+    const int soa = joint / 4;
+    SoaFloat4x4 local_soa_matrices;
+    if (soa == next_soa) {
+      local_soa_matrices = next_soa_matrices;
+    } else if (soa + 1 < end_soa) {
+      const math::WideSoaTransform transforms =
+        math::WideSoaTransform::Load(input.begin[soa], input.begin[soa + 1]);
+      const math::WideSoaFloat4x4 wide_soa_matrices =
+        math::WideSoaFloat4x4::FromAffine(transforms.translation,
+                                          transforms.rotation,
+                                          transforms.scale);
+      local_soa_matrices = math::GetLow(wide_soa_matrices);
+      next_soa_matrices = math::GetHigh(wide_soa_matrices);
+      next_soa = soa + 1;
+    } else {
+      const SoaTransform& transform = input.begin[soa];
+      local_soa_matrices = SoaFloat4x4::FromAffine(transform.translation,
+                                                   transform.rotation,
+                                                   transform.scale);
+    }
     // Converts to aos matrices.
     math::SimdFloat4 local_aos_matrices[16];
     math::Transpose16x16(&local_soa_matrices.cols[0].x, local_aos_matrices);
 
-    // Applies hierarchical transformation.
-    const int proceed_up_to = joint + math::Min(4, num_joints - joint);
-    const math::SimdFloat4* local_aos_matrix = local_aos_matrices;
+    // Applies hierarchical transformation, up to the end of the soa element or
+    // of the range. Only the first soa element of the range can start with an
+    // offset.
+    const math::SimdFloat4* local_aos_matrix =
+      local_aos_matrices + (joint & 3) * 4;
     for (; joint < proceed_up_to; ++joint, local_aos_matrix += 4) {
+      if (!updated[joint & 3]) {
+        continue;
+      }
       const int parent = properties.begin[joint].parent;
       const Float4x4* parent_matrix =
         math::Select(parent == Skeleton::kNoParentIndex,
@@ -977,11 +2277,14 @@ bool LocalToModelJob::Run() const {
 
 #include "ozz/animation/runtime/sampling_job.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/math_constant.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/soa_wide.h"
 #include "ozz/base/memory/allocator.h"
 #include "ozz/animation/runtime/animation.h"
 
@@ -1066,6 +2369,27 @@ struct RotationKey {
   int16_t value[3];  // The quantized value of the 3 smallest components.
 };
 
+// Defines the packed rotation key frame type, an alternative to RotationKey
+// that requires 8 bytes per key instead of 12. It's selected per animation,
+// see Animation::RotationFormat.
+// Time is quantized on 16 bits, as a ratio of the animation duration (see
+// kQuantizedTimeMax). The 3 smallest components of the quaternion are quantized
+// to 11, 11 and 10 bits, packed in a single 32 bits value: bits [0:10] store
+// the first component, bits [11:21] the second and bits [22:31] the third.
+// Each component c, in range [-1/sqrt(2):1/sqrt(2)], is stored as the unsigned
+// integer round((c * sqrt(2) + 1) / 2 * (2^n - 1)), n being the number of bits.
+// Quantization error is then bounded to sqrt(2) / (2 * (2^n - 1)) per
+// component, that is 3.5e-4 for 11 bits components and 6.9e-4 for 10 bits
+// ones. Time quantization error is bounded to
+// duration / (2 * kQuantizedTimeMax).
+struct PackedRotationKey {
+  uint16_t time;  // Quantized time, as a ratio of the animation duration.
+  uint16_t track:13;  // The track this key frame belongs to.
+  uint16_t largest:2;  // The largest component of the quaternion.
+  uint16_t sign:1;  // The sign of the largest component. 1 for negative.
+  uint32_t value;  // The quantized value of the 3 smallest components.
+};
+
 // Defines the scale key frame type.
 // Scale values are stored as half precision floats with 16 bits per
 // component.
@@ -1074,6 +2398,57 @@ struct ScaleKey {
   uint16_t track;
   uint16_t value[3];
 };
+
+// Defines quantized time variants of translation, rotation and scale key frame
+// types, which require 10 bytes per key instead of 12. They are selected per
+// animation, see Animation::TimeFormat.
+// Time is quantized on 16 bits, as a ratio of the animation duration (see
+// kQuantizedTimeMax), with an error bounded to
+// duration / (2 * kQuantizedTimeMax). Values are stored the same way as
+// their float time counterparts.
+struct QuantizedTranslationKey {
+  uint16_t time;  // Quantized time, as a ratio of the animation duration.
+  uint16_t track;
+  uint16_t value[3];
+};
+
+struct QuantizedRotationKey {
+  uint16_t time;  // Quantized time, as a ratio of the animation duration.
+  uint16_t track:13;  // The track this key frame belongs to.
+  uint16_t largest:2;  // The largest component of the quaternion.
+  uint16_t sign:1;  // The sign of the largest component. 1 for negative.
+  int16_t value[3];  // The quantized value of the 3 smallest components.
+};
+
+struct QuantizedScaleKey {
+  uint16_t time;  // Quantized time, as a ratio of the animation duration.
+  uint16_t track;
+  uint16_t value[3];
+};
+
+// Defines constant track types. A track whose value never changes is stored
+// once as a constant, rather than as key frames (see
+// Animation::constant_translations()). Constant values are compressed the same
+// way as key frame values, track member being the joint index.
+struct ConstantTranslation {
+  uint16_t track;
+  uint16_t value[3];
+};
+
+struct ConstantRotation {
+  uint16_t track:13;  // The joint this constant belongs to.
+  uint16_t largest:2;  // The largest component of the quaternion.
+  uint16_t sign:1;  // The sign of the largest component. 1 for negative.
+  int16_t value[3];  // The quantized value of the 3 smallest components.
+};
+
+struct ConstantScale {
+  uint16_t track;
+  uint16_t value[3];
+};
+
+// Maximum value of a quantized time, matching animation duration.
+const float kQuantizedTimeMax = 65535.f;
 }  // animation
 }  // ozz
 #endif  // OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
@@ -1116,6 +2491,14 @@ bool SamplingJob::Validate() const {
   // Tests cache size.
   valid &= cache->max_soa_tracks() >= num_soa_tracks;
 
+  // Tests optional soa joints mask size, one bit per soa joint.
+  if (soa_joints_mask.begin) {
+    valid &= soa_joints_mask.end - soa_joints_mask.begin >=
+             (num_soa_tracks + 7) / 8;
+  } else {
+    valid &= soa_joints_mask.end == NULL;
+  }
+
   return valid;
 }
 
@@ -1185,15 +2568,99 @@ void UpdateKeys(float _time, int _num_soa_tracks,
     *_cursor = static_cast<int>(cursor - _keys.begin);
 }
 
+// Moves the cache to the seek point matching _time, if the cache isn't valid
+// for _time anymore (sampling backward) or if a seek point is ahead of the
+// current cursor (jumping forward). Only the tracks whose keys differ from the
+// restored ones are flagged as outdated. UpdateKeys is then responsible for
+// walking keys forward from the restored cursor.
+template<typename _Key>
+void SeekKeys(float _time, int _num_soa_tracks,
+              ozz::Range<const _Key> _keys,
+              const SeekTable& _table, int _interval,
+              int* _cursor,
+              int* _cache, unsigned char* _outdated) {
+  if (!*_cursor) {
+    return;  // The cache is invalid, it will be initialized by UpdateKeys.
+  }
+  const int num_tracks = _num_soa_tracks * 4;
+  const int first = num_tracks * 2;
+  const ptrdiff_t num_points = _table.times.Count();
+
+  // Cache is valid for _time if the previous key of the last processed key is
+  // before _time. In this case, there's no need to seek unless a seek point is
+  // reachable ahead of the cursor.
+  const int last = _keys.begin[*_cursor - 1].track * 2;
+  if (_keys.begin[_cache[last]].time <= _time) {
+    const int next = (*_cursor - first) / _interval;
+    if (next >= num_points || _table.times.begin[next] > _time) {
+      return;
+    }
+  }
+
+  // Finds the last seek point valid for _time.
+  const float* times = _table.times.begin;
+  const float* point = std::upper_bound(times, times + num_points, _time) - 1;
+  const int index = static_cast<int>(point - _table.times.begin);
+
+  // Restores cache entries, from the seek point or from the first keys if none
+  // is valid, and flag changed entries as outdated.
+  if (index >= 0) {
+    const int* state = _table.keys.begin + index * num_tracks * 2;
+    for (int i = 0; i < num_tracks; ++i) {
+      const int base = i * 2;
+      if (_cache[base] != state[base] || _cache[base + 1] != state[base + 1]) {
+        _cache[base] = state[base];
+        _cache[base + 1] = state[base + 1];
+        _outdated[i / 32] |= (1 << ((i & 0x1f) / 4));
+      }
+    }
+    *_cursor = first + (index + 1) * _interval;
+  } else {
+    for (int i = 0; i < num_tracks; ++i) {
+      const int base = i * 2;
+      if (_cache[base] != i || _cache[base + 1] != num_tracks + i) {
+        _cache[base] = i;
+        _cache[base + 1] = num_tracks + i;
+        _outdated[i / 32] |= (1 << ((i & 0x1f) / 4));
+      }
+    }
+    *_cursor = first;
+  }
+}
+
+// Loads the times of 4 keys to a SIMD vector, in seconds. Float times are
+// loaded as is.
+OZZ_INLINE math::SimdFloat4 LoadTimes(float _t0, float _t1, float _t2,
+                                      float _t3, float /*_time_scale*/) {
+  return math::simd_float4::Load(_t0, _t1, _t2, _t3);
+}
+
+// Quantized times are converted to float, then scaled to seconds.
+OZZ_INLINE math::SimdFloat4 LoadTimes(uint16_t _t0, uint16_t _t1,
+                                      uint16_t _t2, uint16_t _t3,
+                                      float _time_scale) {
+  return math::simd_float4::Load1(_time_scale) * math::simd_float4::FromInt(
+    math::simd_int4::Load(_t0, _t1, _t2, _t3));
+}
+
+// Decompresses translation keys of type _Key, which is TranslationKey or
+// QuantizedTranslationKey. _time_scale converts quantized times to seconds.
+template<typename _Key>
 void UpdateSoaTranslations(int _num_soa_tracks,
-                           ozz::Range<const TranslationKey> _keys,
+                           ozz::Range<const _Key> _keys,
+                           float _time_scale,
                            const int* _interp,
                            unsigned char* _outdated,
+                           const unsigned char* _mask,
                            internal::InterpSoaTranslation* soa_translations_) {
   const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
   for (int j = 0; j < num_outdated_flags; ++j) {
+    // Only processes entries enabled by _mask, if any. Others stay outdated.
     unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+    if (_mask) {
+      outdated &= _mask[j];
+    }
+    _outdated[j] &= ~outdated;  // Reset outdated entries that are processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
@@ -1201,12 +2668,12 @@ void UpdateSoaTranslations(int _num_soa_tracks,
       const int base = i * 4 * 2;  // * soa size * 2 keys
 
       // Decompress left side keyframes and store them in soa structures.
-      const TranslationKey& k00 = _keys.begin[_interp[base + 0]];
-      const TranslationKey& k10 = _keys.begin[_interp[base + 2]];
-      const TranslationKey& k20 = _keys.begin[_interp[base + 4]];
-      const TranslationKey& k30 = _keys.begin[_interp[base + 6]];
-      soa_translations_[i].time[0] = math::simd_float4::Load(
-        k00.time, k10.time, k20.time, k30.time);
+      const _Key& k00 = _keys.begin[_interp[base + 0]];
+      const _Key& k10 = _keys.begin[_interp[base + 2]];
+      const _Key& k20 = _keys.begin[_interp[base + 4]];
+      const _Key& k30 = _keys.begin[_interp[base + 6]];
+      soa_translations_[i].time[0] = LoadTimes(
+        k00.time, k10.time, k20.time, k30.time, _time_scale);
       soa_translations_[i].value[0].x = math::HalfToFloat(math::simd_int4::Load(
         k00.value[0], k10.value[0], k20.value[0], k30.value[0]));
       soa_translations_[i].value[0].y = math::HalfToFloat(math::simd_int4::Load(
@@ -1215,12 +2682,12 @@ void UpdateSoaTranslations(int _num_soa_tracks,
         k00.value[2], k10.value[2], k20.value[2], k30.value[2]));
 
       // Decompress right side keyframes and store them in soa structures.
-      const TranslationKey& k01 = _keys.begin[_interp[base + 1]];
-      const TranslationKey& k11 = _keys.begin[_interp[base + 3]];
-      const TranslationKey& k21 = _keys.begin[_interp[base + 5]];
-      const TranslationKey& k31 = _keys.begin[_interp[base + 7]];
-      soa_translations_[i].time[1] = math::simd_float4::Load(
-        k01.time, k11.time, k21.time, k31.time);
+      const _Key& k01 = _keys.begin[_interp[base + 1]];
+      const _Key& k11 = _keys.begin[_interp[base + 3]];
+      const _Key& k21 = _keys.begin[_interp[base + 5]];
+      const _Key& k31 = _keys.begin[_interp[base + 7]];
+      soa_translations_[i].time[1] = LoadTimes(
+        k01.time, k11.time, k21.time, k31.time, _time_scale);
       soa_translations_[i].value[1].x = math::HalfToFloat(math::simd_int4::Load(
         k01.value[0], k11.value[0], k21.value[0], k31.value[0]));
       soa_translations_[i].value[1].y = math::HalfToFloat(math::simd_int4::Load(
@@ -1282,10 +2749,15 @@ void UpdateSoaTranslations(int _num_soa_tracks,
   _quat.x = cpnt[0]; _quat.y = cpnt[1]; _quat.z = cpnt[2]; _quat.w = cpnt[3];\
 }
 
+// Decompresses rotation keys of type _Key, which is RotationKey or
+// QuantizedRotationKey. _time_scale converts quantized times to seconds.
+template<typename _Key>
 void UpdateSoaRotations(int _num_soa_tracks,
-                        ozz::Range<const RotationKey> _keys,
+                        ozz::Range<const _Key> _keys,
+                        float _time_scale,
                         const int* _interp,
                         unsigned char* _outdated,
+                        const unsigned char* _mask,
                         internal::InterpSoaRotation* _soa_rotations) {
 
   // Prepares constants.
@@ -1306,8 +2778,12 @@ void UpdateSoaRotations(int _num_soa_tracks,
 
   const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
   for (int j = 0; j < num_outdated_flags; ++j) {
+    // Only processes entries enabled by _mask, if any. Others stay outdated.
     unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+    if (_mask) {
+      outdated &= _mask[j];
+    }
+    _outdated[j] &= ~outdated;  // Reset outdated entries that are processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
@@ -1317,26 +2793,26 @@ void UpdateSoaRotations(int _num_soa_tracks,
 
       // Decompress left side keyframes and store them in soa structures.
       {
-        const RotationKey& k0 = _keys.begin[_interp[base + 0]];
-        const RotationKey& k1 = _keys.begin[_interp[base + 2]];
-        const RotationKey& k2 = _keys.begin[_interp[base + 4]];
-        const RotationKey& k3 = _keys.begin[_interp[base + 6]];
+        const _Key& k0 = _keys.begin[_interp[base + 0]];
+        const _Key& k1 = _keys.begin[_interp[base + 2]];
+        const _Key& k2 = _keys.begin[_interp[base + 4]];
+        const _Key& k3 = _keys.begin[_interp[base + 6]];
 
         _soa_rotations[i].time[0] =
-          math::simd_float4::Load(k0.time, k1.time, k2.time, k3.time);
+          LoadTimes(k0.time, k1.time, k2.time, k3.time, _time_scale);
         math::SoaQuaternion& quat = _soa_rotations[i].value[0];
         DECOMPRESS_SOA_QUAT(k0, k1, k2, k3, quat);
       }
 
       // Decompress right side keyframes and store them in soa structures.
       {
-        const RotationKey& k0 = _keys.begin[_interp[base + 1]];
-        const RotationKey& k1 = _keys.begin[_interp[base + 3]];
-        const RotationKey& k2 = _keys.begin[_interp[base + 5]];
-        const RotationKey& k3 = _keys.begin[_interp[base + 7]];
+        const _Key& k0 = _keys.begin[_interp[base + 1]];
+        const _Key& k1 = _keys.begin[_interp[base + 3]];
+        const _Key& k2 = _keys.begin[_interp[base + 5]];
+        const _Key& k3 = _keys.begin[_interp[base + 7]];
 
         _soa_rotations[i].time[1] =
-          math::simd_float4::Load(k0.time, k1.time, k2.time, k3.time);
+          LoadTimes(k0.time, k1.time, k2.time, k3.time, _time_scale);
         math::SoaQuaternion& quat = _soa_rotations[i].value[1];
         DECOMPRESS_SOA_QUAT(k0, k1, k2, k3, quat);
       }
@@ -1344,17 +2820,319 @@ void UpdateSoaRotations(int _num_soa_tracks,
   }
 }
 
+// Sets lane _lane of _dest soa value to lane _src_lane of _src, which stores
+// a soa value components.
+OZZ_INLINE void SetLane(math::SoaFloat3* _dest, int _lane,
+                        const float (*_src)[4], int _src_lane) {
+  _dest->x = math::SetI(_dest->x, _lane, _src[0][_src_lane]);
+  _dest->y = math::SetI(_dest->y, _lane, _src[1][_src_lane]);
+  _dest->z = math::SetI(_dest->z, _lane, _src[2][_src_lane]);
+}
+
+OZZ_INLINE void SetLane(math::SoaQuaternion* _dest, int _lane,
+                        const float (*_src)[4], int _src_lane) {
+  _dest->x = math::SetI(_dest->x, _lane, _src[0][_src_lane]);
+  _dest->y = math::SetI(_dest->y, _lane, _src[1][_src_lane]);
+  _dest->z = math::SetI(_dest->z, _lane, _src[2][_src_lane]);
+  _dest->w = math::SetI(_dest->w, _lane, _src[3][_src_lane]);
+}
+
+// Stores soa value _value components to _dest.
+OZZ_INLINE void StoreLanes(const math::SoaFloat3& _value, float (*_dest)[4]) {
+  math::StorePtr(_value.x, _dest[0]);
+  math::StorePtr(_value.y, _dest[1]);
+  math::StorePtr(_value.z, _dest[2]);
+}
+
+OZZ_INLINE void StoreLanes(const math::SoaQuaternion& _value,
+                           float (*_dest)[4]) {
+  math::StorePtr(_value.x, _dest[0]);
+  math::StorePtr(_value.y, _dest[1]);
+  math::StorePtr(_value.z, _dest[2]);
+  math::StorePtr(_value.w, _dest[3]);
+}
+
+// Defines the joints to output when sampling: the range [begin,end[, where
+// begin is a multiple of 4 and output buffer stores joints from begin. If mask
+// isn't NULL, only the soa joints whose bit is set are output.
+struct JointFilter {
+  // Tests if _joint shall be output.
+  bool Contains(int _joint) const {
+    if (_joint < begin || _joint >= end) {
+      return false;
+    }
+    return !mask || (mask[_joint / 32] & (1 << ((_joint / 4) & 7))) != 0;
+  }
+
+  // Tests if any of the _count first _joints shall be output.
+  bool ContainsAny(const uint16_t* _joints, int _count) const {
+    for (int i = 0; i < _count; ++i) {
+      if (Contains(_joints[i])) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  int begin;
+  int end;
+  const unsigned char* mask;
+};
+
+// Scatters the _count first lanes of _value to _output joints _joints, _member
+// selecting the transform component. Joints outside of _filter are skipped.
+template<typename _Soa>
+void ScatterSoa(const _Soa& _value, const uint16_t* _joints, int _count,
+                _Soa math::SoaTransform::*_member,
+                const JointFilter& _filter,
+                math::SoaTransform* _output) {
+  OZZ_ALIGN(16) float values[4][4];
+  StoreLanes(_value, values);
+  for (int i = 0; i < _count; ++i) {
+    const int joint = _joints[i];
+    if (!_filter.Contains(joint)) {
+      continue;
+    }
+    const int index = (joint - _filter.begin) / 4;
+    SetLane(&(_output[index].*_member), joint & 3, values, i);
+  }
+}
+
+// Compares a constant track to a joint index, to search sorted constants.
+struct ConstantLess {
+  template<typename _Constant>
+  bool operator()(const _Constant& _constant, int _joint) const {
+    return _constant.track < _joint;
+  }
+};
+
+// Finds the constants of _constants, sorted by joint index, that belong to
+// _filter range.
+template<typename _Constant>
+ozz::Range<const _Constant> FindConstants(
+  ozz::Range<const _Constant> _constants, const JointFilter& _filter) {
+  const _Constant* begin = std::lower_bound(
+    _constants.begin, _constants.end, _filter.begin, ConstantLess());
+  const _Constant* end =
+    std::lower_bound(begin, _constants.end, _filter.end, ConstantLess());
+  return ozz::Range<const _Constant>(begin, end);
+}
+
+// Finds the range [*_first,*_last[ of animated soa tracks that contains all
+// the joints of _filter range. _tracks are sorted in ascending order.
+void FindSoaTracks(ozz::Range<const uint16_t> _tracks,
+                   const JointFilter& _filter,
+                   int* _first, int* _last) {
+  const uint16_t* begin =
+    std::lower_bound(_tracks.begin, _tracks.end, _filter.begin);
+  const uint16_t* end = std::lower_bound(begin, _tracks.end, _filter.end);
+  *_first = static_cast<int>(begin - _tracks.begin) / 4;
+  *_last = static_cast<int>(end - _tracks.begin + 3) / 4;
+}
+
+// Decompresses constant translations or scales, 4 at a time, and stores them
+// to their joints in _output. Constants that _filter masks out are skipped.
+template<typename _Constant>
+void StoreConstants(ozz::Range<const _Constant> _constants,
+                    math::SoaFloat3 math::SoaTransform::*_member,
+                    const JointFilter& _filter,
+                    math::SoaTransform* _output) {
+  const int count = static_cast<int>(_constants.Count());
+  for (int i = 0; i < count; i += 4) {
+    // The last soa value is completed with the last constant.
+    const _Constant& c0 = _constants.begin[i];
+    const _Constant& c1 = _constants.begin[math::Min(i + 1, count - 1)];
+    const _Constant& c2 = _constants.begin[math::Min(i + 2, count - 1)];
+    const _Constant& c3 = _constants.begin[math::Min(i + 3, count - 1)];
+    const uint16_t joints[4] = {c0.track, c1.track, c2.track, c3.track};
+    if (_filter.mask && !_filter.ContainsAny(joints, math::Min(count - i, 4))) {
+      continue;
+    }
+    const math::SoaFloat3 value = {
+      math::HalfToFloat(math::simd_int4::Load(
+        c0.value[0], c1.value[0], c2.value[0], c3.value[0])),
+      math::HalfToFloat(math::simd_int4::Load(
+        c0.value[1], c1.value[1], c2.value[1], c3.value[1])),
+      math::HalfToFloat(math::simd_int4::Load(
+        c0.value[2], c1.value[2], c2.value[2], c3.value[2]))};
+    ScatterSoa(value, joints, math::Min(count - i, 4), _member, _filter,
+               _output);
+  }
+}
+
+// Decompresses constant rotations, 4 at a time, and stores them to their
+// joints in _output. Constants that _filter masks out are skipped.
+void StoreConstantRotations(ozz::Range<const ConstantRotation> _constants,
+                            const JointFilter& _filter,
+                            math::SoaTransform* _output) {
+  // Prepares constants, as required by DECOMPRESS_SOA_QUAT.
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 eps = math::simd_float4::Load1(1e-16f);
+  const math::SimdFloat4 kInt2Float =
+    math::simd_float4::Load1(1.f / (32767.f * math::kSqrt2));
+  const math::SimdInt4 mf000 = math::simd_int4::mask_f000();
+  const math::SimdInt4 m0f00 = math::simd_int4::mask_0f00();
+  const math::SimdInt4 m00f0 = math::simd_int4::mask_00f0();
+  const math::SimdInt4 m000f = math::simd_int4::mask_000f();
+  const int kCpntMapping[4][4] = {
+    {0, 0, 1, 2}, {0, 0, 1, 2}, {0, 1, 0, 2}, {0, 1, 2, 0}
+  };
+
+  const int count = static_cast<int>(_constants.Count());
+  for (int i = 0; i < count; i += 4) {
+    // The last soa value is completed with the last constant.
+    const ConstantRotation& c0 = _constants.begin[i];
+    const ConstantRotation& c1 =
+      _constants.begin[math::Min(i + 1, count - 1)];
+    const ConstantRotation& c2 =
+      _constants.begin[math::Min(i + 2, count - 1)];
+    const ConstantRotation& c3 =
+      _constants.begin[math::Min(i + 3, count - 1)];
+    const uint16_t joints[4] = {c0.track, c1.track, c2.track, c3.track};
+    if (_filter.mask && !_filter.ContainsAny(joints, math::Min(count - i, 4))) {
+      continue;
+    }
+    math::SoaQuaternion value;
+    DECOMPRESS_SOA_QUAT(c0, c1, c2, c3, value);
+    ScatterSoa(value, joints, math::Min(count - i, 4),
+               &math::SoaTransform::rotation, _filter, _output);
+  }
+}
+
 #undef DECOMPRESS_SOA_QUAT
 
+// Decompresses 4 packed rotation keys to a SoA quaternion. Unlike standard
+// keys, the whole decompression happens in SIMD registers: the 3 smallest
+// components are extracted from the packed values with shifts and masks, and
+// the largest component is re-injected with selects instead of a mapping
+// table.
+OZZ_INLINE void DecompressSoaPackedQuat(const PackedRotationKey& _k0,
+                                        const PackedRotationKey& _k1,
+                                        const PackedRotationKey& _k2,
+                                        const PackedRotationKey& _k3,
+                                        math::SoaQuaternion* _quat) {
+  // Extracts the 3 quantized components, stored on 11, 11 and 10 bits.
+  const math::SimdInt4 value = math::simd_int4::Load(
+    static_cast<int>(_k0.value), static_cast<int>(_k1.value),
+    static_cast<int>(_k2.value), static_cast<int>(_k3.value));
+  const math::SimdInt4 mask11 =
+    math::simd_int4::Load(0x7ff, 0x7ff, 0x7ff, 0x7ff);
+  const math::SimdInt4 qa = math::And(value, mask11);
+  const math::SimdInt4 qb = math::And(math::ShiftRu(value, 11), mask11);
+  const math::SimdInt4 qc = math::ShiftRu(value, 22);
+
+  // Dequantizes components from [0:2^n-1] to [-1/sqrt(2):1/sqrt(2)].
+  const math::SimdFloat4 offset = math::simd_float4::Load1(-math::kSqrt2_2);
+  const math::SimdFloat4 scale11 =
+    math::simd_float4::Load1(math::kSqrt2 / 2047.f);
+  const math::SimdFloat4 scale10 =
+    math::simd_float4::Load1(math::kSqrt2 / 1023.f);
+  const math::SimdFloat4 a =
+    math::MAdd(math::simd_float4::FromInt(qa), scale11, offset);
+  const math::SimdFloat4 b =
+    math::MAdd(math::simd_float4::FromInt(qb), scale11, offset);
+  const math::SimdFloat4 c =
+    math::MAdd(math::simd_float4::FromInt(qc), scale10, offset);
+
+  // Get back length of the largest component. Favors performance over
+  // accuracy by using x * RSqrtEst(x) instead of Sqrt(x).
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 eps = math::simd_float4::Load1(1e-16f);
+  const math::SimdFloat4 dot = a * a + b * b + c * c;
+  const math::SimdFloat4 ww0 = math::Max(eps, one - dot);
+  const math::SimdFloat4 w0 = ww0 * math::RSqrtEst(ww0);
+  // Re-applies largest component's sign.
+  const math::SimdInt4 sign = math::ShiftL(
+    math::simd_int4::Load(_k0.sign, _k1.sign, _k2.sign, _k3.sign), 31);
+  const math::SimdFloat4 restored = math::Or(w0, sign);
+
+  // Re-injects the largest component, smallest components being stored in
+  // quaternion order.
+  const math::SimdInt4 largest = math::simd_int4::Load(
+    _k0.largest, _k1.largest, _k2.largest, _k3.largest);
+  const math::SimdInt4 l0 =
+    math::CmpEq(largest, math::simd_int4::Load(0, 0, 0, 0));
+  const math::SimdInt4 l1 =
+    math::CmpEq(largest, math::simd_int4::Load(1, 1, 1, 1));
+  const math::SimdInt4 l2 =
+    math::CmpEq(largest, math::simd_int4::Load(2, 2, 2, 2));
+  const math::SimdInt4 l3 =
+    math::CmpEq(largest, math::simd_int4::Load(3, 3, 3, 3));
+  _quat->x = math::Select(l0, restored, a);
+  _quat->y = math::Select(l0, a, math::Select(l1, restored, b));
+  _quat->z = math::Select(l3, c, math::Select(l2, restored, b));
+  _quat->w = math::Select(l3, restored, c);
+}
+
+// Decompresses packed rotation keys. _time_scale converts quantized times to
+// seconds.
+void UpdateSoaPackedRotations(int _num_soa_tracks,
+                              ozz::Range<const PackedRotationKey> _keys,
+                              float _time_scale,
+                              const int* _interp,
+                              unsigned char* _outdated,
+                              const unsigned char* _mask,
+                              internal::InterpSoaRotation* _soa_rotations) {
+  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
+  for (int j = 0; j < num_outdated_flags; ++j) {
+    // Only processes entries enabled by _mask, if any. Others stay outdated.
+    unsigned char outdated = _outdated[j];
+    if (_mask) {
+      outdated &= _mask[j];
+    }
+    _outdated[j] &= ~outdated;  // Reset outdated entries that are processed.
+    for (int i = j * 8; outdated; ++i, outdated >>= 1) {
+      if (!(outdated & 1)) {
+        continue;
+      }
+
+      const int base = i * 4 * 2;  // * soa size * 2 keys per track
+
+      // Decompress left side keyframes and store them in soa structures.
+      {
+        const PackedRotationKey& k0 = _keys.begin[_interp[base + 0]];
+        const PackedRotationKey& k1 = _keys.begin[_interp[base + 2]];
+        const PackedRotationKey& k2 = _keys.begin[_interp[base + 4]];
+        const PackedRotationKey& k3 = _keys.begin[_interp[base + 6]];
+
+        _soa_rotations[i].time[0] =
+          LoadTimes(k0.time, k1.time, k2.time, k3.time, _time_scale);
+        DecompressSoaPackedQuat(k0, k1, k2, k3, &_soa_rotations[i].value[0]);
+      }
+
+      // Decompress right side keyframes and store them in soa structures.
+      {
+        const PackedRotationKey& k0 = _keys.begin[_interp[base + 1]];
+        const PackedRotationKey& k1 = _keys.begin[_interp[base + 3]];
+        const PackedRotationKey& k2 = _keys.begin[_interp[base + 5]];
+        const PackedRotationKey& k3 = _keys.begin[_interp[base + 7]];
+
+        _soa_rotations[i].time[1] =
+          LoadTimes(k0.time, k1.time, k2.time, k3.time, _time_scale);
+        DecompressSoaPackedQuat(k0, k1, k2, k3, &_soa_rotations[i].value[1]);
+      }
+    }
+  }
+}
+
+// Decompresses scale keys of type _Key, which is ScaleKey or QuantizedScaleKey.
+// _time_scale converts quantized times to seconds.
+template<typename _Key>
 void UpdateSoaScales(int _num_soa_tracks,
-                     ozz::Range<const ScaleKey> _keys,
+                     ozz::Range<const _Key> _keys,
+                     float _time_scale,
                      const int* _interp,
                      unsigned char* _outdated,
+                     const unsigned char* _mask,
                      internal::InterpSoaScale* soa_scales_) {
   const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
   for (int j = 0; j < num_outdated_flags; ++j) {
+    // Only processes entries enabled by _mask, if any. Others stay outdated.
     unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+    if (_mask) {
+      outdated &= _mask[j];
+    }
+    _outdated[j] &= ~outdated;  // Reset outdated entries that are processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
@@ -1362,12 +3140,12 @@ void UpdateSoaScales(int _num_soa_tracks,
       const int base = i * 4 * 2;  // * soa size * 2 keys
 
       // Decompress left side keyframes and store them in soa structures.
-      const ScaleKey& k00 = _keys.begin[_interp[base + 0]];
-      const ScaleKey& k10 = _keys.begin[_interp[base + 2]];
-      const ScaleKey& k20 = _keys.begin[_interp[base + 4]];
-      const ScaleKey& k30 = _keys.begin[_interp[base + 6]];
-      soa_scales_[i].time[0] = math::simd_float4::Load(
-        k00.time, k10.time, k20.time, k30.time);
+      const _Key& k00 = _keys.begin[_interp[base + 0]];
+      const _Key& k10 = _keys.begin[_interp[base + 2]];
+      const _Key& k20 = _keys.begin[_interp[base + 4]];
+      const _Key& k30 = _keys.begin[_interp[base + 6]];
+      soa_scales_[i].time[0] = LoadTimes(
+        k00.time, k10.time, k20.time, k30.time, _time_scale);
       soa_scales_[i].value[0].x = math::HalfToFloat(math::simd_int4::Load(
         k00.value[0],k10.value[0], k20.value[0], k30.value[0]));
       soa_scales_[i].value[0].y = math::HalfToFloat(math::simd_int4::Load(
@@ -1376,12 +3154,12 @@ void UpdateSoaScales(int _num_soa_tracks,
         k00.value[2], k10.value[2], k20.value[2], k30.value[2]));
 
       // Decompress right side keyframes and store them in soa structures.
-      const ScaleKey& k01 = _keys.begin[_interp[base + 1]];
-      const ScaleKey& k11 = _keys.begin[_interp[base + 3]];
-      const ScaleKey& k21 = _keys.begin[_interp[base + 5]];
-      const ScaleKey& k31 = _keys.begin[_interp[base + 7]];
-      soa_scales_[i].time[1] = math::simd_float4::Load(
-        k01.time, k11.time, k21.time, k31.time);
+      const _Key& k01 = _keys.begin[_interp[base + 1]];
+      const _Key& k11 = _keys.begin[_interp[base + 3]];
+      const _Key& k21 = _keys.begin[_interp[base + 5]];
+      const _Key& k31 = _keys.begin[_interp[base + 7]];
+      soa_scales_[i].time[1] = LoadTimes(
+        k01.time, k11.time, k21.time, k31.time, _time_scale);
       soa_scales_[i].value[1].x = math::HalfToFloat(math::simd_int4::Load(
         k01.value[0], k11.value[0], k21.value[0], k31.value[0]));
       soa_scales_[i].value[1].y = math::HalfToFloat(math::simd_int4::Load(
@@ -1392,35 +3170,205 @@ void UpdateSoaScales(int _num_soa_tracks,
   }
 }
 
-void Interpolates(float _anim_time,
-                  int _num_soa_tracks,
+// Computes _tracks_mask, one bit per animated soa track of _tracks, set if any
+// of the soa track joints is enabled by _soa_joints_mask.
+void ComputeTracksMask(ozz::Range<const uint16_t> _tracks,
+                       const unsigned char* _soa_joints_mask,
+                       unsigned char* _tracks_mask) {
+  const int num_tracks = static_cast<int>(_tracks.Count());
+  memset(_tracks_mask, 0, ((num_tracks + 3) / 4 + 7) / 8);
+  for (int i = 0; i < num_tracks; ++i) {
+    const int soa_joint = _tracks.begin[i] / 4;
+    if (_soa_joints_mask[soa_joint / 8] & (1 << (soa_joint & 7))) {
+      const int soa_track = i / 4;
+      _tracks_mask[soa_track / 8] |= 1 << (soa_track & 7);
+    }
+  }
+}
+
+// Seeks and fetches _keys to the cache at _time, expressed in keys time unit,
+// then updates outdated soa hot values with _update_soa function. Only soa
+// entries enabled by _mask are updated, unless _mask is NULL.
+template<typename _Key, typename _Interp>
+void UpdateCache(float _time, int _num_soa_tracks,
+                 ozz::Range<const _Key> _keys,
+                 const SeekTable& _table, float _time_scale,
+                 int* _cursor, int* _cache, unsigned char* _outdated,
+                 const unsigned char* _mask,
+                 _Interp* _soa,
+                 void (*_update_soa)(int, ozz::Range<const _Key>, float,
+                                     const int*, unsigned char*,
+                                     const unsigned char*, _Interp*)) {
+  if (_num_soa_tracks == 0) {
+    return;  // All tracks are constant.
+  }
+  SeekKeys(_time, _num_soa_tracks, _keys, _table, _table.interval,
+           _cursor, _cache, _outdated);
+  UpdateKeys(_time, _num_soa_tracks, _keys, _cursor, _cache, _outdated);
+  _update_soa(_num_soa_tracks, _keys, _time_scale, _cache, _outdated, _mask,
+              _soa);
+}
+
+// Stores _value, the soa value of animated tracks [_index * 4, _index * 4 + 4[,
+// to their joints of _filter in _output, _member selecting the transform
+// component. The whole soa value is stored at once if these tracks are the 4
+// joints of an output soa element, which is always the case if there's no
+// constant track.
+template<typename _Soa>
+OZZ_INLINE void StoreAnimated(const _Soa& _value, int _index,
+                              ozz::Range<const uint16_t> _tracks,
+                              _Soa math::SoaTransform::*_member,
+                              const JointFilter& _filter,
+                              math::SoaTransform* _output) {
+  const int first = _index * 4;
+  const int count = static_cast<int>(_tracks.Count()) - first;
+  const uint16_t* joints = _tracks.begin + first;
+  if (count >= 4 && (joints[0] & 3) == 0 && joints[3] == joints[0] + 3 &&
+      _filter.Contains(joints[0])) {
+    _output[(joints[0] - _filter.begin) / 4].*_member = _value;
+  } else {
+    ScatterSoa(_value, joints, math::Min(count, 4), _member, _filter, _output);
+  }
+}
+
+// Tests if animated soa track _index has any joint that _filter outputs. Soa
+// tracks that are masked out aren't interpolated, nor decompressed.
+OZZ_INLINE bool IsSoaTrackEnabled(int _index,
+                                  ozz::Range<const uint16_t> _tracks,
+                                  const JointFilter& _filter) {
+  if (!_filter.mask) {
+    return true;  // FindSoaTracks already restricted tracks to the range.
+  }
+  const int first = _index * 4;
+  const int count = static_cast<int>(_tracks.Count()) - first;
+  return _filter.ContainsAny(_tracks.begin + first, math::Min(count, 4));
+}
+
+// Computes the interpolation ratio of two consecutive soa tracks _lo and _hi
+// at once.
+template <typename _Interp>
+OZZ_INLINE math::SimdFloat8 WideInterpRatio(const _Interp& _lo,
+                                            const _Interp& _hi,
+                                            math::_SimdFloat8 _time) {
+  const math::SimdFloat8 time0 =
+    math::simd_float8::Load(_lo.time[0], _hi.time[0]);
+  const math::SimdFloat8 time1 =
+    math::simd_float8::Load(_lo.time[1], _hi.time[1]);
+  return (_time - time0) * math::RcpEst(time1 - time0);
+}
+
+// Interpolates soa hot data at _anim_time, and stores the joints of _filter to
+// _output. Only animated soa tracks that contain joints of _filter are
+// interpolated.
+void Interpolates(const Animation& _animation,
+                  float _anim_time,
                   const internal::InterpSoaTranslation* _translations,
                   const internal::InterpSoaRotation* _rotations,
                   const internal::InterpSoaScale* _scales,
+                  const JointFilter& _filter,
                   math::SoaTransform* _output) {
-    const math::SimdFloat4 anim_time = math::simd_float4::Load1(_anim_time);
-    for (int i = 0; i < _num_soa_tracks; ++i) {
-      // Prepares interpolation coefficients.
-      const math::SimdFloat4 interp_t_time =
-        (anim_time - _translations[i].time[0]) *
-        math::RcpEst(_translations[i].time[1] - _translations[i].time[0]);
-      const math::SimdFloat4 interp_r_time =
-        (anim_time - _rotations[i].time[0]) *
-        math::RcpEst(_rotations[i].time[1] - _rotations[i].time[0]);
-      const math::SimdFloat4 interp_s_time =
-        (anim_time - _scales[i].time[0]) *
-        math::RcpEst(_scales[i].time[1] - _scales[i].time[0]);
-
-      // Processes interpolations.
-      // The lerp of the rotation uses the shortest path, because opposed
-      // quaternions were negated during animation build stage (AnimationBuilder).
-      _output[i].translation = Lerp(
-        _translations[i].value[0], _translations[i].value[1], interp_t_time);
-      _output[i].rotation = NLerpEst(
-        _rotations[i].value[0], _rotations[i].value[1], interp_r_time);
-      _output[i].scale = Lerp(
-        _scales[i].value[0], _scales[i].value[1], interp_s_time);
+  const math::SimdFloat4 anim_time = math::simd_float4::Load1(_anim_time);
+  const math::SimdFloat8 wide_time = math::simd_float8::Load1(_anim_time);
+
+  // Processes interpolations of animated tracks. Soa tracks are interpolated
+  // by pairs with 8 wide simd, the last one (if any) with 4 wide simd.
+  int i, last;
+  FindSoaTracks(_animation.translation_tracks(), _filter, &i, &last);
+  for (; i < last - 1; i += 2) {
+    if (!IsSoaTrackEnabled(i, _animation.translation_tracks(), _filter) &&
+        !IsSoaTrackEnabled(i + 1, _animation.translation_tracks(), _filter)) {
+      continue;
+    }
+    const internal::InterpSoaTranslation* interp = _translations + i;
+    const math::WideSoaFloat3 value = Lerp(
+      math::WideSoaFloat3::Load(interp[0].value[0], interp[1].value[0]),
+      math::WideSoaFloat3::Load(interp[0].value[1], interp[1].value[1]),
+      WideInterpRatio(interp[0], interp[1], wide_time));
+    StoreAnimated(GetLow(value), i, _animation.translation_tracks(),
+                  &math::SoaTransform::translation, _filter, _output);
+    StoreAnimated(GetHigh(value), i + 1, _animation.translation_tracks(),
+                  &math::SoaTransform::translation, _filter, _output);
+  }
+  for (; i < last; ++i) {
+    if (!IsSoaTrackEnabled(i, _animation.translation_tracks(), _filter)) {
+      continue;
     }
+    const math::SimdFloat4 interp_time =
+      (anim_time - _translations[i].time[0]) *
+      math::RcpEst(_translations[i].time[1] - _translations[i].time[0]);
+    StoreAnimated(
+      Lerp(_translations[i].value[0], _translations[i].value[1], interp_time),
+      i, _animation.translation_tracks(), &math::SoaTransform::translation,
+      _filter, _output);
+  }
+
+  // The lerp of the rotation uses the shortest path, because opposed
+  // quaternions were negated during animation build stage (AnimationBuilder).
+  FindSoaTracks(_animation.rotation_tracks(), _filter, &i, &last);
+  for (; i < last - 1; i += 2) {
+    if (!IsSoaTrackEnabled(i, _animation.rotation_tracks(), _filter) &&
+        !IsSoaTrackEnabled(i + 1, _animation.rotation_tracks(), _filter)) {
+      continue;
+    }
+    const internal::InterpSoaRotation* interp = _rotations + i;
+    const math::WideSoaQuaternion value = NLerpEst(
+      math::WideSoaQuaternion::Load(interp[0].value[0], interp[1].value[0]),
+      math::WideSoaQuaternion::Load(interp[0].value[1], interp[1].value[1]),
+      WideInterpRatio(interp[0], interp[1], wide_time));
+    StoreAnimated(GetLow(value), i, _animation.rotation_tracks(),
+                  &math::SoaTransform::rotation, _filter, _output);
+    StoreAnimated(GetHigh(value), i + 1, _animation.rotation_tracks(),
+                  &math::SoaTransform::rotation, _filter, _output);
+  }
+  for (; i < last; ++i) {
+    if (!IsSoaTrackEnabled(i, _animation.rotation_tracks(), _filter)) {
+      continue;
+    }
+    const math::SimdFloat4 interp_time =
+      (anim_time - _rotations[i].time[0]) *
+      math::RcpEst(_rotations[i].time[1] - _rotations[i].time[0]);
+    StoreAnimated(
+      NLerpEst(_rotations[i].value[0], _rotations[i].value[1], interp_time),
+      i, _animation.rotation_tracks(), &math::SoaTransform::rotation,
+      _filter, _output);
+  }
+
+  FindSoaTracks(_animation.scale_tracks(), _filter, &i, &last);
+  for (; i < last - 1; i += 2) {
+    if (!IsSoaTrackEnabled(i, _animation.scale_tracks(), _filter) &&
+        !IsSoaTrackEnabled(i + 1, _animation.scale_tracks(), _filter)) {
+      continue;
+    }
+    const internal::InterpSoaScale* interp = _scales + i;
+    const math::WideSoaFloat3 value = Lerp(
+      math::WideSoaFloat3::Load(interp[0].value[0], interp[1].value[0]),
+      math::WideSoaFloat3::Load(interp[0].value[1], interp[1].value[1]),
+      WideInterpRatio(interp[0], interp[1], wide_time));
+    StoreAnimated(GetLow(value), i, _animation.scale_tracks(),
+                  &math::SoaTransform::scale, _filter, _output);
+    StoreAnimated(GetHigh(value), i + 1, _animation.scale_tracks(),
+                  &math::SoaTransform::scale, _filter, _output);
+  }
+  for (; i < last; ++i) {
+    if (!IsSoaTrackEnabled(i, _animation.scale_tracks(), _filter)) {
+      continue;
+    }
+    const math::SimdFloat4 interp_time =
+      (anim_time - _scales[i].time[0]) *
+      math::RcpEst(_scales[i].time[1] - _scales[i].time[0]);
+    StoreAnimated(
+      Lerp(_scales[i].value[0], _scales[i].value[1], interp_time),
+      i, _animation.scale_tracks(), &math::SoaTransform::scale,
+      _filter, _output);
+  }
+
+  // Constant tracks values are stored without interpolation.
+  StoreConstants(FindConstants(_animation.constant_translations(), _filter),
+                 &math::SoaTransform::translation, _filter, _output);
+  StoreConstantRotations(
+    FindConstants(_animation.constant_rotations(), _filter), _filter, _output);
+  StoreConstants(FindConstants(_animation.constant_scales(), _filter),
+                 &math::SoaTransform::scale, _filter, _output);
 }
 }  // namespace
 
@@ -1443,59 +3391,93 @@ bool SamplingJob::Run() const {
   // Clamps time in range [0,duration].
   const float anim_time = math::Clamp(0.f, time, animation->duration());
 
-  // Step the cache to this potentially new animation and time.
+  // Step the cache to this potentially new animation, then seeks and fetches
+  // key frames at anim_time, and updates outdated soa hot values.
   assert(cache->max_soa_tracks() >= num_soa_tracks);
-  cache->Step(*animation, anim_time);
-
-  // Fetch key frames from the animation to the cache a t = anim_time.
-  // Then updates outdated soa hot values.
-  UpdateKeys(anim_time, num_soa_tracks,
-             animation->translations(),
-             &cache->translation_cursor_,
-             cache->translation_keys_,
-             cache->outdated_translations_);
-  UpdateSoaTranslations(num_soa_tracks,
-                        animation->translations(),
-                        cache->translation_keys_,
-                        cache->outdated_translations_,
-                        cache->soa_translations_);
-
-  UpdateKeys(anim_time, num_soa_tracks,
-             animation->rotations(),
-             &cache->rotation_cursor_,
-             cache->rotation_keys_,
-             cache->outdated_rotations_);
-  UpdateSoaRotations(num_soa_tracks,
-                     animation->rotations(),
-                     cache->rotation_keys_,
-                     cache->outdated_rotations_,
-                     cache->soa_rotations_);
-
-  UpdateKeys(anim_time, num_soa_tracks,
-             animation->scales(),
-             &cache->scale_cursor_,
-             cache->scale_keys_,
-             cache->outdated_scales_);
-  UpdateSoaScales(num_soa_tracks,
-                  animation->scales(),
-                  cache->scale_keys_,
-                  cache->outdated_scales_,
-                  cache->soa_scales_);
+  cache->Step(*animation);
+  cache->Update(*animation, anim_time, soa_joints_mask.begin);
 
   // Interpolates soa hot data.
-  Interpolates(anim_time,
-               num_soa_tracks,
-               cache->soa_translations_,
-               cache->soa_rotations_,
-               cache->soa_scales_,
-               output.begin);
+  cache->Interpolate(*animation, anim_time, 0, num_soa_tracks,
+                     soa_joints_mask.begin, output.begin);
+
+  return true;
+}
+
+BatchSamplingJob::Instance::Instance()
+    : time(0.f) {
+}
+
+BatchSamplingJob::BatchSamplingJob()
+    : animation(NULL),
+      cache(NULL) {
+}
+
+bool BatchSamplingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL pointers.
+  if (!animation || !cache) {
+    return false;
+  }
+
+  // Tests instances range, implicitly tests instances.end != NULL.
+  valid &= instances.begin != NULL;
+  valid &= instances.begin <= instances.end;
+
+  // Tests cache size.
+  const ptrdiff_t num_soa_tracks = animation->num_soa_tracks();
+  valid &= cache->max_soa_tracks() >= num_soa_tracks;
+
+  // Tests each instance output range.
+  if (valid) {
+    for (const Instance* instance = instances.begin;
+         instance < instances.end;
+         ++instance) {
+      valid &= instance->output.begin != NULL;
+      valid &= instance->output.end - instance->output.begin >= num_soa_tracks;
+    }
+  }
+
+  return valid;
+}
+
+bool BatchSamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+  if (num_soa_tracks == 0) {  // Early out if animation contains no joint.
+    return true;
+  }
+
+  assert(cache->max_soa_tracks() >= num_soa_tracks);
+  for (const Instance* instance = instances.begin;
+       instance < instances.end;
+       ++instance) {
+    // Clamps time in range [0,duration].
+    const float anim_time =
+      math::Clamp(0.f, instance->time, animation->duration());
+
+    // Steps the shared cache to this instance time. Only entries whose key
+    // frames differ from the previous instance are decompressed again.
+    cache->Step(*animation);
+    cache->Update(*animation, anim_time, NULL);
+
+    // Interpolates soa hot data.
+    cache->Interpolate(*animation, anim_time, 0, num_soa_tracks, NULL,
+                       instance->output.begin);
+  }
 
   return true;
 }
 
 SamplingCache::SamplingCache(int _max_tracks)
     : animation_(NULL),
-    time_(0.f),
     max_soa_tracks_((_max_tracks + 3) / 4),
     soa_translations_(NULL),
     soa_rotations_(NULL),
@@ -1508,80 +3490,503 @@ SamplingCache::SamplingCache(int _max_tracks)
     scale_cursor_(0),
     outdated_translations_(NULL),
     outdated_rotations_(NULL),
-    outdated_scales_(NULL) {
+    outdated_scales_(NULL),
+    translations_mask_(NULL),
+    rotations_mask_(NULL),
+    scales_mask_(NULL) {
   using internal::InterpSoaTranslation;
   using internal::InterpSoaRotation;
   using internal::InterpSoaScale;
 
-  // Allocate all cache data at once in a single allocation.
-  // Alignment is guaranteed because memory is dispatch from the highest
-  // alignment requirement (Soa data: SimdFloat4) to the lowest (outdated
-  // flag: unsigned char).
+  // Allocate all cache data at once in a single allocation.
+  // Alignment is guaranteed because memory is dispatch from the highest
+  // alignment requirement (Soa data: SimdFloat4) to the lowest (outdated
+  // flag: unsigned char).
+
+  // Computes allocation size.
+  const size_t max_tracks = max_soa_tracks_ * 4;
+  const size_t num_outdated = (max_soa_tracks_ + 7) / 8;
+  const size_t size =
+    sizeof(InterpSoaTranslation) * max_soa_tracks_  +
+    sizeof(InterpSoaRotation) * max_soa_tracks_ +
+    sizeof(InterpSoaScale) *max_soa_tracks_ +
+    sizeof(int) * max_tracks * 2 * 3 +  // 2 keys * (trans + rot + scale).
+    sizeof(unsigned char) * 3 * num_outdated * 2;  // Outdated flags + masks.
+
+  // Allocates all at once.
+  memory::Allocator* allocator = memory::default_allocator();
+  char* alloc_begin = reinterpret_cast<char*>(
+    allocator->Allocate(size, OZZ_ALIGN_OF(InterpSoaTranslation)));
+  char* alloc_cursor = alloc_begin;
+
+  // Dispatches allocated memory, from the highest alignment requirement to the
+  // lowest.
+  soa_translations_ = reinterpret_cast<InterpSoaTranslation*>(alloc_cursor);
+  alloc_cursor += sizeof(InterpSoaTranslation) * max_soa_tracks_;
+  soa_rotations_ = reinterpret_cast<InterpSoaRotation*>(alloc_cursor);
+  alloc_cursor += sizeof(InterpSoaRotation) * max_soa_tracks_;
+  soa_scales_ = reinterpret_cast<InterpSoaScale*>(alloc_cursor);
+  alloc_cursor += sizeof(InterpSoaScale) * max_soa_tracks_;
+
+  translation_keys_ = reinterpret_cast<int*>(alloc_cursor);
+  alloc_cursor += sizeof(int) * max_tracks * 2;
+  rotation_keys_ = reinterpret_cast<int*>(alloc_cursor);
+  alloc_cursor += sizeof(int) * max_tracks * 2;
+  scale_keys_ = reinterpret_cast<int*>(alloc_cursor);
+  alloc_cursor += sizeof(int) * max_tracks * 2;
+
+  outdated_translations_ = reinterpret_cast<unsigned char*>(alloc_cursor);
+  alloc_cursor += sizeof(unsigned char) * num_outdated;
+  outdated_rotations_ = reinterpret_cast<unsigned char*>(alloc_cursor);
+  alloc_cursor += sizeof(unsigned char) * num_outdated;
+  outdated_scales_ = reinterpret_cast<unsigned char*>(alloc_cursor);
+  alloc_cursor += sizeof(unsigned char) * num_outdated;
+
+  translations_mask_ = reinterpret_cast<unsigned char*>(alloc_cursor);
+  alloc_cursor += sizeof(unsigned char) * num_outdated;
+  rotations_mask_ = reinterpret_cast<unsigned char*>(alloc_cursor);
+  alloc_cursor += sizeof(unsigned char) * num_outdated;
+  scales_mask_ = reinterpret_cast<unsigned char*>(alloc_cursor);
+  alloc_cursor += sizeof(unsigned char) * num_outdated;
+
+  assert(alloc_cursor == alloc_begin + size);
+}
+
+SamplingCache::~SamplingCache() {
+  // Deallocates everything at once.
+  memory::default_allocator()->Deallocate(soa_translations_);
+}
+
+void SamplingCache::Step(const Animation& _animation) {
+  // The cache is invalidated if animation has changed. Rewinding is handled
+  // by seeking keys during Update().
+  if (animation_ != &_animation) {
+    animation_ = &_animation;
+    translation_cursor_ = 0;
+    rotation_cursor_ = 0;
+    scale_cursor_ = 0;
+  }
+}
+
+void SamplingCache::Update(const Animation& _animation, float _time,
+                           const uint8_t* _soa_joints_mask) {
+  assert(max_soa_tracks_ >= _animation.num_soa_tracks());
+  const int num_soa_translations = _animation.num_soa_translation_tracks();
+  const int num_soa_rotations = _animation.num_soa_rotation_tracks();
+  const int num_soa_scales = _animation.num_soa_scale_tracks();
+
+  // Converts the soa joints mask to animated soa tracks masks. Key frames are
+  // still walked for all tracks, but only enabled ones are decompressed.
+  const unsigned char* translations_mask = NULL;
+  const unsigned char* rotations_mask = NULL;
+  const unsigned char* scales_mask = NULL;
+  if (_soa_joints_mask) {
+    ComputeTracksMask(_animation.translation_tracks(), _soa_joints_mask,
+                      translations_mask_);
+    ComputeTracksMask(_animation.rotation_tracks(), _soa_joints_mask,
+                      rotations_mask_);
+    ComputeTracksMask(_animation.scale_tracks(), _soa_joints_mask,
+                      scales_mask_);
+    translations_mask = translations_mask_;
+    rotations_mask = rotations_mask_;
+    scales_mask = scales_mask_;
+  }
+
+  // Quantized time keys and their seek tables are walked in quantized time
+  // unit, which is converted back to seconds by _time_scale.
+  const float duration = _animation.duration();
+  const float quantized_time =
+    duration > 0.f ? _time * (kQuantizedTimeMax / duration) : 0.f;
+  const float time_scale = duration / kQuantizedTimeMax;
+  const bool quantized = _animation.time_format() == Animation::kTimeQuantized;
+
+  // Seeks and fetches key frames from the animation to the cache at t = _time.
+  // Then updates outdated soa hot values.
+  if (quantized) {
+    UpdateCache(quantized_time, num_soa_translations,
+                _animation.quantized_translations(),
+                _animation.translations_seek_table(), time_scale,
+                &translation_cursor_, translation_keys_,
+                outdated_translations_, translations_mask, soa_translations_,
+                &UpdateSoaTranslations<QuantizedTranslationKey>);
+  } else {
+    UpdateCache(_time, num_soa_translations,
+                _animation.translations(),
+                _animation.translations_seek_table(), time_scale,
+                &translation_cursor_, translation_keys_,
+                outdated_translations_, translations_mask, soa_translations_,
+                &UpdateSoaTranslations<TranslationKey>);
+  }
+
+  if (_animation.rotation_format() == Animation::kRotationPacked) {
+    UpdateCache(quantized_time, num_soa_rotations,
+                _animation.packed_rotations(),
+                _animation.rotations_seek_table(), time_scale,
+                &rotation_cursor_, rotation_keys_,
+                outdated_rotations_, rotations_mask, soa_rotations_,
+                &UpdateSoaPackedRotations);
+  } else if (quantized) {
+    UpdateCache(quantized_time, num_soa_rotations,
+                _animation.quantized_rotations(),
+                _animation.rotations_seek_table(), time_scale,
+                &rotation_cursor_, rotation_keys_,
+                outdated_rotations_, rotations_mask, soa_rotations_,
+                &UpdateSoaRotations<QuantizedRotationKey>);
+  } else {
+    UpdateCache(_time, num_soa_rotations,
+                _animation.rotations(),
+                _animation.rotations_seek_table(), time_scale,
+                &rotation_cursor_, rotation_keys_,
+                outdated_rotations_, rotations_mask, soa_rotations_,
+                &UpdateSoaRotations<RotationKey>);
+  }
+
+  if (quantized) {
+    UpdateCache(quantized_time, num_soa_scales,
+                _animation.quantized_scales(),
+                _animation.scales_seek_table(), time_scale,
+                &scale_cursor_, scale_keys_,
+                outdated_scales_, scales_mask, soa_scales_,
+                &UpdateSoaScales<QuantizedScaleKey>);
+  } else {
+    UpdateCache(_time, num_soa_scales,
+                _animation.scales(),
+                _animation.scales_seek_table(), time_scale,
+                &scale_cursor_, scale_keys_,
+                outdated_scales_, scales_mask, soa_scales_,
+                &UpdateSoaScales<ScaleKey>);
+  }
+}
+
+void SamplingCache::Interpolate(const Animation& _animation, float _time,
+                                int _soa_begin, int _soa_end,
+                                const uint8_t* _soa_joints_mask,
+                                math::SoaTransform* _output) const {
+  assert(_soa_begin >= 0 && _soa_begin <= _soa_end &&
+         _soa_end <= _animation.num_soa_tracks());
+  const JointFilter filter = {_soa_begin * 4, _soa_end * 4, _soa_joints_mask};
+  Interpolates(_animation, _time, soa_translations_, soa_rotations_,
+               soa_scales_, filter, _output);
+}
+
+void SamplingCache::Invalidate() {
+  animation_ = NULL;
+  translation_cursor_ = 0;
+  rotation_cursor_ = 0;
+  scale_cursor_ = 0;
+}
+}  // animation
+}  // ozz
+
+// Including segmented_animation.cc file.
+
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/segmented_animation.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+
+#include <cstring>
+#include <cassert>
+
+namespace ozz {
+namespace animation {
+
+SegmentedAnimation::SegmentedAnimation()
+    : duration_(0.f),
+      segment_duration_(0.f),
+      num_tracks_(0),
+      name_(NULL),
+      stream_(NULL) {
+}
+
+SegmentedAnimation::~SegmentedAnimation() {
+  Deallocate();
+}
+
+void SegmentedAnimation::Allocate(size_t _name_len, size_t _num_segments) {
+  // Distributes buffer memory while ensuring proper alignment (serves larger
+  // alignment values first).
+  OZZ_STATIC_ASSERT(
+    OZZ_ALIGN_OF(Animation*) >= OZZ_ALIGN_OF(int) &&
+    OZZ_ALIGN_OF(int) >= OZZ_ALIGN_OF(char));
+
+  assert(name_ == NULL && segments_.Size() == 0 && offsets_.Size() == 0);
+
+  // Compute overall size and allocate a single buffer for all the data.
+  const size_t buffer_size =
+    (_name_len > 0 ? _name_len + 1 : 0) +
+    _num_segments * sizeof(Animation*) +
+    (_num_segments + 1) * sizeof(int);
+  char* buffer = memory::default_allocator()->Allocate<char>(buffer_size);
+
+  // Fix up pointers
+  segments_.begin = reinterpret_cast<Animation**>(buffer);
+  assert(math::IsAligned(segments_.begin, OZZ_ALIGN_OF(Animation*)));
+  buffer += _num_segments * sizeof(Animation*);
+  segments_.end = reinterpret_cast<Animation**>(buffer);
+
+  offsets_.begin = reinterpret_cast<int*>(buffer);
+  assert(math::IsAligned(offsets_.begin, OZZ_ALIGN_OF(int)));
+  buffer += (_num_segments + 1) * sizeof(int);
+  offsets_.end = reinterpret_cast<int*>(buffer);
+
+  // Let name be NULL if animation has no name.
+  name_ = reinterpret_cast<char*>(_name_len > 0 ? buffer : NULL);
+
+  // No segment is resident yet.
+  for (size_t i = 0; i < _num_segments; ++i) {
+    segments_.begin[i] = NULL;
+  }
+  for (size_t i = 0; i <= _num_segments; ++i) {
+    offsets_.begin[i] = 0;
+  }
+}
+
+void SegmentedAnimation::Deallocate() {
+  memory::Allocator* allocator = memory::default_allocator();
+  for (Animation** segment = segments_.begin;
+       segment < segments_.end;
+       ++segment) {
+    allocator->Delete(*segment);
+  }
+  allocator->Deallocate(segments_.begin);
+
+  name_ = NULL;
+  segments_ = ozz::Range<Animation*>();
+  offsets_ = ozz::Range<int>();
+  stream_ = NULL;
+}
+
+int SegmentedAnimation::segment_index(float _time) const {
+  const int num_segments = this->num_segments();
+  if (num_segments == 0) {
+    return 0;
+  }
+  const float time = math::Clamp(0.f, _time, duration_);
+  const int index = static_cast<int>(time / segment_duration_);
+  return math::Min(index, num_segments - 1);
+}
+
+const Animation* SegmentedAnimation::segment(int _index) const {
+  if (_index < 0 || _index >= num_segments()) {
+    return NULL;
+  }
+  return segments_.begin[_index];
+}
+
+const Animation* SegmentedAnimation::Resolve(float _time,
+                                             float* _segment_time) const {
+  assert(_segment_time);
+  const int index = segment_index(_time);
+  const float time = math::Clamp(0.f, _time, duration_);
+  *_segment_time = math::Max(0.f, time - index * segment_duration_);
+  return segment(index);
+}
+
+bool SegmentedAnimation::LoadSegment(int _index) {
+  if (segments_.begin[_index]) {
+    return true;  // Already resident.
+  }
+  // A truncated stream doesn't contain the whole segment data.
+  const int begin = offsets_.begin[_index];
+  const int end = offsets_.begin[_index + 1];
+  if (!stream_ || static_cast<int>(stream_->Size()) < end ||
+      stream_->Seek(begin, io::Stream::kSet)) {
+    return false;
+  }
+
+  // Every segment is stored as a standalone archive.
+  io::IArchive archive(stream_);
+  if (!archive.TestTag<Animation>()) {
+    return false;
+  }
+  Animation* segment = memory::default_allocator()->New<Animation>();
+  archive >> *segment;
+
+  // Rejects segments that couldn't be loaded (unsupported version, corrupted
+  // data...), or that don't match the animation. Slot remains empty.
+  if (stream_->Tell() != end ||
+      segment->num_tracks() != num_tracks_ ||
+      segment->duration() <= 0.f) {
+    memory::default_allocator()->Delete(segment);
+    return false;
+  }
+  segments_.begin[_index] = segment;
+  return true;
+}
+
+bool SegmentedAnimation::Update(float _time, int _look_ahead,
+                                bool* _streamed_out) {
+  if (_streamed_out) {
+    *_streamed_out = false;
+  }
+  const int num_segments = this->num_segments();
+  if (num_segments == 0) {
+    return true;
+  }
+  const int first = segment_index(_time);
+  const int last = math::Min(first + math::Max(_look_ahead, 0),
+                             num_segments - 1);
+
+  // Streams out segments that aren't required anymore, only if they can be
+  // streamed in again.
+  if (stream_) {
+    memory::Allocator* allocator = memory::default_allocator();
+    for (int i = 0; i < num_segments; ++i) {
+      if ((i < first || i > last) && segments_.begin[i]) {
+        allocator->Delete(segments_.begin[i]);
+        segments_.begin[i] = NULL;
+        if (_streamed_out) {
+          *_streamed_out = true;
+        }
+      }
+    }
+  }
+
+  // Streams in required segments.
+  bool success = true;
+  for (int i = first; i <= last; ++i) {
+    success &= LoadSegment(i);
+  }
+  return success;
+}
+
+size_t SegmentedAnimation::size() const {
+  size_t size = sizeof(*this) + segments_.Size() + offsets_.Size();
+  for (Animation** segment = segments_.begin;
+       segment < segments_.end;
+       ++segment) {
+    if (*segment) {
+      size += (*segment)->size();
+    }
+  }
+  return size;
+}
+
+void SegmentedAnimation::Save(ozz::io::OArchive& _archive) const {
+  _archive << duration_;
+  _archive << segment_duration_;
+  _archive << static_cast<int32_t>(num_tracks_);
 
-  // Computes allocation size.
-  const size_t max_tracks = max_soa_tracks_ * 4;
-  const size_t num_outdated = (max_soa_tracks_ + 7) / 8;
-  const size_t size =
-    sizeof(InterpSoaTranslation) * max_soa_tracks_  +
-    sizeof(InterpSoaRotation) * max_soa_tracks_ +
-    sizeof(InterpSoaScale) *max_soa_tracks_ +
-    sizeof(int) * max_tracks * 2 * 3 +  // 2 keys * (trans + rot + scale).
-    sizeof(unsigned char) * 3 * num_outdated;
+  const size_t name_len = name_ ? std::strlen(name_) : 0;
+  _archive << static_cast<int32_t>(name_len);
+  _archive << ozz::io::MakeArray(name_, name_len);
 
-  // Allocates all at once.
-  memory::Allocator* allocator = memory::default_allocator();
-  char* alloc_begin = reinterpret_cast<char*>(
-    allocator->Allocate(size, OZZ_ALIGN_OF(InterpSoaTranslation)));
-  char* alloc_cursor = alloc_begin;
+  // Every segment is written as a standalone archive (with the same
+  // endianness), so it can be loaded independently. Segments are first written
+  // to a memory stream in order to know their size.
+  const Endianness native = GetNativeEndianness();
+  const Endianness endianness = _archive.endian_swap() ?
+    (native == kLittleEndian ? kBigEndian : kLittleEndian) : native;
+  const int32_t num_segments = static_cast<int32_t>(segments_.Count());
+  _archive << num_segments;
+
+  ozz::io::MemoryStream segments_stream;
+  for (int i = 0; i < num_segments; ++i) {
+    assert(segments_.begin[i] && "Saving requires all segments to be resident");
+    const int begin = segments_stream.Tell();
+    ozz::io::OArchive archive(&segments_stream, endianness);
+    archive << *segments_.begin[i];
+    _archive << static_cast<int32_t>(segments_stream.Tell() - begin);
+  }
 
-  // Dispatches allocated memory, from the highest alignment requirement to the
-  // lowest.
-  soa_translations_ = reinterpret_cast<InterpSoaTranslation*>(alloc_cursor);
-  alloc_cursor += sizeof(InterpSoaTranslation) * max_soa_tracks_;
-  soa_rotations_ = reinterpret_cast<InterpSoaRotation*>(alloc_cursor);
-  alloc_cursor += sizeof(InterpSoaRotation) * max_soa_tracks_;
-  soa_scales_ = reinterpret_cast<InterpSoaScale*>(alloc_cursor);
-  alloc_cursor += sizeof(InterpSoaScale) * max_soa_tracks_;
+  // Copies segments data.
+  const size_t size = segments_stream.Size();
+  if (size) {
+    char* buffer = memory::default_allocator()->Allocate<char>(size);
+    segments_stream.Seek(0, ozz::io::Stream::kSet);
+    OZZ_IF_DEBUG(size_t read =) segments_stream.Read(buffer, size);
+    assert(read == size);
+    OZZ_IF_DEBUG(size_t written =) _archive.SaveBinary(buffer, size);
+    assert(written == size);
+    memory::default_allocator()->Deallocate(buffer);
+  }
+}
 
-  translation_keys_ = reinterpret_cast<int*>(alloc_cursor);
-  alloc_cursor += sizeof(int) * max_tracks * 2;
-  rotation_keys_ = reinterpret_cast<int*>(alloc_cursor);
-  alloc_cursor += sizeof(int) * max_tracks * 2;
-  scale_keys_ = reinterpret_cast<int*>(alloc_cursor);
-  alloc_cursor += sizeof(int) * max_tracks * 2;
+void SegmentedAnimation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
 
-  outdated_translations_ = reinterpret_cast<unsigned char*>(alloc_cursor);
-  alloc_cursor += sizeof(unsigned char) * num_outdated;
-  outdated_rotations_ = reinterpret_cast<unsigned char*>(alloc_cursor);
-  alloc_cursor += sizeof(unsigned char) * num_outdated;
-  outdated_scales_ = reinterpret_cast<unsigned char*>(alloc_cursor);
-  alloc_cursor += sizeof(unsigned char) * num_outdated;
+  // Destroy animation in case it was already used before.
+  Deallocate();
+  duration_ = 0.f;
+  segment_duration_ = 0.f;
+  num_tracks_ = 0;
 
-  assert(alloc_cursor == alloc_begin + size);
-}
+  if (_version != 1) {
+    return;
+  }
 
-SamplingCache::~SamplingCache() {
-  // Deallocates everything at once.
-  memory::default_allocator()->Deallocate(soa_translations_);
-}
+  _archive >> duration_;
+  _archive >> segment_duration_;
 
-void SamplingCache::Step(const Animation& _animation, float _time) {
-  // The cache is invalidated if animation has changed or if it is being rewind.
-  if (animation_ != &_animation || _time < time_) {
-    animation_ = &_animation;
-    translation_cursor_ = 0;
-    rotation_cursor_ = 0;
-    scale_cursor_ = 0;
+  int32_t num_tracks;
+  _archive >> num_tracks;
+  num_tracks_ = num_tracks;
+
+  int32_t name_len;
+  _archive >> name_len;
+  char* name = NULL;
+  if (name_len > 0) {  // Name is read before allocation, as sizes are unknown.
+    name = memory::default_allocator()->Allocate<char>(name_len);
+    _archive >> ozz::io::MakeArray(name, name_len);
   }
-  time_ = _time;
-}
 
-void SamplingCache::Invalidate() {
-  animation_ = NULL;
-  time_ = 0.f;
-  translation_cursor_ = 0;
-  rotation_cursor_ = 0;
-  scale_cursor_ = 0;
+  int32_t num_segments;
+  _archive >> num_segments;
+
+  Allocate(name_len, num_segments);
+  if (name_) {  // NULL name_ is supported.
+    std::memcpy(name_, name, name_len);
+    name_[name_len] = 0;
+  }
+  memory::default_allocator()->Deallocate(name);
+
+  // Computes segments position in the stream. Segments data follow the
+  // segments size table.
+  int32_t* sizes = memory::default_allocator()->Allocate<int32_t>(
+    math::Max(num_segments, 1));
+  _archive >> ozz::io::MakeArray(sizes, num_segments);
+  stream_ = _archive.stream();
+  int offset = stream_->Tell();
+  for (int i = 0; i < num_segments; ++i) {
+    offsets_.begin[i] = offset;
+    offset += sizes[i];
+  }
+  offsets_.begin[num_segments] = offset;
+  memory::default_allocator()->Deallocate(sizes);
+
+  // Skips segments data, which are loaded on demand.
+  stream_->Seek(offset, ozz::io::Stream::kSet);
 }
 }  // animation
 }  // ozz
@@ -1618,6 +4023,7 @@ void SamplingCache::Invalidate() {
 #include "ozz/animation/runtime/skeleton.h"
 
 #include <cstring>
+#include <cassert>
 
 #include "ozz/base/io/archive.h"
 #include "ozz/base/maths/math_ex.h"
@@ -1664,7 +4070,16 @@ void Load(IArchive& _archive,
 
 namespace animation {
 
-Skeleton::Skeleton() {}
+namespace {
+// In-place data alignment. OZZ_ALIGN_OF(math::SoaTransform) is conservatively
+// computed from its size, where SoaTransform only requires the alignment of its
+// SimdFloat4 members, which matches their size.
+const size_t kInPlaceAlignment = sizeof(math::SimdFloat4);
+}  // namespace
+
+Skeleton::Skeleton()
+    : in_place_(false) {
+}
 
 Skeleton::~Skeleton() {
   Deallocate();
@@ -1720,7 +4135,13 @@ char* Skeleton::Allocate(size_t _chars_size, size_t _num_joints) {
 }
 
 void Skeleton::Deallocate() {
-  memory::default_allocator()->Deallocate(bind_pose_.begin);
+  if (in_place_) {
+    // Only joint names array is owned by in-place skeletons.
+    memory::default_allocator()->Deallocate(joint_names_.begin);
+    in_place_ = false;
+  } else {
+    memory::default_allocator()->Deallocate(bind_pose_.begin);
+  }
   bind_pose_.Clear();
   joint_names_.Clear();
   joint_properties_.Clear();
@@ -1791,6 +4212,118 @@ void Skeleton::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   _archive >> ozz::io::MakeArray(joint_properties_);
   _archive >> ozz::io::MakeArray(bind_pose_);
 }
+
+void Skeleton::SaveInPlace(ozz::io::OArchive& _archive) const {
+  assert(!_archive.endian_swap() &&
+         "In-place archives must have native endianness.");
+
+  // Stores memory layout properties, so they can be validated when loading.
+  _archive << static_cast<uint32_t>(sizeof(math::SoaTransform));
+  _archive << static_cast<uint32_t>(sizeof(Skeleton::JointProperties));
+
+  const int32_t num_joints = this->num_joints();
+
+  // Early out if skeleton's empty.
+  _archive << num_joints;
+  if (!num_joints) {
+    return;
+  }
+
+  size_t chars_count = 0;
+  for (int i = 0; i < num_joints; ++i) {
+    chars_count += (std::strlen(joint_names_[i]) + 1) * sizeof(char);
+  }
+  _archive << static_cast<int32_t>(chars_count);
+
+  // Stores data as-is, from the biggest to the smallest alignment.
+  io::PadInPlace(_archive, kInPlaceAlignment);
+  _archive.SaveBinary(bind_pose_.begin, bind_pose_.Size());
+  _archive.SaveBinary(joint_properties_.begin, joint_properties_.Size());
+  _archive.SaveBinary(joint_names_[0], chars_count);
+}
+
+void Skeleton::LoadInPlace(ozz::io::IArchive& _archive, uint32_t _version) {
+
+  // Deallocate skeleton in case it was already used before.
+  Deallocate();
+
+  // In-place data cannot be endian swapped.
+  if (_version != 1 || _archive.endian_swap()) {
+    return;
+  }
+
+  uint32_t transform_size;
+  _archive >> transform_size;
+  uint32_t properties_size;
+  _archive >> properties_size;
+  if (transform_size != sizeof(math::SoaTransform) ||
+      properties_size != sizeof(Skeleton::JointProperties)) {
+    return;
+  }
+
+  int32_t num_joints;
+  _archive >> num_joints;
+
+  // Early out if skeleton's empty.
+  if (!num_joints) {
+    return;
+  }
+
+  int32_t chars_count;
+  _archive >> chars_count;
+
+  if (!io::PadInPlace(_archive, kInPlaceAlignment)) {
+    return;
+  }
+
+  const size_t bind_poses_size =
+    (num_joints + 3) / 4 * sizeof(math::SoaTransform);
+  const size_t joint_properties_size =
+    num_joints * sizeof(Skeleton::JointProperties);
+  const size_t data_size =
+    bind_poses_size + joint_properties_size + chars_count;
+
+  // Uses stream memory directly if it's available and properly aligned.
+  io::Stream* stream = _archive.stream();
+  char* data = static_cast<char*>(const_cast<void*>(stream->Map(data_size)));
+  if (data &&
+      !math::IsAligned(data, kInPlaceAlignment)) {
+    stream->Seek(-static_cast<int>(data_size), io::Stream::kCurrent);
+    data = NULL;
+  }
+
+  char* cursor;
+  if (data) {
+    in_place_ = true;
+    joint_names_ =
+      memory::default_allocator()->AllocateRange<char*>(num_joints);
+
+    bind_pose_.begin = reinterpret_cast<math::SoaTransform*>(data);
+    data += bind_poses_size;
+    bind_pose_.end = reinterpret_cast<math::SoaTransform*>(data);
+
+    joint_properties_.begin =
+      reinterpret_cast<Skeleton::JointProperties*>(data);
+    data += joint_properties_size;
+    joint_properties_.end = reinterpret_cast<Skeleton::JointProperties*>(data);
+
+    cursor = data;
+  } else {
+    // Falls back to copying data.
+    cursor = Allocate(chars_count, num_joints);
+    _archive.LoadBinary(bind_pose_.begin, bind_poses_size);
+    _archive.LoadBinary(joint_properties_.begin, joint_properties_size);
+    _archive.LoadBinary(cursor, chars_count);
+  }
+
+  // Fixes up array of pointers. Stops at num_joints - 1, so that it doesn't
+  // read memory past the end of the buffer.
+  for (int i = 0; i < num_joints - 1; ++i) {
+    joint_names_[i] = cursor;
+    cursor += std::strlen(joint_names_[i]) + 1;
+  }
+  joint_names_[num_joints - 1] = cursor;
+}
 }  // animation
 }  // ozz
 
@@ -1826,6 +4359,7 @@ void Skeleton::Load(ozz::io::IArchive& _archive, uint32_t _version) {
 #include "ozz/animation/runtime/skeleton_utils.h"
 
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
 
 #include <assert.h>
 
@@ -1946,6 +4480,254 @@ void IterateJointsDF(const Skeleton& _skeleton,
   }
 }
 #undef _HAS_SIBLING
+
+// Joints are sorted such that a parent always precedes its children. An
+// interval of joints can thus be cut at every joint that isn't preceded by the
+// parent of any of the following joints of the interval. Resulting chunks only
+// depend on themselves and on joints outside of the interval, which are already
+// processed. Chunks are merged together in ranges of at most _grain joints,
+// while bigger chunks are split: their first _grain joints are processed by the
+// current stage, the remaining ones are deferred to the next stage.
+bool PartitionJoints(const Skeleton& _skeleton,
+                     int _grain,
+                     JointsPartition* _partition) {
+  assert(_partition);
+  assert(_grain > 0 && "Grain must be greater than 0.");
+  const int num_joints = _skeleton.num_joints();
+  Range<const Skeleton::JointProperties> properties =
+    _skeleton.joint_properties();
+
+  // Initialize partition.
+  _partition->num_ranges = 0;
+  _partition->num_stages = 0;
+
+  // Tests buffers sizes.
+  if (_partition->ranges.Count() < static_cast<size_t>(num_joints) ||
+      _partition->stages.Count() < static_cast<size_t>(num_joints) + 1) {
+    return false;
+  }
+  _partition->stages[0] = 0;
+
+  if (num_joints == 0 || _grain <= 0) {
+    return true;
+  }
+
+  // Queue of the intervals that remain to be processed, and flags of the
+  // joints that start a new chunk. Intervals are disjoint and not empty, so
+  // there's no more than num_joints of them.
+  typedef JointsPartition::JointRange JointRange;
+  memory::Allocator* allocator = memory::default_allocator();
+  JointRange* queue = allocator->Allocate<JointRange>(num_joints);
+  bool* cuts = allocator->Allocate<bool>(num_joints);
+  int queue_begin = 0;
+  int queue_size = 0;
+  const JointRange all = {0, static_cast<uint16_t>(num_joints)};
+  queue[queue_size++] = all;
+
+  while (queue_size != 0) {
+    // Intervals currently in the queue are all processed by this stage.
+    for (int stage_size = queue_size; stage_size != 0; --stage_size) {
+      const JointRange interval = queue[queue_begin];
+      queue_begin = (queue_begin + 1) % num_joints;
+      --queue_size;
+
+      // Finds chunks, traversing the interval backward to know the lowest
+      // parent of all the following joints.
+      int lowest = interval.to;
+      for (int joint = interval.to - 1; joint > interval.from; --joint) {
+        const int parent = properties.begin[joint].parent;
+        if (parent >= interval.from && parent < lowest) {
+          lowest = parent;
+        }
+        cuts[joint] = lowest >= joint;
+      }
+
+      // Fills ranges with chunks.
+      int range_begin = interval.from;
+      for (int chunk = interval.from; chunk < interval.to;) {
+        int chunk_end = chunk + 1;
+        for (; chunk_end < interval.to && !cuts[chunk_end]; ++chunk_end) {
+        }
+
+        if (chunk_end - range_begin > _grain) {
+          // Chunk doesn't fit in the current range, which is closed.
+          if (chunk > range_begin) {
+            const JointRange range = {static_cast<uint16_t>(range_begin),
+                                      static_cast<uint16_t>(chunk)};
+            _partition->ranges[_partition->num_ranges++] = range;
+            range_begin = chunk;
+          }
+          // Chunk is split if it's bigger than the grain.
+          if (chunk_end - chunk > _grain) {
+            const JointRange head = {static_cast<uint16_t>(chunk),
+                                     static_cast<uint16_t>(chunk + _grain)};
+            _partition->ranges[_partition->num_ranges++] = head;
+            const JointRange tail = {static_cast<uint16_t>(chunk + _grain),
+                                     static_cast<uint16_t>(chunk_end)};
+            queue[(queue_begin + queue_size++) % num_joints] = tail;
+            range_begin = chunk_end;
+          }
+        }
+        chunk = chunk_end;
+      }
+      if (range_begin < interval.to) {
+        const JointRange range = {static_cast<uint16_t>(range_begin),
+                                  interval.to};
+        _partition->ranges[_partition->num_ranges++] = range;
+      }
+    }
+    _partition->stages[++_partition->num_stages] =
+      static_cast<uint16_t>(_partition->num_ranges);
+  }
+
+  allocator->Deallocate(queue);
+  allocator->Deallocate(cuts);
+  return true;
+}
+}  // animation
+}  // ozz
+
+// Including skinning_matrices_job.cc file.
+
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/skinning_matrices_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace animation {
+
+bool SkinningMatricesJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL begin pointers.
+  valid &= models.begin != NULL;
+  valid &= inverse_bind_poses.begin != NULL;
+  valid &= output.begin != NULL;
+
+  // Test ranges, implicitly tests for NULL end pointers.
+  const ptrdiff_t num_matrices = output.end - output.begin;
+  valid &= num_matrices >= 0;
+  valid &= inverse_bind_poses.end - inverse_bind_poses.begin >=
+           (num_matrices + 3) / 4;
+
+  // Test remapping table.
+  const ptrdiff_t num_models = models.end - models.begin;
+  if (joint_remaps.begin != NULL) {
+    valid &= joint_remaps.end - joint_remaps.begin >= num_matrices;
+    for (const uint16_t* remap = joint_remaps.begin;
+         valid && remap < joint_remaps.begin + num_matrices;
+         ++remap) {
+      valid &= *remap < num_models;
+    }
+  } else {
+    valid &= num_models >= num_matrices;
+  }
+
+  return valid;
+}
+
+bool SkinningMatricesJob::Run() const {
+  using math::SoaFloat4x4;
+  using math::Float4x4;
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_matrices = static_cast<int>(output.end - output.begin);
+  for (int i = 0, soa = 0; i < num_matrices; i += 4, ++soa) {
+    const int count = math::Min(num_matrices - i, 4);
+
+    // Gathers and transposes up to 4 model matrices to a soa matrix. Missing
+    // ones are replaced by the last model matrix.
+    const Float4x4* aos_models[4];
+    for (int j = 0; j < 4; ++j) {
+      const int index = i + math::Min(j, count - 1);
+      aos_models[j] = &models.begin[
+        joint_remaps.begin != NULL ? joint_remaps.begin[index] : index];
+    }
+    SoaFloat4x4 soa_models;
+    for (int k = 0; k < 4; ++k) {
+      const math::SimdFloat4 aos_cols[4] = {aos_models[0]->cols[k],
+                                            aos_models[1]->cols[k],
+                                            aos_models[2]->cols[k],
+                                            aos_models[3]->cols[k]};
+      math::Transpose4x4(aos_cols, &soa_models.cols[k].x);
+    }
+
+    // Multiplies by inverse bind-poses and transposes back to aos.
+    const SoaFloat4x4 soa_skinning = soa_models * inverse_bind_poses.begin[soa];
+    for (int k = 0; k < 4; ++k) {
+      math::SimdFloat4 aos_cols[4];
+      math::Transpose4x4(&soa_skinning.cols[k].x, aos_cols);
+      for (int j = 0; j < count; ++j) {
+        output.begin[i + j].cols[k] = aos_cols[j];
+      }
+    }
+  }
+  return true;
+}
+
+bool PackInverseBindPoses(Range<const math::Float4x4> _inverse_bind_poses,
+                          Range<math::SoaFloat4x4> _output) {
+  const int num_matrices = static_cast<int>(_inverse_bind_poses.Count());
+  const int num_soa_matrices = (num_matrices + 3) / 4;
+  if (_output.Count() < static_cast<size_t>(num_soa_matrices)) {
+    return false;
+  }
+
+  const math::Float4x4 identity = math::Float4x4::identity();
+  for (int soa = 0; soa < num_soa_matrices; ++soa) {
+    const math::Float4x4* matrices[4];
+    for (int j = 0; j < 4; ++j) {
+      const int index = soa * 4 + j;
+      matrices[j] = index < num_matrices ?
+        &_inverse_bind_poses.begin[index] : &identity;
+    }
+    for (int k = 0; k < 4; ++k) {
+      const math::SimdFloat4 aos_cols[4] = {matrices[0]->cols[k],
+                                            matrices[1]->cols[k],
+                                            matrices[2]->cols[k],
+                                            matrices[3]->cols[k]};
+      math::Transpose4x4(aos_cols, &_output.begin[soa].cols[k].x);
+    }
+  }
+  return true;
+}
 }  // animation
 }  // ozz
 
@@ -466,6 +466,27 @@ struct RotationKey {
   int16_t value[3];  // The quantized value of the 3 smallest components.
 };
 
+// Defines the packed rotation key frame type, an alternative to RotationKey
+// that requires 8 bytes per key instead of 12. It's selected per animation,
+// see Animation::RotationFormat.
+// Time is quantized on 16 bits, as a ratio of the animation duration (see
+// kQuantizedTimeMax). The 3 smallest components of the quaternion are quantized
+// to 11, 11 and 10 bits, packed in a single 32 bits value: bits [0:10] store
+// the first component, bits [11:21] the second and bits [22:31] the third.
+// Each component c, in range [-1/sqrt(2):1/sqrt(2)], is stored as the unsigned
+// integer round((c * sqrt(2) + 1) / 2 * (2^n - 1)), n being the number of bits.
+// Quantization error is then bounded to sqrt(2) / (2 * (2^n - 1)) per
+// component, that is 3.5e-4 for 11 bits components and 6.9e-4 for 10 bits
+// ones. Time quantization error is bounded to
+// duration / (2 * kQuantizedTimeMax).
+struct PackedRotationKey {
+  uint16_t time;  // Quantized time, as a ratio of the animation duration.
+  uint16_t track:13;  // The track this key frame belongs to.
+  uint16_t largest:2;  // The largest component of the quaternion.
+  uint16_t sign:1;  // The sign of the largest component. 1 for negative.
+  uint32_t value;  // The quantized value of the 3 smallest components.
+};
+
 // Defines the scale key frame type.
 // Scale values are stored as half precision floats with 16 bits per
 // component.
@@ -474,6 +495,57 @@ struct ScaleKey {
   uint16_t track;
   uint16_t value[3];
 };
+
+// Defines quantized time variants of translation, rotation and scale key frame
+// types, which require 10 bytes per key instead of 12. They are selected per
+// animation, see Animation::TimeFormat.
+// Time is quantized on 16 bits, as a ratio of the animation duration (see
+// kQuantizedTimeMax), with an error bounded to
+// duration / (2 * kQuantizedTimeMax). Values are stored the same way as
+// their float time counterparts.
+struct QuantizedTranslationKey {
+  uint16_t time;  // Quantized time, as a ratio of the animation duration.
+  uint16_t track;
+  uint16_t value[3];
+};
+
+struct QuantizedRotationKey {
+  uint16_t time;  // Quantized time, as a ratio of the animation duration.
+  uint16_t track:13;  // The track this key frame belongs to.
+  uint16_t largest:2;  // The largest component of the quaternion.
+  uint16_t sign:1;  // The sign of the largest component. 1 for negative.
+  int16_t value[3];  // The quantized value of the 3 smallest components.
+};
+
+struct QuantizedScaleKey {
+  uint16_t time;  // Quantized time, as a ratio of the animation duration.
+  uint16_t track;
+  uint16_t value[3];
+};
+
+// Defines constant track types. A track whose value never changes is stored
+// once as a constant, rather than as key frames (see
+// Animation::constant_translations()). Constant values are compressed the same
+// way as key frame values, track member being the joint index.
+struct ConstantTranslation {
+  uint16_t track;
+  uint16_t value[3];
+};
+
+struct ConstantRotation {
+  uint16_t track:13;  // The joint this constant belongs to.
+  uint16_t largest:2;  // The largest component of the quaternion.
+  uint16_t sign:1;  // The sign of the largest component. 1 for negative.
+  int16_t value[3];  // The quantized value of the 3 smallest components.
+};
+
+struct ConstantScale {
+  uint16_t track;
+  uint16_t value[3];
+};
+
+// Maximum value of a quantized time, matching animation duration.
+const float kQuantizedTimeMax = 65535.f;
 }  // animation
 }  // ozz
 #endif  // OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
@@ -562,43 +634,34 @@ void CopyRaw(const _SrcTrack& _src, uint16_t _track, float _duration,
   assert(_dest->front().key.time == 0.f && _dest->back().key.time == _duration);
 }
 
-void CopyToAnimation(ozz::Vector<SortingTranslationKey>::Std* _src,
-                     ozz::Range<TranslationKey>* _dest) {
-  const size_t src_count = _src->size();
-  if (!src_count) {
-    return;
-  }
-
-  // Sort animation keys to favor cache coherency.
-  std::sort(&_src->front(), (&_src->back()) + 1, &SortingKeyLess<SortingTranslationKey>);
+// Stores a sorting key time to a key frame time. Float times are copied,
+// while quantized times must have been quantized with QuantizeTimes already.
+void StoreTime(float _time, float* _dest) {
+  *_dest = _time;
+}
 
-  // Fills output.
-  const SortingTranslationKey* src = &_src->front();
-  for (size_t i = 0; i < src_count; ++i) {
-    TranslationKey& key = _dest->begin[i];
-    key.time = src[i].key.time;
-    key.track = src[i].track;
-    key.value[0] = ozz::math::FloatToHalf(src[i].key.value.x);
-    key.value[1] = ozz::math::FloatToHalf(src[i].key.value.y);
-    key.value[2] = ozz::math::FloatToHalf(src[i].key.value.z);
-  }
+void StoreTime(float _time, uint16_t* _dest) {
+  *_dest = static_cast<uint16_t>(_time);
 }
 
-void CopyToAnimation(ozz::Vector<SortingScaleKey>::Std* _src,
-                     ozz::Range<ScaleKey>* _dest) {
+// Copies translation or scale keys, _DestKey being one of TranslationKey,
+// ScaleKey or their quantized time variants.
+template<typename _SortingKey, typename _DestKey>
+void CopyToAnimation(typename ozz::Vector<_SortingKey>::Std* _src,
+                     ozz::Range<_DestKey>* _dest) {
   const size_t src_count = _src->size();
   if (!src_count) {
     return;
   }
 
   // Sort animation keys to favor cache coherency.
-  std::sort(&_src->front(), (&_src->back()) + 1, &SortingKeyLess<SortingScaleKey>);
+  std::sort(&_src->front(), (&_src->back()) + 1, &SortingKeyLess<_SortingKey>);
 
   // Fills output.
-  const SortingScaleKey* src = &_src->front();
+  const _SortingKey* src = &_src->front();
   for (size_t i = 0; i < src_count; ++i) {
-    ScaleKey& key = _dest->begin[i];
-    key.time = src[i].key.time;
+    _DestKey& key = _dest->begin[i];
+    StoreTime(src[i].key.time, &key.time);
     key.track = src[i].track;
     key.value[0] = ozz::math::FloatToHalf(src[i].key.value.x);
     key.value[1] = ozz::math::FloatToHalf(src[i].key.value.y);
@@ -612,14 +675,15 @@ bool LessAbs(float _left, float _right) {
   return std::abs(_left) < std::abs(_right);
 }
 
-// Compresses quaternion to ozz::animation::RotationKey format.
+// Compresses quaternion to ozz::animation::RotationKey format, or
+// QuantizedRotationKey which only differs by its time.
 // The 3 smallest components of the quaternion are quantized to 16 bits
 // integers, while the largest is recomputed thanks to quaternion normalization
 // property (x^2+y^2+z^2+w^2 = 1). Because the 3 components are the 3 smallest,
 // their value cannot be greater than sqrt(2)/2. Thus quantization quality is
 // improved by pre-multiplying each componenent by sqrt(2).
-void CompressQuat(const ozz::math::Quaternion& _src,
-                  ozz::animation::RotationKey* _dest) {
+template<typename _DestKey>
+void CompressQuat(const ozz::math::Quaternion& _src, _DestKey* _dest) {
   // Finds the largest quaternion component.
   const float quat[4] = {_src.x, _src.y, _src.z, _src.w};
   const size_t largest = std::max_element(quat, quat + 4, LessAbs) - quat;
@@ -640,13 +704,42 @@ void CompressQuat(const ozz::math::Quaternion& _src,
   _dest->value[1] = math::Clamp(-32767, b, 32767) & 0xffff;
   _dest->value[2] = math::Clamp(-32767, c, 32767) & 0xffff;
 }
+
+// Compresses quaternion to ozz::animation::PackedRotationKey format.
+// Like CompressQuat, the largest component is dropped, but the 3 smallest
+// components are quantized to 11, 11 and 10 bits unsigned integers and packed
+// in a single 32 bits value.
+void CompressPackedQuat(const ozz::math::Quaternion& _src,
+                        ozz::animation::PackedRotationKey* _dest) {
+  // Finds the largest quaternion component.
+  const float quat[4] = {_src.x, _src.y, _src.z, _src.w};
+  const size_t largest = std::max_element(quat, quat + 4, LessAbs) - quat;
+  assert(largest <= 3);
+  _dest->largest = largest & 0x3;
+
+  // Stores the sign of the largest component.
+  _dest->sign = quat[largest] < 0.f;
+
+  // Remaps the 3 smallest components from [-1/sqrt(2):1/sqrt(2)] to [0:1],
+  // and quantizes them.
+  const int kMapping[4][3] = {{1, 2, 3}, {0, 2, 3}, {0, 1, 3}, {0, 1, 2}};
+  const int* map = kMapping[largest];
+  const float a = (quat[map[0]] * math::kSqrt2 + 1.f) * .5f;
+  const float b = (quat[map[1]] * math::kSqrt2 + 1.f) * .5f;
+  const float c = (quat[map[2]] * math::kSqrt2 + 1.f) * .5f;
+  const int qa = static_cast<int>(floor(a * 2047.f + .5f));
+  const int qb = static_cast<int>(floor(b * 2047.f + .5f));
+  const int qc = static_cast<int>(floor(c * 1023.f + .5f));
+  _dest->value = static_cast<uint32_t>(math::Clamp(0, qa, 2047)) |
+                 (static_cast<uint32_t>(math::Clamp(0, qb, 2047)) << 11) |
+                 (static_cast<uint32_t>(math::Clamp(0, qc, 1023)) << 22);
+}
 }
 
-// Specialize for rotations in order to normalize quaternions.
+// Normalizes rotation keys quaternions, then sorts keys.
 // Consecutive opposite quaternions are also fixed up in order to avoid checking
 // for the smallest path during the NLerp runtime algorithm.
-void CopyToAnimation(ozz::Vector<SortingRotationKey>::Std* _src,
-                     ozz::Range<RotationKey>* _dest) {
+void NormalizeAndSort(ozz::Vector<SortingRotationKey>::Std* _src) {
   const size_t src_count = _src->size();
   if (!src_count) {
     return;
@@ -684,20 +777,160 @@ void CopyToAnimation(ozz::Vector<SortingRotationKey>::Std* _src,
   std::sort(array_begin(*_src),
             array_end(*_src),
             &SortingKeyLess<SortingRotationKey>);
+}
+
+// Specialize for rotations in order to normalize quaternions. _DestKey is
+// RotationKey or QuantizedRotationKey.
+template<typename _DestKey>
+void CopyToAnimation(ozz::Vector<SortingRotationKey>::Std* _src,
+                     ozz::Range<_DestKey>* _dest) {
+  NormalizeAndSort(_src);
 
   // Fills rotation keys output.
+  const size_t src_count = _src->size();
+  const SortingRotationKey* src = array_begin(*_src);
   for (size_t i = 0; i < src_count; ++i) {
     const SortingRotationKey& skey = src[i];
-    RotationKey& dkey = _dest->begin[i];
-    dkey.time = skey.key.time;
+    _DestKey& dkey = _dest->begin[i];
+    StoreTime(skey.key.time, &dkey.time);
     dkey.track = skey.track;
 
     // Compress quaternion to destination container.
     CompressQuat(skey.key.value, &dkey);
   }
 }
+
+// Specialize for packed rotations. Key times must have been quantized with
+// QuantizeTimes.
+void CopyToAnimation(ozz::Vector<SortingRotationKey>::Std* _src,
+                     ozz::Range<PackedRotationKey>* _dest) {
+  NormalizeAndSort(_src);
+
+  // Fills packed rotation keys output.
+  const size_t src_count = _src->size();
+  const SortingRotationKey* src = array_begin(*_src);
+  for (size_t i = 0; i < src_count; ++i) {
+    const SortingRotationKey& skey = src[i];
+    PackedRotationKey& dkey = _dest->begin[i];
+    StoreTime(skey.key.time, &dkey.time);
+    dkey.track = skey.track;
+
+    // Compress quaternion to destination container.
+    CompressPackedQuat(skey.key.value, &dkey);
+  }
+}
+
+// Compresses the value of a constant translation or scale track.
+template<typename _Constant>
+void CompressConstant(const math::Float3& _value, _Constant* _dest) {
+  _dest->value[0] = ozz::math::FloatToHalf(_value.x);
+  _dest->value[1] = ozz::math::FloatToHalf(_value.y);
+  _dest->value[2] = ozz::math::FloatToHalf(_value.z);
+}
+
+// Compresses the value of a constant rotation track, normalized the same way
+// as rotation keys.
+void CompressConstant(const math::Quaternion& _value,
+                      ConstantRotation* _dest) {
+  math::Quaternion normalized =
+    NormalizeSafe(_value, math::Quaternion::identity());
+  if (normalized.w < 0.f) {
+    normalized = -normalized;  // Q an -Q are the same rotation.
+  }
+  CompressQuat(normalized, _dest);
+}
+
+// Tests if a raw track is constant, ie: it has no key or all its keys share
+// the same value.
+template<typename _SrcTrack>
+bool IsConstant(const _SrcTrack& _src) {
+  for (size_t k = 1; k < _src.size(); ++k) {
+    if (!(_src[k].value == _src[0].value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Splits _input tracks of a type, selected by _member, into constant and
+// animated tracks. Constant values are pushed to _constants, while keys of
+// animated tracks are copied to _keys, using their rank as track index. Soa
+// padding joints are animated identity tracks if all the other tracks are
+// animated, or constant ones otherwise. Identity keys are also added to match
+// soa requirements for animated tracks.
+template<typename _SrcTrack, typename _SortingKey, typename _Constant>
+void SplitTracks(const RawAnimation& _input,
+                 const _SrcTrack RawAnimation::JointTrack::*_member,
+                 typename ozz::Vector<_SortingKey>::Std* _keys,
+                 typename ozz::Vector<_Constant>::Std* _constants) {
+  typedef typename _SrcTrack::value_type SrcKey;
+  const int num_tracks = _input.num_tracks();
+  bool has_constant = false;
+  for (int i = 0; i < num_tracks && !has_constant; ++i) {
+    has_constant = IsConstant(_input.tracks[i].*_member);
+  }
+
+  const _SrcTrack empty;
+  uint16_t animated = 0;
+  for (int i = 0; i < math::Align(num_tracks, 4); ++i) {
+    const bool padding = i >= num_tracks;
+    const _SrcTrack& src = padding ? empty : _input.tracks[i].*_member;
+    if ((!padding || has_constant) && IsConstant(src)) {
+      _Constant constant;
+      constant.track = static_cast<uint16_t>(i);
+      CompressConstant(src.empty() ? SrcKey::identity() : src.front().value,
+                       &constant);
+      _constants->push_back(constant);
+    } else {
+      CopyRaw(src, animated++, _input.duration, _keys);
+    }
+  }
+
+  // Add enough identity keys to match soa requirements.
+  for (const int end = math::Align(animated, 4); animated < end; ++animated) {
+    PushBackIdentityKey<SrcKey>(animated, 0.f, _keys);
+    PushBackIdentityKey<SrcKey>(animated, _input.duration, _keys);
+  }
+}
+
+// Quantizes key times as a ratio of _duration, in range [0:kQuantizedTimeMax].
+// Key and previous key times are replaced by their quantized value. Keys of a
+// track whose quantized time equals their predecessor's one are removed, as
+// interpolating between them would divide by zero. The last key of a track
+// (at t = duration) is always kept, replacing its predecessor if needed.
+// Keys are expected to be sorted per-track.
+template<typename _SortingKey>
+void QuantizeTimes(float _duration,
+                   typename ozz::Vector<_SortingKey>::Std* _keys) {
+  const float to_quantized = kQuantizedTimeMax / _duration;
+  const size_t src_count = _keys->size();
+  size_t count = 0;
+  for (size_t i = 0; i < src_count; ++i) {
+    _SortingKey key = (*_keys)[i];
+    const float quantized = floor(key.key.time * to_quantized + .5f);
+    const bool first = count == 0 || (*_keys)[count - 1].track != key.track;
+    if (!first && quantized <= (*_keys)[count - 1].key.time) {
+      const bool last =
+        i + 1 == src_count || (*_keys)[i + 1].track != key.track;
+      if (!last) {
+        continue;  // Removes this key.
+      }
+      --count;  // Removes the predecessor, which can't be the first key.
+    }
+    const bool follows = count > 0 && (*_keys)[count - 1].track == key.track;
+    key.key.time = quantized;
+    key.prev_key_time = follows ? (*_keys)[count - 1].key.time : -1.f;
+    (*_keys)[count++] = key;
+  }
+  _keys->resize(count);
+}
 }  // namespace
 
+AnimationBuilder::AnimationBuilder()
+    : rotation_format(Animation::kRotationStandard),
+      time_format(Animation::kTimeFloat) {
+}
+
 // Ensures _input's validity and allocates _animation.
 // An animation needs to have at least two key frames per joint, the first at
 // t = 0 and the last at t = duration. If at least one of those keys are not
@@ -724,7 +957,6 @@ Animation* AnimationBuilder::operator()(const RawAnimation& _input) const {
   // already been validated.
   const uint16_t num_tracks = static_cast<uint16_t>(_input.num_tracks());
   animation->num_tracks_ = num_tracks;
-  const uint16_t num_soa_tracks = math::Align(num_tracks, 4);
 
   // Declares and preallocates tracks to sort.
   size_t translations = 0, rotations = 0, scales = 0;
@@ -741,40 +973,88 @@ Animation* AnimationBuilder::operator()(const RawAnimation& _input) const {
   ozz::Vector<SortingScaleKey>::Std sorting_scales;
   sorting_scales.reserve(scales);
 
-  // Filters RawAnimation keys and copies them to the output sorting structure.
-  uint16_t i = 0;
-  for (; i < num_tracks; ++i) {
-    const RawAnimation::JointTrack& raw_track = _input.tracks[i];
-    CopyRaw(raw_track.translations, i, duration, &sorting_translations);
-    CopyRaw(raw_track.rotations, i, duration, &sorting_rotations);
-    CopyRaw(raw_track.scales, i, duration, &sorting_scales);
+  // Filters RawAnimation keys and copies them to the output sorting structure,
+  // apart from constant tracks.
+  ozz::Vector<ConstantTranslation>::Std constant_translations;
+  ozz::Vector<ConstantRotation>::Std constant_rotations;
+  ozz::Vector<ConstantScale>::Std constant_scales;
+  SplitTracks<RawAnimation::JointTrack::Translations, SortingTranslationKey,
+              ConstantTranslation>(
+    _input, &RawAnimation::JointTrack::translations, &sorting_translations,
+    &constant_translations);
+  SplitTracks<RawAnimation::JointTrack::Rotations, SortingRotationKey,
+              ConstantRotation>(
+    _input, &RawAnimation::JointTrack::rotations, &sorting_rotations,
+    &constant_rotations);
+  SplitTracks<RawAnimation::JointTrack::Scales, SortingScaleKey,
+              ConstantScale>(
+    _input, &RawAnimation::JointTrack::scales, &sorting_scales,
+    &constant_scales);
+
+  // Quantized time and packed rotation keys are quantized, which can remove
+  // keys.
+  const bool packed = rotation_format == Animation::kRotationPacked;
+  const bool quantized = time_format == Animation::kTimeQuantized;
+  if (quantized) {
+    QuantizeTimes<SortingTranslationKey>(duration, &sorting_translations);
+    QuantizeTimes<SortingScaleKey>(duration, &sorting_scales);
   }
-
-  // Add enough identity keys to match soa requirements.
-  for (; i < num_soa_tracks; ++i) {
-    typedef RawAnimation::TranslationKey SrcTKey;
-    PushBackIdentityKey<SrcTKey>(i, 0.f, &sorting_translations);
-    PushBackIdentityKey<SrcTKey>(i, duration, &sorting_translations);
-
-    typedef RawAnimation::RotationKey SrcRKey;
-    PushBackIdentityKey<SrcRKey>(i, 0.f, &sorting_rotations);
-    PushBackIdentityKey<SrcRKey>(i, duration, &sorting_rotations);
-
-    typedef RawAnimation::ScaleKey SrcSKey;
-    PushBackIdentityKey<SrcSKey>(i, 0.f, &sorting_scales);
-    PushBackIdentityKey<SrcSKey>(i, duration, &sorting_scales);
+  if (packed || quantized) {
+    QuantizeTimes<SortingRotationKey>(duration, &sorting_rotations);
   }
 
   // Allocate animation members.
-  animation->Allocate(_input.name.length() + 1,
-                      sorting_translations.size(),
-                      sorting_rotations.size(),
-                      sorting_scales.size());
+  animation->rotation_format_ = rotation_format;
+  animation->time_format_ = time_format;
+  Animation::Counts counts;
+  counts.name_len = _input.name.length() + 1;
+  counts.translations = sorting_translations.size();
+  counts.rotations = sorting_rotations.size();
+  counts.scales = sorting_scales.size();
+  counts.constant_translations = constant_translations.size();
+  counts.constant_rotations = constant_rotations.size();
+  counts.constant_scales = constant_scales.size();
+  animation->Allocate(counts);
+
+  // Copy constants, which are already sorted by joint index.
+  if (!constant_translations.empty()) {
+    std::memcpy(animation->constant_translations_.begin,
+                array_begin(constant_translations),
+                animation->constant_translations_.Size());
+  }
+  if (!constant_rotations.empty()) {
+    std::memcpy(animation->constant_rotations_.begin,
+                array_begin(constant_rotations),
+                animation->constant_rotations_.Size());
+  }
+  if (!constant_scales.empty()) {
+    std::memcpy(animation->constant_scales_.begin,
+                array_begin(constant_scales),
+                animation->constant_scales_.Size());
+  }
+  animation->BuildTracks();
 
   // Copy sorted keys to final animation.
-  CopyToAnimation(&sorting_translations, &animation->translations_);
-  CopyToAnimation(&sorting_rotations, &animation->rotations_);
-  CopyToAnimation(&sorting_scales, &animation->scales_);
+  if (quantized) {
+    CopyToAnimation<SortingTranslationKey>(
+      &sorting_translations, &animation->quantized_translations_);
+    CopyToAnimation<SortingScaleKey>(
+      &sorting_scales, &animation->quantized_scales_);
+  } else {
+    CopyToAnimation<SortingTranslationKey>(
+      &sorting_translations, &animation->translations_);
+    CopyToAnimation<SortingScaleKey>(&sorting_scales, &animation->scales_);
+  }
+  if (packed) {
+    CopyToAnimation(&sorting_rotations, &animation->packed_rotations_);
+  } else if (quantized) {
+    CopyToAnimation(&sorting_rotations, &animation->quantized_rotations_);
+  } else {
+    CopyToAnimation(&sorting_rotations, &animation->rotations_);
+  }
+
+  // Computes seek tables from sorted keys.
+  animation->BuildSeekTables();
 
   // Copy animation's name.
   strcpy(animation->name_, _input.name.c_str());
@@ -816,15 +1096,22 @@ Animation* AnimationBuilder::operator()(const RawAnimation& _input) const {
 
 #include "ozz/animation/offline/animation_optimizer.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cassert>
 
+#include "ozz/base/task_scheduler.h"
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/transform.h"
 
 #include "ozz/animation/offline/raw_animation.h"
 #include "ozz/animation/offline/raw_animation_utils.h"
 
+#include "ozz/animation/runtime/local_to_model_job.h"
 #include "ozz/animation/runtime/skeleton.h"
 #include "ozz/animation/runtime/skeleton_utils.h"
 
@@ -837,7 +1124,10 @@ AnimationOptimizer::AnimationOptimizer()
   : translation_tolerance(1e-3f),  // 1 mm.
     rotation_tolerance(.1f * math::kPi / 180.f),  // 0.1 degree.
     scale_tolerance(1e-3f),  // 0.1%.
-    hierarchical_tolerance(1e-3f) {  // 1 mm.
+    hierarchical_tolerance(1e-3f),  // 1 mm.
+    reduction(kReductionGreedy),
+    error(kErrorHierarchical),
+    scheduler(NULL) {
 }
 
 namespace {
@@ -954,14 +1244,56 @@ void BuildHierarchicalSpecs(const RawAnimation& _animation,
   }
 }
 
+// Validates keys against the comparator of their track type, ie: tests if a
+// candidate value can replace the value of a key.
+template<typename _RawTrack, typename _Comparator>
+struct CompareValidator {
+  typedef typename _RawTrack::value_type::Value Value;
+
+  // Tests if _value can replace the value of _src key _key.
+  bool operator()(size_t _key, const Value& _value) const {
+    return comparator(_value,
+                      (*src)[_key].value,
+                      tolerance,
+                      hierarchical_tolerance,
+                      hierarchy_length);
+  }
+
+  // Tests if _src values can be interpolated by _lerp from key _left to key
+  // _right, in between keys. Only keys are compared, which operator() does.
+  template<typename _Lerp>
+  bool Segment(size_t _left, size_t _right, const _Lerp& _lerp) const {
+    (void)_left;
+    (void)_right;
+    (void)_lerp;
+    return true;
+  }
+
+  const _RawTrack* src;
+  _Comparator comparator;
+  float tolerance;
+  float hierarchical_tolerance;
+  float hierarchy_length;
+};
+
+// Interpolation function that always returns the left value, which is how a
+// track is sampled after its last key.
+struct LerpLeft {
+  template<typename _Value>
+  _Value operator()(const _Value& _a, const _Value& _b, float _alpha) const {
+    (void)_b;
+    (void)_alpha;
+    return _a;
+  }
+};
+
 // Copy _src keys to _dest but except the ones that can be interpolated.
-template<typename _RawTrack, typename _Comparator, typename _Lerp>
+// _validator tests if the interpolated value of a key can replace it, and if
+// the segment of removed keys can be interpolated in between keys.
+template<typename _RawTrack, typename _Lerp, typename _Validator>
 void Filter(const _RawTrack& _src,
-            const _Comparator& _comparator,
             const _Lerp& _lerp,
-            float _tolerance,
-            float _hierarchical_tolerance,
-            float _hierarchy_length,
+            const _Validator& _validator,
             _RawTrack* _dest) {
   _dest->reserve(_src.size());
 
@@ -974,14 +1306,9 @@ void Filter(const _RawTrack& _src,
       last_src_pushed = i;
     } else if (i == _src.size() - 1) {
       // Don't push the last value if it's the same as last_src_pushed.
-      typename _RawTrack::const_reference left = _src[last_src_pushed];
-      typename _RawTrack::const_reference right = _src[i];
-      if (!_comparator(left.value,
-                       right.value,
-                       _tolerance,
-                       _hierarchical_tolerance,
-                       _hierarchy_length)) {
-        _dest->push_back(right);
+      if (!_validator(i, _src[last_src_pushed].value) ||
+          !_validator.Segment(last_src_pushed, i, LerpLeft())) {
+        _dest->push_back(_src[i]);
         last_src_pushed = i;
       }
     } else {
@@ -989,25 +1316,96 @@ void Filter(const _RawTrack& _src,
       // interpolated from keys last_src_pushed and i + 1.
       typename _RawTrack::const_reference left = _src[last_src_pushed];
       typename _RawTrack::const_reference right = _src[i + 1];
-      for (size_t j = last_src_pushed + 1; j <= i; ++j) {
+      bool valid = true;
+      for (size_t j = last_src_pushed + 1; valid && j <= i; ++j) {
         typename _RawTrack::const_reference test = _src[j];
         const float alpha = (test.time - left.time) / (right.time - left.time);
         assert(alpha >= 0.f && alpha <= 1.f);
-        if (!_comparator(_lerp(left.value, right.value, alpha),
-                         test.value,
-                         _tolerance,
-                         _hierarchical_tolerance,
-                         _hierarchy_length)) {
-          _dest->push_back(_src[i]);
-          last_src_pushed = i;
-          break;
-        }
+        valid = _validator(j, _lerp(left.value, right.value, alpha));
+      }
+      if (!valid || !_validator.Segment(last_src_pushed, i + 1, _lerp)) {
+        _dest->push_back(_src[i]);
+        last_src_pushed = i;
       }
     }
   }
   assert(_dest->size() <= _src.size());
 }
 
+// Tests if all keys in range ]_left,_right[ of _src can be interpolated from
+// keys _left and _right, as well as the segment in between keys. Returns as
+// soon as a key can't.
+template<typename _RawTrack, typename _Lerp, typename _Validator>
+bool Interpolable(const _RawTrack& _src,
+                  size_t _left,
+                  size_t _right,
+                  const _Lerp& _lerp,
+                  const _Validator& _validator) {
+  typename _RawTrack::const_reference left = _src[_left];
+  typename _RawTrack::const_reference right = _src[_right];
+  for (size_t j = _left + 1; j < _right; ++j) {
+    typename _RawTrack::const_reference test = _src[j];
+    const float alpha = (test.time - left.time) / (right.time - left.time);
+    assert(alpha >= 0.f && alpha <= 1.f);
+    if (!_validator(j, _lerp(left.value, right.value, alpha))) {
+      return false;
+    }
+  }
+  return _validator.Segment(_left, _right, _lerp);
+}
+
+// Copy _src keys to _dest but except the ones that can be interpolated, like
+// Filter does. From the last pushed key, segments are extended by doubling
+// their length while they're interpolable, then the longest interpolable one
+// is binary searched, so that a track of n keys costs O(n log n).
+template<typename _RawTrack, typename _Lerp, typename _Validator>
+void FilterBisect(const _RawTrack& _src,
+                  const _Lerp& _lerp,
+                  const _Validator& _validator,
+                  _RawTrack* _dest) {
+  _dest->reserve(_src.size());
+  if (_src.empty()) {
+    return;
+  }
+
+  // First key is always pushed.
+  _dest->push_back(_src[0]);
+
+  const size_t last = _src.size() - 1;
+  size_t left = 0;  // Index (in src) of the last pushed key.
+  while (left < last) {
+    // Finds valid and invalid segment ends, valid < invalid, by doubling
+    // segment length. left + 1 is always valid, as there's no key in between.
+    size_t valid = left + 1;
+    size_t invalid = last + 1;
+    for (size_t length = 2; left + length <= last; length *= 2) {
+      if (!Interpolable(_src, left, left + length, _lerp, _validator)) {
+        invalid = left + length;
+        break;
+      }
+      valid = left + length;
+    }
+
+    // Binary searches the longest valid segment in ]valid,invalid[.
+    while (invalid - valid > 1) {
+      const size_t middle = valid + (invalid - valid) / 2;
+      if (Interpolable(_src, left, middle, _lerp, _validator)) {
+        valid = middle;
+      } else {
+        invalid = middle;
+      }
+    }
+
+    // Don't push the last value if it's the same as the last pushed one.
+    if (valid != last || !_validator(last, _src[left].value) ||
+        !_validator.Segment(left, last, LerpLeft())) {
+      _dest->push_back(_src[valid]);
+    }
+    left = valid;
+  }
+  assert(_dest->size() <= _src.size());
+}
+
 // Translation filtering comparator.
 bool CompareTranslation(const math::Float3& _a,
                         const math::Float3& _b,
@@ -1055,6 +1453,478 @@ bool CompareScale(const math::Float3& _a,
   const math::Float3 l(_hierarchy_length);
   return Compare(_a * l, _b * l, _hierarchical_tolerance);
 }
+
+// Filters _src to _dest with _reduction algorithm, validating keys with
+// _validator.
+template<typename _RawTrack, typename _Lerp, typename _Validator>
+void Reduce(AnimationOptimizer::Reduction _reduction,
+            const _RawTrack& _src,
+            const _Lerp& _lerp,
+            const _Validator& _validator,
+            _RawTrack* _dest) {
+  if (_reduction == AnimationOptimizer::kReductionBisect) {
+    FilterBisect(_src, _lerp, _validator, _dest);
+  } else {
+    Filter(_src, _lerp, _validator, _dest);
+  }
+}
+
+// Filters _src to _dest with _reduction algorithm, comparing keys with
+// _comparator.
+template<typename _RawTrack, typename _Comparator, typename _Lerp>
+void Reduce(AnimationOptimizer::Reduction _reduction,
+            const _RawTrack& _src,
+            _Comparator _comparator,
+            const _Lerp& _lerp,
+            float _tolerance,
+            float _hierarchical_tolerance,
+            float _hierarchy_length,
+            _RawTrack* _dest) {
+  const CompareValidator<_RawTrack, _Comparator> validator = {
+    &_src, _comparator, _tolerance, _hierarchical_tolerance,
+    _hierarchy_length};
+  Reduce(_reduction, _src, _lerp, validator, _dest);
+}
+
+// Compares a time to a key time, to search sorted keys.
+struct KeyTimeLess {
+  template<typename _Key>
+  bool operator()(float _time, const _Key& _key) const {
+    return _time < _key.time;
+  }
+};
+
+// Samples _track at _time, interpolating keys with _lerp. Returns identity
+// value if _track has no key.
+template<typename _RawTrack, typename _Lerp>
+typename _RawTrack::value_type::Value SampleTrack(const _RawTrack& _track,
+                                                  float _time,
+                                                  const _Lerp& _lerp) {
+  if (_track.empty()) {
+    return _RawTrack::value_type::identity();
+  }
+  typename _RawTrack::const_iterator right =
+    std::upper_bound(_track.begin(), _track.end(), _time, KeyTimeLess());
+  if (right == _track.begin()) {
+    return right->value;
+  } else if (right == _track.end()) {
+    return _track.back().value;
+  }
+  typename _RawTrack::const_iterator left = right - 1;
+  const float alpha = (_time - left->time) / (right->time - left->time);
+  return _lerp(left->value, right->value, alpha);
+}
+
+// Packs _count local transforms to soa transforms, completing the last soa
+// element with identity.
+void PackSoa(const math::Transform* _transforms, int _count,
+             math::SoaTransform* _soa) {
+  for (int i = 0; i < _count; i += 4) {
+    const math::Transform identity = math::Transform::identity();
+    const math::Transform& t0 = _transforms[i];
+    const math::Transform& t1 = i + 1 < _count ? _transforms[i + 1] : identity;
+    const math::Transform& t2 = i + 2 < _count ? _transforms[i + 2] : identity;
+    const math::Transform& t3 = i + 3 < _count ? _transforms[i + 3] : identity;
+    const math::SoaTransform soa = {
+      {math::simd_float4::Load(t0.translation.x, t1.translation.x,
+                               t2.translation.x, t3.translation.x),
+       math::simd_float4::Load(t0.translation.y, t1.translation.y,
+                               t2.translation.y, t3.translation.y),
+       math::simd_float4::Load(t0.translation.z, t1.translation.z,
+                               t2.translation.z, t3.translation.z)},
+      {math::simd_float4::Load(t0.rotation.x, t1.rotation.x,
+                               t2.rotation.x, t3.rotation.x),
+       math::simd_float4::Load(t0.rotation.y, t1.rotation.y,
+                               t2.rotation.y, t3.rotation.y),
+       math::simd_float4::Load(t0.rotation.z, t1.rotation.z,
+                               t2.rotation.z, t3.rotation.z),
+       math::simd_float4::Load(t0.rotation.w, t1.rotation.w,
+                               t2.rotation.w, t3.rotation.w)},
+      {math::simd_float4::Load(t0.scale.x, t1.scale.x,
+                               t2.scale.x, t3.scale.x),
+       math::simd_float4::Load(t0.scale.y, t1.scale.y,
+                               t2.scale.y, t3.scale.y),
+       math::simd_float4::Load(t0.scale.z, t1.scale.z,
+                               t2.scale.z, t3.scale.z)}};
+    _soa[i / 4] = soa;
+  }
+}
+
+// Builds the affine matrix of _transform.
+math::Float4x4 ToMatrix(const math::Transform& _transform) {
+  return math::Float4x4::FromAffine(
+    math::simd_float4::Load3PtrU(&_transform.translation.x),
+    math::simd_float4::LoadPtrU(&_transform.rotation.x),
+    math::simd_float4::Load3PtrU(&_transform.scale.x));
+}
+
+// Measures model-space error of joint positions, at every key frame time of
+// an animation. Joints are optimized in skeleton order, so that parents are
+// optimized before their children. Error is measured on the joint being
+// optimized and all its descendants, with optimized ancestors and original
+// descendants. Every joint final position is thus measured once all the
+// tracks it depends on are optimized.
+struct ModelSpaceContext {
+  // Samples _input at every key frame time, and computes reference
+  // model-space matrices with the LocalToModelJob.
+  ModelSpaceContext(const RawAnimation& _input, const Skeleton& _skeleton,
+                    float _tolerance);
+
+  // Prepares positions of _joint and its descendants, relatively to _joint
+  // reference model-space matrix, so that they can be transformed by
+  // candidate _joint matrices.
+  void BeginJoint(int _joint);
+
+  // Updates current joint _member local transforms from its optimized
+  // _track, so that next tracks of this joint are validated against it.
+  template<typename _RawTrack, typename _Lerp>
+  void UpdateLocals(const _RawTrack& _track, const _Lerp& _lerp,
+                    typename _RawTrack::value_type::Value
+                      math::Transform::*_member) {
+    for (int f = 0; f < num_frames; ++f) {
+      locals[f * num_joints + joint].*_member =
+        SampleTrack(_track, times[f], _lerp);
+    }
+  }
+
+  // Computes current joint optimized model-space matrices, once all its
+  // tracks are optimized.
+  void EndJoint();
+
+  // Tests if model-space positions of current joint and its descendants
+  // remain within tolerance at _frame, if current joint local transform is
+  // replaced by _local.
+  bool Validate(int _frame, const math::Transform& _local) const;
+
+  // Finds frame indices of _track key times.
+  template<typename _RawTrack>
+  void FindFrames(const _RawTrack& _track,
+                  ozz::Vector<int>::Std* _frames) const {
+    _frames->resize(_track.size());
+    for (size_t i = 0; i < _track.size(); ++i) {
+      const ozz::Vector<float>::Std::const_iterator it =
+        std::lower_bound(times.begin(), times.end(), _track[i].time);
+      assert(it != times.end() && *it == _track[i].time);
+      (*_frames)[i] = static_cast<int>(it - times.begin());
+    }
+  }
+
+  const Skeleton* skeleton;
+  int num_joints;
+  int num_frames;
+  math::SimdFloat4 tolerance_sq;
+
+  // Sorted times of all animation key frames.
+  ozz::Vector<float>::Std times;
+
+  // Per frame local transforms, updated as joints are optimized.
+  ozz::Vector<math::Transform>::Std locals;
+
+  // Per frame reference and optimized model-space matrices.
+  ozz::Vector<math::Float4x4>::Std models;
+  ozz::Vector<math::Float4x4>::Std optimized_models;
+
+  // Current joint, and per frame soa positions of current joint and its
+  // descendants: relative to current joint and reference model-space.
+  int joint;
+  int num_groups;
+  ozz::Vector<int>::Std descendants;
+  ozz::Vector<char>::Std is_descendant;
+  ozz::Vector<math::SoaFloat3>::Std relatives;
+  ozz::Vector<math::SoaFloat3>::Std positions;
+};
+
+ModelSpaceContext::ModelSpaceContext(const RawAnimation& _input,
+                                     const Skeleton& _skeleton,
+                                     float _tolerance)
+  : skeleton(&_skeleton),
+    num_joints(_skeleton.num_joints()),
+    num_frames(0),
+    tolerance_sq(math::simd_float4::Load1(_tolerance * _tolerance)),
+    joint(-1),
+    num_groups(0) {
+  // Collects all key frame times.
+  for (int i = 0; i < num_joints; ++i) {
+    const RawAnimation::JointTrack& track = _input.tracks[i];
+    for (size_t j = 0; j < track.translations.size(); ++j) {
+      times.push_back(track.translations[j].time);
+    }
+    for (size_t j = 0; j < track.rotations.size(); ++j) {
+      times.push_back(track.rotations[j].time);
+    }
+    for (size_t j = 0; j < track.scales.size(); ++j) {
+      times.push_back(track.scales[j].time);
+    }
+  }
+  std::sort(times.begin(), times.end());
+  times.erase(std::unique(times.begin(), times.end()), times.end());
+  num_frames = static_cast<int>(times.size());
+
+  // Samples local transforms, and computes their model-space matrices.
+  locals.resize(num_frames * num_joints);
+  models.resize(num_frames * num_joints);
+  optimized_models.resize(num_frames * num_joints);
+  ozz::Vector<math::SoaTransform>::Std soa_locals(_skeleton.num_soa_joints());
+  for (int f = 0; f < num_frames; ++f) {
+    math::Transform* frame_locals = &locals[f * num_joints];
+    for (int i = 0; i < num_joints; ++i) {
+      const RawAnimation::JointTrack& track = _input.tracks[i];
+      frame_locals[i].translation =
+        SampleTrack(track.translations, times[f], LerpTranslation);
+      frame_locals[i].rotation =
+        SampleTrack(track.rotations, times[f], LerpRotation);
+      frame_locals[i].scale = SampleTrack(track.scales, times[f], LerpScale);
+    }
+    PackSoa(frame_locals, num_joints, &soa_locals[0]);
+
+    LocalToModelJob job;
+    job.skeleton = &_skeleton;
+    job.input = ozz::Range<const math::SoaTransform>(
+      &soa_locals[0], soa_locals.size());
+    job.output = ozz::Range<math::Float4x4>(
+      &models[f * num_joints], num_joints);
+    const bool success = job.Run();
+    assert(success);
+    (void)success;
+  }
+}
+
+void ModelSpaceContext::BeginJoint(int _joint) {
+  joint = _joint;
+
+  // Collects _joint and its descendants. Skeleton joints are breadth-first
+  // ordered, so descendants aren't contiguous, but they always follow their
+  // parent.
+  const Skeleton::JointProperties* properties =
+    skeleton->joint_properties().begin;
+  is_descendant.assign(num_joints, 0);
+  is_descendant[_joint] = 1;
+  descendants.clear();
+  descendants.push_back(_joint);
+  for (int i = _joint + 1; i < num_joints; ++i) {
+    const int parent = properties[i].parent;
+    if (parent != Skeleton::kNoParentIndex && is_descendant[parent]) {
+      is_descendant[i] = 1;
+      descendants.push_back(i);
+    }
+  }
+  const int count = static_cast<int>(descendants.size());
+  num_groups = (count + 3) / 4;
+
+  // Packs their positions by groups of 4, relative to _joint and in
+  // model-space. Last group is completed with the last joint.
+  relatives.resize(num_frames * num_groups);
+  positions.resize(num_frames * num_groups);
+  for (int f = 0; f < num_frames; ++f) {
+    const math::Float4x4* frame_models = &models[f * num_joints];
+    const math::Float4x4 inverse = math::Invert(frame_models[_joint]);
+    for (int g = 0; g < num_groups; ++g) {
+      math::SimdFloat4 relative[4];
+      math::SimdFloat4 position[4];
+      for (int l = 0; l < 4; ++l) {
+        const int descendant = descendants[math::Min(g * 4 + l, count - 1)];
+        position[l] = frame_models[descendant].cols[3];
+        relative[l] = math::TransformPoint(inverse, position[l]);
+      }
+      math::SimdFloat4 soa[3];
+      math::Transpose4x3(relative, soa);
+      const math::SoaFloat3 soa_relative = {soa[0], soa[1], soa[2]};
+      relatives[f * num_groups + g] = soa_relative;
+      math::Transpose4x3(position, soa);
+      const math::SoaFloat3 soa_position = {soa[0], soa[1], soa[2]};
+      positions[f * num_groups + g] = soa_position;
+    }
+  }
+}
+
+void ModelSpaceContext::EndJoint() {
+  const int parent = skeleton->joint_properties()[joint].parent;
+  for (int f = 0; f < num_frames; ++f) {
+    const math::Transform& local = locals[f * num_joints + joint];
+    math::Float4x4& model = optimized_models[f * num_joints + joint];
+    if (parent == Skeleton::kNoParentIndex) {
+      model = ToMatrix(local);
+    } else {
+      model = optimized_models[f * num_joints + parent] * ToMatrix(local);
+    }
+  }
+}
+
+bool ModelSpaceContext::Validate(int _frame,
+                                 const math::Transform& _local) const {
+  // Computes candidate model-space matrix, from optimized parent.
+  const int parent = skeleton->joint_properties()[joint].parent;
+  math::Float4x4 model = ToMatrix(_local);
+  if (parent != Skeleton::kNoParentIndex) {
+    model = optimized_models[_frame * num_joints + parent] * model;
+  }
+
+  // Splats matrix components, to transform 4 positions at once.
+  const math::SimdFloat4 m00 = math::SplatX(model.cols[0]);
+  const math::SimdFloat4 m01 = math::SplatY(model.cols[0]);
+  const math::SimdFloat4 m02 = math::SplatZ(model.cols[0]);
+  const math::SimdFloat4 m10 = math::SplatX(model.cols[1]);
+  const math::SimdFloat4 m11 = math::SplatY(model.cols[1]);
+  const math::SimdFloat4 m12 = math::SplatZ(model.cols[1]);
+  const math::SimdFloat4 m20 = math::SplatX(model.cols[2]);
+  const math::SimdFloat4 m21 = math::SplatY(model.cols[2]);
+  const math::SimdFloat4 m22 = math::SplatZ(model.cols[2]);
+  const math::SimdFloat4 m30 = math::SplatX(model.cols[3]);
+  const math::SimdFloat4 m31 = math::SplatY(model.cols[3]);
+  const math::SimdFloat4 m32 = math::SplatZ(model.cols[3]);
+
+  const math::SoaFloat3* relative = &relatives[_frame * num_groups];
+  const math::SoaFloat3* position = &positions[_frame * num_groups];
+  for (int g = 0; g < num_groups; ++g) {
+    const math::SoaFloat3& r = relative[g];
+    const math::SimdFloat4 dx =
+      m00 * r.x + m10 * r.y + m20 * r.z + m30 - position[g].x;
+    const math::SimdFloat4 dy =
+      m01 * r.x + m11 * r.y + m21 * r.z + m31 - position[g].y;
+    const math::SimdFloat4 dz =
+      m02 * r.x + m12 * r.y + m22 * r.z + m32 - position[g].z;
+    const math::SimdFloat4 error_sq = dx * dx + dy * dy + dz * dz;
+    if (!math::AreAllFalse(math::CmpGt(error_sq, tolerance_sq))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Validates keys against the comparator of their track type, and against the
+// model-space error of joints positions measured by a ModelSpaceContext.
+template<typename _RawTrack, typename _Comparator>
+struct ModelSpaceValidator {
+  typedef typename _RawTrack::value_type::Value Value;
+
+  // Tests if _value can replace the value of _src key _key.
+  bool operator()(size_t _key, const Value& _value) const {
+    // Local tolerance is tested first, as it's cheaper.
+    if (!compare(_key, _value)) {
+      return false;
+    }
+    const int frame = (*frames)[_key];
+    math::Transform local = context->locals[frame * context->num_joints +
+                                            context->joint];
+    local.*member = _value;
+    return context->Validate(frame, local);
+  }
+
+  // Tests if _src values interpolated by _lerp from key _left to key _right
+  // remain within model-space tolerance at every frame in between, including
+  // key frame times of other tracks.
+  template<typename _Lerp>
+  bool Segment(size_t _left, size_t _right, const _Lerp& _lerp) const {
+    typename _RawTrack::const_reference left = (*compare.src)[_left];
+    typename _RawTrack::const_reference right = (*compare.src)[_right];
+    for (int f = (*frames)[_left] + 1; f < (*frames)[_right]; ++f) {
+      const float alpha =
+        (context->times[f] - left.time) / (right.time - left.time);
+      math::Transform local = context->locals[f * context->num_joints +
+                                              context->joint];
+      local.*member = _lerp(left.value, right.value, alpha);
+      if (!context->Validate(f, local)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  CompareValidator<_RawTrack, _Comparator> compare;
+  const ModelSpaceContext* context;
+  const ozz::Vector<int>::Std* frames;
+  Value math::Transform::*member;
+};
+
+// Filters _src to _dest with _reduction algorithm, comparing keys with
+// _comparator and measuring model-space error with _context.
+template<typename _RawTrack, typename _Comparator, typename _Lerp>
+void ReduceModelSpace(AnimationOptimizer::Reduction _reduction,
+                      ModelSpaceContext* _context,
+                      const _RawTrack& _src,
+                      _Comparator _comparator,
+                      const _Lerp& _lerp,
+                      float _tolerance,
+                      float _hierarchical_tolerance,
+                      typename _RawTrack::value_type::Value
+                        math::Transform::*_member,
+                      _RawTrack* _dest) {
+  ozz::Vector<int>::Std frames;
+  _context->FindFrames(_src, &frames);
+
+  // Hierarchical comparison is disabled with a null hierarchy length, as it's
+  // replaced by the model-space error.
+  const ModelSpaceValidator<_RawTrack, _Comparator> validator = {
+    {&_src, _comparator, _tolerance, _hierarchical_tolerance, 0.f},
+    _context, &frames, _member};
+  Reduce(_reduction, _src, _lerp, validator, _dest);
+
+  _context->UpdateLocals(*_dest, _lerp, _member);
+}
+
+// Optimizes all _input tracks to _output, measuring model-space error.
+void OptimizeModelSpace(const AnimationOptimizer& _optimizer,
+                        const RawAnimation& _input,
+                        const Skeleton& _skeleton,
+                        RawAnimation* _output) {
+  ModelSpaceContext context(_input, _skeleton,
+                            _optimizer.hierarchical_tolerance);
+  for (int i = 0; i < _input.num_tracks(); ++i) {
+    const RawAnimation::JointTrack& input = _input.tracks[i];
+    RawAnimation::JointTrack& output = _output->tracks[i];
+    context.BeginJoint(i);
+    ReduceModelSpace(_optimizer.reduction, &context, input.translations,
+                     CompareTranslation, LerpTranslation,
+                     _optimizer.translation_tolerance,
+                     _optimizer.hierarchical_tolerance,
+                     &math::Transform::translation, &output.translations);
+    ReduceModelSpace(_optimizer.reduction, &context, input.rotations,
+                     CompareRotation, LerpRotation,
+                     _optimizer.rotation_tolerance,
+                     _optimizer.hierarchical_tolerance,
+                     &math::Transform::rotation, &output.rotations);
+    ReduceModelSpace(_optimizer.reduction, &context, input.scales,
+                     CompareScale, LerpScale,
+                     _optimizer.scale_tolerance,
+                     _optimizer.hierarchical_tolerance,
+                     &math::Transform::scale, &output.scales);
+    context.EndJoint();
+  }
+}
+
+// Tasks context, shared by all tasks.
+struct TaskContext {
+  const AnimationOptimizer* optimizer;
+  const RawAnimation* input;
+  const JointSpecs* hierarchical_joint_specs;
+  RawAnimation* output;
+};
+
+// Task function, filters track _index translations, rotations and scales.
+// Tracks are independent, so tasks only write to their own output track.
+void OptimizeTrack(void* _user_data, int _index) {
+  const TaskContext& context = *reinterpret_cast<TaskContext*>(_user_data);
+  const AnimationOptimizer& optimizer = *context.optimizer;
+  const RawAnimation::JointTrack& input = context.input->tracks[_index];
+  const JointSpec& spec = (*context.hierarchical_joint_specs)[_index];
+  RawAnimation::JointTrack& output = context.output->tracks[_index];
+
+  Reduce(optimizer.reduction, input.translations,
+         CompareTranslation, LerpTranslation,
+         optimizer.translation_tolerance,
+         optimizer.hierarchical_tolerance, spec.scale,
+         &output.translations);
+  Reduce(optimizer.reduction, input.rotations,
+         CompareRotation, LerpRotation,
+         optimizer.rotation_tolerance,
+         optimizer.hierarchical_tolerance, spec.length,
+         &output.rotations);
+  Reduce(optimizer.reduction, input.scales,
+         CompareScale, LerpScale,
+         optimizer.scale_tolerance,
+         optimizer.hierarchical_tolerance, spec.length,
+         &output.scales);
+}
 }  // namespace
 
 bool AnimationOptimizer::operator()(const RawAnimation& _input,
@@ -1076,31 +1946,42 @@ bool AnimationOptimizer::operator()(const RawAnimation& _input,
     return false;
   }
 
-  // First computes bone lengths, that will be used when filtering.
-  JointSpecs hierarchical_joint_specs;
-  BuildHierarchicalSpecs(_input, _skeleton, &hierarchical_joint_specs);
-  
   // Rebuilds output animation.
   _output->name = _input.name;
   _output->duration = _input.duration;
   _output->tracks.resize(_input.tracks.size());
-  
+
+  // Model-space error is measured joint after joint, from parents to
+  // children, so tracks are optimized sequentially.
+  if (error == kErrorModelSpace) {
+    OptimizeModelSpace(*this, _input, _skeleton, _output);
+    return _output->Validate();
+  }
+
+  // First computes bone lengths, that will be used when filtering.
+  JointSpecs hierarchical_joint_specs;
+  BuildHierarchicalSpecs(_input, _skeleton, &hierarchical_joint_specs);
+
+  // Reserves output keys up front, so that tasks don't allocate memory
+  // concurrently, which custom allocators aren't required to support. Output
+  // tracks never have more keys than input ones.
   for (size_t i = 0; i < _input.tracks.size(); ++i) {
-    Filter(_input.tracks[i].translations,
-           CompareTranslation, LerpTranslation,
-           translation_tolerance,
-           hierarchical_tolerance, hierarchical_joint_specs[i].scale,
-           &_output->tracks[i].translations);
-    Filter(_input.tracks[i].rotations,
-           CompareRotation, LerpRotation,
-           rotation_tolerance,
-           hierarchical_tolerance, hierarchical_joint_specs[i].length,
-           &_output->tracks[i].rotations);
-    Filter(_input.tracks[i].scales,
-           CompareScale, LerpScale,
-           scale_tolerance,
-           hierarchical_tolerance, hierarchical_joint_specs[i].length,
-           &_output->tracks[i].scales);
+    const RawAnimation::JointTrack& input = _input.tracks[i];
+    RawAnimation::JointTrack& output = _output->tracks[i];
+    output.translations.reserve(input.translations.size());
+    output.rotations.reserve(input.rotations.size());
+    output.scales.reserve(input.scales.size());
+  }
+
+  // Dispatches tracks.
+  TaskContext context = {this, &_input, &hierarchical_joint_specs, _output};
+  const int num_tracks = _input.num_tracks();
+  if (scheduler && num_tracks > 1) {
+    scheduler->Run(&OptimizeTrack, &context, num_tracks);
+  } else {
+    for (int i = 0; i < num_tracks; ++i) {
+      OptimizeTrack(&context, i);
+    }
   }
 
   // Output animation is always valid though.
@@ -1231,6 +2112,179 @@ bool AdditiveAnimationBuilder::operator()(const RawAnimation& _input,
 }  // animation
 }  // ozz
 
+// Including segmented_animation_builder.cc file.
+
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/segmented_animation_builder.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/math_ex.h"
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/segmented_animation.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace {
+
+// Samples track _track at time _time, using _lerp interpolation function that
+// matches runtime sampling.
+template<typename _Track>
+typename _Track::value_type::Value SampleTrack(
+    const _Track& _track, float _time,
+    typename _Track::value_type::Value (*_lerp)(
+      const typename _Track::value_type::Value&,
+      const typename _Track::value_type::Value&,
+      float)) {
+  assert(!_track.empty());
+  if (_time <= _track.front().time) {
+    return _track.front().value;
+  }
+  for (size_t i = 1; i < _track.size(); ++i) {
+    if (_time <= _track[i].time) {
+      const float alpha = (_time - _track[i - 1].time) /
+                          (_track[i].time - _track[i - 1].time);
+      return _lerp(_track[i - 1].value, _track[i].value, alpha);
+    }
+  }
+  return _track.back().value;
+}
+
+// Extracts keys of _src track in range [_begin,_end], and remaps them to range
+// [0,_end-_begin]. First and last keys are sampled at segment bounds.
+template<typename _Track>
+void ExtractSegment(
+    const _Track& _src, float _begin, float _end,
+    typename _Track::value_type::Value (*_lerp)(
+      const typename _Track::value_type::Value&,
+      const typename _Track::value_type::Value&,
+      float),
+    _Track* _dest) {
+  typedef typename _Track::value_type Key;
+  if (_src.empty()) {  // Identity keys will be added by the AnimationBuilder.
+    return;
+  }
+
+  const Key first = {0.f, SampleTrack(_src, _begin, _lerp)};
+  _dest->push_back(first);
+
+  const float duration = _end - _begin;
+  for (size_t i = 0; i < _src.size(); ++i) {
+    const float time = _src[i].time - _begin;
+    // Keys are kept strictly ordered, even with floating point rounding.
+    if (time > _dest->back().time && time < duration) {
+      const Key key = {time, _src[i].value};
+      _dest->push_back(key);
+    }
+  }
+
+  const Key last = {duration, SampleTrack(_src, _end, _lerp)};
+  _dest->push_back(last);
+}
+}  // namespace
+
+SegmentedAnimationBuilder::SegmentedAnimationBuilder()
+    : segment_duration(1.f),
+      rotation_format(Animation::kRotationStandard),
+      time_format(Animation::kTimeFloat) {
+}
+
+SegmentedAnimation* SegmentedAnimationBuilder::operator()(
+    const RawAnimation& _input) const {
+  // Tests _raw_animation validity.
+  if (!_input.Validate() || !(segment_duration > 0.f)) {
+    return NULL;
+  }
+
+  // Computes the number of segments. The last segment absorbs the remaining
+  // time if it's too small.
+  const float duration = _input.duration;
+  const int num_segments = math::Max(
+    1, static_cast<int>(std::ceil(duration / segment_duration - 1e-3f)));
+
+  SegmentedAnimation* animation =
+    memory::default_allocator()->New<SegmentedAnimation>();
+  animation->duration_ = duration;
+  animation->segment_duration_ = segment_duration;
+  animation->num_tracks_ = _input.num_tracks();
+  animation->Allocate(_input.name.length(), num_segments);
+  if (animation->name_) {
+    std::strcpy(animation->name_, _input.name.c_str());
+  }
+
+  // Builds every segment as a standalone animation.
+  AnimationBuilder builder;
+  builder.rotation_format = rotation_format;
+  builder.time_format = time_format;
+  RawAnimation raw_segment;
+  raw_segment.tracks.resize(_input.tracks.size());
+  for (int i = 0; i < num_segments; ++i) {
+    const float begin = i * segment_duration;
+    const float end = i == num_segments - 1 ? duration : begin + segment_duration;
+    raw_segment.duration = end - begin;
+
+    for (size_t j = 0; j < _input.tracks.size(); ++j) {
+      const RawAnimation::JointTrack& src = _input.tracks[j];
+      RawAnimation::JointTrack& dest = raw_segment.tracks[j];
+      dest.translations.clear();
+      dest.rotations.clear();
+      dest.scales.clear();
+      ExtractSegment(src.translations, begin, end, &LerpTranslation,
+                     &dest.translations);
+      ExtractSegment(src.rotations, begin, end, &LerpRotation,
+                     &dest.rotations);
+      ExtractSegment(src.scales, begin, end, &LerpScale, &dest.scales);
+    }
+
+    Animation* segment = builder(raw_segment);
+    if (!segment) {  // Shall not happen as input was validated.
+      memory::default_allocator()->Delete(animation);
+      return NULL;
+    }
+    animation->segments_.begin[i] = segment;
+  }
+
+  return animation;  // Success.
+}
+}  // offline
+}  // animation
+}  // ozz
+
 // Including raw_skeleton.cc file.
 
 //----------------------------------------------------------------------------//
@@ -35,6 +35,10 @@
 #include <cassert>
 #include <memory.h>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif  // _MSC_VER
+
 #include "ozz/base/maths/math_ex.h"
 
 namespace ozz {
@@ -45,10 +49,32 @@ struct Header {
   void* unaligned;
   size_t size;
 };
+
+// Atomically adds _value to _count, so that allocations can be traced from
+// concurrent threads.
+#if defined(_MSC_VER)
+typedef long AtomicCount;
+inline void AtomicAdd(volatile AtomicCount* _count, long _value) {
+  _InterlockedExchangeAdd(_count, _value);
+}
+#elif defined(__GNUC__) || defined(__clang__)
+typedef int AtomicCount;
+inline void AtomicAdd(volatile AtomicCount* _count, int _value) {
+  __sync_fetch_and_add(_count, _value);
+}
+#else
+// No atomic support, allocations must not be traced concurrently.
+typedef int AtomicCount;
+inline void AtomicAdd(volatile AtomicCount* _count, int _value) {
+  *_count += _value;
 }
+#endif
+}  // namespace
 
 // Implements the basic heap allocator->
 // Will trace allocation count and assert in case of a memory leak.
+// Allocation count is updated atomically, so the heap allocator is thread
+// safe.
 class HeapAllocator : public Allocator {
  public:
   HeapAllocator() :
@@ -74,7 +100,7 @@ class HeapAllocator : public Allocator {
     header->unaligned = unaligned;
     header->size = _size;
     // Allocation's succeeded.
-    ++allocation_count_;
+    AtomicAdd(&allocation_count_, 1);
     return aligned;
   }
 
@@ -88,7 +114,7 @@ class HeapAllocator : public Allocator {
       free(old_header->unaligned);
 
       // Deallocation completed.
-      --allocation_count_;
+      AtomicAdd(&allocation_count_, -1);
     }
     return new_block;
   }
@@ -99,14 +125,14 @@ class HeapAllocator : public Allocator {
         reinterpret_cast<char*>(_block) - sizeof(Header));
       free(header->unaligned);
       // Deallocation completed.
-      --allocation_count_;
+      AtomicAdd(&allocation_count_, -1);
     }
   }
 
  private:
   // Internal allocation count used to track memory leaks.
   // Should equals 0 at destruction time.
-  int allocation_count_;
+  volatile AtomicCount allocation_count_;
 };
 
 namespace {
@@ -358,6 +384,37 @@ IArchive::IArchive(Stream* _stream)
   *this >> endianness;
   endian_swap_ = endianness != GetNativeEndianness();
 }
+
+// In-place padding implementation.
+
+void PadInPlace(OArchive& _archive, size_t _alignment) {
+  assert((_alignment & (_alignment - 1)) == 0 &&
+         "Alignment must be a power of 2.");
+  const int tell = _archive.stream()->Tell();
+  assert(tell >= 0);
+  const size_t padding =
+    (_alignment - (static_cast<size_t>(tell) & (_alignment - 1))) &
+    (_alignment - 1);
+  for (size_t i = 0; i < padding; ++i) {
+    const uint8_t zero = 0;
+    _archive << zero;
+  }
+}
+
+bool PadInPlace(IArchive& _archive, size_t _alignment) {
+  assert((_alignment & (_alignment - 1)) == 0 &&
+         "Alignment must be a power of 2.");
+  const int tell = _archive.stream()->Tell();
+  if (tell < 0) {
+    return false;
+  }
+  const size_t padding =
+    (_alignment - (static_cast<size_t>(tell) & (_alignment - 1))) &
+    (_alignment - 1);
+  return padding == 0 ||
+         _archive.stream()->Seek(static_cast<int>(padding),
+                                 Stream::kCurrent) == 0;
+}
 }  // io
 }  // ozz
 
@@ -397,6 +454,21 @@ IArchive::IArchive(Stream* _stream)
 #include <cstring>
 #include <cassert>
 
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif  // WIN32_LEAN_AND_MEAN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif  // NOMINMAX
+#include <windows.h>
+#else  // _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
 #include "ozz/base/memory/allocator.h"
 #include "ozz/base/maths/math_ex.h"
 
@@ -477,8 +549,137 @@ size_t File::Size() const {
   return static_cast<size_t>(end);
 }
 
+// Starts MappedFile implementation.
+
+namespace {
+// Maps the whole content of file _filename. Returns NULL on failure, or if the
+// file is empty.
+const char* MapFile(const char* _filename, int* _size) {
+  *_size = 0;
+#ifdef _WIN32
+  HANDLE file = CreateFileA(_filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return NULL;
+  }
+  const char* data = NULL;
+  LARGE_INTEGER size;
+  if (GetFileSizeEx(file, &size) && size.QuadPart > 0 &&
+      size.QuadPart <= std::numeric_limits<int>::max()) {
+    HANDLE mapping =
+      CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping) {
+      data = reinterpret_cast<const char*>(
+        MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+      // The view keeps a reference to the mapping object.
+      CloseHandle(mapping);
+      if (data) {
+        *_size = static_cast<int>(size.QuadPart);
+      }
+    }
+  }
+  CloseHandle(file);
+  return data;
+#else  // _WIN32
+  const int fd = open(_filename, O_RDONLY);
+  if (fd == -1) {
+    return NULL;
+  }
+  const char* data = NULL;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0 &&
+      st.st_size <= std::numeric_limits<int>::max()) {
+    void* map = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ,
+                     MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED) {
+      data = reinterpret_cast<const char*>(map);
+      *_size = static_cast<int>(st.st_size);
+    }
+  }
+  // The mapping keeps a reference to the file.
+  close(fd);
+  return data;
+#endif  // _WIN32
+}
+}  // namespace
+
+MappedFile::MappedFile(const char* _filename)
+    : data_(NULL),
+      size_(0),
+      tell_(0) {
+  data_ = MapFile(_filename, &size_);
+}
+
+MappedFile::~MappedFile() {
+  Close();
+}
+
+void MappedFile::Close() {
+  if (data_) {
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+#else  // _WIN32
+    munmap(const_cast<char*>(data_), static_cast<size_t>(size_));
+#endif  // _WIN32
+    data_ = NULL;
+    size_ = 0;
+    tell_ = 0;
+  }
+}
+
+bool MappedFile::opened() const {
+  return data_ != NULL;
+}
+
+size_t MappedFile::Read(void* _buffer, size_t _size) {
+  const int read_size =
+    static_cast<int>(math::Min(static_cast<size_t>(size_ - tell_), _size));
+  std::memcpy(_buffer, data_ + tell_, read_size);
+  tell_ += read_size;
+  return read_size;
+}
+
+size_t MappedFile::Write(const void* /*_buffer*/, size_t /*_size*/) {
+  return 0;
+}
+
+int MappedFile::Seek(int _offset, Origin _origin) {
+  int origin;
+  switch (_origin) {
+    case kCurrent: origin = tell_; break;
+    case kEnd: origin = size_; break;
+    case kSet: origin = 0; break;
+    default: return -1;
+  }
+
+  // Exit if seeking before file begin or beyond file end.
+  if (origin < -_offset || _offset > size_ - origin) {
+    return -1;
+  }
+  tell_ = origin + _offset;
+  return 0;
+}
+
+int MappedFile::Tell() const {
+  return tell_;
+}
+
+size_t MappedFile::Size() const {
+  return static_cast<size_t>(size_);
+}
+
+const void* MappedFile::Map(size_t _size) {
+  if (!data_ || _size > static_cast<size_t>(size_ - tell_)) {
+    return NULL;
+  }
+  const char* data = data_ + tell_;
+  tell_ += static_cast<int>(_size);
+  return data;
+}
+
 // Starts MemoryStream implementation.
 const size_t MemoryStream::kBufferSizeIncrement = 16<<10;
+const size_t MemoryStream::kBufferAlignment = 16;
 const size_t MemoryStream::kMaxSize = std::numeric_limits<int>::max();
 
 MemoryStream::MemoryStream()
@@ -570,6 +771,16 @@ size_t MemoryStream::Size() const {
   return static_cast<size_t>(end_);
 }
 
+const void* MemoryStream::Map(size_t _size) {
+  // Mapping cannot go beyond the end of the stream.
+  if (tell_ > end_ || _size > static_cast<size_t>(end_ - tell_)) {
+    return NULL;
+  }
+  const char* data = buffer_ + tell_;
+  tell_ += static_cast<int>(_size);
+  return data;
+}
+
 bool MemoryStream::Resize(size_t _size) {
   if (_size > alloc_size_) {
     // Resize to the next multiple of kBufferSizeIncrement, requires
@@ -578,7 +789,8 @@ bool MemoryStream::Resize(size_t _size) {
       (MemoryStream::kBufferSizeIncrement & (kBufferSizeIncrement-1)) == 0);
 
     alloc_size_ = ozz::math::Align(_size, kBufferSizeIncrement);
-    buffer_ = ozz::memory::default_allocator()->Reallocate(buffer_, alloc_size_);
+    buffer_ = static_cast<char*>(ozz::memory::default_allocator()->Reallocate(
+      buffer_, alloc_size_, kBufferAlignment));
   }
   return _size == 0 || buffer_ != NULL;
 }
@@ -679,7 +891,9 @@ namespace ozz {
 namespace math {
 
 const char* SimdImplementationName() {
-#if defined(OZZ_SIMD_AVX)
+#if defined(OZZ_SIMD_AVX2)
+  return "AVX2";
+#elif defined(OZZ_SIMD_AVX)
   return "AVX";
 #elif defined(OZZ_SIMD_SSE4_2)
   return "SSE4.2";
@@ -74,18 +74,37 @@ bool SkinningJob::Validate() const {
   const int vertex_count_minus_1 = vertex_count > 0 ? vertex_count - 1 : 0;
   const int vertex_count_at_least_1 = vertex_count > 0;
 
-  // Checks indices, required.
-  valid &= joint_indices.begin != NULL;
-  valid &= joint_indices.Size() >=
-    joint_indices_stride * vertex_count_minus_1 +
-    sizeof(uint16_t) * influences_count * vertex_count_at_least_1;
+  // Checks indices, required in one (and only one) of the supported formats.
+  valid &= (joint_indices.begin != NULL) + (joint_indices8.begin != NULL) == 1;
+  if (joint_indices.begin) {
+    valid &= joint_indices.Size() >=
+      joint_indices_stride * vertex_count_minus_1 +
+      sizeof(uint16_t) * influences_count * vertex_count_at_least_1;
+  } else {
+    valid &= joint_indices8.Size() >=
+      joint_indices_stride * vertex_count_minus_1 +
+      sizeof(uint8_t) * influences_count * vertex_count_at_least_1;
+  }
 
-  // Checks weights, required if influences_count > 1. 
+  // Checks weights, required if influences_count > 1, in one (and only one) of
+  // the supported formats.
   if (influences_count != 1) {
-    valid &= joint_weights.begin != NULL;
-    valid &= joint_weights.Size() >=
-      joint_weights_stride * vertex_count_minus_1 +
-      sizeof(float) * (influences_count - 1) * vertex_count_at_least_1;
+    valid &= (joint_weights.begin != NULL) +
+             (joint_weights16.begin != NULL) +
+             (joint_weights8.begin != NULL) == 1;
+    if (joint_weights.begin) {
+      valid &= joint_weights.Size() >=
+        joint_weights_stride * vertex_count_minus_1 +
+        sizeof(float) * (influences_count - 1) * vertex_count_at_least_1;
+    } else if (joint_weights16.begin) {
+      valid &= joint_weights16.Size() >=
+        joint_weights_stride * vertex_count_minus_1 +
+        sizeof(uint16_t) * (influences_count - 1) * vertex_count_at_least_1;
+    } else {
+      valid &= joint_weights8.Size() >=
+        joint_weights_stride * vertex_count_minus_1 +
+        sizeof(uint8_t) * (influences_count - 1) * vertex_count_at_least_1;
+    }
   }
 
   // Checks positions, mandatory.
@@ -127,6 +146,68 @@ bool SkinningJob::Validate() const {
   return valid;
 }
 
+// Defines joint indices formats. Each provides the index type, and a function
+// that returns the beginning of job's indices array.
+struct Indices16 {
+  typedef uint16_t Type;
+  static OZZ_INLINE const Type* Begin(const SkinningJob& _job) {
+    return _job.joint_indices.begin;
+  }
+};
+
+struct Indices8 {
+  typedef uint8_t Type;
+  static OZZ_INLINE const Type* Begin(const SkinningJob& _job) {
+    return _job.joint_indices8.begin;
+  }
+};
+
+// Defines joint weights formats. Each provides the weight type, a function
+// that returns the beginning of job's weights array, and functions that
+// decode weights:
+// - Load1 decodes the weight pointed by _w, and replicates it to all the
+// components of the returned vector.
+// - Load decodes the 4 weights pointed by _w.
+struct WeightsFloat {
+  typedef float Type;
+  static OZZ_INLINE const Type* Begin(const SkinningJob& _job) {
+    return _job.joint_weights.begin;
+  }
+  static OZZ_INLINE math::SimdFloat4 Load1(const Type* _w) {
+    return math::simd_float4::Load1PtrU(_w);
+  }
+  static OZZ_INLINE math::SimdFloat4 Load(const Type* _w) {
+    return math::simd_float4::LoadPtrU(_w);
+  }
+};
+
+// Unsigned normalized integer weights, [0, 2^n - 1] mapping to [0, 1].
+template <typename _Ty>
+struct WeightsUNorm {
+  typedef _Ty Type;
+  static OZZ_INLINE math::SimdFloat4 Load1(const Type* _w) {
+    return math::simd_float4::Load1(
+      static_cast<float>(_w[0]) * (1.f / static_cast<_Ty>(-1)));
+  }
+  static OZZ_INLINE math::SimdFloat4 Load(const Type* _w) {
+    const math::SimdInt4 w = math::simd_int4::Load(_w[0], _w[1], _w[2], _w[3]);
+    return math::simd_float4::FromInt(w) *
+           math::simd_float4::Load1(1.f / static_cast<_Ty>(-1));
+  }
+};
+
+struct WeightsUNorm16 : public WeightsUNorm<uint16_t> {
+  static OZZ_INLINE const Type* Begin(const SkinningJob& _job) {
+    return _job.joint_weights16.begin;
+  }
+};
+
+struct WeightsUNorm8 : public WeightsUNorm<uint8_t> {
+  static OZZ_INLINE const Type* Begin(const SkinningJob& _job) {
+    return _job.joint_weights8.begin;
+  }
+};
+
 // For performance optimization reasons, every skinning variants (positions,
 // positions + normals, 1 to n influences...) are implemented as separate
 // specialized functions.
@@ -134,8 +215,11 @@ bool SkinningJob::Validate() const {
 // define a skeleton code (SKINNING_FN) for the skinning loop, which internally
 // calls MACRO that are shared or specialized according to skinning variants.
 
+// Skinning functions are templates of _Indices and _Weights formats.
+
 // Defines the skeleton code for the per vertex skinning loop.
 #define SKINNING_FN(_type, _it, _inf) \
+  template <typename _Indices, typename _Weights> \
   void SKINNING_FN_NAME(_type, _it, _inf)(const SkinningJob& _job) { \
     ASSERT_##_type() \
     ASSERT_##_it() \
@@ -182,7 +266,7 @@ bool SkinningJob::Validate() const {
 
 // Implements loop initializations for positions, ...
 #define INIT_P() \
-  const uint16_t* joint_indices = _job.joint_indices.begin; \
+  const typename _Indices::Type* joint_indices = _Indices::Begin(_job); \
   const float* in_positions = _job.in_positions.begin; \
   float* out_positions = _job.out_positions.begin;
 
@@ -203,7 +287,7 @@ bool SkinningJob::Validate() const {
 
 #define INIT_W2() \
   const math::SimdFloat4 one = math::simd_float4::one(); \
-  const float* joint_weights = _job.joint_weights.begin;
+  const typename _Weights::Type* joint_weights = _Weights::Begin(_job);
 
 #define INIT_W3() \
   INIT_W2()
@@ -221,7 +305,8 @@ bool SkinningJob::Validate() const {
 #define NEXT_W1()
 
 #define NEXT_W2() \
-  joint_weights = NEXT(const float*, joint_weights, _job.joint_weights_stride); \
+  joint_weights = NEXT(const typename _Weights::Type*, \
+                       joint_weights, _job.joint_weights_stride);
 
 #define NEXT_W3() \
   NEXT_W2()
@@ -233,7 +318,8 @@ bool SkinningJob::Validate() const {
   NEXT_W2()
 
 #define NEXT_P() \
-  joint_indices = NEXT(const uint16_t*, joint_indices, _job.joint_indices_stride); \
+  joint_indices = NEXT(const typename _Indices::Type*, \
+                       joint_indices, _job.joint_indices_stride); \
   in_positions = NEXT(const float*, in_positions, _job.in_positions_stride); \
   out_positions = NEXT(float*, out_positions, _job.out_positions_stride);
 
@@ -254,7 +340,7 @@ bool SkinningJob::Validate() const {
 // _OUTER functions restrict access to data that are sure to be readable from
 // the buffer.
 #define PREPARE_1_INNER(_it) \
-  const uint16_t i0 = joint_indices[0]; \
+  const int i0 = joint_indices[0]; \
   const math::Float4x4& transform = _job.joint_matrices[i0]; \
   PREPARE_##_it##_1()
 
@@ -272,9 +358,9 @@ bool SkinningJob::Validate() const {
   const math::Float4x4& it_transform = _job.joint_inverse_transpose_matrices[i0];
 
 #define PREPARE_2_INNER(_it) \
-  const math::SimdFloat4 w0 = math::simd_float4::Load1PtrU(joint_weights + 0); \
-  const uint16_t i0 = joint_indices[0]; \
-  const uint16_t i1 = joint_indices[1]; \
+  const math::SimdFloat4 w0 = _Weights::Load1(joint_weights + 0); \
+  const int i0 = joint_indices[0]; \
+  const int i1 = joint_indices[1]; \
   const math::Float4x4& m0 = _job.joint_matrices[i0]; \
   const math::Float4x4& m1 = _job.joint_matrices[i1]; \
   const math::SimdFloat4 w1 = one - w0; \
@@ -295,9 +381,9 @@ bool SkinningJob::Validate() const {
   PREPARE_2_INNER(_it)
 
 #define PREPARE_3_CONCAT(_it) \
-  const uint16_t i0 = joint_indices[0]; \
-  const uint16_t i1 = joint_indices[1]; \
-  const uint16_t i2 = joint_indices[2]; \
+  const int i0 = joint_indices[0]; \
+  const int i1 = joint_indices[1]; \
+  const int i2 = joint_indices[2]; \
   const math::Float4x4& m0 = _job.joint_matrices[i0]; \
   const math::Float4x4& m1 = _job.joint_matrices[i1]; \
   const math::Float4x4& m2 = _job.joint_matrices[i2]; \
@@ -319,21 +405,21 @@ bool SkinningJob::Validate() const {
                                       math::ColumnMultiply(mit2, w2); \
 
 #define PREPARE_3_INNER(_it) \
-  const math::SimdFloat4 w = math::simd_float4::LoadPtrU(joint_weights); \
+  const math::SimdFloat4 w = _Weights::Load(joint_weights); \
   const math::SimdFloat4 w0 = math::SplatX(w); \
   const math::SimdFloat4 w1 = math::SplatY(w); \
   PREPARE_3_CONCAT(_it)
 
 #define PREPARE_3_OUTER(_it) \
-  const math::SimdFloat4 w0 = math::simd_float4::Load1PtrU(joint_weights + 0); \
-  const math::SimdFloat4 w1 = math::simd_float4::Load1PtrU(joint_weights + 1); \
+  const math::SimdFloat4 w0 = _Weights::Load1(joint_weights + 0); \
+  const math::SimdFloat4 w1 = _Weights::Load1(joint_weights + 1); \
   PREPARE_3_CONCAT(_it)
 
 #define PREPARE_4_CONCAT(_it) \
-  const uint16_t i0 = joint_indices[0]; \
-  const uint16_t i1 = joint_indices[1]; \
-  const uint16_t i2 = joint_indices[2]; \
-  const uint16_t i3 = joint_indices[3]; \
+  const int i0 = joint_indices[0]; \
+  const int i1 = joint_indices[1]; \
+  const int i2 = joint_indices[2]; \
+  const int i3 = joint_indices[3]; \
   const math::Float4x4& m0 = _job.joint_matrices[i0]; \
   const math::Float4x4& m1 = _job.joint_matrices[i1]; \
   const math::Float4x4& m2 = _job.joint_matrices[i2]; \
@@ -359,25 +445,25 @@ bool SkinningJob::Validate() const {
                                       math::ColumnMultiply(mit3, w3); \
 
 #define PREPARE_4_INNER(_it) \
-  const math::SimdFloat4 w = math::simd_float4::LoadPtrU(joint_weights); \
+  const math::SimdFloat4 w = _Weights::Load(joint_weights); \
   const math::SimdFloat4 w0 = math::SplatX(w); \
   const math::SimdFloat4 w1 = math::SplatY(w); \
   const math::SimdFloat4 w2 = math::SplatZ(w); \
   PREPARE_4_CONCAT(_it)
 
 #define PREPARE_4_OUTER(_it) \
-  const math::SimdFloat4 w0 = math::simd_float4::Load1PtrU(joint_weights + 0); \
-  const math::SimdFloat4 w1 = math::simd_float4::Load1PtrU(joint_weights + 1); \
-  const math::SimdFloat4 w2 = math::simd_float4::Load1PtrU(joint_weights + 2); \
+  const math::SimdFloat4 w0 = _Weights::Load1(joint_weights + 0); \
+  const math::SimdFloat4 w1 = _Weights::Load1(joint_weights + 1); \
+  const math::SimdFloat4 w2 = _Weights::Load1(joint_weights + 2); \
   PREPARE_4_CONCAT(_it)
 
 #define PREPARE_NOIT_N() \
-  math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(joint_weights + 0); \
+  math::SimdFloat4 wsum = _Weights::Load1(joint_weights + 0); \
   math::Float4x4 transform = \
     math::ColumnMultiply(_job.joint_matrices[joint_indices[0]], wsum); \
   const int last = _job.influences_count - 1; \
   for (int j = 1; j < last; ++j) { \
-    const math::SimdFloat4 w = math::simd_float4::Load1PtrU(joint_weights + j); \
+    const math::SimdFloat4 w = _Weights::Load1(joint_weights + j); \
     wsum = wsum + w; \
     transform = transform + \
       math::ColumnMultiply(_job.joint_matrices[joint_indices[j]], w); \
@@ -387,16 +473,16 @@ bool SkinningJob::Validate() const {
   PREPARE_NOIT()
 
 #define PREPARE_IT_N() \
-  math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(joint_weights + 0); \
-  const uint16_t i0 = joint_indices[0]; \
+  math::SimdFloat4 wsum = _Weights::Load1(joint_weights + 0); \
+  const int i0 = joint_indices[0]; \
   math::Float4x4 transform = \
     math::ColumnMultiply(_job.joint_matrices[i0], wsum); \
   math::Float4x4 it_transform = \
     math::ColumnMultiply(_job.joint_inverse_transpose_matrices[i0], wsum); \
   const int last = _job.influences_count - 1; \
   for (int j = 1; j < last; ++j) { \
-    const uint16_t ij = joint_indices[j]; \
-    const math::SimdFloat4 w = math::simd_float4::Load1PtrU(joint_weights + j); \
+    const int ij = joint_indices[j]; \
+    const math::SimdFloat4 w = _Weights::Load1(joint_weights + j); \
     wsum = wsum + w; \
     transform = transform + \
       math::ColumnMultiply(_job.joint_matrices[ij], w); \
@@ -479,26 +565,71 @@ SKINNING_FN(PNT, NOIT, N)
 SKINNING_FN(PN, IT, N)
 SKINNING_FN(PNT, IT, N)
 
-// Defines a matrix of skinning function pointers. This matrix will then be
-// indexed according to skinning jobs parameters.
+// Defines a matrix of skinning function pointers, for every indices and weights
+// formats. This matrix will then be indexed according to skinning jobs
+// parameters.
 typedef void (*SkiningFct)(const SkinningJob&);
-static const SkiningFct kSkinningFct[2][5][3] = {
+template <typename _Indices, typename _Weights>
+struct SkinningFcts {
+  static const SkiningFct kFct[2][5][3];
+};
+
+#define SKINNING_FN_PTR(_type, _it, _inf) \
+  &SKINNING_FN_NAME(_type, _it, _inf)<_Indices, _Weights>
+
+template <typename _Indices, typename _Weights>
+const SkiningFct SkinningFcts<_Indices, _Weights>::kFct[2][5][3] = {
   {
-    {&SKINNING_FN_NAME(P, NOIT, 1), &SKINNING_FN_NAME(PN, NOIT, 1), &SKINNING_FN_NAME(PNT, NOIT, 1)},
-    {&SKINNING_FN_NAME(P, NOIT, 2), &SKINNING_FN_NAME(PN, NOIT, 2), &SKINNING_FN_NAME(PNT, NOIT, 2)},
-    {&SKINNING_FN_NAME(P, NOIT, 3), &SKINNING_FN_NAME(PN, NOIT, 3), &SKINNING_FN_NAME(PNT, NOIT, 3)},
-    {&SKINNING_FN_NAME(P, NOIT, 4), &SKINNING_FN_NAME(PN, NOIT, 4), &SKINNING_FN_NAME(PNT, NOIT, 4)},
-    {&SKINNING_FN_NAME(P, NOIT, N), &SKINNING_FN_NAME(PN, NOIT, N), &SKINNING_FN_NAME(PNT, NOIT, N)},
+    {SKINNING_FN_PTR(P, NOIT, 1),
+     SKINNING_FN_PTR(PN, NOIT, 1),
+     SKINNING_FN_PTR(PNT, NOIT, 1)},
+    {SKINNING_FN_PTR(P, NOIT, 2),
+     SKINNING_FN_PTR(PN, NOIT, 2),
+     SKINNING_FN_PTR(PNT, NOIT, 2)},
+    {SKINNING_FN_PTR(P, NOIT, 3),
+     SKINNING_FN_PTR(PN, NOIT, 3),
+     SKINNING_FN_PTR(PNT, NOIT, 3)},
+    {SKINNING_FN_PTR(P, NOIT, 4),
+     SKINNING_FN_PTR(PN, NOIT, 4),
+     SKINNING_FN_PTR(PNT, NOIT, 4)},
+    {SKINNING_FN_PTR(P, NOIT, N),
+     SKINNING_FN_PTR(PN, NOIT, N),
+     SKINNING_FN_PTR(PNT, NOIT, N)},
   },
   {
-    {&SKINNING_FN_NAME(P, NOIT, 1), &SKINNING_FN_NAME(PN, IT, 1), &SKINNING_FN_NAME(PNT, IT, 1)},
-    {&SKINNING_FN_NAME(P, NOIT, 2), &SKINNING_FN_NAME(PN, IT, 2), &SKINNING_FN_NAME(PNT, IT, 2)},
-    {&SKINNING_FN_NAME(P, NOIT, 3), &SKINNING_FN_NAME(PN, IT, 3), &SKINNING_FN_NAME(PNT, IT, 3)},
-    {&SKINNING_FN_NAME(P, NOIT, 4), &SKINNING_FN_NAME(PN, IT, 4), &SKINNING_FN_NAME(PNT, IT, 4)},
-    {&SKINNING_FN_NAME(P, NOIT, N), &SKINNING_FN_NAME(PN, IT, N), &SKINNING_FN_NAME(PNT, IT, N)},
+    {SKINNING_FN_PTR(P, NOIT, 1),
+     SKINNING_FN_PTR(PN, IT, 1),
+     SKINNING_FN_PTR(PNT, IT, 1)},
+    {SKINNING_FN_PTR(P, NOIT, 2),
+     SKINNING_FN_PTR(PN, IT, 2),
+     SKINNING_FN_PTR(PNT, IT, 2)},
+    {SKINNING_FN_PTR(P, NOIT, 3),
+     SKINNING_FN_PTR(PN, IT, 3),
+     SKINNING_FN_PTR(PNT, IT, 3)},
+    {SKINNING_FN_PTR(P, NOIT, 4),
+     SKINNING_FN_PTR(PN, IT, 4),
+     SKINNING_FN_PTR(PNT, IT, 4)},
+    {SKINNING_FN_PTR(P, NOIT, N),
+     SKINNING_FN_PTR(PN, IT, N),
+     SKINNING_FN_PTR(PNT, IT, N)},
   }
 };
 
+#undef SKINNING_FN_PTR
+
+// Selects the skinning function matrix that matches job's indices and weights
+// formats.
+template <typename _Indices>
+static const SkiningFct (*SelectFcts(const SkinningJob& _job))[5][3] {
+  if (_job.joint_weights16.begin != NULL) {
+    return SkinningFcts<_Indices, WeightsUNorm16>::kFct;
+  } else if (_job.joint_weights8.begin != NULL) {
+    return SkinningFcts<_Indices, WeightsUNorm8>::kFct;
+  }
+  // Default to float weights, also used when there's a single influence.
+  return SkinningFcts<_Indices, WeightsFloat>::kFct;
+}
+
 // Implements job Run function.
 bool SkinningJob::Run() const {
   // Exit with an error if job is invalid.
@@ -512,18 +643,1033 @@ bool SkinningJob::Run() const {
     return true;
   }
 
+  // Find skinning function matrix, according to indices and weights formats.
+  const SkiningFct (*fcts)[5][3] = joint_indices8.begin != NULL ?
+    SelectFcts<Indices8>(*this) : SelectFcts<Indices16>(*this);
+
   // Find skinning function index.
   const size_t it = joint_inverse_transpose_matrices.begin != NULL;
-  assert(it < OZZ_ARRAY_SIZE(kSkinningFct));
+  assert(it < 2);
+  const size_t inf =
+    static_cast<size_t>(influences_count) > OZZ_ARRAY_SIZE(fcts[0]) ?
+      OZZ_ARRAY_SIZE(fcts[0]) -1 : influences_count - 1;
+  assert(inf < OZZ_ARRAY_SIZE(fcts[0]));
+  const size_t fct = (in_normals.begin != NULL) + (in_tangents.begin != NULL);
+  assert(fct < OZZ_ARRAY_SIZE(fcts[0][0]));
+
+  // Calls skinning function. Cannot fail because job is valid.
+  fcts[it][inf][fct](*this);
+
+  return true;
+}
+}  // geometry
+}  // ozz
+
+// Including soa_skinning_job.cc file.
+
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/soa_skinning_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_wide.h"
+
+namespace ozz {
+namespace geometry {
+
+SoaSkinningJob::SoaSkinningJob()
+ : vertex_count(0),
+   influences_count(0) {
+}
+
+bool SoaSkinningJob::Validate() const {
+
+  // Start validation of all parameters.
+  bool valid = true;
+
+  // Checks vertex and influences bounds.
+  valid &= vertex_count >= 0;
+  valid &= influences_count > 0;
+
+  // Checks joints matrices, required.
+  valid &= joint_matrices.begin != NULL;
+  valid &= joint_matrices.end >= joint_matrices.begin;
+
+  // Checks optional inverse transpose matrices.
+  valid &= joint_inverse_transpose_matrices.end >=
+           joint_inverse_transpose_matrices.begin;
+
+  const size_t packets = static_cast<size_t>((vertex_count + 3) / 4);
+
+  // Checks indices, required.
+  valid &= joint_indices.begin != NULL;
+  valid &= joint_indices.Count() >= packets * influences_count * 4;
+
+  // Checks weights, required if influences_count > 1.
+  if (influences_count > 1) {
+    valid &= joint_weights.begin != NULL;
+    valid &= math::IsAligned(joint_weights.begin, 16);
+    valid &= joint_weights.Count() >= packets * (influences_count - 1) * 4;
+  }
+
+  // Checks positions, mandatory.
+  valid &= in_positions.begin != NULL;
+  valid &= in_positions.Count() >= packets;
+  valid &= out_positions.begin != NULL;
+  valid &= out_positions.Count() >= packets;
+
+  // Checks normals, optional.
+  if (in_normals.begin) {
+    valid &= in_normals.Count() >= packets;
+    valid &= out_normals.begin != NULL;
+    valid &= out_normals.Count() >= packets;
+
+    // Checks tangents, optional but requires normals.
+    if (in_tangents.begin) {
+      valid &= in_tangents.Count() >= packets;
+      valid &= out_tangents.begin != NULL;
+      valid &= out_tangents.Count() >= packets;
+    }
+  } else {
+    // Tangents are not supported if normals are not there.
+    valid &= in_tangents.begin == NULL;
+    valid &= in_tangents.end == NULL;
+  }
+
+  return valid;
+}
+
+namespace {
+
+// Soa affine matrix, made of the x, y and z components of the 4 columns, with
+// _Lanes::Simd components. It's templated on lanes traits rather than on simd
+// types, as simd types attributes would be ignored as template arguments.
+template <typename _Lanes>
+struct SoaAffine {
+  typename _Lanes::Simd cols[4][3];
+};
+
+// Defines the 4 lanes packet traits, which processes a single packet per loop.
+struct Lanes4 {
+  typedef math::SimdFloat4 Simd;
+  typedef math::SoaFloat3 Float3;
+  enum { kPackets = 1 };
+
+  static OZZ_INLINE Simd one() {
+    return math::simd_float4::one();
+  }
+
+  // Gathers the 4 joint matrices of a packet referenced by _indices, and
+  // transposes them to a soa affine matrix. _next is the number of indices
+  // from a packet to the next, unused here.
+  static OZZ_INLINE void Gather(const math::Float4x4* _matrices,
+                                const uint16_t* _indices,
+                                int _next,
+                                SoaAffine<Lanes4>* _out) {
+    (void)_next;
+    const math::Float4x4& m0 = _matrices[_indices[0]];
+    const math::Float4x4& m1 = _matrices[_indices[1]];
+    const math::Float4x4& m2 = _matrices[_indices[2]];
+    const math::Float4x4& m3 = _matrices[_indices[3]];
+    for (int i = 0; i < 4; ++i) {
+      const math::SimdFloat4 cols[4] = {
+        m0.cols[i], m1.cols[i], m2.cols[i], m3.cols[i]};
+      math::Transpose4x3(cols, _out->cols[i]);
+    }
+  }
+
+  // Loads the 4 weights of an influence. _next is the number of weights from
+  // a packet to the next, unused here.
+  static OZZ_INLINE Simd LoadWeight(const float* _weights, int _next) {
+    (void)_next;
+    return math::simd_float4::LoadPtr(_weights);
+  }
+
+  static OZZ_INLINE Float3 Load(const math::SoaFloat3* _in) {
+    return *_in;
+  }
+
+  static OZZ_INLINE void Store(const Float3& _v, math::SoaFloat3* _out) {
+    *_out = _v;
+  }
+};
+
+// Defines the 8 lanes packet traits, which processes two packets per loop.
+struct Lanes8 {
+  typedef math::SimdFloat8 Simd;
+  typedef math::WideSoaFloat3 Float3;
+  enum { kPackets = 2 };
+
+  static OZZ_INLINE Simd one() {
+    return math::simd_float8::one();
+  }
+
+  static OZZ_INLINE void Gather(const math::Float4x4* _matrices,
+                                const uint16_t* _indices,
+                                int _next,
+                                SoaAffine<Lanes8>* _out) {
+    SoaAffine<Lanes4> lo;
+    SoaAffine<Lanes4> hi;
+    Lanes4::Gather(_matrices, _indices, 0, &lo);
+    Lanes4::Gather(_matrices, _indices + _next, 0, &hi);
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        _out->cols[i][j] = math::simd_float8::Load(lo.cols[i][j],
+                                                   hi.cols[i][j]);
+      }
+    }
+  }
+
+  static OZZ_INLINE Simd LoadWeight(const float* _weights, int _next) {
+    return math::simd_float8::Load(math::simd_float4::LoadPtr(_weights),
+                                   math::simd_float4::LoadPtr(_weights + _next));
+  }
+
+  static OZZ_INLINE Float3 Load(const math::SoaFloat3* _in) {
+    return math::WideSoaFloat3::Load(_in[0], _in[1]);
+  }
+
+  static OZZ_INLINE void Store(const Float3& _v, math::SoaFloat3* _out) {
+    _out[0] = math::GetLow(_v);
+    _out[1] = math::GetHigh(_v);
+  }
+};
+
+// Computes the weighted soa matrix of a packet, from the _job.influences_count
+// joint matrices of _matrices palette.
+template <typename _Lanes, int _Influences>
+OZZ_INLINE void WeightPacket(const SoaSkinningJob& _job,
+                             const math::Float4x4* _matrices,
+                             const uint16_t* _indices,
+                             const float* _weights,
+                             SoaAffine<_Lanes>* _out) {
+  typedef typename _Lanes::Simd Simd;
+  const int influences = _Influences ? _Influences : _job.influences_count;
+  const int last = influences - 1;
+  const int next_indices = influences * 4;
+  const int next_weights = last * 4;
+
+  // A single influence has an implicit weight of 1.
+  if (influences == 1) {
+    _Lanes::Gather(_matrices, _indices, next_indices, _out);
+    return;
+  }
+
+  // Accumulates weighted matrices. The weight of the last influence is
+  // restored from the sum of the others.
+  Simd wsum = _Lanes::LoadWeight(_weights, next_weights);
+  SoaAffine<_Lanes> m;
+  _Lanes::Gather(_matrices, _indices, next_indices, &m);
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      _out->cols[i][j] = m.cols[i][j] * wsum;
+    }
+  }
+  for (int k = 1; k < influences; ++k) {
+    Simd w;
+    if (k < last) {
+      w = _Lanes::LoadWeight(_weights + k * 4, next_weights);
+      wsum = wsum + w;
+    } else {
+      w = _Lanes::one() - wsum;
+    }
+    _Lanes::Gather(_matrices, _indices + k * 4, next_indices, &m);
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        _out->cols[i][j] = math::MAdd(m.cols[i][j], w, _out->cols[i][j]);
+      }
+    }
+  }
+}
+
+// Transforms soa point _p by soa matrix _m.
+template <typename _Lanes>
+OZZ_INLINE typename _Lanes::Float3 TransformPoint(
+  const SoaAffine<_Lanes>& _m, const typename _Lanes::Float3& _p) {
+  const typename _Lanes::Float3 r = {
+    math::MAdd(_m.cols[0][0], _p.x,
+               math::MAdd(_m.cols[1][0], _p.y,
+                          math::MAdd(_m.cols[2][0], _p.z, _m.cols[3][0]))),
+    math::MAdd(_m.cols[0][1], _p.x,
+               math::MAdd(_m.cols[1][1], _p.y,
+                          math::MAdd(_m.cols[2][1], _p.z, _m.cols[3][1]))),
+    math::MAdd(_m.cols[0][2], _p.x,
+               math::MAdd(_m.cols[1][2], _p.y,
+                          math::MAdd(_m.cols[2][2], _p.z, _m.cols[3][2])))};
+  return r;
+}
+
+// Transforms soa vector _v by soa matrix _m.
+template <typename _Lanes>
+OZZ_INLINE typename _Lanes::Float3 TransformVector(
+  const SoaAffine<_Lanes>& _m, const typename _Lanes::Float3& _v) {
+  const typename _Lanes::Float3 r = {
+    math::MAdd(_m.cols[0][0], _v.x,
+               math::MAdd(_m.cols[1][0], _v.y, _m.cols[2][0] * _v.z)),
+    math::MAdd(_m.cols[0][1], _v.x,
+               math::MAdd(_m.cols[1][1], _v.y, _m.cols[2][1] * _v.z)),
+    math::MAdd(_m.cols[0][2], _v.x,
+               math::MAdd(_m.cols[1][2], _v.y, _m.cols[2][2] * _v.z))};
+  return r;
+}
+
+// Skins packets [_begin, _end[, _Lanes::kPackets at a time. _end - _begin
+// must be a multiple of _Lanes::kPackets.
+// _Influences is the number of influences, or 0 if it should be read from the
+// job.
+template <typename _Lanes, int _Influences>
+void SkinPackets(const SoaSkinningJob& _job, int _begin, int _end) {
+  typedef typename _Lanes::Float3 Float3;
+  assert((_end - _begin) % _Lanes::kPackets == 0);
+
+  const int influences = _Influences ? _Influences : _job.influences_count;
+  const bool normals = _job.in_normals.begin != NULL;
+  const bool tangents = _job.in_tangents.begin != NULL;
+  const bool it = normals && _job.joint_inverse_transpose_matrices.begin;
+
+  for (int i = _begin; i < _end; i += _Lanes::kPackets) {
+    const uint16_t* indices = _job.joint_indices.begin + i * influences * 4;
+    const float* weights = _job.joint_weights.begin + i * (influences - 1) * 4;
+
+    SoaAffine<_Lanes> transform;
+    WeightPacket<_Lanes, _Influences>(
+      _job, _job.joint_matrices.begin, indices, weights, &transform);
+
+    const Float3 in_p = _Lanes::Load(_job.in_positions.begin + i);
+    _Lanes::Store(TransformPoint(transform, in_p),
+                  _job.out_positions.begin + i);
+    if (!normals) {
+      continue;
+    }
+
+    // Vectors are transformed by inverse transpose matrices if provided.
+    SoaAffine<_Lanes> it_transform;
+    if (it) {
+      WeightPacket<_Lanes, _Influences>(
+        _job, _job.joint_inverse_transpose_matrices.begin, indices, weights,
+        &it_transform);
+    }
+    const SoaAffine<_Lanes>& vector_transform =
+      it ? it_transform : transform;
+
+    const Float3 in_n = _Lanes::Load(_job.in_normals.begin + i);
+    _Lanes::Store(TransformVector(vector_transform, in_n),
+                  _job.out_normals.begin + i);
+    if (tangents) {
+      const Float3 in_t = _Lanes::Load(_job.in_tangents.begin + i);
+      _Lanes::Store(TransformVector(vector_transform, in_t),
+                    _job.out_tangents.begin + i);
+    }
+  }
+}
+
+// Skins all job's packets, by pairs using 8 lanes, then the remaining one
+// using 4 lanes.
+template <int _Influences>
+void SkinAll(const SoaSkinningJob& _job) {
+  const int packets = (_job.vertex_count + 3) / 4;
+  const int pairs = packets & ~1;
+  SkinPackets<Lanes8, _Influences>(_job, 0, pairs);
+  SkinPackets<Lanes4, _Influences>(_job, pairs, packets);
+}
+
+// Defines skinning functions for 1 to 4 influences, and any number of
+// influences.
+typedef void (*SoaSkinningFct)(const SoaSkinningJob&);
+const SoaSkinningFct kSoaSkinningFct[] = {
+  &SkinAll<1>, &SkinAll<2>, &SkinAll<3>, &SkinAll<4>, &SkinAll<0>};
+}  // namespace
+
+bool SoaSkinningJob::Run() const {
+  // Exit with an error if job is invalid.
+  if (!Validate()) {
+    return false;
+  }
+
+  // Finds skinning function index.
+  const size_t inf =
+    static_cast<size_t>(influences_count) > OZZ_ARRAY_SIZE(kSoaSkinningFct) ?
+      OZZ_ARRAY_SIZE(kSoaSkinningFct) - 1 : influences_count - 1;
+  assert(inf < OZZ_ARRAY_SIZE(kSoaSkinningFct));
+
+  // Calls skinning function. Cannot fail because job is valid.
+  kSoaSkinningFct[inf](*this);
+
+  return true;
+}
+
+bool PackSoaVertices(Range<const float> _in,
+                     size_t _in_stride,
+                     int _count,
+                     Range<math::SoaFloat3> _out) {
+  if (_count < 0) {
+    return false;
+  }
+  const size_t packets = static_cast<size_t>((_count + 3) / 4);
+  if (_out.Count() < packets) {
+    return false;
+  }
+  if (_count == 0) {
+    return true;
+  }
+  if (!_in.begin ||
+      _in.Size() < _in_stride * (_count - 1) + sizeof(float) * 3) {
+    return false;
+  }
+
+  for (size_t i = 0; i < packets; ++i) {
+    float soa[3][4];
+    for (int j = 0; j < 4; ++j) {
+      // Pads with the last vertex.
+      const int vertex = math::Min(static_cast<int>(i * 4 + j), _count - 1);
+      const float* in = reinterpret_cast<const float*>(
+        reinterpret_cast<uintptr_t>(_in.begin) + vertex * _in_stride);
+      soa[0][j] = in[0];
+      soa[1][j] = in[1];
+      soa[2][j] = in[2];
+    }
+    const math::SoaFloat3 packet = {math::simd_float4::LoadPtrU(soa[0]),
+                                    math::simd_float4::LoadPtrU(soa[1]),
+                                    math::simd_float4::LoadPtrU(soa[2])};
+    _out[i] = packet;
+  }
+  return true;
+}
+
+bool UnpackSoaVertices(Range<const math::SoaFloat3> _in,
+                       int _count,
+                       Range<float> _out,
+                       size_t _out_stride) {
+  if (_count < 0) {
+    return false;
+  }
+  const size_t packets = static_cast<size_t>((_count + 3) / 4);
+  if (_in.Count() < packets) {
+    return false;
+  }
+  if (_count == 0) {
+    return true;
+  }
+  if (!_out.begin ||
+      _out.Size() < _out_stride * (_count - 1) + sizeof(float) * 3) {
+    return false;
+  }
+
+  for (size_t i = 0; i < packets; ++i) {
+    float soa[3][4];
+    math::StorePtrU(_in[i].x, soa[0]);
+    math::StorePtrU(_in[i].y, soa[1]);
+    math::StorePtrU(_in[i].z, soa[2]);
+    const int count = math::Min(4, static_cast<int>(_count - i * 4));
+    for (int j = 0; j < count; ++j) {
+      float* out = reinterpret_cast<float*>(
+        reinterpret_cast<uintptr_t>(_out.begin) + (i * 4 + j) * _out_stride);
+      out[0] = soa[0][j];
+      out[1] = soa[1][j];
+      out[2] = soa[2][j];
+    }
+  }
+  return true;
+}
+
+bool PackSoaInfluences(int _count,
+                       int _influences_count,
+                       Range<const uint16_t> _indices,
+                       size_t _indices_stride,
+                       Range<const float> _weights,
+                       size_t _weights_stride,
+                       Range<uint16_t> _out_indices,
+                       Range<float> _out_weights) {
+  if (_count < 0 || _influences_count <= 0) {
+    return false;
+  }
+  const size_t packets = static_cast<size_t>((_count + 3) / 4);
+  const int last = _influences_count - 1;
+  if (_out_indices.Count() < packets * _influences_count * 4 ||
+      _out_weights.Count() < packets * last * 4) {
+    return false;
+  }
+  if (_count == 0) {
+    return true;
+  }
+  if (!_indices.begin ||
+      _indices.Size() < _indices_stride * (_count - 1) +
+                        sizeof(uint16_t) * _influences_count) {
+    return false;
+  }
+  if (last > 0 &&
+      (!_weights.begin ||
+       _weights.Size() < _weights_stride * (_count - 1) +
+                         sizeof(float) * last)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < packets; ++i) {
+    uint16_t* out_indices = _out_indices.begin + i * _influences_count * 4;
+    float* out_weights = _out_weights.begin + i * last * 4;
+    for (int j = 0; j < 4; ++j) {
+      // Pads with the last vertex.
+      const int vertex = math::Min(static_cast<int>(i * 4 + j), _count - 1);
+      const uint16_t* indices = reinterpret_cast<const uint16_t*>(
+        reinterpret_cast<uintptr_t>(_indices.begin) +
+          vertex * _indices_stride);
+      for (int k = 0; k < _influences_count; ++k) {
+        out_indices[k * 4 + j] = indices[k];
+      }
+    }
+    for (int j = 0; j < 4; ++j) {
+      const int vertex = math::Min(static_cast<int>(i * 4 + j), _count - 1);
+      const float* weights = reinterpret_cast<const float*>(
+        reinterpret_cast<uintptr_t>(_weights.begin) + vertex * _weights_stride);
+      for (int k = 0; k < last; ++k) {
+        out_weights[k * 4 + j] = weights[k];
+      }
+    }
+  }
+  return true;
+}
+}  // geometry
+}  // ozz
+
+// Including parallel_skinning_job.cc file.
+
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/parallel_skinning_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace geometry {
+
+ParallelSkinningJob::ParallelSkinningJob()
+ : grain(1024),
+   scheduler(NULL) {
+}
+
+bool ParallelSkinningJob::Validate() const {
+  bool valid = job.Validate();
+  valid &= grain > 0;
+  return valid;
+}
+
+namespace {
+
+// Computes the number of vertices of a buffer of stride _stride that match a
+// whole number of cache lines.
+int CacheLineVertices(size_t _stride) {
+  int vertices = 1;
+  while ((_stride * vertices) % ParallelSkinningJob::kCacheLineSize != 0 &&
+         vertices < ParallelSkinningJob::kCacheLineSize) {
+    vertices *= 2;
+  }
+  return vertices;
+}
+
+// Offsets _range begin by _count elements of _stride bytes.
+template <typename _Ty>
+void Offset(Range<_Ty>* _range, size_t _stride, int _count) {
+  if (_range->begin) {
+    _range->begin = reinterpret_cast<_Ty*>(
+      reinterpret_cast<uintptr_t>(_range->begin) + _stride * _count);
+  }
+}
+
+// Tasks context, shared by all tasks.
+struct TaskContext {
+  const SkinningJob* job;
+  int range_size;
+};
+
+// Task function, skins the vertex range _index.
+void SkinRange(void* _user_data, int _index) {
+  const TaskContext& context = *reinterpret_cast<TaskContext*>(_user_data);
+  const SkinningJob& job = *context.job;
+  const int range_size = context.range_size;
+  const int begin = _index * range_size;
+  assert(begin < job.vertex_count);
+
+  // Offsets all job buffers to the beginning of the range.
+  SkinningJob range_job = job;
+  range_job.vertex_count = math::Min(range_size, job.vertex_count - begin);
+  Offset(&range_job.joint_indices, job.joint_indices_stride, begin);
+  Offset(&range_job.joint_indices8, job.joint_indices_stride, begin);
+  if (job.influences_count > 1) {
+    Offset(&range_job.joint_weights, job.joint_weights_stride, begin);
+    Offset(&range_job.joint_weights16, job.joint_weights_stride, begin);
+    Offset(&range_job.joint_weights8, job.joint_weights_stride, begin);
+  }
+  Offset(&range_job.in_positions, job.in_positions_stride, begin);
+  Offset(&range_job.in_normals, job.in_normals_stride, begin);
+  Offset(&range_job.in_tangents, job.in_tangents_stride, begin);
+  Offset(&range_job.out_positions, job.out_positions_stride, begin);
+  Offset(&range_job.out_normals, job.out_normals_stride, begin);
+  Offset(&range_job.out_tangents, job.out_tangents_stride, begin);
+
+  // Cannot fail as a sub range of a valid job is valid.
+  const bool success = range_job.Run();
+  assert(success);
+  (void)success;
+}
+}  // namespace
+
+int ParallelSkinningJob::range_size() const {
+  if (!Validate()) {
+    return 0;
+  }
+
+  // Rounds grain up to a multiple of the vertices of a cache line. Strides are
+  // checked for all outputs, as they can be interleaved or not.
+  int alignment = CacheLineVertices(job.out_positions_stride);
+  if (job.out_normals.begin) {
+    alignment = math::Max(alignment,
+                          CacheLineVertices(job.out_normals_stride));
+  }
+  if (job.out_tangents.begin) {
+    alignment = math::Max(alignment,
+                          CacheLineVertices(job.out_tangents_stride));
+  }
+  return (grain + alignment - 1) / alignment * alignment;
+}
+
+bool ParallelSkinningJob::Run() const {
+  // Exit with an error if job is invalid.
+  if (!Validate()) {
+    return false;
+  }
+
+  TaskContext context = {&job, range_size()};
+  const int ranges =
+    (job.vertex_count + context.range_size - 1) / context.range_size;
+
+  // Dispatches ranges.
+  if (scheduler && ranges > 1) {
+    scheduler->Run(&SkinRange, &context, ranges);
+  } else {
+    for (int i = 0; i < ranges; ++i) {
+      SkinRange(&context, i);
+    }
+  }
+
+  return true;
+}
+}  // geometry
+}  // ozz
+
+// Including dual_quaternion_skinning_job.cc file.
+
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/dual_quaternion_skinning_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+namespace geometry {
+
+DualQuaternionPaletteJob::DualQuaternionPaletteJob() {
+}
+
+bool DualQuaternionPaletteJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL pointers.
+  valid &= models.begin != NULL && models.end >= models.begin;
+  valid &= inverse_bind_poses.begin != NULL &&
+           inverse_bind_poses.end >= inverse_bind_poses.begin;
+  valid &= output.begin != NULL && output.end >= output.begin;
+
+  // Test ranges size.
+  valid &= inverse_bind_poses.Count() >= models.Count();
+  valid &= output.Count() >= models.Count();
+
+  return valid;
+}
+
+bool DualQuaternionPaletteJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const size_t count = models.Count();
+  for (size_t i = 0; i < count; ++i) {
+    const math::Float4x4 matrix = models[i] * inverse_bind_poses[i];
+
+    // Extracts rigid part of the transformation.
+    math::SimdFloat4 translation, rotation, scale;
+    if (!math::ToAffine(matrix, &translation, &rotation, &scale)) {
+      translation = matrix.cols[3];
+      rotation = math::simd_float4::w_axis();
+    }
+
+    // dual = .5 * t * real, where t is the pure quaternion (x, y, z, 0) made
+    // of the translation.
+    const math::SimdInt4 mask_fff0 = math::simd_int4::mask_fff0();
+    const math::SimdFloat4 half = math::simd_float4::Load1(.5f);
+    const math::SimdFloat4 t = math::And(translation, mask_fff0);
+    const math::SimdFloat4 dual_xyz =
+      math::Cross3(t, rotation) + t * math::SplatW(rotation);
+    const math::SimdFloat4 dual_w = math::SplatX(-math::Dot3(t, rotation));
+    DualQuaternion& dq = output.begin[i];
+    dq.real = rotation;
+    dq.dual = math::Select(mask_fff0, dual_xyz, dual_w) * half;
+  }
+
+  return true;
+}
+
+DualQuaternionSkinningJob::DualQuaternionSkinningJob()
+ : vertex_count(0),
+   influences_count(0),
+   joint_indices_stride(0),
+   joint_weights_stride(0),
+   in_positions_stride(0),
+   in_normals_stride(0),
+   in_tangents_stride(0),
+   out_positions_stride(0),
+   out_normals_stride(0),
+   out_tangents_stride(0) {
+}
+
+bool DualQuaternionSkinningJob::Validate() const {
+
+  // Start validation of all parameters.
+  bool valid = true;
+
+  // Checks influences bounds.
+  valid &= influences_count > 0;
+
+  // Checks joints dual quaternions, required.
+  valid &= joint_dual_quaternions.begin != NULL;
+  valid &= joint_dual_quaternions.end >= joint_dual_quaternions.begin;
+
+  // Prepares local variables used to compute buffer size.
+  const int vertex_count_minus_1 = vertex_count > 0 ? vertex_count - 1 : 0;
+  const int vertex_count_at_least_1 = vertex_count > 0;
+
+  // Checks indices, required.
+  valid &= joint_indices.Size() >=
+    joint_indices_stride * vertex_count_minus_1 +
+    sizeof(uint16_t) * influences_count * vertex_count_at_least_1;
+
+  // Checks weights, required if influences_count > 1.
+  if (influences_count != 1) {
+    valid &= joint_weights.Size() >=
+      joint_weights_stride * vertex_count_minus_1 +
+      sizeof(float) * (influences_count - 1) * vertex_count_at_least_1;
+  }
+
+  // Checks positions, mandatory.
+  valid &= in_positions.Size() >=
+      in_positions_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+  valid &= out_positions.begin != NULL;
+  valid &= out_positions.Size() >=
+      out_positions_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+
+  // Checks normals, optional.
+  if (in_normals.begin) {
+    valid &= in_normals.Size() >=
+      in_normals_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+    valid &= out_normals.begin != NULL;
+    valid &= out_normals.Size() >=
+      out_normals_stride * vertex_count_minus_1 +
+      sizeof(float) * 3 * vertex_count_at_least_1;
+
+    // Checks tangents, optional but requires normals.
+    if (in_tangents.begin) {
+      valid &= in_tangents.Size() >=
+        in_tangents_stride * vertex_count_minus_1 +
+        sizeof(float) * 3 * vertex_count_at_least_1;
+      valid &= out_tangents.begin != NULL;
+      valid &= out_tangents.Size() >=
+        out_tangents_stride * vertex_count_minus_1 +
+        sizeof(float) * 3 * vertex_count_at_least_1;
+    }
+  } else {
+    // Tangents are not supported if normals are not there.
+    valid &= in_tangents.begin == NULL;
+    valid &= in_tangents.end == NULL;
+  }
+
+  return valid;
+}
+
+namespace {
+
+// Blends the dual quaternions of the joints influencing a vertex, and
+// normalizes the result. _Influences is the number of influences when known
+// at compile time, or 0 to use job's influences_count. Dual quaternions are
+// blended in the hemisphere of the first one, as q and -q represent the same
+// rotation.
+template <int _Influences>
+OZZ_INLINE void BlendDualQuaternions(const DualQuaternionSkinningJob& _job,
+                                     const uint16_t* _indices,
+                                     const float* _weights,
+                                     math::SimdFloat4* _real,
+                                     math::SimdFloat4* _dual) {
+  const DualQuaternion& dq0 = _job.joint_dual_quaternions[_indices[0]];
+  if (_Influences == 1) {
+    // Palette dual quaternions are already normalized.
+    *_real = dq0.real;
+    *_dual = dq0.dual;
+    return;
+  }
+  const int last = (_Influences ? _Influences : _job.influences_count) - 1;
+
+  const math::SimdFloat4 w0 = math::simd_float4::Load1PtrU(_weights);
+  math::SimdFloat4 wsum = w0;
+  math::SimdFloat4 real = dq0.real * w0;
+  math::SimdFloat4 dual = dq0.dual * w0;
+  for (int i = 1; i <= last; ++i) {
+    const DualQuaternion& dq = _job.joint_dual_quaternions[_indices[i]];
+    math::SimdFloat4 w;
+    if (i != last) {
+      w = math::simd_float4::Load1PtrU(_weights + i);
+      wsum = wsum + w;
+    } else {
+      w = math::simd_float4::one() - wsum;
+    }
+    const math::SimdInt4 sign =
+      math::Sign(math::SplatX(math::Dot4(dq0.real, dq.real)));
+    const math::SimdFloat4 signed_w = math::Xor(w, sign);
+    real = real + dq.real * signed_w;
+    dual = dual + dq.dual * signed_w;
+  }
+
+  const math::SimdFloat4 inv_len =
+    math::SplatX(math::RSqrtEstNR(math::Length4Sqr(real)));
+  *_real = real * inv_len;
+  *_dual = dual * inv_len;
+}
+
+// Rotates vector _v by unit quaternion _q.
+OZZ_INLINE math::SimdFloat4 Rotate(math::_SimdFloat4 _q,
+                                   math::_SimdFloat4 _v) {
+  const math::SimdFloat4 a = math::Cross3(_q, _v) + math::SplatW(_q) * _v;
+  const math::SimdFloat4 b = math::Cross3(_q, a);
+  return _v + b + b;
+}
+
+// Transforms point _p by unit dual quaternion (_real, _dual).
+OZZ_INLINE math::SimdFloat4 Transform(math::_SimdFloat4 _real,
+                                      math::_SimdFloat4 _dual,
+                                      math::_SimdFloat4 _p) {
+  const math::SimdFloat4 t = math::Cross3(_real, _dual) +
+                             math::SplatW(_real) * _dual -
+                             math::SplatW(_dual) * _real;
+  return Rotate(_real, _p) + t + t;
+}
+
+// Loads 3 floats. The 4th component is also read if it's _Safe to, that is
+// for all vertices but the last one.
+template <bool _Safe>
+OZZ_INLINE math::SimdFloat4 Load3(const float* _f) {
+  return _Safe ?
+    math::simd_float4::LoadPtrU(_f) : math::simd_float4::Load3PtrU(_f);
+}
+
+// Defines job's buffers iterators.
+struct Iterators {
+  explicit Iterators(const DualQuaternionSkinningJob& _job)
+    : indices(_job.joint_indices.begin),
+      weights(_job.joint_weights.begin),
+      in_positions(_job.in_positions.begin),
+      in_normals(_job.in_normals.begin),
+      in_tangents(_job.in_tangents.begin),
+      out_positions(_job.out_positions.begin),
+      out_normals(_job.out_normals.begin),
+      out_tangents(_job.out_tangents.begin) {
+  }
+  const uint16_t* indices;
+  const float* weights;
+  const float* in_positions;
+  const float* in_normals;
+  const float* in_tangents;
+  float* out_positions;
+  float* out_normals;
+  float* out_tangents;
+};
+
+// Skins the vertex pointed by _it. Positions are always transformed, normals
+// and tangents are transformed according to _Normals and _Tangents.
+template <int _Influences, bool _Normals, bool _Tangents, bool _Safe>
+OZZ_INLINE void SkinVertex(const DualQuaternionSkinningJob& _job,
+                           const Iterators& _it) {
+  math::SimdFloat4 real, dual;
+  BlendDualQuaternions<_Influences>(
+    _job, _it.indices, _it.weights, &real, &dual);
+
+  const math::SimdFloat4 in_p = Load3<_Safe>(_it.in_positions);
+  math::Store3PtrU(Transform(real, dual, in_p), _it.out_positions);
+  if (_Normals) {
+    const math::SimdFloat4 in_n = Load3<_Safe>(_it.in_normals);
+    math::Store3PtrU(Rotate(real, in_n), _it.out_normals);
+  }
+  if (_Tangents) {
+    const math::SimdFloat4 in_t = Load3<_Safe>(_it.in_tangents);
+    math::Store3PtrU(Rotate(real, in_t), _it.out_tangents);
+  }
+}
+
+// Skins all job's vertices.
+template <int _Influences, bool _Normals, bool _Tangents>
+void SkinVertices(const DualQuaternionSkinningJob& _job) {
+  assert(_job.vertex_count > 0);
+  Iterators it(_job);
+  for (int i = 0; i < _job.vertex_count - 1; ++i) {
+    SkinVertex<_Influences, _Normals, _Tangents, true>(_job, it);
+
+    it.indices = PointerStride(it.indices, _job.joint_indices_stride);
+    it.weights = PointerStride(it.weights, _job.joint_weights_stride);
+    it.in_positions = PointerStride(it.in_positions, _job.in_positions_stride);
+    it.out_positions =
+      PointerStride(it.out_positions, _job.out_positions_stride);
+    if (_Normals) {
+      it.in_normals = PointerStride(it.in_normals, _job.in_normals_stride);
+      it.out_normals = PointerStride(it.out_normals, _job.out_normals_stride);
+    }
+    if (_Tangents) {
+      it.in_tangents = PointerStride(it.in_tangents, _job.in_tangents_stride);
+      it.out_tangents =
+        PointerStride(it.out_tangents, _job.out_tangents_stride);
+    }
+  }
+  // Last vertex doesn't read beyond buffers end.
+  SkinVertex<_Influences, _Normals, _Tangents, false>(_job, it);
+}
+
+// Defines a matrix of skinning function pointers. This matrix will then be
+// indexed according to skinning jobs parameters.
+typedef void (*SkinningFct)(const DualQuaternionSkinningJob&);
+const SkinningFct kSkinningFct[5][3] = {
+  {&SkinVertices<1, false, false>,
+   &SkinVertices<1, true, false>,
+   &SkinVertices<1, true, true>},
+  {&SkinVertices<2, false, false>,
+   &SkinVertices<2, true, false>,
+   &SkinVertices<2, true, true>},
+  {&SkinVertices<3, false, false>,
+   &SkinVertices<3, true, false>,
+   &SkinVertices<3, true, true>},
+  {&SkinVertices<4, false, false>,
+   &SkinVertices<4, true, false>,
+   &SkinVertices<4, true, true>},
+  {&SkinVertices<0, false, false>,
+   &SkinVertices<0, true, false>,
+   &SkinVertices<0, true, true>}
+};
+}  // namespace
+
+bool DualQuaternionSkinningJob::Run() const {
+  // Exit with an error if job is invalid.
+  if (!Validate()) {
+    return false;
+  }
+
+  // Early out if no vertex. This isn't an error.
+  if (vertex_count == 0) {
+    return true;
+  }
+
+  // Find skinning function index.
   const size_t inf =
-    static_cast<size_t>(influences_count) > OZZ_ARRAY_SIZE(kSkinningFct[0]) ?
-      OZZ_ARRAY_SIZE(kSkinningFct[0]) -1 : influences_count - 1;
-  assert(inf < OZZ_ARRAY_SIZE(kSkinningFct[0]));
+    static_cast<size_t>(influences_count) > OZZ_ARRAY_SIZE(kSkinningFct) ?
+      OZZ_ARRAY_SIZE(kSkinningFct) - 1 : influences_count - 1;
+  assert(inf < OZZ_ARRAY_SIZE(kSkinningFct));
   const size_t fct = (in_normals.begin != NULL) + (in_tangents.begin != NULL);
-  assert(fct < OZZ_ARRAY_SIZE(kSkinningFct[0][0]));
+  assert(fct < OZZ_ARRAY_SIZE(kSkinningFct[0]));
 
   // Calls skinning function. Cannot fail because job is valid.
-  kSkinningFct[it][inf][fct](*this);
+  kSkinningFct[inf][fct](*this);
 
   return true;
 }
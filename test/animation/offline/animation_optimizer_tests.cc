@@ -27,11 +27,19 @@
 
 #include "ozz/animation/offline/animation_optimizer.h"
 
+#include <cmath>
+#include <cstring>
+#include <ctime>
+
 #include "gtest/gtest.h"
 
+#include "ozz/base/log.h"
+#include "ozz/base/task_scheduler.h"
 #include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/simd_math.h"
 
 #include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
 #include "ozz/animation/offline/animation_builder.h"
 
 #include "ozz/animation/offline/skeleton_builder.h"
@@ -43,6 +51,7 @@ using ozz::animation::offline::RawSkeleton;
 using ozz::animation::offline::SkeletonBuilder;
 using ozz::animation::offline::RawAnimation;
 using ozz::animation::offline::AnimationOptimizer;
+using ozz::TaskScheduler;
 
 TEST(Error, AnimationOptimizer) {
   AnimationOptimizer optimizer;
@@ -399,3 +408,421 @@ TEST(OptimizeHierarchical, AnimationOptimizer) {
 
   ozz::memory::default_allocator()->Delete(skeleton);
 }
+
+namespace {
+// Runs tasks sequentially, in reverse order, counting them.
+class ReverseScheduler : public TaskScheduler {
+ public:
+  ReverseScheduler()
+    : count_(0) {
+  }
+  virtual void Run(TaskFct _fct, void* _user_data, int _count) {
+    for (int i = _count - 1; i >= 0; --i) {
+      _fct(_user_data, i);
+    }
+    count_ += _count;
+  }
+  int count() const {
+    return count_;
+  }
+ private:
+  int count_;
+};
+
+// Expects _a and _b tracks keys to be bit for bit identical.
+template<typename _Track>
+void ExpectSameKeys(const _Track& _a, const _Track& _b) {
+  ASSERT_EQ(_a.size(), _b.size());
+  for (size_t i = 0; i < _a.size(); ++i) {
+    EXPECT_EQ(_a[i].time, _b[i].time);
+    EXPECT_EQ(memcmp(&_a[i].value, &_b[i].value, sizeof(_a[i].value)), 0);
+  }
+}
+}  // namespace
+
+TEST(OptimizeScheduler, AnimationOptimizer) {
+  // Prepares a skeleton with 2 levels of hierarchy.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(20);
+  for (size_t i = 0; i < raw_skeleton.roots[0].children.size(); ++i) {
+    RawSkeleton::Joint& child = raw_skeleton.roots[0].children[i];
+    child.transform = ozz::math::Transform::identity();
+    child.children.resize(1);
+    child.children[0].transform = ozz::math::Transform::identity();
+  }
+  raw_skeleton.roots[0].transform = ozz::math::Transform::identity();
+  SkeletonBuilder skeleton_builder;
+  Skeleton* skeleton = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Builds an animation whose tracks have both interpolable and non
+  // interpolable keys.
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(skeleton->num_joints());
+  for (int i = 0; i < input.num_tracks(); ++i) {
+    RawAnimation::JointTrack& track = input.tracks[i];
+    for (int k = 0; k <= 50; ++k) {
+      const float time = k / 50.f;
+      // Linear segments with a break, and spikes on odd tracks.
+      const float value =
+        (k < 25 ? k * .01f : .25f + (k - 25) * (i % 5 + 1) * .01f) +
+        (i & 1 && k % 10 == 3 ? .1f : 0.f) + i;
+      const RawAnimation::TranslationKey tkey =
+        {time, ozz::math::Float3(value, i * .1f, 0.f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey =
+        {time, ozz::math::Quaternion::FromEuler(
+          ozz::math::Float3(value * .1f, 0.f, i * .1f))};
+      track.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey =
+        {time, ozz::math::Float3(1.f, value * .1f, 1.f)};
+      track.scales.push_back(skey);
+    }
+  }
+
+  AnimationOptimizer optimizer;
+  RawAnimation reference;
+  ASSERT_TRUE(optimizer(input, *skeleton, &reference));
+
+  // Tracks are optimized as independent tasks, with the same output.
+  ReverseScheduler scheduler;
+  optimizer.scheduler = &scheduler;
+  RawAnimation output;
+  ASSERT_TRUE(optimizer(input, *skeleton, &output));
+  EXPECT_EQ(scheduler.count(), skeleton->num_joints());
+
+  ASSERT_EQ(output.num_tracks(), reference.num_tracks());
+  for (int i = 0; i < output.num_tracks(); ++i) {
+    ExpectSameKeys(output.tracks[i].translations,
+                   reference.tracks[i].translations);
+    ExpectSameKeys(output.tracks[i].rotations, reference.tracks[i].rotations);
+    ExpectSameKeys(output.tracks[i].scales, reference.tracks[i].scales);
+    EXPECT_LT(output.tracks[i].translations.size(), 51u);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+namespace {
+// Linearly interpolates _track translation keys at _time.
+ozz::math::Float3 SampleTranslation(
+  const RawAnimation::JointTrack::Translations& _track, float _time) {
+  size_t i = 1;
+  while (i < _track.size() && _track[i].time < _time) {
+    ++i;
+  }
+  if (i == _track.size()) {
+    return _track.back().value;
+  }
+  const float alpha =
+    (_time - _track[i - 1].time) / (_track[i].time - _track[i - 1].time);
+  return ozz::math::Lerp(_track[i - 1].value, _track[i].value,
+                         ozz::math::Max(alpha, 0.f));
+}
+}  // namespace
+
+TEST(OptimizeReduction, AnimationOptimizer) {
+  // Prepares a skeleton.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  SkeletonBuilder skeleton_builder;
+  Skeleton* skeleton = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Builds a long track, made of a few linear segments plus noise below
+  // tolerance, so that most of the keys can be removed.
+  const int kNumKeys = 5000;
+  RawAnimation input;
+  input.duration = kNumKeys / 60.f;
+  input.tracks.resize(1);
+  for (int k = 0; k < kNumKeys; ++k) {
+    const float time = k / 60.f;
+    const float bend = static_cast<float>(k / 1000);
+    const float noise = 2e-4f * std::sin(k * 1.7f);
+    const RawAnimation::TranslationKey key = {
+      time, ozz::math::Float3(time + noise, bend * time, (k % 1000) * .01f)};
+    input.tracks[0].translations.push_back(key);
+  }
+  ASSERT_TRUE(input.Validate());
+
+  AnimationOptimizer optimizer;
+  RawAnimation outputs[2];
+  const AnimationOptimizer::Reduction reductions[2] = {
+    AnimationOptimizer::kReductionGreedy, AnimationOptimizer::kReductionBisect};
+  clock_t times[2];
+  for (int i = 0; i < 2; ++i) {
+    optimizer.reduction = reductions[i];
+    const clock_t begin = clock();
+    ASSERT_TRUE(optimizer(input, *skeleton, &outputs[i]));
+    times[i] = clock() - begin;
+  }
+  const size_t greedy_keys = outputs[0].tracks[0].translations.size();
+  const size_t bisect_keys = outputs[1].tracks[0].translations.size();
+  ozz::log::Log() << "Greedy reduction: " << greedy_keys << " keys, " <<
+    times[0] * 1000. / CLOCKS_PER_SEC << "ms. Bisect reduction: " <<
+    bisect_keys << " keys, " << times[1] * 1000. / CLOCKS_PER_SEC << "ms." <<
+    std::endl;
+
+  // Both reductions remove most of the keys, to a similar count.
+  EXPECT_LT(greedy_keys, 40u);
+  EXPECT_LT(bisect_keys, 40u);
+
+  // Both reductions respect tolerance.
+  for (int i = 0; i < 2; ++i) {
+    const RawAnimation::JointTrack::Translations& translations =
+      outputs[i].tracks[0].translations;
+    EXPECT_FLOAT_EQ(translations.front().time, 0.f);
+    for (int k = 0; k < kNumKeys; ++k) {
+      const RawAnimation::TranslationKey& key = input.tracks[0].translations[k];
+      const ozz::math::Float3 value = SampleTranslation(translations, key.time);
+      EXPECT_LE(Length(value - key.value),
+                optimizer.translation_tolerance * 1.001f) << "key " << k;
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+namespace {
+// Samples _track at _time, interpolating keys with _lerp.
+template<typename _Track, typename _Lerp>
+typename _Track::value_type::Value Sample(const _Track& _track, float _time,
+                                          const _Lerp& _lerp) {
+  if (_track.empty()) {
+    return _Track::value_type::identity();
+  }
+  size_t i = 0;
+  while (i < _track.size() && _track[i].time < _time) {
+    ++i;
+  }
+  if (i == 0) {
+    return _track.front().value;
+  } else if (i == _track.size()) {
+    return _track.back().value;
+  }
+  const float alpha =
+    (_time - _track[i - 1].time) / (_track[i].time - _track[i - 1].time);
+  return _lerp(_track[i - 1].value, _track[i].value, alpha);
+}
+
+// Computes model-space positions of all _animation joints at _time.
+void ComputePositions(const RawAnimation& _animation, const Skeleton& _skeleton,
+                      float _time, ozz::math::Float4x4* _models,
+                      ozz::math::Float3* _positions) {
+  using ozz::animation::offline::LerpTranslation;
+  using ozz::animation::offline::LerpRotation;
+  using ozz::animation::offline::LerpScale;
+  for (int i = 0; i < _animation.num_tracks(); ++i) {
+    const RawAnimation::JointTrack& track = _animation.tracks[i];
+    const ozz::math::Float3 t =
+      Sample(track.translations, _time, LerpTranslation);
+    const ozz::math::Quaternion r =
+        Sample(track.rotations, _time, LerpRotation);
+    const ozz::math::Float3 s = Sample(track.scales, _time, LerpScale);
+    const ozz::math::Float4x4 local = ozz::math::Float4x4::FromAffine(
+      ozz::math::simd_float4::Load(t.x, t.y, t.z, 0.f),
+      ozz::math::simd_float4::Load(r.x, r.y, r.z, r.w),
+      ozz::math::simd_float4::Load(s.x, s.y, s.z, 0.f));
+    const int parent = _skeleton.joint_properties()[i].parent;
+    _models[i] =
+      parent == Skeleton::kNoParentIndex ? local : _models[parent] * local;
+    float position[4];
+    ozz::math::StorePtrU(_models[i].cols[3], position);
+    _positions[i] = ozz::math::Float3(position[0], position[1], position[2]);
+  }
+}
+
+// Expects model-space positions of _output joints to be within _tolerance of
+// _input ones, at _num_times regularly spaced times.
+void ExpectModelSpaceError(const RawAnimation& _input,
+                           const RawAnimation& _output,
+                           const Skeleton& _skeleton, int _num_times,
+                           float _tolerance) {
+  const int num_joints = _skeleton.num_joints();
+  ozz::Vector<ozz::math::Float4x4>::Std models(num_joints);
+  ozz::Vector<ozz::math::Float3>::Std expected_positions(num_joints);
+  ozz::Vector<ozz::math::Float3>::Std positions(num_joints);
+  for (int k = 0; k < _num_times; ++k) {
+    const float time = _input.duration * k / (_num_times - 1.f);
+    ComputePositions(_input, _skeleton, time, &models[0],
+                     &expected_positions[0]);
+    ComputePositions(_output, _skeleton, time, &models[0], &positions[0]);
+    for (int i = 0; i < num_joints; ++i) {
+      EXPECT_LE(Length(positions[i] - expected_positions[i]),
+                _tolerance * 1.001f) << "joint " << i << ", time " << time;
+    }
+  }
+}
+}  // namespace
+
+TEST(OptimizeModelSpace, AnimationOptimizer) {
+  // Prepares a chain of 3 joints.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(1);
+  raw_skeleton.roots[0].children[0].children.resize(1);
+  SkeletonBuilder skeleton_builder;
+  Skeleton* skeleton = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 3);
+
+  // Root and second joint twist around the x axis, along which children are
+  // aligned, so twisting doesn't move any joint. Twist noise remains below
+  // rotation tolerance.
+  const int kNumKeys = 100;
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(3);
+  for (int k = 0; k < kNumKeys; ++k) {
+    const float time = k / (kNumKeys - 1.f);
+    const float noise = 8e-4f * std::sin(k * 2.1f);
+    const RawAnimation::RotationKey twist = {
+      time, ozz::math::Quaternion::FromAxisAngle(
+        ozz::math::Float4(1.f, 0.f, 0.f, noise))};
+    input.tracks[0].rotations.push_back(twist);
+    input.tracks[1].rotations.push_back(twist);
+  }
+  for (int i = 1; i < 3; ++i) {
+    const RawAnimation::TranslationKey key = {
+      0.f, ozz::math::Float3(1.f, 0.f, 0.f)};
+    input.tracks[i].translations.push_back(key);
+  }
+  ASSERT_TRUE(input.Validate());
+
+  AnimationOptimizer optimizer;
+  RawAnimation hierarchical;
+  ASSERT_TRUE(optimizer(input, *skeleton, &hierarchical));
+
+  optimizer.error = AnimationOptimizer::kErrorModelSpace;
+  RawAnimation model_space;
+  ASSERT_TRUE(optimizer(input, *skeleton, &model_space));
+
+  // Hierarchical error approximation keeps twist keys, as they could move
+  // children. Model-space error measures they don't.
+  EXPECT_GT(hierarchical.tracks[0].rotations.size(), 50u);
+  EXPECT_GT(hierarchical.tracks[1].rotations.size(), 10u);
+  EXPECT_LE(model_space.tracks[0].rotations.size(), 2u);
+  EXPECT_LE(model_space.tracks[1].rotations.size(), 2u);
+  EXPECT_EQ(model_space.tracks[1].translations.size(), 1u);
+  EXPECT_EQ(model_space.tracks[2].translations.size(), 1u);
+
+  // Measures model-space positions error at every key frame time.
+  ExpectModelSpaceError(input, model_space, *skeleton, kNumKeys,
+                        optimizer.hierarchical_tolerance);
+
+  // Root now bends around z axis, moving children. Its keys are kept as long
+  // as children error exceeds tolerance.
+  for (int k = 0; k < kNumKeys; ++k) {
+    const float time = k / (kNumKeys - 1.f);
+    const float noise = 8e-4f * std::sin(k * 2.1f);
+    const RawAnimation::RotationKey bend = {
+      time, ozz::math::Quaternion::FromAxisAngle(
+        ozz::math::Float4(0.f, 0.f, 1.f, time * .5f + noise))};
+    input.tracks[0].rotations[k] = bend;
+  }
+  ASSERT_TRUE(optimizer(input, *skeleton, &model_space));
+  EXPECT_GT(model_space.tracks[0].rotations.size(), 10u);
+  ExpectModelSpaceError(input, model_space, *skeleton, kNumKeys,
+                        optimizer.hierarchical_tolerance);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(OptimizeModelSpaceBranches, AnimationOptimizer) {
+  // Prepares a branched hierarchy: root->{a, b}, a->{a1}. Skeleton is breadth
+  // first ordered, so a descendants aren't contiguous: root, a, b, a1.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(2);
+  raw_skeleton.roots[0].children[0].children.resize(1);
+  SkeletonBuilder skeleton_builder;
+  Skeleton* skeleton = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 4);
+  ASSERT_EQ(skeleton->joint_properties()[3].parent, 1);
+
+  // a bends around z axis, with a noise below rotation tolerance that moves a1
+  // (10 units away) beyond hierarchical tolerance.
+  const int kNumKeys = 100;
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(4);
+  for (int k = 0; k < kNumKeys; ++k) {
+    const float time = k / (kNumKeys - 1.f);
+    const float noise = 8e-4f * std::sin(k * 2.1f);
+    const RawAnimation::RotationKey bend = {
+      time, ozz::math::Quaternion::FromAxisAngle(
+        ozz::math::Float4(0.f, 0.f, 1.f, time * .5f + noise))};
+    input.tracks[1].rotations.push_back(bend);
+  }
+  const RawAnimation::TranslationKey child = {
+    0.f, ozz::math::Float3(1.f, 0.f, 0.f)};
+  input.tracks[1].translations.push_back(child);
+  input.tracks[2].translations.push_back(child);
+  const RawAnimation::TranslationKey far_child = {
+    0.f, ozz::math::Float3(10.f, 0.f, 0.f)};
+  input.tracks[3].translations.push_back(far_child);
+  ASSERT_TRUE(input.Validate());
+
+  AnimationOptimizer optimizer;
+  optimizer.error = AnimationOptimizer::kErrorModelSpace;
+  RawAnimation model_space;
+  ASSERT_TRUE(optimizer(input, *skeleton, &model_space));
+
+  // a keys are kept, as they move a1.
+  EXPECT_GT(model_space.tracks[1].rotations.size(), 50u);
+  ExpectModelSpaceError(input, model_space, *skeleton, kNumKeys,
+                        optimizer.hierarchical_tolerance);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(OptimizeModelSpaceFrames, AnimationOptimizer) {
+  // Prepares a root and its child.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(1);
+  SkeletonBuilder skeleton_builder;
+  Skeleton* skeleton = skeleton_builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  ASSERT_EQ(skeleton->num_joints(), 2);
+
+  // Root key at .25 is removed, as its .9 error is below tolerance. Child key
+  // at .5 error is only .5, but removing it adds .25 error at .25, which is a
+  // key frame time of the root track only.
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(2);
+  const RawAnimation::TranslationKey root_keys[] = {
+    {0.f, ozz::math::Float3(0.f, 0.f, 0.f)},
+    {.25f, ozz::math::Float3(.9f, 0.f, 0.f)},
+    {.5f, ozz::math::Float3(0.f, 0.f, 0.f)}};
+  input.tracks[0].translations.assign(root_keys,
+                                      root_keys + OZZ_ARRAY_SIZE(root_keys));
+  const RawAnimation::TranslationKey child_keys[] = {
+    {0.f, ozz::math::Float3(0.f, 0.f, 0.f)},
+    {.5f, ozz::math::Float3(.5f, 0.f, 0.f)},
+    {1.f, ozz::math::Float3(0.f, 0.f, 0.f)}};
+  input.tracks[1].translations.assign(child_keys,
+                                      child_keys + OZZ_ARRAY_SIZE(child_keys));
+  ASSERT_TRUE(input.Validate());
+
+  AnimationOptimizer optimizer;
+  optimizer.error = AnimationOptimizer::kErrorModelSpace;
+  optimizer.translation_tolerance = 10.f;
+  optimizer.hierarchical_tolerance = 1.f;
+  for (int i = 0; i < 2; ++i) {
+    optimizer.reduction = i == 0 ? AnimationOptimizer::kReductionGreedy :
+                                   AnimationOptimizer::kReductionBisect;
+    RawAnimation model_space;
+    ASSERT_TRUE(optimizer(input, *skeleton, &model_space));
+    EXPECT_EQ(model_space.tracks[0].translations.size(), 1u);
+    EXPECT_EQ(model_space.tracks[1].translations.size(), 2u);
+    ExpectModelSpaceError(input, model_space, *skeleton, 101,
+                          optimizer.hierarchical_tolerance);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
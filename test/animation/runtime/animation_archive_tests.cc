@@ -27,11 +27,16 @@
 
 #include "ozz/animation/runtime/animation.h"
 
+#include <cstring>
+#include <ctime>
+
 #include "gtest/gtest.h"
+#include "ozz/base/gtest_helper.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 
 #include "ozz/base/io/archive.h"
 #include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
 #include "ozz/base/memory/allocator.h"
 
 #include "ozz/base/maths/soa_transform.h"
@@ -113,6 +118,12 @@ TEST(Filled, AnimationSerialize) {
     ASSERT_FLOAT_EQ(o_animation->duration(), i_animation.duration());
     ASSERT_EQ(o_animation->num_tracks(), i_animation.num_tracks());
     EXPECT_EQ(o_animation->size(), i_animation.size());
+    EXPECT_EQ(o_animation->translations_seek_table().times.Count(),
+              i_animation.translations_seek_table().times.Count());
+    EXPECT_EQ(o_animation->rotations_seek_table().times.Count(),
+              i_animation.rotations_seek_table().times.Count());
+    EXPECT_EQ(o_animation->scales_seek_table().times.Count(),
+              i_animation.scales_seek_table().times.Count());
 
     // Needs to sample to test the animation.
     ozz::animation::SamplingJob job;
@@ -198,3 +209,338 @@ TEST(AlreadyInitialized, AnimationSerialize) {
     ASSERT_EQ(i_animation.num_tracks(), 2);
   }
 }
+
+namespace {
+// Compares all animation buffers, seek tables included.
+void ExpectAnimationEq(const Animation& _a, const Animation& _b) {
+  EXPECT_FLOAT_EQ(_a.duration(), _b.duration());
+  EXPECT_EQ(_a.num_tracks(), _b.num_tracks());
+  EXPECT_STREQ(_a.name(), _b.name());
+  EXPECT_EQ(_a.size(), _b.size());
+  ASSERT_EQ(_a.translations().Size(), _b.translations().Size());
+  EXPECT_EQ(std::memcmp(_a.translations().begin, _b.translations().begin,
+                        _a.translations().Size()), 0);
+  ASSERT_EQ(_a.rotations().Size(), _b.rotations().Size());
+  EXPECT_EQ(std::memcmp(_a.rotations().begin, _b.rotations().begin,
+                        _a.rotations().Size()), 0);
+  EXPECT_EQ(_a.rotation_format(), _b.rotation_format());
+  EXPECT_EQ(_a.time_format(), _b.time_format());
+  ASSERT_EQ(_a.quantized_translations().Size(),
+            _b.quantized_translations().Size());
+  EXPECT_EQ(std::memcmp(_a.quantized_translations().begin,
+                        _b.quantized_translations().begin,
+                        _a.quantized_translations().Size()), 0);
+  ASSERT_EQ(_a.quantized_rotations().Size(), _b.quantized_rotations().Size());
+  EXPECT_EQ(std::memcmp(_a.quantized_rotations().begin,
+                        _b.quantized_rotations().begin,
+                        _a.quantized_rotations().Size()), 0);
+  ASSERT_EQ(_a.quantized_scales().Size(), _b.quantized_scales().Size());
+  EXPECT_EQ(std::memcmp(_a.quantized_scales().begin,
+                        _b.quantized_scales().begin,
+                        _a.quantized_scales().Size()), 0);
+  ASSERT_EQ(_a.packed_rotations().Size(), _b.packed_rotations().Size());
+  EXPECT_EQ(std::memcmp(_a.packed_rotations().begin,
+                        _b.packed_rotations().begin,
+                        _a.packed_rotations().Size()), 0);
+  ASSERT_EQ(_a.scales().Size(), _b.scales().Size());
+  EXPECT_EQ(std::memcmp(_a.scales().begin, _b.scales().begin,
+                        _a.scales().Size()), 0);
+  ASSERT_EQ(_a.constant_translations().Size(),
+            _b.constant_translations().Size());
+  EXPECT_EQ(std::memcmp(_a.constant_translations().begin,
+                        _b.constant_translations().begin,
+                        _a.constant_translations().Size()), 0);
+  ASSERT_EQ(_a.constant_rotations().Size(), _b.constant_rotations().Size());
+  EXPECT_EQ(std::memcmp(_a.constant_rotations().begin,
+                        _b.constant_rotations().begin,
+                        _a.constant_rotations().Size()), 0);
+  ASSERT_EQ(_a.constant_scales().Size(), _b.constant_scales().Size());
+  EXPECT_EQ(std::memcmp(_a.constant_scales().begin,
+                        _b.constant_scales().begin,
+                        _a.constant_scales().Size()), 0);
+  ASSERT_EQ(_a.translation_tracks().Size(), _b.translation_tracks().Size());
+  EXPECT_EQ(std::memcmp(_a.translation_tracks().begin,
+                        _b.translation_tracks().begin,
+                        _a.translation_tracks().Size()), 0);
+  ASSERT_EQ(_a.rotation_tracks().Size(), _b.rotation_tracks().Size());
+  EXPECT_EQ(std::memcmp(_a.rotation_tracks().begin,
+                        _b.rotation_tracks().begin,
+                        _a.rotation_tracks().Size()), 0);
+  ASSERT_EQ(_a.scale_tracks().Size(), _b.scale_tracks().Size());
+  EXPECT_EQ(std::memcmp(_a.scale_tracks().begin, _b.scale_tracks().begin,
+                        _a.scale_tracks().Size()), 0);
+  const ozz::animation::SeekTable& ta = _a.rotations_seek_table();
+  const ozz::animation::SeekTable& tb = _b.rotations_seek_table();
+  ASSERT_EQ(ta.keys.Size(), tb.keys.Size());
+  EXPECT_EQ(std::memcmp(ta.keys.begin, tb.keys.begin, ta.keys.Size()), 0);
+  ASSERT_EQ(ta.times.Size(), tb.times.Size());
+  EXPECT_EQ(std::memcmp(ta.times.begin, tb.times.begin, ta.times.Size()), 0);
+}
+}  // namespace
+
+TEST(InPlace, AnimationSerialize) {
+  // Builds an animation with enough keys to have seek tables.
+  Animation* o_animation = NULL;
+  {
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.name = "in place";
+    raw_animation.tracks.resize(3);
+    for (int i = 0; i < 3; ++i) {
+      for (int k = 0; k < 40; ++k) {
+        const float time = k / 40.f;
+        const RawAnimation::TranslationKey t_key = {
+          time, ozz::math::Float3(time, i * 2.f, 46.f)};
+        raw_animation.tracks[i].translations.push_back(t_key);
+        const RawAnimation::RotationKey r_key = {
+          time, ozz::math::Quaternion::FromEuler(
+            ozz::math::Float3(time, 0.f, i * .1f))};
+        raw_animation.tracks[i].rotations.push_back(r_key);
+      }
+    }
+    AnimationBuilder builder;
+    o_animation = builder(raw_animation);
+    ASSERT_TRUE(o_animation != NULL);
+    EXPECT_GT(o_animation->rotations_seek_table().times.Count(), 0u);
+  }
+
+  { // Data are used in place from a memory stream.
+    ozz::io::MemoryStream stream;
+    ozz::io::OArchive o(&stream);
+    o << ozz::io::MakeInPlace(*o_animation);
+
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    EXPECT_FALSE(i.TestTag<Animation>());
+    EXPECT_TRUE(i.TestTag<ozz::io::InPlace<Animation> >());
+
+    Animation i_animation;
+    i >> ozz::io::MakeInPlace(i_animation);
+    ExpectAnimationEq(*o_animation, i_animation);
+
+    // Buffers point to stream memory, at the beginning of in-place data which
+    // are at the end of the stream. This animation has no constant translation
+    // or rotation, so constant scales are distributed first.
+    const size_t data_size = i_animation.size() - sizeof(Animation) +
+                             std::strlen(i_animation.name()) + 1;
+    stream.Seek(-static_cast<int>(data_size), ozz::io::Stream::kEnd);
+    ASSERT_EQ(i_animation.constant_translations().Size(), 0u);
+    ASSERT_EQ(i_animation.constant_rotations().Size(), 0u);
+    EXPECT_EQ(stream.Map(0), i_animation.constant_scales().begin);
+  }
+
+  { // Data are copied from a file stream, then used in place from a mapped
+    // file.
+    {
+      ozz::io::File file("in_place.ozz", "wb");
+      ASSERT_TRUE(file.opened());
+      ozz::io::OArchive o(&file);
+      o << ozz::io::MakeInPlace(*o_animation);
+    }
+    {
+      ozz::io::File file("in_place.ozz", "rb");
+      ASSERT_TRUE(file.opened());
+      ozz::io::IArchive i(&file);
+      Animation i_animation;
+      i >> ozz::io::MakeInPlace(i_animation);
+      ExpectAnimationEq(*o_animation, i_animation);
+    }
+    {
+      ozz::io::MappedFile file("in_place.ozz");
+      ASSERT_TRUE(file.opened());
+      ozz::io::IArchive i(&file);
+      Animation i_animation;
+      i >> ozz::io::MakeInPlace(i_animation);
+      ExpectAnimationEq(*o_animation, i_animation);
+    }
+  }
+
+  { // Non native endianness is rejected.
+    ozz::io::MemoryStream stream;
+    ozz::io::OArchive o(&stream, ozz::GetNativeEndianness() == ozz::kBigEndian ?
+                                 ozz::kLittleEndian : ozz::kBigEndian);
+    EXPECT_ASSERTION(o << ozz::io::MakeInPlace(*o_animation),
+                     "In-place archives must have native endianness.");
+  }
+
+  ozz::memory::default_allocator()->Delete(o_animation);
+}
+
+TEST(Formats, AnimationSerialize) {
+  // Builds an animation with enough keys to have seek tables.
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.name = "formats";
+  raw_animation.tracks.resize(5);
+  for (int i = 0; i < 5; ++i) {
+    for (int k = 0; k < 40; ++k) {
+      const float time = k / 20.f;
+      const RawAnimation::TranslationKey t_key = {
+        time, ozz::math::Float3(time, i * 2.f, 46.f)};
+      raw_animation.tracks[i].translations.push_back(t_key);
+      const RawAnimation::RotationKey r_key = {
+        time, ozz::math::Quaternion::FromEuler(
+          ozz::math::Float3(time, -time * i, i * .1f))};
+      raw_animation.tracks[i].rotations.push_back(r_key);
+      const RawAnimation::ScaleKey s_key = {
+        time, ozz::math::Float3(1.f, time, 1.f)};
+      raw_animation.tracks[i].scales.push_back(s_key);
+    }
+  }
+
+  // Tests packed rotations and quantized times, separately and together.
+  const Animation::RotationFormat rotation_formats[] = {
+    Animation::kRotationPacked, Animation::kRotationStandard,
+    Animation::kRotationPacked};
+  const Animation::TimeFormat time_formats[] = {
+    Animation::kTimeFloat, Animation::kTimeQuantized,
+    Animation::kTimeQuantized};
+  for (size_t f = 0; f < OZZ_ARRAY_SIZE(time_formats); ++f) {
+    AnimationBuilder builder;
+    builder.rotation_format = rotation_formats[f];
+    builder.time_format = time_formats[f];
+    Animation* o_animation = builder(raw_animation);
+    ASSERT_TRUE(o_animation != NULL);
+    EXPECT_EQ(o_animation->rotation_format(), rotation_formats[f]);
+    EXPECT_EQ(o_animation->time_format(), time_formats[f]);
+    EXPECT_GT(o_animation->rotations_seek_table().times.Count(), 0u);
+
+    for (int e = 0; e < 2; ++e) {
+      ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+      ozz::io::MemoryStream stream;
+      ozz::io::OArchive o(&stream, endianess);
+      o << *o_animation;
+
+      stream.Seek(0, ozz::io::Stream::kSet);
+      ozz::io::IArchive i(&stream);
+      Animation i_animation;
+      i >> i_animation;
+      ExpectAnimationEq(*o_animation, i_animation);
+    }
+
+    { // In-place.
+      ozz::io::MemoryStream stream;
+      ozz::io::OArchive o(&stream);
+      o << ozz::io::MakeInPlace(*o_animation);
+
+      stream.Seek(0, ozz::io::Stream::kSet);
+      ozz::io::IArchive i(&stream);
+      Animation i_animation;
+      i >> ozz::io::MakeInPlace(i_animation);
+      ExpectAnimationEq(*o_animation, i_animation);
+    }
+
+    ozz::memory::default_allocator()->Delete(o_animation);
+  }
+}
+
+namespace {
+// Loads animation keys field by field, the way Animation::Load used to,
+// to serve as a reference for the benchmark. Returns the number of keys read.
+int LoadKeysPerField(ozz::io::IArchive& _archive) {
+  float duration;
+  _archive >> duration;
+  int32_t num_tracks, name_len, counts[3];
+  _archive >> num_tracks;
+  _archive >> name_len;
+  _archive >> counts[0];
+  _archive >> counts[1];
+  _archive >> counts[2];
+  uint8_t rotation_format;
+  _archive >> rotation_format;
+  uint8_t time_format;
+  _archive >> time_format;
+  int32_t constant_counts[3];
+  _archive >> ozz::io::MakeArray(constant_counts);
+  char name[64];
+  _archive >> ozz::io::MakeArray(name, name_len);
+  int read = 0;
+  for (int k = 0; k < 3; ++k) {
+    for (int i = 0; i < counts[k]; ++i, ++read) {
+      float time;
+      _archive >> time;
+      uint16_t track;
+      _archive >> track;
+      if (k == 1) {  // Rotations.
+        uint8_t largest;
+        _archive >> largest;
+        bool sign;
+        _archive >> sign;
+      }
+      uint16_t value[3];
+      _archive >> ozz::io::MakeArray(value);
+    }
+  }
+  return read;
+}
+}  // namespace
+
+TEST(Benchmark, AnimationSerialize) {
+  // Builds a big animation.
+  const int num_tracks = 64;
+  const int num_keys = 200;
+  Animation* o_animation = NULL;
+  {
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.name = "benchmark";
+    raw_animation.tracks.resize(num_tracks);
+    for (int i = 0; i < num_tracks; ++i) {
+      for (int k = 0; k < num_keys; ++k) {
+        const float time = static_cast<float>(k) / num_keys;
+        const RawAnimation::TranslationKey t_key = {
+          time, ozz::math::Float3(time, static_cast<float>(i), 46.f)};
+        raw_animation.tracks[i].translations.push_back(t_key);
+        const RawAnimation::RotationKey r_key = {
+          time, ozz::math::Quaternion::FromEuler(
+            ozz::math::Float3(time, 0.f, i * .01f))};
+        raw_animation.tracks[i].rotations.push_back(r_key);
+        const RawAnimation::ScaleKey s_key = {
+          time, ozz::math::Float3(1.f, time, 1.f)};
+        raw_animation.tracks[i].scales.push_back(s_key);
+      }
+    }
+    AnimationBuilder builder;
+    o_animation = builder(raw_animation);
+    ASSERT_TRUE(o_animation != NULL);
+  }
+
+  const int num_loops = 20;
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_animation;
+
+    // Bulk loading.
+    Animation i_animation;
+    const std::clock_t bulk_begin = std::clock();
+    for (int l = 0; l < num_loops; ++l) {
+      stream.Seek(0, ozz::io::Stream::kSet);
+      ozz::io::IArchive i(&stream);
+      i >> i_animation;
+    }
+    const std::clock_t bulk_time = std::clock() - bulk_begin;
+    ExpectAnimationEq(*o_animation, i_animation);
+
+    // Per field reference loading.
+    const std::clock_t field_begin = std::clock();
+    for (int l = 0; l < num_loops; ++l) {
+      stream.Seek(0, ozz::io::Stream::kSet);
+      ozz::io::IArchive i(&stream);
+      ASSERT_TRUE(i.TestTag<Animation>());
+      stream.Seek(static_cast<int>(sizeof("ozz-animation") + sizeof(uint32_t)),
+                  ozz::io::Stream::kCurrent);
+      EXPECT_GE(LoadKeysPerField(i), num_tracks * num_keys * 3);
+    }
+    const std::clock_t field_time = std::clock() - field_begin;
+
+    ozz::log::Log() << (endianess == ozz::GetNativeEndianness() ?
+                         "Native" : "Swapped") <<
+      " endianness animation loading: bulk " << bulk_time <<
+      " clocks, per field " << field_time << " clocks, speedup x" <<
+      static_cast<float>(field_time) / (bulk_time > 0 ? bulk_time : 1) << "." <<
+      std::endl;
+  }
+  ozz::memory::default_allocator()->Delete(o_animation);
+}
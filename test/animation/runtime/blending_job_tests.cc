@@ -26,13 +26,30 @@
 //----------------------------------------------------------------------------//
 
 #include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include <cstring>
 
 #include "gtest/gtest.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
 
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/animation_builder.h"
+
+using ozz::animation::Animation;
 using ozz::animation::BlendingJob;
+using ozz::animation::SamplingBlendingJob;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
 
 TEST(JobValidity, BlendingJob) {
   const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
@@ -1224,3 +1241,464 @@ TEST(AdditiveJointWeight, BlendingJob) {
                             1.f/20.f, 1.f/11.f, 1.f, 1.f);
   }
 }
+
+TEST(SparseJointWeights, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SimdFloat4 zero = ozz::math::simd_float4::zero();
+  const ozz::math::SimdFloat4 one = ozz::math::simd_float4::one();
+
+  // Per-joint weights mask out all the joints of the first soa joint.
+  const ozz::math::SimdFloat4 joint_weights[2] = {zero, one};
+
+  ozz::math::SoaTransform input_transforms[3][2] = {
+    {identity, identity}, {identity, identity}, {identity, identity}};
+  for (int i = 0; i < 2; ++i) {
+    input_transforms[0][i].translation = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load1(1.f + i), zero, zero);
+    input_transforms[1][i].translation = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load1(3.f), zero, zero);
+    input_transforms[2][i].translation = ozz::math::SoaFloat3::Load(
+      one, zero, zero);
+  }
+  ozz::math::SoaTransform bind_poses[2] = {identity, identity};
+  bind_poses[0].translation = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load1(10.f), zero, zero);
+
+  // The partial layer is the first one, so that it's blended first.
+  BlendingJob::Layer layers[2];
+  layers[0].transform = input_transforms[0];
+  layers[0].joint_weights = joint_weights;
+  layers[0].weight = 1.f;
+  layers[1].transform = input_transforms[1];
+
+  BlendingJob::Layer additive_layers[1];
+  additive_layers[0].transform = input_transforms[2];
+  additive_layers[0].joint_weights = joint_weights;
+  additive_layers[0].weight = 1.f;
+
+  ozz::math::SoaTransform output_transforms[2];
+
+  BlendingJob job;
+  job.layers = layers;
+  job.additive_layers = additive_layers;
+  job.bind_pose = bind_poses;
+  job.output = output_transforms;
+
+  {  // Masked joints only get the second layer.
+    layers[1].weight = 1.f;
+    EXPECT_TRUE(job.Run());
+
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].translation,
+                        3.f, 3.f, 3.f, 3.f,
+                        0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[1].translation,
+                        3.5f, 3.5f, 3.5f, 3.5f,
+                        0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].scale,
+                        1.f, 1.f, 1.f, 1.f,
+                        1.f, 1.f, 1.f, 1.f,
+                        1.f, 1.f, 1.f, 1.f);
+  }
+
+  {  // Masked joints fall back to the bind pose.
+    layers[1].weight = 0.f;
+    EXPECT_TRUE(job.Run());
+
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].translation,
+                        10.f, 10.f, 10.f, 10.f,
+                        0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[1].translation,
+                        3.f, 3.f, 3.f, 3.f,
+                        0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].scale,
+                        1.f, 1.f, 1.f, 1.f,
+                        1.f, 1.f, 1.f, 1.f,
+                        1.f, 1.f, 1.f, 1.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output_transforms[0].rotation,
+                                0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f,
+                                1.f, 1.f, 1.f, 1.f);
+  }
+}
+
+TEST(MaxJoints, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const int num_soa_joints = Skeleton::kMaxSoAJoints;
+
+  // Initialize inputs, with a translation set to the soa joint index. Per-joint
+  // weights of the second layer are only set for odd soa joints.
+  static ozz::math::SoaTransform input_transforms[2][Skeleton::kMaxSoAJoints];
+  static ozz::math::SimdFloat4 joint_weights[Skeleton::kMaxSoAJoints];
+  static ozz::math::SoaTransform additive_transforms[Skeleton::kMaxSoAJoints];
+  static ozz::math::SoaTransform bind_poses[Skeleton::kMaxSoAJoints];
+  static ozz::math::SoaTransform output_transforms[Skeleton::kMaxSoAJoints];
+  for (int i = 0; i < num_soa_joints; ++i) {
+    const ozz::math::SimdFloat4 index =
+      ozz::math::simd_float4::Load1(static_cast<float>(i));
+    input_transforms[0][i] = identity;
+    input_transforms[0][i].translation =
+      ozz::math::SoaFloat3::Load(index, index, index);
+    input_transforms[1][i] = identity;
+    input_transforms[1][i].translation = -input_transforms[0][i].translation;
+    joint_weights[i] = ozz::math::simd_float4::Load1((i & 1) ? 1.f : 0.f);
+    additive_transforms[i] = identity;
+    additive_transforms[i].translation = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::one(),
+      ozz::math::simd_float4::one(),
+      ozz::math::simd_float4::one());
+    bind_poses[i] = identity;
+  }
+
+  BlendingJob::Layer layers[2];
+  layers[0].transform = input_transforms[0];
+  layers[0].weight = 1.f;
+  layers[1].transform = input_transforms[1];
+  layers[1].joint_weights = joint_weights;
+  layers[1].weight = 1.f;
+
+  BlendingJob::Layer additive_layers[1];
+  additive_layers[0].transform = additive_transforms;
+  additive_layers[0].weight = .5f;
+
+  BlendingJob job;
+  job.layers = layers;
+  job.additive_layers = additive_layers;
+  job.bind_pose = bind_poses;
+  job.output = output_transforms;
+
+  EXPECT_TRUE(job.Run());
+
+  for (int i = 0; i < num_soa_joints; ++i) {
+    const float t = (i & 1) ? .5f : i + .5f;
+    EXPECT_SOAFLOAT3_EQ(output_transforms[i].translation,
+                        t, t, t, t,
+                        t, t, t, t,
+                        t, t, t, t);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[i].scale,
+                        1.f, 1.f, 1.f, 1.f,
+                        1.f, 1.f, 1.f, 1.f,
+                        1.f, 1.f, 1.f, 1.f);
+  }
+}
+
+TEST(JobValidity, SamplingBlendingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SimdFloat4 zero = ozz::math::simd_float4::zero();
+  const ozz::math::SoaTransform bind_poses[3] = {
+    identity, identity, identity};
+  ozz::math::SoaTransform output_transforms[3];
+  ozz::math::SimdFloat4 joint_weights[2] = {zero, zero};
+
+  SamplingCache cache(5);
+  SamplingCache small_cache(1);
+
+  SamplingBlendingJob::Layer layers[2];
+  layers[0].animation = animation;
+  layers[0].cache = &cache;
+  layers[1].animation = animation;
+  layers[1].cache = &cache;
+
+  {  // Empty/default job.
+    SamplingBlendingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job, no layer.
+    SamplingBlendingJob job;
+    job.bind_pose.begin = bind_poses;
+    job.bind_pose.end = bind_poses + 2;
+    job.output.begin = output_transforms;
+    job.output.end = output_transforms + 2;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid job.
+    SamplingBlendingJob job;
+    job.layers.begin = layers;
+    job.layers.end = layers + 1;
+    job.additive_layers.begin = layers + 1;
+    job.additive_layers.end = layers + 2;
+    job.bind_pose.begin = bind_poses;
+    job.bind_pose.end = bind_poses + 2;
+    job.output.begin = output_transforms;
+    job.output.end = output_transforms + 2;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Invalid threshold.
+    SamplingBlendingJob job;
+    job.threshold = 0.f;
+    job.layers.begin = layers;
+    job.layers.end = layers + 2;
+    job.bind_pose.begin = bind_poses;
+    job.bind_pose.end = bind_poses + 2;
+    job.output.begin = output_transforms;
+    job.output.end = output_transforms + 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output range, smaller than bind pose.
+    SamplingBlendingJob job;
+    job.layers.begin = layers;
+    job.layers.end = layers + 2;
+    job.bind_pose.begin = bind_poses;
+    job.bind_pose.end = bind_poses + 2;
+    job.output.begin = output_transforms;
+    job.output.end = output_transforms + 1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid animation, with less soa tracks than the bind pose.
+    SamplingBlendingJob job;
+    job.layers.begin = layers;
+    job.layers.end = layers + 2;
+    job.bind_pose.begin = bind_poses;
+    job.bind_pose.end = bind_poses + 3;
+    job.output.begin = output_transforms;
+    job.output.end = output_transforms + 3;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid layer animation.
+    SamplingBlendingJob::Layer invalid_layers[1];
+    invalid_layers[0].cache = &cache;
+
+    SamplingBlendingJob job;
+    job.layers.begin = invalid_layers;
+    job.layers.end = invalid_layers + 1;
+    job.bind_pose.begin = bind_poses;
+    job.bind_pose.end = bind_poses + 2;
+    job.output.begin = output_transforms;
+    job.output.end = output_transforms + 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid additive layer cache.
+    SamplingBlendingJob::Layer invalid_layers[1];
+    invalid_layers[0].animation = animation;
+
+    SamplingBlendingJob job;
+    job.additive_layers.begin = invalid_layers;
+    job.additive_layers.end = invalid_layers + 1;
+    job.bind_pose.begin = bind_poses;
+    job.bind_pose.end = bind_poses + 2;
+    job.output.begin = output_transforms;
+    job.output.end = output_transforms + 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid cache size.
+    SamplingBlendingJob::Layer invalid_layers[1];
+    invalid_layers[0].animation = animation;
+    invalid_layers[0].cache = &small_cache;
+
+    SamplingBlendingJob job;
+    job.layers.begin = invalid_layers;
+    job.layers.end = invalid_layers + 1;
+    job.bind_pose.begin = bind_poses;
+    job.bind_pose.end = bind_poses + 2;
+    job.output.begin = output_transforms;
+    job.output.end = output_transforms + 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid joint weights range.
+    SamplingBlendingJob::Layer invalid_layers[1];
+    invalid_layers[0].animation = animation;
+    invalid_layers[0].cache = &cache;
+    invalid_layers[0].joint_weights.begin = joint_weights;
+    invalid_layers[0].joint_weights.end = joint_weights + 1;
+
+    SamplingBlendingJob job;
+    job.layers.begin = invalid_layers;
+    job.layers.end = invalid_layers + 1;
+    job.bind_pose.begin = bind_poses;
+    job.bind_pose.end = bind_poses + 2;
+    job.output.begin = output_transforms;
+    job.output.end = output_transforms + 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid joint weights range.
+    SamplingBlendingJob::Layer valid_layers[1];
+    valid_layers[0].animation = animation;
+    valid_layers[0].cache = &cache;
+    valid_layers[0].joint_weights.begin = joint_weights;
+    valid_layers[0].joint_weights.end = joint_weights + 2;
+
+    SamplingBlendingJob job;
+    job.layers.begin = valid_layers;
+    job.layers.end = valid_layers + 1;
+    job.bind_pose.begin = bind_poses;
+    job.bind_pose.end = bind_poses + 2;
+    job.output.begin = output_transforms;
+    job.output.end = output_transforms + 2;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+namespace {
+// Builds an animation of _num_tracks tracks, whose values depend on _seed.
+// One track out of 3 has a constant translation, and one out of 5 a constant
+// rotation, so that animated tracks aren't aligned with soa joints.
+Animation* BuildAnimation(int _num_tracks, float _seed) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const int num_keys = 2 + (i % 4);
+    for (int k = 0; k < num_keys; ++k) {
+      const float time = raw_animation.duration * k / (num_keys - 1);
+      const float value = _seed + i * .1f + (i % 3 ? k : 0);
+      const RawAnimation::TranslationKey tkey =
+        {time, ozz::math::Float3(value, -value, value * .5f)};
+      track.translations.push_back(tkey);
+      const float angle = i % 5 ? value * .2f : _seed;
+      const RawAnimation::RotationKey rkey =
+        {time, ozz::math::Quaternion::FromEuler(
+          ozz::math::Float3(angle, -angle * .5f, angle * .1f))};
+      track.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey =
+        {time, ozz::math::Float3(1.f + value * .1f, 1.f, 2.f)};
+      track.scales.push_back(skey);
+    }
+  }
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+}  // namespace
+
+TEST(Sampling, SamplingBlendingJob) {
+  // Uses more soa joints than a single block, and a number of joints that
+  // isn't a multiple of soa size.
+  const int kNumJoints = 75;
+  const int kNumSoaJoints = (kNumJoints + 3) / 4;
+  const int kNumLayers = 3;
+
+  Animation* animations[kNumLayers + 1];
+  for (int i = 0; i < kNumLayers + 1; ++i) {
+    animations[i] = BuildAnimation(kNumJoints, i * 1.f);
+    ASSERT_TRUE(animations[i] != NULL);
+  }
+
+  // Bind pose and per-joint weights. Whole soa joints are masked out,
+  // including all the joints of the second block.
+  ozz::math::SoaTransform bind_poses[kNumSoaJoints];
+  ozz::math::SimdFloat4 joint_weights[kNumSoaJoints];
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    bind_poses[i] = ozz::math::SoaTransform::identity();
+    const bool masked = i % 3 == 1 || (i >= 8 && i < 16);
+    joint_weights[i] = masked ?
+      ozz::math::simd_float4::zero() :
+      ozz::math::simd_float4::Load(i % 3 ? 0.f : 1.f, .5f, 0.f, i * .1f);
+  }
+
+  // Separate sampling and blending jobs reference setup.
+  SamplingCache* caches[kNumLayers + 1];
+  ozz::math::SoaTransform locals[kNumLayers + 1][kNumSoaJoints];
+  BlendingJob::Layer blend_layers[kNumLayers + 1];
+  for (int i = 0; i < kNumLayers + 1; ++i) {
+    caches[i] =
+      ozz::memory::default_allocator()->New<SamplingCache>(kNumJoints);
+    blend_layers[i].transform = locals[i];
+  }
+  blend_layers[1].joint_weights = joint_weights;
+  blend_layers[kNumLayers].joint_weights = joint_weights;
+  BlendingJob blending_job;
+  blending_job.layers.begin = blend_layers;
+  blending_job.layers.end = blend_layers + kNumLayers;
+  blending_job.additive_layers.begin = blend_layers + kNumLayers;
+  blending_job.additive_layers.end = blend_layers + kNumLayers + 1;
+  blending_job.bind_pose = bind_poses;
+  ozz::math::SoaTransform expected[kNumSoaJoints];
+  blending_job.output = expected;
+
+  // Fused job setup.
+  SamplingCache* fused_caches[kNumLayers + 1];
+  SamplingBlendingJob::Layer layers[kNumLayers + 1];
+  for (int i = 0; i < kNumLayers + 1; ++i) {
+    fused_caches[i] =
+      ozz::memory::default_allocator()->New<SamplingCache>(kNumJoints);
+    layers[i].animation = animations[i];
+    layers[i].cache = fused_caches[i];
+  }
+  layers[1].joint_weights = joint_weights;
+  layers[kNumLayers].joint_weights = joint_weights;
+  SamplingBlendingJob job;
+  job.layers.begin = layers;
+  job.layers.end = layers + kNumLayers;
+  job.additive_layers.begin = layers + kNumLayers;
+  job.additive_layers.end = layers + kNumLayers + 1;
+  job.bind_pose = bind_poses;
+  ozz::math::SoaTransform output[kNumSoaJoints];
+  job.output = output;
+
+  // Samples forward and backward, with zero weight and negative weight
+  // layers.
+  const float times[] = {0.f, .3f, .7f, 1.6f, 2.5f, .2f, 1.1f};
+  const float weights[][kNumLayers + 1] = {
+    {1.f, 1.f, 0.f, 1.f},
+    {.2f, .8f, .5f, .3f},
+    {0.f, 1.f, 0.f, -.5f},
+    {0.f, 0.f, 0.f, 0.f},
+    {.5f, 0.f, -1.f, 0.f},
+    {.01f, .02f, .03f, 1.f},
+    {.7f, 2.f, .3f, -1.f}};
+  for (size_t t = 0; t < OZZ_ARRAY_SIZE(times); ++t) {
+    for (int i = 0; i < kNumLayers + 1; ++i) {
+      const float time = times[t] * (1.f + i * .1f);
+      const float weight = weights[t][i];
+
+      SamplingJob sampling_job;
+      sampling_job.animation = animations[i];
+      sampling_job.cache = caches[i];
+      sampling_job.time = time;
+      sampling_job.output = locals[i];
+      ASSERT_TRUE(sampling_job.Run());
+      blend_layers[i].weight = weight;
+
+      layers[i].time = time;
+      layers[i].weight = weight;
+    }
+    ASSERT_TRUE(blending_job.Run());
+
+    memset(output, 0xde, sizeof(output));
+    ASSERT_TRUE(job.Run());
+
+    // Fused sampling and blending must match separate jobs exactly.
+    EXPECT_EQ(memcmp(expected, output, sizeof(output)), 0);
+  }
+
+  for (int i = 0; i < kNumLayers + 1; ++i) {
+    ozz::memory::default_allocator()->Delete(caches[i]);
+    ozz::memory::default_allocator()->Delete(fused_caches[i]);
+    ozz::memory::default_allocator()->Delete(animations[i]);
+  }
+}
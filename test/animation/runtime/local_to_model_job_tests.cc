@@ -27,6 +27,8 @@
 
 #include "ozz/animation/runtime/local_to_model_job.h"
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 
 #include "ozz/base/memory/allocator.h"
@@ -36,6 +38,7 @@
 #include "ozz/animation/offline/raw_skeleton.h"
 #include "ozz/animation/offline/skeleton_builder.h"
 #include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
 
 using ozz::animation::Skeleton;
 using ozz::animation::LocalToModelJob;
@@ -142,6 +145,27 @@ TEST(JobValidity, LocalToModel) {
     EXPECT_FALSE(job.Validate());
     EXPECT_FALSE(job.Run());
   }
+  // Invalid joint range: negative from.
+  {
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.from = -1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  // Invalid joint range: to < from.
+  {
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.from = 1;
+    job.to = 0;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
   // Valid job.
   {
     LocalToModelJob job;
@@ -152,6 +176,62 @@ TEST(JobValidity, LocalToModel) {
     EXPECT_TRUE(job.Validate());
     EXPECT_TRUE(job.Run());
   }
+  // Valid job, empty joint range.
+  {
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.from = 1;
+    job.to = 1;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  // Invalid root.
+  {
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.root = 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  // Invalid dirty bitset: too small.
+  {
+    const uint32_t dirty[1] = {0};
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.dirty.begin = dirty;
+    job.dirty.end = dirty;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  // Valid job, root and dirty bitset.
+  {
+    const uint32_t dirty[1] = {2};
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.root = 0;
+    job.dirty = dirty;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  // Valid job, joint range out of the skeleton.
+  {
+    LocalToModelJob job;
+    job.skeleton = skeleton;
+    job.input = input;
+    job.output = output;
+    job.from = 46;
+    job.to = 93;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
   // Valid job with empty skeleton.
   {
     LocalToModelJob job;
@@ -273,3 +353,206 @@ TEST(Transformation, LocalToModel) {
                                 0.f, 0.f, 0.f, 1.f);
   ozz::memory::default_allocator()->Delete(skeleton);
 }
+
+namespace {
+// Builds a skeleton made of a root with 4 branches of various depths, for a
+// total of 1 + 4 * 11 joints.
+Skeleton* BuildBranchesSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(4);
+  for (int b = 0; b < 4; ++b) {
+    RawSkeleton::Joint& branch = raw_skeleton.roots[0].children[b];
+    branch.children.resize(2);
+    RawSkeleton::Joint::Children* child = &branch.children[0].children;
+    for (int i = 0; i < 8; ++i) {
+      child->resize(1);
+      child = &child->at(0).children;
+    }
+  }
+  EXPECT_EQ(raw_skeleton.num_joints(), 45);
+
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Fills _input with a different transformation for every joint.
+void FillInput(ozz::math::SoaTransform* _input, int _count) {
+  for (int i = 0; i < _count; ++i) {
+    const float f = static_cast<float>(i);
+    const ozz::math::SoaTransform transform = {
+      {ozz::math::simd_float4::Load(f, 1.f, 2.f, 3.f),
+       ozz::math::simd_float4::Load(4.f, f, 5.f, 6.f),
+       ozz::math::simd_float4::Load(7.f, 8.f, f, 9.f)},
+      {ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, 0.f),
+       ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+       ozz::math::simd_float4::Load(.70710677f, 0.f, 0.f, 0.f),
+       ozz::math::simd_float4::Load(.70710677f, .70710677f, .70710677f, 1.f)},
+      {ozz::math::simd_float4::Load(1.f, 2.f, 1.f, .5f),
+       ozz::math::simd_float4::Load(1.f, 2.f, 1.f, .5f),
+       ozz::math::simd_float4::Load(1.f, 2.f, 1.f, .5f)}};
+    _input[i] = transform;
+  }
+}
+}  // namespace
+
+TEST(Range, LocalToModel) {
+  Skeleton* skeleton = BuildBranchesSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  ozz::math::SoaTransform input[12];
+  FillInput(input, 12);
+
+  // Reference, computed with a single job.
+  ozz::math::Float4x4 reference[45];
+  LocalToModelJob job;
+  job.skeleton = skeleton;
+  job.input = input;
+  job.output = reference;
+  ASSERT_TRUE(job.Run());
+
+  // Joints can be processed by consecutive ranges.
+  {
+    ozz::math::Float4x4 output[45] = {};
+    job.output = output;
+    const int ranges[] = {0, 3, 4, 9, 23, 24, 45};
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(ranges) - 1; ++i) {
+      job.from = ranges[i];
+      job.to = ranges[i + 1];
+      ASSERT_TRUE(job.Run());
+    }
+    EXPECT_EQ(std::memcmp(output, reference, sizeof(output)), 0);
+  }
+
+  // Joints outside of the range aren't written.
+  {
+    ozz::math::Float4x4 output[45] = {};
+    job.output = output;
+    job.from = 0;
+    job.to = 6;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(std::memcmp(output, reference, 6 * sizeof(output[0])), 0);
+    const ozz::math::Float4x4 zero = {};
+    for (int i = 6; i < 45; ++i) {
+      EXPECT_EQ(std::memcmp(&output[i], &zero, sizeof(zero)), 0);
+    }
+  }
+
+  // Ranges of a partition stage can be processed in any order.
+  for (int grain = 1; grain < 46; ++grain) {
+    ozz::animation::JointsPartition::JointRange ranges[45];
+    uint16_t stages[46];
+    ozz::animation::JointsPartition partition;
+    partition.ranges = ranges;
+    partition.stages = stages;
+    ASSERT_TRUE(ozz::animation::PartitionJoints(*skeleton, grain, &partition));
+
+    ozz::math::Float4x4 output[45] = {};
+    job.output = output;
+    for (int s = 0; s < partition.num_stages; ++s) {
+      for (int r = partition.stages[s + 1] - 1; r >= partition.stages[s]; --r) {
+        job.from = partition.ranges[r].from;
+        job.to = partition.ranges[r].to;
+        ASSERT_TRUE(job.Run());
+      }
+    }
+    EXPECT_EQ(std::memcmp(output, reference, sizeof(output)), 0);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+namespace {
+// Flags _joint and its descendants.
+void FlagSubtree(const Skeleton& _skeleton, int _joint, bool* _flags) {
+  for (int i = 0; i < _skeleton.num_joints(); ++i) {
+    const int parent = _skeleton.joint_properties().begin[i].parent;
+    _flags[i] |= i == _joint ||
+                 (parent != Skeleton::kNoParentIndex && _flags[parent]);
+  }
+}
+
+// Runs _job, expecting that only _updated joints are computed. Other joints
+// are zeroed, except ancestors of updated joints that are set to _reference.
+void ExpectSubtreeUpdate(const LocalToModelJob& _job,
+                         const ozz::math::Float4x4* _reference,
+                         const bool* _updated) {
+  const int num_joints = _job.skeleton->num_joints();
+  bool ancestors[Skeleton::kMaxJoints] = {false};
+  for (int i = num_joints - 1; i >= 0; --i) {
+    const int parent = _job.skeleton->joint_properties().begin[i].parent;
+    if ((_updated[i] || ancestors[i]) && parent != Skeleton::kNoParentIndex) {
+      ancestors[parent] = !_updated[parent];
+    }
+  }
+
+  const ozz::math::Float4x4 zero = {};
+  for (int i = 0; i < num_joints; ++i) {
+    _job.output.begin[i] = ancestors[i] ? _reference[i] : zero;
+  }
+
+  ASSERT_TRUE(_job.Run());
+  for (int i = 0; i < num_joints; ++i) {
+    const ozz::math::Float4x4& expected =
+      _updated[i] || ancestors[i] ? _reference[i] : zero;
+    EXPECT_EQ(std::memcmp(&_job.output.begin[i], &expected, sizeof(expected)),
+              0) << "joint " << i;
+  }
+}
+}  // namespace
+
+TEST(Subtree, LocalToModel) {
+  Skeleton* skeleton = BuildBranchesSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  ozz::math::SoaTransform input[12];
+  FillInput(input, 12);
+
+  // Reference, computed with a full update.
+  ozz::math::Float4x4 reference[45];
+  LocalToModelJob job;
+  job.skeleton = skeleton;
+  job.input = input;
+  job.output = reference;
+  ASSERT_TRUE(job.Run());
+
+  ozz::math::Float4x4 output[45];
+  job.output = output;
+
+  // Updates root subtrees, from the whole hierarchy down to leaves.
+  const int roots[] = {0, 2, 7, 5, 44};
+  for (size_t r = 0; r < OZZ_ARRAY_SIZE(roots); ++r) {
+    bool updated[45] = {false};
+    FlagSubtree(*skeleton, roots[r], updated);
+    job.root = roots[r];
+    ExpectSubtreeUpdate(job, reference, updated);
+  }
+
+  // Updates dirty joints subtrees.
+  const int dirty_joints[] = {3, 33, 40};
+  uint32_t dirty[2] = {0, 0};
+  bool updated[45] = {false};
+  for (size_t d = 0; d < OZZ_ARRAY_SIZE(dirty_joints); ++d) {
+    const int joint = dirty_joints[d];
+    dirty[joint / 32] |= 1u << (joint & 31);
+    FlagSubtree(*skeleton, joint, updated);
+  }
+  job.root = Skeleton::kNoParentIndex;
+  job.dirty = dirty;
+  ExpectSubtreeUpdate(job, reference, updated);
+
+  // Combines root and dirty joints.
+  job.root = 6;
+  FlagSubtree(*skeleton, 6, updated);
+  ExpectSubtreeUpdate(job, reference, updated);
+
+  // Restricted to a joint range.
+  job.from = 4;
+  job.to = 30;
+  for (int i = 0; i < 45; ++i) {
+    updated[i] &= i >= 4 && i < 30;
+  }
+  ExpectSubtreeUpdate(job, reference, updated);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
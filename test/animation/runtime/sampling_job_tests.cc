@@ -40,6 +40,7 @@
 
 using ozz::animation::Animation;
 using ozz::animation::SamplingJob;
+using ozz::animation::BatchSamplingJob;
 using ozz::animation::SamplingCache;
 using ozz::animation::offline::RawAnimation;
 using ozz::animation::offline::AnimationBuilder;
@@ -166,6 +167,47 @@ TEST(JobValidity, SamplingJob) {
     EXPECT_TRUE(job.Run());
   }
 
+  {  // Invalid soa joints mask, end without begin.
+    ozz::math::SoaTransform output[1];
+    const uint8_t mask[1] = {1};
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.soa_joints_mask.end = mask + 1;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid soa joints mask, too small.
+    ozz::math::SoaTransform output[1];
+    const uint8_t mask[1] = {1};
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.soa_joints_mask.begin = mask;
+    job.soa_joints_mask.end = mask;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job with soa joints mask.
+    ozz::math::SoaTransform output[1];
+    const uint8_t mask[1] = {1};
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.soa_joints_mask.begin = mask;
+    job.soa_joints_mask.end = mask + 1;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
   {  // Default animation.
     ozz::math::SoaTransform output[1];
     Animation default_animation;
@@ -689,3 +731,705 @@ TEST(SamplingCache, SamplingJob) {
   ozz::memory::default_allocator()->Delete(animations[0]);
   ozz::memory::default_allocator()->Delete(animations[1]);
 }
+
+TEST(SamplingSeek, SamplingJob) {
+  // Builds an animation with enough keys to have seek points.
+  RawAnimation raw_animation;
+  raw_animation.duration = 10.f;
+  raw_animation.tracks.resize(5);
+  for (int i = 0; i < 5; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const int num_keys = 20 + i * 17;
+    for (int k = 0; k < num_keys; ++k) {
+      const float time = raw_animation.duration * k / num_keys;
+      const float value = static_cast<float>(i * 100 + k);
+      const RawAnimation::TranslationKey tkey =
+        {time, ozz::math::Float3(value, -value, value * .5f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey =
+        {time, ozz::math::Quaternion::FromEuler(
+           ozz::math::Float3(value * .1f, value * .2f, -value * .05f))};
+      track.rotations.push_back(rkey);
+      if (k % 3 == 0) {
+        const RawAnimation::ScaleKey skey =
+          {time, ozz::math::Float3(1.f + value * .1f, 1.f, 2.f)};
+        track.scales.push_back(skey);
+      }
+    }
+  }
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_GT(animation->translations_seek_table().times.Count(), 2u);
+  EXPECT_GT(animation->rotations_seek_table().times.Count(), 2u);
+  EXPECT_GT(animation->scales_seek_table().times.Count(), 0u);
+
+  // Forward, backward, scrubbed and out of range times.
+  const float times[] = {0.f, .1f, 2.f, 1.9f, 1.9f, 0.f, 9.5f, 3.3f, 3.4f, 7.f,
+                         6.99f, 6.5f, 4.f, 10.f, 12.f, .05f, -1.f, 5.f, 2.5f,
+                         8.f, 7.5f, 7.f, 6.5f, 6.f, 5.5f, 5.f, 4.5f, 4.f};
+
+  SamplingCache cache(5);
+  ozz::math::SoaTransform output[2];
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 2;
+
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    memset(output, 0xde, sizeof(output));
+    job.time = times[i];
+    ASSERT_TRUE(job.Run());
+
+    // Sampling with a persistent cache must match sampling with a new one.
+    SamplingCache new_cache(5);
+    ozz::math::SoaTransform expected[2];
+    memset(expected, 0xde, sizeof(expected));
+    SamplingJob new_job;
+    new_job.animation = animation;
+    new_job.cache = &new_cache;
+    new_job.time = times[i];
+    new_job.output.begin = expected;
+    new_job.output.end = expected + 2;
+    ASSERT_TRUE(new_job.Run());
+    EXPECT_EQ(memcmp(output, expected, sizeof(output)), 0) << "time " <<
+      times[i];
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(SamplingPackedRotations, SamplingJob) {
+  // Builds an animation with enough keys to have seek points, and a track whose
+  // keys are too close to have distinct quantized times.
+  RawAnimation raw_animation;
+  raw_animation.duration = 10.f;
+  raw_animation.tracks.resize(6);
+  for (int i = 0; i < 5; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const int num_keys = 20 + i * 17;
+    for (int k = 0; k < num_keys; ++k) {
+      const float time = raw_animation.duration * k / num_keys;
+      const float value = static_cast<float>(i * 100 + k);
+      const RawAnimation::RotationKey rkey =
+        {time, ozz::math::Quaternion::FromEuler(
+           ozz::math::Float3(value * .1f, value * .2f, -value * .05f))};
+      track.rotations.push_back(rkey);
+    }
+  }
+  const RawAnimation::RotationKey close_keys[] = {
+    {0.f, ozz::math::Quaternion::identity()},
+    {1e-6f, ozz::math::Quaternion(0.f, .70710677f, 0.f, .70710677f)},
+    {5.f, ozz::math::Quaternion(0.f, .70710677f, 0.f, .70710677f)},
+    {10.f - 1e-6f, ozz::math::Quaternion(0.f, 1.f, 0.f, 0.f)},
+    {10.f, ozz::math::Quaternion(.70710677f, 0.f, 0.f, .70710677f)}};
+  raw_animation.tracks[5].rotations.assign(
+    close_keys, close_keys + OZZ_ARRAY_SIZE(close_keys));
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->rotation_format(), Animation::kRotationStandard);
+  EXPECT_EQ(animation->packed_rotations().Size(), 0u);
+
+  builder.rotation_format = Animation::kRotationPacked;
+  Animation* packed = builder(raw_animation);
+  ASSERT_TRUE(packed != NULL);
+  EXPECT_EQ(packed->rotation_format(), Animation::kRotationPacked);
+  EXPECT_EQ(packed->rotations().Size(), 0u);
+  EXPECT_GT(packed->rotations_seek_table().times.Count(), 2u);
+
+  // Keys too close to the previous one are removed, but the last one. Key
+  // sizes are hard coded, as key frame types aren't public.
+  const size_t kRotationKeySize = 12;
+  const size_t kPackedRotationKeySize = 8;
+  EXPECT_EQ(animation->rotations().Size() / kRotationKeySize - 2,
+            packed->packed_rotations().Size() / kPackedRotationKeySize);
+  EXPECT_LT(packed->size(), animation->size());
+
+  // Forward, backward, scrubbed and out of range times.
+  const float times[] = {0.f, .1f, 2.f, 1.9f, 1.9f, 0.f, 9.5f, 3.3f, 3.4f, 7.f,
+                         6.99f, 6.5f, 4.f, 10.f, 12.f, .05f, -1.f, 5.f, 2.5f,
+                         8.f, 7.5f, 7.f, 6.5f, 6.f, 5.5f, 5.f, 4.5f, 4.f};
+
+  SamplingCache cache(6);
+  SamplingCache packed_cache(6);
+  ozz::math::SoaTransform output[2];
+  ozz::math::SoaTransform packed_output[2];
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 2;
+  SamplingJob packed_job;
+  packed_job.animation = packed;
+  packed_job.cache = &packed_cache;
+  packed_job.output.begin = packed_output;
+  packed_job.output.end = packed_output + 2;
+
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    job.time = times[i];
+    ASSERT_TRUE(job.Run());
+    packed_job.time = times[i];
+    ASSERT_TRUE(packed_job.Run());
+
+    // Packed rotations must match standard ones within quantization error,
+    // excepted for the track whose keys were removed.
+    for (int j = 0; j < 2; ++j) {
+      float expected[4][4];
+      float actual[4][4];
+      const ozz::math::SoaQuaternion& e = output[j].rotation;
+      const ozz::math::SoaQuaternion& a = packed_output[j].rotation;
+      ozz::math::StorePtrU(e.x, expected[0]);
+      ozz::math::StorePtrU(e.y, expected[1]);
+      ozz::math::StorePtrU(e.z, expected[2]);
+      ozz::math::StorePtrU(e.w, expected[3]);
+      ozz::math::StorePtrU(a.x, actual[0]);
+      ozz::math::StorePtrU(a.y, actual[1]);
+      ozz::math::StorePtrU(a.z, actual[2]);
+      ozz::math::StorePtrU(a.w, actual[3]);
+      for (int c = 0; c < 4; ++c) {
+        for (int k = 0; k < 4 && j * 4 + k < 5; ++k) {
+          EXPECT_NEAR(expected[c][k], actual[c][k], 2e-3f) << "time " <<
+            times[i] << ", track " << j * 4 + k;
+        }
+      }
+      // Track with close keys is still sampled with valid values.
+      if (j == 1) {
+        EXPECT_EQ(actual[3][1], actual[3][1]) << "time " << times[i];
+      }
+    }
+
+    // Sampling with a persistent cache must match sampling with a new one.
+    SamplingCache new_cache(6);
+    ozz::math::SoaTransform expected[2];
+    memset(expected, 0xde, sizeof(expected));
+    SamplingJob new_job;
+    new_job.animation = packed;
+    new_job.cache = &new_cache;
+    new_job.time = times[i];
+    new_job.output.begin = expected;
+    new_job.output.end = expected + 2;
+    ASSERT_TRUE(new_job.Run());
+    EXPECT_EQ(memcmp(packed_output, expected, sizeof(packed_output)), 0) <<
+      "time " << times[i];
+  }
+
+  ozz::memory::default_allocator()->Delete(packed);
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+namespace {
+// Expects _a and _b SoaFloat4 to be equal within _tolerance.
+void ExpectSoaNear(ozz::math::SimdFloat4 _a, ozz::math::SimdFloat4 _b,
+                   float _tolerance, float _time) {
+  float a[4];
+  float b[4];
+  ozz::math::StorePtrU(_a, a);
+  ozz::math::StorePtrU(_b, b);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NEAR(a[i], b[i], _tolerance) << "time " << _time << ", lane " << i;
+  }
+}
+}  // namespace
+
+TEST(SamplingQuantizedTimes, SamplingJob) {
+  // Builds an animation with enough keys to have seek points.
+  RawAnimation raw_animation;
+  raw_animation.duration = 10.f;
+  raw_animation.tracks.resize(7);
+  for (int i = 0; i < 7; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const int num_keys = 20 + i * 13;
+    for (int k = 0; k < num_keys; ++k) {
+      const float time = raw_animation.duration * k / num_keys;
+      const float value = static_cast<float>(i * 10 + k);
+      const RawAnimation::TranslationKey tkey =
+        {time, ozz::math::Float3(value, -value, value * .5f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey =
+        {time, ozz::math::Quaternion::FromEuler(
+           ozz::math::Float3(value * .1f, value * .2f, -value * .05f))};
+      track.rotations.push_back(rkey);
+      if (k % 3 == 0) {
+        const RawAnimation::ScaleKey skey =
+          {time, ozz::math::Float3(1.f + value * .1f, 1.f, 2.f)};
+        track.scales.push_back(skey);
+      }
+    }
+  }
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->time_format(), Animation::kTimeFloat);
+  EXPECT_EQ(animation->quantized_translations().Size(), 0u);
+  EXPECT_EQ(animation->quantized_rotations().Size(), 0u);
+  EXPECT_EQ(animation->quantized_scales().Size(), 0u);
+
+  // Quantized times are tested with both rotation formats.
+  for (int f = 0; f < 2; ++f) {
+    builder.time_format = Animation::kTimeQuantized;
+    builder.rotation_format =
+      f == 0 ? Animation::kRotationStandard : Animation::kRotationPacked;
+    Animation* quantized = builder(raw_animation);
+    ASSERT_TRUE(quantized != NULL);
+    EXPECT_EQ(quantized->time_format(), Animation::kTimeQuantized);
+    EXPECT_EQ(quantized->translations().Size(), 0u);
+    EXPECT_EQ(quantized->rotations().Size(), 0u);
+    EXPECT_EQ(quantized->scales().Size(), 0u);
+    EXPECT_EQ(quantized->quantized_rotations().Size() == 0u, f == 1);
+    EXPECT_GT(quantized->translations_seek_table().times.Count(), 2u);
+    EXPECT_GT(quantized->rotations_seek_table().times.Count(), 2u);
+    EXPECT_LT(quantized->size(), animation->size());
+
+    // Forward, backward, scrubbed and out of range times.
+    const float times[] = {0.f, .1f, 2.f, 1.9f, 1.9f, 0.f, 9.5f, 3.3f, 3.4f,
+                           7.f, 6.99f, 6.5f, 4.f, 10.f, 12.f, .05f, -1.f, 5.f,
+                           2.5f, 8.f, 7.5f, 7.f, 6.5f, 6.f, 5.5f, 5.f, 4.5f};
+
+    SamplingCache cache(7);
+    SamplingCache quantized_cache(7);
+    ozz::math::SoaTransform output[2];
+    ozz::math::SoaTransform quantized_output[2];
+    SamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output.begin = output;
+    job.output.end = output + 2;
+    SamplingJob quantized_job;
+    quantized_job.animation = quantized;
+    quantized_job.cache = &quantized_cache;
+    quantized_job.output.begin = quantized_output;
+    quantized_job.output.end = quantized_output + 2;
+
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+      job.time = times[i];
+      ASSERT_TRUE(job.Run());
+      quantized_job.time = times[i];
+      ASSERT_TRUE(quantized_job.Run());
+
+      // Values must match float time ones within time quantization error.
+      for (int j = 0; j < 2; ++j) {
+        const ozz::math::SoaTransform& e = output[j];
+        const ozz::math::SoaTransform& a = quantized_output[j];
+        ExpectSoaNear(e.translation.x, a.translation.x, 2e-3f, times[i]);
+        ExpectSoaNear(e.translation.y, a.translation.y, 2e-3f, times[i]);
+        ExpectSoaNear(e.translation.z, a.translation.z, 2e-3f, times[i]);
+        ExpectSoaNear(e.rotation.x, a.rotation.x, 2e-3f, times[i]);
+        ExpectSoaNear(e.rotation.y, a.rotation.y, 2e-3f, times[i]);
+        ExpectSoaNear(e.rotation.z, a.rotation.z, 2e-3f, times[i]);
+        ExpectSoaNear(e.rotation.w, a.rotation.w, 2e-3f, times[i]);
+        ExpectSoaNear(e.scale.x, a.scale.x, 2e-3f, times[i]);
+        ExpectSoaNear(e.scale.y, a.scale.y, 2e-3f, times[i]);
+        ExpectSoaNear(e.scale.z, a.scale.z, 2e-3f, times[i]);
+      }
+
+      // Sampling with a persistent cache must match sampling with a new one.
+      SamplingCache new_cache(7);
+      ozz::math::SoaTransform expected[2];
+      memset(expected, 0xde, sizeof(expected));
+      SamplingJob new_job;
+      new_job.animation = quantized;
+      new_job.cache = &new_cache;
+      new_job.time = times[i];
+      new_job.output.begin = expected;
+      new_job.output.end = expected + 2;
+      ASSERT_TRUE(new_job.Run());
+      EXPECT_EQ(memcmp(quantized_output, expected, sizeof(expected)), 0) <<
+        "time " << times[i];
+    }
+    ozz::memory::default_allocator()->Delete(quantized);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(SamplingConstantTracks, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(6);
+
+  // Translations of tracks 0, 2 and 5 are animated. Tracks 1, 3 and 4 are
+  // constant: no key, a single key, and keys sharing the same value.
+  const RawAnimation::TranslationKey tkeys[] = {
+    {0.f, ozz::math::Float3(0.f, 0.f, 0.f)},
+    {1.f, ozz::math::Float3(1.f, 2.f, -1.f)},
+    {0.f, ozz::math::Float3(1.f, 2.f, 3.f)},
+    {1.f, ozz::math::Float3(3.f, 2.f, 1.f)},
+    {.5f, ozz::math::Float3(7.f, 8.f, 9.f)},
+    {.2f, ozz::math::Float3(-1.f, -2.f, -3.f)},
+    {.8f, ozz::math::Float3(-1.f, -2.f, -3.f)},
+    {0.f, ozz::math::Float3(0.f, 0.f, 0.f)},
+    {.5f, ozz::math::Float3(2.f, 2.f, 2.f)},
+    {1.f, ozz::math::Float3(0.f, 0.f, 0.f)}};
+  const int tkeys_track[] = {0, 0, 2, 2, 3, 4, 4, 5, 5, 5};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(tkeys); ++i) {
+    raw_animation.tracks[tkeys_track[i]].translations.push_back(tkeys[i]);
+  }
+
+  // Rotation of track 1 is animated, track 3 is constant.
+  const RawAnimation::RotationKey rkey10 =
+    {0.f, ozz::math::Quaternion::identity()};
+  raw_animation.tracks[1].rotations.push_back(rkey10);
+  const RawAnimation::RotationKey rkey11 =
+    {1.f, ozz::math::Quaternion(0.f, .7071067f, 0.f, .7071067f)};
+  raw_animation.tracks[1].rotations.push_back(rkey11);
+  const RawAnimation::RotationKey rkey30 =
+    {.3f, ozz::math::Quaternion(0.f, 0.f, .7071067f, .7071067f)};
+  raw_animation.tracks[3].rotations.push_back(rkey30);
+
+  // All scales are constant.
+  const RawAnimation::ScaleKey skey20 = {.5f, ozz::math::Float3(2.f, 3.f, 4.f)};
+  raw_animation.tracks[2].scales.push_back(skey20);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // Only animated tracks have keys.
+  ASSERT_EQ(animation->translation_tracks().Count(), 3u);
+  EXPECT_EQ(animation->translation_tracks().begin[0], 0);
+  EXPECT_EQ(animation->translation_tracks().begin[1], 2);
+  EXPECT_EQ(animation->translation_tracks().begin[2], 5);
+  EXPECT_EQ(animation->num_soa_translation_tracks(), 1);
+  ASSERT_EQ(animation->rotation_tracks().Count(), 1u);
+  EXPECT_EQ(animation->rotation_tracks().begin[0], 1);
+  EXPECT_EQ(animation->scale_tracks().Count(), 0u);
+  EXPECT_EQ(animation->num_soa_scale_tracks(), 0);
+  EXPECT_EQ(animation->scales().Size(), 0u);
+
+  // Constants include the soa padding joints.
+  const size_t kConstantSize = 8;
+  EXPECT_EQ(animation->constant_translations().Size(), 5 * kConstantSize);
+  EXPECT_EQ(animation->constant_rotations().Size(), 7 * kConstantSize);
+  EXPECT_EQ(animation->constant_scales().Size(), 8 * kConstantSize);
+
+  SamplingCache cache(6);
+  ozz::math::SoaTransform output[2];
+  memset(output, 0xde, sizeof(output));
+
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 2;
+
+  // Samples forward and backward.
+  const float times[] = {0.f, .5f, 1.f, .25f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    const float t = times[i];
+    job.time = t;
+    ASSERT_TRUE(job.Run());
+
+    const float t5 = t < .5f ? t * 4.f : (1.f - t) * 4.f;
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, t, 0.f, 1.f + t * 2.f, 7.f,
+                                                   t * 2.f, 0.f, 2.f, 8.f,
+                                                   -t, 0.f, 3.f - t * 2.f, 9.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, -1.f, t5, 0.f, 0.f,
+                                                   -2.f, t5, 0.f, 0.f,
+                                                   -3.f, t5, 0.f, 0.f);
+
+    // Nlerp between identity and a 90 degrees rotation around y.
+    const float ry = .7071067f * t;
+    const float rw = 1.f - t + .7071067f * t;
+    const float rlen = std::sqrt(ry * ry + rw * rw);
+    EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, 0.f, 0.f, 0.f, 0.f,
+                                                    0.f, ry / rlen, 0.f, 0.f,
+                                                    0.f, 0.f, 0.f, .7071067f,
+                                                    1.f, rw / rlen, 1.f,
+                                                    .7071067f);
+    EXPECT_SOAQUATERNION_EQ_EST(output[1].rotation, 0.f, 0.f, 0.f, 0.f,
+                                                    0.f, 0.f, 0.f, 0.f,
+                                                    0.f, 0.f, 0.f, 0.f,
+                                                    1.f, 1.f, 1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].scale, 1.f, 1.f, 2.f, 1.f,
+                                             1.f, 1.f, 3.f, 1.f,
+                                             1.f, 1.f, 4.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].scale, 1.f, 1.f, 1.f, 1.f,
+                                             1.f, 1.f, 1.f, 1.f,
+                                             1.f, 1.f, 1.f, 1.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(SamplingMask, SamplingJob) {
+  // Uses a number of joints that isn't a multiple of soa size, and constant
+  // tracks so that animated tracks aren't aligned with soa joints.
+  const int kNumJoints = 75;
+  const int kNumSoaJoints = (kNumJoints + 3) / 4;
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(kNumJoints);
+  for (int i = 0; i < kNumJoints; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const int num_keys = i % 4 == 2 ? 1 : 2 + (i % 5);
+    for (int k = 0; k < num_keys; ++k) {
+      const float time =
+        num_keys > 1 ? raw_animation.duration * k / (num_keys - 1) : .5f;
+      const float value = i * .1f + k;
+      const RawAnimation::TranslationKey tkey =
+        {time, ozz::math::Float3(value, -value, value * .5f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey =
+        {time, ozz::math::Quaternion::FromEuler(
+          ozz::math::Float3(value * .2f, -value * .1f, 0.f))};
+      if (i % 7) {
+        track.rotations.push_back(rkey);
+      }
+      const RawAnimation::ScaleKey skey =
+        {time, ozz::math::Float3(1.f + value * .1f, 1.f, 2.f)};
+      track.scales.push_back(skey);
+    }
+  }
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // Reference job samples all joints.
+  SamplingCache reference_cache(kNumJoints);
+  ozz::math::SoaTransform reference[kNumSoaJoints];
+  SamplingJob reference_job;
+  reference_job.animation = animation;
+  reference_job.cache = &reference_cache;
+  reference_job.output.begin = reference;
+  reference_job.output.end = reference + kNumSoaJoints;
+
+  SamplingCache cache(kNumJoints);
+  ozz::math::SoaTransform output[kNumSoaJoints];
+  memset(output, 0xde, sizeof(output));
+  uint8_t mask[(kNumSoaJoints + 7) / 8] = {0};
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.soa_joints_mask.begin = mask;
+  job.soa_joints_mask.end = mask + OZZ_ARRAY_SIZE(mask);
+  job.output.begin = output;
+  job.output.end = output + kNumSoaJoints;
+
+  // Samples forward and backward, while the mask changes. Masked in joints
+  // must match the reference, others must be left unchanged.
+  const float times[] = {0.f, .3f, .6f, 1.1f, 1.1f, .2f, 1.9f, 2.f, .7f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    for (int j = 0; j < kNumSoaJoints; ++j) {
+      if (j % 3 == static_cast<int>(i % 3) || (i == 4 && j < 8)) {
+        mask[j / 8] |= 1 << (j & 7);
+      } else {
+        mask[j / 8] &= ~(1 << (j & 7));
+      }
+    }
+
+    ozz::math::SoaTransform previous[kNumSoaJoints];
+    memcpy(previous, output, sizeof(output));
+
+    reference_job.time = times[i];
+    ASSERT_TRUE(reference_job.Run());
+    job.time = times[i];
+    ASSERT_TRUE(job.Run());
+
+    for (int j = 0; j < kNumSoaJoints; ++j) {
+      const bool enabled = (mask[j / 8] & (1 << (j & 7))) != 0;
+      EXPECT_EQ(memcmp(&output[j],
+                       enabled ? &reference[j] : &previous[j],
+                       sizeof(output[j])), 0) << "time " << times[i] <<
+                       ", soa joint " << j;
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(JobValidity, BatchSamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // Allocates cache.
+  SamplingCache cache(1);
+
+  ozz::math::SoaTransform output[2][1];
+  BatchSamplingJob::Instance instances[2];
+  instances[0].output.begin = output[0];
+  instances[0].output.end = output[0] + 1;
+  instances[1].output.begin = output[1];
+  instances[1].output.end = output[1] + 1;
+
+  { // Empty/default job
+    BatchSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid instances.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid instances range: end < begin.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.instances.begin = instances + 1;
+    job.instances.end = instances;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid animation.
+    BatchSamplingJob job;
+    job.cache = &cache;
+    job.instances.begin = instances;
+    job.instances.end = instances + 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid cache.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.instances.begin = instances;
+    job.instances.end = instances + 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid cache size.
+    SamplingCache zero_cache(0);
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.cache = &zero_cache;
+    job.instances.begin = instances;
+    job.instances.end = instances + 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid instance output.
+    BatchSamplingJob::Instance invalid_instances[2];
+    invalid_instances[0] = instances[0];
+    invalid_instances[1].output.begin = output[1];
+    invalid_instances[1].output.end = output[1];
+
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.instances.begin = invalid_instances;
+    job.instances.end = invalid_instances + 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job with no instance.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.instances.begin = instances;
+    job.instances.end = instances;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid job.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.instances.begin = instances;
+    job.instances.end = instances + 2;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Default animation.
+    Animation default_animation;
+    BatchSamplingJob job;
+    job.animation = &default_animation;
+    job.cache = &cache;
+    job.instances.begin = instances;
+    job.instances.end = instances + 2;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Sampling, BatchSamplingJob) {
+  // Builds an animation with 2 soa tracks and keys on all components.
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(7);
+  for (int i = 0; i < 7; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    for (int k = 0; k <= i; ++k) {
+      const float time = raw_animation.duration * k / (i + 1);
+      const float value = static_cast<float>(i * 10 + k);
+      const RawAnimation::TranslationKey tkey =
+        {time, ozz::math::Float3(value, -value, value * .5f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey =
+        {time + .01f, ozz::math::Quaternion::FromEuler(
+           ozz::math::Float3(value * .1f, value * .2f, -value * .05f))};
+      track.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey =
+        {time + .02f, ozz::math::Float3(1.f + value * .1f, 1.f, 2.f)};
+      track.scales.push_back(skey);
+    }
+  }
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  ASSERT_EQ(animation->num_soa_tracks(), 2);
+
+  // Sorted times, with duplicates, and unsorted ones.
+  const float times[] = {-1.f, 0.f, .1f, .1f, .3f, .31f, .9f, .5f, 1.f, 1.7f,
+                         1.7f, 2.f, 3.f, .2f};
+  const int kNumInstances = OZZ_ARRAY_SIZE(times);
+
+  ozz::math::SoaTransform batch_output[kNumInstances][2];
+  BatchSamplingJob::Instance instances[kNumInstances];
+  for (int i = 0; i < kNumInstances; ++i) {
+    instances[i].time = times[i];
+    instances[i].output.begin = batch_output[i];
+    instances[i].output.end = batch_output[i] + 2;
+  }
+
+  SamplingCache batch_cache(7);
+  BatchSamplingJob batch_job;
+  batch_job.animation = animation;
+  batch_job.cache = &batch_cache;
+  batch_job.instances.begin = instances;
+  batch_job.instances.end = instances + kNumInstances;
+
+  // Runs twice, so that the cache is reused from its last state.
+  for (int run = 0; run < 2; ++run) {
+    memset(batch_output, 0xde, sizeof(batch_output));
+    ASSERT_TRUE(batch_job.Run());
+
+    // Batch sampling must match individual sampling exactly.
+    for (int i = 0; i < kNumInstances; ++i) {
+      SamplingCache cache(7);
+      ozz::math::SoaTransform output[2];
+      memset(output, 0xde, sizeof(output));
+      SamplingJob job;
+      job.animation = animation;
+      job.cache = &cache;
+      job.time = times[i];
+      job.output.begin = output;
+      job.output.end = output + 2;
+      ASSERT_TRUE(job.Run());
+      EXPECT_EQ(memcmp(output, batch_output[i], sizeof(output)), 0);
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
@@ -0,0 +1,407 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/segmented_animation.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/segmented_animation_builder.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SegmentedAnimation;
+using ozz::animation::SamplingJob;
+using ozz::animation::SamplingCache;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::SegmentedAnimationBuilder;
+
+namespace {
+void BuildRawAnimation(RawAnimation* _raw_animation) {
+  _raw_animation->duration = 4.5f;
+  _raw_animation->name = "segmented";
+  _raw_animation->tracks.resize(5);
+  for (int i = 0; i < 4; ++i) {  // Last track has no key.
+    RawAnimation::JointTrack& track = _raw_animation->tracks[i];
+    for (int k = 0; k < 10 + i * 3; ++k) {
+      const float time = .05f + k * .4f / (i + 1);
+      if (time > _raw_animation->duration) {
+        break;
+      }
+      const float value = static_cast<float>(i * 10 + k % 5);
+      const RawAnimation::TranslationKey tkey =
+        {time, ozz::math::Float3(value, -value, value * .5f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey =
+        {time, ozz::math::Quaternion::FromEuler(
+           ozz::math::Float3(value * .1f, value * .2f, -value * .05f))};
+      track.rotations.push_back(rkey);
+    }
+    const RawAnimation::ScaleKey skey =
+      {1.f, ozz::math::Float3(1.f + i, 1.f, 2.f)};
+    track.scales.push_back(skey);
+  }
+}
+
+// Samples _animation at _time, with _cache if it isn't NULL.
+void Sample(const Animation& _animation, float _time,
+            ozz::math::SoaTransform* _output, SamplingCache* _cache = NULL) {
+  SamplingCache cache(_animation.num_tracks());
+  SamplingJob job;
+  job.animation = &_animation;
+  job.cache = _cache ? _cache : &cache;
+  job.time = _time;
+  job.output.begin = _output;
+  job.output.end = _output + _animation.num_soa_tracks();
+  ASSERT_TRUE(job.Run());
+}
+
+void ExpectSimdNear(ozz::math::SimdFloat4 _a, ozz::math::SimdFloat4 _b,
+                    float _tolerance) {
+  float a[4], b[4];
+  ozz::math::StorePtrU(_a, a);
+  ozz::math::StorePtrU(_b, b);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NEAR(a[i], b[i], _tolerance);
+  }
+}
+
+// Compares sampling results of a segmented animation and the full animation.
+// Segments are sampled with _cache if it isn't NULL.
+void ExpectSamplingMatches(const SegmentedAnimation& _segmented,
+                           const Animation& _animation, float _time,
+                           SamplingCache* _cache = NULL) {
+  SCOPED_TRACE(_time);
+  float segment_time;
+  const Animation* segment = _segmented.Resolve(_time, &segment_time);
+  ASSERT_TRUE(segment != NULL);
+  ASSERT_EQ(segment->num_tracks(), _animation.num_tracks());
+
+  ozz::math::SoaTransform expected[2];
+  ozz::math::SoaTransform output[2];
+  Sample(_animation, _time, expected);
+  Sample(*segment, segment_time, output, _cache);
+  for (int i = 0; i < 2; ++i) {
+    ExpectSimdNear(output[i].translation.x, expected[i].translation.x, 2e-2f);
+    ExpectSimdNear(output[i].translation.y, expected[i].translation.y, 2e-2f);
+    ExpectSimdNear(output[i].translation.z, expected[i].translation.z, 2e-2f);
+    // Q and -Q are the same rotation, as segments first keys are normalized
+    // independently.
+    const ozz::math::SoaQuaternion& a = output[i].rotation;
+    const ozz::math::SoaQuaternion& b = expected[i].rotation;
+    const ozz::math::SimdFloat4 dot =
+      ozz::math::Abs(a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w);
+    ExpectSimdNear(dot, ozz::math::simd_float4::one(), 2e-3f);
+    ExpectSimdNear(output[i].scale.x, expected[i].scale.x, 2e-3f);
+    ExpectSimdNear(output[i].scale.y, expected[i].scale.y, 2e-3f);
+    ExpectSimdNear(output[i].scale.z, expected[i].scale.z, 2e-3f);
+  }
+}
+}  // namespace
+
+TEST(Error, SegmentedAnimationBuilder) {
+  SegmentedAnimationBuilder builder;
+
+  {  // Invalid raw animation.
+    RawAnimation raw_animation;
+    raw_animation.duration = -1.f;
+    EXPECT_TRUE(builder(raw_animation) == NULL);
+  }
+
+  {  // Invalid segment duration.
+    RawAnimation raw_animation;
+    SegmentedAnimationBuilder invalid_builder;
+    invalid_builder.segment_duration = 0.f;
+    EXPECT_TRUE(invalid_builder(raw_animation) == NULL);
+  }
+}
+
+TEST(Empty, SegmentedAnimation) {
+  SegmentedAnimation animation;
+  EXPECT_EQ(animation.num_segments(), 0);
+  EXPECT_EQ(animation.num_tracks(), 0);
+  EXPECT_STREQ(animation.name(), "");
+  EXPECT_TRUE(animation.Update(0.f));
+  float segment_time;
+  EXPECT_TRUE(animation.Resolve(0.f, &segment_time) == NULL);
+  EXPECT_TRUE(animation.segment(0) == NULL);
+}
+
+TEST(Build, SegmentedAnimation) {
+  RawAnimation raw_animation;
+  BuildRawAnimation(&raw_animation);
+
+  AnimationBuilder animation_builder;
+  Animation* animation = animation_builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SegmentedAnimationBuilder builder;
+  SegmentedAnimation* segmented = builder(raw_animation);
+  ASSERT_TRUE(segmented != NULL);
+
+  EXPECT_FLOAT_EQ(segmented->duration(), 4.5f);
+  EXPECT_FLOAT_EQ(segmented->segment_duration(), 1.f);
+  EXPECT_EQ(segmented->num_tracks(), 5);
+  EXPECT_STREQ(segmented->name(), "segmented");
+  ASSERT_EQ(segmented->num_segments(), 5);
+
+  EXPECT_EQ(segmented->segment_index(-1.f), 0);
+  EXPECT_EQ(segmented->segment_index(0.f), 0);
+  EXPECT_EQ(segmented->segment_index(.99f), 0);
+  EXPECT_EQ(segmented->segment_index(1.f), 1);
+  EXPECT_EQ(segmented->segment_index(4.5f), 4);
+  EXPECT_EQ(segmented->segment_index(46.f), 4);
+
+  // All segments are resident, and cannot be streamed out.
+  EXPECT_TRUE(segmented->Update(0.f));
+  for (int i = 0; i < segmented->num_segments(); ++i) {
+    EXPECT_TRUE(segmented->segment(i) != NULL);
+  }
+  EXPECT_FLOAT_EQ(segmented->segment(0)->duration(), 1.f);
+  EXPECT_FLOAT_EQ(segmented->segment(4)->duration(), .5f);
+
+  const float times[] = {-1.f, 0.f, .3f, .999f, 1.f, 1.45f, 2.f, 3.7f, 4.f,
+                         4.49f, 4.5f, 10.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    ExpectSamplingMatches(*segmented, *animation, times[i]);
+  }
+
+  ozz::memory::default_allocator()->Delete(segmented);
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Streaming, SegmentedAnimation) {
+  RawAnimation raw_animation;
+  BuildRawAnimation(&raw_animation);
+
+  AnimationBuilder animation_builder;
+  Animation* animation = animation_builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  ozz::io::MemoryStream stream;
+  {
+    SegmentedAnimationBuilder builder;
+    builder.segment_duration = .7f;
+    SegmentedAnimation* segmented = builder(raw_animation);
+    ASSERT_TRUE(segmented != NULL);
+
+    ozz::io::OArchive o(&stream, ozz::kBigEndian);
+    o << *segmented;
+    const int32_t end_marker = 46;
+    o << end_marker;
+    ozz::memory::default_allocator()->Delete(segmented);
+  }
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  ASSERT_TRUE(i.TestTag<SegmentedAnimation>());
+  SegmentedAnimation segmented;
+  i >> segmented;
+
+  // Archive is positioned after segments data.
+  int32_t end_marker;
+  i >> end_marker;
+  EXPECT_EQ(end_marker, 46);
+
+  EXPECT_FLOAT_EQ(segmented.duration(), 4.5f);
+  EXPECT_FLOAT_EQ(segmented.segment_duration(), .7f);
+  EXPECT_EQ(segmented.num_tracks(), 5);
+  EXPECT_STREQ(segmented.name(), "segmented");
+  ASSERT_EQ(segmented.num_segments(), 7);
+
+  // No segment is resident after loading.
+  for (int s = 0; s < segmented.num_segments(); ++s) {
+    EXPECT_TRUE(segmented.segment(s) == NULL);
+  }
+  const size_t header_size = segmented.size();
+
+  // Streams segments in and out while playing forward and backward.
+  const float times[] = {0.f, .2f, .8f, 1.5f, 2.2f, 4.4f, 4.5f, 1.f, 3.f, 0.f};
+  for (size_t t = 0; t < OZZ_ARRAY_SIZE(times); ++t) {
+    ASSERT_TRUE(segmented.Update(times[t], 1));
+    const int index = segmented.segment_index(times[t]);
+    for (int s = 0; s < segmented.num_segments(); ++s) {
+      const bool resident = s == index || s == index + 1;
+      EXPECT_EQ(segmented.segment(s) != NULL, resident);
+    }
+    EXPECT_GT(segmented.size(), header_size);
+    ExpectSamplingMatches(segmented, *animation, times[t]);
+  }
+
+  // Only current segment.
+  ASSERT_TRUE(segmented.Update(2.f, 0));
+  for (int s = 0; s < segmented.num_segments(); ++s) {
+    EXPECT_EQ(segmented.segment(s) != NULL, s == 2);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(StreamingCache, SegmentedAnimation) {
+  RawAnimation raw_animation;
+  BuildRawAnimation(&raw_animation);
+
+  AnimationBuilder animation_builder;
+  Animation* animation = animation_builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  ozz::io::MemoryStream stream;
+  {
+    SegmentedAnimationBuilder builder;
+    builder.segment_duration = .7f;
+    SegmentedAnimation* segmented = builder(raw_animation);
+    ASSERT_TRUE(segmented != NULL);
+    ozz::io::OArchive o(&stream);
+    o << *segmented;
+    ozz::memory::default_allocator()->Delete(segmented);
+  }
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  SegmentedAnimation segmented;
+  i >> segmented;
+
+  // A single cache is used for the whole playback. Only the current segment is
+  // resident, so every segment change streams out the previous one, whose
+  // address is likely to be reused by the next one.
+  SamplingCache cache(segmented.num_tracks());
+  bool streamed_out;
+  ASSERT_TRUE(segmented.Update(0.f, 0, &streamed_out));
+  EXPECT_FALSE(streamed_out);
+
+  // Plays forward, then backward.
+  for (int pass = 0; pass < 2; ++pass) {
+    for (int t = 0; t <= 90; ++t) {
+      const float time = (pass == 0 ? t : 90 - t) * .05f;
+      const int previous = segmented.segment_index(
+        t == 0 ? time : (pass == 0 ? t - 1 : 91 - t) * .05f);
+      ASSERT_TRUE(segmented.Update(time, 0, &streamed_out));
+      EXPECT_EQ(streamed_out, segmented.segment_index(time) != previous);
+      if (streamed_out) {
+        cache.Invalidate();
+      }
+      ExpectSamplingMatches(segmented, *animation, time, &cache);
+    }
+  }
+
+  // Nothing is streamed out when segments are already resident.
+  ASSERT_TRUE(segmented.Update(.1f, 0, &streamed_out));
+  EXPECT_FALSE(streamed_out);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+namespace {
+// Copies the _size first bytes of _stream to _copy.
+void CopyStream(ozz::io::MemoryStream* _stream, size_t _size,
+                ozz::io::MemoryStream* _copy) {
+  char* buffer = ozz::memory::default_allocator()->Allocate<char>(_size);
+  _stream->Seek(0, ozz::io::Stream::kSet);
+  ASSERT_EQ(_stream->Read(buffer, _size), _size);
+  ASSERT_EQ(_copy->Write(buffer, _size), _size);
+  _copy->Seek(0, ozz::io::Stream::kSet);
+  ozz::memory::default_allocator()->Deallocate(buffer);
+}
+}  // namespace
+
+TEST(StreamingErrors, SegmentedAnimation) {
+  RawAnimation raw_animation;
+  BuildRawAnimation(&raw_animation);
+
+  ozz::io::MemoryStream stream;
+  {
+    SegmentedAnimationBuilder builder;
+    builder.segment_duration = .7f;
+    SegmentedAnimation* segmented = builder(raw_animation);
+    ASSERT_TRUE(segmented != NULL);
+    ozz::io::OArchive o(&stream);
+    o << *segmented;
+    ozz::memory::default_allocator()->Delete(segmented);
+  }
+
+  // Finds segments position in the stream, from their animation tag.
+  const char kTag[] = "ozz-animation";
+  const size_t size = stream.Size();
+  ozz::Vector<size_t>::Std tags;
+  {
+    ozz::Vector<char>::Std buffer(size);
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ASSERT_EQ(stream.Read(&buffer[0], size), size);
+    for (size_t p = 0; p + sizeof(kTag) <= size; ++p) {
+      if (std::memcmp(&buffer[p], kTag, sizeof(kTag)) == 0) {
+        tags.push_back(p);
+      }
+    }
+  }
+  ASSERT_EQ(tags.size(), 7u);
+
+  {  // Stream truncated in the middle of segment 3.
+    ozz::io::MemoryStream truncated;
+    CopyStream(&stream, (tags[3] + tags[4]) / 2, &truncated);
+    ozz::io::IArchive i(&truncated);
+    SegmentedAnimation segmented;
+    i >> segmented;
+    ASSERT_EQ(segmented.num_segments(), 7);
+
+    EXPECT_TRUE(segmented.Update(0.f, 1));
+    EXPECT_FALSE(segmented.Update(1.5f, 1));
+    EXPECT_TRUE(segmented.segment(2) != NULL);
+    EXPECT_TRUE(segmented.segment(3) == NULL);
+    EXPECT_FALSE(segmented.Update(4.5f, 0));
+    EXPECT_TRUE(segmented.segment(6) == NULL);
+  }
+
+  {  // Segment 1 with an unsupported version.
+    ozz::io::MemoryStream corrupted;
+    CopyStream(&stream, size, &corrupted);
+    corrupted.Seek(static_cast<int>(tags[1] + sizeof(kTag)),
+                   ozz::io::Stream::kSet);
+    const uint32_t version = 0xffffffff;
+    ASSERT_EQ(corrupted.Write(&version, sizeof(version)), sizeof(version));
+    corrupted.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&corrupted);
+    SegmentedAnimation segmented;
+    i >> segmented;
+
+    EXPECT_FALSE(segmented.Update(0.f, 1));
+    EXPECT_TRUE(segmented.segment(0) != NULL);
+    EXPECT_TRUE(segmented.segment(1) == NULL);
+    EXPECT_TRUE(segmented.Update(1.5f, 1));
+    EXPECT_TRUE(segmented.segment(2) != NULL);
+  }
+}
@@ -27,6 +27,9 @@
 
 #include "ozz/animation/runtime/skeleton.h"
 
+#include <cstdio>
+#include <cstring>
+
 #include "gtest/gtest.h"
 
 #include "ozz/base/io/archive.h"
@@ -184,3 +187,73 @@ TEST(AlreadyInitialized, SkeletonSerialize) {
   ozz::memory::default_allocator()->Delete(o_skeleton[0]);
   ozz::memory::default_allocator()->Delete(o_skeleton[1]);
 }
+
+TEST(InPlace, SkeletonSerialize) {
+  Skeleton* o_skeleton = NULL;
+  {
+    RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(1);
+    RawSkeleton::Joint& root = raw_skeleton.roots[0];
+    root.name = "root";
+    root.transform.translation = ozz::math::Float3(46.f, 58.f, 93.f);
+    root.children.resize(2);
+    root.children[0].name = "j0";
+    root.children[1].name = "j1";
+
+    SkeletonBuilder builder;
+    o_skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(o_skeleton != NULL);
+  }
+
+  for (int s = 0; s < 2; ++s) {
+    // Data are used in place from the memory stream, or copied from the file.
+    ozz::io::MemoryStream memory;
+    ozz::io::File file(s == 0 ? NULL : std::tmpfile());
+    ozz::io::Stream* stream = s == 0 ?
+      static_cast<ozz::io::Stream*>(&memory) : &file;
+    ASSERT_TRUE(stream->opened());
+
+    // Streams out an empty skeleton first, then the filled one.
+    ozz::io::OArchive o(stream);
+    Skeleton empty;
+    o << ozz::io::MakeInPlace(empty);
+    o << ozz::io::MakeInPlace(*o_skeleton);
+
+    // Streams in.
+    stream->Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(stream);
+    EXPECT_TRUE(i.TestTag<ozz::io::InPlace<Skeleton> >());
+
+    Skeleton i_skeleton;
+    i >> ozz::io::MakeInPlace(i_skeleton);
+    EXPECT_EQ(i_skeleton.num_joints(), 0);
+
+    // Reuses the skeleton.
+    i >> ozz::io::MakeInPlace(i_skeleton);
+
+    // Compares skeletons.
+    ASSERT_EQ(o_skeleton->num_joints(), i_skeleton.num_joints());
+    for (int j = 0; j < i_skeleton.num_joints(); ++j) {
+      EXPECT_EQ(i_skeleton.joint_properties().begin[j].parent,
+                o_skeleton->joint_properties().begin[j].parent);
+      EXPECT_EQ(i_skeleton.joint_properties().begin[j].is_leaf,
+                o_skeleton->joint_properties().begin[j].is_leaf);
+      EXPECT_STREQ(i_skeleton.joint_names()[j],
+                   o_skeleton->joint_names()[j]);
+    }
+    EXPECT_EQ(std::memcmp(i_skeleton.bind_pose().begin,
+                          o_skeleton->bind_pose().begin,
+                          o_skeleton->bind_pose().Size()), 0);
+
+    if (s == 0) {
+      // Bind poses point to memory stream data.
+      const size_t data_size = i_skeleton.bind_pose().Size() +
+                               i_skeleton.joint_properties().Size() +
+                               sizeof("root") + sizeof("j0") + sizeof("j1");
+      stream->Seek(-static_cast<int>(data_size), ozz::io::Stream::kEnd);
+      EXPECT_EQ(stream->Map(data_size),
+                static_cast<const void*>(i_skeleton.bind_pose().begin));
+    }
+  }
+  ozz::memory::default_allocator()->Delete(o_skeleton);
+}
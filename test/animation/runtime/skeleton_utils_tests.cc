@@ -303,3 +303,158 @@ TEST(InterateWorstDepthDF, SkeletonUtils) {
   }
   ozz::memory::default_allocator()->Delete(skeleton);
 }
+
+namespace {
+// Checks that _partition covers all _skeleton joints, with ranges of at most
+// _grain joints that only depend on previous stages or on themselves.
+void ExpectPartitionValid(const Skeleton& _skeleton,
+                          int _grain,
+                          const ozz::animation::JointsPartition& _partition) {
+  const int num_joints = _skeleton.num_joints();
+  int stages[Skeleton::kMaxJoints];
+  int ranges[Skeleton::kMaxJoints];
+  for (int i = 0; i < num_joints; ++i) {
+    stages[i] = -1;
+  }
+
+  ASSERT_EQ(_partition.stages[0], 0);
+  ASSERT_EQ(_partition.stages[_partition.num_stages], _partition.num_ranges);
+  for (int s = 0; s < _partition.num_stages; ++s) {
+    ASSERT_LT(_partition.stages[s], _partition.stages[s + 1]);
+    for (int r = _partition.stages[s]; r < _partition.stages[s + 1]; ++r) {
+      const ozz::animation::JointsPartition::JointRange& range =
+        _partition.ranges[r];
+      EXPECT_LT(range.from, range.to);
+      EXPECT_LE(range.to - range.from, _grain);
+      ASSERT_LE(range.to, num_joints);
+      for (int i = range.from; i < range.to; ++i) {
+        EXPECT_EQ(stages[i], -1);
+        stages[i] = s;
+        ranges[i] = r;
+      }
+    }
+  }
+
+  for (int i = 0; i < num_joints; ++i) {
+    ASSERT_NE(stages[i], -1);
+    const int parent = _skeleton.joint_properties().begin[i].parent;
+    if (parent != Skeleton::kNoParentIndex) {
+      EXPECT_TRUE(stages[parent] < stages[i] || ranges[parent] == ranges[i]);
+    }
+  }
+}
+}  // namespace
+
+TEST(PartitionJoints, SkeletonUtils) {
+  SkeletonBuilder builder;
+  ozz::animation::JointsPartition::JointRange ranges[Skeleton::kMaxJoints];
+  uint16_t stages[Skeleton::kMaxJoints + 1];
+  ozz::animation::JointsPartition partition;
+  partition.ranges = ranges;
+  partition.stages = stages;
+
+  // Empty skeleton.
+  {
+    RawSkeleton raw_skeleton;
+    Skeleton* skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+
+    EXPECT_TRUE(ozz::animation::PartitionJoints(*skeleton, 8, &partition));
+    EXPECT_EQ(partition.num_ranges, 0);
+    EXPECT_EQ(partition.num_stages, 0);
+    EXPECT_ASSERTION(ozz::animation::PartitionJoints(*skeleton, 0, &partition),
+                     "Grain must be greater than 0.");
+
+    ozz::memory::default_allocator()->Delete(skeleton);
+  }
+
+  // Worst breadth, only roots.
+  {
+    RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(Skeleton::kMaxJoints);
+    Skeleton* skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+
+    EXPECT_TRUE(ozz::animation::PartitionJoints(*skeleton, 100, &partition));
+    EXPECT_EQ(partition.num_stages, 1);
+    EXPECT_EQ(partition.num_ranges, 11);
+    ExpectPartitionValid(*skeleton, 100, partition);
+
+    EXPECT_TRUE(ozz::animation::PartitionJoints(
+      *skeleton, Skeleton::kMaxJoints, &partition));
+    EXPECT_EQ(partition.num_stages, 1);
+    EXPECT_EQ(partition.num_ranges, 1);
+    ExpectPartitionValid(*skeleton, Skeleton::kMaxJoints, partition);
+
+    ozz::memory::default_allocator()->Delete(skeleton);
+  }
+
+  // Worst depth, a single chain.
+  {
+    RawSkeleton raw_skeleton;
+    RawSkeleton::Joint::Children* child = &raw_skeleton.roots;
+    for (int i = 0; i < Skeleton::kMaxJoints; ++i) {
+      child->resize(1);
+      child = &child->at(0).children;
+    }
+    Skeleton* skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+
+    EXPECT_TRUE(ozz::animation::PartitionJoints(*skeleton, 100, &partition));
+    EXPECT_EQ(partition.num_stages, 11);
+    EXPECT_EQ(partition.num_ranges, 11);
+    ExpectPartitionValid(*skeleton, 100, partition);
+
+    ozz::memory::default_allocator()->Delete(skeleton);
+  }
+
+  // Root with 3 chains of 10 joints: root and the head of the chains come
+  // first, then chains are independent.
+  {
+    RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(1);
+    raw_skeleton.roots[0].children.resize(3);
+    for (int c = 0; c < 3; ++c) {
+      RawSkeleton::Joint::Children* child =
+        &raw_skeleton.roots[0].children[c].children;
+      for (int i = 0; i < 9; ++i) {
+        child->resize(1);
+        child = &child->at(0).children;
+      }
+    }
+    Skeleton* skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+    EXPECT_EQ(skeleton->num_joints(), 31);
+
+    EXPECT_TRUE(ozz::animation::PartitionJoints(*skeleton, 10, &partition));
+    ExpectPartitionValid(*skeleton, 10, partition);
+    ASSERT_EQ(partition.num_stages, 2);
+    ASSERT_EQ(partition.num_ranges, 4);
+    EXPECT_EQ(partition.ranges[0].from, 0);
+    EXPECT_EQ(partition.ranges[0].to, 10);
+    EXPECT_EQ(partition.stages[1], 1);
+
+    for (int grain = 1; grain < 32; ++grain) {
+      EXPECT_TRUE(
+        ozz::animation::PartitionJoints(*skeleton, grain, &partition));
+      ExpectPartitionValid(*skeleton, grain, partition);
+    }
+
+    // Buffers too small for the skeleton.
+    ozz::animation::JointsPartition small;
+    small.ranges = ozz::Range<ozz::animation::JointsPartition::JointRange>(
+      ranges, 30);
+    small.stages = stages;
+    EXPECT_FALSE(ozz::animation::PartitionJoints(*skeleton, 10, &small));
+    EXPECT_EQ(small.num_ranges, 0);
+    EXPECT_EQ(small.num_stages, 0);
+    small.ranges = ranges;
+    small.stages = ozz::Range<uint16_t>(stages, 31);
+    EXPECT_FALSE(ozz::animation::PartitionJoints(*skeleton, 10, &small));
+    small.stages = ozz::Range<uint16_t>(stages, 32);
+    EXPECT_TRUE(ozz::animation::PartitionJoints(*skeleton, 10, &small));
+    ExpectPartitionValid(*skeleton, 10, small);
+
+    ozz::memory::default_allocator()->Delete(skeleton);
+  }
+}
@@ -0,0 +1,220 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/skinning_matrices_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float4x4.h"
+
+using ozz::animation::SkinningMatricesJob;
+
+namespace {
+// Builds a matrix that's different for every _i.
+ozz::math::Float4x4 BuildMatrix(int _i) {
+  const float f = static_cast<float>(_i);
+  return ozz::math::Float4x4::Translation(
+           ozz::math::simd_float4::Load(f, -f * 2.f, 3.f, 0.f)) *
+         ozz::math::Float4x4::FromAxisAngle(
+           ozz::math::simd_float4::Load(0.f, 1.f, 0.f, f * .3f)) *
+         ozz::math::Float4x4::Scaling(
+           ozz::math::simd_float4::Load(1.f + f, 1.f, 2.f, 0.f));
+}
+
+// Compares all matrices components.
+void ExpectMatrixEq(const ozz::math::Float4x4& _expected,
+                    const ozz::math::Float4x4& _m) {
+  for (int i = 0; i < 4; ++i) {
+    float expected[4];
+    float m[4];
+    ozz::math::StorePtrU(_expected.cols[i], expected);
+    ozz::math::StorePtrU(_m.cols[i], m);
+    for (int j = 0; j < 4; ++j) {
+      EXPECT_NEAR(expected[j], m[j], 1e-4f);
+    }
+  }
+}
+}  // namespace
+
+TEST(PackInverseBindPoses, SkinningMatricesJob) {
+  ozz::math::Float4x4 matrices[5];
+  for (int i = 0; i < 5; ++i) {
+    matrices[i] = BuildMatrix(i);
+  }
+  ozz::math::SoaFloat4x4 soa[2];
+
+  // Output too small.
+  EXPECT_FALSE(ozz::animation::PackInverseBindPoses(
+    ozz::Range<const ozz::math::Float4x4>(matrices),
+    ozz::Range<ozz::math::SoaFloat4x4>(soa, 1)));
+
+  ASSERT_TRUE(ozz::animation::PackInverseBindPoses(
+    ozz::Range<const ozz::math::Float4x4>(matrices),
+    ozz::Range<ozz::math::SoaFloat4x4>(soa)));
+
+  // Matrix 4 is the first of the second soa element, padding is identity.
+  EXPECT_SOAFLOAT4_EQ(soa[1].cols[3],
+    4.f, 0.f, 0.f, 0.f,
+    -8.f, 0.f, 0.f, 0.f,
+    3.f, 0.f, 0.f, 0.f,
+    1.f, 1.f, 1.f, 1.f);
+  EXPECT_SOAFLOAT4_EQ(soa[1].cols[1],
+    0.f, 0.f, 0.f, 0.f,
+    1.f, 1.f, 1.f, 1.f,
+    0.f, 0.f, 0.f, 0.f,
+    0.f, 0.f, 0.f, 0.f);
+}
+
+TEST(JobValidity, SkinningMatricesJob) {
+  ozz::math::Float4x4 models[5];
+  ozz::math::SoaFloat4x4 inverse_bind_poses[2];
+  uint16_t joint_remaps[5] = {0, 1, 2, 3, 4};
+  ozz::math::Float4x4 output[5];
+
+  { // Default is invalid.
+    SkinningMatricesJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Valid.
+    SkinningMatricesJob job;
+    job.models = models;
+    job.inverse_bind_poses = inverse_bind_poses;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+  }
+  { // Valid, with remaps.
+    SkinningMatricesJob job;
+    job.models = models;
+    job.inverse_bind_poses = inverse_bind_poses;
+    job.joint_remaps = joint_remaps;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+  }
+  { // Invalid, too small inverse bind poses.
+    SkinningMatricesJob job;
+    job.models = models;
+    job.inverse_bind_poses =
+      ozz::Range<const ozz::math::SoaFloat4x4>(inverse_bind_poses, 1);
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Invalid, too small models.
+    SkinningMatricesJob job;
+    job.models = ozz::Range<const ozz::math::Float4x4>(models, 4);
+    job.inverse_bind_poses = inverse_bind_poses;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Valid, smaller models with remaps.
+    const uint16_t small_remaps[5] = {0, 1, 0, 1, 0};
+    SkinningMatricesJob job;
+    job.models = ozz::Range<const ozz::math::Float4x4>(models, 2);
+    job.inverse_bind_poses = inverse_bind_poses;
+    job.joint_remaps = small_remaps;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+  }
+  { // Invalid, remap out of range.
+    SkinningMatricesJob job;
+    job.models = ozz::Range<const ozz::math::Float4x4>(models, 4);
+    job.inverse_bind_poses = inverse_bind_poses;
+    job.joint_remaps = joint_remaps;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Invalid, too small remaps.
+    SkinningMatricesJob job;
+    job.models = models;
+    job.inverse_bind_poses = inverse_bind_poses;
+    job.joint_remaps = ozz::Range<const uint16_t>(joint_remaps, 4);
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Valid, empty output.
+    SkinningMatricesJob job;
+    job.models = models;
+    job.inverse_bind_poses = inverse_bind_poses;
+    job.output = ozz::Range<ozz::math::Float4x4>(output, output);
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(JobResult, SkinningMatricesJob) {
+  const int kNumModels = 9;
+  ozz::math::Float4x4 models[kNumModels];
+  ozz::math::Float4x4 inverse_bind_poses[kNumModels];
+  for (int i = 0; i < kNumModels; ++i) {
+    models[i] = BuildMatrix(i);
+    inverse_bind_poses[i] = ozz::math::Invert(BuildMatrix(kNumModels - i));
+  }
+  ozz::math::SoaFloat4x4 soa_inverse_bind_poses[(kNumModels + 3) / 4];
+  ASSERT_TRUE(ozz::animation::PackInverseBindPoses(
+    ozz::Range<const ozz::math::Float4x4>(inverse_bind_poses),
+    ozz::Range<ozz::math::SoaFloat4x4>(soa_inverse_bind_poses)));
+
+  { // All joints.
+    ozz::math::Float4x4 output[kNumModels + 1];
+    output[kNumModels] = ozz::math::Float4x4::identity();
+
+    SkinningMatricesJob job;
+    job.models = models;
+    job.inverse_bind_poses = soa_inverse_bind_poses;
+    job.output = ozz::Range<ozz::math::Float4x4>(output, kNumModels);
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < kNumModels; ++i) {
+      ExpectMatrixEq(models[i] * inverse_bind_poses[i], output[i]);
+    }
+
+    // Doesn't write beyond output range.
+    EXPECT_FLOAT4x4_EQ(output[kNumModels],
+                       1.f, 0.f, 0.f, 0.f,
+                       0.f, 1.f, 0.f, 0.f,
+                       0.f, 0.f, 1.f, 0.f,
+                       0.f, 0.f, 0.f, 1.f);
+  }
+  { // Remapped subset of joints. Inverse bind poses are indexed like output.
+    const uint16_t joint_remaps[5] = {8, 2, 2, 5, 0};
+    ozz::math::Float4x4 output[5];
+
+    SkinningMatricesJob job;
+    job.models = models;
+    job.inverse_bind_poses = soa_inverse_bind_poses;
+    job.joint_remaps = joint_remaps;
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < 5; ++i) {
+      ExpectMatrixEq(models[joint_remaps[i]] * inverse_bind_poses[i],
+                     output[i]);
+    }
+  }
+}
@@ -173,11 +173,74 @@ TEST(File, Stream) {
   }
 }
 
+TEST(MappedFile, Stream) {
+  {
+    ozz::io::MappedFile file("unexisting.file");
+    EXPECT_FALSE(file.opened());
+  }
+  {  // Empty files cannot be mapped.
+    { ozz::io::File file("mapped.bin", "wb"); }
+    ozz::io::MappedFile file("mapped.bin");
+    EXPECT_FALSE(file.opened());
+  }
+  {
+    ozz::io::File file("mapped.bin", "wb");
+    ASSERT_TRUE(file.opened());
+    const int to_write[] = {46, 58, 93};
+    EXPECT_EQ(file.Write(to_write, sizeof(to_write)), sizeof(to_write));
+  }
+  {
+    ozz::io::MappedFile file("mapped.bin");
+    ASSERT_TRUE(file.opened());
+    EXPECT_EQ(file.Size(), 3 * sizeof(int));
+    EXPECT_EQ(file.Tell(), 0);
+
+    // Mapped file is read-only.
+    const int to_write = 0;
+    EXPECT_EQ(file.Write(&to_write, sizeof(int)), 0u);
+
+    int to_read = 0;
+    EXPECT_EQ(file.Read(&to_read, sizeof(int)), sizeof(int));
+    EXPECT_EQ(to_read, 46);
+
+    const int* mapped = static_cast<const int*>(file.Map(sizeof(int) * 2));
+    ASSERT_TRUE(mapped != NULL);
+    EXPECT_EQ(mapped[0], 58);
+    EXPECT_EQ(mapped[1], 93);
+    EXPECT_EQ(file.Tell(), static_cast<int>(3 * sizeof(int)));
+
+    // Can't map or seek beyond the end.
+    EXPECT_TRUE(file.Map(1) == NULL);
+    EXPECT_NE(file.Seek(1, ozz::io::Stream::kCurrent), 0);
+    EXPECT_EQ(file.Read(&to_read, sizeof(int)), 0u);
+
+    EXPECT_EQ(file.Seek(-4, ozz::io::Stream::kEnd), 0);
+    EXPECT_EQ(file.Map(sizeof(int)), mapped + 1);
+    EXPECT_NE(file.Seek(-1, ozz::io::Stream::kSet), 0);
+
+    file.Close();
+    EXPECT_FALSE(file.opened());
+  }
+}
+
 TEST(MemoryStream, Stream) {
     {
       ozz::io::MemoryStream stream;
       TestStream(&stream);
     }
+  {
+    ozz::io::MemoryStream stream;
+    EXPECT_TRUE(stream.Map(1) == NULL);
+    const int to_write[] = {46, 58};
+    EXPECT_EQ(stream.Write(to_write, sizeof(to_write)), sizeof(to_write));
+    EXPECT_EQ(stream.Seek(sizeof(int), ozz::io::Stream::kSet), 0);
+    const int* mapped = static_cast<const int*>(stream.Map(sizeof(int)));
+    ASSERT_TRUE(mapped != NULL);
+    EXPECT_EQ(*mapped, 58);
+    EXPECT_EQ(stream.Tell(), static_cast<int>(2 * sizeof(int)));
+    EXPECT_TRUE(stream.Map(1) == NULL);
+    EXPECT_EQ(stream.Tell(), static_cast<int>(2 * sizeof(int)));
+  }
   {
     ozz::io::MemoryStream stream;
     TestSeek(&stream);
@@ -0,0 +1,224 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/maths/soa_wide.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/gtest_helper.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+using ozz::math::SimdFloat4;
+using ozz::math::SimdFloat8;
+using ozz::math::SoaFloat3;
+using ozz::math::SoaQuaternion;
+using ozz::math::SoaTransform;
+using ozz::math::SoaFloat4x4;
+using ozz::math::WideSoaFloat3;
+using ozz::math::WideSoaQuaternion;
+using ozz::math::WideSoaTransform;
+using ozz::math::WideSoaFloat4x4;
+
+namespace {
+// Wide operations are expected to match 4 wide ones, up to the estimation
+// precision.
+void ExpectSimdFloatNear(SimdFloat4 _a, SimdFloat4 _b) {
+  float a[4];
+  float b[4];
+  ozz::math::StorePtrU(_a, a);
+  ozz::math::StorePtrU(_b, b);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NEAR(a[i], b[i], 1e-5f);
+  }
+}
+
+void ExpectSoaFloat3Near(const SoaFloat3& _a, const SoaFloat3& _b) {
+  ExpectSimdFloatNear(_a.x, _b.x);
+  ExpectSimdFloatNear(_a.y, _b.y);
+  ExpectSimdFloatNear(_a.z, _b.z);
+}
+
+void ExpectSoaQuaternionNear(const SoaQuaternion& _a,
+                             const SoaQuaternion& _b) {
+  ExpectSimdFloatNear(_a.x, _b.x);
+  ExpectSimdFloatNear(_a.y, _b.y);
+  ExpectSimdFloatNear(_a.z, _b.z);
+  ExpectSimdFloatNear(_a.w, _b.w);
+}
+
+void ExpectSoaFloat4x4Near(const SoaFloat4x4& _a, const SoaFloat4x4& _b) {
+  for (int i = 0; i < 4; ++i) {
+    ExpectSimdFloatNear(_a.cols[i].x, _b.cols[i].x);
+    ExpectSimdFloatNear(_a.cols[i].y, _b.cols[i].y);
+    ExpectSimdFloatNear(_a.cols[i].z, _b.cols[i].z);
+    ExpectSimdFloatNear(_a.cols[i].w, _b.cols[i].w);
+  }
+}
+
+const SoaTransform kTransforms[2] = {
+  {{ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 3.f),
+    ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 7.f),
+    ozz::math::simd_float4::Load(8.f, 9.f, 10.f, 11.f)},
+   {ozz::math::simd_float4::Load(.70710677f, 0.f, 0.f, .382683432f),
+    ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(.70710677f, 1.f, .70710677f, .9238795f)},
+   {ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 4.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, .5f, 1.f),
+    ozz::math::simd_float4::Load(1.f, -1.f, 1.f, 2.f)}},
+  {{ozz::math::simd_float4::Load(-12.f, -13.f, -14.f, -15.f),
+    ozz::math::simd_float4::Load(16.f, 17.f, 18.f, 19.f),
+    ozz::math::simd_float4::Load(-20.f, 21.f, -22.f, 23.f)},
+   {ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, -.382683432f),
+    ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(1.f, .70710677f, .70710677f, .9238795f)},
+   {ozz::math::simd_float4::Load(2.f, 2.f, 2.f, 2.f),
+    ozz::math::simd_float4::Load(3.f, .1f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 5.f, 1.f)}}};
+}  // namespace
+
+TEST(SimdFloat8, ozz_soa_math) {
+  const SimdFloat4 lo = ozz::math::simd_float4::Load(0.f, -1.f, 2.f, -3.f);
+  const SimdFloat4 hi = ozz::math::simd_float4::Load(4.f, -5.f, 6.f, -7.f);
+  const SimdFloat8 v = ozz::math::simd_float8::Load(lo, hi);
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetLow(v), 0.f, -1.f, 2.f, -3.f);
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetHigh(v), 4.f, -5.f, 6.f, -7.f);
+
+  const SimdFloat8 one = ozz::math::simd_float8::one();
+  const SimdFloat8 two = ozz::math::simd_float8::Load1(2.f);
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetHigh(ozz::math::simd_float8::zero()),
+                      0.f, 0.f, 0.f, 0.f);
+
+  const SimdFloat8 arithmetic = (v + one) * two - v / two;
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetLow(arithmetic), 2.f, .5f, 5.f, -2.5f);
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetHigh(arithmetic), 8.f, -5.5f, 11.f, -8.5f);
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetHigh(-v), -4.f, 5.f, -6.f, 7.f);
+
+  const SimdFloat8 madd = ozz::math::MAdd(v, two, one);
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetLow(madd), 1.f, -1.f, 5.f, -5.f);
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetHigh(madd), 9.f, -9.f, 13.f, -13.f);
+
+  const SimdFloat8 max0 = ozz::math::Max0(v);
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetLow(max0), 0.f, 0.f, 2.f, 0.f);
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetHigh(max0), 4.f, 0.f, 6.f, 0.f);
+
+  // Xor-ing with the sign of v computes the absolute value.
+  const SimdFloat8 abs = ozz::math::Xor(v, ozz::math::Sign(v));
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetLow(abs), 0.f, 1.f, 2.f, 3.f);
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetHigh(abs), 4.f, 5.f, 6.f, 7.f);
+
+  const SimdFloat8 rcp = ozz::math::RcpEst(madd);
+  EXPECT_SIMDFLOAT_EQ_EST(ozz::math::GetLow(rcp), 1.f, -1.f, .2f, -.2f);
+  EXPECT_SIMDFLOAT_EQ_EST(ozz::math::GetHigh(rcp),
+                          1.f / 9.f, -1.f / 9.f, 1.f / 13.f, -1.f / 13.f);
+
+  const SimdFloat8 rsqrt = ozz::math::RSqrtEstNR(max0 + one);
+  EXPECT_SIMDFLOAT_EQ_EST(ozz::math::GetLow(rsqrt),
+                          1.f, 1.f, .57735026f, 1.f);
+  EXPECT_SIMDFLOAT_EQ_EST(ozz::math::GetHigh(rsqrt),
+                          .44721359f, 1.f, .37796447f, 1.f);
+}
+
+TEST(WideSoaLoad, ozz_soa_math) {
+  const WideSoaTransform transform =
+    WideSoaTransform::Load(kTransforms[0], kTransforms[1]);
+  const SoaTransform lo = ozz::math::GetLow(transform);
+  const SoaTransform hi = ozz::math::GetHigh(transform);
+  EXPECT_SOAFLOAT3_EQ(lo.translation, 0.f, 1.f, 2.f, 3.f,
+                                      4.f, 5.f, 6.f, 7.f,
+                                      8.f, 9.f, 10.f, 11.f);
+  EXPECT_SOAFLOAT3_EQ(hi.translation, -12.f, -13.f, -14.f, -15.f,
+                                      16.f, 17.f, 18.f, 19.f,
+                                      -20.f, 21.f, -22.f, 23.f);
+  ExpectSoaQuaternionNear(lo.rotation, kTransforms[0].rotation);
+  ExpectSoaQuaternionNear(hi.rotation, kTransforms[1].rotation);
+  ExpectSoaFloat3Near(lo.scale, kTransforms[0].scale);
+  ExpectSoaFloat3Near(hi.scale, kTransforms[1].scale);
+}
+
+TEST(WideSoaInterpolation, ozz_soa_math) {
+  const WideSoaTransform a =
+    WideSoaTransform::Load(kTransforms[0], kTransforms[1]);
+  const WideSoaTransform b =
+    WideSoaTransform::Load(kTransforms[1], kTransforms[0]);
+  const SimdFloat4 alpha_lo =
+    ozz::math::simd_float4::Load(0.f, .1f, .5f, 1.f);
+  const SimdFloat4 alpha_hi =
+    ozz::math::simd_float4::Load(.3f, .7f, .9f, 0.f);
+  const SimdFloat8 alpha = ozz::math::simd_float8::Load(alpha_lo, alpha_hi);
+
+  const WideSoaFloat3 lerp = Lerp(a.translation, b.translation, alpha);
+  ExpectSoaFloat3Near(ozz::math::GetLow(lerp),
+                      Lerp(kTransforms[0].translation,
+                           kTransforms[1].translation,
+                           alpha_lo));
+  ExpectSoaFloat3Near(ozz::math::GetHigh(lerp),
+                      Lerp(kTransforms[1].translation,
+                           kTransforms[0].translation,
+                           alpha_hi));
+
+  const WideSoaQuaternion nlerp = NLerpEst(a.rotation, b.rotation, alpha);
+  ExpectSoaQuaternionNear(ozz::math::GetLow(nlerp),
+                          NLerpEst(kTransforms[0].rotation,
+                                   kTransforms[1].rotation,
+                                   alpha_lo));
+  ExpectSoaQuaternionNear(ozz::math::GetHigh(nlerp),
+                          NLerpEst(kTransforms[1].rotation,
+                                   kTransforms[0].rotation,
+                                   alpha_hi));
+
+  const WideSoaQuaternion sum = a.rotation + b.rotation * alpha;
+  ExpectSoaQuaternionNear(ozz::math::GetLow(NormalizeEst(sum)),
+                          NormalizeEst(kTransforms[0].rotation +
+                                       kTransforms[1].rotation * alpha_lo));
+  ExpectSoaQuaternionNear(ozz::math::GetHigh(NormalizeEst(sum)),
+                          NormalizeEst(kTransforms[1].rotation +
+                                       kTransforms[0].rotation * alpha_hi));
+
+  const WideSoaFloat3 scale = a.scale + b.scale * alpha;
+  ExpectSoaFloat3Near(ozz::math::GetHigh(scale),
+                      kTransforms[1].scale + kTransforms[0].scale * alpha_hi);
+}
+
+TEST(WideSoaFloat4x4FromAffine, ozz_soa_math) {
+  const WideSoaTransform transform =
+    WideSoaTransform::Load(kTransforms[0], kTransforms[1]);
+  const WideSoaFloat4x4 matrices =
+    WideSoaFloat4x4::FromAffine(transform.translation,
+                                transform.rotation,
+                                transform.scale);
+  for (int i = 0; i < 2; ++i) {
+    const SoaFloat4x4 expected =
+      SoaFloat4x4::FromAffine(kTransforms[i].translation,
+                              kTransforms[i].rotation,
+                              kTransforms[i].scale);
+    ExpectSoaFloat4x4Near(i == 0 ? ozz::math::GetLow(matrices) :
+                                   ozz::math::GetHigh(matrices),
+                          expected);
+  }
+}
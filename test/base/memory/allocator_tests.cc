@@ -31,6 +31,10 @@
 
 #include "ozz/base/maths/math_ex.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif  // _OPENMP
+
 TEST(Malloc, Memory) {
   void* p = ozz::memory::default_allocator()->Allocate(12, 1024);
   EXPECT_TRUE(p != NULL);
@@ -223,3 +227,36 @@ TEST(AllocatorOverride, Memory) {
 
   EXPECT_EQ(ozz::memory::SetDefaulAllocator(previous), current);
 }
+
+TEST(Concurrent, Memory) {
+  // Allocates and deallocates from concurrent threads, if OpenMP is available
+  // (test_memory is built with OpenMP flags when cmake finds it). The default
+  // allocator asserts at exit, in debug builds, if its allocation count was
+  // corrupted.
+  const int kCount = 100000;
+  int failures = 0;
+  int threads = 1;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(4) reduction(+:failures)
+#endif  // _OPENMP
+  for (int i = 0; i < kCount; ++i) {
+#ifdef _OPENMP
+    if (i == 0) {
+      threads = omp_get_num_threads();
+    }
+#endif  // _OPENMP
+    ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+    void* p = allocator->Allocate(16 + i % 64, 16);
+    failures += p == NULL;
+    p = allocator->Reallocate(p, 32 + i % 128, 16);
+    failures += p == NULL;
+    allocator->Deallocate(p);
+  }
+  EXPECT_EQ(failures, 0);
+#ifdef _OPENMP
+  // Allocations were actually concurrent.
+  EXPECT_GT(threads, 1);
+#else   // _OPENMP
+  EXPECT_EQ(threads, 1);
+#endif  // _OPENMP
+}
@@ -0,0 +1,390 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/dual_quaternion_skinning_job.h"
+#include "ozz/geometry/runtime/skinning_job.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+using ozz::geometry::DualQuaternion;
+using ozz::geometry::DualQuaternionPaletteJob;
+using ozz::geometry::DualQuaternionSkinningJob;
+
+TEST(JobValidity, DualQuaternionPaletteJob) {
+  ozz::math::Float4x4 models[2];
+  ozz::math::Float4x4 inverse_bind_poses[2];
+  DualQuaternion output[2];
+
+  { // Default is invalid.
+    DualQuaternionPaletteJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Valid.
+    DualQuaternionPaletteJob job;
+    job.models = models;
+    job.inverse_bind_poses = inverse_bind_poses;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+  }
+  { // Valid, empty.
+    DualQuaternionPaletteJob job;
+    job.models = ozz::Range<const ozz::math::Float4x4>(models, models);
+    job.inverse_bind_poses = inverse_bind_poses;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  { // Output too small.
+    DualQuaternionPaletteJob job;
+    job.models = models;
+    job.inverse_bind_poses = inverse_bind_poses;
+    job.output = ozz::Range<DualQuaternion>(output, 1);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Inverse bind poses too small.
+    DualQuaternionPaletteJob job;
+    job.models = models;
+    job.inverse_bind_poses =
+      ozz::Range<const ozz::math::Float4x4>(inverse_bind_poses, 1);
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+}
+
+TEST(JobValidity, DualQuaternionSkinningJob) {
+  DualQuaternion dqs[2];
+  uint16_t joint_indices[8];
+  float joint_weights[6];
+  float in_positions[6];
+  float in_normals[6];
+  float in_tangents[6];
+  float out_positions[6];
+  float out_normals[6];
+  float out_tangents[6];
+
+  { // Default is invalid.
+    DualQuaternionSkinningJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Valid job with 0 vertex.
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 0;
+    job.influences_count = 1;
+    job.joint_dual_quaternions = dqs;
+    job.joint_indices = joint_indices;
+    job.joint_indices_stride = sizeof(uint16_t) * 1;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  { // Invalid job with 0 influence.
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 0;
+    job.joint_dual_quaternions = dqs;
+    job.joint_indices = joint_indices;
+    job.joint_indices_stride = sizeof(uint16_t) * 1;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Invalid job without dual quaternions.
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 1;
+    job.joint_indices = joint_indices;
+    job.joint_indices_stride = sizeof(uint16_t) * 1;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Valid job with 2 influences, normals and tangents.
+    DualQuaternionSkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 2;
+    job.joint_dual_quaternions = dqs;
+    job.joint_indices = joint_indices;
+    job.joint_indices_stride = sizeof(uint16_t) * 2;
+    job.joint_weights = joint_weights;
+    job.joint_weights_stride = sizeof(float) * 1;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    job.in_normals = in_normals;
+    job.in_normals_stride = sizeof(float) * 3;
+    job.out_normals = out_normals;
+    job.out_normals_stride = sizeof(float) * 3;
+    job.in_tangents = in_tangents;
+    job.in_tangents_stride = sizeof(float) * 3;
+    job.out_tangents = out_tangents;
+    job.out_tangents_stride = sizeof(float) * 3;
+    EXPECT_TRUE(job.Validate());
+
+    // Missing weights.
+    DualQuaternionSkinningJob no_weights = job;
+    no_weights.joint_weights = ozz::Range<const float>();
+    EXPECT_FALSE(no_weights.Validate());
+
+    // Missing output tangents.
+    DualQuaternionSkinningJob no_out_tangents = job;
+    no_out_tangents.out_tangents = ozz::Range<float>();
+    EXPECT_FALSE(no_out_tangents.Validate());
+
+    // Tangents without normals.
+    DualQuaternionSkinningJob no_normals = job;
+    no_normals.in_normals = ozz::Range<const float>();
+    EXPECT_FALSE(no_normals.Validate());
+  }
+}
+
+TEST(JobResult, DualQuaternionPaletteJob) {
+  // Rigid model and inverse bind pose matrices.
+  const ozz::math::Float4x4 models[3] = {
+    ozz::math::Float4x4::identity(),
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)) *
+    ozz::math::Float4x4::FromAxisAngle(
+      ozz::math::simd_float4::Load(0.f, 1.f, 0.f, 2.f)),
+    ozz::math::Float4x4::FromAxisAngle(
+      ozz::math::simd_float4::Load(.6f, 0.f, .8f, -.7f))
+  };
+  const ozz::math::Float4x4 inverse_bind_poses[3] = {
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(-4.f, 0.f, 1.f, 0.f)),
+    ozz::math::Float4x4::FromAxisAngle(
+      ozz::math::simd_float4::Load(1.f, 0.f, 0.f, 1.f)),
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(3.f, -2.f, 1.f, 0.f)) *
+    ozz::math::Float4x4::FromAxisAngle(
+      ozz::math::simd_float4::Load(0.f, 0.f, 1.f, 3.f))
+  };
+  DualQuaternion palette[3];
+
+  DualQuaternionPaletteJob palette_job;
+  palette_job.models = models;
+  palette_job.inverse_bind_poses = inverse_bind_poses;
+  palette_job.output = palette;
+  ASSERT_TRUE(palette_job.Run());
+
+  // Skins a vertex per joint, which must match matrix transformation.
+  const uint16_t joint_indices[3] = {0, 1, 2};
+  const float in_positions[9] = {1.f, 2.f, 3.f, -4.f, 5.f, 6.f, 7.f, 8.f, 9.f};
+  const float in_normals[9] = {1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f};
+  float out_positions[9];
+  float out_normals[9];
+
+  DualQuaternionSkinningJob job;
+  job.vertex_count = 3;
+  job.influences_count = 1;
+  job.joint_dual_quaternions = palette;
+  job.joint_indices = joint_indices;
+  job.joint_indices_stride = sizeof(uint16_t);
+  job.in_positions = in_positions;
+  job.in_positions_stride = sizeof(float) * 3;
+  job.in_normals = in_normals;
+  job.in_normals_stride = sizeof(float) * 3;
+  job.out_positions = out_positions;
+  job.out_positions_stride = sizeof(float) * 3;
+  job.out_normals = out_normals;
+  job.out_normals_stride = sizeof(float) * 3;
+  ASSERT_TRUE(job.Run());
+
+  for (int i = 0; i < 3; ++i) {
+    const ozz::math::Float4x4 matrix = models[i] * inverse_bind_poses[i];
+    const ozz::math::SimdFloat4 p = ozz::math::TransformPoint(
+      matrix, ozz::math::simd_float4::Load3PtrU(in_positions + i * 3));
+    const ozz::math::SimdFloat4 n = ozz::math::TransformVector(
+      matrix, ozz::math::simd_float4::Load3PtrU(in_normals + i * 3));
+    EXPECT_SIMDFLOAT_EQ_EST(
+      ozz::math::simd_float4::Load3PtrU(out_positions + i * 3),
+      ozz::math::GetX(p), ozz::math::GetY(p), ozz::math::GetZ(p), 0.f);
+    EXPECT_SIMDFLOAT_EQ_EST(
+      ozz::math::simd_float4::Load3PtrU(out_normals + i * 3),
+      ozz::math::GetX(n), ozz::math::GetY(n), ozz::math::GetZ(n), 0.f);
+  }
+}
+
+TEST(JobResult, DualQuaternionSkinningJob) {
+  // Joints share the same rotation, in which case dual quaternion and linear
+  // blend skinning results are the same.
+  const ozz::math::Float4x4 rotation = ozz::math::Float4x4::FromAxisAngle(
+    ozz::math::simd_float4::Load(0.f, .6f, .8f, 1.f));
+  const ozz::math::Float4x4 matrices[4] = {
+    rotation,
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)) * rotation,
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(-3.f, 0.f, 2.f, 0.f)) * rotation,
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(0.f, -5.f, 1.f, 0.f)) * rotation
+  };
+  const ozz::math::Float4x4 identities[4] = {
+    ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity(),
+    ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity()
+  };
+  DualQuaternion palette[4];
+  DualQuaternionPaletteJob palette_job;
+  palette_job.models = matrices;
+  palette_job.inverse_bind_poses = identities;
+  palette_job.output = palette;
+  ASSERT_TRUE(palette_job.Run());
+
+  // 2 vertices with up to 5 influences.
+  const int kMaxInfluences = 5;
+  const uint16_t joint_indices[10] = {0, 1, 2, 3, 0, 3, 2, 1, 0, 3};
+  const float joint_weights[8] = {.5f, .2f, .125f, .1f,
+                                  .25f, .25f, .25f, .125f};
+  const float in_positions[6] = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+  const float in_normals[6] = {.1f, .2f, .3f, .4f, .5f, .6f};
+  const float in_tangents[6] = {.01f, .02f, .03f, .04f, .05f, .06f};
+
+  for (int inf = 1; inf <= kMaxInfluences; ++inf) {
+    for (int fct = 0; fct < 3; ++fct) {
+      float expected[18] = {0.f};
+      ozz::geometry::SkinningJob lbs_job;
+      lbs_job.vertex_count = 2;
+      lbs_job.influences_count = inf;
+      lbs_job.joint_matrices = matrices;
+      lbs_job.joint_indices = joint_indices;
+      lbs_job.joint_indices_stride = sizeof(uint16_t) * kMaxInfluences;
+      if (inf > 1) {
+        lbs_job.joint_weights = joint_weights;
+        lbs_job.joint_weights_stride = sizeof(float) * (kMaxInfluences - 1);
+      }
+      lbs_job.in_positions = in_positions;
+      lbs_job.in_positions_stride = sizeof(float) * 3;
+      lbs_job.out_positions = ozz::Range<float>(expected, 6);
+      lbs_job.out_positions_stride = sizeof(float) * 3;
+      if (fct > 0) {
+        lbs_job.in_normals = in_normals;
+        lbs_job.in_normals_stride = sizeof(float) * 3;
+        lbs_job.out_normals = ozz::Range<float>(expected + 6, 6);
+        lbs_job.out_normals_stride = sizeof(float) * 3;
+      }
+      if (fct > 1) {
+        lbs_job.in_tangents = in_tangents;
+        lbs_job.in_tangents_stride = sizeof(float) * 3;
+        lbs_job.out_tangents = ozz::Range<float>(expected + 12, 6);
+        lbs_job.out_tangents_stride = sizeof(float) * 3;
+      }
+      ASSERT_TRUE(lbs_job.Run());
+
+      float out[18] = {0.f};
+      DualQuaternionSkinningJob job;
+      job.vertex_count = lbs_job.vertex_count;
+      job.influences_count = lbs_job.influences_count;
+      job.joint_dual_quaternions = palette;
+      job.joint_indices = lbs_job.joint_indices;
+      job.joint_indices_stride = lbs_job.joint_indices_stride;
+      job.joint_weights = lbs_job.joint_weights;
+      job.joint_weights_stride = lbs_job.joint_weights_stride;
+      job.in_positions = lbs_job.in_positions;
+      job.in_positions_stride = lbs_job.in_positions_stride;
+      job.out_positions = ozz::Range<float>(out, 6);
+      job.out_positions_stride = lbs_job.out_positions_stride;
+      if (fct > 0) {
+        job.in_normals = lbs_job.in_normals;
+        job.in_normals_stride = lbs_job.in_normals_stride;
+        job.out_normals = ozz::Range<float>(out + 6, 6);
+        job.out_normals_stride = lbs_job.out_normals_stride;
+      }
+      if (fct > 1) {
+        job.in_tangents = lbs_job.in_tangents;
+        job.in_tangents_stride = lbs_job.in_tangents_stride;
+        job.out_tangents = ozz::Range<float>(out + 12, 6);
+        job.out_tangents_stride = lbs_job.out_tangents_stride;
+      }
+      ASSERT_TRUE(job.Run());
+
+      for (int i = 0; i < 18; ++i) {
+        EXPECT_NEAR(expected[i], out[i], 1e-4f);
+      }
+    }
+  }
+}
+
+TEST(CandyWrapper, DualQuaternionSkinningJob) {
+  // Second joint is twisted by 180 degrees around x axis. Linear blend
+  // skinning collapses vertices halfway, whereas dual quaternion skinning
+  // rotates them by 90 degrees.
+  const ozz::math::Float4x4 matrices[2] = {
+    ozz::math::Float4x4::identity(),
+    ozz::math::Float4x4::FromAxisAngle(
+      ozz::math::simd_float4::Load(1.f, 0.f, 0.f, ozz::math::kPi))
+  };
+  const ozz::math::Float4x4 identities[2] = {
+    ozz::math::Float4x4::identity(),
+    ozz::math::Float4x4::identity()
+  };
+  DualQuaternion palette[2];
+  DualQuaternionPaletteJob palette_job;
+  palette_job.models = matrices;
+  palette_job.inverse_bind_poses = identities;
+  palette_job.output = palette;
+  ASSERT_TRUE(palette_job.Run());
+
+  const uint16_t joint_indices[2] = {0, 1};
+  const float joint_weights[1] = {.5f};
+  const float in_positions[3] = {2.f, 1.f, 0.f};
+  float out_positions[3];
+
+  DualQuaternionSkinningJob job;
+  job.vertex_count = 1;
+  job.influences_count = 2;
+  job.joint_dual_quaternions = palette;
+  job.joint_indices = joint_indices;
+  job.joint_indices_stride = sizeof(uint16_t) * 2;
+  job.joint_weights = joint_weights;
+  job.joint_weights_stride = sizeof(float);
+  job.in_positions = in_positions;
+  job.in_positions_stride = sizeof(float) * 3;
+  job.out_positions = out_positions;
+  job.out_positions_stride = sizeof(float) * 3;
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_NEAR(2.f, out_positions[0], 1e-5f);
+  EXPECT_NEAR(0.f, out_positions[1], 1e-5f);
+  EXPECT_NEAR(1.f, std::abs(out_positions[2]), 1e-5f);
+}
@@ -0,0 +1,450 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/parallel_skinning_job.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/log.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/allocator.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif  // _OPENMP
+
+using ozz::geometry::ParallelSkinningJob;
+using ozz::geometry::SkinningJob;
+using ozz::TaskScheduler;
+
+namespace {
+// Runs tasks sequentially, in reverse order, counting them.
+class ReverseScheduler : public TaskScheduler {
+ public:
+  ReverseScheduler()
+    : count_(0) {
+  }
+  virtual void Run(TaskFct _fct, void* _user_data, int _count) {
+    for (int i = _count - 1; i >= 0; --i) {
+      _fct(_user_data, i);
+    }
+    count_ += _count;
+  }
+  int count() const {
+    return count_;
+  }
+ private:
+  int count_;
+};
+
+struct Vertex {
+  float pos[3];
+  float normal[3];
+  float tangent[3];
+  uint16_t indices[4];
+  float weights[3];
+};
+
+// Setups job to skin _vertices to _out, with _influences.
+void SetupJob(SkinningJob* _job,
+              ozz::Range<const ozz::math::Float4x4> _matrices,
+              ozz::Range<const Vertex> _vertices,
+              ozz::Range<Vertex> _out,
+              int _influences,
+              bool _normals,
+              bool _tangents) {
+  _job->vertex_count = static_cast<int>(_vertices.Count());
+  _job->influences_count = _influences;
+  _job->joint_matrices = _matrices;
+  _job->joint_indices.begin = _vertices.begin->indices;
+  _job->joint_indices.end = reinterpret_cast<const uint16_t*>(_vertices.end);
+  _job->joint_indices_stride = sizeof(Vertex);
+  _job->joint_weights.begin = _vertices.begin->weights;
+  _job->joint_weights.end = reinterpret_cast<const float*>(_vertices.end);
+  _job->joint_weights_stride = sizeof(Vertex);
+  _job->in_positions.begin = _vertices.begin->pos;
+  _job->in_positions.end = reinterpret_cast<const float*>(_vertices.end);
+  _job->in_positions_stride = sizeof(Vertex);
+  _job->out_positions.begin = _out.begin->pos;
+  _job->out_positions.end = reinterpret_cast<const float*>(_out.end);
+  _job->out_positions_stride = sizeof(Vertex);
+  if (_normals) {
+    _job->in_normals.begin = _vertices.begin->normal;
+    _job->in_normals.end = reinterpret_cast<const float*>(_vertices.end);
+    _job->in_normals_stride = sizeof(Vertex);
+    _job->out_normals.begin = _out.begin->normal;
+    _job->out_normals.end = reinterpret_cast<const float*>(_out.end);
+    _job->out_normals_stride = sizeof(Vertex);
+  }
+  if (_tangents) {
+    _job->in_tangents.begin = _vertices.begin->tangent;
+    _job->in_tangents.end = reinterpret_cast<const float*>(_vertices.end);
+    _job->in_tangents_stride = sizeof(Vertex);
+    _job->out_tangents.begin = _out.begin->tangent;
+    _job->out_tangents.end = reinterpret_cast<const float*>(_out.end);
+    _job->out_tangents_stride = sizeof(Vertex);
+  }
+}
+
+// Fills _vertices with pseudo random data.
+void FillVertices(ozz::Range<Vertex> _vertices, int _joints) {
+  for (size_t i = 0; i < _vertices.Count(); ++i) {
+    Vertex& vertex = _vertices[i];
+    for (int j = 0; j < 3; ++j) {
+      vertex.pos[j] = (i * 3 + j) * .01f - 5.f;
+      vertex.normal[j] = j == static_cast<int>(i % 3) ? 1.f : .3f;
+      vertex.tangent[j] = j == static_cast<int>((i + 1) % 3) ? -1.f : .2f;
+      vertex.weights[j] = .1f + .05f * ((i + j) % 4);
+    }
+    for (int j = 0; j < 4; ++j) {
+      vertex.indices[j] = static_cast<uint16_t>((i * 7 + j * 3) % _joints);
+    }
+  }
+}
+}  // namespace
+
+TEST(JobValidity, ParallelSkinningJob) {
+  ozz::math::Float4x4 matrices[2] = {ozz::math::Float4x4::identity(),
+                                     ozz::math::Float4x4::identity()};
+  Vertex vertices[8];
+  Vertex out[8];
+  FillVertices(ozz::Range<Vertex>(vertices), 2);
+
+  { // Default is invalid.
+    ParallelSkinningJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+    EXPECT_EQ(job.range_size(), 0);
+  }
+  { // Invalid skinning job.
+    ParallelSkinningJob job;
+    SetupJob(&job.job, ozz::Range<const ozz::math::Float4x4>(matrices),
+             ozz::Range<const Vertex>(vertices), ozz::Range<Vertex>(out),
+             2, true, true);
+    job.job.out_positions.Clear();
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Invalid grain.
+    ParallelSkinningJob job;
+    SetupJob(&job.job, ozz::Range<const ozz::math::Float4x4>(matrices),
+             ozz::Range<const Vertex>(vertices), ozz::Range<Vertex>(out),
+             2, true, true);
+    job.grain = 0;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Valid.
+    ParallelSkinningJob job;
+    SetupJob(&job.job, ozz::Range<const ozz::math::Float4x4>(matrices),
+             ozz::Range<const Vertex>(vertices), ozz::Range<Vertex>(out),
+             2, true, true);
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  { // Valid without vertex.
+    ParallelSkinningJob job;
+    SetupJob(&job.job, ozz::Range<const ozz::math::Float4x4>(matrices),
+             ozz::Range<const Vertex>(vertices), ozz::Range<Vertex>(out),
+             2, true, true);
+    job.job.vertex_count = 0;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(RangeSize, ParallelSkinningJob) {
+  ozz::math::Float4x4 matrices[1] = {ozz::math::Float4x4::identity()};
+  float in[48 * 3];
+  float out_positions[48 * 4];
+  float out_normals[48 * 4];
+  uint16_t indices[48];
+  for (int i = 0; i < 48; ++i) {
+    indices[i] = 0;
+  }
+
+  ParallelSkinningJob job;
+  job.job.vertex_count = 48;
+  job.job.influences_count = 1;
+  job.job.joint_matrices = matrices;
+  job.job.joint_indices = indices;
+  job.job.joint_indices_stride = sizeof(uint16_t);
+  job.job.in_positions = in;
+  job.job.in_positions_stride = sizeof(float) * 3;
+  job.job.out_positions = out_positions;
+  job.job.out_positions_stride = sizeof(float) * 3;
+
+  // 16 vertices of 12 bytes are 3 cache lines.
+  job.grain = 1;
+  EXPECT_EQ(job.range_size(), 16);
+  job.grain = 16;
+  EXPECT_EQ(job.range_size(), 16);
+  job.grain = 17;
+  EXPECT_EQ(job.range_size(), 32);
+
+  // Normals output of 16 bytes stride requires 4 vertices only.
+  job.job.in_normals = in;
+  job.job.in_normals_stride = sizeof(float) * 3;
+  job.job.out_normals = out_normals;
+  job.job.out_normals_stride = sizeof(float) * 4;
+  job.grain = 1;
+  EXPECT_EQ(job.range_size(), 16);
+  job.job.out_positions_stride = sizeof(float) * 4;
+  job.job.out_positions.end = out_positions + 47 * 4 + 3;
+  EXPECT_EQ(job.range_size(), 4);
+  job.grain = 5;
+  EXPECT_EQ(job.range_size(), 8);
+}
+
+TEST(JobResult, ParallelSkinningJob) {
+  const int vertex_count = 1001;
+  const int joint_count = 5;
+
+  ozz::math::Float4x4 matrices[joint_count];
+  ozz::math::Float4x4 it_matrices[joint_count];
+  for (int i = 0; i < joint_count; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] = ozz::math::Float4x4::FromAffine(
+      ozz::math::simd_float4::Load(f, -2.f * f, 3.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, .38268343f, 0.f, .92387953f),
+      ozz::math::simd_float4::Load(1.f + f, 2.f, 1.f + f * .5f, 0.f));
+    it_matrices[i] = Transpose(Invert(matrices[i]));
+  }
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  ozz::Range<Vertex> vertices = allocator->AllocateRange<Vertex>(vertex_count);
+  ozz::Range<Vertex> expected = allocator->AllocateRange<Vertex>(vertex_count);
+  ozz::Range<Vertex> out = allocator->AllocateRange<Vertex>(vertex_count);
+  FillVertices(vertices, joint_count);
+
+  for (int influences = 1; influences <= 4; ++influences) {
+    for (int variant = 0; variant < 4; ++variant) {
+      const bool normals = variant != 0;
+      const bool tangents = variant >= 2;
+      const bool it = variant == 3;
+
+      memset(expected.begin, 0, expected.Size());
+      memset(out.begin, 0, out.Size());
+
+      SkinningJob reference;
+      SetupJob(&reference, ozz::Range<const ozz::math::Float4x4>(matrices),
+               vertices, expected, influences, normals, tangents);
+      if (it) {
+        reference.joint_inverse_transpose_matrices = it_matrices;
+      }
+      ASSERT_TRUE(reference.Run());
+
+      ReverseScheduler scheduler;
+      ParallelSkinningJob job;
+      job.job = reference;
+      SetupJob(&job.job, ozz::Range<const ozz::math::Float4x4>(matrices),
+               vertices, out, influences, normals, tangents);
+      job.grain = 100;
+      job.scheduler = &scheduler;
+      ASSERT_TRUE(job.Run());
+
+      // Vertex is 56 bytes, so 8 vertices are 7 cache lines.
+      EXPECT_EQ(job.range_size(), 104);
+      EXPECT_EQ(scheduler.count(), 10);
+
+      // Results are bit for bit identical.
+      EXPECT_EQ(memcmp(expected.begin, out.begin, out.Size()), 0);
+
+      // Runs without scheduler.
+      memset(out.begin, 0, out.Size());
+      job.scheduler = NULL;
+      ASSERT_TRUE(job.Run());
+      EXPECT_EQ(memcmp(expected.begin, out.begin, out.Size()), 0);
+    }
+  }
+
+  allocator->Deallocate(vertices);
+  allocator->Deallocate(expected);
+  allocator->Deallocate(out);
+}
+
+namespace {
+// Compact joint indices and weights of a vertex.
+struct CompactInfluences {
+  uint8_t indices8[4];
+  uint16_t weights16[3];
+  uint8_t weights8[3];
+};
+}  // namespace
+
+TEST(JobResultCompact, ParallelSkinningJob) {
+  const int vertex_count = 1001;
+  const int joint_count = 5;
+
+  ozz::math::Float4x4 matrices[joint_count];
+  for (int i = 0; i < joint_count; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] = ozz::math::Float4x4::FromAffine(
+      ozz::math::simd_float4::Load(f, -2.f * f, 3.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, .38268343f, 0.f, .92387953f),
+      ozz::math::simd_float4::Load(1.f + f, 2.f, 1.f + f * .5f, 0.f));
+  }
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  ozz::Range<Vertex> vertices = allocator->AllocateRange<Vertex>(vertex_count);
+  ozz::Range<CompactInfluences> compacts =
+    allocator->AllocateRange<CompactInfluences>(vertex_count);
+  ozz::Range<Vertex> expected = allocator->AllocateRange<Vertex>(vertex_count);
+  ozz::Range<Vertex> out = allocator->AllocateRange<Vertex>(vertex_count);
+  FillVertices(vertices, joint_count);
+  for (int i = 0; i < vertex_count; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      compacts[i].indices8[j] = static_cast<uint8_t>(vertices[i].indices[j]);
+    }
+    for (int j = 0; j < 3; ++j) {
+      compacts[i].weights16[j] =
+        static_cast<uint16_t>(vertices[i].weights[j] * 65535.f);
+      compacts[i].weights8[j] =
+        static_cast<uint8_t>(vertices[i].weights[j] * 255.f);
+    }
+  }
+
+  for (int influences = 1; influences <= 4; ++influences) {
+    // Formats: 8 bits indices with float weights, 16 bits indices with 16
+    // bits weights, and 8 bits indices with 8 bits weights.
+    for (int format = 0; format < 3; ++format) {
+      memset(expected.begin, 0, expected.Size());
+      memset(out.begin, 0, out.Size());
+
+      SkinningJob reference;
+      SetupJob(&reference, ozz::Range<const ozz::math::Float4x4>(matrices),
+               vertices, expected, influences, true, true);
+      if (format != 1) {
+        reference.joint_indices.Clear();
+        reference.joint_indices8.begin = compacts.begin->indices8;
+        reference.joint_indices8.end =
+          reinterpret_cast<const uint8_t*>(compacts.end);
+        reference.joint_indices_stride = sizeof(CompactInfluences);
+      }
+      if (format != 0) {
+        reference.joint_weights.Clear();
+        if (format == 1) {
+          reference.joint_weights16.begin = compacts.begin->weights16;
+          reference.joint_weights16.end =
+            reinterpret_cast<const uint16_t*>(compacts.end);
+        } else {
+          reference.joint_weights8.begin = compacts.begin->weights8;
+          reference.joint_weights8.end =
+            reinterpret_cast<const uint8_t*>(compacts.end);
+        }
+        reference.joint_weights_stride = sizeof(CompactInfluences);
+      }
+
+      ParallelSkinningJob job;
+      job.job = reference;
+      job.job.out_positions.begin = out.begin->pos;
+      job.job.out_positions.end = reinterpret_cast<const float*>(out.end);
+      job.job.out_normals.begin = out.begin->normal;
+      job.job.out_normals.end = reinterpret_cast<const float*>(out.end);
+      job.job.out_tangents.begin = out.begin->tangent;
+      job.job.out_tangents.end = reinterpret_cast<const float*>(out.end);
+
+      ASSERT_TRUE(reference.Run());
+
+      ReverseScheduler scheduler;
+      job.grain = 100;
+      job.scheduler = &scheduler;
+      ASSERT_TRUE(job.Run());
+      EXPECT_GT(scheduler.count(), 1);
+
+      // Results are bit for bit identical.
+      EXPECT_EQ(memcmp(expected.begin, out.begin, out.Size()), 0);
+    }
+  }
+
+  allocator->Deallocate(vertices);
+  allocator->Deallocate(compacts);
+  allocator->Deallocate(expected);
+  allocator->Deallocate(out);
+}
+
+#ifdef _OPENMP
+namespace {
+// Runs tasks with OpenMP, using num_threads threads.
+class OpenMPScheduler : public TaskScheduler {
+ public:
+  explicit OpenMPScheduler(int _num_threads)
+    : num_threads_(_num_threads) {
+  }
+  virtual void Run(TaskFct _fct, void* _user_data, int _count) {
+    #pragma omp parallel for num_threads(num_threads_) schedule(dynamic)
+    for (int i = 0; i < _count; ++i) {
+      _fct(_user_data, i);
+    }
+  }
+ private:
+  int num_threads_;
+};
+}  // namespace
+
+TEST(Benchmark, ParallelSkinningJob) {
+  const int vertex_count = 200000;
+  const int joint_count = 100;
+  const int loops = 20;
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  ozz::Range<ozz::math::Float4x4> matrices =
+    allocator->AllocateRange<ozz::math::Float4x4>(joint_count);
+  for (int i = 0; i < joint_count; ++i) {
+    matrices[i] = ozz::math::Float4x4::identity();
+  }
+  ozz::Range<Vertex> vertices = allocator->AllocateRange<Vertex>(vertex_count);
+  ozz::Range<Vertex> out = allocator->AllocateRange<Vertex>(vertex_count);
+  FillVertices(vertices, joint_count);
+
+  ParallelSkinningJob job;
+  SetupJob(&job.job, matrices, vertices, out, 4, true, true);
+
+  // Reports scaling from 1 to the number of processors.
+  double reference = 0.;
+  for (int threads = 1; threads <= omp_get_num_procs(); ++threads) {
+    OpenMPScheduler scheduler(threads);
+    job.scheduler = &scheduler;
+    const double begin = omp_get_wtime();
+    for (int i = 0; i < loops; ++i) {
+      EXPECT_TRUE(job.Run());
+    }
+    const double time = (omp_get_wtime() - begin) / loops;
+    if (threads == 1) {
+      reference = time;
+    }
+    ozz::log::Log() << "ParallelSkinningJob, " << threads << " threads: " <<
+      time * 1000. << "ms, speedup x" << reference / time << std::endl;
+  }
+
+  allocator->Deallocate(matrices);
+  allocator->Deallocate(vertices);
+  allocator->Deallocate(out);
+}
+#endif  // _OPENMP
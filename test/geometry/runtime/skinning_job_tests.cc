@@ -443,6 +443,62 @@ TEST(JobValidity, SkinningJob) {
     job.out_positions_stride = sizeof(float) * 3;
     EXPECT_FALSE(job.Validate());
   }
+  { // Valid job with 2 influences, compact indices and weights.
+    uint8_t joint_indices8[4];
+    uint8_t joint_weights8[2];
+    SkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 2;
+    job.joint_matrices = matrices;
+    job.joint_indices8 = joint_indices8;
+    job.joint_indices_stride = sizeof(uint8_t) * 2;
+    job.joint_weights8 = joint_weights8;
+    job.joint_weights_stride = sizeof(uint8_t) * 1;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_TRUE(job.Validate());
+
+    // Indices buffer too small.
+    job.joint_indices8.end = joint_indices8 + 3;
+    EXPECT_FALSE(job.Validate());
+    job.joint_indices8 = joint_indices8;
+
+    // Both indices formats provided.
+    job.joint_indices.begin = joint_indices;
+    job.joint_indices.end = joint_indices + 4;
+    EXPECT_FALSE(job.Validate());
+    job.joint_indices = ozz::Range<const uint16_t>();
+    EXPECT_TRUE(job.Validate());
+
+    // Multiple weights formats provided.
+    job.joint_weights.begin = joint_weights;
+    job.joint_weights.end = joint_weights + 2;
+    EXPECT_FALSE(job.Validate());
+    job.joint_weights = ozz::Range<const float>();
+    EXPECT_TRUE(job.Validate());
+  }
+  { // Valid job with 3 influences, 16 bits weights.
+    uint16_t joint_weights16[4];
+    SkinningJob job;
+    job.vertex_count = 2;
+    job.influences_count = 3;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.joint_indices_stride = sizeof(uint16_t) * 3;
+    job.joint_weights16 = joint_weights16;
+    job.joint_weights_stride = sizeof(uint16_t) * 2;
+    job.in_positions = in_positions;
+    job.in_positions_stride = sizeof(float) * 3;
+    job.out_positions = out_positions;
+    job.out_positions_stride = sizeof(float) * 3;
+    EXPECT_TRUE(job.Validate());
+
+    // Weights buffer too small.
+    job.joint_weights16.end = joint_weights16 + 3;
+    EXPECT_FALSE(job.Validate());
+  }
 }
 
 TEST(JobResult, SkinningJob) {
@@ -1115,6 +1171,113 @@ TEST(JobResult, SkinningJob) {
   }
 }
 
+TEST(JobResultCompressed, SkinningJob) {
+  ozz::math::Float4x4 matrices[4] = {
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(-1.f, 3.f, 2.f, 0.f)),
+    ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)),
+    ozz::math::Float4x4::Scaling(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)),
+    ozz::math::Float4x4::FromAxisAngle(
+      ozz::math::simd_float4::Load(0.f, 1.f, 0.f, 1.f))
+  };
+  ozz::math::Float4x4 it_matrices[4];
+  for (int i = 0; i < 4; ++i) {
+    it_matrices[i] =
+      ozz::math::Transpose(ozz::math::Invert(matrices[i]));
+  }
+
+  // 2 vertices with up to 5 influences.
+  const int kMaxInfluences = 5;
+  const uint16_t joint_indices[10] = {0, 1, 2, 3, 0, 3, 2, 1, 0, 3};
+  const float joint_weights[8] = {.5f, .2f, .125f, .1f,
+                                  .25f, .25f, .25f, .125f};
+  float in_positions[6] = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+  float in_normals[6] = {.1f, .2f, .3f, .4f, .5f, .6f};
+  float in_tangents[6] = {.01f, .02f, .03f, .04f, .05f, .06f};
+
+  // Builds compressed formats.
+  uint8_t joint_indices8[10];
+  for (int i = 0; i < 10; ++i) {
+    joint_indices8[i] = static_cast<uint8_t>(joint_indices[i]);
+  }
+  uint16_t joint_weights16[8];
+  uint8_t joint_weights8[8];
+  for (int i = 0; i < 8; ++i) {
+    joint_weights16[i] =
+      static_cast<uint16_t>(joint_weights[i] * 65535.f + .5f);
+    joint_weights8[i] = static_cast<uint8_t>(joint_weights[i] * 255.f + .5f);
+  }
+
+  for (int inf = 1; inf <= kMaxInfluences; ++inf) {
+    for (int it = 0; it < 2; ++it) {
+      SkinningJob base_job;
+      base_job.vertex_count = 2;
+      base_job.influences_count = inf;
+      base_job.joint_matrices = matrices;
+      if (it) {
+        base_job.joint_inverse_transpose_matrices = it_matrices;
+      }
+      base_job.joint_indices = joint_indices;
+      base_job.joint_indices_stride = sizeof(uint16_t) * kMaxInfluences;
+      if (inf > 1) {
+        base_job.joint_weights = joint_weights;
+        base_job.joint_weights_stride = sizeof(float) * (kMaxInfluences - 1);
+      }
+      base_job.in_positions = in_positions;
+      base_job.in_positions_stride = sizeof(float) * 3;
+      base_job.in_normals = in_normals;
+      base_job.in_normals_stride = sizeof(float) * 3;
+      base_job.in_tangents = in_tangents;
+      base_job.in_tangents_stride = sizeof(float) * 3;
+
+      // Computes reference result.
+      float expected[18];
+      base_job.out_positions = ozz::Range<float>(expected, expected + 6);
+      base_job.out_positions_stride = sizeof(float) * 3;
+      base_job.out_normals = ozz::Range<float>(expected + 6, expected + 12);
+      base_job.out_normals_stride = sizeof(float) * 3;
+      base_job.out_tangents = ozz::Range<float>(expected + 12, expected + 18);
+      base_job.out_tangents_stride = sizeof(float) * 3;
+      ASSERT_TRUE(base_job.Run());
+
+      // Tests all indices and weights formats combinations.
+      for (int indices = 0; indices < 2; ++indices) {
+        for (int weights = 0; weights < 3; ++weights) {
+          float out[18];
+          SkinningJob job = base_job;
+          job.out_positions = ozz::Range<float>(out, out + 6);
+          job.out_normals = ozz::Range<float>(out + 6, out + 12);
+          job.out_tangents = ozz::Range<float>(out + 12, out + 18);
+          if (indices == 1) {
+            job.joint_indices = ozz::Range<const uint16_t>();
+            job.joint_indices8 = joint_indices8;
+            job.joint_indices_stride = sizeof(uint8_t) * kMaxInfluences;
+          }
+          float tolerance = 0.f;
+          if (inf > 1 && weights == 1) {
+            job.joint_weights = ozz::Range<const float>();
+            job.joint_weights16 = joint_weights16;
+            job.joint_weights_stride =
+              sizeof(uint16_t) * (kMaxInfluences - 1);
+            tolerance = 1e-3f;
+          } else if (inf > 1 && weights == 2) {
+            job.joint_weights = ozz::Range<const float>();
+            job.joint_weights8 = joint_weights8;
+            job.joint_weights_stride = sizeof(uint8_t) * (kMaxInfluences - 1);
+            tolerance = 5e-2f;
+          }
+          ASSERT_TRUE(job.Run());
+          for (int i = 0; i < 18; ++i) {
+            EXPECT_NEAR(expected[i], out[i], tolerance);
+          }
+        }
+      }
+    }
+  }
+}
+
 struct BenchVertexIn {
   float pos[3];
   float normals[3];
@@ -0,0 +1,412 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) 2015 Guillaume Blanc                                         //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/soa_skinning_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/geometry/runtime/skinning_job.h"
+
+using ozz::geometry::SoaSkinningJob;
+using ozz::geometry::SkinningJob;
+
+TEST(JobValidity, SoaSkinningJob) {
+  ozz::math::Float4x4 matrices[2];
+  uint16_t joint_indices[16];
+  OZZ_ALIGN(16) float joint_weights[8];
+  ozz::math::SoaFloat3 in_positions[2];
+  ozz::math::SoaFloat3 in_normals[2];
+  ozz::math::SoaFloat3 in_tangents[2];
+  ozz::math::SoaFloat3 out_positions[2];
+  ozz::math::SoaFloat3 out_normals[2];
+  ozz::math::SoaFloat3 out_tangents[2];
+
+  { // Default is invalid.
+    SoaSkinningJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  { // Valid job with 0 vertex.
+    SoaSkinningJob job;
+    job.vertex_count = 0;
+    job.influences_count = 1;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.in_positions = in_positions;
+    job.out_positions = out_positions;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  { // Invalid job with negative vertex count.
+    SoaSkinningJob job;
+    job.vertex_count = -1;
+    job.influences_count = 1;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.in_positions = in_positions;
+    job.out_positions = out_positions;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Valid job with 8 vertices, 2 packets.
+    SoaSkinningJob job;
+    job.vertex_count = 8;
+    job.influences_count = 2;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.joint_weights = joint_weights;
+    job.in_positions = in_positions;
+    job.out_positions = out_positions;
+    EXPECT_TRUE(job.Validate());
+  }
+  { // Invalid job with 9 vertices, 3 packets.
+    SoaSkinningJob job;
+    job.vertex_count = 9;
+    job.influences_count = 1;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.in_positions = in_positions;
+    job.out_positions = out_positions;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Invalid job with 3 influences, not enough indices.
+    SoaSkinningJob job;
+    job.vertex_count = 8;
+    job.influences_count = 3;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.joint_weights = joint_weights;
+    job.in_positions = in_positions;
+    job.out_positions = out_positions;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Invalid job with 2 influences, unaligned weights.
+    SoaSkinningJob job;
+    job.vertex_count = 4;
+    job.influences_count = 2;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.joint_weights = ozz::Range<const float>(joint_weights + 1, 4);
+    job.in_positions = in_positions;
+    job.out_positions = out_positions;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Invalid job with 2 influences, missing weights.
+    SoaSkinningJob job;
+    job.vertex_count = 8;
+    job.influences_count = 2;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.in_positions = in_positions;
+    job.out_positions = out_positions;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Invalid job, missing positions output.
+    SoaSkinningJob job;
+    job.vertex_count = 8;
+    job.influences_count = 1;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.in_positions = in_positions;
+    EXPECT_FALSE(job.Validate());
+  }
+  { // Invalid job, missing normals output.
+    SoaSkinningJob job;
+    job.vertex_count = 8;
+    job.influences_count = 1;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.in_positions = in_positions;
+    job.out_positions = out_positions;
+    job.in_normals = in_normals;
+    EXPECT_FALSE(job.Validate());
+    job.out_normals = out_normals;
+    EXPECT_TRUE(job.Validate());
+  }
+  { // Invalid job, tangents without normals.
+    SoaSkinningJob job;
+    job.vertex_count = 8;
+    job.influences_count = 1;
+    job.joint_matrices = matrices;
+    job.joint_indices = joint_indices;
+    job.in_positions = in_positions;
+    job.out_positions = out_positions;
+    job.in_tangents = in_tangents;
+    job.out_tangents = out_tangents;
+    EXPECT_FALSE(job.Validate());
+    job.in_normals = in_normals;
+    job.out_normals = out_normals;
+    EXPECT_TRUE(job.Validate());
+  }
+}
+
+TEST(Pack, SoaSkinningJob) {
+  const float vertices[] = {0.f, 1.f, 2.f, 99.f,
+                            3.f, 4.f, 5.f, 99.f,
+                            6.f, 7.f, 8.f, 99.f,
+                            9.f, 10.f, 11.f, 99.f,
+                            12.f, 13.f, 14.f};
+  const size_t stride = sizeof(float) * 4;
+  const ozz::Range<const float> in(vertices);
+  ozz::math::SoaFloat3 soa[2];
+  const ozz::Range<ozz::math::SoaFloat3> packets(soa);
+
+  // Invalid ranges.
+  EXPECT_FALSE(ozz::geometry::PackSoaVertices(
+    in, stride, 5, ozz::Range<ozz::math::SoaFloat3>(soa, 1)));
+  EXPECT_FALSE(ozz::geometry::PackSoaVertices(
+    ozz::Range<const float>(vertices, 15), stride, 5, packets));
+  EXPECT_FALSE(ozz::geometry::PackSoaVertices(in, stride, -1, packets));
+  EXPECT_TRUE(ozz::geometry::PackSoaVertices(
+    ozz::Range<const float>(), stride, 0, packets));
+
+  // Last packet is padded with the last vertex.
+  EXPECT_TRUE(ozz::geometry::PackSoaVertices(in, stride, 5, packets));
+  EXPECT_SOAFLOAT3_EQ(packets[0], 0.f, 3.f, 6.f, 9.f,
+                                  1.f, 4.f, 7.f, 10.f,
+                                  2.f, 5.f, 8.f, 11.f);
+  EXPECT_SOAFLOAT3_EQ(packets[1], 12.f, 12.f, 12.f, 12.f,
+                                  13.f, 13.f, 13.f, 13.f,
+                                  14.f, 14.f, 14.f, 14.f);
+
+  // Unpacks to a tightly packed buffer.
+  float unpacked[16];
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(unpacked); ++i) {
+    unpacked[i] = -1.f;
+  }
+  EXPECT_FALSE(ozz::geometry::UnpackSoaVertices(
+    packets, 5, ozz::Range<float>(unpacked, 14), sizeof(float) * 3));
+  EXPECT_TRUE(ozz::geometry::UnpackSoaVertices(
+    packets, 5, ozz::Range<float>(unpacked), sizeof(float) * 3));
+  for (int i = 0; i < 15; ++i) {
+    EXPECT_FLOAT_EQ(unpacked[i], static_cast<float>(i));
+  }
+  EXPECT_FLOAT_EQ(unpacked[15], -1.f);
+
+  // Packs 5 vertices with 3 influences.
+  const uint16_t indices[] = {0, 1, 2,
+                              3, 4, 5,
+                              6, 7, 8,
+                              9, 10, 11,
+                              12, 13, 14};
+  const float weights[] = {.1f, .2f,
+                           .3f, .4f,
+                           .5f, .6f,
+                           .7f, .8f,
+                           .9f, 1.f};
+  const ozz::Range<const uint16_t> in_indices(indices);
+  const ozz::Range<const float> in_weights(weights);
+  uint16_t soa_indices[24];
+  float soa_weights[16];
+  const ozz::Range<uint16_t> out_indices(soa_indices);
+  const ozz::Range<float> out_weights(soa_weights);
+  EXPECT_FALSE(ozz::geometry::PackSoaInfluences(
+    5, 3, in_indices, sizeof(uint16_t) * 3, in_weights, sizeof(float) * 2,
+    ozz::Range<uint16_t>(soa_indices, 23), out_weights));
+  EXPECT_FALSE(ozz::geometry::PackSoaInfluences(
+    5, 3, in_indices, sizeof(uint16_t) * 3, ozz::Range<const float>(),
+    sizeof(float) * 2, out_indices, out_weights));
+  EXPECT_TRUE(ozz::geometry::PackSoaInfluences(
+    5, 3, in_indices, sizeof(uint16_t) * 3, in_weights, sizeof(float) * 2,
+    out_indices, out_weights));
+  const uint16_t expected_indices[] = {0, 3, 6, 9,
+                                       1, 4, 7, 10,
+                                       2, 5, 8, 11,
+                                       12, 12, 12, 12,
+                                       13, 13, 13, 13,
+                                       14, 14, 14, 14};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(expected_indices); ++i) {
+    EXPECT_EQ(soa_indices[i], expected_indices[i]);
+  }
+  const float expected_weights[] = {.1f, .3f, .5f, .7f,
+                                    .2f, .4f, .6f, .8f,
+                                    .9f, .9f, .9f, .9f,
+                                    1.f, 1.f, 1.f, 1.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(expected_weights); ++i) {
+    EXPECT_FLOAT_EQ(soa_weights[i], expected_weights[i]);
+  }
+}
+
+TEST(JobResult, SoaSkinningJob) {
+  const int vertex_count = 13;  // 3 packets by pairs and a partial one.
+  const int joint_count = 7;
+  const int max_influences = 6;
+
+  ozz::math::Float4x4 matrices[joint_count];
+  ozz::math::Float4x4 it_matrices[joint_count];
+  for (int i = 0; i < joint_count; ++i) {
+    const float f = static_cast<float>(i);
+    matrices[i] = ozz::math::Float4x4::FromAffine(
+      ozz::math::simd_float4::Load(f, -2.f * f, 3.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, .38268343f, 0.f, .92387953f),
+      ozz::math::simd_float4::Load(1.f + f, 2.f, 1.f + f * .5f, 0.f));
+    it_matrices[i] = Transpose(Invert(matrices[i]));
+  }
+
+  // Prepares strided vertices and influences.
+  float positions[vertex_count * 3];
+  float normals[vertex_count * 3];
+  float tangents[vertex_count * 3];
+  uint16_t indices[vertex_count * max_influences];
+  float weights[vertex_count * max_influences];
+  for (int i = 0; i < vertex_count; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      const float f = static_cast<float>(i * 3 + j);
+      positions[i * 3 + j] = f * .5f - 3.f;
+      normals[i * 3 + j] = j == i % 3 ? 1.f : 0.f;
+      tangents[i * 3 + j] = j == (i + 1) % 3 ? -1.f : .1f * f;
+    }
+    for (int j = 0; j < max_influences; ++j) {
+      indices[i * max_influences + j] =
+        static_cast<uint16_t>((i + j * 3) % joint_count);
+      weights[i * max_influences + j] = .05f + .01f * ((i + j) % 5);
+    }
+  }
+
+  // Prepares soa buffers.
+  const int packets = (vertex_count + 3) / 4;
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  ozz::Range<ozz::math::SoaFloat3> soa_in =
+    allocator->AllocateRange<ozz::math::SoaFloat3>(packets * 3);
+  ozz::Range<ozz::math::SoaFloat3> soa_out =
+    allocator->AllocateRange<ozz::math::SoaFloat3>(packets * 3);
+  const size_t soa_weights_count = packets * (max_influences - 1) * 4;
+  ozz::Range<float> soa_weights(
+    static_cast<float*>(
+      allocator->Allocate(soa_weights_count * sizeof(float), 16)),
+    soa_weights_count);
+  uint16_t soa_indices[packets * max_influences * 4];
+
+  const ozz::Range<ozz::math::SoaFloat3> soa_in_positions(
+    soa_in.begin, packets);
+  const ozz::Range<ozz::math::SoaFloat3> soa_in_normals(
+    soa_in.begin + packets, packets);
+  const ozz::Range<ozz::math::SoaFloat3> soa_in_tangents(
+    soa_in.begin + packets * 2, packets);
+  const size_t vertex_stride = sizeof(float) * 3;
+  ASSERT_TRUE(ozz::geometry::PackSoaVertices(
+    ozz::Range<const float>(positions), vertex_stride, vertex_count,
+    soa_in_positions));
+  ASSERT_TRUE(ozz::geometry::PackSoaVertices(
+    ozz::Range<const float>(normals), vertex_stride, vertex_count,
+    soa_in_normals));
+  ASSERT_TRUE(ozz::geometry::PackSoaVertices(
+    ozz::Range<const float>(tangents), vertex_stride, vertex_count,
+    soa_in_tangents));
+
+  for (int influences = 1; influences <= max_influences; ++influences) {
+    ASSERT_TRUE(ozz::geometry::PackSoaInfluences(
+      vertex_count, influences,
+      ozz::Range<const uint16_t>(indices), sizeof(uint16_t) * max_influences,
+      ozz::Range<const float>(weights), sizeof(float) * max_influences,
+      ozz::Range<uint16_t>(soa_indices), soa_weights));
+
+    for (int variant = 0; variant < 5; ++variant) {
+      // Variants: P, PN, PNT, PN with inverse transpose, PNT with inverse
+      // transpose.
+      const bool normals_variant = variant != 0;
+      const bool tangents_variant = variant == 2 || variant == 4;
+      const bool it_variant = variant >= 3;
+
+      SkinningJob job;
+      job.vertex_count = vertex_count;
+      job.influences_count = influences;
+      job.joint_matrices = matrices;
+      job.joint_indices = indices;
+      job.joint_indices_stride = sizeof(uint16_t) * max_influences;
+      job.joint_weights = weights;
+      job.joint_weights_stride = sizeof(float) * max_influences;
+      job.in_positions = positions;
+      job.in_positions_stride = vertex_stride;
+      float out_positions[vertex_count * 3];
+      float out_normals[vertex_count * 3];
+      float out_tangents[vertex_count * 3];
+      job.out_positions = out_positions;
+      job.out_positions_stride = vertex_stride;
+
+      SoaSkinningJob soa_job;
+      soa_job.vertex_count = vertex_count;
+      soa_job.influences_count = influences;
+      soa_job.joint_matrices = matrices;
+      soa_job.joint_indices = ozz::Range<const uint16_t>(
+        soa_indices, packets * influences * 4);
+      soa_job.joint_weights = ozz::Range<const float>(
+        soa_weights.begin, packets * (influences - 1) * 4);
+      soa_job.in_positions = soa_in_positions;
+      soa_job.out_positions =
+        ozz::Range<ozz::math::SoaFloat3>(soa_out.begin, packets);
+
+      if (normals_variant) {
+        job.in_normals = normals;
+        job.in_normals_stride = vertex_stride;
+        job.out_normals = out_normals;
+        job.out_normals_stride = vertex_stride;
+        soa_job.in_normals = soa_in_normals;
+        soa_job.out_normals =
+          ozz::Range<ozz::math::SoaFloat3>(soa_out.begin + packets, packets);
+      }
+      if (tangents_variant) {
+        job.in_tangents = tangents;
+        job.in_tangents_stride = vertex_stride;
+        job.out_tangents = out_tangents;
+        job.out_tangents_stride = vertex_stride;
+        soa_job.in_tangents = soa_in_tangents;
+        soa_job.out_tangents = ozz::Range<ozz::math::SoaFloat3>(
+          soa_out.begin + packets * 2, packets);
+      }
+      if (it_variant) {
+        job.joint_inverse_transpose_matrices = it_matrices;
+        soa_job.joint_inverse_transpose_matrices = it_matrices;
+      }
+
+      ASSERT_TRUE(job.Run());
+      ASSERT_TRUE(soa_job.Run());
+
+      // Compares outputs.
+      float soa_out_vertices[vertex_count * 3];
+      const float* expected[] = {out_positions, out_normals, out_tangents};
+      const int outputs = 1 + normals_variant + tangents_variant;
+      for (int i = 0; i < outputs; ++i) {
+        ASSERT_TRUE(ozz::geometry::UnpackSoaVertices(
+          ozz::Range<const ozz::math::SoaFloat3>(
+            soa_out.begin + packets * i, packets),
+          vertex_count, ozz::Range<float>(soa_out_vertices), vertex_stride));
+        for (int j = 0; j < vertex_count * 3; ++j) {
+          EXPECT_NEAR(soa_out_vertices[j], expected[i][j], 1e-4f)
+            << "influences " << influences << ", variant " << variant;
+        }
+      }
+    }
+  }
+
+  allocator->Deallocate(soa_in);
+  allocator->Deallocate(soa_out);
+  allocator->Deallocate(soa_weights);
+}